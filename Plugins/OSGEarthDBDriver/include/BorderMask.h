@@ -0,0 +1,122 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDIS_PLUGIN_OSGEARTH_DB_BORDER_MASK_H
+#define SIMDIS_PLUGIN_OSGEARTH_DB_BORDER_MASK_H 1
+
+#include "QSCommonIntTypes.h"
+
+namespace osg {
+  class HeightField;
+  class Image;
+}
+
+namespace simVis_db
+{
+  /**
+   * Pixels of a decoded tile that fall inside the data extents of its face.  Pixels outside
+   * are filled with "no data".  Since pixel X depends only on the column and pixel Y only on
+   * the row, the pixels inside form one rectangle; it is found with one pass over the columns
+   * and one over the rows, and the fill is done with contiguous row span writes instead of a
+   * per-pixel test and read/write.
+   *
+   * Pixel (col, row) is inside if tileMinX + col * (tileWidth / (width - 1)) lies within
+   * [xMin, xMax], and likewise for the row and Y.
+   */
+  class BorderMask
+  {
+  public:
+    /**
+     * Computes the rectangle of pixels inside the extents
+     * @param width Number of columns in the tile
+     * @param height Number of rows in the tile
+     * @param tileMinX Minimum X of the tile, QS units
+     * @param tileMinY Minimum Y of the tile, QS units
+     * @param tileWidth Width of the tile, QS units
+     * @param tileHeight Height of the tile, QS units
+     * @param xMin Minimum X of the data extents, QS units
+     * @param xMax Maximum X of the data extents, QS units
+     * @param yMin Minimum Y of the data extents, QS units
+     * @param yMax Maximum Y of the data extents, QS units
+     */
+    BorderMask(unsigned int width, unsigned int height,
+      double tileMinX, double tileMinY, double tileWidth, double tileHeight,
+      double xMin, double xMax, double yMin, double yMax);
+
+    /** Returns true if no pixels are outside the extents */
+    bool isEmpty() const;
+    /** Returns true if the pixel is outside the extents */
+    bool isMasked(unsigned int col, unsigned int row) const;
+
+    /**
+     * Clears the alpha of pixels outside the extents in an image with 8 bit channels
+     * @param data First byte of the image
+     * @param rowStepBytes Bytes between the start of consecutive rows
+     * @param bytesPerPixel Bytes per pixel
+     * @param alphaOffset Byte offset of the alpha channel within a pixel
+     */
+    void clearAlpha8(uint8_t* data, unsigned int rowStepBytes, unsigned int bytesPerPixel, unsigned int alphaOffset) const;
+
+    /**
+     * Clears the alpha bit of pixels outside the extents in a GL_UNSIGNED_SHORT_5_5_5_1 image in native byte order
+     * @param data First byte of the image
+     * @param rowStepBytes Bytes between the start of consecutive rows
+     */
+    void clearAlpha5551(uint8_t* data, unsigned int rowStepBytes) const;
+
+    /**
+     * Sets values outside the extents in a row-major single-channel float raster (e.g. a height field)
+     * @param data First value of the raster
+     * @param rowStep Values between the start of consecutive rows
+     * @param value Value to write
+     */
+    void fill(float* data, unsigned int rowStep, float value) const;
+
+    /**
+     * Clears the alpha of pixels outside the extents.  8 bit RGBA, BGRA, luminance-alpha and alpha
+     * images and GL_UNSIGNED_SHORT_5_5_5_1 RGBA images are written directly in row spans; other
+     * layouts with alpha use osgEarth's PixelReader and PixelWriter on the masked pixels.
+     * @param image Image of width x height pixels
+     */
+    void clearAlpha(osg::Image& image) const;
+
+    /**
+     * Sets heights outside the extents
+     * @param heightField Height field of width x height samples
+     * @param value Height to write
+     */
+    void fill(osg::HeightField& heightField, float value) const;
+
+  private:
+    unsigned int width_;
+    unsigned int height_;
+    /// Columns and rows inside the extents; the range is empty if first > last
+    unsigned int firstCol_;
+    unsigned int lastCol_;
+    unsigned int firstRow_;
+    unsigned int lastRow_;
+    /// True if no row or no column is inside the extents
+    bool allMasked_;
+  };
+
+} // namespace simVis_db
+
+#endif // SIMDIS_PLUGIN_OSGEARTH_DB_BORDER_MASK_H
@@ -23,6 +23,8 @@
 #ifndef SIMDIS_PLUGIN_OSGEARTH_DB_DRIVER_H
 #define SIMDIS_PLUGIN_OSGEARTH_DB_DRIVER_H 1
 
+#include "OpenThreads/Atomic"
+#include "OpenThreads/Mutex"
 #include "osgEarth/TileSource"
 #include "simCore/Time/Utils.h"
 #include "simVis/DBOptions.h"
@@ -30,10 +32,12 @@
 #include "sqlite/sqlite3.h"
 #include "SQLiteDataBaseReadUtil.h"
 #include "QSPosXYExtents.h"
+#include "DecodedTileCache.h"
+#include "TilePrefetcher.h"
 
 namespace simVis_db
 {
-  class DBTileSource : public osgEarth::TileSource
+  class DBTileSource : public osgEarth::TileSource, public TilePrefetcher::Loader
   {
   public:
     /** Constructs a new driver for reading .DB raster files */
@@ -46,22 +50,58 @@ namespace simVis_db
     virtual std::string getExtension() const;
     virtual int getPixelsPerTile() const;
 
+    /**
+     * Loads a tile into the decoded tile cache, if it is not already cached.  Called by the prefetcher.
+     * Tiles the database does not have are cached as empty entries; failed reads are not cached.
+     * @param key Tile to load
+     * @param isHeightField True to load a height field, false for an image
+     * @return True if a tile with data was loaded and cached
+     */
+    virtual bool prefetchTile(const osgEarth::TileKey& key, bool isHeightField);
+
   protected:
       virtual ~DBTileSource();
 
   private:
+      class RasterDecoder;
+
       bool decodeRaster_(
           int          rasterFormat,
           const char*  inputBuffer,
           int          inputBufferLen,
           osg::ref_ptr<osg::Image>& out_image);
 
-      osg::Image* createImage_(const osgEarth::TileKey& key, bool isHeightField);
+      /** Reads and decodes an image tile; out_absent is set if the database has no tile for the key */
+      osg::Image* createImage_(const osgEarth::TileKey& key, bool isHeightField, bool& out_absent);
+      /** Reads and decodes a height field tile; out_absent is set if the database has no tile for the key */
+      osg::HeightField* createHeightField_(const osgEarth::TileKey& key, bool& out_absent);
+
+      /** Returns the decoded tile cache key for a tile */
+      std::string cacheKey_(const osgEarth::TileKey& key, bool isHeightField) const;
+      /** Adds a freshly loaded tile to the decoded tile cache; a NULL tile is cached only if absent is true */
+      void cacheTile_(const std::string& cacheKey, const osg::Object* tile, bool absent);
+      /** Updates the statistics user values */
+      void publishStatistics_();
+      /** Counts a tile request, publishing the statistics every STATISTICS_INTERVAL requests */
+      void countRequest_();
+
+      /** Number of tile requests between updates of the statistics user values */
+      static const unsigned int STATISTICS_INTERVAL = 64;
 
       const simVis::DBOptions options_;
       std::string pathname_;
       sqlite3* db_;
       SQLiteDataBaseReadUtil dbUtil_;
+      /** Connections used by the pager threads to read tiles */
+      SQLiteReadConnectionPool* readPool_;
+      /** Decoded tiles; NULL if disabled */
+      DecodedTileCache* cache_;
+      /** Loads neighbors and children of requested tiles into cache_; NULL if disabled */
+      TilePrefetcher* prefetcher_;
+      /** Serializes updates of the statistics user values */
+      OpenThreads::Mutex statisticsMutex_;
+      /** Number of tile requests served through the cache */
+      OpenThreads::Atomic numRequests_;
 
       // layer metadata
       /** Defined in RasterCommon.h */
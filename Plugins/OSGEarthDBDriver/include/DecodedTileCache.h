@@ -0,0 +1,127 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDIS_PLUGIN_OSGEARTH_DB_DECODED_TILE_CACHE_H
+#define SIMDIS_PLUGIN_OSGEARTH_DB_DECODED_TILE_CACHE_H 1
+
+#include <list>
+#include <map>
+#include <string>
+#include "OpenThreads/Mutex"
+#include "osg/Object"
+#include "osg/ref_ptr"
+
+namespace simVis_db
+{
+  /**
+   * Memory-bounded LRU cache of decoded tiles (osg::Image or osg::HeightField), keyed on a
+   * string built from the TileKey.  osgEarth re-requests the same tiles after camera moves;
+   * a hit replaces the database read and the JPEG/PNG/zlib decode with a memory copy.
+   * The cache stores its own copies, so callers are free to modify what they get back.
+   * Tiles without data are cached as empty entries, so that they are not read again.
+   * All methods are thread safe.
+   */
+  class DecodedTileCache
+  {
+  public:
+    /** Counters describing the use of the cache */
+    struct Statistics
+    {
+      /// Lookups that found a tile
+      unsigned int hits;
+      /// Lookups that did not find a tile
+      unsigned int misses;
+      /// Tiles removed to stay within the memory limit
+      unsigned int evictions;
+      /// Number of tiles in the cache
+      unsigned int numTiles;
+      /// Memory used by tiles in the cache, in bytes
+      size_t sizeBytes;
+    };
+
+    /**
+     * Constructs a cache
+     * @param maxSizeBytes Memory limit for cached tiles, in bytes
+     */
+    explicit DecodedTileCache(size_t maxSizeBytes);
+    virtual ~DecodedTileCache();
+
+    /**
+     * Retrieves a copy of a cached tile, counting a hit or a miss
+     * @param key Tile key
+     * @param tile Receives a copy of the tile, or NULL for an empty entry
+     * @return True if the key is in the cache, including empty entries
+     */
+    bool get(const std::string& key, osg::ref_ptr<osg::Object>& tile);
+
+    /**
+     * Returns true if a tile is in the cache; does not count as a hit or miss, nor change LRU order
+     * @param key Tile key
+     * @return True if the tile is in the cache
+     */
+    bool contains(const std::string& key) const;
+
+    /**
+     * Adds a copy of a tile, replacing any tile with the same key, then evicts the least recently
+     * used tiles until the cache is within its memory limit
+     * @param key Tile key
+     * @param tile Tile to copy into the cache; NULL adds an empty entry for a tile without data
+     * @param sizeBytes Memory used by the tile, in bytes; empty entries are charged EMPTY_ENTRY_BYTES
+     */
+    void insert(const std::string& key, const osg::Object* tile, size_t sizeBytes);
+
+    /** Removes all tiles; statistics are kept */
+    void clear();
+
+    /** Retrieves the statistics */
+    Statistics statistics() const;
+
+    /** Retrieves the memory limit, in bytes */
+    size_t maxSizeBytes() const;
+
+    /** Memory charged for an empty entry, which only holds the key */
+    static const size_t EMPTY_ENTRY_BYTES = 64;
+
+  private:
+    /** A cached tile */
+    struct Entry
+    {
+      std::string key;
+      /// NULL for a tile without data
+      osg::ref_ptr<osg::Object> tile;
+      size_t sizeBytes;
+    };
+    typedef std::list<Entry> EntryList;
+
+    /** Removes least recently used entries until within the limit; mutex_ must be locked */
+    void evict_();
+
+    size_t maxSizeBytes_;
+    mutable OpenThreads::Mutex mutex_;
+    /// Most recently used at the front
+    EntryList entries_;
+    std::map<std::string, EntryList::iterator> entriesByKey_;
+    Statistics stats_;
+  };
+
+} // namespace simVis_db
+
+#endif // SIMDIS_PLUGIN_OSGEARTH_DB_DECODED_TILE_CACHE_H
@@ -24,6 +24,8 @@
 #define SQLITE_DATABASE_READ_UTIL_H
 
 #include <string>
+#include <vector>
+#include "OpenThreads/Mutex"
 #include "sqlite/sqlite3.h"
 #include "simCore/Time/TimeClass.h"
 
@@ -78,10 +80,28 @@ namespace simVis_db
   static const char* QS_TSO_DESCRIPTION = "ds";
   static const char* QS_TSO_TIME_SPECIFIED = "ts";
 
+  /** Default number of pages in the SQLite page cache of each connection */
+  static const int QS_DEFAULT_CACHE_SIZE_PAGES = 100;
+
   //=====================================================================================
   typedef std::vector<sqlite3*> vSqlite3;
   void CloseSqliteDBs(vSqlite3*);
 
+  //=====================================================================================
+  /** Receives a node's data buffer directly from SQLite, without an intermediate copy */
+  class TileBlobVisitor
+  {
+  public:
+    virtual ~TileBlobVisitor() {}
+
+    /**
+     * Called once per read with the node's data buffer
+     * @param data Data buffer owned by SQLite; only valid for the duration of the call
+     * @param dataSize Size (bytes) of the data buffer; 0 if the node is not in the table
+     */
+    virtual void Visit(const uint8_t* data, uint32_t dataSize) = 0;
+  };
+
   //=====================================================================================
   class SQLiteDataBaseReadUtil
   {
@@ -89,6 +109,31 @@ namespace simVis_db
     SQLiteDataBaseReadUtil();
     virtual ~SQLiteDataBaseReadUtil();
 
+    /** Sets the number of pages in the page cache of connections opened by OpenDataBaseFile() */
+    void SetCacheSizePages(int cacheSizePages);
+    /** Returns the number of pages in the page cache of connections opened by OpenDataBaseFile() */
+    int CacheSizePages() const;
+
+    /** Creates the SELECT statement that reads a node's data buffer from the given sets table */
+    std::string TsReadDataBufferCommand(const std::string& dataTableName) const;
+
+    /**
+     * Packs the face index and node ID into the blob used as key in sets tables
+     * @param[in] faceIndex Mapping to a face index/orientation
+     * @param[in] nodeID Node to pack
+     * @param[out] idBlob Destination, at least SizeOfIdBlob() bytes
+     */
+    void PackIdBlob(const FaceIndexType& faceIndex, const QSNodeId& nodeID, uint8_t* idBlob) const;
+    /** Returns the size (bytes) of the blob used as key in sets tables */
+    int SizeOfIdBlob() const;
+
+    /**
+     * Formats an error message for the given connection, including SQLite's extended error code
+     * @param sqlite3Db Connection that reported the error
+     * @return Error description, terminated with a newline
+     */
+    static std::string ExtendedErrorMessage(sqlite3* sqlite3Db);
+
     /** Opens a database file */
     QsErrorType OpenDataBaseFile(const std::string& dbFileName,
                                   sqlite3** sqlite3Db,
@@ -150,6 +195,7 @@ namespace simVis_db
                                   bool displayErrorMessage=false) const;
   protected:
     int sizeOfIdBlob_;
+    int cacheSizePages_;
 
     std::string textureSetSelectCommand_;
     std::string textureSetSelectFileCommand1_;
@@ -170,6 +216,68 @@ namespace simVis_db
     int tsInsertSetIdTimeValue_;
   };
 
+  //=====================================================================================
+  /**
+   * Pool of read-only connections to the sets table of one database file.
+   *
+   * A single connection opened with SQLITE_OPEN_FULLMUTEX serializes all of osgEarth's pager
+   * threads, and TsReadDataBuffer() prepares and finalizes a statement and copies the data
+   * buffer on every read.  Each reader here checks out a connection of its own for the
+   * duration of a read, so that concurrent readers proceed in parallel; the pool grows to the
+   * number of concurrent readers.  Each connection keeps its prepared SELECT statement, and
+   * data buffers are handed to a TileBlobVisitor straight from SQLite's memory.
+   */
+  class SQLiteReadConnectionPool
+  {
+  public:
+    /**
+     * Constructs a pool; connections are opened on demand
+     * @param dbFileName Name of the SQLite database file
+     * @param dataTableName Name of the sets table to read
+     * @param cacheSizePages Number of pages in the page cache of each connection
+     */
+    SQLiteReadConnectionPool(const std::string& dbFileName, const std::string& dataTableName,
+                             int cacheSizePages = QS_DEFAULT_CACHE_SIZE_PAGES);
+    virtual ~SQLiteReadConnectionPool();
+
+    /**
+     * Reads a node's data buffer and passes it to the visitor.  Safe to call from multiple threads.
+     * @param[in] faceIndex Mapping to a face index/orientation, used to create a SQLite idBlob
+     * @param[in] nodeID Used to fill the idBlob
+     * @param[in] visitor Receives the data buffer; called once on success, with a size of 0 if the node is not in the table
+     * @param[in] displayErrorMessage Determines whether to display error messages to console when failing
+     * @return An error value, mapped to QsErrorType
+     */
+    QsErrorType TsReadDataBuffer(const FaceIndexType& faceIndex,
+                                 const QSNodeId& nodeID,
+                                 TileBlobVisitor& visitor,
+                                 bool displayErrorMessage=false);
+
+    /** Returns the number of connections opened so far */
+    size_t NumConnections() const;
+
+  private:
+    /** A connection and its prepared statement */
+    struct Connection
+    {
+      sqlite3* db;
+      sqlite3_stmt* selectStmt;
+    };
+
+    /** Checks out an idle connection, opening a new one if none are idle */
+    QsErrorType Acquire_(Connection*& connection, bool displayErrorMessage);
+    /** Returns a connection to the idle list */
+    void Release_(Connection* connection);
+
+    SQLiteDataBaseReadUtil dbUtil_;
+    std::string dbFileName_;
+    std::string selectCommand_;
+
+    mutable OpenThreads::Mutex mutex_;
+    std::vector<Connection*> idle_;
+    std::vector<Connection*> all_;
+  };
+
 #ifdef USE_SIMDIS_SDK
 } // namespace simVis_db
 #endif
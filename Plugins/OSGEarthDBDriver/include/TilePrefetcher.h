@@ -0,0 +1,109 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMDIS_PLUGIN_OSGEARTH_DB_TILE_PREFETCHER_H
+#define SIMDIS_PLUGIN_OSGEARTH_DB_TILE_PREFETCHER_H 1
+
+#include <deque>
+#include <vector>
+#include "OpenThreads/Condition"
+#include "OpenThreads/Mutex"
+#include "osgEarth/TileKey"
+
+namespace simVis_db
+{
+  /**
+   * Pool of worker threads that load tiles into a DBTileSource's decoded tile cache ahead of
+   * osgEarth's requests.  After a request, the children and the neighbors of the requested tile
+   * are queued; when the queue is full the oldest requests are dropped, since they are the least
+   * likely to still be relevant after camera movement.  A tile is queued at most once; requesting
+   * it again moves it to the front of the queue.
+   */
+  class TilePrefetcher
+  {
+  public:
+    /** Loads tiles for the prefetcher; implemented by DBTileSource */
+    class Loader
+    {
+    public:
+      virtual ~Loader() {}
+
+      /**
+       * Loads a tile into the decoded tile cache, if it is not already cached.  Called from worker threads.
+       * @param key Tile to load
+       * @param isHeightField True to load a height field, false for an image
+       * @return True if a tile was loaded and cached
+       */
+      virtual bool prefetchTile(const osgEarth::TileKey& key, bool isHeightField) = 0;
+    };
+
+    /**
+     * Constructs the prefetcher and starts its threads
+     * @param source Loader of the tiles; must outlive the prefetcher
+     * @param numThreads Number of worker threads; 0 uses one thread
+     * @param maxQueued Maximum number of queued tiles
+     */
+    TilePrefetcher(Loader& source, unsigned int numThreads, size_t maxQueued = 256);
+    /** Stops and joins the worker threads; queued tiles are discarded */
+    virtual ~TilePrefetcher();
+
+    /**
+     * Queues the children and the four neighbors of a requested tile
+     * @param key Tile requested by osgEarth
+     * @param isHeightField True to prefetch height fields, false for images
+     * @param maxLevel Deepest level of detail with data; deeper children are not queued
+     */
+    void requestAround(const osgEarth::TileKey& key, bool isHeightField, unsigned int maxLevel);
+
+    /** Returns the number of tiles loaded by the worker threads */
+    unsigned int numLoaded() const;
+
+  private:
+    class Worker;
+
+    /** A queued tile */
+    struct Request
+    {
+      osgEarth::TileKey key;
+      bool isHeightField;
+    };
+
+    /** Queues one tile, or moves it to the most recent position if already queued; mutex_ must be locked */
+    void push_(const osgEarth::TileKey& key, bool isHeightField);
+    /** Blocks until a tile is queued; returns false if the prefetcher is shutting down */
+    bool pop_(Request& request);
+    /** Loads one tile, called from the worker threads */
+    void load_(const Request& request);
+
+    Loader& source_;
+    size_t maxQueued_;
+    std::vector<Worker*> workers_;
+
+    mutable OpenThreads::Mutex mutex_;
+    OpenThreads::Condition condition_;
+    std::deque<Request> queue_;
+    bool done_;
+    unsigned int numLoaded_;
+  };
+
+} // namespace simVis_db
+
+#endif // SIMDIS_PLUGIN_OSGEARTH_DB_TILE_PREFETCHER_H
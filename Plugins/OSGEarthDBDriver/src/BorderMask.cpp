@@ -0,0 +1,239 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+#include <cstring>
+#include "osg/Image"
+#include "osg/Shape"
+#include "osgEarth/ImageUtils"
+#include "BorderMask.h"
+
+using namespace simVis_db;
+
+namespace
+{
+  /**
+   * Finds the first and last index whose coordinate lies in [minValue, maxValue].  Coordinates
+   * increase with the index, so the indices in range are contiguous.
+   * @return False if no index is in range
+   */
+  bool findSpan(unsigned int count, double start, double extent, double minValue, double maxValue, unsigned int& first, unsigned int& last)
+  {
+    // Must be computed exactly as the per-pixel test did, so that results match bit for bit
+    const double step = extent / (count - 1);
+    bool found = false;
+    for (unsigned int k = 0; k < count; ++k)
+    {
+      const double value = start + k * step;
+      if (!(value < minValue || value > maxValue))
+      {
+        if (!found)
+          first = k;
+        last = k;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  /** Applies an operation to every pixel outside a rectangle, row span by row span */
+  template <typename SpanOp>
+  void forEachMaskedSpan(unsigned int width, unsigned int height, bool allMasked,
+    unsigned int firstCol, unsigned int lastCol, unsigned int firstRow, unsigned int lastRow, SpanOp& op)
+  {
+    for (unsigned int row = 0; row < height; ++row)
+    {
+      if (allMasked || row < firstRow || row > lastRow)
+      {
+        op(row, 0, width);
+        continue;
+      }
+      if (firstCol > 0)
+        op(row, 0, firstCol);
+      if (lastCol + 1 < width)
+        op(row, lastCol + 1, width);
+    }
+  }
+
+  /** Clears an 8 bit alpha channel over [begin, end) of a row */
+  struct ClearAlpha8
+  {
+    uint8_t* data;
+    unsigned int rowStepBytes;
+    unsigned int bytesPerPixel;
+    unsigned int alphaOffset;
+    void operator()(unsigned int row, unsigned int begin, unsigned int end) const
+    {
+      uint8_t* alpha = data + row * rowStepBytes + begin * bytesPerPixel + alphaOffset;
+      for (unsigned int col = begin; col < end; ++col, alpha += bytesPerPixel)
+        *alpha = 0;
+    }
+  };
+
+  /** Clears the alpha bit of 5551 pixels over [begin, end) of a row */
+  struct ClearAlpha5551
+  {
+    uint8_t* data;
+    unsigned int rowStepBytes;
+    void operator()(unsigned int row, unsigned int begin, unsigned int end) const
+    {
+      uint8_t* rowStart = data + row * rowStepBytes;
+      for (unsigned int col = begin; col < end; ++col)
+      {
+        // Copy through memcpy to avoid alignment and aliasing issues
+        uint16_t pixel;
+        memcpy(&pixel, rowStart + col * sizeof(uint16_t), sizeof(uint16_t));
+        pixel &= static_cast<uint16_t>(0xfffe);
+        memcpy(rowStart + col * sizeof(uint16_t), &pixel, sizeof(uint16_t));
+      }
+    }
+  };
+
+  /** Fills float values over [begin, end) of a row */
+  struct FillFloat
+  {
+    float* data;
+    unsigned int rowStep;
+    float value;
+    void operator()(unsigned int row, unsigned int begin, unsigned int end) const
+    {
+      float* values = data + row * rowStep;
+      for (unsigned int col = begin; col < end; ++col)
+        values[col] = value;
+    }
+  };
+}
+
+BorderMask::BorderMask(unsigned int width, unsigned int height,
+  double tileMinX, double tileMinY, double tileWidth, double tileHeight,
+  double xMin, double xMax, double yMin, double yMax)
+  : width_(width),
+    height_(height),
+    firstCol_(0),
+    lastCol_(0),
+    firstRow_(0),
+    lastRow_(0),
+    allMasked_(false)
+{
+  if (width == 0 || height == 0)
+    return;
+  const bool haveCols = findSpan(width, tileMinX, tileWidth, xMin, xMax, firstCol_, lastCol_);
+  const bool haveRows = findSpan(height, tileMinY, tileHeight, yMin, yMax, firstRow_, lastRow_);
+  allMasked_ = !haveCols || !haveRows;
+}
+
+bool BorderMask::isEmpty() const
+{
+  if (width_ == 0 || height_ == 0)
+    return true;
+  return !allMasked_ && firstCol_ == 0 && lastCol_ + 1 == width_ && firstRow_ == 0 && lastRow_ + 1 == height_;
+}
+
+bool BorderMask::isMasked(unsigned int col, unsigned int row) const
+{
+  return allMasked_ || col < firstCol_ || col > lastCol_ || row < firstRow_ || row > lastRow_;
+}
+
+void BorderMask::clearAlpha8(uint8_t* data, unsigned int rowStepBytes, unsigned int bytesPerPixel, unsigned int alphaOffset) const
+{
+  if (isEmpty())
+    return;
+  ClearAlpha8 op = { data, rowStepBytes, bytesPerPixel, alphaOffset };
+  forEachMaskedSpan(width_, height_, allMasked_, firstCol_, lastCol_, firstRow_, lastRow_, op);
+}
+
+void BorderMask::clearAlpha5551(uint8_t* data, unsigned int rowStepBytes) const
+{
+  if (isEmpty())
+    return;
+  ClearAlpha5551 op = { data, rowStepBytes };
+  forEachMaskedSpan(width_, height_, allMasked_, firstCol_, lastCol_, firstRow_, lastRow_, op);
+}
+
+void BorderMask::fill(float* data, unsigned int rowStep, float value) const
+{
+  if (isEmpty())
+    return;
+  FillFloat op = { data, rowStep, value };
+  forEachMaskedSpan(width_, height_, allMasked_, firstCol_, lastCol_, firstRow_, lastRow_, op);
+}
+
+void BorderMask::clearAlpha(osg::Image& image) const
+{
+  if (isEmpty())
+    return;
+  const GLenum pixelFormat = image.getPixelFormat();
+  const GLenum dataType = image.getDataType();
+  const unsigned int rowStep = image.getRowStepInBytes();
+
+  // Formats without alpha are unaffected, as they were with PixelWriter
+  if (pixelFormat == GL_RGB || pixelFormat == GL_BGR || pixelFormat == GL_LUMINANCE || pixelFormat == GL_RED)
+    return;
+
+  if (dataType == GL_UNSIGNED_BYTE)
+  {
+    if (pixelFormat == GL_RGBA || pixelFormat == GL_BGRA)
+    {
+      clearAlpha8(image.data(), rowStep, 4, 3);
+      return;
+    }
+    if (pixelFormat == GL_LUMINANCE_ALPHA)
+    {
+      clearAlpha8(image.data(), rowStep, 2, 1);
+      return;
+    }
+    if (pixelFormat == GL_ALPHA)
+    {
+      clearAlpha8(image.data(), rowStep, 1, 0);
+      return;
+    }
+  }
+  else if (dataType == GL_UNSIGNED_SHORT_5_5_5_1 && pixelFormat == GL_RGBA)
+  {
+    clearAlpha5551(image.data(), rowStep);
+    return;
+  }
+
+  // Any other layout goes through osgEarth's generic pixel access, for masked pixels only
+  osgEarth::ImageUtils::PixelReader read(&image);
+  osgEarth::ImageUtils::PixelWriter write(&image);
+  const unsigned int width = static_cast<unsigned int>(image.s());
+  const unsigned int height = static_cast<unsigned int>(image.t());
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+    {
+      if (isMasked(col, row))
+      {
+        osg::Vec4f pixel = read(col, row);
+        pixel.a() = 0.0f;
+        write(pixel, col, row);
+      }
+    }
+  }
+}
+
+void BorderMask::fill(osg::HeightField& heightField, float value) const
+{
+  osg::FloatArray* heights = heightField.getFloatArray();
+  if (heights != NULL && !heights->empty())
+    fill(&(*heights)[0], heightField.getNumColumns(), value);
+}
@@ -22,6 +22,7 @@
 
 #include "simCore/Calc/Math.h"
 #include "osg/ValueObject"
+#include "OpenThreads/ScopedLock"
 #include "osgEarth/Registry"
 #include "osgEarth/FileUtils"
 #include "osgEarth/Cube"
@@ -37,6 +38,8 @@
 #include "QSCommon.h"
 #include "SQLiteDataBaseReadUtil.h"
 #include "swapbytes.h"
+#include "BorderMask.h"
+#include "TilePrefetcher.h"
 #include "DBTileSource.h"
 
 #define LC "[simVis::DBTileSource] "
@@ -115,21 +118,88 @@ namespace
     return true;
   }
 
+  /** Read-only stream buffer over existing memory, so that decoders can read SQLite's buffer without copying it */
+  class MemoryStreamBuf : public std::streambuf
+  {
+  public:
+    MemoryStreamBuf(const char* data, int dataLen)
+    {
+      char* begin = const_cast<char*>(data);
+      setg(begin, begin, begin + dataLen);
+    }
+
+  protected:
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+    {
+      char* target = egptr() + off;
+      if (dir == std::ios_base::beg)
+        target = eback() + off;
+      else if (dir == std::ios_base::cur)
+        target = gptr() + off;
+      if (target < eback() || target > egptr())
+        return pos_type(off_type(-1));
+      setg(eback(), target, egptr());
+      return pos_type(target - eback());
+    }
+
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+    {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+  };
+
   bool decompressZLIB(const char* input, int inputLen, std::string& output)
   {
     osgDB::BaseCompressor* comp = osgDB::Registry::instance()->getObjectWrapperManager()->findCompressor("zlib");
-    std::string inString(input, inputLen);
-    std::istringstream inStream(inString);
+    MemoryStreamBuf inBuf(input, inputLen);
+    std::istream inStream(&inBuf);
     return comp->decompress(inStream, output);
   }
 }
 
 // --------------------------------------------------------------------------
 
+/** Decodes a tile straight from the buffer owned by SQLite */
+class DBTileSource::RasterDecoder : public TileBlobVisitor
+{
+public:
+  explicit RasterDecoder(DBTileSource& source)
+    : source_(source),
+      found_(false),
+      decoded_(false)
+  {
+  }
+
+  virtual void Visit(const uint8_t* data, uint32_t dataSize)
+  {
+    found_ = (dataSize > 0);
+    if (found_)
+      decoded_ = source_.decodeRaster_(source_.rasterFormat_, reinterpret_cast<const char*>(data), static_cast<int>(dataSize), image_);
+  }
+
+  /** True if the tile exists in the db */
+  bool found() const { return found_; }
+  /** True if the tile was decoded into image() */
+  bool decoded() const { return decoded_; }
+  /** Decoded image */
+  osg::Image* image() const { return image_.get(); }
+
+private:
+  DBTileSource& source_;
+  bool found_;
+  bool decoded_;
+  osg::ref_ptr<osg::Image> image_;
+};
+
+// --------------------------------------------------------------------------
+
 DBTileSource::DBTileSource(const TileSourceOptions& options)
   : osgEarth::TileSource(options),
     options_(options),
     db_(NULL),
+    readPool_(NULL),
+    cache_(NULL),
+    prefetcher_(NULL),
     rasterFormat_(SPLIT_UNKNOWN),
     pixelLength_(128),
     shallowLevel_(0),
@@ -145,6 +215,10 @@ DBTileSource::DBTileSource(const TileSourceOptions& options)
 
 DBTileSource::~DBTileSource()
 {
+  // Prefetch threads use the cache and the read pool
+  delete prefetcher_;
+  delete cache_;
+  delete readPool_;
   if (db_)
   {
     sqlite3_close(db_);
@@ -239,6 +313,19 @@ Status DBTileSource::initialize(const osgDB::Options* dbOptions)
         << "    4: " << extents_[4].minX << "," << extents_[4].minY << "," << extents_[4].maxX << "," << extents_[4].maxY << "(" << (llex[4].isValid() ? llex[4].toString() : "empty") << ")\n"
         << "    5: " << extents_[5].minX << "," << extents_[5].minY << "," << extents_[5].maxX << "," << extents_[5].maxY << "(" << (llex[5].isValid() ? llex[5].toString() : "empty") << ")\n";
 
+      // Tiles are read through a pool of connections, so that pager threads do not serialize on db_
+      const int cacheSizePages = options_.cacheSizePages().isSet() ? options_.cacheSizePages().get() : QS_DEFAULT_CACHE_SIZE_PAGES;
+      readPool_ = new SQLiteReadConnectionPool(pathname_, "default", cacheSizePages);
+
+      // Decoded tiles are cached, optionally with prefetch of neighbors and children
+      if (options_.decodedCacheSizeMB().get() > 0)
+      {
+        cache_ = new DecodedTileCache(static_cast<size_t>(options_.decodedCacheSizeMB().get()) * 1024 * 1024);
+        if (options_.prefetch().get())
+          prefetcher_ = new TilePrefetcher(*this, options_.prefetchThreads().get());
+      }
+      publishStatistics_();
+
       // Line up the native format readers:
       pngReader_ = osgDB::Registry::instance()->getReaderWriterForMimeType("image/png");
       jpgReader_ = osgDB::Registry::instance()->getReaderWriterForMimeType("image/jpeg");
@@ -261,12 +348,118 @@ int DBTileSource::getPixelsPerTile() const
 
 osg::Image* DBTileSource::createImage(const TileKey& key, ProgressCallback* progress)
 {
-  return createImage_(key, false);
+  bool absent = false;
+  if (!cache_)
+    return createImage_(key, false, absent);
+
+  const std::string cacheKey = cacheKey_(key, false);
+  osg::ref_ptr<osg::Object> cached;
+  osg::ref_ptr<osg::Image> result;
+  if (cache_->get(cacheKey, cached))
+    result = static_cast<osg::Image*>(cached.get());
+  else
+  {
+    result = createImage_(key, false, absent);
+    cacheTile_(cacheKey, result.get(), absent);
+  }
+  if (prefetcher_)
+    prefetcher_->requestAround(key, false, static_cast<unsigned int>(deepLevel_));
+  countRequest_();
+  return result.release();
 }
 
 osg::HeightField* DBTileSource::createHeightField(const TileKey& key, ProgressCallback* progress)
 {
-  if (!db_) return NULL;
+  bool absent = false;
+  if (!cache_)
+    return createHeightField_(key, absent);
+
+  const std::string cacheKey = cacheKey_(key, true);
+  osg::ref_ptr<osg::Object> cached;
+  osg::ref_ptr<osg::HeightField> result;
+  if (cache_->get(cacheKey, cached))
+    result = static_cast<osg::HeightField*>(cached.get());
+  else
+  {
+    result = createHeightField_(key, absent);
+    cacheTile_(cacheKey, result.get(), absent);
+  }
+  if (prefetcher_)
+    prefetcher_->requestAround(key, true, static_cast<unsigned int>(deepLevel_));
+  countRequest_();
+  return result.release();
+}
+
+bool DBTileSource::prefetchTile(const TileKey& key, bool isHeightField)
+{
+  if (!cache_)
+    return false;
+  const std::string cacheKey = cacheKey_(key, isHeightField);
+  if (cache_->contains(cacheKey))
+    return false;
+
+  osg::ref_ptr<osg::Object> tile;
+  bool absent = false;
+  if (isHeightField)
+    tile = createHeightField_(key, absent);
+  else
+    tile = createImage_(key, false, absent);
+  cacheTile_(cacheKey, tile.get(), absent);
+  return tile.valid();
+}
+
+std::string DBTileSource::cacheKey_(const TileKey& key, bool isHeightField) const
+{
+  return (isHeightField ? "h" : "i") + key.str();
+}
+
+void DBTileSource::cacheTile_(const std::string& cacheKey, const osg::Object* tile, bool absent)
+{
+  // Tiles the database does not have are cached as empty entries so they are not queried again.
+  // Failed reads (e.g. a busy or locked database) and failed decodes are not cached, so the next request retries.
+  if (!cache_ || (tile == NULL && !absent))
+    return;
+
+  size_t sizeBytes = 0;
+  const osg::Image* image = dynamic_cast<const osg::Image*>(tile);
+  const osg::HeightField* heightField = dynamic_cast<const osg::HeightField*>(tile);
+  if (image)
+    sizeBytes = image->getTotalSizeInBytesIncludingMipmaps();
+  else if (heightField)
+    sizeBytes = heightField->getNumColumns() * heightField->getNumRows() * sizeof(float);
+  cache_->insert(cacheKey, tile, sizeBytes);
+}
+
+void DBTileSource::countRequest_()
+{
+  // Publishing locks and sets five user values, so it is done once per interval rather than per tile
+  if ((++numRequests_ % STATISTICS_INTERVAL) == 0)
+    publishStatistics_();
+}
+
+void DBTileSource::publishStatistics_()
+{
+  DecodedTileCache::Statistics stats;
+  stats.hits = 0;
+  stats.misses = 0;
+  stats.sizeBytes = 0;
+  if (cache_)
+    stats = cache_->statistics();
+  const unsigned int lookups = stats.hits + stats.misses;
+
+  // The values are created during initialize(), so later updates only change values in place
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(statisticsMutex_);
+  setUserValue("decoded_cache_hits", stats.hits);
+  setUserValue("decoded_cache_misses", stats.misses);
+  setUserValue("decoded_cache_hit_rate", (lookups == 0) ? 0.0 : static_cast<double>(stats.hits) / lookups);
+  setUserValue("decoded_cache_size_bytes", static_cast<double>(stats.sizeBytes));
+  setUserValue("prefetch_loads", prefetcher_ ? prefetcher_->numLoaded() : 0u);
+}
+
+osg::HeightField* DBTileSource::createHeightField_(const TileKey& key, bool& out_absent)
+{
+  out_absent = false;
+  if (!readPool_) return NULL;
 
   osg::ref_ptr<osg::HeightField> result;
 
@@ -281,31 +474,20 @@ osg::HeightField* DBTileSource::createHeightField(const TileKey& key, ProgressCa
   {
     // If there is no data on that face, return nothing.
     OE_DEBUG << LC << "Face " << (int)faceId << " is invalid; returning empty heightfield" << std::endl;
+    out_absent = true;
     return NULL;
   }
 
-  // Query the database
-  TextureDataType* buf = NULL;
-  uint32_t bufSize =0;
-  uint32_t currentRasterSize =0;
-
-  QsErrorType err = dbUtil_.TsReadDataBuffer(
-    db_,
-    pathname_,
-    "default",
-    faceId,
-    nodeId,
-    &buf,
-    &bufSize,
-    &currentRasterSize,
-    false);             // AllowLocalDB: no, we created it ourselves
+  // Query the database, decoding directly from SQLite's buffer
+  RasterDecoder decoder(*this);
+  QsErrorType err = readPool_->TsReadDataBuffer(faceId, nodeId, decoder);
 
   if (err == QS_IS_OK)
   {
-    if (currentRasterSize > 0)
+    if (decoder.found())
     {
-      osg::ref_ptr<osg::Image> image;
-      if (decodeRaster_(rasterFormat_, (const char*)buf, currentRasterSize, image))
+      osg::ref_ptr<osg::Image> image = decoder.image();
+      if (decoder.decoded())
       {
 
 #if DUMP_HF // Debugging - write out each raw image tile
@@ -362,23 +544,9 @@ osg::HeightField* DBTileSource::createHeightField(const TileKey& key, ProgressCa
           const double yMax = extents_[faceId].maxY - qppy;
 
           // Write "no data" to all pixels outside the reported extent.
-          const double colWidth = tileWidth / (result->getNumColumns() - 1);
-          const double rowHeight = tileHeight / (result->getNumRows() - 1);
-
-          for (unsigned int row = 0; row < result->getNumRows(); ++row)
-          {
-            const double y = tileMin.y() + row * rowHeight;
-
-            for (unsigned int col = 0; col < result->getNumColumns(); ++col)
-            {
-              const double x = tileMin.x() + col * colWidth;
-
-              if (x < xMin || x > xMax || y < yMin || y >  yMax)
-              {
-                result->setHeight(col, row, NO_DATA_VALUE);
-              }
-            }
-          }
+          const BorderMask mask(result->getNumColumns(), result->getNumRows(),
+            tileMin.x(), tileMin.y(), tileWidth, tileHeight, xMin, xMax, yMin, yMax);
+          mask.fill(*result, NO_DATA_VALUE);
         }
 
 #if DUMP_HF // Debugging - write out each raw image tile
@@ -399,6 +567,7 @@ osg::HeightField* DBTileSource::createHeightField(const TileKey& key, ProgressCa
     {
       // Raster size of 0 means no tile in the db
       result = NULL;
+      out_absent = true;
     }
   }
   else
@@ -406,13 +575,13 @@ osg::HeightField* DBTileSource::createHeightField(const TileKey& key, ProgressCa
     OE_WARN << "Failed to read heightfield from " << key.str() << std::endl;
   }
 
-  delete [] buf;
   return result.release();
 }
 
-osg::Image* DBTileSource::createImage_(const TileKey& key, bool isHeightField)
+osg::Image* DBTileSource::createImage_(const TileKey& key, bool isHeightField, bool& out_absent)
 {
-  if (!db_)
+  out_absent = false;
+  if (!readPool_)
     return NULL;
 
   osg::ref_ptr<osg::Image> result;
@@ -428,37 +597,28 @@ osg::Image* DBTileSource::createImage_(const TileKey& key, bool isHeightField)
   {
     // If there is no data on that face, return nothing.
     OE_DEBUG << LC << "Face " << static_cast<int>(faceId) << " is invalid; returning empty image" << std::endl;
+    out_absent = true;
     return NULL;
   }
 
   if (key.getLevelOfDetail() > static_cast<unsigned int>(deepLevel_))
   {
     // Hopefully this doesn't happen since we called setMaxDataLevel, but you never know
+    out_absent = true;
     return NULL;
   }
 
-  // Query the database
-  TextureDataType* buf = NULL;
-  uint32_t bufSize =0;
-  uint32_t currentRasterSize =0;
-
-  QsErrorType err = dbUtil_.TsReadDataBuffer(
-    db_,
-    pathname_,
-    "default",
-    faceId,
-    nodeId,
-    &buf,
-    &bufSize,
-    &currentRasterSize,
-    false, true);             // AllowLocalDB: no, we created it ourselves
+  // Query the database, decoding directly from SQLite's buffer
+  RasterDecoder decoder(*this);
+  QsErrorType err = readPool_->TsReadDataBuffer(faceId, nodeId, decoder, true);
 
   if (err == QS_IS_OK)
   {
-    if (currentRasterSize > 0)
+    if (decoder.found())
     {
-      if (decodeRaster_(rasterFormat_, (const char*)buf, currentRasterSize, result))
+      if (decoder.decoded())
       {
+        result = decoder.image();
 #if SDK_OSGEARTH_VERSION_LESS_OR_EQUAL(1,6,0)
         // Resize if necessary:
         if (options_.tileSize().isSet() && options_.tileSize().value() >= 0)
@@ -498,29 +658,9 @@ osg::Image* DBTileSource::createImage_(const TileKey& key, bool isHeightField)
           const double yMin = extents_[faceId].minY + qppy;
           const double yMax = extents_[faceId].maxY - qppy;
 
-          osgEarth::ImageUtils::PixelReader read(result.get());
-          osgEarth::ImageUtils::PixelWriter write(result.get());
-
           // Write "no data" to all pixels outside the reported extent.
-          const double colw = tileWidth / (resultS - 1);
-          const double rowh = tileHeight / (resultT - 1);
-
-          for (unsigned int row = 0; row < resultS; ++row)
-          {
-            const double y = tileMin.y() + row * rowh;
-
-            for (unsigned int col = 0; col < resultT; ++col)
-            {
-              const double x = tileMin.x() + col * colw;
-
-              if (x < xMin || x > xMax || y < yMin || y > yMax)
-              {
-                osg::Vec4f pixel = read(col, row);
-                pixel.a() = 0.0f;
-                write(pixel, col, row);
-              }
-            }
-          }
+          const BorderMask mask(resultS, resultT, tileMin.x(), tileMin.y(), tileWidth, tileHeight, xMin, xMax, yMin, yMax);
+          mask.clearAlpha(*result);
         }
       }
       else
@@ -533,6 +673,7 @@ osg::Image* DBTileSource::createImage_(const TileKey& key, bool isHeightField)
       // Raster size of 0 means no tile in the db
       //OE_DEBUG << "No image in the database for key " << key->str() << std::endl;
       result = NULL;
+      out_absent = true;
     }
   }
   else
@@ -541,7 +682,6 @@ osg::Image* DBTileSource::createImage_(const TileKey& key, bool isHeightField)
     OE_WARN << "Failed to read image from " << key.str() << std::endl;
   }
 
-  delete [] buf;
   return result.release();
 }
 
@@ -592,8 +732,8 @@ void makeImage(int size, GLenum internalFormat, GLenum pixelFormat, GLenum type,
 // Uses one of OSG's native ReaderWriter's to read image data from a buffer.
 static bool readNativeImage(osgDB::ReaderWriter* reader, const char* inBuf, int inBufLen, osg::ref_ptr<osg::Image>& outImage)
 {
-  std::string inString(inBuf, inBufLen);
-  std::istringstream inStream(inString);
+  MemoryStreamBuf streamBuf(inBuf, inBufLen);
+  std::istream inStream(&streamBuf);
   osgDB::ReaderWriter::ReadResult result = reader->readImage(inStream);
   outImage = result.getImage();
   if (result.error() || !outImage.valid())
@@ -0,0 +1,130 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+#include "osg/CopyOp"
+#include "OpenThreads/ScopedLock"
+#include "DecodedTileCache.h"
+
+using namespace simVis_db;
+
+DecodedTileCache::DecodedTileCache(size_t maxSizeBytes)
+  : maxSizeBytes_(maxSizeBytes)
+{
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.evictions = 0;
+  stats_.numTiles = 0;
+  stats_.sizeBytes = 0;
+}
+
+DecodedTileCache::~DecodedTileCache()
+{
+}
+
+bool DecodedTileCache::get(const std::string& key, osg::ref_ptr<osg::Object>& tile)
+{
+  osg::ref_ptr<osg::Object> cached;
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    std::map<std::string, EntryList::iterator>::const_iterator i = entriesByKey_.find(key);
+    if (i == entriesByKey_.end())
+    {
+      ++stats_.misses;
+      tile = NULL;
+      return false;
+    }
+    ++stats_.hits;
+    // Move to the front of the LRU list; iterators remain valid
+    entries_.splice(entries_.begin(), entries_, i->second);
+    cached = i->second->tile;
+  }
+  // Copy outside the lock; the cached tile itself is never modified
+  tile = cached.valid() ? cached->clone(osg::CopyOp::DEEP_COPY_ALL) : NULL;
+  return true;
+}
+
+bool DecodedTileCache::contains(const std::string& key) const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return entriesByKey_.find(key) != entriesByKey_.end();
+}
+
+void DecodedTileCache::insert(const std::string& key, const osg::Object* tile, size_t sizeBytes)
+{
+  if (tile == NULL)
+    sizeBytes = EMPTY_ENTRY_BYTES;
+  // Tiles larger than the whole cache are not worth keeping
+  if (sizeBytes > maxSizeBytes_)
+    return;
+
+  Entry entry;
+  entry.key = key;
+  if (tile != NULL)
+    entry.tile = tile->clone(osg::CopyOp::DEEP_COPY_ALL);
+  entry.sizeBytes = sizeBytes;
+
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  std::map<std::string, EntryList::iterator>::iterator i = entriesByKey_.find(key);
+  if (i != entriesByKey_.end())
+  {
+    stats_.sizeBytes -= i->second->sizeBytes;
+    entries_.erase(i->second);
+    entriesByKey_.erase(i);
+  }
+  entries_.push_front(entry);
+  entriesByKey_[key] = entries_.begin();
+  stats_.sizeBytes += sizeBytes;
+  evict_();
+  stats_.numTiles = static_cast<unsigned int>(entriesByKey_.size());
+}
+
+void DecodedTileCache::evict_()
+{
+  while (stats_.sizeBytes > maxSizeBytes_ && !entries_.empty())
+  {
+    const Entry& last = entries_.back();
+    stats_.sizeBytes -= last.sizeBytes;
+    entriesByKey_.erase(last.key);
+    entries_.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+void DecodedTileCache::clear()
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  entries_.clear();
+  entriesByKey_.clear();
+  stats_.numTiles = 0;
+  stats_.sizeBytes = 0;
+}
+
+DecodedTileCache::Statistics DecodedTileCache::statistics() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return stats_;
+}
+
+size_t DecodedTileCache::maxSizeBytes() const
+{
+  return maxSizeBytes_;
+}
@@ -20,6 +20,7 @@
  *
  */
 
+#include <cassert>
 #include <sstream>
 
 #ifndef USE_SIMDIS_SDK
@@ -31,6 +32,7 @@
 #include "simCore/Time/Utils.h"
 #endif
 
+#include "OpenThreads/ScopedLock"
 #include "swapbytes.h"
 #include "QSCommon.h"
 #include "SQLiteDataBaseReadUtil.h"
@@ -46,6 +48,10 @@ using namespace simVis_db;
 namespace
 {
   static const int gMaxBufferSize = 20000000;
+  /** Large enough for a face index and a 96 bit node ID */
+  static const int gMaxIdBlobSize = 32;
+  /** Column of the data buffer in rows of a sets table: (id, data) */
+  static const int gDataColumn = 1;
 
   std::string printExtendedErrorMessage(sqlite3* sqlite3Db)
   {
@@ -111,7 +117,8 @@ void CloseSqliteDBs(vSqlite3* given)
 
 //=====================================================================================
 SQLiteDataBaseReadUtil::SQLiteDataBaseReadUtil()
-  : textureSetSelectCommand_(""),
+  : cacheSizePages_(QS_DEFAULT_CACHE_SIZE_PAGES),
+    textureSetSelectCommand_(""),
     tsInsertFileIdData_(2),
     tsInsertSetTextureSetName_(1),
     tsInsertSetIdRasterFormat_(2),
@@ -147,6 +154,46 @@ SQLiteDataBaseReadUtil::~SQLiteDataBaseReadUtil()
 {
 }
 
+//-------------------------------------------------------------------------------------
+void SQLiteDataBaseReadUtil::SetCacheSizePages(int cacheSizePages)
+{
+  cacheSizePages_ = cacheSizePages;
+}
+
+//-------------------------------------------------------------------------------------
+int SQLiteDataBaseReadUtil::CacheSizePages() const
+{
+  return cacheSizePages_;
+}
+
+//-------------------------------------------------------------------------------------
+std::string SQLiteDataBaseReadUtil::TsReadDataBufferCommand(const std::string& dataTableName) const
+{
+  string sqlCommand = textureSetSelectFileCommand1_;
+  sqlCommand.append(dataTableName);
+  sqlCommand.append(textureSetSelectFileCommand2_);
+  return sqlCommand;
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteDataBaseReadUtil::PackIdBlob(const FaceIndexType& faceIndex, const QSNodeId& nodeID, uint8_t* idBlob) const
+{
+  bewrite(idBlob, &faceIndex);
+  nodeID.Pack(idBlob+sizeof(FaceIndexType));
+}
+
+//-------------------------------------------------------------------------------------
+int SQLiteDataBaseReadUtil::SizeOfIdBlob() const
+{
+  return sizeOfIdBlob_;
+}
+
+//-------------------------------------------------------------------------------------
+std::string SQLiteDataBaseReadUtil::ExtendedErrorMessage(sqlite3* sqlite3Db)
+{
+  return printExtendedErrorMessage(sqlite3Db);
+}
+
 //-------------------------------------------------------------------------------------
 QsErrorType SQLiteDataBaseReadUtil::OpenDataBaseFile(const std::string& dbFileName,
                                                      sqlite3** sqlite3Db,
@@ -178,7 +225,9 @@ QsErrorType SQLiteDataBaseReadUtil::OpenDataBaseFile(const std::string& dbFileNa
     cerr << "OpenDataBaseFile sqlite3_open_v2 Error: " << dbFileName << "\n" << printExtendedErrorMessage(*sqlite3Db);
     return QS_IS_UNABLE_TO_OPEN_DB;
   }
-  if (sqlite3_exec(*sqlite3Db, "PRAGMA CACHE_SIZE=100;", NULL, NULL, NULL) != SQLITE_OK)
+  std::stringstream cacheSizeCommand;
+  cacheSizeCommand << "PRAGMA CACHE_SIZE=" << cacheSizePages_ << ";";
+  if (sqlite3_exec(*sqlite3Db, cacheSizeCommand.str().c_str(), NULL, NULL, NULL) != SQLITE_OK)
   {
     cerr << "Unable to set SQLite cache size " << dbFileName << "\n";
     cerr << printExtendedErrorMessage(*sqlite3Db);
@@ -225,10 +274,7 @@ QsErrorType SQLiteDataBaseReadUtil::TsReadDataBuffer(sqlite3* sqlite3Db,
       return tmpReturnValue;
   }
 
-  string sqlCommand;
-  sqlCommand = textureSetSelectFileCommand1_;
-  sqlCommand.append(dataTableName);
-  sqlCommand.append(textureSetSelectFileCommand2_);
+  const string sqlCommand = TsReadDataBufferCommand(dataTableName);
 
   // prepares the statement
   sqlite3_stmt* stmt = 0;
@@ -249,8 +295,7 @@ QsErrorType SQLiteDataBaseReadUtil::TsReadDataBuffer(sqlite3* sqlite3Db,
 
   // binds id
   uint8_t* idBlob = new uint8_t[sizeOfIdBlob_];
-  bewrite(idBlob, &faceIndex);
-  nodeID.Pack(idBlob+sizeof(FaceIndexType));
+  PackIdBlob(faceIndex, nodeID, idBlob);
   returnValue = sqlite3_bind_blob(stmt, 1, idBlob, sizeOfIdBlob_, SQLITE_TRANSIENT);
   if (returnValue != SQLITE_OK && displayErrorMessage)
   {
@@ -402,3 +447,144 @@ QsErrorType SQLiteDataBaseReadUtil::TsGetSetFromListOfSetsTable(sqlite3* sqlite3
   return otherReturnValue;
 }
 
+
+//=====================================================================================
+SQLiteReadConnectionPool::SQLiteReadConnectionPool(const std::string& dbFileName,
+                                                   const std::string& dataTableName,
+                                                   int cacheSizePages)
+  : dbFileName_(dbFileName)
+{
+  dbUtil_.SetCacheSizePages(cacheSizePages);
+  selectCommand_ = dbUtil_.TsReadDataBufferCommand(dataTableName);
+}
+
+//-------------------------------------------------------------------------------------
+SQLiteReadConnectionPool::~SQLiteReadConnectionPool()
+{
+  // All reads must be complete before the pool is destroyed
+  assert(idle_.size() == all_.size());
+  for (std::vector<Connection*>::const_iterator iter = all_.begin(); iter != all_.end(); ++iter)
+  {
+    sqlite3_finalize((*iter)->selectStmt);
+    sqlite3_close((*iter)->db);
+    delete *iter;
+  }
+}
+
+//-------------------------------------------------------------------------------------
+size_t SQLiteReadConnectionPool::NumConnections() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return all_.size();
+}
+
+//-------------------------------------------------------------------------------------
+QsErrorType SQLiteReadConnectionPool::Acquire_(Connection*& connection, bool displayErrorMessage)
+{
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    if (!idle_.empty())
+    {
+      connection = idle_.back();
+      idle_.pop_back();
+      return QS_IS_OK;
+    }
+  }
+
+  // Open outside the lock; each connection is only used by one thread at a time, so SQLite's own mutex is not needed
+  sqlite3* db = NULL;
+  QsErrorType rv = dbUtil_.OpenDataBaseFile(dbFileName_, &db, SQLITE_OPEN_READONLY|SQLITE_OPEN_NOMUTEX);
+  if (rv != QS_IS_OK)
+  {
+    if (db != NULL) sqlite3_close(db);
+    return rv;
+  }
+  sqlite3_stmt* stmt = NULL;
+  const int returnValue = sqlite3_prepare_v2(db, selectCommand_.c_str(), static_cast<int>(selectCommand_.length()), &stmt, NULL);
+  if (returnValue != SQLITE_OK)
+  {
+    if (displayErrorMessage && (returnValue != SQLITE_BUSY && returnValue != SQLITE_LOCKED))
+    {
+      cerr << "SQLiteReadConnectionPool sqlite3_prepare_v2 Error(" << returnValue << "): " << dbFileName_ << "\n" << printExtendedErrorMessage(db);
+    }
+    if (stmt != NULL) sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    if ((returnValue == SQLITE_BUSY) ||
+       (returnValue == SQLITE_LOCKED))
+      return QS_IS_BUSY;
+    return QS_IS_PREPARE_ERROR;
+  }
+
+  connection = new Connection;
+  connection->db = db;
+  connection->selectStmt = stmt;
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  all_.push_back(connection);
+  return QS_IS_OK;
+}
+
+//-------------------------------------------------------------------------------------
+void SQLiteReadConnectionPool::Release_(Connection* connection)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  idle_.push_back(connection);
+}
+
+//-------------------------------------------------------------------------------------
+QsErrorType SQLiteReadConnectionPool::TsReadDataBuffer(const FaceIndexType& faceIndex,
+                                                       const QSNodeId& nodeID,
+                                                       TileBlobVisitor& visitor,
+                                                       bool displayErrorMessage)
+{
+  Connection* connection = NULL;
+  QsErrorType otherReturnValue = Acquire_(connection, displayErrorMessage);
+  if (otherReturnValue != QS_IS_OK)
+    return otherReturnValue;
+
+  // binds id
+  uint8_t idBlob[gMaxIdBlobSize];
+  assert(dbUtil_.SizeOfIdBlob() <= gMaxIdBlobSize);
+  dbUtil_.PackIdBlob(faceIndex, nodeID, idBlob);
+  int returnValue = sqlite3_bind_blob(connection->selectStmt, 1, idBlob, dbUtil_.SizeOfIdBlob(), SQLITE_TRANSIENT);
+  if (returnValue != SQLITE_OK && displayErrorMessage)
+  {
+    cerr << "SQLiteReadConnectionPool sqlite3_bind_blob Error(" << returnValue << "): " << dbFileName_ << "\n" << printExtendedErrorMessage(connection->db);
+  }
+
+  // executes the statement
+  returnValue = sqlite3_step(connection->selectStmt);
+  if (returnValue == SQLITE_ROW)
+  {
+    // Blob pointer must be retrieved before its size; both stay valid until the statement is reset
+    const uint8_t* data = static_cast<const uint8_t*>(sqlite3_column_blob(connection->selectStmt, gDataColumn));
+    const int dataSize = sqlite3_column_bytes(connection->selectStmt, gDataColumn);
+    if (data != NULL && dataSize > 0 && dataSize <= gMaxBufferSize)
+      visitor.Visit(data, static_cast<uint32_t>(dataSize));
+    else
+      visitor.Visit(NULL, 0);
+    otherReturnValue = QS_IS_OK;
+  }
+  else if (returnValue == SQLITE_DONE)
+  {
+    visitor.Visit(NULL, 0);
+    otherReturnValue = QS_IS_OK;
+  }
+  else if ((returnValue == SQLITE_BUSY) || (returnValue == SQLITE_LOCKED))
+  {
+    otherReturnValue = QS_IS_BUSY;
+  }
+  else
+  {
+    if (displayErrorMessage)
+    {
+      cerr << "SQLiteReadConnectionPool sqlite3_step Error(" << returnValue << "): " << dbFileName_ << "\n";
+      cerr << "not done (" << nodeID.FormatAsHex().c_str() << ") " << printExtendedErrorMessage(connection->db);
+    }
+    otherReturnValue = QS_IS_UNABLE_TO_READ_DATA_BUFFER;
+  }
+
+  // Reset keeps the compiled statement for the next read on this connection
+  sqlite3_reset(connection->selectStmt);
+  Release_(connection);
+  return otherReturnValue;
+}
@@ -0,0 +1,149 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
+#include "TilePrefetcher.h"
+
+using namespace simVis_db;
+
+/** Worker thread that loads queued tiles until the prefetcher shuts down */
+class TilePrefetcher::Worker : public OpenThreads::Thread
+{
+public:
+  explicit Worker(TilePrefetcher& owner)
+    : owner_(owner)
+  {
+  }
+
+  virtual void run()
+  {
+    Request request;
+    while (owner_.pop_(request))
+      owner_.load_(request);
+  }
+
+private:
+  TilePrefetcher& owner_;
+};
+
+// --------------------------------------------------------------------------
+
+TilePrefetcher::TilePrefetcher(Loader& source, unsigned int numThreads, size_t maxQueued)
+  : source_(source),
+    maxQueued_(maxQueued),
+    done_(false),
+    numLoaded_(0)
+{
+  if (numThreads == 0)
+    numThreads = 1;
+  for (unsigned int k = 0; k < numThreads; ++k)
+  {
+    Worker* worker = new Worker(*this);
+    workers_.push_back(worker);
+    worker->start();
+  }
+}
+
+TilePrefetcher::~TilePrefetcher()
+{
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    done_ = true;
+    queue_.clear();
+  }
+  condition_.broadcast();
+  for (std::vector<Worker*>::const_iterator i = workers_.begin(); i != workers_.end(); ++i)
+  {
+    (*i)->join();
+    delete *i;
+  }
+}
+
+void TilePrefetcher::requestAround(const osgEarth::TileKey& key, bool isHeightField, unsigned int maxLevel)
+{
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    if (done_)
+      return;
+    // Neighbors first: panning is more common than zooming in
+    push_(key.createNeighborKey(-1, 0), isHeightField);
+    push_(key.createNeighborKey(1, 0), isHeightField);
+    push_(key.createNeighborKey(0, -1), isHeightField);
+    push_(key.createNeighborKey(0, 1), isHeightField);
+    if (key.getLevelOfDetail() < maxLevel)
+    {
+      for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+        push_(key.createChildKey(quadrant), isHeightField);
+    }
+  }
+  condition_.broadcast();
+}
+
+void TilePrefetcher::push_(const osgEarth::TileKey& key, bool isHeightField)
+{
+  if (!key.valid())
+    return;
+  // A tile that is already queued moves to the back, as the most recent request, instead of being queued twice
+  for (std::deque<Request>::iterator i = queue_.begin(); i != queue_.end(); ++i)
+  {
+    if (i->isHeightField == isHeightField && i->key == key)
+    {
+      queue_.erase(i);
+      break;
+    }
+  }
+  Request request;
+  request.key = key;
+  request.isHeightField = isHeightField;
+  queue_.push_back(request);
+  while (queue_.size() > maxQueued_)
+    queue_.pop_front();
+}
+
+bool TilePrefetcher::pop_(Request& request)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  while (queue_.empty() && !done_)
+    condition_.wait(&mutex_);
+  if (done_)
+    return false;
+  // Most recent requests first; they are closest to what the camera is looking at
+  request = queue_.back();
+  queue_.pop_back();
+  return true;
+}
+
+void TilePrefetcher::load_(const Request& request)
+{
+  if (source_.prefetchTile(request.key, request.isHeightField))
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    ++numLoaded_;
+  }
+}
+
+unsigned int TilePrefetcher::numLoaded() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return numLoaded_;
+}
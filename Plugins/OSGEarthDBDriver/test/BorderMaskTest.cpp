@@ -0,0 +1,278 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+/**
+ * Compares the image and height field masking that DBTileSource runs through BorderMask against
+ * the per-pixel PixelReader/PixelWriter loop it used before, for every layout BorderMask writes
+ * directly and for layouts that use the generic path.  Also reports the time of both methods on
+ * a 256x256 RGBA tile.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include "osg/Image"
+#include "osg/Shape"
+#include "osg/ref_ptr"
+#include "osgEarth/ImageUtils"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Time/Utils.h"
+#include "BorderMask.h"
+
+using namespace simVis_db;
+
+namespace
+{
+
+/** Height written outside the extents */
+const float NO_DATA = -32767.f;
+
+/** Tile and extents of one test case, in QS units */
+struct Extents
+{
+  double tileMinX;
+  double tileMinY;
+  double tileWidth;
+  double tileHeight;
+  double xMin;
+  double xMax;
+  double yMin;
+  double yMax;
+};
+
+/** The per-pixel border test DBTileSource used before BorderMask */
+bool referenceMasked(const Extents& e, unsigned int width, unsigned int height, unsigned int col, unsigned int row)
+{
+  const double colw = e.tileWidth / (width - 1);
+  const double rowh = e.tileHeight / (height - 1);
+  const double y = e.tileMinY + row * rowh;
+  const double x = e.tileMinX + col * colw;
+  return (x < e.xMin || x > e.xMax || y < e.yMin || y > e.yMax);
+}
+
+/** The image masking DBTileSource used before BorderMask */
+void referenceClearAlpha(const Extents& e, osg::Image& image)
+{
+  osgEarth::ImageUtils::PixelReader read(&image);
+  osgEarth::ImageUtils::PixelWriter write(&image);
+  const unsigned int width = static_cast<unsigned int>(image.s());
+  const unsigned int height = static_cast<unsigned int>(image.t());
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+    {
+      if (referenceMasked(e, width, height, col, row))
+      {
+        osg::Vec4f pixel = read(col, row);
+        pixel.a() = 0.0f;
+        write(pixel, col, row);
+      }
+    }
+  }
+}
+
+/** The height field masking DBTileSource used before BorderMask */
+void referenceFill(const Extents& e, osg::HeightField& heightField)
+{
+  const unsigned int width = heightField.getNumColumns();
+  const unsigned int height = heightField.getNumRows();
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+    {
+      if (referenceMasked(e, width, height, col, row))
+        heightField.setHeight(col, row, NO_DATA);
+    }
+  }
+}
+
+double randomDouble(double low, double high)
+{
+  return low + (high - low) * (static_cast<double>(rand()) / RAND_MAX);
+}
+
+/** Random extents that overlap the tile in various ways, including not at all */
+Extents randomExtents()
+{
+  Extents e;
+  e.tileMinX = randomDouble(0, 1000);
+  e.tileMinY = randomDouble(0, 1000);
+  e.tileWidth = randomDouble(1, 100);
+  e.tileHeight = e.tileWidth;
+  e.xMin = e.tileMinX + randomDouble(-0.5, 1.2) * e.tileWidth;
+  e.xMax = e.xMin + randomDouble(0, 1.5) * e.tileWidth;
+  e.yMin = e.tileMinY + randomDouble(-0.5, 1.2) * e.tileHeight;
+  e.yMax = e.yMin + randomDouble(0, 1.5) * e.tileHeight;
+  return e;
+}
+
+BorderMask makeMask(const Extents& e, unsigned int width, unsigned int height)
+{
+  return BorderMask(width, height, e.tileMinX, e.tileMinY, e.tileWidth, e.tileHeight, e.xMin, e.xMax, e.yMin, e.yMax);
+}
+
+/** Returns an opaque image with a color pattern; rows are padded to 4 bytes to exercise the row step */
+osg::Image* makeImage(unsigned int width, unsigned int height, GLenum pixelFormat, GLenum dataType)
+{
+  osg::Image* image = new osg::Image;
+  image->allocateImage(width, height, 1, pixelFormat, dataType, 4);
+  osgEarth::ImageUtils::PixelWriter write(image);
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+    {
+      const osg::Vec4f color(((col * 37 + row) % 256) / 255.f, ((row * 59 + col) % 256) / 255.f, ((col + row) % 256) / 255.f, 1.f);
+      write(color, col, row);
+    }
+  }
+  return image;
+}
+
+/**
+ * Masks one image with BorderMask and one with the reference loop, then compares them through
+ * PixelReader.  Alpha must match exactly; the direct paths do not round trip colors through
+ * floats, so colors may differ from the reference by the quantization step in colorTolerance.
+ */
+int testImage(const Extents& e, unsigned int width, unsigned int height, GLenum pixelFormat, GLenum dataType, float colorTolerance)
+{
+  osg::ref_ptr<osg::Image> expected = makeImage(width, height, pixelFormat, dataType);
+  osg::ref_ptr<osg::Image> actual = makeImage(width, height, pixelFormat, dataType);
+  referenceClearAlpha(e, *expected);
+  makeMask(e, width, height).clearAlpha(*actual);
+
+  osgEarth::ImageUtils::PixelReader readExpected(expected.get());
+  osgEarth::ImageUtils::PixelReader readActual(actual.get());
+  int rv = 0;
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+    {
+      const osg::Vec4f expectedPixel = readExpected(col, row);
+      const osg::Vec4f actualPixel = readActual(col, row);
+      bool same = (expectedPixel.a() == actualPixel.a());
+      for (int k = 0; k < 3; ++k)
+        same = same && (std::fabs(expectedPixel[k] - actualPixel[k]) <= colorTolerance);
+      if (!same)
+        ++rv;
+    }
+  }
+  return SDK_ASSERT(rv == 0);
+}
+
+int testHeightField(const Extents& e, unsigned int width, unsigned int height)
+{
+  osg::ref_ptr<osg::HeightField> expected = new osg::HeightField;
+  expected->allocate(width, height);
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+      expected->setHeight(col, row, static_cast<float>(row * width + col));
+  }
+  osg::ref_ptr<osg::HeightField> actual = new osg::HeightField(*expected, osg::CopyOp::DEEP_COPY_ALL);
+  referenceFill(e, *expected);
+  makeMask(e, width, height).fill(*actual, NO_DATA);
+
+  int rv = 0;
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    for (unsigned int col = 0; col < width; ++col)
+    {
+      if (expected->getHeight(col, row) != actual->getHeight(col, row))
+        ++rv;
+    }
+  }
+  return SDK_ASSERT(rv == 0);
+}
+
+int testMatchesReference()
+{
+  int rv = 0;
+  srand(1234);
+  const float UB_STEP = 1.f / 255.f + 1e-6f;
+  const float STEP_5551 = 1.f / 31.f + 1e-6f;
+  const unsigned int sizes[] = { 1, 2, 3, 17, 128, 256 };
+  for (unsigned int sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(sizes[0]); ++sizeIndex)
+  {
+    const unsigned int size = sizes[sizeIndex];
+    for (int trial = 0; trial < 20; ++trial)
+    {
+      const Extents e = randomExtents();
+      // Direct paths
+      rv += testImage(e, size, size, GL_RGBA, GL_UNSIGNED_BYTE, UB_STEP);
+      rv += testImage(e, size, size, GL_BGRA, GL_UNSIGNED_BYTE, UB_STEP);
+      rv += testImage(e, size, size, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, UB_STEP);
+      rv += testImage(e, size, size, GL_ALPHA, GL_UNSIGNED_BYTE, UB_STEP);
+      rv += testImage(e, size, size, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, STEP_5551);
+      // No alpha, left unchanged
+      rv += testImage(e, size, size, GL_RGB, GL_UNSIGNED_BYTE, UB_STEP);
+      // Generic PixelReader/PixelWriter path, which must match exactly
+      rv += testImage(e, size, size, GL_RGBA, GL_FLOAT, 0.f);
+      rv += testImage(e, size, size, GL_RGBA, GL_UNSIGNED_SHORT, 0.f);
+      rv += testHeightField(e, size, size);
+    }
+  }
+
+  // Extents covering the whole tile mask nothing; extents outside the tile mask everything
+  Extents e = { 0, 0, 10, 10, -1, 11, -1, 11 };
+  rv += SDK_ASSERT(makeMask(e, 16, 16).isEmpty());
+  rv += testImage(e, 16, 16, GL_RGBA, GL_UNSIGNED_BYTE, UB_STEP);
+  e.xMin = 20;
+  e.xMax = 30;
+  const BorderMask outside = makeMask(e, 16, 16);
+  rv += SDK_ASSERT(!outside.isEmpty());
+  rv += SDK_ASSERT(outside.isMasked(0, 0) && outside.isMasked(15, 15));
+  rv += testImage(e, 16, 16, GL_RGBA, GL_UNSIGNED_BYTE, UB_STEP);
+  rv += testHeightField(e, 16, 16);
+  return rv;
+}
+
+int testPerformance()
+{
+  const unsigned int size = 256;
+  const int iterations = 100;
+  // Typical case: the data edge cuts through the tile
+  const Extents e = { 0, 0, 100, 100, 30.5, 200, -10, 60.25 };
+  osg::ref_ptr<osg::Image> image = makeImage(size, size, GL_RGBA, GL_UNSIGNED_BYTE);
+
+  const double startReference = simCore::getSystemTime();
+  for (int k = 0; k < iterations; ++k)
+    referenceClearAlpha(e, *image);
+  const double referenceSeconds = simCore::getSystemTime() - startReference;
+
+  const double startMask = simCore::getSystemTime();
+  for (int k = 0; k < iterations; ++k)
+    makeMask(e, size, size).clearAlpha(*image);
+  const double maskSeconds = simCore::getSystemTime() - startMask;
+
+  std::cout << "Border mask of " << iterations << " 256x256 RGBA tiles: per-pixel PixelReader/PixelWriter " << referenceSeconds
+    << " s, row spans " << maskSeconds << " s" << std::endl;
+  return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  int rv = testMatchesReference();
+  rv += testPerformance();
+  std::cout << "BorderMaskTest " << ((rv == 0) ? "passed" : "failed") << std::endl;
+  return rv;
+}
@@ -0,0 +1,264 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+/**
+ * Tile read throughput benchmark for the .db driver.  Creates a synthetic .db file, then reads
+ * random tiles from several threads, first through a single shared connection with
+ * SQLiteDataBaseReadUtil::TsReadDataBuffer() as the driver used to, then through a
+ * SQLiteReadConnectionPool.  Both methods must return identical data.
+ */
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "OpenThreads/Thread"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Time/Utils.h"
+#include "SQLiteDataBaseReadUtil.h"
+
+using namespace simVis_db;
+
+namespace
+{
+
+static const char* DB_FILE_NAME = "DBReadBenchmark.db";
+static const char* TABLE_NAME = "default";
+static const uint32_t NUM_TILES = 2048;
+static const uint32_t TILE_SIZE = 16384;
+static const uint32_t READS_PER_THREAD = 20000;
+static const unsigned int NUM_THREADS = 4;
+
+/** Deterministic contents for a tile, so that readers can verify what they read */
+uint8_t tileByte(uint32_t tile, uint32_t offset)
+{
+  return static_cast<uint8_t>((tile * 131 + offset * 7) & 0xff);
+}
+
+/** Sum of the bytes of a tile, at a few sample offsets */
+uint64_t checksum(const uint8_t* data, uint32_t dataSize)
+{
+  uint64_t sum = dataSize;
+  for (uint32_t k = 0; k < dataSize; k += 509)
+    sum += data[k];
+  return sum;
+}
+
+/** Writes the synthetic database; returns 0 on success */
+int createDatabase()
+{
+  std::remove(DB_FILE_NAME);
+  sqlite3* db = NULL;
+  if (sqlite3_open_v2(DB_FILE_NAME, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
+  {
+    sqlite3_close(db);
+    return 1;
+  }
+  int rv = 0;
+  rv += SDK_ASSERT(sqlite3_exec(db, "CREATE TABLE \"default\" (id BLOB PRIMARY KEY, data BLOB);", NULL, NULL, NULL) == SQLITE_OK);
+  rv += SDK_ASSERT(sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK);
+  sqlite3_stmt* stmt = NULL;
+  rv += SDK_ASSERT(sqlite3_prepare_v2(db, "INSERT INTO \"default\" VALUES (?, ?);", -1, &stmt, NULL) == SQLITE_OK);
+
+  SQLiteDataBaseReadUtil util;
+  std::vector<uint8_t> idBlob(util.SizeOfIdBlob());
+  std::vector<uint8_t> data(TILE_SIZE);
+  for (uint32_t tile = 0; tile < NUM_TILES && rv == 0; ++tile)
+  {
+    util.PackIdBlob(0, QSNodeId(tile), &idBlob[0]);
+    for (uint32_t k = 0; k < TILE_SIZE; ++k)
+      data[k] = tileByte(tile, k);
+    sqlite3_bind_blob(stmt, 1, &idBlob[0], static_cast<int>(idBlob.size()), SQLITE_TRANSIENT);
+    sqlite3_bind_blob(stmt, 2, &data[0], static_cast<int>(data.size()), SQLITE_TRANSIENT);
+    rv += SDK_ASSERT(sqlite3_step(stmt) == SQLITE_DONE);
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+  rv += SDK_ASSERT(sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL) == SQLITE_OK);
+  sqlite3_close(db);
+  return rv;
+}
+
+/** Tile visited by a reader thread; cycles through the tiles in a thread-specific order */
+uint32_t tileForRead(unsigned int thread, uint32_t read)
+{
+  return (read * 2654435761u + thread * 97u) % NUM_TILES;
+}
+
+/** Expected checksum of all reads done by one thread */
+uint64_t expectedChecksum(unsigned int thread)
+{
+  std::vector<uint8_t> data(TILE_SIZE);
+  uint64_t sum = 0;
+  for (uint32_t read = 0; read < READS_PER_THREAD; ++read)
+  {
+    const uint32_t tile = tileForRead(thread, read);
+    for (uint32_t k = 0; k < TILE_SIZE; ++k)
+      data[k] = tileByte(tile, k);
+    sum += checksum(&data[0], TILE_SIZE);
+  }
+  return sum;
+}
+
+/** Reads through one FULLMUTEX connection shared by all threads, copying each tile */
+class SharedConnectionReader : public OpenThreads::Thread
+{
+public:
+  SharedConnectionReader(const SQLiteDataBaseReadUtil& util, sqlite3* db, unsigned int thread)
+    : util_(util), db_(db), thread_(thread), sum(0), errors(0)
+  {
+  }
+
+  virtual void run()
+  {
+    TextureDataType* buf = NULL;
+    uint32_t bufSize = 0;
+    for (uint32_t read = 0; read < READS_PER_THREAD; ++read)
+    {
+      uint32_t rasterSize = 0;
+      if (util_.TsReadDataBuffer(db_, DB_FILE_NAME, TABLE_NAME, 0, QSNodeId(tileForRead(thread_, read)), &buf, &bufSize, &rasterSize, false) != QS_IS_OK)
+        ++errors;
+      else
+        sum += checksum(buf, rasterSize);
+    }
+    delete [] buf;
+  }
+
+private:
+  const SQLiteDataBaseReadUtil& util_;
+  sqlite3* db_;
+  unsigned int thread_;
+
+public:
+  uint64_t sum;
+  unsigned int errors;
+};
+
+/** Accumulates the checksum of visited tiles */
+class ChecksumVisitor : public TileBlobVisitor
+{
+public:
+  ChecksumVisitor() : sum(0) {}
+  virtual void Visit(const uint8_t* data, uint32_t dataSize)
+  {
+    if (dataSize > 0)
+      sum += checksum(data, dataSize);
+  }
+  uint64_t sum;
+};
+
+/** Reads through a connection pool, without copying tiles */
+class PooledReader : public OpenThreads::Thread
+{
+public:
+  PooledReader(SQLiteReadConnectionPool& pool, unsigned int thread)
+    : pool_(pool), thread_(thread), errors(0)
+  {
+  }
+
+  virtual void run()
+  {
+    for (uint32_t read = 0; read < READS_PER_THREAD; ++read)
+    {
+      if (pool_.TsReadDataBuffer(0, QSNodeId(tileForRead(thread_, read)), visitor) != QS_IS_OK)
+        ++errors;
+    }
+  }
+
+private:
+  SQLiteReadConnectionPool& pool_;
+  unsigned int thread_;
+
+public:
+  ChecksumVisitor visitor;
+  unsigned int errors;
+};
+
+template <typename ReaderType>
+double runReaders(std::vector<ReaderType*>& readers)
+{
+  const double start = simCore::getSystemTime();
+  for (size_t k = 0; k < readers.size(); ++k)
+    readers[k]->start();
+  for (size_t k = 0; k < readers.size(); ++k)
+    readers[k]->join();
+  return simCore::getSystemTime() - start;
+}
+
+int testThroughput()
+{
+  int rv = 0;
+  std::vector<uint64_t> expected;
+  for (unsigned int k = 0; k < NUM_THREADS; ++k)
+    expected.push_back(expectedChecksum(k));
+  const double numReads = static_cast<double>(NUM_THREADS) * READS_PER_THREAD;
+
+  // Single shared connection, as used by the driver before the connection pool
+  SQLiteDataBaseReadUtil util;
+  sqlite3* db = NULL;
+  rv += SDK_ASSERT(util.OpenDataBaseFile(DB_FILE_NAME, &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX) == QS_IS_OK);
+  std::vector<SharedConnectionReader*> sharedReaders;
+  for (unsigned int k = 0; k < NUM_THREADS; ++k)
+    sharedReaders.push_back(new SharedConnectionReader(util, db, k));
+  const double sharedSeconds = runReaders(sharedReaders);
+  for (unsigned int k = 0; k < NUM_THREADS; ++k)
+  {
+    rv += SDK_ASSERT(sharedReaders[k]->errors == 0);
+    rv += SDK_ASSERT(sharedReaders[k]->sum == expected[k]);
+    delete sharedReaders[k];
+  }
+  sqlite3_close(db);
+
+  // Connection pool, decoding straight from SQLite's buffer
+  SQLiteReadConnectionPool pool(DB_FILE_NAME, TABLE_NAME);
+  std::vector<PooledReader*> pooledReaders;
+  for (unsigned int k = 0; k < NUM_THREADS; ++k)
+    pooledReaders.push_back(new PooledReader(pool, k));
+  const double pooledSeconds = runReaders(pooledReaders);
+  for (unsigned int k = 0; k < NUM_THREADS; ++k)
+  {
+    rv += SDK_ASSERT(pooledReaders[k]->errors == 0);
+    rv += SDK_ASSERT(pooledReaders[k]->visitor.sum == expected[k]);
+    delete pooledReaders[k];
+  }
+  rv += SDK_ASSERT(pool.NumConnections() >= 1 && pool.NumConnections() <= NUM_THREADS);
+
+  // Missing tiles are reported with a size of 0
+  ChecksumVisitor missing;
+  rv += SDK_ASSERT(pool.TsReadDataBuffer(1, QSNodeId(0), missing) == QS_IS_OK);
+  rv += SDK_ASSERT(missing.sum == 0);
+
+  std::cout << "Shared connection: " << numReads / sharedSeconds << " tiles/s (" << sharedSeconds << " s)\n"
+    << "Connection pool:   " << numReads / pooledSeconds << " tiles/s (" << pooledSeconds << " s, "
+    << pool.NumConnections() << " connections)" << std::endl;
+  return rv;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  int rv = createDatabase();
+  if (rv == 0)
+    rv += testThroughput();
+  std::remove(DB_FILE_NAME);
+  std::cout << "DBReadBenchmark " << ((rv == 0) ? "passed" : "failed") << std::endl;
+  return rv;
+}
@@ -0,0 +1,187 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+/**
+ * Tests DecodedTileCache: copies on insert and lookup, LRU eviction against the memory limit,
+ * empty entries for tiles without data, and statistics.
+ */
+#include <iostream>
+#include <string>
+#include "osg/Image"
+#include "osg/ref_ptr"
+#include "simCore/Common/SDKAssert.h"
+#include "DecodedTileCache.h"
+
+using namespace simVis_db;
+
+namespace
+{
+
+/** Size of the test images, in bytes */
+const size_t IMAGE_BYTES = 100;
+
+/** Creates a 10x10 luminance image filled with the given value */
+osg::Image* makeImage(unsigned char value)
+{
+  osg::Image* image = new osg::Image;
+  image->allocateImage(10, 10, 1, GL_LUMINANCE, GL_UNSIGNED_BYTE);
+  for (size_t k = 0; k < IMAGE_BYTES; ++k)
+    image->data()[k] = value;
+  return image;
+}
+
+/** Returns the first pixel of a cached image, or 0 if the key has no image */
+unsigned char cachedValue(DecodedTileCache& cache, const std::string& key)
+{
+  osg::ref_ptr<osg::Object> tile;
+  if (!cache.get(key, tile))
+    return 0;
+  const osg::Image* image = dynamic_cast<const osg::Image*>(tile.get());
+  return (image == NULL) ? 0 : image->data()[0];
+}
+
+int testCopies()
+{
+  int rv = 0;
+  DecodedTileCache cache(10 * IMAGE_BYTES);
+  osg::ref_ptr<osg::Image> image = makeImage(1);
+  cache.insert("a", image.get(), IMAGE_BYTES);
+
+  // Changes to the inserted image do not reach the cache
+  image->data()[0] = 2;
+  osg::ref_ptr<osg::Object> first;
+  rv += SDK_ASSERT(cache.get("a", first));
+  rv += SDK_ASSERT(first.valid() && first.get() != image.get());
+  osg::Image* firstImage = dynamic_cast<osg::Image*>(first.get());
+  rv += SDK_ASSERT(firstImage != NULL && firstImage->data()[0] == 1);
+
+  // Changes to a returned image do not reach the cache either
+  if (firstImage != NULL)
+    firstImage->data()[0] = 3;
+  rv += SDK_ASSERT(cachedValue(cache, "a") == 1);
+  return rv;
+}
+
+int testEviction()
+{
+  int rv = 0;
+  // Room for two and a half images
+  DecodedTileCache cache(5 * IMAGE_BYTES / 2);
+  osg::ref_ptr<osg::Image> a = makeImage(1);
+  osg::ref_ptr<osg::Image> b = makeImage(2);
+  osg::ref_ptr<osg::Image> c = makeImage(3);
+  osg::ref_ptr<osg::Image> d = makeImage(4);
+
+  cache.insert("a", a.get(), IMAGE_BYTES);
+  cache.insert("b", b.get(), IMAGE_BYTES);
+  rv += SDK_ASSERT(cache.statistics().numTiles == 2);
+  rv += SDK_ASSERT(cache.statistics().sizeBytes == 2 * IMAGE_BYTES);
+
+  // Using "a" makes "b" the least recently used
+  rv += SDK_ASSERT(cachedValue(cache, "a") == 1);
+  cache.insert("c", c.get(), IMAGE_BYTES);
+  rv += SDK_ASSERT(cache.contains("a"));
+  rv += SDK_ASSERT(!cache.contains("b"));
+  rv += SDK_ASSERT(cache.contains("c"));
+  rv += SDK_ASSERT(cache.statistics().evictions == 1);
+  rv += SDK_ASSERT(cache.statistics().numTiles == 2);
+  rv += SDK_ASSERT(cache.statistics().sizeBytes == 2 * IMAGE_BYTES);
+
+  // contains() does not change the order, so "a" is evicted next
+  rv += SDK_ASSERT(cache.contains("a"));
+  cache.insert("d", d.get(), IMAGE_BYTES);
+  rv += SDK_ASSERT(!cache.contains("a"));
+  rv += SDK_ASSERT(cache.contains("c"));
+  rv += SDK_ASSERT(cache.contains("d"));
+  rv += SDK_ASSERT(cache.statistics().evictions == 2);
+
+  // Replacing a tile keeps one entry and its size
+  cache.insert("d", a.get(), IMAGE_BYTES);
+  rv += SDK_ASSERT(cachedValue(cache, "d") == 1);
+  rv += SDK_ASSERT(cache.statistics().numTiles == 2);
+  rv += SDK_ASSERT(cache.statistics().sizeBytes == 2 * IMAGE_BYTES);
+
+  // A tile larger than the cache is not kept, and does not evict anything
+  cache.insert("huge", a.get(), 3 * IMAGE_BYTES);
+  rv += SDK_ASSERT(!cache.contains("huge"));
+  rv += SDK_ASSERT(cache.statistics().numTiles == 2);
+  rv += SDK_ASSERT(cache.statistics().evictions == 2);
+  return rv;
+}
+
+int testEmptyEntries()
+{
+  int rv = 0;
+  DecodedTileCache cache(10 * IMAGE_BYTES);
+  cache.insert("missing", NULL, 0);
+  rv += SDK_ASSERT(cache.contains("missing"));
+  rv += SDK_ASSERT(cache.statistics().sizeBytes == DecodedTileCache::EMPTY_ENTRY_BYTES);
+
+  // An empty entry is a hit with no tile
+  osg::ref_ptr<osg::Object> tile = makeImage(1);
+  rv += SDK_ASSERT(cache.get("missing", tile));
+  rv += SDK_ASSERT(!tile.valid());
+
+  // An unknown key is a miss
+  tile = makeImage(1);
+  rv += SDK_ASSERT(!cache.get("unknown", tile));
+  rv += SDK_ASSERT(!tile.valid());
+  return rv;
+}
+
+int testStatistics()
+{
+  int rv = 0;
+  DecodedTileCache cache(10 * IMAGE_BYTES);
+  rv += SDK_ASSERT(cache.maxSizeBytes() == 10 * IMAGE_BYTES);
+  osg::ref_ptr<osg::Image> image = makeImage(1);
+  cache.insert("a", image.get(), IMAGE_BYTES);
+  osg::ref_ptr<osg::Object> tile;
+  cache.get("a", tile);
+  cache.get("a", tile);
+  cache.get("b", tile);
+  DecodedTileCache::Statistics stats = cache.statistics();
+  rv += SDK_ASSERT(stats.hits == 2);
+  rv += SDK_ASSERT(stats.misses == 1);
+
+  // clear() removes the tiles and keeps the counters
+  cache.clear();
+  stats = cache.statistics();
+  rv += SDK_ASSERT(!cache.contains("a"));
+  rv += SDK_ASSERT(stats.numTiles == 0);
+  rv += SDK_ASSERT(stats.sizeBytes == 0);
+  rv += SDK_ASSERT(stats.hits == 2);
+  rv += SDK_ASSERT(stats.misses == 1);
+  return rv;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  int rv = testCopies();
+  rv += testEviction();
+  rv += testEmptyEntries();
+  rv += testStatistics();
+  std::cout << "DecodedTileCacheTest " << ((rv == 0) ? "passed" : "failed") << std::endl;
+  return rv;
+}
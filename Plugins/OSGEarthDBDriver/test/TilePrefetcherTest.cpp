@@ -0,0 +1,232 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+
+/**
+ * Tests TilePrefetcher with a loader that records the tiles it is asked for: the neighbors and
+ * children that are queued, the deepest level limit, the dropping of the oldest requests
+ * when the queue is full, and the merging of repeated requests for a queued tile.
+ */
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "OpenThreads/Block"
+#include "OpenThreads/Mutex"
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
+#include "osgEarth/Registry"
+#include "osgEarth/TileKey"
+#include "simCore/Common/SDKAssert.h"
+#include "TilePrefetcher.h"
+
+using namespace simVis_db;
+
+namespace
+{
+
+/** Records the tiles requested by the prefetcher; can hold the first request until released */
+class RecordingLoader : public TilePrefetcher::Loader
+{
+public:
+  explicit RecordingLoader(bool holdFirst)
+    : holdFirst_(holdFirst)
+  {
+    gate_.set(!holdFirst);
+  }
+
+  virtual bool prefetchTile(const osgEarth::TileKey& key, bool isHeightField)
+  {
+    bool wait = false;
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      keys_.push_back(key.str());
+      heightFields_.push_back(isHeightField);
+      wait = holdFirst_ && keys_.size() == 1;
+    }
+    if (wait)
+      gate_.block();
+    return true;
+  }
+
+  /** Lets the held request finish */
+  void release()
+  {
+    gate_.release();
+  }
+
+  /** Returns the keys requested so far */
+  std::vector<std::string> keys() const
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    return keys_;
+  }
+
+  /** Returns true if every request so far was for the given tile type */
+  bool allOfType(bool isHeightField) const
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    return std::find(heightFields_.begin(), heightFields_.end(), !isHeightField) == heightFields_.end();
+  }
+
+private:
+  bool holdFirst_;
+  OpenThreads::Block gate_;
+  mutable OpenThreads::Mutex mutex_;
+  std::vector<std::string> keys_;
+  std::vector<bool> heightFields_;
+};
+
+/** Waits up to 10 seconds for the prefetcher to load the given number of tiles */
+bool waitForLoads(const TilePrefetcher& prefetcher, unsigned int numLoads)
+{
+  for (int k = 0; k < 1000 && prefetcher.numLoaded() < numLoads; ++k)
+    OpenThreads::Thread::microSleep(10000);
+  return prefetcher.numLoaded() == numLoads;
+}
+
+/** Waits up to 10 seconds for the loader to receive the given number of requests */
+bool waitForRequests(const RecordingLoader& loader, size_t numRequests)
+{
+  for (int k = 0; k < 1000 && loader.keys().size() < numRequests; ++k)
+    OpenThreads::Thread::microSleep(10000);
+  return loader.keys().size() == numRequests;
+}
+
+/** Returns true if the key is in the vector */
+bool contains(const std::vector<std::string>& keys, const osgEarth::TileKey& key)
+{
+  return std::find(keys.begin(), keys.end(), key.str()) != keys.end();
+}
+
+int testNeighborsAndChildren()
+{
+  int rv = 0;
+  const osgEarth::Profile* profile = osgEarth::Registry::instance()->getGlobalGeodeticProfile();
+  const osgEarth::TileKey key(3, 5, 3, profile);
+  RecordingLoader loader(false);
+  TilePrefetcher prefetcher(loader, 2);
+
+  prefetcher.requestAround(key, true, 10);
+  rv += SDK_ASSERT(waitForLoads(prefetcher, 8));
+  const std::vector<std::string> keys = loader.keys();
+  rv += SDK_ASSERT(keys.size() == 8);
+  rv += SDK_ASSERT(contains(keys, key.createNeighborKey(-1, 0)));
+  rv += SDK_ASSERT(contains(keys, key.createNeighborKey(1, 0)));
+  rv += SDK_ASSERT(contains(keys, key.createNeighborKey(0, -1)));
+  rv += SDK_ASSERT(contains(keys, key.createNeighborKey(0, 1)));
+  for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+    rv += SDK_ASSERT(contains(keys, key.createChildKey(quadrant)));
+  rv += SDK_ASSERT(!contains(keys, key));
+  rv += SDK_ASSERT(loader.allOfType(true));
+
+  // No children at the deepest level
+  prefetcher.requestAround(key, true, 3);
+  rv += SDK_ASSERT(waitForLoads(prefetcher, 12));
+  rv += SDK_ASSERT(loader.keys().size() == 12);
+  return rv;
+}
+
+int testQueueLimit()
+{
+  int rv = 0;
+  const osgEarth::Profile* profile = osgEarth::Registry::instance()->getGlobalGeodeticProfile();
+  const osgEarth::TileKey first(3, 5, 3, profile);
+  const osgEarth::TileKey second(4, 2, 9, profile);
+  RecordingLoader loader(true);
+  TilePrefetcher prefetcher(loader, 1, 4);
+
+  // The single worker takes the most recent tile of the first request, and is held there
+  prefetcher.requestAround(first, false, 10);
+  rv += SDK_ASSERT(waitForRequests(loader, 1));
+
+  // The second request overflows the queue; only its four children, the most recent, are kept
+  prefetcher.requestAround(second, false, 10);
+  loader.release();
+  rv += SDK_ASSERT(waitForLoads(prefetcher, 5));
+  OpenThreads::Thread::microSleep(50000);
+  const std::vector<std::string> keys = loader.keys();
+  rv += SDK_ASSERT(keys.size() == 5);
+  if (keys.size() == 5)
+  {
+    rv += SDK_ASSERT(keys[0] == first.createChildKey(3).str());
+    // Most recent first
+    for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+      rv += SDK_ASSERT(keys[4 - quadrant] == second.createChildKey(quadrant).str());
+  }
+  rv += SDK_ASSERT(loader.allOfType(false));
+  return rv;
+}
+
+int testDuplicateRequests()
+{
+  int rv = 0;
+  const osgEarth::Profile* profile = osgEarth::Registry::instance()->getGlobalGeodeticProfile();
+  const osgEarth::TileKey key(3, 5, 3, profile);
+  RecordingLoader loader(true);
+  TilePrefetcher prefetcher(loader, 1);
+
+  // The worker is held on the first tile while the same tile is requested twice more
+  prefetcher.requestAround(key, false, 10);
+  rv += SDK_ASSERT(waitForRequests(loader, 1));
+  prefetcher.requestAround(key, false, 10);
+  prefetcher.requestAround(key, false, 10);
+  loader.release();
+
+  // The seven queued tiles are loaded once each, plus the held tile, which was queued again
+  rv += SDK_ASSERT(waitForLoads(prefetcher, 9));
+  OpenThreads::Thread::microSleep(50000);
+  std::vector<std::string> keys = loader.keys();
+  rv += SDK_ASSERT(keys.size() == 9);
+  std::sort(keys.begin(), keys.end());
+  rv += SDK_ASSERT(std::adjacent_find(keys.begin(), keys.end()) != keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  rv += SDK_ASSERT(keys.size() == 8);
+  return rv;
+}
+
+int testShutdownWithQueuedTiles()
+{
+  int rv = 0;
+  const osgEarth::Profile* profile = osgEarth::Registry::instance()->getGlobalGeodeticProfile();
+  RecordingLoader loader(true);
+  {
+    TilePrefetcher prefetcher(loader, 1);
+    prefetcher.requestAround(osgEarth::TileKey(3, 5, 3, profile), false, 10);
+    rv += SDK_ASSERT(waitForRequests(loader, 1));
+    loader.release();
+    // Destructor discards the queued tiles and joins the worker
+  }
+  rv += SDK_ASSERT(loader.keys().size() <= 8);
+  return rv;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  int rv = testNeighborsAndChildren();
+  rv += testQueueLimit();
+  rv += testDuplicateRequests();
+  rv += testShutdownWithQueuedTiles();
+  std::cout << "TilePrefetcherTest " << ((rv == 0) ? "passed" : "failed") << std::endl;
+  return rv;
+}
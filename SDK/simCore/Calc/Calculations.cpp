@@ -1655,3 +1655,398 @@ bool simCore::laserInGate(const simCore::Vec3& gateHostLLA, const simCore::Vec3&
   // At least one of the laser's endpoints was not in the gate
   return false;
 }
+
+//------------------------------------------------------------------------
+
+simCore::RelativeGeometryFrame::TargetGeometry::TargetGeometry()
+  : azim_(0.0),
+    elev_(0.0),
+    cmp_(0.0),
+    relAzim_(0.0),
+    relElev_(0.0),
+    relCmp_(0.0),
+    slant_(0.0),
+    ground_(0.0),
+    altitude_(0.0),
+    closingVelocity_(0.0)
+{
+}
+
+simCore::RelativeGeometryFrame::RelativeGeometryFrame(const Vec3& fromLla, const Vec3& fromOriLla, const Vec3& fromVel,
+  EarthModelCalculations model, const CoordinateConverter* coordConv)
+  : fromLla_(fromLla),
+    fromOri_(fromOriLla),
+    fromVel_(fromVel),
+    model_(model),
+    valid_(true)
+{
+  // orientation terms used by calculateRelAng()
+  d3EulertoDCM(fromOri_, oriDcm_);
+  boresight_.set(sin(fromOri_[0]), cos(fromOri_[0]), tan(fromOri_[1]));
+
+  const Coordinate fromState(COORD_SYS_LLA, fromLla_, Vec3(0., 0., 0.), fromVel_);
+  Coordinate fromPos;
+  switch (model_)
+  {
+  case WGS_84:
+  case TANGENT_PLANE_WGS_84:
+    cc_.setReferenceOrigin(fromLla_);
+    cc_.convert(Coordinate(COORD_SYS_LLA, fromLla_), fromPos, COORD_SYS_XEAST);
+    fromLocal_ = fromPos.position();
+    CoordinateConverter::convertGeodeticPosToEcef(fromLla_, fromEcef_);
+    cc_.convert(fromState, fromState_, (model_ == WGS_84) ? COORD_SYS_ECEF : COORD_SYS_XEAST);
+    break;
+
+  case FLAT_EARTH:
+    if (!coordConv || !coordConv->hasReferenceOrigin())
+    {
+      SIM_WARN << "RelativeGeometryFrame, CoordinateConverter not set for FLAT_EARTH: " << __LINE__ << std::endl;
+      valid_ = false;
+      break;
+    }
+    cc_ = *coordConv;
+    cc_.convert(Coordinate(COORD_SYS_LLA, fromLla_), fromPos, COORD_SYS_ENU);
+    fromLocal_ = fromPos.position();
+    hostCc_.setReferenceOrigin(fromLla_);
+    hostCc_.convert(fromState, fromState_, COORD_SYS_ENU);
+    break;
+
+  case PERFECT_SPHERE:
+    geodeticToSpherical(fromLla_[0], fromLla_[1], fromLla_[2], fromLocal_);
+    break;
+
+  default:
+    SIM_WARN << "RelativeGeometryFrame, unknown earth model: " << __LINE__ << std::endl;
+    valid_ = false;
+    break;
+  }
+}
+
+simCore::RelativeGeometryFrame::~RelativeGeometryFrame()
+{
+}
+
+bool simCore::RelativeGeometryFrame::isValid() const
+{
+  return valid_;
+}
+
+simCore::EarthModelCalculations simCore::RelativeGeometryFrame::model() const
+{
+  return model_;
+}
+
+void simCore::RelativeGeometryFrame::localPosition_(const Vec3& toLla, Vec3& local) const
+{
+  Coordinate toPos;
+  switch (model_)
+  {
+  case WGS_84:
+  case TANGENT_PLANE_WGS_84:
+    cc_.convert(Coordinate(COORD_SYS_LLA, toLla), toPos, COORD_SYS_XEAST);
+    local = toPos.position();
+    break;
+  case FLAT_EARTH:
+    cc_.convert(Coordinate(COORD_SYS_LLA, toLla), toPos, COORD_SYS_ENU);
+    local = toPos.position();
+    break;
+  case PERFECT_SPHERE:
+    geodeticToSpherical(toLla[0], toLla[1], toLla[2], local);
+    break;
+  default:
+    local.zero();
+    break;
+  }
+}
+
+void simCore::RelativeGeometryFrame::relAngles_(const Vec3& local, double* azim, double* elev, double* cmp) const
+{
+  // the WGS-84 models use the target's tangent plane position; flat earth uses the ENU difference
+  Vec3 enuVec(local);
+  if (model_ == FLAT_EARTH)
+    v3Subtract(local, fromLocal_, enuVec);
+  pointingAngles_(enuVec, azim, elev, cmp);
+}
+
+void simCore::RelativeGeometryFrame::pointingAngles_(const Vec3& enuVec, double* azim, double* elev, double* cmp) const
+{
+  if (azim || elev)
+  {
+    // same steps as calculateRelAng(), with the rotation matrix computed once
+    Vec3 pntVec;
+    calculateBodyUnitX(atan2(enuVec[0], enuVec[1]), atan2(enuVec[2], sqrt(square(enuVec[0]) + square(enuVec[1]))), pntVec);
+    Vec3 body;
+    d3Mv3Mult(oriDcm_, pntVec, body);
+    double az;
+    double el;
+    calculateYawPitchFromBodyUnitX(body, az, el);
+    if (azim)
+      *azim = az;
+    if (elev)
+      *elev = el;
+  }
+  if (cmp)
+    *cmp = v3Angle(boresight_, enuVec);
+}
+
+void simCore::RelativeGeometryFrame::absAngles_(const Vec3& local, double* azim, double* elev, double* cmp) const
+{
+  Vec3 enuDelta;
+  if (model_ == FLAT_EARTH)
+    v3Subtract(local, fromLocal_, enuDelta);
+  else if (model_ == PERFECT_SPHERE)
+    sphere2TangentPlane(fromLla_, local, enuDelta, &fromLocal_);
+  else
+    enuDelta = local;
+
+  if (azim)
+    *azim = angFix2PI(atan2(enuDelta[0], enuDelta[1]));
+  if (elev)
+    *elev = atan2(enuDelta[2], sqrt(enuDelta[0]*enuDelta[0] + enuDelta[1]*enuDelta[1]));
+  if (cmp)
+    *cmp = v3Angle(Vec3(0.0, 1.0, 0.0), enuDelta);
+}
+
+bool simCore::RelativeGeometryFrame::velocities_(const Vec3& toLla, const Vec3& toVel, double* closing, double* delta) const
+{
+  CoordinateSystem system;
+  switch (model_)
+  {
+  case WGS_84:
+    system = COORD_SYS_ECEF;
+    break;
+  case TANGENT_PLANE_WGS_84:
+    system = COORD_SYS_XEAST;
+    break;
+  case FLAT_EARTH:
+    system = COORD_SYS_ENU;
+    break;
+  default:
+    return false;
+  }
+  if (!valid_)
+    return false;
+
+  Coordinate toPos;
+  const CoordinateConverter& cc = (model_ == FLAT_EARTH) ? hostCc_ : cc_;
+  cc.convert(Coordinate(COORD_SYS_LLA, toLla, Vec3(0., 0., 0.), toVel), toPos, system);
+  if (closing)
+  {
+    Vec3 unitPosVec;
+    v3Subtract(toPos.position(), fromState_.position(), unitPosVec);
+    v3Unit(unitPosVec);
+    Vec3 diff;
+    v3Subtract(fromState_.velocity(), toPos.velocity(), diff);
+    *closing = v3Dot(diff, unitPosVec);
+  }
+  if (delta)
+    *delta = v3Distance(fromState_.velocity(), toPos.velocity());
+  return true;
+}
+
+void simCore::RelativeGeometryFrame::calculateRelAzEl(const Vec3& toLla, double* azim, double* elev, double* cmp) const
+{
+  if (!valid_ || model_ == PERFECT_SPHERE)
+  {
+    SIM_WARN << "Could not calculate relative angles: " << __LINE__ << std::endl;
+    if (azim) *azim = 0.0;
+    if (elev) *elev = 0.0;
+    if (cmp) *cmp = 0.0;
+    return;
+  }
+  Vec3 local;
+  localPosition_(toLla, local);
+  relAngles_(local, azim, elev, cmp);
+}
+
+void simCore::RelativeGeometryFrame::calculateAbsAzEl(const Vec3& toLla, double* azim, double* elev, double* cmp) const
+{
+  if (!valid_)
+  {
+    SIM_WARN << "Could not calculate true angles: " << __LINE__ << std::endl;
+    if (azim) *azim = 0.0;
+    if (elev) *elev = 0.0;
+    if (cmp) *cmp = 0.0;
+    return;
+  }
+  Vec3 local;
+  localPosition_(toLla, local);
+  absAngles_(local, azim, elev, cmp);
+}
+
+double simCore::RelativeGeometryFrame::calculateSlant(const Vec3& toLla) const
+{
+  if (!valid_)
+    return 0.0;
+  if (model_ == WGS_84)
+  {
+    Vec3 toEcef;
+    CoordinateConverter::convertGeodeticPosToEcef(toLla, toEcef);
+    return v3Distance(toEcef, fromEcef_);
+  }
+  Vec3 local;
+  localPosition_(toLla, local);
+  return v3Distance(local, fromLocal_);
+}
+
+double simCore::RelativeGeometryFrame::calculateGroundDist(const Vec3& toLla) const
+{
+  if (!valid_ || model_ == PERFECT_SPHERE)
+    return 0.0;
+  if (model_ == WGS_84)
+    return sodanoInverse(fromLla_[0], fromLla_[1], 0., toLla[0], toLla[1]);
+  Vec3 local;
+  localPosition_(toLla, local);
+  return sqrt(square(local[0] - fromLocal_[0]) + square(local[1] - fromLocal_[1]));
+}
+
+double simCore::RelativeGeometryFrame::calculateAltitude(const Vec3& toLla) const
+{
+  if (!valid_ || model_ == PERFECT_SPHERE)
+    return 0.0;
+  if (model_ == WGS_84)
+    return toLla[2] - fromLla_[2];
+  Vec3 local;
+  localPosition_(toLla, local);
+  return local[2] - fromLocal_[2];
+}
+
+double simCore::RelativeGeometryFrame::calculateClosingVelocity(const Vec3& toLla, const Vec3& toVel) const
+{
+  double closing = 0.0;
+  if (!velocities_(toLla, toVel, &closing, NULL))
+    SIM_ERROR << "RelativeGeometryFrame::calculateClosingVelocity, unable to perform calculation: " << __LINE__ << std::endl;
+  return closing;
+}
+
+double simCore::RelativeGeometryFrame::calculateVelocityDelta(const Vec3& toLla, const Vec3& toVel) const
+{
+  double delta = 0.0;
+  if (!velocities_(toLla, toVel, NULL, &delta))
+    SIM_ERROR << "RelativeGeometryFrame::calculateVelocityDelta, unable to perform calculation: " << __LINE__ << std::endl;
+  return delta;
+}
+
+void simCore::RelativeGeometryFrame::hostBearingAndGround_(const Vec3& toLla, double* bearing, double* ground) const
+{
+  if (model_ != FLAT_EARTH)
+  {
+    calculateRelAzEl(toLla, bearing, NULL, NULL);
+    if (ground)
+      *ground = calculateGroundDist(toLla);
+    return;
+  }
+
+  // the free rate functions re-reference flat earth at the host
+  Coordinate toPos;
+  hostCc_.convert(Coordinate(COORD_SYS_LLA, toLla), toPos, COORD_SYS_ENU);
+  Vec3 enuVec;
+  v3Subtract(toPos.position(), fromState_.position(), enuVec);
+  pointingAngles_(enuVec, bearing, NULL, NULL);
+  if (ground)
+    *ground = sqrt(square(enuVec[0]) + square(enuVec[1]));
+}
+
+double simCore::RelativeGeometryFrame::calculateRangeRate(const Vec3& toLla, const Vec3& toOriLla, const Vec3& toVel) const
+{
+  if (!valid_ || model_ == PERFECT_SPHERE)
+  {
+    SIM_ERROR << "RelativeGeometryFrame::calculateRangeRate, unable to perform calculation: " << __LINE__ << std::endl;
+    return 0.0;
+  }
+  double bearing = 0;
+  hostBearingAndGround_(toLla, &bearing, NULL);
+  return v3Length(fromVel_) * cos(fromOri_[0] - bearing) - (v3Length(toVel) * cos(toOriLla[0] - bearing));
+}
+
+double simCore::RelativeGeometryFrame::calculateBearingRate(const Vec3& toLla, const Vec3& toOriLla, const Vec3& toVel) const
+{
+  if (!valid_ || model_ == PERFECT_SPHERE)
+  {
+    SIM_ERROR << "RelativeGeometryFrame::calculateBearingRate, unable to perform calculation: " << __LINE__ << std::endl;
+    return 0.0;
+  }
+  double bearing = 0;
+  double range = 0;
+  hostBearingAndGround_(toLla, &bearing, &range);
+  const double tspd  = v3Length(toVel);
+  const double ospd  = v3Length(fromVel_);
+
+  // same expression as simCore::calculateBearingRate()
+  return (tspd * sin(toOriLla[0]) - ospd * sin(fromOri_[0])) *
+    cos(bearing) - (tspd * cos(toOriLla[0]) - ospd * cos(fromOri_[0])) *
+    sin(bearing) / range;
+}
+
+int simCore::RelativeGeometryFrame::calculate(const std::vector<Vec3>& toLla, const std::vector<Vec3>& toVel, std::vector<TargetGeometry>& results) const
+{
+  results.clear();
+  if (!valid_ || (!toVel.empty() && toVel.size() != toLla.size()))
+    return 1;
+  const size_t count = toLla.size();
+  results.resize(count);
+  if (count == 0)
+    return 0;
+
+  // convert all the targets at once
+  PositionArrays lla;
+  lla.resize(count);
+  for (size_t k = 0; k < count; ++k)
+    lla.set(k, toLla[k]);
+  PositionArrays local;
+  PositionArrays ecef;
+  switch (model_)
+  {
+  case WGS_84:
+    CoordinateConverter::convertGeodeticPosToEcef(lla, ecef);
+    cc_.convertEcefPosToXEast(ecef, local);
+    break;
+  case TANGENT_PLANE_WGS_84:
+    cc_.convertGeodeticPosToXEast(lla, local);
+    break;
+  case FLAT_EARTH:
+    cc_.convertGeodeticPosToFlat(lla, local, COORD_SYS_ENU);
+    break;
+  default:
+    local.resize(count);
+    for (size_t k = 0; k < count; ++k)
+    {
+      Vec3 sphere;
+      geodeticToSpherical(toLla[k][0], toLla[k][1], toLla[k][2], sphere);
+      local.set(k, sphere);
+    }
+    break;
+  }
+  // the flat earth conversion can fail for a degenerate origin; leave the results at 0
+  if (local.size() != count)
+    return 1;
+
+  const Vec3 zeroVel(0., 0., 0.);
+  for (size_t k = 0; k < count; ++k)
+  {
+    TargetGeometry& result = results[k];
+    const Vec3 localPos = local.get(k);
+    absAngles_(localPos, &result.azim_, &result.elev_, &result.cmp_);
+    if (model_ == PERFECT_SPHERE)
+    {
+      result.slant_ = v3Distance(localPos, fromLocal_);
+      continue;
+    }
+
+    relAngles_(localPos, &result.relAzim_, &result.relElev_, &result.relCmp_);
+    if (model_ == WGS_84)
+    {
+      result.slant_ = v3Distance(ecef.get(k), fromEcef_);
+      result.ground_ = sodanoInverse(fromLla_[0], fromLla_[1], 0., toLla[k][0], toLla[k][1]);
+      result.altitude_ = toLla[k][2] - fromLla_[2];
+    }
+    else
+    {
+      result.slant_ = v3Distance(localPos, fromLocal_);
+      result.ground_ = sqrt(square(localPos[0] - fromLocal_[0]) + square(localPos[1] - fromLocal_[1]));
+      result.altitude_ = localPos[2] - fromLocal_[2];
+    }
+    velocities_(toLla[k], toVel.empty() ? zeroVel : toVel[k], &result.closingVelocity_, NULL);
+  }
+  return 0;
+}
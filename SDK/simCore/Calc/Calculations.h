@@ -28,6 +28,7 @@
 * radians for latitude/longitude and other angles, and meters per second for velocity.
 */
 
+#include <vector>
 #include "simCore/Common/Common.h"
 #include "simCore/Calc/NumericalAnalysis.h"
 #include "simCore/Calc/CoordinateConverter.h"
@@ -579,6 +580,115 @@ namespace simCore
     double laserAzRad, double laserElRad, double laserRngM,
     simCore::EarthModelCalculations earthModel, const CoordinateConverter& cc,
     int numPoints=20);
+
+  /**
+  * Relative geometry from one 'from' entity to many 'to' entities.
+  *
+  * The calculate*() functions above rebuild the from entity's reference frame on every call.
+  * This class does that work once: it holds a converter referenced to the from entity, the
+  * from entity's converted position and velocity, and its orientation matrix, then evaluates
+  * targets against them.  Results match the free functions for the same model and converter.
+  */
+  class SDKCORE_EXPORT RelativeGeometryFrame
+  {
+  public:
+    /** Geometry from the from entity to one target */
+    struct SDKCORE_EXPORT TargetGeometry
+    {
+      TargetGeometry();
+
+      double azim_;             ///< True azimuth (rad), as calculateAbsAzEl()
+      double elev_;             ///< True elevation (rad), as calculateAbsAzEl()
+      double cmp_;              ///< True composite angle (rad), as calculateAbsAzEl()
+      double relAzim_;          ///< Azimuth relative to the from orientation (rad), as calculateRelAzEl()
+      double relElev_;          ///< Elevation relative to the from orientation (rad), as calculateRelAzEl()
+      double relCmp_;           ///< Composite angle relative to the from orientation (rad), as calculateRelAzEl()
+      double slant_;            ///< Slant range (m), as calculateSlant()
+      double ground_;           ///< Ground range (m), as calculateGroundDist()
+      double altitude_;         ///< Altitude difference (m), as calculateAltitude()
+      double closingVelocity_;  ///< Closing velocity (m/s), as calculateClosingVelocity()
+    };
+
+    /**
+    * Builds the frame of the from entity
+    * @param[in ] fromLla Lat, lon, alt of the from entity (rad, rad, m)
+    * @param[in ] fromOriLla Yaw, pitch, roll of the from entity (rad)
+    * @param[in ] fromVel Velocity of the from entity (m/s)
+    * @param[in ] model Earth model to perform the calculations in
+    * @param[in ] coordConv Required, with a reference origin set, if model is FLAT_EARTH; ignored otherwise
+    */
+    RelativeGeometryFrame(const Vec3& fromLla, const Vec3& fromOriLla, const Vec3& fromVel,
+      EarthModelCalculations model, const CoordinateConverter* coordConv = NULL);
+    virtual ~RelativeGeometryFrame();
+
+    /** Returns false if the model is unknown, or is FLAT_EARTH without a reference origin */
+    bool isValid() const;
+    /** Returns the earth model of the calculations */
+    EarthModelCalculations model() const;
+
+    /** Equivalent of simCore::calculateRelAzEl() from this frame; not available for PERFECT_SPHERE */
+    void calculateRelAzEl(const Vec3& toLla, double* azim, double* elev, double* cmp) const;
+    /** Equivalent of simCore::calculateAbsAzEl() from this frame */
+    void calculateAbsAzEl(const Vec3& toLla, double* azim, double* elev, double* cmp) const;
+    /** Equivalent of simCore::calculateSlant() from this frame */
+    double calculateSlant(const Vec3& toLla) const;
+    /** Equivalent of simCore::calculateGroundDist() from this frame; not available for PERFECT_SPHERE */
+    double calculateGroundDist(const Vec3& toLla) const;
+    /** Equivalent of simCore::calculateAltitude() from this frame; not available for PERFECT_SPHERE */
+    double calculateAltitude(const Vec3& toLla) const;
+    /** Equivalent of simCore::calculateClosingVelocity() from this frame; not available for PERFECT_SPHERE */
+    double calculateClosingVelocity(const Vec3& toLla, const Vec3& toVel) const;
+    /** Equivalent of simCore::calculateVelocityDelta() from this frame; not available for PERFECT_SPHERE */
+    double calculateVelocityDelta(const Vec3& toLla, const Vec3& toVel) const;
+    /** Equivalent of simCore::calculateRangeRate() from this frame; not available for PERFECT_SPHERE */
+    double calculateRangeRate(const Vec3& toLla, const Vec3& toOriLla, const Vec3& toVel) const;
+    /** Equivalent of simCore::calculateBearingRate() from this frame; not available for PERFECT_SPHERE */
+    double calculateBearingRate(const Vec3& toLla, const Vec3& toOriLla, const Vec3& toVel) const;
+
+    /**
+    * Calculates the geometry to many targets, converting all target positions in one batch.
+    * Values the model does not support are 0.
+    * @param[in ] toLla Lat, lon, alt of each target (rad, rad, m)
+    * @param[in ] toVel Velocity of each target (m/s); may be empty if the targets are stationary
+    * @param[out] results Geometry for each target, parallel to toLla
+    * @return 0 on success, non-zero if the frame is invalid or toVel is neither empty nor the size of toLla
+    */
+    int calculate(const std::vector<Vec3>& toLla, const std::vector<Vec3>& toVel, std::vector<TargetGeometry>& results) const;
+
+  private:
+    /** Converts a target to the local frame of the model: XEAST, ENU or the sphere tangent plane */
+    void localPosition_(const Vec3& toLla, Vec3& local) const;
+    /** Calculates relative angles from a local target position, as calculateRelAng() */
+    void relAngles_(const Vec3& local, double* azim, double* elev, double* cmp) const;
+    /** Calculates relative angles from an ENU pointing vector, using the cached orientation */
+    void pointingAngles_(const Vec3& enuVec, double* azim, double* elev, double* cmp) const;
+    /** Calculates the relative bearing and ground distance used by the rate calculations; outputs may be NULL */
+    void hostBearingAndGround_(const Vec3& toLla, double* bearing, double* ground) const;
+    /** Calculates true angles from a local target position */
+    void absAngles_(const Vec3& local, double* azim, double* elev, double* cmp) const;
+    /** Calculates the closing velocity and velocity delta to a target; returns false if the model does not support them */
+    bool velocities_(const Vec3& toLla, const Vec3& toVel, double* closing, double* delta) const;
+
+    Vec3 fromLla_;
+    Vec3 fromOri_;
+    Vec3 fromVel_;
+    EarthModelCalculations model_;
+    bool valid_;
+    /** Referenced to fromLla_ for the WGS-84 models; a copy of the caller's converter for FLAT_EARTH */
+    CoordinateConverter cc_;
+    /** Referenced to fromLla_; the velocity calculations always use the host as origin, like the free functions */
+    CoordinateConverter hostCc_;
+    /** From position in XEAST (tangent plane), ENU (flat earth) or the sphere */
+    Vec3 fromLocal_;
+    /** From position in ECEF, for the WGS_84 slant range */
+    Vec3 fromEcef_;
+    /** From position and velocity in the system used for velocity calculations */
+    Coordinate fromState_;
+    /** Rotation matrix of the from orientation */
+    double oriDcm_[3][3];
+    /** Pointing vector of the from orientation, for the relative composite angle */
+    Vec3 boresight_;
+  };
 }
 
 #endif /* SIMCORE_CALC_RANGE_CALCULATIONS_H */
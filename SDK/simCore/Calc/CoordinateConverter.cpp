@@ -2449,3 +2449,297 @@ void CoordinateConverter::convertGeodeticOriToEcef(const Vec3 &llaPos, const Vec
   // calculate Euler angles for platform body in ECEF coordinates
   d3DCMtoEuler(BE, ecefOri);
 }
+
+//-------------------------------------------------------------------------
+// Batch position conversions
+
+void PositionArrays::resize(size_t count)
+{
+  x_.resize(count);
+  y_.resize(count);
+  z_.resize(count);
+}
+
+void PositionArrays::set(size_t index, const Vec3& pos)
+{
+  x_[index] = pos.x();
+  y_[index] = pos.y();
+  z_[index] = pos.z();
+}
+
+Vec3 PositionArrays::get(size_t index) const
+{
+  return Vec3(x_[index], y_[index], z_[index]);
+}
+
+void CoordinateConverter::convertGeodeticPosToEcef(const PositionArrays &llaPos, PositionArrays &ecefPos, const double semiMajor, const double eccentricitySquared)
+{
+  assert(llaPos.y_.size() == llaPos.x_.size() && llaPos.z_.size() == llaPos.x_.size());
+  const size_t count = llaPos.size();
+  ecefPos.resize(count);
+  if (count == 0)
+    return;
+  const double* lat = &llaPos.x_[0];
+  const double* lon = &llaPos.y_[0];
+  const double* alt = &llaPos.z_[0];
+  double* x = &ecefPos.x_[0];
+  double* y = &ecefPos.y_[0];
+  double* z = &ecefPos.z_[0];
+  const double oneMinusEsq = 1.0 - eccentricitySquared;
+  for (size_t k = 0; k < count; ++k)
+  {
+    const double sLat = sin(lat[k]);
+    const double cLat = cos(lat[k]);
+    const double Rn = semiMajor / sqrt(1.0 - eccentricitySquared * sLat * sLat);
+    const double horiz = (Rn + alt[k]) * cLat;
+    const double lonK = lon[k];
+    const double zK = (Rn * oneMinusEsq + alt[k]) * sLat;
+    x[k] = horiz * cos(lonK);
+    y[k] = horiz * sin(lonK);
+    z[k] = zK;
+  }
+}
+
+void CoordinateConverter::convertEcefToGeodeticPos(const PositionArrays &ecefPos, PositionArrays &llaPos)
+{
+  assert(ecefPos.y_.size() == ecefPos.x_.size() && ecefPos.z_.size() == ecefPos.x_.size());
+  const size_t count = ecefPos.size();
+  llaPos.resize(count);
+  if (count == 0)
+    return;
+  const double* x = &ecefPos.x_[0];
+  const double* y = &ecefPos.y_[0];
+  const double* z = &ecefPos.z_[0];
+  double* lat = &llaPos.x_[0];
+  double* lon = &llaPos.y_[0];
+  double* alt = &llaPos.z_[0];
+  // cosine of 67.5 degrees
+  const double cos_67_5 = 0.3826834323650897717284599840304;
+  for (size_t k = 0; k < count; ++k)
+  {
+    // Same Toms (1996) formulation as the Vec3 version.  On the Z axis the estimates
+    // reduce to Cos_p1 == 0, which gives the polar latitude and altitude directly;
+    // only the center of the earth needs a special case.
+    const double xK = x[k];
+    const double yK = y[k];
+    const double zK = z[k];
+    const double W2 = xK * xK + yK * yK;
+    const double W = sqrt(W2);
+    const double T0 = zK * 1.0026000;
+    const double S0 = sqrt(T0 * T0 + W2);
+    const double Sin_B0 = T0 / S0;
+    const double Cos_B0 = W / S0;
+    const double T1 = zK + WGS_B * WGS_EP2 * Sin_B0 * Sin_B0 * Sin_B0;
+    const double Sum = W - WGS_A * WGS_ESQ * Cos_B0 * Cos_B0 * Cos_B0;
+    const double S1 = sqrt(T1 * T1 + Sum * Sum);
+    const double Sin_p1 = T1 / S1;
+    const double Cos_p1 = Sum / S1;
+    const double Rn = WGS_A / sqrt(1.0 - WGS_ESQ * Sin_p1 * Sin_p1);
+
+    const double absCos = fabs(Cos_p1);
+    const double altK = (absCos >= cos_67_5) ? (W / absCos - Rn) : (zK / Sin_p1 + Rn * (WGS_ESQ - 1.0));
+    const double latK = (W2 == 0.0) ? (zK < 0.0 ? -M_PI_2 : M_PI_2) : atan(Sin_p1 / Cos_p1);
+    const bool center = (W2 == 0.0 && zK == 0.0);
+    lon[k] = (W2 == 0.0) ? 0.0 : atan2(yK, xK);
+    lat[k] = latK;
+    alt[k] = center ? -WGS_B : altK;
+  }
+}
+
+int CoordinateConverter::convertGeodeticPosToFlat(const PositionArrays &llaPos, PositionArrays &flatPos, CoordinateSystem system) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertGeodeticPosToFlat, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (!(system == COORD_SYS_NED || system == COORD_SYS_NWU || system == COORD_SYS_ENU))
+  {
+    SIM_ERROR << "convertGeodeticPosToFlat, invalid local coordinate system: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (refOriginStatus_ == REF_ORIGIN_SCALED_FLAT_EARTH_DEGENERATE)
+  {
+    SIM_ERROR << "convertGeodeticPosToFlat, degenerate reference origin at/near pole: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  assert(llaPos.y_.size() == llaPos.x_.size() && llaPos.z_.size() == llaPos.x_.size());
+  const size_t count = llaPos.size();
+  flatPos.resize(count);
+  if (count == 0)
+    return 0;
+  const double* lat = &llaPos.x_[0];
+  const double* lon = &llaPos.y_[0];
+  const double* alt = &llaPos.z_[0];
+  double* x = &flatPos.x_[0];
+  double* y = &flatPos.y_[0];
+  double* z = &flatPos.z_[0];
+
+  // North, east and up are computed for every system, then arranged per system
+  const double refLat = referenceOrigin_.lat();
+  const double refLon = referenceOrigin_.lon();
+  const double refAlt = referenceOrigin_.alt();
+  const double northSign = 1.0;
+  const double eastSign = (system == COORD_SYS_NWU) ? -1.0 : 1.0;
+  const double upSign = (system == COORD_SYS_NED) ? -1.0 : 1.0;
+  const bool eastFirst = (system == COORD_SYS_ENU);
+  for (size_t k = 0; k < count; ++k)
+  {
+    const double north = northSign * angFixPI2(lat[k] - refLat) * latRadius_;
+    const double east = eastSign * angFixPI(lon[k] - refLon) * lonRadius_;
+    const double up = upSign * (alt[k] - refAlt);
+    x[k] = eastFirst ? east : north;
+    y[k] = eastFirst ? north : east;
+    z[k] = up;
+  }
+  return 0;
+}
+
+int CoordinateConverter::convertFlatPosToGeodetic(const PositionArrays &flatPos, CoordinateSystem system, PositionArrays &llaPos) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertFlatPosToGeodetic, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (!(system == COORD_SYS_NED || system == COORD_SYS_NWU || system == COORD_SYS_ENU))
+  {
+    SIM_ERROR << "convertFlatPosToGeodetic, invalid local coordinate system: " << __LINE__ << std::endl;
+    return 1;
+  }
+  if (refOriginStatus_ == REF_ORIGIN_SCALED_FLAT_EARTH_DEGENERATE)
+  {
+    SIM_ERROR << "convertFlatPosToGeodetic, degenerate reference origin at/near pole: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  assert(flatPos.y_.size() == flatPos.x_.size() && flatPos.z_.size() == flatPos.x_.size());
+  const size_t count = flatPos.size();
+  llaPos.resize(count);
+  if (count == 0)
+    return 0;
+  const double* x = &flatPos.x_[0];
+  const double* y = &flatPos.y_[0];
+  const double* z = &flatPos.z_[0];
+  double* lat = &llaPos.x_[0];
+  double* lon = &llaPos.y_[0];
+  double* alt = &llaPos.z_[0];
+
+  const double refLat = referenceOrigin_.lat();
+  const double refLon = referenceOrigin_.lon();
+  const double refAlt = referenceOrigin_.alt();
+  const double eastSign = (system == COORD_SYS_NWU) ? -1.0 : 1.0;
+  const double upSign = (system == COORD_SYS_NED) ? -1.0 : 1.0;
+  const bool eastFirst = (system == COORD_SYS_ENU);
+  for (size_t k = 0; k < count; ++k)
+  {
+    const double north = eastFirst ? y[k] : x[k];
+    const double east = eastSign * (eastFirst ? x[k] : y[k]);
+    const double up = upSign * z[k];
+    lat[k] = north * invLatRadius_ + refLat;
+    lon[k] = east * invLonRadius_ + refLon;
+    alt[k] = up + refAlt;
+  }
+  return 0;
+}
+
+int CoordinateConverter::convertEcefPosToXEast(const PositionArrays &ecefPos, PositionArrays &tpPos) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertEcefPosToXEast, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  assert(ecefPos.y_.size() == ecefPos.x_.size() && ecefPos.z_.size() == ecefPos.x_.size());
+  const size_t count = ecefPos.size();
+  tpPos.resize(count);
+  if (count == 0)
+    return 0;
+  const double* x = &ecefPos.x_[0];
+  const double* y = &ecefPos.y_[0];
+  const double* z = &ecefPos.z_[0];
+  double* tpX = &tpPos.x_[0];
+  double* tpY = &tpPos.y_[0];
+  double* tpZ = &tpPos.z_[0];
+
+  // translate to the tangent plane origin, then rotate to X-East
+  const double (&m)[3][3] = rotationMatrixENU_;
+  const double tx = tangentPlaneTranslation_.x();
+  const double ty = tangentPlaneTranslation_.y();
+  const double tz = tangentPlaneTranslation_.z();
+  for (size_t k = 0; k < count; ++k)
+  {
+    const double dx = x[k] - tx;
+    const double dy = y[k] - ty;
+    const double dz = z[k] - tz;
+    tpX[k] = m[0][0] * dx + m[0][1] * dy + m[0][2] * dz;
+    tpY[k] = m[1][0] * dx + m[1][1] * dy + m[1][2] * dz;
+    tpZ[k] = m[2][0] * dx + m[2][1] * dy + m[2][2] * dz;
+  }
+  return 0;
+}
+
+int CoordinateConverter::convertXEastPosToEcef(const PositionArrays &tpPos, PositionArrays &ecefPos) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertXEastPosToEcef, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+
+  assert(tpPos.y_.size() == tpPos.x_.size() && tpPos.z_.size() == tpPos.x_.size());
+  const size_t count = tpPos.size();
+  ecefPos.resize(count);
+  if (count == 0)
+    return 0;
+  const double* tpX = &tpPos.x_[0];
+  const double* tpY = &tpPos.y_[0];
+  const double* tpZ = &tpPos.z_[0];
+  double* x = &ecefPos.x_[0];
+  double* y = &ecefPos.y_[0];
+  double* z = &ecefPos.z_[0];
+
+  // rotate to geocentric direction with the transposed matrix, then translate to the earth center origin
+  const double (&m)[3][3] = rotationMatrixENU_;
+  const double tx = tangentPlaneTranslation_.x();
+  const double ty = tangentPlaneTranslation_.y();
+  const double tz = tangentPlaneTranslation_.z();
+  for (size_t k = 0; k < count; ++k)
+  {
+    const double px = tpX[k];
+    const double py = tpY[k];
+    const double pz = tpZ[k];
+    x[k] = m[0][0] * px + m[1][0] * py + m[2][0] * pz + tx;
+    y[k] = m[0][1] * px + m[1][1] * py + m[2][1] * pz + ty;
+    z[k] = m[0][2] * px + m[1][2] * py + m[2][2] * pz + tz;
+  }
+  return 0;
+}
+
+int CoordinateConverter::convertGeodeticPosToXEast(const PositionArrays &llaPos, PositionArrays &tpPos) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertGeodeticPosToXEast, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+  // convert from lla -> ecef -> xeast, reusing the output as the intermediate
+  convertGeodeticPosToEcef(llaPos, tpPos);
+  return convertEcefPosToXEast(tpPos, tpPos);
+}
+
+int CoordinateConverter::convertXEastPosToGeodetic(const PositionArrays &tpPos, PositionArrays &llaPos) const
+{
+  if (!hasReferenceOrigin())
+  {
+    SIM_ERROR << "convertXEastPosToGeodetic, reference origin not set: " << __LINE__ << std::endl;
+    return 1;
+  }
+  // convert from xeast -> ecef -> lla, reusing the output as the intermediate
+  if (convertXEastPosToEcef(tpPos, llaPos) != 0)
+    return 1;
+  convertEcefToGeodeticPos(llaPos, llaPos);
+  return 0;
+}
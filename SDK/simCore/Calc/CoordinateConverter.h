@@ -23,6 +23,7 @@
 #define SIMCORE_CALC_COORDCONVERT_H
 
 #include <cassert>
+#include <vector>
 
 #include "simCore/Common/Common.h"
 #include "simCore/Calc/CoordinateSystem.h"
@@ -107,6 +108,27 @@ namespace simCore
     LOCAL_LEVEL_FRAME_ENU     ///< Local level ENU frame: +X=East, +Y=North, +Z=Up, perpendicular to Earth surface
   };
 
+  /**
+  * Structure-of-arrays positions for the batch conversions in CoordinateConverter.
+  * Geodetic positions store latitude in x_, longitude in y_ and altitude in z_,
+  * matching the component order of Vec3.  All three arrays have the same size.
+  */
+  struct SDKCORE_EXPORT PositionArrays
+  {
+    std::vector<double> x_;  ///< X, North, East or latitude (rad) component
+    std::vector<double> y_;  ///< Y, East, North, West or longitude (rad) component
+    std::vector<double> z_;  ///< Z, Down, Up or altitude (m) component
+
+    /** Returns the number of positions */
+    size_t size() const { return x_.size(); }
+    /** Resizes all three arrays */
+    void resize(size_t count);
+    /** Sets position 'index' from a Vec3 */
+    void set(size_t index, const Vec3& pos);
+    /** Returns position 'index' as a Vec3 */
+    Vec3 get(size_t index) const;
+  };
+
   class SDKCORE_EXPORT CoordinateConverter
   {
   public:
@@ -465,6 +487,90 @@ namespace simCore
     */
     static void convertEcefToGeodeticPos(const Vec3 &ecefPos, Vec3 &llaPos);
 
+    //------------------------------------------------------------------------
+    // Batch position conversions.  These loop over structure-of-arrays input
+    // without per-point Coordinate objects or branching on the data, so the
+    // compiler can keep the loops tight.  Output arrays are resized to match
+    // the input, and the output may be the same object as the input.  The
+    // functions do not modify the converter, so disjoint inputs may be
+    // converted from several threads at once.
+
+    /**
+    * @brief Converts geodetic positions to Earth Centered Earth Fixed (ECEF)
+    *
+    * Batch equivalent of convertGeodeticPosToEcef(const Vec3&, Vec3&, double, double)
+    * @param[in ] llaPos Lat, lon, alt (rad, rad, m)
+    * @param[out] ecefPos ECEF positions (m)
+    * @param[in ] semiMajor semi major Earth radius
+    * @param[in ] eccentricitySquared Earth eccentricity, squared
+    */
+    static void convertGeodeticPosToEcef(const PositionArrays &llaPos, PositionArrays &ecefPos, double semiMajor = WGS_A, double eccentricitySquared = WGS_ESQ);
+
+    /**
+    * @brief Converts Earth Centered Earth Fixed (ECEF) positions to geodetic
+    *
+    * Batch equivalent of convertEcefToGeodeticPos(const Vec3&, Vec3&)
+    * @param[in ] ecefPos ECEF positions (m)
+    * @param[out] llaPos Lat, lon, alt (rad, rad, m)
+    */
+    static void convertEcefToGeodeticPos(const PositionArrays &ecefPos, PositionArrays &llaPos);
+
+    /**
+    * @brief Converts geodetic positions to a scaled flat earth system
+    *
+    * @param[in ] llaPos Lat, lon, alt (rad, rad, m)
+    * @param[out] flatPos Scaled flat earth positions (m)
+    * @param[in ] system Flat earth system (NED, NWU or ENU)
+    * @return 0 on success, !0 if the reference origin is not set or degenerate, or the system is not a flat earth system
+    */
+    int convertGeodeticPosToFlat(const PositionArrays &llaPos, PositionArrays &flatPos, CoordinateSystem system) const;
+
+    /**
+    * @brief Converts scaled flat earth positions to geodetic
+    *
+    * @param[in ] flatPos Scaled flat earth positions (m)
+    * @param[in ] system Flat earth system of flatPos (NED, NWU or ENU)
+    * @param[out] llaPos Lat, lon, alt (rad, rad, m)
+    * @return 0 on success, !0 if the reference origin is not set or degenerate, or the system is not a flat earth system
+    */
+    int convertFlatPosToGeodetic(const PositionArrays &flatPos, CoordinateSystem system, PositionArrays &llaPos) const;
+
+    /**
+    * @brief Converts Earth Centered Earth Fixed (ECEF) positions to the X-East tangent plane
+    *
+    * @param[in ] ecefPos ECEF positions (m)
+    * @param[out] tpPos X-East tangent plane positions (m)
+    * @return 0 on success, !0 if the reference origin is not set
+    */
+    int convertEcefPosToXEast(const PositionArrays &ecefPos, PositionArrays &tpPos) const;
+
+    /**
+    * @brief Converts X-East tangent plane positions to Earth Centered Earth Fixed (ECEF)
+    *
+    * @param[in ] tpPos X-East tangent plane positions (m)
+    * @param[out] ecefPos ECEF positions (m)
+    * @return 0 on success, !0 if the reference origin is not set
+    */
+    int convertXEastPosToEcef(const PositionArrays &tpPos, PositionArrays &ecefPos) const;
+
+    /**
+    * @brief Converts geodetic positions to the X-East tangent plane
+    *
+    * @param[in ] llaPos Lat, lon, alt (rad, rad, m)
+    * @param[out] tpPos X-East tangent plane positions (m)
+    * @return 0 on success, !0 if the reference origin is not set
+    */
+    int convertGeodeticPosToXEast(const PositionArrays &llaPos, PositionArrays &tpPos) const;
+
+    /**
+    * @brief Converts X-East tangent plane positions to geodetic
+    *
+    * @param[in ] tpPos X-East tangent plane positions (m)
+    * @param[out] llaPos Lat, lon, alt (rad, rad, m)
+    * @return 0 on success, !0 if the reference origin is not set
+    */
+    int convertXEastPosToGeodetic(const PositionArrays &tpPos, PositionArrays &llaPos) const;
+
     /**
     * @brief Converts an Earth Centered Earth Fixed (ECEF) velocity to geodetic
     *
@@ -19,6 +19,7 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include "simCore/Calc/Geometry.h"
 #include "simCore/Calc/CoordinateSystem.h"
 #include "simCore/Calc/CoordinateConverter.h"
@@ -26,6 +27,14 @@
 
 using namespace simCore;
 
+namespace
+{
+  /** Distance in meters a point may be below a polytope's plane and still be contained */
+  const double POLYTOPE_EPSILON = 1e-5;
+  /** Points closer than this to the earth's center, in meters, are not located in the fence index grid */
+  const double MIN_INDEX_RADIUS = 1e6;
+}
+
 //------------------------------------------------------------------------
 
 #undef  LC
@@ -70,7 +79,11 @@ Polytope::Polytope()
 }
 
 Polytope::Polytope(const Polytope& rhs) :
-planes_(rhs.planes_)
+planes_(rhs.planes_),
+a_(rhs.a_),
+b_(rhs.b_),
+c_(rhs.c_),
+d_(rhs.d_)
 {
   //nop
 }
@@ -78,25 +91,60 @@ planes_(rhs.planes_)
 void Polytope::addPlane(const Plane& plane)
 {
   planes_.push_back(plane);
+  const double* v = plane.coefficients();
+  a_.push_back(v[0]);
+  b_.push_back(v[1]);
+  c_.push_back(v[2]);
+  d_.push_back(v[3]);
 }
 
 bool Polytope::contains(const Vec3& p) const
 {
-  const double epsilon = 1e-5;
-
   for (std::vector<Plane>::const_iterator i = planes_.begin(); i != planes_.end(); ++i)
   {
     const Plane& plane = *i;
     double dist = plane.distance(p);
-    if (dist+epsilon < 0.0)
+    if (dist+POLYTOPE_EPSILON < 0.0)
       return false;
   }
   return true;
 }
 
+void Polytope::contains(const Vec3String& points, std::vector<bool>& results) const
+{
+  const size_t numPoints = points.size();
+  // Separate coordinate arrays let the compiler vectorize each plane's test across the points
+  std::vector<double> x(numPoints);
+  std::vector<double> y(numPoints);
+  std::vector<double> z(numPoints);
+  for (size_t k = 0; k < numPoints; ++k)
+  {
+    x[k] = points[k].x();
+    y[k] = points[k].y();
+    z[k] = points[k].z();
+  }
+
+  std::vector<unsigned char> inside(numPoints, 1);
+  for (size_t i = 0; i < a_.size(); ++i)
+  {
+    const double a = a_[i];
+    const double b = b_[i];
+    const double c = c_[i];
+    const double d = d_[i];
+    // Same arithmetic as Plane::distance() and contains(), so the answers match exactly
+    for (size_t k = 0; k < numPoints; ++k)
+      inside[k] &= !(a*x[k] + b*y[k] + c*z[k] + d + POLYTOPE_EPSILON < 0.0);
+  }
+  results.assign(inside.begin(), inside.end());
+}
+
 void Polytope::clear()
 {
   planes_.clear();
+  a_.clear();
+  b_.clear();
+  c_.clear();
+  d_.clear();
 }
 
 //------------------------------------------------------------------------
@@ -104,7 +152,11 @@ void Polytope::clear()
 #undef  LC
 #define LC "[simCore::GeoFence] "
 
-GeoFence::GeoFence() : valid_(false)
+GeoFence::GeoFence() :
+valid_(false),
+hasCap_(false),
+capCos_(-1.0),
+capMargin_(0.0)
 {
   //nop
 }
@@ -112,12 +164,20 @@ GeoFence::GeoFence() : valid_(false)
 GeoFence::GeoFence(const GeoFence& rhs) :
 points_(rhs.points_),
 tope_(rhs.tope_),
-valid_(rhs.valid_)
+valid_(rhs.valid_),
+hasCap_(rhs.hasCap_),
+capAxis_(rhs.capAxis_),
+capCos_(rhs.capCos_),
+capMargin_(rhs.capMargin_)
 {
   //nop
 }
 
-GeoFence::GeoFence(const Vec3String& points, const CoordinateSystem& cs)
+GeoFence::GeoFence(const Vec3String& points, const CoordinateSystem& cs) :
+valid_(false),
+hasCap_(false),
+capCos_(-1.0),
+capMargin_(0.0)
 {
   set(points, cs);
 }
@@ -127,6 +187,7 @@ void GeoFence::set(const Vec3String& points, const CoordinateSystem& cs)
   // must have at least three vertices
   if (points.size() <= 2)
     return;
+  hasCap_ = false;
 
   // We want ECEF. Convert the input to ECEF if necessary.
   if (cs == COORD_SYS_ECEF)
@@ -161,13 +222,55 @@ void GeoFence::set(const Vec3String& points, const CoordinateSystem& cs)
 
   // validate.
   valid_ = verifyConvexity_(points_);
+  computeCap_();
 }
 
 bool GeoFence::contains(const Vec3& ecef) const
 {
+    if (hasCap_ && outsideCap_(ecef))
+      return false;
     return tope_.contains(ecef);
 }
 
+void GeoFence::contains(const Vec3String& ecefPoints, std::vector<bool>& results) const
+{
+  if (!hasCap_)
+  {
+    tope_.contains(ecefPoints, results);
+    return;
+  }
+
+  // Only the points inside the cap need the plane tests
+  Vec3String candidates;
+  std::vector<size_t> indices;
+  for (size_t k = 0; k < ecefPoints.size(); ++k)
+  {
+    if (!outsideCap_(ecefPoints[k]))
+    {
+      candidates.push_back(ecefPoints[k]);
+      indices.push_back(k);
+    }
+  }
+
+  results.assign(ecefPoints.size(), false);
+  if (candidates.empty())
+    return;
+  std::vector<bool> inside;
+  tope_.contains(candidates, inside);
+  for (size_t k = 0; k < indices.size(); ++k)
+    results[indices[k]] = inside[k];
+}
+
+bool GeoFence::boundingCap(Vec3& axis, double& cosRadius, double& margin) const
+{
+  if (!hasCap_)
+    return false;
+  axis = capAxis_;
+  cosRadius = capCos_;
+  margin = capMargin_;
+  return true;
+}
+
 bool GeoFence::contains(const Coordinate& input) const
 {
     if (input.coordinateSystem() == COORD_SYS_ECEF)
@@ -195,3 +298,229 @@ bool GeoFence::verifyConvexity_(const Vec3String& v) const
   }
   return true;
 }
+
+void GeoFence::computeCap_()
+{
+  hasCap_ = false;
+  // Open fences are not bounded; a closed triangle needs 4 points
+  if (!valid_ || points_.size() < 4 || points_.front() != points_.back())
+    return;
+
+  // Center the cap on the mean direction of the fence posts
+  const size_t numPosts = points_.size() - 1;
+  Vec3 sum;
+  for (size_t i = 0; i < numPosts; ++i)
+  {
+    Vec3 unit;
+    v3Norm(points_[i], unit);
+    v3Add(sum, unit, sum);
+  }
+  if (v3Length(sum) == 0.0)
+    return;
+  Vec3 axis;
+  v3Norm(sum, axis);
+
+  // The fence is convex, so the smallest cap around its posts holds the whole fence,
+  // as long as that cap is smaller than a hemisphere
+  double cosRadius = 1.0;
+  for (size_t i = 0; i < numPosts; ++i)
+  {
+    Vec3 unit;
+    v3Norm(points_[i], unit);
+    cosRadius = sdkMin(cosRadius, v3Dot(unit, axis));
+  }
+  if (cosRadius <= 0.0)
+    return;
+
+  // contains() accepts points up to POLYTOPE_EPSILON below each plane. Stepping such a point
+  // along the axis by POLYTOPE_EPSILON / (smallest normal . axis) puts it inside every plane, and
+  // therefore inside the cap, so the point is within twice that distance of the cap.
+  double minNormalDot = 1.0;
+  const Vec3 origin(0, 0, 0);
+  for (size_t i = 0; i < numPosts; ++i)
+  {
+    const Plane plane(points_[i], points_[i + 1], origin);
+    const double* v = plane.coefficients();
+    minNormalDot = sdkMin(minNormalDot, v[0]*axis.x() + v[1]*axis.y() + v[2]*axis.z());
+  }
+  if (minNormalDot <= 0.0)
+    return;
+
+  capAxis_ = axis;
+  // pad for rounding in the plane constants and the cap test itself
+  capCos_ = cosRadius - 1e-9;
+  capMargin_ = 2.0 * (POLYTOPE_EPSILON + 1e-6) / minNormalDot;
+  hasCap_ = true;
+}
+
+bool GeoFence::outsideCap_(const Vec3& ecef) const
+{
+  return v3Dot(ecef, capAxis_) < capCos_ * v3Length(ecef) - capMargin_;
+}
+
+//------------------------------------------------------------------------
+
+#undef  LC
+#define LC "[simCore::GeoFenceIndex] "
+
+GeoFenceIndex::GeoFenceIndex(double cellSize)
+{
+  if (cellSize <= 0.0)
+    cellSize = 5.0 * M_PI / 180.0;
+  numRows_ = sdkMax(1, static_cast<int>(ceil(M_PI / cellSize)));
+  numCols_ = sdkMax(1, static_cast<int>(ceil(M_TWOPI / cellSize)));
+  rowSize_ = M_PI / numRows_;
+  colSize_ = M_TWOPI / numCols_;
+  cells_.resize(numRows_ * numCols_);
+}
+
+GeoFenceIndex::~GeoFenceIndex()
+{
+}
+
+size_t GeoFenceIndex::addFence(const std::shared_ptr<const GeoFence>& fence)
+{
+  const size_t index = fences_.size();
+  fences_.push_back(fence);
+
+  Vec3 axis;
+  double cosRadius = 0.0;
+  double margin = 0.0;
+  if (!fence || !fence->boundingCap(axis, cosRadius, margin))
+  {
+    unbounded_.push_back(index);
+    return index;
+  }
+
+  // Angular radius of the cap for every point far enough from the earth's center to be located in the grid
+  const double cosGridRadius = cosRadius - margin / MIN_INDEX_RADIUS;
+  if (cosGridRadius <= 0.0)
+  {
+    unbounded_.push_back(index);
+    return index;
+  }
+  const double radius = acos(sdkMin(1.0, cosGridRadius)) + 1e-9;
+
+  // Geocentric latitude and longitude of the cap center
+  const double lat = asin(sdkMax(-1.0, sdkMin(1.0, axis.z())));
+  const double lon = atan2(axis.y(), axis.x());
+
+  const int firstRow = sdkMax(0, static_cast<int>(floor((lat - radius + M_PI_2) / rowSize_)));
+  const int lastRow = sdkMin(numRows_ - 1, static_cast<int>(floor((lat + radius + M_PI_2) / rowSize_)));
+
+  // Caps over a pole cover every longitude
+  int firstCol = 0;
+  int lastCol = numCols_ - 1;
+  if (lat + radius < M_PI_2 && lat - radius > -M_PI_2)
+  {
+    // Widest longitude reach of a cap that does not cover a pole
+    const double lonRadius = asin(sdkMin(1.0, sin(radius) / cos(lat))) + 1e-9;
+    const int first = static_cast<int>(floor((lon - lonRadius + M_PI) / colSize_));
+    const int last = static_cast<int>(floor((lon + lonRadius + M_PI) / colSize_));
+    if (last - first + 1 < numCols_)
+    {
+      firstCol = first;
+      lastCol = last;
+    }
+  }
+
+  for (int row = firstRow; row <= lastRow; ++row)
+  {
+    for (int col = firstCol; col <= lastCol; ++col)
+    {
+      // wrap across the anti-meridian
+      const int wrapped = ((col % numCols_) + numCols_) % numCols_;
+      cells_[row * numCols_ + wrapped].push_back(index);
+    }
+  }
+  return index;
+}
+
+size_t GeoFenceIndex::numFences() const
+{
+  return fences_.size();
+}
+
+void GeoFenceIndex::clear()
+{
+  fences_.clear();
+  unbounded_.clear();
+  for (std::vector<std::vector<size_t> >::iterator i = cells_.begin(); i != cells_.end(); ++i)
+    i->clear();
+}
+
+int GeoFenceIndex::cellOf_(const Vec3& ecef) const
+{
+  const double length = v3Length(ecef);
+  if (length < MIN_INDEX_RADIUS)
+    return -1;
+  const double lat = asin(sdkMax(-1.0, sdkMin(1.0, ecef.z() / length)));
+  const double lon = atan2(ecef.y(), ecef.x());
+  const int row = sdkMax(0, sdkMin(numRows_ - 1, static_cast<int>(floor((lat + M_PI_2) / rowSize_))));
+  const int col = sdkMax(0, sdkMin(numCols_ - 1, static_cast<int>(floor((lon + M_PI) / colSize_))));
+  return row * numCols_ + col;
+}
+
+void GeoFenceIndex::candidates_(const Vec3& ecef, std::vector<size_t>& fences) const
+{
+  const int cell = cellOf_(ecef);
+  if (cell < 0)
+  {
+    for (size_t i = 0; i < fences_.size(); ++i)
+      fences.push_back(i);
+    return;
+  }
+  // Each fence is either unbounded or in the cells; both lists are in increasing order
+  const std::vector<size_t>& bounded = cells_[cell];
+  const size_t start = fences.size();
+  fences.resize(start + bounded.size() + unbounded_.size());
+  std::merge(bounded.begin(), bounded.end(), unbounded_.begin(), unbounded_.end(), fences.begin() + start);
+}
+
+void GeoFenceIndex::find(const Vec3& ecef, std::vector<size_t>& fences) const
+{
+  fences.clear();
+  candidates_(ecef, fences);
+  size_t numFound = 0;
+  for (size_t i = 0; i < fences.size(); ++i)
+  {
+    const GeoFence* fence = fences_[fences[i]].get();
+    if (fence && fence->contains(ecef))
+      fences[numFound++] = fences[i];
+  }
+  fences.resize(numFound);
+}
+
+void GeoFenceIndex::find(const Vec3String& ecefPoints, std::vector<std::vector<size_t> >& fences) const
+{
+  fences.assign(ecefPoints.size(), std::vector<size_t>());
+
+  // Gather the candidate points of each fence, so each fence classifies its points together
+  std::vector<Vec3String> fencePoints(fences_.size());
+  std::vector<std::vector<size_t> > fencePointIndices(fences_.size());
+  std::vector<size_t> candidates;
+  for (size_t k = 0; k < ecefPoints.size(); ++k)
+  {
+    candidates.clear();
+    candidates_(ecefPoints[k], candidates);
+    for (std::vector<size_t>::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
+    {
+      fencePoints[*i].push_back(ecefPoints[k]);
+      fencePointIndices[*i].push_back(k);
+    }
+  }
+
+  // Visiting the fences in order keeps each point's list in increasing order
+  std::vector<bool> inside;
+  for (size_t i = 0; i < fences_.size(); ++i)
+  {
+    if (fencePoints[i].empty() || !fences_[i])
+      continue;
+    fences_[i]->contains(fencePoints[i], inside);
+    for (size_t k = 0; k < inside.size(); ++k)
+    {
+      if (inside[k])
+        fences[fencePointIndices[i][k]].push_back(i);
+    }
+  }
+}
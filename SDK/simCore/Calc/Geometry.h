@@ -26,6 +26,7 @@
 #include "simCore/Calc/Coordinate.h"
 #include "simCore/Calc/CoordinateSystem.h"
 #include "simCore/Calc/Math.h"
+#include <memory>
 #include <vector>
 
 namespace simCore
@@ -64,6 +65,12 @@ namespace simCore
     */
     double distance(const Vec3& point) const;
 
+    /**
+    * Coefficients (a, b, c, d) of the plane equation ax + by + cz + d = 0, where
+    * (a, b, c) is the unit normal vector.
+    */
+    const double* coefficients() const { return v_; }
+
   protected:
     /** Vector representing the plane */
     double v_[4];
@@ -102,6 +109,14 @@ namespace simCore
     */
     bool contains(const Vec3& point) const;
 
+    /**
+    * Classifies a batch of points. Gives the same answers as calling contains()
+    * on each point, but tests each plane against all of the points at once.
+    * @param[in ] points Points to test.
+    * @param[out] results Resized to match points; true for each contained point.
+    */
+    void contains(const Vec3String& points, std::vector<bool>& results) const;
+
     /**
     * Resets the polytope by removing all planes.
     */
@@ -110,6 +125,14 @@ namespace simCore
   protected:
     /** Vector of all planes that, together, represent the polytope */
     std::vector<Plane> planes_;
+    /** X coefficient of each plane, kept apart for testing many points at once */
+    std::vector<double> a_;
+    /** Y coefficient of each plane */
+    std::vector<double> b_;
+    /** Z coefficient of each plane */
+    std::vector<double> c_;
+    /** Constant term of each plane */
+    std::vector<double> d_;
   };
 
   /// Geographic, convex bounding region formed from a line string boundary.
@@ -169,6 +192,26 @@ namespace simCore
     */
     bool contains(const Coordinate& coord) const;
 
+    /**
+    * Classifies a batch of ECEF points. Gives the same answers as calling contains()
+    * on each point; points outside the bounding cap are rejected before the planes
+    * are tested.
+    * @param[in ] ecefPoints Points to test; must be ECEF.
+    * @param[out] results Resized to match ecefPoints; true for each contained point.
+    */
+    void contains(const Vec3String& ecefPoints, std::vector<bool>& results) const;
+
+    /**
+    * Retrieves the spherical cap bounding the fence. Only valid, closed fences smaller
+    * than a hemisphere have a bounding cap. A point p can only be contained if
+    * (p . axis) >= cosRadius * |p| - margin.
+    * @param[out] axis Unit vector from the earth's center through the center of the cap
+    * @param[out] cosRadius Cosine of the angular radius of the cap
+    * @param[out] margin Tolerance in meters, covering the tolerance of the plane tests
+    * @return True if the fence has a bounding cap, false if it may contain any point
+    */
+    bool boundingCap(Vec3& axis, double& cosRadius, double& margin) const;
+
     /** dtor */
     virtual ~GeoFence() { }
 
@@ -180,9 +223,88 @@ namespace simCore
     Polytope   tope_;
     /** True when the shape is valid */
     bool       valid_;
+    /** True when the fence has a bounding cap */
+    bool       hasCap_;
+    /** Unit vector through the center of the bounding cap */
+    Vec3       capAxis_;
+    /** Cosine of the angular radius of the bounding cap */
+    double     capCos_;
+    /** Tolerance of the bounding cap test in meters */
+    double     capMargin_;
 
     /// call this after set
     bool verifyConvexity_(const Vec3String& v) const;
+    /// computes the bounding cap; call this after verifyConvexity_
+    void computeCap_();
+    /// true if the ECEF point is certainly outside the bounding cap
+    bool outsideCap_(const Vec3& ecef) const;
+  };
+
+  /// Index over many GeoFences, for finding all of the fences that contain a point.
+  /// Fences are bucketed by their bounding caps on a grid of geocentric latitude and
+  /// longitude cells, so a point is only tested against the fences near it. Fences
+  /// without a bounding cap, and points near the center of the earth, are tested
+  /// against everything. Fences must not be changed after they are added.
+  class SDKCORE_EXPORT GeoFenceIndex
+  {
+  public:
+    /**
+    * Constructs an empty index
+    * @param[in ] cellSize Size of the grid cells in radians
+    */
+    explicit GeoFenceIndex(double cellSize = 5.0 * M_PI / 180.0);
+
+    /** dtor */
+    virtual ~GeoFenceIndex();
+
+    /**
+    * Adds a fence to the index
+    * @param[in ] fence Fence to add; must not be NULL
+    * @return Index of the fence, reported by find()
+    */
+    size_t addFence(const std::shared_ptr<const GeoFence>& fence);
+
+    /** Number of fences in the index */
+    size_t numFences() const;
+
+    /** Removes all fences */
+    void clear();
+
+    /**
+    * Finds the fences that contain an ECEF point
+    * @param[in ] ecef Point to test; must be ECEF
+    * @param[out] fences Indices of the containing fences, in increasing order
+    */
+    void find(const Vec3& ecef, std::vector<size_t>& fences) const;
+
+    /**
+    * Finds the fences that contain each of a batch of ECEF points, classifying the
+    * candidate points of each fence together
+    * @param[in ] ecefPoints Points to test; must be ECEF
+    * @param[out] fences For each point, the indices of the containing fences, in increasing order
+    */
+    void find(const Vec3String& ecefPoints, std::vector<std::vector<size_t> >& fences) const;
+
+  private:
+    /** Returns the cell containing the point, or -1 if the point is too close to the earth's center to index */
+    int cellOf_(const Vec3& ecef) const;
+    /** Appends the fences that might contain the point, in increasing order */
+    void candidates_(const Vec3& ecef, std::vector<size_t>& fences) const;
+
+    /** All fences, in the order they were added */
+    std::vector<std::shared_ptr<const GeoFence> > fences_;
+    /** Fences without a bounding cap, tested against every point */
+    std::vector<size_t> unbounded_;
+    /** For each grid cell, the fences whose caps overlap it; row major by latitude */
+    std::vector<std::vector<size_t> > cells_;
+    /** Number of latitude rows in the grid */
+    int numRows_;
+    /** Number of longitude columns in the grid */
+    int numCols_;
+    /** Height of a row in radians */
+    double rowSize_;
+    /** Width of a column in radians */
+    double colSize_;
   };
 
 } // namespace simCore
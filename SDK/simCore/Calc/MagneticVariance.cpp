@@ -19,6 +19,8 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cmath>
 #include <string.h>
 #include "simCore/Calc/Vec3.h"
 #include "simCore/Calc/Angle.h"
@@ -52,7 +54,7 @@ static const double K_COEFF[13][13]=
 static const double FN_COEFF[13] = {0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13};
 static const double FM_COEFF[13] = {0, 1, 2, 3, 4, 5, 6, 7, 8,  9, 10, 11, 12};
 
-static double SNORM_COEFF[169] =
+static const double SNORM_COEFF[169] =
 {
   1, 1, 1.5, 2.5, 4.375, 7.875, 14.4375, 26.8125, 50.2734375, 94.9609375, 180.42578125, 344.44921875, 660.1943359375,
   0, 1, 1.732050807568877, 3.061862178478973, 5.533985905294664, 10.16658128379447, 18.90312474169284, 35.46960351395967,
@@ -337,6 +339,49 @@ static const double GEOMAG_C4 = GEOMAG_A4 - GEOMAG_B4;
 
 ////////////////////////////////////////////////////////////////
 
+/** Returns the Gauss coefficients and their annual changes for an epoch year */
+static void epochCoefficients(int epochYear, const double (*&c)[13], const double (*&cd)[13])
+{
+  switch (epochYear)
+  {
+  case 1985:
+    c = WMM1985_C;
+    cd = WMM1985_CD;
+    break;
+  case 1990:
+    c = WMM1990_C;
+    cd = WMM1990_CD;
+    break;
+  case 1995:
+    c = WMM1995_C;
+    cd = WMM1995_CD;
+    break;
+  case 2000:
+    c = WMM2000_C;
+    cd = WMM2000_CD;
+    break;
+  case 2005:
+    c = WMM2005_C;
+    cd = WMM2005_CD;
+    break;
+  case 2010:
+    c = WMM2010_C;
+    cd = WMM2010_CD;
+    break;
+  default:
+  case 2015:
+    c = WMM2015_C;
+    cd = WMM2015_CD;
+    break;
+  }
+}
+
+/** Returns the ordinal day of a time stamp, as used by the WMM */
+static int ordinalDay(const simCore::TimeStamp& timeStamp)
+{
+  return static_cast<int>(timeStamp.secondsSinceRefYear().Double() / 86400.0);
+}
+
 /** Encapsulates the variables needed for calculation of WMM variances */
 class WorldMagneticModel::GeoMag
 {
@@ -344,6 +389,7 @@ public:
   /** Constructor initializes all values */
   GeoMag()
     : epochYear_(1985),
+      dateValid_(false),
       dec_(0),
       ct_(0),
       st_(0),
@@ -351,12 +397,6 @@ public:
       d_(0),
       ca_(0),
       sa_(0),
-      aor_(0),
-      ar_(0),
-      br_(0),
-      bt_(0),
-      bp_(0),
-      bpp_(0),
       otime_(-1000),
       oalt_(-1000),
       olat_(-1000),
@@ -369,6 +409,8 @@ public:
     memset(sp_, 0, 13 * sizeof(double));
     memset(cp_, 0, 13 * sizeof(double));
     memset(pp_, 0, 13 * sizeof(double));
+    // Legendre functions are stored per instance, so the cached values cannot be overwritten by another model
+    memcpy(p_, SNORM_COEFF, 169 * sizeof(double));
     cp_[0] = 1.0;
     pp_[0] = 1.0;
   }
@@ -379,18 +421,28 @@ public:
   /** Calculates the magnetic variation in radians. */
   int calculateVariance(const simCore::Vec3& lla, int ordinalDay, int refYear, double& variance);
 
+  /**
+   * Time adjusts the Gauss coefficients for a date.  The coefficients are kept until the date changes.
+   * @return 0 on success, non-zero if the date is outside the model
+   */
+  int setDate(int ordinalDay, int refYear);
+
+  /** Calculates the magnetic variation in radians at the date of the last successful setDate() */
+  double calculateVariance(const simCore::Vec3& lla);
+
 private:
   int epochYear_;
+  bool dateValid_;
   double dec_;
 
   // WORLD MAGNETIC MODEL SPHERICAL HARMONIC COEFFICIENTS
   double tc_[13][13];
   double dp_[13][13];
+  double p_[169];
   double sp_[13];
   double cp_[13];
   double pp_[13];
   double ct_, st_, r_, d_, ca_, sa_;
-  double aor_, ar_, br_, bt_, bp_, bpp_;
   double otime_, oalt_, olat_, olon_;
   int oyear_;
 };
@@ -462,52 +514,85 @@ private:
 
 // // // // // // // // // // // // // // // // // // // // // // //
 
-int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int ordinalDay, int refYear, double& variance)
+int WorldMagneticModel::GeoMag::setDate(int ordinalDay, int refYear)
 {
   // convert time to year decimal fraction
   const double time = static_cast<double>(refYear)+static_cast<double>(ordinalDay) / 365.25;
 
   // determine appropriate epoch year
+  int epochYear;
   if (refYear >= 1985 && refYear < 1990)
-    epochYear_ = 1985;
+    epochYear = 1985;
   else if (refYear >= 1990 && refYear < 1995)
-    epochYear_ = 1990;
+    epochYear = 1990;
   else if (refYear >= 1995 && refYear < 2000)
-    epochYear_ = 1995;
+    epochYear = 1995;
   else if (refYear >= 2000 && refYear < 2005)
-    epochYear_ = 2000;
+    epochYear = 2000;
   else if (refYear >= 2005 && refYear < 2010)
-    epochYear_ = 2005;
+    epochYear = 2005;
   else if (refYear >= 2010 && refYear < 2015)
-    epochYear_ = 2010;
+    epochYear = 2010;
   else
     // default to last updated WMM
-    epochYear_ = 2015;
+    epochYear = 2015;
 
-  const double dt = time - static_cast<double>(epochYear_);
-
-  // convert alt from m to km
-  const double altkm = lla.alt() / 1000.;
+  // coefficients are already adjusted for this date
+  if (time == otime_ && epochYear == oyear_)
+    return dateValid_ ? 0 : 1;
 
-  // convert rad to deg
-  const double dlat = simCore::RAD2DEG * lla.lat();
-  const double dlon = simCore::RAD2DEG * lla.lon();
+  epochYear_ = epochYear;
+  oyear_ = epochYear;
+  otime_ = time;
+  dateValid_ = (time <= epochYear_ + 5 && time >= epochYear_);
+  if (!dateValid_)
+    return 1;
 
-  // check for exact location
-  if (altkm == oalt_ && dlat == olat_ && dlon == olon_ &&
-    otime_ == time && oyear_ == epochYear_)
+  // TIME ADJUST THE GAUSS COEFFICIENTS
+  const double dt = time - static_cast<double>(epochYear_);
+  const double (*c)[13] = NULL;
+  const double (*cd)[13] = NULL;
+  epochCoefficients(epochYear_, c, cd);
+  for (int n = 1; n <= GEO_MAG_MAX_DEG; n++)
   {
-    variance = dec_;
-    return 0;
+    for (int m = 0; m <= n; m++)
+    {
+      tc_[m][n] = c[m][n] + dt * cd[m][n];
+      if (m != 0)
+        tc_[n][m - 1] = c[n][m - 1] + dt * cd[n][m - 1];
+    }
   }
 
-  if (time > epochYear_ + 5 || time < epochYear_)
+  // force the next variance calculation
+  olon_ = -1000;
+  return 0;
+}
+
+int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int ordinalDay, int refYear, double& variance)
+{
+  if (setDate(ordinalDay, refYear) != 0)
   {
     variance = 0.0;
     return 1;
   }
+  variance = calculateVariance(lla);
+  return 0;
+}
+
+double WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla)
+{
+  // convert alt from m to km
+  const double altkm = lla.alt() / 1000.;
 
-  double *p = SNORM_COEFF;
+  // convert rad to deg
+  const double dlat = simCore::RAD2DEG * lla.lat();
+  const double dlon = simCore::RAD2DEG * lla.lon();
+
+  // check for exact location; setDate() resets olon_ when the coefficients change
+  if (altkm == oalt_ && dlat == olat_ && dlon == olon_)
+    return dec_;
+
+  double *p = p_;
   const double srlon = sin(lla.lon());
   const double srlat = sin(lla.lat());
   const double crlon = cos(lla.lon());
@@ -516,7 +601,8 @@ int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int
   cp_[1] = crlon;
 
   // CONVERT FROM GEODETIC COORDS. TO SPHERICAL COORDS. */
-  if (altkm != oalt_ || dlat != olat_)
+  const bool newLat = (altkm != oalt_ || dlat != olat_);
+  if (newLat)
   {
     const double srlat2 = srlat * srlat;
     const double crlat2 = crlat * crlat;
@@ -541,33 +627,32 @@ int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int
     }
   }
 
-  aor_ = GEOMAG_RE / r_;
-  ar_ = aor_ * aor_;
-  br_ = bt_ = bp_ = bpp_ = 0.0;
+  const double aor = GEOMAG_RE / r_;
+  double ar = aor * aor;
+  double br = 0.0;
+  double bt = 0.0;
+  double bp = 0.0;
+  double bpp = 0.0;
   for (int n = 1; n <= GEO_MAG_MAX_DEG; n++)
   {
-    ar_ = ar_ * aor_;
-    for (int m = 0, D4 = (n + m + 1); D4 > 0; D4--, m += 1)
+    ar = ar * aor;
+    for (int m = 0; m <= n; m++)
     {
       // COMPUTE UNNORMALIZED ASSOCIATED LEGENDRE POLYNOMIALS
       // AND DERIVATIVES VIA RECURSION RELATIONS
-      if (altkm != oalt_ || dlat != olat_)
+      if (newLat)
       {
         if (n == m)
         {
           *(p + n + m * 13) = st_ * *(p + n - 1 + (m - 1) * 13);
           dp_[m][n] = st_ * dp_[m - 1][n - 1] + ct_ * *(p + n - 1 + (m - 1) * 13);
-          goto S50;
-          // TODO: break ?
         }
-        if (n == 1 && m == 0)
+        else if (n == 1 && m == 0)
         {
           *(p + n + m * 13) = ct_ * *(p + n - 1 + m * 13);
           dp_[m][n] = ct_ * dp_[m][n - 1] - st_ * *(p + n - 1 + m * 13);
-          goto S50;
-          // TODO: break ?
         }
-        if (n > 1 && n != m)
+        else if (n > 1)
         {
           if (m > n - 2) *(p + n - 2 + m * 13) = 0.0;
           if (m > n - 2) dp_[m][n - 2] = 0.0;
@@ -576,60 +661,9 @@ int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int
         }
       }
 
-    S50:
-      // TIME ADJUST THE GAUSS COEFFICIENTS
-      if (time != otime_ || oyear_ != epochYear_)
-      {
-        switch (epochYear_)
-        {
-        case 1985:
-          tc_[m][n] = WMM1985_C[m][n] + dt * WMM1985_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM1985_C[n][m - 1] + dt * WMM1985_CD[n][m - 1];
-          break;
-
-        case 1990:
-          tc_[m][n] = WMM1990_C[m][n] + dt * WMM1990_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM1990_C[n][m - 1] + dt * WMM1990_CD[n][m - 1];
-          break;
-
-        case 1995:
-          tc_[m][n] = WMM1995_C[m][n] + dt * WMM1995_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM1995_C[n][m - 1] + dt * WMM1995_CD[n][m - 1];
-          break;
-
-        case 2000:
-          tc_[m][n] = WMM2000_C[m][n] + dt * WMM2000_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM2000_C[n][m - 1] + dt * WMM2000_CD[n][m - 1];
-          break;
-
-        case 2005:
-          tc_[m][n] = WMM2005_C[m][n] + dt * WMM2005_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM2005_C[n][m - 1] + dt * WMM2005_CD[n][m - 1];
-          break;
-
-        case 2010:
-          tc_[m][n] = WMM2010_C[m][n] + dt * WMM2010_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM2010_C[n][m - 1] + dt * WMM2010_CD[n][m - 1];
-          break;
-
-        default:
-        case 2015:
-          tc_[m][n] = WMM2015_C[m][n] + dt * WMM2015_CD[m][n];
-          if (m != 0)
-            tc_[n][m - 1] = WMM2015_C[n][m - 1] + dt * WMM2015_CD[n][m - 1];
-          break;
-        }
-      }
-
       // ACCUMULATE TERMS OF THE SPHERICAL HARMONIC EXPANSIONS
       double temp1, temp2;
-      double par = ar_ * *(p + n + m * 13);
+      double par = ar * *(p + n + m * 13);
       if (m == 0)
       {
         temp1 = tc_[m][n] * cp_[m];
@@ -640,35 +674,31 @@ int WorldMagneticModel::GeoMag::calculateVariance(const simCore::Vec3& lla, int
         temp1 = tc_[m][n] * cp_[m] + tc_[n][m - 1] * sp_[m];
         temp2 = tc_[m][n] * sp_[m] - tc_[n][m - 1] * cp_[m];
       }
-      bt_ = bt_ - ar_ * temp1 * dp_[m][n];
-      bp_ += (FM_COEFF[m] * temp2 * par);
-      br_ += (FN_COEFF[n] * temp1 * par);
+      bt = bt - ar * temp1 * dp_[m][n];
+      bp += (FM_COEFF[m] * temp2 * par);
+      br += (FN_COEFF[n] * temp1 * par);
 
       // SPECIAL CASE:  NORTH/SOUTH GEOGRAPHIC POLES
       if (st_ == 0.0 && m == 1)
       {
         pp_[n] = (n == 1) ? pp_[n - 1] : (ct_ * pp_[n - 1] - K_COEFF[m][n] * pp_[n - 2]);
-        double parp = ar_ * pp_[n];
-        bpp_ += (FM_COEFF[m] * temp2 * parp);
+        double parp = ar * pp_[n];
+        bpp += (FM_COEFF[m] * temp2 * parp);
       }
     }
   }
 
-  bp_ = (st_ == 0.0) ? bpp_ : bp_ / st_;
+  bp = (st_ == 0.0) ? bpp : bp / st_;
 
   // ROTATE MAGNETIC VECTOR COMPONENTS FROM SPHERICAL TO
   // GEODETIC COORDINATES, COMPUTE DECLINATION (DEC);
-  dec_ = atan2(bp_, (-bt_ * ca_ - br_ * sa_));
+  dec_ = atan2(bp, (-bt * ca_ - br * sa_));
 
   // set current values for this call
-  oyear_ = epochYear_;
-  otime_ = time;
   oalt_ = altkm;
   olat_ = dlat;
   olon_ = dlon;
-
-  variance = dec_;
-  return 0;
+  return dec_;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -693,7 +723,7 @@ int WorldMagneticModel::calculateMagneticVariance(const simCore::Vec3& lla, int
 
 int WorldMagneticModel::calculateMagneticVariance(const simCore::Vec3& lla, const simCore::TimeStamp& timeStamp, double& varianceRad)
 {
-  return calculateMagneticVariance(lla, static_cast<int>(timeStamp.secondsSinceRefYear().Double() / 86400.0), timeStamp.referenceYear(), varianceRad);
+  return calculateMagneticVariance(lla, ordinalDay(timeStamp), timeStamp.referenceYear(), varianceRad);
 }
 
 int WorldMagneticModel::calculateMagneticBearing(const simCore::Vec3& lla, const simCore::TimeStamp& timeStamp, double& bearingRad)
@@ -718,4 +748,155 @@ int WorldMagneticModel::calculateTrueBearing(const simCore::Vec3& lla, const sim
   return 1;
 }
 
+////////////////////////////////////////////////////////////////
+
+/** Evaluates the model at each position for one time; all values are 0 on error */
+static int calculateVariances(WorldMagneticModel& wmm, const std::vector<simCore::Vec3>& lla, const simCore::TimeStamp& timeStamp, std::vector<double>& varianceRad)
+{
+  varianceRad.assign(lla.size(), 0.0);
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    if (wmm.calculateMagneticVariance(lla[k], timeStamp, varianceRad[k]) != 0)
+    {
+      varianceRad.assign(lla.size(), 0.0);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+MagneticVarianceGrid::MagneticVarianceGrid()
+  : ordinalDay_(0),
+    year_(0),
+    altitude_(0.0),
+    spacing_(0.0),
+    numRows_(0),
+    numCols_(0),
+    maxSampledError_(0.0),
+    numDirect_(0)
+{
+}
+
+MagneticVarianceGrid::~MagneticVarianceGrid()
+{
+}
+
+int MagneticVarianceGrid::build(const simCore::TimeStamp& timeStamp, double spacingRad, double altitude, double toleranceRad)
+{
+  nodes_.clear();
+  direct_.clear();
+  numRows_ = 0;
+  numCols_ = 0;
+  maxSampledError_ = 0.0;
+  numDirect_ = 0;
+  if (!(spacingRad > 0.0) || toleranceRad < 0.0)
+    return 1;
+
+  // nodes run from the south pole to the north pole, and from -180 to +180 inclusive
+  const size_t numLatCells = static_cast<size_t>(ceil(M_PI / std::min(spacingRad, M_PI)));
+  spacing_ = M_PI / numLatCells;
+  ordinalDay_ = ordinalDay(timeStamp);
+  year_ = timeStamp.referenceYear();
+  altitude_ = altitude;
+  const size_t numRows = numLatCells + 1;
+  const size_t numCols = 2 * numLatCells + 1;
+
+  // row major, so each row shares its Legendre functions
+  std::vector<simCore::Vec3> lla;
+  lla.reserve(numRows * numCols);
+  for (size_t row = 0; row < numRows; ++row)
+  {
+    const double lat = std::min(-M_PI_2 + row * spacing_, M_PI_2);
+    for (size_t col = 0; col < numCols; ++col)
+      lla.push_back(simCore::Vec3(lat, -M_PI + col * spacing_, altitude_));
+  }
+  if (calculateVariances(wmm_, lla, timeStamp, nodes_) != 0)
+  {
+    nodes_.clear();
+    return 1;
+  }
+  numRows_ = numRows;
+  numCols_ = numCols;
+
+  // measure the interpolation error at each cell center
+  lla.clear();
+  for (size_t row = 0; row + 1 < numRows_; ++row)
+  {
+    for (size_t col = 0; col + 1 < numCols_; ++col)
+      lla.push_back(simCore::Vec3(-M_PI_2 + (row + 0.5) * spacing_, -M_PI + (col + 0.5) * spacing_, altitude_));
+  }
+  std::vector<double> centers;
+  calculateVariances(wmm_, lla, timeStamp, centers);
+  direct_.assign(centers.size(), 0);
+  for (size_t row = 0; row + 1 < numRows_; ++row)
+  {
+    for (size_t col = 0; col + 1 < numCols_; ++col)
+    {
+      const size_t cell = row * (numCols_ - 1) + col;
+      const double error = fabs(angFixPI(interpolate_(row, col, 0.5, 0.5) - centers[cell]));
+      if (error > toleranceRad)
+      {
+        direct_[cell] = 1;
+        ++numDirect_;
+      }
+      else
+        maxSampledError_ = std::max(maxSampledError_, error);
+    }
+  }
+  return 0;
+}
+
+bool MagneticVarianceGrid::isValid() const
+{
+  return !nodes_.empty();
+}
+
+double MagneticVarianceGrid::spacing() const
+{
+  return spacing_;
+}
+
+double MagneticVarianceGrid::maxSampledErrorRad() const
+{
+  return maxSampledError_;
+}
+
+size_t MagneticVarianceGrid::numDirectCells() const
+{
+  return numDirect_;
+}
+
+int MagneticVarianceGrid::calculateMagneticVariance(const simCore::Vec3& lla, double& varianceRad)
+{
+  if (!isValid())
+  {
+    varianceRad = 0.0;
+    return 1;
+  }
+
+  const double lat = std::max(-M_PI_2, std::min(M_PI_2, lla.lat()));
+  const double lon = angFixPI(lla.lon());
+  const double rowPos = (lat + M_PI_2) / spacing_;
+  const double colPos = (lon + M_PI) / spacing_;
+  const size_t row = std::min(static_cast<size_t>(rowPos), numRows_ - 2);
+  const size_t col = std::min(static_cast<size_t>(colPos), numCols_ - 2);
+
+  if (direct_[row * (numCols_ - 1) + col] != 0)
+    return wmm_.calculateMagneticVariance(simCore::Vec3(lat, lon, altitude_), ordinalDay_, year_, varianceRad);
+  varianceRad = interpolate_(row, col, rowPos - row, colPos - col);
+  return 0;
+}
+
+double MagneticVarianceGrid::interpolate_(size_t row, size_t col, double rowFrac, double colFrac) const
+{
+  // interpolate the differences from one corner, so cells that cross +/-180 degrees blend correctly
+  const double* south = &nodes_[row * numCols_ + col];
+  const double* north = south + numCols_;
+  const double dSouthEast = angFixPI(south[1] - south[0]);
+  const double dNorthWest = angFixPI(north[0] - south[0]);
+  const double dNorthEast = angFixPI(north[1] - south[0]);
+  const double delta = (1.0 - rowFrac) * colFrac * dSouthEast + rowFrac * ((1.0 - colFrac) * dNorthWest + colFrac * dNorthEast);
+  return angFixPI(south[0] + delta);
+}
+
 }
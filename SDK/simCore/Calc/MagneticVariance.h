@@ -22,6 +22,7 @@
 #ifndef SIMCORE_CALC_MAGNETICVARIANCE_H
 #define SIMCORE_CALC_MAGNETICVARIANCE_H
 
+#include <vector>
 #include "simCore/Common/Export.h"
 
 namespace simCore {
@@ -88,6 +89,67 @@ private:
   GeoMag* geomag_;
 };
 
+/**
+ * Magnetic variance precomputed on a regular latitude/longitude grid for one date, with
+ * bilinear lookup.  The interpolation error of each cell is measured against the WMM at
+ * the cell center when the grid is built; cells whose error exceeds the tolerance, such
+ * as those near the magnetic poles, are evaluated directly by the WMM on lookup instead.
+ * Lookups use the altitude the grid was built at.
+ */
+class SDKCORE_EXPORT MagneticVarianceGrid
+{
+public:
+  MagneticVarianceGrid();
+  virtual ~MagneticVarianceGrid();
+
+  /**
+   * Evaluates the WMM at each grid node
+   * @param timeStamp Time value between the years [1985-2020].  WMM cannot be used outside these bounds.
+   * @param spacingRad Requested node spacing in radians; rounded down to divide the latitude and longitude ranges evenly.
+   * @param altitude Altitude of the grid in meters.
+   * @param toleranceRad Cells whose interpolation error at their center exceeds this value, in radians,
+   *   are evaluated directly by the WMM.  Only the center is sampled, so other points in an
+   *   interpolated cell may have larger errors.
+   * @return 0 on success, non-zero on error
+   */
+  int build(const simCore::TimeStamp& timeStamp, double spacingRad, double altitude, double toleranceRad);
+
+  /** Returns true if build() succeeded */
+  bool isValid() const;
+  /** Node spacing in radians */
+  double spacing() const;
+  /** Largest interpolation error in radians measured at the centers of interpolated cells; not a bound on the error elsewhere in those cells */
+  double maxSampledErrorRad() const;
+  /** Number of cells evaluated directly by the WMM because their center error exceeded the tolerance */
+  size_t numDirectCells() const;
+
+  /**
+   * Retrieves the magnetic variance at a position, at the grid's date and altitude.
+   * @param lla Geodetic position in radians and meters; the altitude is ignored.
+   * @param varianceRad Radian value of the magnetic variance at the position.
+   * @return 0 on success, non-zero if the grid is not valid
+   */
+  int calculateMagneticVariance(const simCore::Vec3& lla, double& varianceRad);
+
+private:
+  /** Bilinear interpolation in a cell, given fractional offsets [0,1] from its south-west node */
+  double interpolate_(size_t row, size_t col, double rowFrac, double colFrac) const;
+
+  WorldMagneticModel wmm_;
+  int ordinalDay_;
+  int year_;
+  double altitude_;
+  double spacing_;
+  size_t numRows_;
+  size_t numCols_;
+  double maxSampledError_;
+  size_t numDirect_;
+  /** Variance at each node, in radians; row major from the south-west corner */
+  std::vector<double> nodes_;
+  /** Nonzero for each cell evaluated directly; row major from the south-west corner */
+  std::vector<unsigned char> direct_;
+};
+
 }
 
 #endif /* SIMCORE_CALC_MAGNETICVARIANCE_H */
@@ -27,7 +27,10 @@
  *       GEOTRANS license can be found here : http ://earth-info.nga.mil/GandG/geotrans/docs/MSP_GeoTrans_Terms_of_Use.pdf
  */
 
+#include <algorithm>
+#include <cctype>
 #include <cmath>
+#include <cstring>
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/CoordinateSystem.h"
 #include "simCore/String/Tokenizer.h"
@@ -38,6 +41,94 @@
 namespace simCore
 {
 
+namespace
+{
+  const double ONEHT = 100000.;
+  const double TWOMIL = 2000000.;
+  /// Standard scale factor for UTM
+  const double UTM_SCALE_FACTOR = 0.9996;
+  /// Standard scale factor for UPS
+  const double UPS_SCALE_FACTOR = 0.994;
+  /// Latitude band letters, 8 degrees each from 80 degrees south; X is extended to 84 degrees north
+  const char BAND_LETTERS[] = "CDEFGHJKLMNPQRSTUVWX";
+
+  /** Series constants of the UTM projection, which depend only on the WGS-84 ellipsoid */
+  struct UtmConstants
+  {
+    UtmConstants()
+    {
+      n1 = WGS_F / (2.0 - WGS_F);
+      const double n2 = pow(n1, 2);
+      const double n3 = pow(n1, 3);
+      const double n4 = pow(n1, 4);
+
+      // inverse: footpoint latitude series
+      r = WGS_A * (1.0 - n1) * (1.0 - n2) * (1.0 + 9.0*n2 / 4.0 + 225.0*n4 / 64.0);
+      const double v2 = 3.0*n1 / 2.0 - 27.0*n3 / 32.0;
+      const double v4 = 21.0*n2 / 16.0 - 55.0*n4 / 32.0;
+      const double v6 = 151.0*n3 / 96.0;
+      const double v8 = 1097.0*n4 / 512.0;
+      V0 = 2.0*(v2 - 2.0*v4 + 3.0*v6 - 4.0*v8);
+      V2 = 8.0*(v4 - 4.0*v6 + 10.0*v8);
+      V4 = 32.0*(v6 - 6.0*v8);
+      V6 = 128.0*(v8);
+
+      // forward: Krueger series in the third flattening
+      rectifyingRadius = WGS_A / (1.0 + n1) * (1.0 + n2 / 4.0 + n4 / 64.0);
+      alpha[0] = n1 / 2.0 - 2.0*n2 / 3.0 + 5.0*n3 / 16.0 + 41.0*n4 / 180.0;
+      alpha[1] = 13.0*n2 / 48.0 - 3.0*n3 / 5.0 + 557.0*n4 / 1440.0;
+      alpha[2] = 61.0*n3 / 240.0 - 103.0*n4 / 140.0;
+      alpha[3] = 49561.0*n4 / 161280.0;
+    }
+
+    double n1;
+    double r;
+    double V0;
+    double V2;
+    double V4;
+    double V6;
+    double rectifyingRadius;
+    double alpha[4];
+  };
+  const UtmConstants UTM_CONSTANTS;
+
+  /** Computes the hyperbolic arctangent of the given input */
+  double atanhValue(double x)
+  {
+    return (log(1 + x) - log(1 - x)) / 2;
+  }
+
+  /** Projects a position onto a transverse Mercator with the UTM scale, before false easting and northing */
+  void toTransverseMercator(double lat, double deltaLon, double& x, double& y)
+  {
+    const double sinPhi = sin(lat);
+    const double t = sinh(atanhValue(sinPhi) - WGS_E * atanhValue(WGS_E * sinPhi));
+    const double xiPrime = atan2(t, cos(deltaLon));
+    const double etaPrime = atanhValue(sin(deltaLon) / sqrt(1.0 + t * t));
+    double xi = xiPrime;
+    double eta = etaPrime;
+    for (int j = 1; j <= 4; ++j)
+    {
+      const double alpha = UTM_CONSTANTS.alpha[j - 1];
+      xi += alpha * sin(2.0 * j * xiPrime) * cosh(2.0 * j * etaPrime);
+      eta += alpha * cos(2.0 * j * xiPrime) * sinh(2.0 * j * etaPrime);
+    }
+    const double scale = UTM_SCALE_FACTOR * UTM_CONSTANTS.rectifyingRadius;
+    x = scale * eta;
+    y = scale * xi;
+  }
+
+  /** Adjusts a grid row index to a letter, skipping I and O */
+  char gridRowLetter(int index)
+  {
+    if (index > 'H' - 'A')
+      ++index;
+    if (index > 'N' - 'A')
+      ++index;
+    return static_cast<char>('A' + index);
+  }
+}
+
 int Mgrs::convertMgrsToGeodetic(const std::string& mgrs, double& lat, double& lon, std::string* err)
 {
   int zone;
@@ -187,9 +278,6 @@ int Mgrs::breakMgrsString(const std::string& mgrs, int& zone, std::string& gzdLe
 int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsEasting, double mgrsNorthing,
   Hemisphere& hemisphere, double& utmEasting, double& utmNorthing, std::string* err)
 {
-  const double ONEHT = 100000.;
-  const double TWOMIL = 2000000.;
-
   if (zone < 1 || zone > 60)
   {
     if (err)
@@ -215,6 +303,19 @@ int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsE
     return 1;
   }
 
+  double gridEasting;
+  double gridNorthing;
+  if (utmGridSquare_(zone, gzdLetters.c_str(), hemisphere, gridEasting, gridNorthing, err) != 0)
+    return 1;
+
+  utmEasting = gridEasting + mgrsEasting;
+  utmNorthing = gridNorthing + mgrsNorthing;
+  return 0;
+}
+
+int Mgrs::utmGridSquare_(int zone, const char* gzdLetters, Hemisphere& hemisphere, double& gridEasting,
+  double& gridNorthing, std::string* err)
+{
   // Exception case for Svalbard
   if ((gzdLetters[0] == 'X') && ((zone == 32) || (zone == 34) || (zone == 36)))
   {
@@ -237,9 +338,9 @@ int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsE
     return 1;
   }
 
-  char columnLetterLowValue;
-  char columnLetterHighValue;
-  double patternOffset;
+  char columnLetterLowValue = 'A';
+  char columnLetterHighValue = 'H';
+  double patternOffset = 0.0;
   getGridValues_(zone, columnLetterLowValue, columnLetterHighValue, patternOffset);
 
   // Check that the second letter of the MGRS string is within the range of valid second letter values
@@ -251,7 +352,7 @@ int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsE
     return 1;
   }
 
-  double gridEasting = (gzdLetters[1] - columnLetterLowValue + 1) * ONEHT;
+  gridEasting = (gzdLetters[1] - columnLetterLowValue + 1) * ONEHT;
   if ((columnLetterLowValue == 'J') && (gzdLetters[1] > 'O'))
     gridEasting -= ONEHT;
 
@@ -271,7 +372,7 @@ int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsE
     return 1;
   }
 
-  double gridNorthing = rowLetterNorthing - patternOffset;
+  gridNorthing = rowLetterNorthing - patternOffset;
   if (gridNorthing < 0)
     gridNorthing += TWOMIL;
 
@@ -280,9 +381,6 @@ int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsE
   if (gridNorthing < minNorthing)
     gridNorthing += TWOMIL;
 
-  utmEasting = gridEasting + mgrsEasting;
-  utmNorthing = gridNorthing + mgrsNorthing;
-
   // Latitude bands of 'N' and lower are in the southern hemisphere.
   if (gzdLetters[0] < 'N')
     hemisphere = UPS_SOUTH;
@@ -294,8 +392,7 @@ int Mgrs::convertMgrstoUtm(int zone, const std::string& gzdLetters, double mgrsE
 
 int Mgrs::convertUtmToGeodetic(int zone, Hemisphere hemisphere, double easting, double northing, double& lat, double& lon, std::string* err)
 {
-  // Standard scale factor for UTM
-  const double scaleFactor = 0.9996;
+  const double scaleFactor = UTM_SCALE_FACTOR;
 
   if (zone < 1 || zone > 60)
   {
@@ -321,12 +418,8 @@ int Mgrs::convertUtmToGeodetic(int zone, Hemisphere hemisphere, double easting,
   if (hemisphere == UPS_SOUTH)
     northing -= 10000000;
 
-  const double n1 = WGS_F / (2.0 - WGS_F);
-  const double n2 = pow(n1, 2);
-  const double n3 = pow(n1, 3);
-  const double n4 = pow(n1, 4);
-
-  const double r = WGS_A * (1.0 - n1) * (1.0 - n2) * (1.0 + 9.0*n2 / 4.0 + 225.0*n4 / 64.0);
+  // Series constants depend only on the ellipsoid
+  const double r = UTM_CONSTANTS.r;
   const double omega = northing / (scaleFactor * r);
 
   const double cosP1 = cos(omega);
@@ -334,15 +427,10 @@ int Mgrs::convertUtmToGeodetic(int zone, Hemisphere hemisphere, double easting,
   const double cos4P1 = cos2P1 * cos2P1;
   const double cos6P1 = cos4P1 * cos2P1;
 
-  const double v2 = 3.0*n1 / 2.0 - 27.0*n3 / 32.0;
-  const double v4 = 21.0*n2 / 16.0 - 55.0*n4 / 32.0;
-  const double v6 = 151.0*n3 / 96.0;
-  const double v8 = 1097.0*n4 / 512.0;
-
-  const double V0 = 2.0*(v2 - 2.0*v4 + 3.0*v6 - 4.0*v8);
-  const double V2 = 8.0*(v4 - 4.0*v6 + 10.0*v8);
-  const double V4 = 32.0*(v6 - 6.0*v8);
-  const double V6 = 128.0*(v8);
+  const double V0 = UTM_CONSTANTS.V0;
+  const double V2 = UTM_CONSTANTS.V2;
+  const double V4 = UTM_CONSTANTS.V4;
+  const double V6 = UTM_CONSTANTS.V6;
 
   const double phif = omega + sin(omega)*cosP1*(V0 + V2 * cos2P1 + V4 * cos4P1 + V6 * cos6P1);
 
@@ -379,14 +467,6 @@ int Mgrs::convertUtmToGeodetic(int zone, Hemisphere hemisphere, double easting,
 int Mgrs::convertMgrsToUps(const std::string& gzdLetters, double mgrsEasting, double mgrsNorthing,
   Hemisphere& hemisphere, double& upsEasting, double& upsNorthing, std::string* err)
 {
-  const UPS_Constants UPS_Constant_Table[4] =
-  {
-    { 'J', 'Z', 'Z', 800000.0, 800000.0 },   // Latitude band A
-    { 'A', 'R', 'Z', 2000000.0, 800000.0 },  // Latitude band B
-    { 'J', 'Z', 'P', 800000.0, 1300000.0 },  // Latitude band Y
-    { 'A', 'J', 'P', 2000000.0, 1300000.0 }  // Latitude band Z
-  };
-
   if (gzdLetters.size() != 3)
   {
     if (err)
@@ -394,18 +474,39 @@ int Mgrs::convertMgrsToUps(const std::string& gzdLetters, double mgrsEasting, do
     return 1;
   }
 
-  int upsIndex;
-  if ((gzdLetters[0] == 'Y') || (gzdLetters[0] == 'Z'))
+  double gridEasting;
+  double gridNorthing;
+  if (upsGridSquare_(gzdLetters.c_str(), hemisphere, gridEasting, gridNorthing, err) != 0)
+    return 1;
+
+  upsEasting = gridEasting + mgrsEasting;
+  upsNorthing = gridNorthing + mgrsNorthing;
+
+  return 0;
+}
+
+const Mgrs::UPS_Constants& Mgrs::upsConstants_(char bandLetter)
+{
+  static const UPS_Constants UPS_Constant_Table[4] =
   {
+    { 'J', 'Z', 'Z', 800000.0, 800000.0 },   // Latitude band A
+    { 'A', 'R', 'Z', 2000000.0, 800000.0 },  // Latitude band B
+    { 'J', 'Z', 'P', 800000.0, 1300000.0 },  // Latitude band Y
+    { 'A', 'J', 'P', 2000000.0, 1300000.0 }  // Latitude band Z
+  };
+  // The indices for 'Y' and 'Z' are at 2 and 3, so subtract 'Y' - 2 == 'W'
+  if ((bandLetter == 'Y') || (bandLetter == 'Z'))
+    return UPS_Constant_Table[bandLetter - 'W'];
+  return UPS_Constant_Table[bandLetter - 'A'];
+}
+
+int Mgrs::upsGridSquare_(const char* gzdLetters, Hemisphere& hemisphere, double& gridEasting,
+  double& gridNorthing, std::string* err)
+{
+  if ((gzdLetters[0] == 'Y') || (gzdLetters[0] == 'Z'))
     hemisphere = UPS_NORTH;
-    // The indices for 'Y' and 'Z' are at 2 and 3, so subtract 'Y' - 2 == 'W'
-    upsIndex = gzdLetters[0] - 'W';
-  }
   else if ((gzdLetters[0] == 'A') || (gzdLetters[0] == 'B'))
-  {
     hemisphere = UPS_SOUTH;
-    upsIndex = gzdLetters[0] - 'A';
-  }
   else
   {
     if (err)
@@ -413,11 +514,12 @@ int Mgrs::convertMgrsToUps(const std::string& gzdLetters, double mgrsEasting, do
     return 1;
   }
 
-  char gridColumnLowValue = UPS_Constant_Table[upsIndex].gridColumnLowValue;
-  char gridColumnHighValue = UPS_Constant_Table[upsIndex].gridColumnHighValue;
-  char gridRowHighValue = UPS_Constant_Table[upsIndex].gridRowHighValue;
-  double falseEasting = UPS_Constant_Table[upsIndex].falseEasting;
-  double falseNorthing = UPS_Constant_Table[upsIndex].falseNorthing;
+  const UPS_Constants& constants = upsConstants_(gzdLetters[0]);
+  char gridColumnLowValue = constants.gridColumnLowValue;
+  char gridColumnHighValue = constants.gridColumnHighValue;
+  char gridRowHighValue = constants.gridRowHighValue;
+  double falseEasting = constants.falseEasting;
+  double falseNorthing = constants.falseNorthing;
 
   // Check that the grid column letter of the MGRS string is within the range of valid second letter values.
   if ((gzdLetters[1] < gridColumnLowValue) || (gzdLetters[1] > gridColumnHighValue) ||
@@ -438,7 +540,7 @@ int Mgrs::convertMgrsToUps(const std::string& gzdLetters, double mgrsEasting, do
   }
 
   // Northing for 100,000 meter grid square
-  double gridNorthing = (gzdLetters[2] - 'A') * 100000.0 + falseNorthing;
+  gridNorthing = (gzdLetters[2] - 'A') * 100000.0 + falseNorthing;
   if (gzdLetters[2] > 'I')
     gridNorthing = gridNorthing - 100000.0;
 
@@ -446,7 +548,7 @@ int Mgrs::convertMgrsToUps(const std::string& gzdLetters, double mgrsEasting, do
     gridNorthing = gridNorthing - 100000.0;
 
   // Easting for 100,000 meter grid square
-  double gridEasting = (gzdLetters[1] - gridColumnLowValue) * 100000.0 + falseEasting;
+  gridEasting = (gzdLetters[1] - gridColumnLowValue) * 100000.0 + falseEasting;
   if (gridColumnLowValue != 'A')
   {
     if (gzdLetters[1] > 'L')
@@ -467,9 +569,6 @@ int Mgrs::convertMgrsToUps(const std::string& gzdLetters, double mgrsEasting, do
       gridEasting = gridEasting - 300000.0;
   }
 
-  upsEasting = gridEasting + mgrsEasting;
-  upsNorthing = gridNorthing + mgrsNorthing;
-
   return 0;
 }
 
@@ -481,7 +580,7 @@ int Mgrs::convertUpsToGeodetic(Hemisphere hemisphere, double easting, double nor
   const double centralMeridian = 0.0;
   const double falseEasting = 2000000.0;
   const double falseNorthing = 2000000.0;
-  const double scaleFactor = 0.994;
+  const double scaleFactor = UPS_SCALE_FACTOR;
   // Values calculated from UPS standard
   const double k90 = sqrt(1 - WGS_E * WGS_E) * exp(WGS_E * atanh_(WGS_E));
   const double deltaEasting = 2000000.0;
@@ -560,6 +659,358 @@ int Mgrs::convertUpsToGeodetic(Hemisphere hemisphere, double easting, double nor
   return 0;
 }
 
+int Mgrs::convertGeodeticToMgrs(double lat, double lon, int precision, char* mgrs, std::string* err)
+{
+  return geodeticToMgrs_(lat, lon, precision, mgrs, err);
+}
+
+int Mgrs::convertGeodeticToMgrs(double lat, double lon, std::string& mgrs, int precision, std::string* err)
+{
+  char buffer[MGRS_BUFFER_SIZE];
+  const int rv = convertGeodeticToMgrs(lat, lon, precision, buffer, err);
+  mgrs = buffer;
+  return rv;
+}
+
+int Mgrs::convertGeodeticToUtm(double lat, double lon, int& zone, Hemisphere& hemisphere, double& easting, double& northing, std::string* err)
+{
+  const double latDeg = lat * RAD2DEG;
+  if (latDeg < -80.0 || latDeg > 84.0)
+  {
+    if (err)
+      *err = "Invalid geodetic coordinate: Latitude is outside the UTM range.";
+    return 1;
+  }
+
+  // Longitude in [-180,180)
+  lon = angFixPI(lon);
+  if (lon >= M_PI)
+    lon -= M_TWOPI;
+  zone = utmZone_(latDeg, lon * RAD2DEG);
+
+  double x;
+  double y;
+  toTransverseMercator(lat, lon - (6 * zone - 183) * DEG2RAD, x, y);
+  easting = 500000.0 + x;
+  northing = y;
+  // Add the standard false northing in the southern hemisphere to avoid negative values
+  if (lat < 0.0)
+  {
+    hemisphere = UPS_SOUTH;
+    northing += 10000000.0;
+  }
+  else
+    hemisphere = UPS_NORTH;
+  return 0;
+}
+
+int Mgrs::convertGeodeticToUps(double lat, double lon, Hemisphere& hemisphere, double& easting, double& northing, std::string* err)
+{
+  if (lat > M_PI_2 || lat < -M_PI_2)
+  {
+    if (err)
+      *err = "Invalid geodetic coordinate: Latitude is out of range.";
+    return 1;
+  }
+
+  // The southern projection is the northern one, mirrored through the pole; see convertUpsToGeodetic()
+  hemisphere = (lat >= 0.0) ? UPS_NORTH : UPS_SOUTH;
+  const double sign = (hemisphere == UPS_NORTH) ? 1.0 : -1.0;
+  const double phi = sign * lat;
+  const double lambda = sign * lon;
+
+  const double k90 = sqrt(1 - WGS_E * WGS_E) * exp(WGS_E * atanh_(WGS_E));
+  const double sinPhi = sin(phi);
+  const double t = tan(M_PI_4 - phi / 2.0) / pow((1.0 - WGS_E * sinPhi) / (1.0 + WGS_E * sinPhi), WGS_E / 2.0);
+  const double rho = 2.0 * WGS_A * UPS_SCALE_FACTOR * t / k90;
+
+  easting = TWOMIL + sign * rho * sin(lambda);
+  northing = TWOMIL - sign * rho * cos(lambda);
+  return 0;
+}
+
+size_t Mgrs::convertGeodeticToMgrs(const std::vector<double>& lat, const std::vector<double>& lon, int precision, std::vector<char>& mgrs)
+{
+  if (lat.size() != lon.size())
+  {
+    mgrs.clear();
+    return std::max(lat.size(), lon.size());
+  }
+
+  mgrs.resize(lat.size() * MGRS_BUFFER_SIZE);
+  size_t failures = 0;
+  for (size_t k = 0; k < lat.size(); ++k)
+  {
+    if (geodeticToMgrs_(lat[k], lon[k], precision, &mgrs[k * MGRS_BUFFER_SIZE], NULL) != 0)
+      ++failures;
+  }
+  return failures;
+}
+
+size_t Mgrs::convertMgrsToGeodetic(const std::vector<std::string>& mgrs, std::vector<double>& lat, std::vector<double>& lon)
+{
+  lat.assign(mgrs.size(), 0.0);
+  lon.assign(mgrs.size(), 0.0);
+  size_t failures = 0;
+
+  // Grid square of the previous coordinate
+  int lastZone = -1;
+  char lastLetters[3] = { 0, 0, 0 };
+  int lastSquareResult = 1;
+  Hemisphere hemisphere = UPS_NORTH;
+  double gridEasting = 0.0;
+  double gridNorthing = 0.0;
+
+  for (size_t k = 0; k < mgrs.size(); ++k)
+  {
+    int zone;
+    char letters[3];
+    double easting;
+    double northing;
+    int rv = 0;
+    if (parseMgrs_(mgrs[k], zone, letters, easting, northing) != 0)
+    {
+      // Let the general parser handle quotes and unusual forms
+      rv = convertMgrsToGeodetic(mgrs[k], lat[k], lon[k]);
+    }
+    else
+    {
+      if (zone != lastZone || memcmp(letters, lastLetters, sizeof(letters)) != 0)
+      {
+        lastZone = zone;
+        memcpy(lastLetters, letters, sizeof(letters));
+        if (zone == 0)
+          lastSquareResult = upsGridSquare_(letters, hemisphere, gridEasting, gridNorthing, NULL);
+        else
+          lastSquareResult = utmGridSquare_(zone, letters, hemisphere, gridEasting, gridNorthing, NULL);
+      }
+
+      if (lastSquareResult != 0)
+        rv = 1;
+      else if (zone == 0)
+        rv = convertUpsToGeodetic(hemisphere, gridEasting + easting, gridNorthing + northing, lat[k], lon[k], NULL);
+      // Same range checks as convertMgrstoUtm()
+      else if (easting > ONEHT || northing > ONEHT)
+        rv = 1;
+      else
+        rv = convertUtmToGeodetic(zone, hemisphere, gridEasting + easting, gridNorthing + northing, lat[k], lon[k], NULL);
+    }
+
+    if (rv != 0)
+    {
+      lat[k] = 0.0;
+      lon[k] = 0.0;
+      ++failures;
+    }
+  }
+  return failures;
+}
+
+int Mgrs::parseMgrs_(const std::string& mgrs, int& zone, char gzdLetters[3], double& easting, double& northing)
+{
+  const size_t length = mgrs.size();
+  size_t pos = 0;
+  // Spaces are allowed anywhere, as in breakMgrsString()
+  while (pos < length && mgrs[pos] == ' ')
+    ++pos;
+
+  zone = 0;
+  size_t numZoneDigits = 0;
+  while (pos < length && (isdigit(mgrs[pos]) || mgrs[pos] == ' '))
+  {
+    if (mgrs[pos] != ' ')
+    {
+      zone = zone * 10 + (mgrs[pos] - '0');
+      ++numZoneDigits;
+    }
+    ++pos;
+  }
+  if (numZoneDigits > 2 || zone > 60)
+    return 1;
+
+  size_t numLetters = 0;
+  while (pos < length && numLetters < 3)
+  {
+    const char letter = mgrs[pos++];
+    if (letter == ' ')
+      continue;
+    // Lower case letters are accepted by breakMgrsString(), but only upper case polar letters without a zone
+    if (!isalpha(letter))
+      return 1;
+    const char upper = static_cast<char>(toupper(letter));
+    if (upper == 'I' || upper == 'O')
+      return 1;
+    if (numLetters == 0 && numZoneDigits == 0 && letter != 'A' && letter != 'B' && letter != 'Y' && letter != 'Z')
+      return 1;
+    gzdLetters[numLetters++] = upper;
+  }
+  if (numLetters != 3)
+    return 1;
+
+  // Up to 5 easting and 5 northing digits
+  char digits[10];
+  size_t numDigits = 0;
+  for (; pos < length; ++pos)
+  {
+    if (mgrs[pos] == ' ')
+      continue;
+    if (!isdigit(mgrs[pos]) || numDigits == sizeof(digits))
+      return 1;
+    digits[numDigits++] = mgrs[pos];
+  }
+  if ((numDigits & 1) != 0)
+    return 1;
+
+  const size_t numDigitsInPosition = numDigits / 2;
+  easting = 0.0;
+  northing = 0.0;
+  for (size_t i = 0; i < numDigitsInPosition; ++i)
+  {
+    easting = easting * 10 + (digits[i] - '0');
+    northing = northing * 10 + (digits[numDigitsInPosition + i] - '0');
+  }
+  // multiply the position values until they are 5 digits long (i.e. range of 0 - 99,999)
+  if (numDigitsInPosition > 0)
+  {
+    for (size_t i = numDigitsInPosition; i < 5; ++i)
+    {
+      easting *= 10;
+      northing *= 10;
+    }
+  }
+  return 0;
+}
+
+void Mgrs::writeMgrs_(int zone, const char* gzdLetters, double easting, double northing, int precision, char* mgrs)
+{
+  static const double DIVISORS[6] = { 100000.0, 10000.0, 1000.0, 100.0, 10.0, 1.0 };
+  char* out = mgrs;
+  if (zone > 0)
+  {
+    *out++ = static_cast<char>('0' + zone / 10);
+    *out++ = static_cast<char>('0' + zone % 10);
+  }
+  *out++ = gzdLetters[0];
+  *out++ = gzdLetters[1];
+  *out++ = gzdLetters[2];
+
+  // MGRS truncates the position within the grid square
+  long east = static_cast<long>(fmod(easting, ONEHT) / DIVISORS[precision]);
+  long north = static_cast<long>(fmod(northing, ONEHT) / DIVISORS[precision]);
+  for (int i = precision - 1; i >= 0; --i)
+  {
+    out[i] = static_cast<char>('0' + east % 10);
+    out[precision + i] = static_cast<char>('0' + north % 10);
+    east /= 10;
+    north /= 10;
+  }
+  out[2 * precision] = '\0';
+}
+
+int Mgrs::geodeticToMgrs_(double lat, double lon, int precision, char* mgrs, std::string* err)
+{
+  mgrs[0] = '\0';
+  if (precision < 0 || precision > 5)
+  {
+    if (err)
+      *err = "Invalid MGRS precision: must be in the range 0-5.";
+    return 1;
+  }
+  if (lat > M_PI_2 || lat < -M_PI_2)
+  {
+    if (err)
+      *err = "Invalid geodetic coordinate: Latitude is out of range.";
+    return 1;
+  }
+
+  const double latDeg = lat * RAD2DEG;
+  char letters[3];
+  Hemisphere hemisphere;
+  double easting;
+  double northing;
+
+  // Polar regions use UPS
+  if (latDeg < -80.0 || latDeg > 84.0)
+  {
+    convertGeodeticToUps(lat, lon, hemisphere, easting, northing, NULL);
+    if (hemisphere == UPS_NORTH)
+      letters[0] = (easting >= TWOMIL) ? 'Z' : 'Y';
+    else
+      letters[0] = (easting >= TWOMIL) ? 'B' : 'A';
+    const UPS_Constants& constants = upsConstants_(letters[0]);
+
+    letters[2] = gridRowLetter(static_cast<int>((northing - constants.falseNorthing) / ONEHT));
+    letters[1] = static_cast<char>(constants.gridColumnLowValue + static_cast<int>((easting - constants.falseEasting) / ONEHT));
+    if (easting < TWOMIL)
+    {
+      if (letters[1] > 'L')
+        letters[1] += 3;
+      if (letters[1] > 'U')
+        letters[1] += 2;
+    }
+    else
+    {
+      if (letters[1] > 'C')
+        letters[1] += 2;
+      if (letters[1] > 'H')
+        letters[1] += 1;
+      if (letters[1] > 'L')
+        letters[1] += 3;
+    }
+    writeMgrs_(0, letters, easting, northing, precision, mgrs);
+    return 0;
+  }
+
+  int zone;
+  convertGeodeticToUtm(lat, lon, zone, hemisphere, easting, northing, NULL);
+  char columnLetterLowValue = 'A';
+  char columnLetterHighValue = 'H';
+  double patternOffset = 0.0;
+  getGridValues_(zone, columnLetterLowValue, columnLetterHighValue, patternOffset);
+
+  const int bandIndex = static_cast<int>(floor((latDeg + 80.0) / 8.0));
+  letters[0] = BAND_LETTERS[(bandIndex > 19) ? 19 : bandIndex];
+
+  double gridNorthing = fmod(northing, TWOMIL) + patternOffset;
+  if (gridNorthing >= TWOMIL)
+    gridNorthing -= TWOMIL;
+  letters[2] = gridRowLetter(static_cast<int>(gridNorthing / ONEHT));
+
+  // Zone 31V is narrowed to 3 degrees east, so its central meridian is the eastern edge
+  if (letters[0] == 'V' && zone == 31 && easting == 500000.0)
+    easting -= 1.0;
+  letters[1] = static_cast<char>(columnLetterLowValue + static_cast<int>(easting / ONEHT) - 1);
+  if (columnLetterLowValue == 'J' && letters[1] > 'N')
+    ++letters[1];
+
+  writeMgrs_(zone, letters, easting, northing, precision, mgrs);
+  return 0;
+}
+
+int Mgrs::utmZone_(double latDeg, double lonDeg)
+{
+  int zone = static_cast<int>((lonDeg + 180.0) / 6.0) + 1;
+  if (zone > 60)
+    zone = 60;
+
+  // Norway
+  if (latDeg >= 56.0 && latDeg < 64.0 && lonDeg >= 3.0 && lonDeg < 12.0)
+    zone = 32;
+  // Svalbard
+  if (latDeg >= 72.0 && lonDeg >= 0.0 && lonDeg < 42.0)
+  {
+    if (lonDeg < 9.0)
+      zone = 31;
+    else if (lonDeg < 21.0)
+      zone = 33;
+    else if (lonDeg < 33.0)
+      zone = 35;
+    else
+      zone = 37;
+  }
+  return zone;
+}
+
 void Mgrs::getGridValues_(int zone, char& columnLetterLowValue, char& columnLetterHighValue, double& patternOffset)
 {
   // The zones' lowest and highest column letters repeat every 3 zones.
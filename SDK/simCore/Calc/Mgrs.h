@@ -24,6 +24,7 @@
 #define SIMCORE_CALC_MGRS_H
 
 #include <string>
+#include <vector>
 #include "simCore/Common/Export.h"
 
 namespace simCore {
@@ -47,6 +48,9 @@ public:
     UPS_NORTH
   };
 
+  /// Size of a buffer that holds any MGRS string written by the geodetic to MGRS conversions, including the terminating NUL
+  static const size_t MGRS_BUFFER_SIZE = 16;
+
   /**
   * Converts an MGRS coordinate to geodetic coordinates.
   * Note that the function is currently defined only for values that convert to latitudes of less than 80 degrees
@@ -141,6 +145,87 @@ public:
   */
   static int convertUpsToGeodetic(Hemisphere hemisphere, double easting, double northing, double& lat, double& lon, std::string* err = NULL);
 
+  /**
+  * Converts geodetic coordinates to an MGRS coordinate.  Latitudes from 80 degrees south to 84 degrees north
+  * use a UTM grid zone; the polar regions use UPS and have no zone number.  Easting and northing are
+  * truncated to the precision, per the MGRS standard.
+  *
+  * @param[in ] lat Latitude in radians
+  * @param[in ] lon Longitude in radians
+  * @param[in ] precision Number of digits in each of the easting and northing, 0 (100 km) to 5 (1 m)
+  * @param[out] mgrs Buffer of at least MGRS_BUFFER_SIZE characters that receives the NUL terminated MGRS coordinate
+  * @param[out] err Optional pointer to error string
+  * @return 0 if conversion is successful, non-zero otherwise; mgrs is an empty string on failure
+  */
+  static int convertGeodeticToMgrs(double lat, double lon, int precision, char* mgrs, std::string* err = NULL);
+
+  /**
+  * Converts geodetic coordinates to an MGRS coordinate string.
+  *
+  * @param[in ] lat Latitude in radians
+  * @param[in ] lon Longitude in radians
+  * @param[out] mgrs MGRS coordinate string, such as "31NAA6602100000"
+  * @param[in ] precision Number of digits in each of the easting and northing, 0 (100 km) to 5 (1 m)
+  * @param[out] err Optional pointer to error string
+  * @return 0 if conversion is successful, non-zero otherwise
+  */
+  static int convertGeodeticToMgrs(double lat, double lon, std::string& mgrs, int precision = 5, std::string* err = NULL);
+
+  /**
+  * Converts geodetic coordinates to UTM, including the Norway and Svalbard zone exceptions.
+  * The function is defined only for latitudes from 80 degrees south to 84 degrees north.
+  *
+  * @param[in ] lat Latitude in radians
+  * @param[in ] lon Longitude in radians
+  * @param[out] zone UTM zone, in the range 1-60
+  * @param[out] hemisphere Hemisphere (north/south) of the coordinate
+  * @param[out] easting Easting portion of position within grid
+  * @param[out] northing Northing portion of position within grid, with the false northing in the southern hemisphere
+  * @param[out] err Optional pointer to error string
+  * @return 0 if conversion is successful, non-zero otherwise
+  */
+  static int convertGeodeticToUtm(double lat, double lon, int& zone, Hemisphere& hemisphere, double& easting, double& northing, std::string* err = NULL);
+
+  /**
+  * Converts geodetic coordinates to UPS.  Intended for latitudes beyond 80 degrees south or 84 degrees north.
+  *
+  * @param[in ] lat Latitude in radians
+  * @param[in ] lon Longitude in radians
+  * @param[out] hemisphere Hemisphere for UPS coordinate: UPS_SOUTH or UPS_NORTH
+  * @param[out] easting Easting portion of position within grid
+  * @param[out] northing Northing portion of position within grid
+  * @param[out] err Optional pointer to error string
+  * @return 0 if conversion is successful, non-zero otherwise
+  */
+  static int convertGeodeticToUps(double lat, double lon, Hemisphere& hemisphere, double& easting, double& northing, std::string* err = NULL);
+
+  /**
+  * Converts many geodetic coordinates to MGRS in one preallocated buffer.  Each coordinate gets a
+  * NUL terminated record of MGRS_BUFFER_SIZE characters; record k starts at &mgrs[k * MGRS_BUFFER_SIZE].
+  * Each coordinate costs the same as convertGeodeticToMgrs() into a caller's buffer, since the
+  * projection dominates and has no per-zone work to share; the batch form only saves the string
+  * allocations.  Reusing the output vector between calls avoids reallocation.
+  *
+  * @param[in ] lat Latitudes in radians
+  * @param[in ] lon Longitudes in radians, one per latitude
+  * @param[in ] precision Number of digits in each of the easting and northing, 0 (100 km) to 5 (1 m)
+  * @param[out] mgrs Resized to hold one record per coordinate; records that fail to convert are empty strings
+  * @return Number of coordinates that could not be converted; if the input sizes differ, mgrs is cleared and all fail
+  */
+  static size_t convertGeodeticToMgrs(const std::vector<double>& lat, const std::vector<double>& lon, int precision, std::vector<char>& mgrs);
+
+  /**
+  * Converts many MGRS coordinates to geodetic coordinates.  Canonical strings are parsed without
+  * allocation, and the 100,000 meter grid square is reused between consecutive coordinates in the
+  * same square.  Results match convertMgrsToGeodetic().
+  *
+  * @param[in ] mgrs MGRS coordinate strings
+  * @param[out] lat Latitudes in radians, one per string; 0 for strings that fail to convert
+  * @param[out] lon Longitudes in radians, one per string; 0 for strings that fail to convert
+  * @return Number of coordinates that could not be converted
+  */
+  static size_t convertMgrsToGeodetic(const std::vector<std::string>& mgrs, std::vector<double>& lat, std::vector<double>& lon);
+
 private:
 
   struct Latitude_Band
@@ -187,6 +272,71 @@ private:
   */
   static void getGridValues_(int zone, char& columnLetterLowValue, char& columnLetterHighValue, double& patternOffset);
 
+  /*
+  * Calculates the UTM coordinate of the south-west corner of an MGRS 100,000 meter grid square.
+  *
+  * @param[in ] zone UTM Zone number, 1-60
+  * @param[in ] gzdLetters Latitude band, grid column and grid row letters
+  * @param[out] hemisphere Hemisphere of the square
+  * @param[out] gridEasting UTM easting of the square
+  * @param[out] gridNorthing UTM northing of the square
+  * @param[out] err Optional pointer to error string
+  * @return 0 on success, non-zero if the letters are not valid for the zone
+  */
+  static int utmGridSquare_(int zone, const char* gzdLetters, Hemisphere& hemisphere, double& gridEasting,
+    double& gridNorthing, std::string* err);
+
+  /// Returns the UPS grid constants for polar band letter A, B, Y or Z
+  static const UPS_Constants& upsConstants_(char bandLetter);
+
+  /*
+  * Calculates the UPS coordinate of the south-west corner of an MGRS 100,000 meter grid square.
+  *
+  * @param[in ] gzdLetters Polar band, grid column and grid row letters
+  * @param[out] hemisphere Hemisphere of the square
+  * @param[out] gridEasting UPS easting of the square
+  * @param[out] gridNorthing UPS northing of the square
+  * @param[out] err Optional pointer to error string
+  * @return 0 on success, non-zero if the letters are not valid
+  */
+  static int upsGridSquare_(const char* gzdLetters, Hemisphere& hemisphere, double& gridEasting,
+    double& gridNorthing, std::string* err);
+
+  /*
+  * Parses a canonical MGRS string (optional zone, three letters, an even number of up to 10 digits,
+  * with optional spaces) without allocating.  Strings it rejects may still be valid for breakMgrsString().
+  *
+  * @return 0 if the string was parsed, non-zero otherwise
+  */
+  static int parseMgrs_(const std::string& mgrs, int& zone, char gzdLetters[3], double& easting, double& northing);
+
+  /*
+  * Writes an MGRS coordinate from a zone (0 for UPS), grid letters and UTM/UPS easting and northing.
+  *
+  * @param[in ] zone UTM Zone number, or 0 for UPS
+  * @param[in ] gzdLetters Latitude band, grid column and grid row letters
+  * @param[in ] easting UTM or UPS easting
+  * @param[in ] northing UTM or UPS northing
+  * @param[in ] precision Number of digits in each of the easting and northing, 0-5
+  * @param[out] mgrs Buffer of at least MGRS_BUFFER_SIZE characters
+  */
+  static void writeMgrs_(int zone, const char* gzdLetters, double easting, double northing, int precision, char* mgrs);
+
+  /*
+  * Converts geodetic coordinates to MGRS, writing into a caller-supplied buffer.
+  *
+  * @param[in ] lat Latitude in radians
+  * @param[in ] lon Longitude in radians
+  * @param[in ] precision Number of digits in each of the easting and northing, 0-5
+  * @param[out] mgrs Buffer of at least MGRS_BUFFER_SIZE characters
+  * @param[out] err Optional pointer to error string
+  * @return 0 on success, non-zero otherwise
+  */
+  static int geodeticToMgrs_(double lat, double lon, int precision, char* mgrs, std::string* err);
+
+  /// Calculates the UTM zone of a position in degrees, including the Norway and Svalbard exceptions
+  static int utmZone_(double latDeg, double lonDeg);
+
   /// Computes the hyperbolic arctangent of the given input.
   static double atanh_(double x);
 };
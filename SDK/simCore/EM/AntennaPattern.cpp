@@ -19,8 +19,10 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cstring>
 #include <string>
+#include <vector>
 #include "simNotify/Notify.h"
 #include "simCore/String/Format.h"
 #include "simCore/String/Tokenizer.h"
@@ -35,6 +37,291 @@
 using namespace std;
 using namespace simCore;
 
+namespace
+{
+  /** Computes the sin(x)/x pattern gain (dB) at an angular distance from boresight in normalized beam widths */
+  double sinXXGain(double phi, float refGain, float firstLobe)
+  {
+    // Compute antenna gain
+    if (phi == 0.0)
+      return refGain;
+
+    double gain = square(sin(2.783*phi) / (2.783*phi));
+    gain = refGain + 10.0 * log10(gain);
+
+    // Add sin x/x side lobe gain
+    if (phi > M_2_SQRTPI)
+      gain += firstLobe + 13.2;
+
+    return gain;
+  }
+
+  /** Computes the pedestal pattern gain (dB) at an angular distance from boresight in normalized beam widths */
+  double pedestalGain(double phi, float refGain)
+  {
+    double gain = 0.;
+
+    // Determine lobe and compute antenna gain
+    if (phi < 1.29)
+    {
+      gain = refGain - 12.0 * square(phi);
+    }
+    else if (phi < 4.00)
+    {
+      gain = refGain - 20.0;
+    }
+    else if (phi < 5.00)
+    {
+      gain = 5.0 * refGain - phi * (refGain - 10.0) - 60.0;
+    }
+    else
+    {
+      gain = -10.0;
+    }
+
+    if (gain < -10.0)
+      gain = -10.0;
+
+    return gain;
+  }
+
+  /** Finds the lower index and interpolation factor of a value in a regularly spaced CRUISE axis */
+  void cruiseIndex(double value, double minVal, double step, int len, int& index, double& delta)
+  {
+    if (value <= minVal)
+    {
+      index = 0;
+      delta = 0.0;
+    }
+    else if (value >= minVal + step * (len-1))
+    {
+      index = len-2;
+      delta = 1.0;
+    }
+    else
+    {
+      double temp = (value-minVal)/step;
+      index = static_cast<int>(floor(temp));
+      delta = temp - index;
+    }
+  }
+
+  /** Finds the lower index and interpolation factor of a frequency in the CRUISE frequency list */
+  void cruiseFreqIndex(const double* freqData, int freqLen, double freq, int& index, double& delta)
+  {
+    index = 0;
+    delta = 0.0;
+    if (freq <= freqData[0])
+    {
+      index = 0;
+      delta = 0.0;
+    }
+    else if (freq >= freqData[freqLen-1])
+    {
+      index = freqLen-2;
+      delta = 1.0;
+    }
+    else
+    {
+      for (int i = 1; i < freqLen; i++)
+      {
+        if (freq < freqData[i])
+        {
+          index = i - 1;
+          delta = (freq - freqData[index]) / (freqData[index+1] - freqData[index]);
+          break;
+        }
+      }
+    }
+  }
+
+  /** Angle and gain pairs of a gain map, stored in contiguous arrays for grid evaluation */
+  class FlatGainTable
+  {
+  public:
+    explicit FlatGainTable(const std::map<float, float>& data)
+    {
+      angles_.reserve(data.size());
+      gains_.reserve(data.size());
+      for (std::map<float, float>::const_iterator iter = data.begin(); iter != data.end(); ++iter)
+      {
+        angles_.push_back(iter->first);
+        gains_.push_back(iter->second);
+      }
+    }
+
+    /** First angle in the table; table must not be empty */
+    float front() const { return angles_.front(); }
+    /** Last angle in the table; table must not be empty */
+    float back() const { return angles_.back(); }
+
+    /** Returns the gain at the given angle, matching the map lookup in calculateGain() */
+    double lookup(double ang) const
+    {
+      const std::vector<float>::const_iterator iter = std::lower_bound(angles_.begin(), angles_.end(), static_cast<float>(ang));
+      if (iter != angles_.end())
+      {
+        const size_t hi = iter - angles_.begin();
+        if (angles_[hi] == ang || hi == 0)
+          return gains_[hi];
+        const double hiGain = gains_[hi];
+        const double loGain = gains_[hi - 1];
+        return linearInterpolate(loGain, hiGain, angles_[hi - 1], ang, angles_[hi]);
+      }
+      // check for rounding errors due to casting
+      if (areEqual(ang, angles_.front()))
+        return gains_.front();
+      if (areEqual(ang, angles_.back()))
+        return gains_.back();
+      return SMALL_DB_VAL;
+    }
+
+  private:
+    std::vector<float> angles_;
+    std::vector<float> gains_;
+  };
+
+  /**
+  * Grid form of calculateGain(); without weighting, the azimuth and elevation lookups are done
+  * once per column and once per row.  Angles must already be converted as calculateGain() expects.
+  */
+  void calculateGainGrid(const std::map<float, float>& azimData,
+    const std::map<float, float>& elevData,
+    const std::vector<float>& azimuths,
+    const std::vector<float>& elevations,
+    float hbw,
+    float vbw,
+    float maxGain,
+    bool applyWeight,
+    std::vector<float>& gains)
+  {
+    const size_t numAzim = azimuths.size();
+    gains.resize(numAzim * elevations.size());
+    if (azimData.empty() || elevData.empty())
+    {
+      std::fill(gains.begin(), gains.end(), static_cast<float>(SMALL_DB_VAL));
+      return;
+    }
+    const FlatGainTable azimTable(azimData);
+    const FlatGainTable elevTable(elevData);
+
+    std::vector<float>::iterator out = gains.begin();
+    if (!applyWeight)
+    {
+      std::vector<double> azGain(numAzim);
+      std::vector<bool> azValid(numAzim);
+      for (size_t a = 0; a < numAzim; ++a)
+      {
+        azValid[a] = !(azimuths[a] < azimTable.front() || azimuths[a] > azimTable.back());
+        azGain[a] = azimTable.lookup(azimuths[a]);
+      }
+      for (size_t e = 0; e < elevations.size(); ++e)
+      {
+        const float elev = elevations[e];
+        if (elev < elevTable.front() || elev > elevTable.back())
+        {
+          std::fill(out, out + numAzim, static_cast<float>(SMALL_DB_VAL));
+          out += numAzim;
+          continue;
+        }
+        const double elGain = elevTable.lookup(elev);
+        for (size_t a = 0; a < numAzim; ++a, ++out)
+          *out = azValid[a] ? static_cast<float>(maxGain + (azGain[a] + elGain) / 2.0) : static_cast<float>(SMALL_DB_VAL);
+      }
+      return;
+    }
+
+    std::vector<double> azimBw(numAzim);
+    for (size_t a = 0; a < numAzim; ++a)
+      azimBw[a] = azimuths[a] / hbw;
+    for (size_t e = 0; e < elevations.size(); ++e)
+    {
+      const double elev_bw = elevations[e] / vbw;
+      for (size_t a = 0; a < numAzim; ++a, ++out)
+      {
+        // Compute angular distance in normalized beam widths
+        const double azim_bw = azimBw[a];
+        const double phi = sqrt(square(azim_bw) + square(elev_bw));
+        const double az_gain = azimTable.lookup(sdkMin(phi * hbw, M_PI));
+        const double el_gain = elevTable.lookup(sdkMin(phi * vbw, M_PI_2));
+
+        // weighted average, see calculateGain()
+        double gain;
+        if ((azim_bw == 0.0 && elev_bw == 0.0) || vbw == hbw)
+        {
+          gain = maxGain + (az_gain + el_gain) / 2.0;
+        }
+        else if (azim_bw <= elev_bw)
+        {
+          double alpha = fabs(atan2(azim_bw, elev_bw));
+          if (alpha > M_PI_2)
+            alpha = M_PI - alpha;
+          const double beta = M_PI_2 - alpha;
+          gain = maxGain + (alpha * az_gain + beta * el_gain) / M_PI_2;
+        }
+        else
+        {
+          double beta = fabs(atan2(elev_bw, azim_bw));
+          if (beta > M_PI_2)
+            beta = M_PI - beta;
+          const double alpha = M_PI_2 - beta;
+          gain = maxGain + (alpha * az_gain + beta * el_gain) / M_PI_2;
+        }
+        *out = static_cast<float>(gain);
+      }
+    }
+  }
+
+  /** Grid evaluation shared by the absolute and relative table patterns */
+  void tableGainGrid(bool valid, const std::map<float, float>& azimData, const std::map<float, float>& elevData,
+    const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+  {
+    if (!valid)
+    {
+      gains.assign(azimuths.size() * elevations.size(), static_cast<float>(SMALL_DB_VAL));
+      return;
+    }
+    std::vector<float> azim(azimuths.size());
+    for (size_t a = 0; a < azimuths.size(); ++a)
+      azim[a] = static_cast<float>(angFixPI(azimuths[a]));
+    std::vector<float> elev(elevations.size());
+    for (size_t e = 0; e < elevations.size(); ++e)
+      elev[e] = static_cast<float>(angFixPI2(elevations[e]));
+    calculateGainGrid(azimData, elevData, azim, elev, params.hbw_, params.vbw_, params.refGain_, params.weighting_, gains);
+  }
+
+  /**
+  * Grid form of the bilinear gain lookup used by the EZNEC and XFDTD patterns; points outside the
+  * table are SMALL_DB_VAL.  Angles must already be converted to table units.
+  */
+  void bilinearGainGrid(const GainData& data, const std::vector<float>& x, const std::vector<float>& y, float refGain, std::vector<float>& gains)
+  {
+    const LUT::LUT2<float>& lut = data.lut();
+    const size_t numX = x.size();
+    gains.resize(numX * y.size());
+    std::vector<bool> xValid(numX);
+    for (size_t a = 0; a < numX; ++a)
+      xValid[a] = !(x[a] > lut.maxX() || x[a] < lut.minX());
+
+    std::vector<float>::iterator out = gains.begin();
+    for (size_t e = 0; e < y.size(); ++e)
+    {
+      const bool yValid = !(y[e] > lut.maxY() || y[e] < lut.minY());
+      for (size_t a = 0; a < numX; ++a, ++out)
+      {
+        if (!yValid || !xValid[a])
+        {
+          *out = static_cast<float>(SMALL_DB_VAL);
+          continue;
+        }
+        float gain = refGain;
+        gain += BilinearLookupNoException(data, x[a], y[e]);
+        *out = gain;
+      }
+    }
+  }
+}
+
 // Returns the string representation of the antenna pattern type
 std::string simCore::antennaPatternTypeString(AntennaPatternType antPatType)
 {
@@ -798,6 +1085,24 @@ AntennaPattern* simCore::loadPatternFile(const std::string &filename, float freq
   return pattern;
 }
 
+// ----------------------------------------------------------------------------
+
+void AntennaPattern::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  gains.resize(azimuths.size() * elevations.size());
+  AntennaGainParameters agp(params);
+  std::vector<float>::iterator out = gains.begin();
+  for (std::vector<float>::const_iterator elev = elevations.begin(); elev != elevations.end(); ++elev)
+  {
+    agp.elev_ = *elev;
+    for (std::vector<float>::const_iterator azim = azimuths.begin(); azim != azimuths.end(); ++azim, ++out)
+    {
+      agp.azim_ = *azim;
+      *out = gain(agp);
+    }
+  }
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
@@ -812,6 +1117,22 @@ float AntennaPatternGauss::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternGauss::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  // pattern varies with elevation only
+  const size_t numAzim = azimuths.size();
+  gains.resize(numAzim * elevations.size());
+  AntennaGainParameters agp(params);
+  std::vector<float>::iterator out = gains.begin();
+  for (size_t e = 0; e < elevations.size(); ++e, out += numAzim)
+  {
+    agp.elev_ = elevations[e];
+    std::fill(out, out + numAzim, AntennaPatternGauss::gain(agp));
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternGauss::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
@@ -856,6 +1177,22 @@ float AntennaPatternCscSq::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternCscSq::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  // pattern varies with elevation only
+  const size_t numAzim = azimuths.size();
+  gains.resize(numAzim * elevations.size());
+  AntennaGainParameters agp(params);
+  std::vector<float>::iterator out = gains.begin();
+  for (size_t e = 0; e < elevations.size(); ++e, out += numAzim)
+  {
+    agp.elev_ = elevations[e];
+    std::fill(out, out + numAzim, AntennaPatternCscSq::gain(agp));
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternCscSq::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
@@ -898,19 +1235,27 @@ float AntennaPatternSinXX::gain(const AntennaGainParameters &params)
 
   // Compute angular distance in normalized beam widths
   double phi = sqrt(square(dazim/params.hbw_) + square(delev/params.vbw_));
+  return static_cast<float>(sinXXGain(phi, params.refGain_, params.firstLobe_));
+}
 
-  // Compute antenna gain
-  if (phi == 0.0)
-    return params.refGain_;
-
-  double gain = square(sin(2.783*phi) / (2.783*phi));
-  gain = params.refGain_ + 10.0 * log10(gain);
+// ----------------------------------------------------------------------------
 
-  // Add sin x/x side lobe gain
-  if (phi > M_2_SQRTPI)
-    gain += params.firstLobe_ + 13.2;
+void AntennaPatternSinXX::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  const size_t numAzim = azimuths.size();
+  gains.resize(numAzim * elevations.size());
+  // normalized azimuth distance is shared by each row
+  std::vector<double> azimTerm(numAzim);
+  for (size_t a = 0; a < numAzim; ++a)
+    azimTerm[a] = square(angFixPI(azimuths[a])/params.hbw_);
 
-  return static_cast<float>(gain);
+  std::vector<float>::iterator out = gains.begin();
+  for (size_t e = 0; e < elevations.size(); ++e)
+  {
+    const double elevTerm = square(angFixPI(elevations[e])/params.vbw_);
+    for (size_t a = 0; a < numAzim; ++a, ++out)
+      *out = static_cast<float>(sinXXGain(sqrt(azimTerm[a] + elevTerm), params.refGain_, params.firstLobe_));
+  }
 }
 
 // ----------------------------------------------------------------------------
@@ -963,6 +1308,13 @@ float AntennaPatternOmni::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternOmni::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  gains.assign(azimuths.size() * elevations.size(), params.refGain_);
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternOmni::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
@@ -978,36 +1330,32 @@ void AntennaPatternOmni::minMaxGain(float *min, float *max, const AntennaGainPar
 
 float AntennaPatternPedestal::gain(const AntennaGainParameters &params)
 {
-  double gain = 0.;
-
   double delev = angFixPI(params.elev_);
   double dazim = angFixPI(params.azim_);
 
   // Compute angular distance in normalized beam widths
   double phi = (sqrt(square(dazim/params.hbw_) + square(delev/params.vbw_)));
+  return static_cast<float>(pedestalGain(phi, params.refGain_));
+}
 
-  // Determine lobe and compute antenna gain
-  if (phi < 1.29)
-  {
-    gain = params.refGain_ - 12.0 * square(phi);
-  }
-  else if (phi < 4.00)
-  {
-    gain = params.refGain_ - 20.0;
-  }
-  else if (phi < 5.00)
-  {
-    gain = 5.0 * params.refGain_ - phi * (params.refGain_ - 10.0) - 60.0;
-  }
-  else
-  {
-    gain = -10.0;
-  }
+// ----------------------------------------------------------------------------
 
-  if (gain < -10.0)
-    gain = -10.0;
+void AntennaPatternPedestal::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  const size_t numAzim = azimuths.size();
+  gains.resize(numAzim * elevations.size());
+  // normalized azimuth distance is shared by each row
+  std::vector<double> azimTerm(numAzim);
+  for (size_t a = 0; a < numAzim; ++a)
+    azimTerm[a] = square(angFixPI(azimuths[a])/params.hbw_);
 
-  return static_cast<float>(gain);
+  std::vector<float>::iterator out = gains.begin();
+  for (size_t e = 0; e < elevations.size(); ++e)
+  {
+    const double elevTerm = square(angFixPI(elevations[e])/params.vbw_);
+    for (size_t a = 0; a < numAzim; ++a, ++out)
+      *out = static_cast<float>(pedestalGain(sqrt(azimTerm[a] + elevTerm), params.refGain_));
+  }
 }
 
 // ----------------------------------------------------------------------------
@@ -1079,6 +1427,13 @@ float AntennaPatternTable::gain(const AntennaGainParameters &params)
     params.weighting_);
 }
 
+// ----------------------------------------------------------------------------
+
+void AntennaPatternTable::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  tableGainGrid(valid_, azimData_, elevData_, azimuths, elevations, params, gains);
+}
+
 /// --------------------------------------------------------------------------
 int AntennaPatternTable::readPat(istream& fp)
 {
@@ -1369,6 +1724,13 @@ float AntennaPatternRelativeTable::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternRelativeTable::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  tableGainGrid(valid_, azimData_, elevData_, azimuths, elevations, params, gains);
+}
+
+// ----------------------------------------------------------------------------
+
 int AntennaPatternRelativeTable::readPat_(istream& fp)
 {
   assert(fp);
@@ -1641,7 +2003,6 @@ float AntennaPatternCRUISE::gain(const AntennaGainParameters &params)
   double adelta=0;
   double edelta=0;
   double fdelta=0;
-  double temp=0;
 
   double dazim = RAD2DEG*(angFixPI(params.azim_));
   double delev = RAD2DEG*(angFixPI(params.elev_));
@@ -1649,65 +2010,10 @@ float AntennaPatternCRUISE::gain(const AntennaGainParameters &params)
   // need at least two points to interpolate
   assert(azimLen_ >= 2 && freqLen_ >= 2);
 
-  // Interpolate azimuth
-  if (dazim <= azimMin_)
-  {
-    alowindex = 0;
-    adelta    = 0.0;
-  }
-  else if (dazim >= azimMin_ + azimStep_ * (azimLen_-1))
-  {
-    alowindex = azimLen_-2;
-    adelta    = 1.0;
-  }
-  else
-  {
-    temp      = (dazim-azimMin_)/azimStep_;
-    alowindex = static_cast<int>(floor(temp));
-    adelta    = temp - alowindex;
-  }
-
-  // Interpolate elevation
-  if (delev <= elevMin_)
-  {
-    elowindex = 0;
-    edelta    = 0.0;
-  }
-  else if (delev >= elevMin_ + elevStep_ * (elevLen_-1))
-  {
-    elowindex = elevLen_-2;
-    edelta    = 1.0;
-  }
-  else
-  {
-    temp      = (delev-elevMin_)/elevStep_;
-    elowindex = static_cast<int>(floor(temp));
-    edelta    = temp - elowindex;
-  }
-
-  // Interpolate frequency
-  if (params.freq_ <= freqData_[0])
-  {
-    flowindex  = 0;
-    fdelta     = 0.0;
-  }
-  else if (params.freq_ >= freqData_[freqLen_-1])
-  {
-    flowindex  = freqLen_-2;
-    fdelta     = 1.0;
-  }
-  else
-  {
-    for (int i = 1; i < freqLen_; i++)
-    {
-      if (params.freq_ < freqData_[i])
-      {
-        flowindex = i - 1;
-        fdelta = (params.freq_ - freqData_[flowindex]) / (freqData_[flowindex+1] - freqData_[flowindex]);
-        break;
-      }
-    }
-  }
+  // Interpolate azimuth, elevation and frequency
+  cruiseIndex(dazim, azimMin_, azimStep_, azimLen_, alowindex, adelta);
+  cruiseIndex(delev, elevMin_, elevStep_, elevLen_, elowindex, edelta);
+  cruiseFreqIndex(freqData_, freqLen_, params.freq_, flowindex, fdelta);
 
   double azGain = (azimData_[flowindex  ][alowindex  ]*(1.0-fdelta)*(1.0-adelta) +
     azimData_[flowindex  ][alowindex+1]*(1.0-fdelta)*     adelta  +
@@ -1726,6 +2032,55 @@ float AntennaPatternCRUISE::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternCRUISE::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  const size_t numAzim = azimuths.size();
+  if (!valid_)
+  {
+    gains.assign(numAzim * elevations.size(), static_cast<float>(SMALL_DB_VAL));
+    return;
+  }
+  gains.resize(numAzim * elevations.size());
+
+  // need at least two points to interpolate
+  assert(azimLen_ >= 2 && freqLen_ >= 2);
+
+  int flowindex = 0;
+  double fdelta = 0;
+  cruiseFreqIndex(freqData_, freqLen_, params.freq_, flowindex, fdelta);
+
+  // azimuth and elevation gains are separable; interpolate each column and row once
+  std::vector<double> azGains(numAzim);
+  for (size_t a = 0; a < numAzim; ++a)
+  {
+    int alowindex = 0;
+    double adelta = 0;
+    cruiseIndex(RAD2DEG*(angFixPI(azimuths[a])), azimMin_, azimStep_, azimLen_, alowindex, adelta);
+    azGains[a] = (azimData_[flowindex  ][alowindex  ]*(1.0-fdelta)*(1.0-adelta) +
+      azimData_[flowindex  ][alowindex+1]*(1.0-fdelta)*     adelta  +
+      azimData_[flowindex+1][alowindex  ]*     fdelta *(1.0-adelta) +
+      azimData_[flowindex+1][alowindex+1]*     fdelta *     adelta);
+  }
+
+  std::vector<float>::iterator out = gains.begin();
+  for (size_t e = 0; e < elevations.size(); ++e)
+  {
+    int elowindex = 0;
+    double edelta = 0;
+    cruiseIndex(RAD2DEG*(angFixPI(elevations[e])), elevMin_, elevStep_, elevLen_, elowindex, edelta);
+    const double elGain = (elevData_[flowindex  ][elowindex  ]*(1.0-fdelta)*(1.0-edelta) +
+      elevData_[flowindex  ][elowindex+1]*(1.0-fdelta)*     edelta  +
+      elevData_[flowindex+1][elowindex  ]*     fdelta *(1.0-edelta) +
+      elevData_[flowindex+1][elowindex+1]*     fdelta *     edelta);
+
+    // CRUISE Antenna Table data are saved as voltage gains instead of power gains
+    for (size_t a = 0; a < numAzim; ++a, ++out)
+      *out = static_cast<float>(square(azGains[a] * elGain));
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternCRUISE::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
@@ -1876,7 +2231,8 @@ AntennaPatternMonopulse::AntennaPatternMonopulse()
   : AntennaPattern(),
   freq_(0),
   minDelGain_(-SMALL_DB_VAL),
-  maxDelGain_(SMALL_DB_VAL)
+  maxDelGain_(SMALL_DB_VAL),
+  lastGain_(SMALL_DB_VAL)
 {}
 
 // ----------------------------------------------------------------------------
@@ -1941,6 +2297,16 @@ void AntennaPatternMonopulse::minMaxGain(float *min, float *max, const AntennaGa
   if (!min || !max)
     return;
 
+  // cached bounds include the reference gain
+  if (params.refGain_ != lastGain_)
+  {
+    lastGain_ = params.refGain_;
+    minGain_ = -SMALL_DB_VAL;
+    maxGain_ = SMALL_DB_VAL;
+    minDelGain_ = -SMALL_DB_VAL;
+    maxDelGain_ = SMALL_DB_VAL;
+  }
+
   if (params.delta_ && minDelGain_ == -SMALL_DB_VAL)
   {
     setMinMaxGain_(&minDelGain_, &maxDelGain_, params.refGain_, params.delta_);
@@ -2139,7 +2505,8 @@ AntennaPatternNSMA::AntennaPatternNSMA()
   minVHGain_(-SMALL_DB_VAL),
   maxVHGain_(SMALL_DB_VAL),
   minVVGain_(-SMALL_DB_VAL),
-  maxVVGain_(SMALL_DB_VAL)
+  maxVVGain_(SMALL_DB_VAL),
+  lastGain_(SMALL_DB_VAL)
 {}
 
 // ----------------------------------------------------------------------------
@@ -2204,12 +2571,60 @@ float AntennaPatternNSMA::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternNSMA::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  if (!valid_)
+  {
+    gains.assign(azimuths.size() * elevations.size(), static_cast<float>(SMALL_DB_VAL));
+    return;
+  }
+
+  const std::map<float, float>* azimData = &HHDataMap_;
+  const std::map<float, float>* elevData = &ELHHDataMap_;
+  switch (params.polarity_)
+  {
+  case POLARITY_VERTICAL:
+    azimData = &VVDataMap_;
+    elevData = &ELVVDataMap_;
+    break;
+  case POLARITY_HORZVERT:
+  case POLARITY_RIGHTCIRC:
+    azimData = &HVDataMap_;
+    elevData = &ELHVDataMap_;
+    break;
+  case POLARITY_VERTHORZ:
+  case POLARITY_LEFTCIRC:
+    azimData = &VHDataMap_;
+    elevData = &ELVHDataMap_;
+    break;
+  default:
+    break;
+  }
+  calculateGainGrid(*azimData, *elevData, azimuths, elevations, halfPowerBeamWidth_, halfPowerBeamWidth_, midBandGain_ + params.refGain_, false, gains);
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternNSMA::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
   if (!min || !max)
     return;
 
+  // cached bounds include the reference gain
+  if (params.refGain_ != lastGain_)
+  {
+    lastGain_ = params.refGain_;
+    minGain_ = -SMALL_DB_VAL;
+    maxGain_ = SMALL_DB_VAL;
+    minHVGain_ = -SMALL_DB_VAL;
+    maxHVGain_ = SMALL_DB_VAL;
+    minVHGain_ = -SMALL_DB_VAL;
+    maxVHGain_ = SMALL_DB_VAL;
+    minVVGain_ = -SMALL_DB_VAL;
+    maxVVGain_ = SMALL_DB_VAL;
+  }
+
   switch (params.polarity_)
   {
   case POLARITY_VERTICAL:
@@ -2722,6 +3137,41 @@ float AntennaPatternEZNEC::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternEZNEC::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  if (!valid_)
+  {
+    gains.assign(azimuths.size() * elevations.size(), static_cast<float>(SMALL_DB_VAL));
+    return;
+  }
+
+  std::vector<float> azim(azimuths.size());
+  for (size_t a = 0; a < azimuths.size(); ++a)
+  {
+    // adjust requested azim based on pattern's angle convention
+    const float azimConv = (angleConvCCW_) ? -azimuths[a] : static_cast<float>((M_PI_2 + azimuths[a]));
+    azim[a] = static_cast<float>(RAD2DEG*(angFix2PI(azimConv)));
+  }
+  std::vector<float> elev(elevations.size());
+  for (size_t e = 0; e < elevations.size(); ++e)
+    elev[e] = static_cast<float>(RAD2DEG*(angFixPI2(elevations[e])));
+
+  switch (params.polarity_)
+  {
+  case POLARITY_VERTICAL:
+    bilinearGainGrid(vertData_, azim, elev, params.refGain_, gains);
+    break;
+  case POLARITY_HORIZONTAL:
+    bilinearGainGrid(horzData_, azim, elev, params.refGain_, gains);
+    break;
+  default:
+    bilinearGainGrid(totalData_, azim, elev, params.refGain_, gains);
+    break;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternEZNEC::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
@@ -3115,6 +3565,37 @@ float AntennaPatternXFDTD::gain(const AntennaGainParameters &params)
 
 // ----------------------------------------------------------------------------
 
+void AntennaPatternXFDTD::gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains)
+{
+  if (!valid_)
+  {
+    gains.assign(azimuths.size() * elevations.size(), static_cast<float>(SMALL_DB_VAL));
+    return;
+  }
+
+  std::vector<float> azim(azimuths.size());
+  for (size_t a = 0; a < azimuths.size(); ++a)
+    azim[a] = static_cast<float>(RAD2DEG*(angFix2PI(azimuths[a]+M_PI_2)));
+  std::vector<float> elev(elevations.size());
+  for (size_t e = 0; e < elevations.size(); ++e)
+    elev[e] = static_cast<float>(RAD2DEG*(angFixPI2(elevations[e])));
+
+  switch (params.polarity_)
+  {
+  case POLARITY_VERTICAL:
+    bilinearGainGrid(vertData_, azim, elev, params.refGain_, gains);
+    break;
+  case POLARITY_HORIZONTAL:
+    bilinearGainGrid(horzData_, azim, elev, params.refGain_, gains);
+    break;
+  default:
+    bilinearGainGrid(totalData_, azim, elev, params.refGain_, gains);
+    break;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 void AntennaPatternXFDTD::minMaxGain(float *min, float *max, const AntennaGainParameters &params)
 {
   assert(min && max);
@@ -24,11 +24,13 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <complex>
 #include <cfloat>
 
 #include "simCore/Common/Common.h"
+#include "simCore/Common/Memory.h"
 #include "simCore/LUT/InterpTable.h"
 #include "simCore/EM/Decibel.h"
 #include "simCore/EM/Constants.h"
@@ -224,6 +226,25 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params) = 0;
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and
+    * elevations.  The default implementation calls gain() for each point; derived classes override it
+    * with evaluations that share the per row and per column work.
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major: gain for azimuths[a] and elevations[e]
+    *   is at gains[e * azimuths.size() + a]
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently, e.g. by several threads each
+    * evaluating a different set of elevations
+    * @return true if gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return false; }
+
     /**
     * This method returns the file name of the antenna pattern
     * @return file name.
@@ -256,6 +277,8 @@ namespace simCore
     std::string filename_;        ///< Filename containing antenna pattern data
   };
 
+  /// Shared pointer of an Antenna Pattern
+  typedef std::tr1::shared_ptr<AntennaPattern> AntennaPatternPtr;
 
   /// Gaussian antenna pattern class
   class SDKCORE_EXPORT AntennaPatternGauss : public AntennaPattern
@@ -286,6 +309,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
   protected:
     float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
   };
@@ -320,6 +358,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
   protected:
     float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
   };
@@ -354,6 +407,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
   protected:
     float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
     float lastHbw_;             ///< Last horizontal beam width used to calculate min & max gains
@@ -389,6 +457,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
   protected:
     float lastVbw_;             ///< Last vertical beam width used to calculate min & max gains
     float lastHbw_;             ///< Last horizontal beam width used to calculate min & max gains
@@ -425,6 +508,21 @@ namespace simCore
     * @pre min and max valid params
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
+
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
   };
 
 
@@ -457,6 +555,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
     /**
     * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat
     * @param[in ] file Input file name
@@ -543,6 +656,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
     /**
     * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
     * @param[in ] file Input file name
@@ -606,6 +734,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
     /**
     * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
     * @param[in ] file Input file name
@@ -670,6 +813,7 @@ namespace simCore
     double freq_; ///< Current freq associated with computed gain
     float minDelGain_; ///< Minimum delta gain value (dB)
     float maxDelGain_; ///< Maximum delta gain value (dB)
+    float lastGain_; ///< Reference gain used to calculate min & max gains (dB)
 
     SymmetricAntennaPattern sumPat_;  ///< Monopulse sum pattern (linear)
     SymmetricAntennaPattern delPat_;  ///< Monopulse delta pattern (linear)
@@ -784,6 +928,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
     /**
     * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
     * @param[in ] file Input file name
@@ -814,6 +973,7 @@ namespace simCore
     std::map<float, float> ELVVDataMap_;  ///< Elevation VV polarization gain data (dB)
     float minVVGain_;                     ///< Minimum VV gain value (dB)
     float maxVVGain_;                     ///< Maximum VV gain value (dB)
+    float lastGain_;                      ///< Reference gain used to calculate min & max gains (dB)
 
     /**
     * This method parses and stores the incoming antenna pattern data
@@ -863,6 +1023,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
     /**
     * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
     * @param[in ] file Input file name
@@ -920,6 +1095,21 @@ namespace simCore
     */
     virtual void minMaxGain(float *min, float *max, const AntennaGainParameters &params);
 
+    /**
+    * This method computes the antenna pattern gain for every combination of the requested azimuths and elevations
+    * @param[in ] azimuths Relative azimuth angles, referenced to host antenna (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host antenna (rad)
+    * @param[in ] params Collection of antenna parameters; azim_ and elev_ are ignored
+    * @param[out] gains Antenna pattern gains (dB), elevation major
+    */
+    virtual void gainGrid(const std::vector<float>& azimuths, const std::vector<float>& elevations, const AntennaGainParameters &params, std::vector<float>& gains);
+
+    /**
+    * This method indicates whether gainGrid() may be called concurrently
+    * @return true, gainGrid() does not modify the pattern
+    */
+    virtual bool gainGridThreadSafe() const { return true; }
+
     /**
     * This method checks the incoming antenna pattern data filename, opens a file stream and calls readPat_
     * @param[in ] file Input file name
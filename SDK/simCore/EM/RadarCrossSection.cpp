@@ -104,6 +104,24 @@ namespace
 
 }
 
+/* ************************************************************************ */
+/* RadarCrossSection Methods                                                */
+/* ************************************************************************ */
+
+void RadarCrossSection::RCSdBGrid(float freq, const std::vector<double>& azimuths, const std::vector<double>& elevations, PolarityType pol, std::vector<float>& rcsdB)
+{
+  rcsdB.resize(azimuths.size() * elevations.size());
+  std::vector<float>::iterator out = rcsdB.begin();
+  for (std::vector<double>::const_iterator elev = elevations.begin(); elev != elevations.end(); ++elev)
+  {
+    for (std::vector<double>::const_iterator azim = azimuths.begin(); azim != azimuths.end(); ++azim)
+    {
+      *out = RCSdB(freq, *azim, *elev, pol);
+      ++out;
+    }
+  }
+}
+
 /* ************************************************************************ */
 /* RCSTableUD Methods                                                       */
 /* ************************************************************************ */
@@ -212,7 +230,8 @@ RCSLUT::RCSLUT()
   min_(std::numeric_limits<float>::max()),
   max_(-std::numeric_limits<float>::max()),
   lastFreq_(-std::numeric_limits<float>::max()),
-  lastPolarity_(POLARITY_UNKNOWN)
+  lastPolarity_(POLARITY_UNKNOWN),
+  compiled_(NULL)
 {
   for (unsigned int i = 0; i < 2; ++i)
   {
@@ -232,6 +251,7 @@ RCSLUT::~RCSLUT()
     delete it->second;
     ++it;
   }
+  delete compiled_;
 }
 
 /* ************************************************************************ */
@@ -561,6 +581,37 @@ float RCSLUT::RCSsm(float freq, double azim, double elev,  PolarityType pol)
 
 /* ************************************************************************ */
 
+void RCSLUT::modulation(float mod)
+{
+  modulation_ = mod;
+  // compiled tables include the modulation as a bias
+  delete compiled_;
+  compiled_ = NULL;
+}
+
+/* ************************************************************************ */
+
+void RCSLUT::RCSdBGrid(float freq, const std::vector<double>& azimuths, const std::vector<double>& elevations, PolarityType pol, std::vector<float>& rcsdB)
+{
+  // same frequency tolerance as the table lookup in calcTableRCS_()
+  if (compiled_ == NULL || !simCore::areEqual(compiled_->freq(), freq, 0.1) || compiled_->polarity() != pol)
+  {
+    CompiledRCSLUT* compiled = new CompiledRCSLUT;
+    if (compiled->compile(*this, freq, pol) != 0)
+    {
+      // random distribution, every point needs its own draw
+      delete compiled;
+      RadarCrossSection::RCSdBGrid(freq, azimuths, elevations, pol, rcsdB);
+      return;
+    }
+    delete compiled_;
+    compiled_ = compiled;
+  }
+  compiled_->RCSdBGrid(azimuths, elevations, rcsdB);
+}
+
+/* ************************************************************************ */
+
 int RCSLUT::loadXPATCHRCSFile_(std::istream &inFile)
 {
   int rv = 1;
@@ -1314,6 +1365,8 @@ void RCSLUT::reset_()
     ++it;
   }
   rcsMap_.clear();
+  delete compiled_;
+  compiled_ = NULL;
   tableType_ = RCS_LUT_TYPE;
   functionType_ = RCS_MEAN_FUNC;
   modulation_ = 1.f;
@@ -1383,6 +1436,263 @@ int RCSLUT::loadRCSFile(std::istream& istream)
 }
 
 
+/* ************************************************************************ */
+/* CompiledRCSLUT Methods                                                   */
+/* ************************************************************************ */
+
+CompiledRCSLUT::CompiledRCSLUT()
+  : freq_(0.f),
+  polarity_(POLARITY_UNKNOWN),
+  symmetric_(false),
+  bias_(0.f)
+{
+}
+
+/* ************************************************************************ */
+
+int CompiledRCSLUT::compile(const RCSLUT& lut, float freq, PolarityType pol)
+{
+  freq_ = freq;
+  polarity_ = pol;
+  symmetric_ = (lut.tableType() == RCS_SYM_LUT_TYPE);
+  bias_ = 0.f;
+  elevs_.clear();
+  tables_.clear();
+  azims_.clear();
+  values_.clear();
+
+  if (lut.tableType() == RCS_DISTRIBUTION_FUNC_TYPE)
+  {
+    if (lut.functionType() != RCS_MEAN_FUNC)
+      return 1;
+    // scintillation applied to mean value
+    bias_ = lut.modulation();
+  }
+
+  // select polarity and frequency the same way RCSLUT::calcTableRCS_() does
+  const POLARITY_FREQ_ELEV_MAP& rcsMap = lut.tables();
+  if (rcsMap.empty())
+    return 0;
+  POLARITY_FREQ_ELEV_MAP::const_iterator pfeiter = (pol == POLARITY_UNKNOWN) ? rcsMap.begin() : rcsMap.find(pol);
+  if (pfeiter == rcsMap.end())
+    return 0;
+
+  const FREQ_ELEV_MAP& freqMap = pfeiter->second->freqMap;
+  if (freqMap.empty())
+    return 0;
+  FREQ_ELEV_MAP::const_iterator feiter = freqMap.find(freq);
+  if (feiter == freqMap.end())
+  {
+    feiter = freqMap.lower_bound(freq);
+    if (feiter == freqMap.end())
+    {
+      --feiter;
+    }
+    else if (feiter != freqMap.begin())
+    {
+      float maxFreq = feiter->first;
+      --feiter;
+      float minFreq = feiter->first;
+      if (fabs(freq-minFreq) > fabs(maxFreq-freq))
+        ++feiter;
+    }
+  }
+
+  const ELEV_RCSTABLE_MAP& eMap = feiter->second->eMap;
+  for (ELEV_RCSTABLE_MAP::const_iterator eiter = eMap.begin(); eiter != eMap.end(); ++eiter)
+  {
+    const AZIM_RCS_MAP& azMap = eiter->second->azimuthMap();
+    Table table;
+    table.offset = azims_.size();
+    table.count = azMap.size();
+    table.invStep = 0.;
+    for (AZIM_RCS_MAP::const_iterator aiter = azMap.begin(); aiter != azMap.end(); ++aiter)
+    {
+      azims_.push_back(aiter->first);
+      values_.push_back(aiter->second);
+    }
+
+    // detect regular spacing, used to compute the starting index directly
+    if (table.count > 2)
+    {
+      const float* az = &azims_[table.offset];
+      const double step = (static_cast<double>(az[table.count - 1]) - az[0]) / (table.count - 1);
+      bool regular = (step > 0.);
+      for (size_t i = 1; regular && i < table.count; ++i)
+        regular = simCore::areEqual(az[i] - az[0], i * step, 1.0e-4 * step);
+      if (regular)
+        table.invStep = 1. / step;
+    }
+
+    elevs_.push_back(eiter->first);
+    tables_.push_back(table);
+  }
+  return 0;
+}
+
+/* ************************************************************************ */
+
+double CompiledRCSLUT::fixAzimuth_(double azim) const
+{
+  azim = angFix2PI(azim);
+  if (symmetric_)
+    return static_cast<float>(fabs(angFixPI(azim)));
+  return azim;
+}
+
+/* ************************************************************************ */
+
+bool CompiledRCSLUT::findTables_(double elev, size_t& lo, size_t& hi) const
+{
+  if (elevs_.empty())
+    return false;
+  if (elevs_.size() == 1)
+  {
+    lo = hi = 0;
+    return true;
+  }
+
+  const float fElev = static_cast<float>(elev);
+  const std::vector<float>::const_iterator iter = std::lower_bound(elevs_.begin(), elevs_.end(), fElev);
+  if (iter == elevs_.end())
+  {
+    // after last table
+    lo = hi = elevs_.size() - 1;
+  }
+  else if (*iter == fElev || iter == elevs_.begin())
+  {
+    // exact match, or before first table
+    lo = hi = iter - elevs_.begin();
+  }
+  else
+  {
+    // in between two tables, need to interpolate
+    hi = iter - elevs_.begin();
+    lo = hi - 1;
+  }
+  return true;
+}
+
+/* ************************************************************************ */
+
+float CompiledRCSLUT::tableRCS_(const Table& table, double azim) const
+{
+  // matches RCSTable::RCS(), including the float comparisons against the keys
+  if (table.count == 0)
+    return static_cast<float>(SMALL_RCS_SM);
+  const float* az = &azims_[table.offset];
+  const float* val = &values_[table.offset];
+  const size_t last = table.count - 1;
+  if (last == 0)
+    return val[0];
+
+  const float fAzim = static_cast<float>(azim);
+  if (fAzim <= az[0])
+    return val[0];
+  if (fAzim >= az[last])
+    return val[last];
+
+  // find i such that az[i] <= fAzim < az[i+1]
+  size_t i;
+  if (table.invStep != 0.)
+  {
+    const double index = (fAzim - az[0]) * table.invStep;
+    i = (index < static_cast<double>(last)) ? static_cast<size_t>(index) : last - 1;
+    // correct for rounding of the computed index
+    while (i > 0 && az[i] > fAzim)
+      --i;
+    while (i + 1 < last && az[i + 1] <= fAzim)
+      ++i;
+  }
+  else
+  {
+    i = (std::upper_bound(az, az + table.count, fAzim) - az) - 1;
+  }
+
+  if (az[i] == fAzim)
+    return val[i];
+  return linearInterpolate(val[i], val[i + 1], az[i], azim, az[i + 1]);
+}
+
+/* ************************************************************************ */
+
+float CompiledRCSLUT::rcs_(double azim, double elev) const
+{
+  size_t lo = 0;
+  size_t hi = 0;
+  float rcs = static_cast<float>(SMALL_RCS_SM);
+  if (!findTables_(elev, lo, hi))
+    return rcs + bias_;
+
+  if (lo == hi)
+    rcs = tableRCS_(tables_[lo], azim);
+  else
+    rcs = linearInterpolate(tableRCS_(tables_[lo], azim), tableRCS_(tables_[hi], azim), elevs_[lo], elev, elevs_[hi]);
+  return rcs + bias_;
+}
+
+/* ************************************************************************ */
+
+float CompiledRCSLUT::RCSsm(double azim, double elev) const
+{
+  return rcs_(fixAzimuth_(azim), angFixPI(elev));
+}
+
+/* ************************************************************************ */
+
+float CompiledRCSLUT::RCSdB(double azim, double elev) const
+{
+  return static_cast<float>(linear2dB(RCSsm(azim, elev)));
+}
+
+/* ************************************************************************ */
+
+void CompiledRCSLUT::RCSdBGrid(const std::vector<double>& azimuths, const std::vector<double>& elevations, std::vector<float>& rcsdB) const
+{
+  const size_t numAzim = azimuths.size();
+  rcsdB.resize(numAzim * elevations.size());
+  if (rcsdB.empty())
+    return;
+
+  std::vector<double> fixedAzim(numAzim);
+  for (size_t a = 0; a < numAzim; ++a)
+    fixedAzim[a] = fixAzimuth_(azimuths[a]);
+
+  std::vector<float> loRow(numAzim);
+  std::vector<float> hiRow(numAzim);
+  float* out = &rcsdB[0];
+  for (size_t e = 0; e < elevations.size(); ++e, out += numAzim)
+  {
+    const double elev = angFixPI(elevations[e]);
+    size_t lo = 0;
+    size_t hi = 0;
+    if (!findTables_(elev, lo, hi))
+    {
+      const float small = static_cast<float>(linear2dB(SMALL_RCS_SM + bias_));
+      std::fill(out, out + numAzim, small);
+      continue;
+    }
+
+    const Table& loTable = tables_[lo];
+    for (size_t a = 0; a < numAzim; ++a)
+      loRow[a] = tableRCS_(loTable, fixedAzim[a]);
+
+    if (lo == hi)
+    {
+      for (size_t a = 0; a < numAzim; ++a)
+        out[a] = static_cast<float>(linear2dB(static_cast<float>(loRow[a] + bias_)));
+      continue;
+    }
+
+    const Table& hiTable = tables_[hi];
+    for (size_t a = 0; a < numAzim; ++a)
+      hiRow[a] = tableRCS_(hiTable, fixedAzim[a]);
+    const double factor = getFactor(elevs_[lo], elev, elevs_[hi]);
+    for (size_t a = 0; a < numAzim; ++a)
+      out[a] = static_cast<float>(linear2dB(static_cast<float>(linearInterpolate(loRow[a], hiRow[a], factor) + bias_)));
+  }
+}
+
 /* ************************************************************************ */
 /* RcsFileParser Methods                                                    */
 /* ************************************************************************ */
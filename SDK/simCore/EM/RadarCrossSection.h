@@ -84,6 +84,19 @@ namespace simCore
     */
     virtual float RCSsm(float freq, double azim, double elev, PolarityType pol) = 0;
 
+    /**
+    * This method computes RCS values in dB for every combination of the requested azimuths and
+    * elevations.  The default implementation calls RCSdB() for each point; derived classes may
+    * override it with a faster evaluation of the whole grid.
+    * @param[in ] freq Frequency of radar in MHz
+    * @param[in ] azimuths Relative azimuth angles, referenced to host platform (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host platform (rad)
+    * @param[in ] pol Radar polarity
+    * @param[out] rcsdB RCS values (dB), elevation major: value for azimuths[a] and elevations[e] is at
+    *   rcsdB[e * azimuths.size() + a]
+    */
+    virtual void RCSdBGrid(float freq, const std::vector<double>& azimuths, const std::vector<double>& elevations, PolarityType pol, std::vector<float>& rcsdB);
+
     /**
     * This method checks the incoming RCS data filename, opens a file stream and parses the RCS data
     * @param[in ] fname Input file name
@@ -123,6 +136,12 @@ namespace simCore
     */
     float RCS(double azim) const;
 
+    /**
+    * This method retrieves the RCS data of this table
+    * @return RCS values (sq meters) keyed on host body azimuth (rad)
+    */
+    const AZIM_RCS_MAP& azimuthMap() const { return azMap_; }
+
     /**
     * This method sets the radar cross section value for the given azimuth
     * @param[in ] azim Azimuth value relative to host (rad)
@@ -202,6 +221,8 @@ namespace simCore
   /** RCS frequency tables keyed on RCS polarity */
   typedef std::map<PolarityType, FREQMAP*> POLARITY_FREQ_ELEV_MAP;
 
+  class CompiledRCSLUT;
+
   /**
    * @brief Storage class used for multiple sub-tables of RCS values associated to an azimuth value.
    *
@@ -264,10 +285,41 @@ namespace simCore
     virtual float RCSdB(float freq, double azim, double elev, PolarityType pol=POLARITY_UNKNOWN);
 
     /**
-    * This method sets the radar cross section modulation value
+    * This method computes RCS values in dB for every combination of the requested azimuths and
+    * elevations.  Deterministic tables are evaluated through a CompiledRCSLUT, which is rebuilt
+    * only when the frequency, polarity or modulation changes; tables with a random distribution
+    * function are evaluated point by point.
+    * @param[in ] freq Frequency of radar in MHz
+    * @param[in ] azimuths Relative azimuth angles, referenced to host platform (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host platform (rad)
+    * @param[in ] pol Radar polarity
+    * @param[out] rcsdB RCS values (dB), elevation major
+    */
+    virtual void RCSdBGrid(float freq, const std::vector<double>& azimuths, const std::vector<double>& elevations, PolarityType pol, std::vector<float>& rcsdB);
+
+    /**
+    * This method returns the RCS table type
+    * @return table type
+    */
+    RCSTableType tableType() const { return tableType_; }
+
+    /**
+    * This method returns the RCS distribution function
+    * @return distribution function
+    */
+    RCSFuncType functionType() const { return functionType_; }
+
+    /**
+    * This method returns the RCS data
+    * @return RCS tables keyed on polarity, frequency and elevation
+    */
+    const POLARITY_FREQ_ELEV_MAP& tables() const { return rcsMap_; }
+
+    /**
+    * This method sets the radar cross section modulation value, discarding the compiled tables
     * @param[in ] mod Radar cross section modulation value (sq meters)
     */
-    void modulation(float mod) { modulation_ = mod; }
+    void modulation(float mod);
 
     /**
     * This method returns the radar cross section modulation value
@@ -316,6 +368,7 @@ namespace simCore
     PolarityType lastPolarity_;         ///< last polarity used for look up
     RCSTable *loTable_[2];              ///< pointers to two last accessed lo tables
     RCSTable *hiTable_[2];              ///< pointers to two last accessed hi tables
+    CompiledRCSLUT* compiled_;          ///< compiled tables used by RCSdBGrid(), NULL until first needed
 
     /**
     * This method returns an azimuth based RCSTable
@@ -378,6 +431,105 @@ namespace simCore
     void computeStatistics_(std::vector<float> *medianVec);
   };
 
+  /**
+   * @brief Flat, read-only form of the RCSLUT tables for a single frequency and polarity.
+   *
+   * The RCSLUT stores its data in nested maps, so each lookup performs several tree searches.
+   * CompiledRCSLUT selects the tables for one frequency and polarity (using the same nearest
+   * frequency and polarity rules as RCSLUT) and stores their elevations, azimuths and values in
+   * contiguous arrays.  Tables with regularly spaced azimuths are indexed directly from a
+   * precomputed step; irregular tables use a binary search.  Results match RCSLUT::RCSsm() and
+   * RCSLUT::RCSdB() for the deterministic table types.
+   */
+  class SDKCORE_EXPORT CompiledRCSLUT
+  {
+  public:
+    CompiledRCSLUT();
+    virtual ~CompiledRCSLUT() {}
+
+    /**
+    * This method builds the flat tables from the given RCSLUT
+    * @param[in ] lut Source of the RCS data
+    * @param[in ] freq Frequency of radar in MHz
+    * @param[in ] pol Radar polarity
+    * @return 0 on success; non-zero if the RCSLUT uses a random distribution function, which
+    *   cannot be precomputed
+    */
+    int compile(const RCSLUT& lut, float freq, PolarityType pol);
+
+    /**
+    * This method returns the frequency passed to the last successful compile()
+    * @return frequency (MHz)
+    */
+    float freq() const { return freq_; }
+
+    /**
+    * This method returns the polarity passed to the last successful compile()
+    * @return polarity value
+    */
+    PolarityType polarity() const { return polarity_; }
+
+    /**
+    * This method returns the number of tables selected by compile()
+    * @return number of elevation tables
+    */
+    size_t numTables() const { return tables_.size(); }
+
+    /**
+    * This method computes the RCS value in square meters for the compiled frequency and polarity
+    * @param[in ] azim Relative azimuth angle, referenced to host platform (rad)
+    * @param[in ] elev Relative elevation angle, referenced to host platform (rad)
+    * @return RCS value (square meters)
+    */
+    float RCSsm(double azim, double elev) const;
+
+    /**
+    * This method computes the RCS value in dB for the compiled frequency and polarity
+    * @param[in ] azim Relative azimuth angle, referenced to host platform (rad)
+    * @param[in ] elev Relative elevation angle, referenced to host platform (rad)
+    * @return RCS value (dB)
+    */
+    float RCSdB(double azim, double elev) const;
+
+    /**
+    * This method computes RCS values in dB for every combination of the requested azimuths and
+    * elevations.  Azimuth normalization is done once per column and the elevation tables are
+    * selected once per row.
+    * @param[in ] azimuths Relative azimuth angles, referenced to host platform (rad)
+    * @param[in ] elevations Relative elevation angles, referenced to host platform (rad)
+    * @param[out] rcsdB RCS values (dB), elevation major: value for azimuths[a] and elevations[e] is at
+    *   rcsdB[e * azimuths.size() + a]
+    */
+    void RCSdBGrid(const std::vector<double>& azimuths, const std::vector<double>& elevations, std::vector<float>& rcsdB) const;
+
+  private:
+    /** Location of one elevation table in the flat arrays */
+    struct Table
+    {
+      size_t offset;    ///< index of the first azimuth in azims_ and values_
+      size_t count;     ///< number of azimuths in the table
+      double invStep;   ///< inverse of the azimuth spacing (1/rad), 0 if the spacing is irregular
+    };
+
+    /** Converts an azimuth to the range and symmetry used for table lookup */
+    double fixAzimuth_(double azim) const;
+    /** Selects the low and high tables for the normalized elevation; returns false if there are no tables */
+    bool findTables_(double elev, size_t& lo, size_t& hi) const;
+    /** Returns the RCS (sq meters) from a single table at the normalized azimuth */
+    float tableRCS_(const Table& table, double azim) const;
+    /** Returns the RCS (sq meters) for normalized azimuth and elevation */
+    float rcs_(double azim, double elev) const;
+
+    float freq_;                  ///< requested frequency (MHz)
+    PolarityType polarity_;       ///< requested polarity
+    bool symmetric_;              ///< true for RCS_SYM_LUT_TYPE tables
+    float bias_;                  ///< constant added to each RCS value (sq meters)
+    std::vector<float> elevs_;    ///< table elevations (rad), ascending
+    std::vector<Table> tables_;   ///< tables parallel to elevs_
+    std::vector<float> azims_;    ///< azimuths (rad) of all tables, ascending within a table
+    std::vector<float> values_;   ///< RCS values (sq meters) parallel to azims_
+  };
+
   /** @brief Contains static methods for loading RCS data files. */
   class SDKCORE_EXPORT RcsFileParser
   {
@@ -19,6 +19,10 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <iomanip>
 #include <cassert>
@@ -34,9 +38,424 @@
 #include "simCore/Time/Exception.h"
 #include "simCore/Time/String.h"
 
+namespace
+{
+
+/**
+ * Appends text to a fixed-size character buffer, mirroring the std::ostream formatting used by the
+ * built-in formatters' toStream() functions (right-aligned fields padded with '0', fixed precision).
+ * Tracks the full output length even when the buffer is too small.
+ */
+class BufferWriter
+{
+public:
+  BufferWriter(char* buffer, size_t bufferSize)
+    : buffer_(buffer),
+      bufferSize_(bufferSize),
+      length_(0)
+  {
+  }
+
+  /** Appends the characters, padded on the left with '0' to the given width */
+  void append(const char* text, size_t textLength, size_t width=0)
+  {
+    for (size_t k = textLength; k < width; ++k)
+      put_('0');
+    for (size_t k = 0; k < textLength; ++k)
+      put_(text[k]);
+  }
+
+  /** Appends a null terminated string */
+  void append(const char* text)
+  {
+    append(text, strlen(text));
+  }
+
+  /** Appends an integer, padded on the left with '0' to the given width */
+  void appendInt(int value, size_t width=0)
+  {
+    char text[16];
+    const int len = sprintf(text, "%d", value);
+    append(text, static_cast<size_t>(len), width);
+  }
+
+  /** Appends a fixed point value with the given precision, padded on the left with '0' to the given width */
+  void appendFixed(double value, unsigned short precision, size_t width=0)
+  {
+    // Seconds values are bounded by an int, so 32 characters covers sign, integer digits, and decimal point
+    const size_t maxLength = 32 + precision;
+    char local[64];
+    std::vector<char> large;
+    char* text = local;
+    if (maxLength > sizeof(local))
+    {
+      large.resize(maxLength);
+      text = &large[0];
+    }
+    const int len = sprintf(text, "%.*f", static_cast<int>(precision), value);
+    append(text, static_cast<size_t>(len), width);
+  }
+
+  /** Null terminates the buffer and returns the full length of the output */
+  size_t finish()
+  {
+    if (bufferSize_ > 0)
+      buffer_[(length_ < bufferSize_) ? length_ : bufferSize_ - 1] = '\0';
+    return length_;
+  }
+
+private:
+  void put_(char c)
+  {
+    if (length_ + 1 < bufferSize_)
+      buffer_[length_] = c;
+    ++length_;
+  }
+
+  char* buffer_;
+  size_t bufferSize_;
+  size_t length_;
+};
+
+/** Writes a minutes value the same way as MinutesTimeFormatter::toStream(), with the minutes padded to minutesWidth */
+void writeMinutes(BufferWriter& writer, simCore::Seconds seconds, unsigned short precision, size_t minutesWidth)
+{
+  seconds = seconds.rounded(precision);
+  int minutes = static_cast<int>(seconds.Double() / 60.0);
+  seconds -= minutes * 60.0;
+  const size_t numSpaces = precision + (precision == 0 ? 0 : 1);
+  writer.appendInt(minutes, minutesWidth);
+  writer.append(":", 1);
+  writer.appendFixed(seconds.Double(), precision, 2 + numSpaces);
+}
+
+/** Writes an hours value the same way as HoursTimeFormatter::toStream(), with the hours padded to hoursWidth */
+void writeHours(BufferWriter& writer, simCore::Seconds seconds, unsigned short precision, size_t hoursWidth)
+{
+  seconds = seconds.rounded(precision);
+  int hours = static_cast<int>(seconds.Double() / 3600.0);
+  seconds -= hours * 3600.0;
+  writer.appendInt(hours, hoursWidth);
+  writer.append(":", 1);
+  writeMinutes(writer, seconds, precision, 2);
+}
+
+/** Writes an ordinal value the same way as OrdinalTimeFormatter::toStream() */
+void writeOrdinal(BufferWriter& writer, const simCore::TimeStamp& timeStamp, unsigned short precision)
+{
+  const int refYear = timeStamp.referenceYear();
+  const simCore::TimeStamp roundedStamp(refYear, timeStamp.secondsSinceRefYear(refYear).rounded(precision));
+  int days = static_cast<int>(roundedStamp.secondsSinceRefYear().Double() / simCore::SECPERDAY);
+  simCore::Seconds seconds = roundedStamp.secondsSinceRefYear() - simCore::Seconds(static_cast<double>(days) * simCore::SECPERDAY);
+  writer.appendInt(days + 1, 3);
+  writer.append(" ", 1);
+  writer.appendInt(refYear);
+  writer.append(" ", 1);
+  writeHours(writer, seconds, precision, 2);
+}
+
+/** Returns the output of a built-in formatter's toBuffer() as a string */
+std::string bufferToString(const simCore::TimeFormatter& formatter, const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision)
+{
+  char local[64];
+  const size_t length = formatter.toBuffer(timeStamp, referenceYear, precision, local, sizeof(local));
+  if (length < sizeof(local))
+    return std::string(local, length);
+  std::vector<char> large(length + 1);
+  formatter.toBuffer(timeStamp, referenceYear, precision, &large[0], large.size());
+  return std::string(&large[0], length);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/** Cursor over one token of a time string for the single-pass parser */
+struct ParseCursor
+{
+  const char* pos;
+  const char* end;
+
+  /** Returns true if the whole token has been read */
+  bool done() const { return pos == end; }
+};
+
+inline bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/** Reads between minDigits and maxDigits decimal digits; fails if more digits follow */
+bool readDigits(ParseCursor& cursor, size_t minDigits, size_t maxDigits, int& value)
+{
+  value = 0;
+  size_t count = 0;
+  while (cursor.pos != cursor.end && isDigit(*cursor.pos))
+  {
+    if (++count > maxDigits)
+      return false;
+    value = value * 10 + (*cursor.pos - '0');
+    ++cursor.pos;
+  }
+  return count >= minDigits;
+}
+
+/** Reads the given character */
+bool readChar(ParseCursor& cursor, char c)
+{
+  if (cursor.pos == cursor.end || *cursor.pos != c)
+    return false;
+  ++cursor.pos;
+  return true;
+}
+
+/** Reads a number of the form "D[DDD][.sss]" with a limited number of leading digits, converting it with strtod() */
+bool readDecimal(ParseCursor& cursor, size_t minDigits, size_t maxDigits, double& value)
+{
+  const char* start = cursor.pos;
+  while (cursor.pos != cursor.end && isDigit(*cursor.pos))
+    ++cursor.pos;
+  const size_t numDigits = static_cast<size_t>(cursor.pos - start);
+  if (numDigits < minDigits || numDigits > maxDigits)
+    return false;
+  if (readChar(cursor, '.'))
+  {
+    while (cursor.pos != cursor.end && isDigit(*cursor.pos))
+      ++cursor.pos;
+  }
+  // Copy to a null terminated buffer for strtod(); very long values fall back to the tokenizing parsers
+  char text[64];
+  const size_t length = static_cast<size_t>(cursor.pos - start);
+  if (length >= sizeof(text))
+    return false;
+  memcpy(text, start, length);
+  text[length] = '\0';
+  value = strtod(text, NULL);
+  return true;
+}
+
+/**
+ * Reads a strict seconds value of the form "S[S][.sss]" that is less than 60, matching
+ * SecondsTimeFormatter::isStrictSecondsString().  The value is converted with strtod() to
+ * match the conversion of the tokenizing parsers exactly.
+ */
+bool readStrictSeconds(ParseCursor& cursor, size_t minDigits, double& seconds)
+{
+  return readDecimal(cursor, minDigits, 2, seconds) && seconds < 60.0;
+}
+
+/** Reads a strict "H[H]:M[M]:S[S][.sss]" string, as per HoursTimeFormatter::isStrictHoursString(), into seconds */
+bool readStrictHours(ParseCursor& cursor, simCore::Seconds& seconds)
+{
+  int hours;
+  int minutes;
+  double sec;
+  if (!readDigits(cursor, 1, 2, hours) || hours >= 24 || !readChar(cursor, ':') ||
+    !readDigits(cursor, 1, 2, minutes) || minutes >= 60 || !readChar(cursor, ':') ||
+    !readStrictSeconds(cursor, 1, sec))
+    return false;
+  // Same arithmetic as HoursTimeFormatter::fromString()
+  seconds = hours * 3600 + minutes * 60 + sec;
+  return true;
+}
+
+/** Reads a three letter month abbreviation, returning [0,11] or -1 */
+int readMonth(ParseCursor& cursor)
+{
+  if (cursor.end - cursor.pos < 3)
+    return -1;
+  const int month = simCore::MonthDayTimeFormatter::monthStringToInt(std::string(cursor.pos, 3));
+  if (month >= 0)
+    cursor.pos += 3;
+  return month;
+}
+
+/** Parses seconds, minutes, and hours strings, which are relative to the reference year */
+bool parseRelative(ParseCursor cursor, simCore::TimeStamp& timeStamp, int referenceYear)
+{
+  const size_t numColons = std::count(cursor.pos, cursor.end, ':');
+  if (numColons == 0)
+  {
+    double seconds;
+    if (!readDecimal(cursor, 1, 9, seconds) || !cursor.done())
+      return false;
+    timeStamp = simCore::TimeStamp(referenceYear, seconds);
+    return true;
+  }
+
+  // Limit leading digits so that the integer arithmetic below cannot overflow
+  int first;
+  if (!readDigits(cursor, 1, 7, first) || !readChar(cursor, ':') || (numColons > 1 && first > 99999))
+    return false;
+  if (numColons == 1)
+  {
+    double seconds;
+    if (!readStrictSeconds(cursor, 1, seconds) || !cursor.done())
+      return false;
+    // Same arithmetic as MinutesTimeFormatter::fromString()
+    timeStamp = simCore::TimeStamp(referenceYear, first * 60 + seconds);
+    return true;
+  }
+
+  int minutes;
+  double sec;
+  if (numColons != 2 || !readDigits(cursor, 1, 2, minutes) || minutes >= 60 || !readChar(cursor, ':') ||
+    !readStrictSeconds(cursor, 1, sec) || !cursor.done())
+    return false;
+  // Same arithmetic as HoursTimeFormatter::fromString()
+  const simCore::Seconds seconds = first * 3600 + minutes * 60 + sec;
+  timeStamp = simCore::TimeStamp(referenceYear, seconds);
+  return true;
+}
+
+/** Parses "DDD YYYY HH:MM:SS[.sss]" */
+bool parseOrdinal(ParseCursor dayToken, ParseCursor yearToken, ParseCursor hoursToken, simCore::TimeStamp& timeStamp)
+{
+  int day;
+  int year;
+  simCore::Seconds seconds;
+  if (!readDigits(dayToken, 1, 3, day) || !dayToken.done() ||
+    !readDigits(yearToken, 4, 4, year) || !yearToken.done() || year <= 1900 ||
+    !readStrictHours(hoursToken, seconds) || !hoursToken.done())
+    return false;
+  try
+  {
+    if (day < 1 || day > simCore::daysPerYear(year - 1900))
+      return false;
+  }
+  catch (const simCore::TimeException&)
+  {
+    return false;
+  }
+  timeStamp = simCore::TimeStamp(year, seconds + simCore::Seconds((day - 1) * 86400));
+  return true;
+}
+
+/** Parses "MON MD YYYY HH:MM:SS[.sss]" */
+bool parseMonthDay(ParseCursor monthToken, ParseCursor dayToken, ParseCursor yearToken, ParseCursor hoursToken, simCore::TimeStamp& timeStamp)
+{
+  int monthDay;
+  int year;
+  simCore::Seconds seconds;
+  const int month = readMonth(monthToken);
+  if (month < 0 || !monthToken.done() ||
+    !readDigits(dayToken, 1, 2, monthDay) || !dayToken.done() || monthDay < 1 ||
+    !readDigits(yearToken, 4, 4, year) || !yearToken.done() || year < 1900 ||
+    !readStrictHours(hoursToken, seconds) || !hoursToken.done())
+    return false;
+  try
+  {
+    if (monthDay > simCore::daysPerMonth(year - 1900, month))
+      return false;
+    const int yearDay = simCore::getYearDay(month, monthDay, year - 1900);
+    timeStamp = simCore::TimeStamp(year, seconds + simCore::Seconds(yearDay * 86400));
+    return true;
+  }
+  catch (const simCore::TimeException&)
+  {
+  }
+  return false;
+}
+
+/** Parses "DDHHMM:SS[.sss] Z MONYY" */
+bool parseDtg(ParseCursor timesToken, ParseCursor monthToken, simCore::TimeStamp& timeStamp)
+{
+  int ddhhmm;
+  double seconds;
+  int year;
+  const int month = readMonth(monthToken);
+  if (month < 0 || !readDigits(monthToken, 2, 2, year) || !monthToken.done() ||
+    !readDigits(timesToken, 6, 6, ddhhmm) || !readChar(timesToken, ':') ||
+    !readStrictSeconds(timesToken, 2, seconds) || !timesToken.done())
+    return false;
+  const int monthDay = ddhhmm / 10000;
+  const int hours = (ddhhmm / 100) % 100;
+  const int minutes = ddhhmm % 100;
+  year += (year >= 70) ? 1900 : 2000; // Valid from 1970 to 2069
+  if (monthDay < 1 || hours >= 24 || minutes >= 60)
+    return false;
+  try
+  {
+    if (monthDay > simCore::daysPerMonth(year - 1900, month))
+      return false;
+    const int yearDay = simCore::getYearDay(month, monthDay, year - 1900);
+    // Same arithmetic as DtgTimeFormatter::fromString()
+    timeStamp = simCore::TimeStamp(year, yearDay * 86400 + hours * 3600 + minutes * 60 + seconds);
+    return true;
+  }
+  catch (const simCore::TimeException&)
+  {
+  }
+  return false;
+}
+
+/**
+ * Single-pass parser for strings in the canonical form of the built-in formats.  Identifies the
+ * format from the token layout and decodes it without allocating.  Returns false for anything it
+ * does not recognize, in which case the caller falls back to the tokenizing formatters.  Only
+ * strings that the built-in formatters would also accept are decoded, and since the canonical
+ * layouts do not overlap, the result does not depend on formatter priority.
+ */
+bool parseBuiltIn(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear)
+{
+  const size_t first = timeString.find_first_not_of(simCore::STR_WHITE_SPACE_CHARS);
+  if (first == std::string::npos)
+    return false;
+  const size_t last = timeString.find_last_not_of(simCore::STR_WHITE_SPACE_CHARS);
+  const char* pos = timeString.data() + first;
+  const char* end = timeString.data() + last + 1;
+
+  // Split on spaces; quoted strings and other white space are left to the tokenizing parsers
+  static const size_t MAX_TOKENS = 4;
+  ParseCursor tokens[MAX_TOKENS];
+  size_t numTokens = 0;
+  while (pos != end)
+  {
+    if (numTokens == MAX_TOKENS)
+      return false;
+    ParseCursor& token = tokens[numTokens++];
+    token.pos = pos;
+    while (pos != end && *pos != ' ')
+    {
+      if (*pos == '"' || *pos == '\t' || *pos == '\r' || *pos == '\n')
+        return false;
+      ++pos;
+    }
+    token.end = pos;
+    while (pos != end && *pos == ' ')
+      ++pos;
+  }
+
+  switch (numTokens)
+  {
+  case 1:
+    return parseRelative(tokens[0], timeStamp, referenceYear);
+  case 3:
+    if (tokens[1].end - tokens[1].pos == 1 && *tokens[1].pos == 'Z')
+      return parseDtg(tokens[0], tokens[2], timeStamp);
+    return parseOrdinal(tokens[0], tokens[1], tokens[2], timeStamp);
+  case 4:
+    return parseMonthDay(tokens[0], tokens[1], tokens[2], tokens[3], timeStamp);
+  default:
+    break;
+  }
+  return false;
+}
+
+}
+
 namespace simCore
 {
 
+size_t TimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  const std::string str = toString(timeStamp, referenceYear, precision);
+  BufferWriter writer(buffer, bufferSize);
+  writer.append(str.c_str(), str.size());
+  return writer.finish();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+
 std::string NullTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
   std::stringstream ss;
@@ -60,9 +479,14 @@ int NullTimeFormatter::fromString(const std::string& timeString, simCore::TimeSt
 
 std::string SecondsTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
-  std::stringstream ss;
-  SecondsTimeFormatter::toStream(ss, timeStamp.secondsSinceRefYear(referenceYear), precision);
-  return ss.str();
+  return bufferToString(*this, timeStamp, referenceYear, precision);
+}
+
+size_t SecondsTimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  BufferWriter writer(buffer, bufferSize);
+  writer.appendFixed(timeStamp.secondsSinceRefYear(referenceYear).Double(), precision);
+  return writer.finish();
 }
 
 bool SecondsTimeFormatter::canConvert(const std::string& timeString) const
@@ -101,9 +525,14 @@ bool SecondsTimeFormatter::isStrictSecondsString(const std::string& timeString)
 
 std::string MinutesTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
-  std::stringstream ss;
-  MinutesTimeFormatter::toStream(ss, timeStamp.secondsSinceRefYear(referenceYear), precision);
-  return ss.str();
+  return bufferToString(*this, timeStamp, referenceYear, precision);
+}
+
+size_t MinutesTimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  BufferWriter writer(buffer, bufferSize);
+  writeMinutes(writer, timeStamp.secondsSinceRefYear(referenceYear), precision, 0);
+  return writer.finish();
 }
 
 bool MinutesTimeFormatter::canConvert(const std::string& timeString) const
@@ -163,9 +592,14 @@ bool MinutesTimeFormatter::isStrictMinutesString(const std::string& timeString)
 
 std::string HoursTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
-  std::stringstream ss;
-  HoursTimeFormatter::toStream(ss, timeStamp.secondsSinceRefYear(referenceYear), precision);
-  return ss.str();
+  return bufferToString(*this, timeStamp, referenceYear, precision);
+}
+
+size_t HoursTimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  BufferWriter writer(buffer, bufferSize);
+  writeHours(writer, timeStamp.secondsSinceRefYear(referenceYear), precision, 0);
+  return writer.finish();
 }
 
 bool HoursTimeFormatter::canConvert(const std::string& timeString) const
@@ -244,9 +678,14 @@ bool HoursTimeFormatter::isStrictHoursString(const std::string& timeString)
 
 std::string OrdinalTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
-  std::stringstream ss;
-  OrdinalTimeFormatter::toStream(ss, timeStamp, precision);
-  return ss.str();
+  return bufferToString(*this, timeStamp, referenceYear, precision);
+}
+
+size_t OrdinalTimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  BufferWriter writer(buffer, bufferSize);
+  writeOrdinal(writer, timeStamp, precision);
+  return writer.finish();
 }
 
 bool OrdinalTimeFormatter::canConvert(const std::string& timeString) const
@@ -334,7 +773,12 @@ bool OrdinalTimeFormatter::isValidOrdinal(const std::string& input, int year, in
 
 std::string MonthDayTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
-  std::stringstream ss;
+  return bufferToString(*this, timeStamp, referenceYear, precision);
+}
+
+size_t MonthDayTimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  BufferWriter writer(buffer, bufferSize);
   const int refYear = timeStamp.referenceYear();
   const simCore::TimeStamp roundedStamp(refYear, timeStamp.secondsSinceRefYear(refYear).rounded(precision));
   int month = 0; // Between 0-11
@@ -344,14 +788,19 @@ std::string MonthDayTimeFormatter::toString(const simCore::TimeStamp& timeStamp,
   // Get components: In case of extreme error, fall back to Ordinal, which can't have exception issues
   if (MonthDayTimeFormatter::getMonthComponents(roundedStamp, month, monthDay, seconds) != 0)
   {
-    OrdinalTimeFormatter::toStream(ss, roundedStamp, precision);
-    return ss.str();
+    writeOrdinal(writer, roundedStamp, precision);
+    return writer.finish();
   }
 
   // EG Jan 13 2014 00:01:02.03
-  ss << MonthDayTimeFormatter::monthIntToString(month) << " " << monthDay << " " << refYear << " " << std::setw(2) << std::setfill('0');
-  HoursTimeFormatter::toStream(ss, seconds, precision);
-  return ss.str();
+  writer.append((month >= 0 && month < 12) ? ABBREV_MONTH_NAME[month].c_str() : "Unk");
+  writer.append(" ", 1);
+  writer.appendInt(monthDay);
+  writer.append(" ", 1);
+  writer.appendInt(refYear);
+  writer.append(" ", 1);
+  writeHours(writer, seconds, precision, 2);
+  return writer.finish();
 }
 
 int MonthDayTimeFormatter::monthStringToInt(const std::string& monthString)
@@ -474,7 +923,12 @@ int MonthDayTimeFormatter::fromString(const std::string& timeString, simCore::Ti
 
 std::string DtgTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision) const
 {
-  std::stringstream ss;
+  return bufferToString(*this, timeStamp, referenceYear, precision);
+}
+
+size_t DtgTimeFormatter::toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  BufferWriter writer(buffer, bufferSize);
   const int realYear = timeStamp.referenceYear();
   const simCore::TimeStamp roundedStamp(realYear, timeStamp.secondsSinceRefYear(realYear).rounded(precision));
   int days = static_cast<int>(roundedStamp.secondsSinceRefYear().Double() / simCore::SECPERDAY);
@@ -490,8 +944,8 @@ std::string DtgTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int
     // Should not occur with the massaged simCore::TimeStamp input.
     assert(false);
     // In case of extreme error, fall back to Ordinal, which can't have issues like this
-    OrdinalTimeFormatter::toStream(ss, roundedStamp, precision);
-    return ss.str();
+    writeOrdinal(writer, roundedStamp, precision);
+    return writer.finish();
   }
 
   // Validate the output of getMonthAndDayOfMonth
@@ -499,9 +953,9 @@ std::string DtgTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int
   assert(monthDay >= 1 && monthDay <= 31);
 
   // Avoid any possible out-of-bounds issues
-  std::string monthName = "Unk"; // Unknown
+  const char* monthName = "Unk"; // Unknown
   if (month >= 0 && month < 12)
-    monthName = ABBREV_MONTH_NAME[month];
+    monthName = ABBREV_MONTH_NAME[month].c_str();
 
   simCore::Seconds seconds = roundedStamp.secondsSinceRefYear() - simCore::Seconds(static_cast<double>(days) * simCore::SECPERDAY);
   // Rely on static_cast<> to floor the value
@@ -509,11 +963,13 @@ std::string DtgTimeFormatter::toString(const simCore::TimeStamp& timeStamp, int
   seconds -= hours * 3600; // seconds now holds minutes+seconds past hour
 
   // EG 061435:03.010 Z Apr07
-  ss << std::setw(2) << std::setfill('0') << monthDay
-    << std::setw(2) << hours << std::setw(2);
-  MinutesTimeFormatter::toStream(ss, seconds, precision);
-  ss << " Z " << monthName << std::setw(2) << (realYear % 100);
-  return ss.str();
+  writer.appendInt(monthDay, 2);
+  writer.appendInt(hours, 2);
+  writeMinutes(writer, seconds, precision, 2);
+  writer.append(" Z ", 3);
+  writer.append(monthName);
+  writer.appendInt(realYear % 100, 2);
+  return writer.finish();
 }
 
 bool DtgTimeFormatter::canConvert(const std::string& timeString) const
@@ -611,6 +1067,7 @@ int DtgTimeFormatter::fromString(const std::string& timeString, simCore::TimeSta
 
 TimeFormatterRegistry::TimeFormatterRegistry()
   : nullFormatter_(new NullTimeFormatter),
+    fastParseEnabled_(false),
     lastUsedFormatter_(nullFormatter_)
 {
   knownFormatters_[TIMEFORMAT_SECONDS] = TimeFormatterPtr(new SecondsTimeFormatter);
@@ -626,6 +1083,8 @@ TimeFormatterRegistry::TimeFormatterRegistry()
   registerCustomFormatter(TimeFormatterPtr(new Deprecated::MON_MD_HHMMSS_YYYY_Formatter));
   registerCustomFormatter(TimeFormatterPtr(new Deprecated::WKD_MON_MD_HHMMSS_Formatter));
   registerCustomFormatter(TimeFormatterPtr(new Deprecated::WKD_MON_MD_HHMMSS_YYYY_Formatter));
+  // The deprecated formats do not overlap the canonical built-in layouts, so the fast parser is safe
+  fastParseEnabled_ = true;
 }
 
 TimeFormatterRegistry::~TimeFormatterRegistry()
@@ -635,7 +1094,11 @@ TimeFormatterRegistry::~TimeFormatterRegistry()
 void TimeFormatterRegistry::registerCustomFormatter(TimeFormatterPtr formatter)
 {
   if (formatter != NULL)
+  {
     foreignFormatters_.push_back(formatter);
+    // Custom formatters take priority, so every string must go through formatter()
+    fastParseEnabled_ = false;
+  }
 }
 
 const TimeFormatter& TimeFormatterRegistry::formatter(simCore::TimeFormat format) const
@@ -684,8 +1147,16 @@ std::string TimeFormatterRegistry::toString(simCore::TimeFormat format, const si
   return printer.toString(timeStamp, referenceYear, precision);
 }
 
+size_t TimeFormatterRegistry::toString(simCore::TimeFormat format, const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const
+{
+  const TimeFormatter& printer = formatter(format);
+  return printer.toBuffer(timeStamp, referenceYear, precision, buffer, bufferSize);
+}
+
 int TimeFormatterRegistry::fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const
 {
+  if (fastParseEnabled_ && parseBuiltIn(timeString, timeStamp, referenceYear))
+    return 0;
   const TimeFormatter& parser = formatter(timeString);
   return parser.fromString(timeString, timeStamp, referenceYear);
 }
@@ -60,6 +60,20 @@ public:
    */
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const = 0;
 
+  /**
+   * Converts the time stamp to a string, writing into a caller-supplied buffer.  This avoids the
+   * std::string allocation of toString() for views that format many time values.  The default
+   * implementation copies the output of toString(); built-in formatters write directly.
+   * @param timeStamp Time to print; see toString()
+   * @param referenceYear Epoch reference year; see toString()
+   * @param precision Precision after the decimal place; see toString()
+   * @param buffer Buffer to receive the time string.  Null terminated if bufferSize is non-zero.
+   * @param bufferSize Size of buffer in bytes, including space for the null terminator
+   * @return Length of the full time string, not including the null terminator.  If the return value
+   *   is bufferSize or more, the output was truncated.
+   */
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
+
   /**
    * Returns true if the passed-in time string matches this formatter's style.  This is a check of
    * validity for whether fromString() will be able to successfully convert the time string to a
@@ -101,6 +115,7 @@ class SDKCORE_EXPORT SecondsTimeFormatter : public TimeFormatter
 {
 public:
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
   virtual bool canConvert(const std::string& timeString) const;
   virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const;
 
@@ -115,6 +130,7 @@ class SDKCORE_EXPORT MinutesTimeFormatter : public TimeFormatter
 {
 public:
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
   virtual bool canConvert(const std::string& timeString) const;
   virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const;
 
@@ -129,6 +145,7 @@ class SDKCORE_EXPORT HoursTimeFormatter : public TimeFormatter
 {
 public:
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
   virtual bool canConvert(const std::string& timeString) const;
   virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const;
 
@@ -148,6 +165,7 @@ class SDKCORE_EXPORT OrdinalTimeFormatter : public TimeFormatter
 {
 public:
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
   virtual bool canConvert(const std::string& timeString) const;
   virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const;
 
@@ -172,6 +190,7 @@ class SDKCORE_EXPORT MonthDayTimeFormatter : public TimeFormatter
 {
 public:
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
   virtual bool canConvert(const std::string& timeString) const;
   virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const;
 
@@ -199,6 +218,7 @@ class SDKCORE_EXPORT DtgTimeFormatter : public TimeFormatter
 {
 public:
   virtual std::string toString(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
+  virtual size_t toBuffer(const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
   virtual bool canConvert(const std::string& timeString) const;
   virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const;
 };
@@ -221,7 +241,8 @@ public:
 
   /**
    * Registers a custom formatter with this registry.  Custom formatters are given priority over
-   * built-in formatters in the formatter() and fromString() functions.
+   * built-in formatters in the formatter() and fromString() functions.  Because of that priority,
+   * registering a custom formatter disables the single-pass built-in parser in fromString().
    * @param formatter Custom formatter that abides by the simCore::TimeFormatter interface.
    */
   void registerCustomFormatter(TimeFormatterPtr formatter);
@@ -254,6 +275,20 @@ public:
    */
   std::string toString(simCore::TimeFormat format, const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision=5) const;
 
+  /**
+   * Converts the simCore::TimeStamp to the requested built-in format, writing into a caller-supplied
+   * buffer instead of allocating a string.  Output is identical to that of toString().
+   * @param format Format enumeration that matches up with a built-in formatter.
+   * @param timeStamp Time to print to string.  Should be after the epoch referenceYear.
+   * @param referenceYear Epoch reference year for formats such as Seconds, Minutes, and Hours.
+   * @param precision Precision after the decimal place for components that use decimal output.
+   * @param buffer Buffer to receive the time string.  Null terminated if bufferSize is non-zero.
+   * @param bufferSize Size of buffer in bytes, including space for the null terminator
+   * @return Length of the full time string, not including the null terminator.  If the return value
+   *   is bufferSize or more, the output was truncated.
+   */
+  size_t toString(simCore::TimeFormat format, const simCore::TimeStamp& timeStamp, int referenceYear, unsigned short precision, char* buffer, size_t bufferSize) const;
+
   /**
    * Determines the best matching formatter and uses it to convert a time string to a time stamp.  The
    * formatter() function determines the proper simCore::TimeFormatter to use for parsing the time
@@ -261,6 +296,9 @@ public:
    * Minutes require a reference year to properly decode the time string into a simCore::TimeStamp
    * structure.  If the formatter is unable to convert the string, a non-zero error will be set in the
    * return value.
+   *
+   * Strings in the canonical form of a built-in format are decoded in a single pass without tokenizing,
+   * as long as no custom formatters have been registered.  Other strings fall back to formatter().
    * @param timeString Time string to convert to a simCore::TimeStamp
    * @param timeStamp Value to fill with the interpreted time.  If there is an error in conversion,
    *   this value is reset to simCore::TimeStamp(1970, 0).
@@ -279,6 +317,8 @@ private:
   std::vector<TimeFormatterPtr> foreignFormatters_;
   /** Saves a NullFormatter for null object pattern use. */
   TimeFormatterPtr nullFormatter_;
+  /** True when only the default formatters are registered, allowing the single-pass parser */
+  bool fastParseEnabled_;
 
   /** Cache the most recent formatter to leverage locality principle in format conversion */
   mutable TimeFormatterPtr lastUsedFormatter_;
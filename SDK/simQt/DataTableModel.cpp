@@ -19,6 +19,8 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <cstdlib>
 #include <limits>
 #include "simCore/Calc/Math.h"
 #include "DataTableModel.h"
@@ -34,6 +36,12 @@ static const int ROWLOADINCREMENT = 50;
 // Increment for time values
 static const double EPSILON = 1e-7;
 
+// Cell position of a row that has no value in a column
+static const int MISSING_CELL = -1;
+
+// Farthest a column cursor steps before searching the column by time instead
+static const int MAX_CURSOR_STEPS = 64;
+
 /// Visits all columns of a table and populates a QList with column ptrs
 class ColumnTimeValueAccumulator : public simData::DataTable::ColumnVisitor
 {
@@ -56,16 +64,55 @@ private:
   QList<const simData::TableColumn*> columns_; ///< all the TableColumn ptrs
 };
 
+/// Collects the model column index of each cell in a row
+class CellColumnAccumulator : public simData::TableRow::CellVisitor
+{
+public:
+  /** Constructor */
+  CellColumnAccumulator(const std::map<simData::TableColumnId, int>& columnIndices, std::vector<int>& columns)
+    : columnIndices_(columnIndices),
+      columns_(columns)
+  {
+  }
+
+  virtual void visit(simData::TableColumnId columnId, uint8_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, int8_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, uint16_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, int16_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, uint32_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, int32_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, uint64_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, int64_t value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, float value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, double value) { add_(columnId); }
+  virtual void visit(simData::TableColumnId columnId, const std::string& value) { add_(columnId); }
+
+private:
+  void add_(simData::TableColumnId columnId)
+  {
+    std::map<simData::TableColumnId, int>::const_iterator i = columnIndices_.find(columnId);
+    if (i != columnIndices_.end())
+      columns_.push_back(i->second);
+  }
+
+  const std::map<simData::TableColumnId, int>& columnIndices_;
+  std::vector<int>& columns_;
+};
+
 /**
-* Visits all rows in a table, populates the QList with the row time values, starting at first row visited until
-* it has visited the number of rows specified by numRows
+* Visits all rows in a table, populates the QList with the row time values, and records the position
+* of each row's cell in each column
 */
 class RowValueAccumulator : public simData::DataTable::RowVisitor
 {
 public:
   /** Constructor */
-  explicit RowValueAccumulator(QList<double>& rows)
-    : rows_(rows)
+  RowValueAccumulator(QList<double>& rows, const std::map<simData::TableColumnId, int>& columnIndices,
+    std::vector<std::vector<int> >& cellPositions)
+    : rows_(rows),
+      columnIndices_(columnIndices),
+      cellPositions_(cellPositions),
+      counts_(cellPositions.size(), 0)
   {
   }
 
@@ -73,34 +120,151 @@ public:
   {
     // add rows in the order they exist in the table, will be time ordered
     rows_.push_back(row.time());
+
+    // cells arrive in time order, so the position of a cell is the number of earlier cells in its column
+    for (size_t k = 1; k < cellPositions_.size(); ++k)
+      cellPositions_[k].push_back(MISSING_CELL);
+    cells_.clear();
+    CellColumnAccumulator cellColumns(columnIndices_, cells_);
+    row.accept(cellColumns);
+    for (std::vector<int>::const_iterator i = cells_.begin(); i != cells_.end(); ++i)
+      cellPositions_[*i].back() = counts_[*i]++;
     return simData::DataTable::RowVisitor::VISIT_CONTINUE;
   }
 
 private:
   QList<double>& rows_; ///< all the row time values
+  const std::map<simData::TableColumnId, int>& columnIndices_; ///< model column index of each column ID
+  std::vector<std::vector<int> >& cellPositions_; ///< cell positions of each column
+  std::vector<int> counts_; ///< number of cells seen in each column
+  std::vector<int> cells_; ///< columns of the current row's cells
+};
+
+/** Strict ordering of extracted values */
+template <typename T>
+bool lessThan(const T& lhs, const T& rhs)
+{
+  return lhs < rhs;
+}
+
+/** Strict ordering of doubles; NaN sorts before all other values */
+static bool lessThan(double lhs, double rhs)
+{
+  if (std::isnan(rhs))
+    return false;
+  return std::isnan(lhs) || lhs < rhs;
+}
+
+/** Orders indices into a buffer of extracted column values */
+template <typename T>
+class ExtractedValueLess
+{
+public:
+  /** Constructor */
+  ExtractedValueLess(const std::vector<T>& values, bool descending)
+    : values_(values),
+      descending_(descending)
+  {
+  }
+
+  bool operator()(int lhs, int rhs) const
+  {
+    return descending_ ? lessThan(values_[rhs], values_[lhs]) : lessThan(values_[lhs], values_[rhs]);
+  }
+
+private:
+  const std::vector<T>& values_;
+  bool descending_;
+};
+
+/** Moves each kept entry of a container to its new index, which never exceeds its old one, and drops the rest */
+template <typename Container>
+void compact(Container& values, const std::vector<int>& newIndices, int newSize)
+{
+  for (size_t k = 0; k < newIndices.size(); ++k)
+  {
+    if (newIndices[k] >= 0)
+      values[newIndices[k]] = values[static_cast<int>(k)];
+  }
+  values.erase(values.begin() + newSize, values.end());
+}
+
+/// Iterator into a column and the position of the cell at its peekNext()
+class DataTableModel::ColumnCursor
+{
+public:
+  /** Constructor */
+  ColumnCursor(const simData::TableColumn::Iterator& iter, int position)
+    : iter_(iter),
+      position_(position)
+  {
+  }
+
+  simData::TableColumn::Iterator iter_; ///< peekNext() is the cell at position_
+  int position_; ///< position of the cell in the column
+};
+
+/// Keeps the model's rows and cell positions up to date with the data table
+class DataTableModel::DataTableObserver : public simData::DataTable::TableObserver
+{
+public:
+  /** Constructor */
+  explicit DataTableObserver(DataTableModel& parent)
+    : parent_(parent)
+  {
+  }
+
+  virtual void onAddColumn(simData::DataTable& table, const simData::TableColumn& column)
+  {
+    parent_.addColumn_(column);
+  }
+
+  virtual void onAddRow(simData::DataTable& table, const simData::TableRow& row)
+  {
+    parent_.addRow_(row);
+  }
+
+  virtual void onPreRemoveColumn(simData::DataTable& table, const simData::TableColumn& column)
+  {
+    parent_.removeColumn_(column);
+  }
+
+  virtual void onPreRemoveRow(simData::DataTable& table, double rowTime)
+  {
+    parent_.removeRow_(rowTime);
+  }
+
+private:
+  DataTableModel& parent_;
 };
 
 //----------------------------------------------------------------------------
 DataTableModel::DataTableModel(QObject *parent, simData::DataTable* dataTable)
 :QAbstractItemModel(parent),
-dataTable_(NULL)
+dataTable_(NULL),
+sorted_(false)
 {
+  observer_.reset(new DataTableObserver(*this));
   setDataTable(dataTable);
 }
 
 DataTableModel::~DataTableModel()
 {
+  if (dataTable_ != NULL)
+    dataTable_->removeObserver(observer_);
+  clearCursors_();
 }
 
 QVariant DataTableModel::data(const QModelIndex &index, int role) const
 {
   if (!index.isValid() || dataTable_ == NULL)
     return QVariant();
-  if (!(columns_.size() > index.column()) || !(rows_.size() > index.row()))
+  if (!(columns_.size() > index.column()) || !(rowCount() > index.row()))
     return QVariant();
 
   // what time are we looking for
-  const double time = rows_.at(index.row());
+  const int row = storageRow_(index.row());
+  const double time = rows_.at(row);
 
   if (role == Qt::DisplayRole)
   {
@@ -108,20 +272,18 @@ QVariant DataTableModel::data(const QModelIndex &index, int role) const
     if (index.column() == 0)
     {
       // TODO: format time string here
-      QString timeString = QString("%1").arg(time, 0, 'f', 3);
+      QString& timeString = timeStrings_[row];
+      if (timeString.isEmpty())
+        timeString = QString::number(time, 'f', 3);
       return QVariant(timeString);
     }
 
-    const simData::TableColumn* col = columns_[index.column()];
-    simData::TableColumn::Iterator cell = col->findAtOrBeforeTime(time);
-    if (!cell.hasNext())
-      return EMPTY_CELL;
-
     // return NULL if we found no data at this time
-    if (cell.peekNext()->time() != time)
+    const simData::TableColumn::IteratorDataPtr cell = cell_(index.column(), row);
+    if (!cell)
       return EMPTY_CELL;
 
-    return cellDisplayValue_(col->variableType(), cell);
+    return cellDisplayValue_(columns_[index.column()]->variableType(), *cell);
   }
 
   if (role == SortRole)
@@ -132,16 +294,12 @@ QVariant DataTableModel::data(const QModelIndex &index, int role) const
       return QVariant(time);
     }
 
-    const simData::TableColumn* col = columns_[index.column()];
-    simData::TableColumn::Iterator cell = col->findAtOrBeforeTime(time);
-    if (!cell.hasNext())
-      return EMPTY_CELL;
-
     // return NULL if we found no data at this time
-    if (cell.peekNext()->time() != time)
+    const simData::TableColumn::IteratorDataPtr cell = cell_(index.column(), row);
+    if (!cell)
       return EMPTY_CELL;
 
-    return cellSortValue_(col->variableType(), cell);
+    return cellSortValue_(columns_[index.column()]->variableType(), *cell);
   }
 
   if (role == Qt::TextAlignmentRole)
@@ -149,14 +307,12 @@ QVariant DataTableModel::data(const QModelIndex &index, int role) const
     // column 0 is time string, left align
     if (index.column() == 0)
       return Qt::AlignLeft;
-    const simData::TableColumn* col = columns_[index.column()];
-    simData::TableColumn::Iterator cell = col->findAtOrBeforeTime(time);
     // this is a NULL block, left align
-    if (cell.next()->time() != time)
+    if (cellPositions_[index.column()][row] == MISSING_CELL)
       return Qt::AlignLeft;
 
     // Strings should be left align
-    if (col->variableType() == simData::VT_STRING)
+    if (columns_[index.column()]->variableType() == simData::VT_STRING)
       return Qt::AlignLeft;
 
     // everything else is right aligned
@@ -190,7 +346,7 @@ QModelIndex DataTableModel::index(int row, int column, const QModelIndex &parent
 {
   // return invalid index if we don't have this row/column
   if (parent != QModelIndex() || row < 0 || column < 0 ||
-      row >= static_cast<int>(rows_.size()) || column >= static_cast<int>(columns_.size()))
+      row >= rowCount() || column >= static_cast<int>(columns_.size()))
     return QModelIndex();
 
   // no hierarchy in the model, just return an index with the specified row/column
@@ -210,13 +366,108 @@ int DataTableModel::columnCount(const QModelIndex & parent) const
 
 int DataTableModel::rowCount(const QModelIndex & parent) const
 {
-  return parent == QModelIndex() ? rows_.size() : 0;
+  if (parent != QModelIndex())
+    return 0;
+  // while sorted, rows being removed leave rows_ only after the model has removed them
+  return sorted_ ? static_cast<int>(sortedRows_.size()) : rows_.size();
+}
+
+void DataTableModel::sort(int column, Qt::SortOrder order)
+{
+  if (column < 0 || column >= columns_.size() || rows_.empty())
+    return;
+
+  emit layoutAboutToBeChanged();
+  // remember where persistent indices point before reordering
+  const QModelIndexList oldIndices = persistentIndexList();
+  std::vector<int> oldRows;
+  for (QModelIndexList::const_iterator i = oldIndices.begin(); i != oldIndices.end(); ++i)
+    oldRows.push_back(storageRow_(i->row()));
+
+  std::vector<int> rows;
+  if (column == 0)
+  {
+    // rows_ is already in time order
+    if (order == Qt::DescendingOrder)
+    {
+      for (int k = rows_.size() - 1; k >= 0; --k)
+        rows.push_back(k);
+    }
+  }
+  else
+  {
+    switch (columns_[column]->variableType())
+    {
+    case simData::VT_UINT64:
+      sortByValue_<uint64_t>(column, order, rows);
+      break;
+    case simData::VT_INT64:
+      sortByValue_<int64_t>(column, order, rows);
+      break;
+    case simData::VT_STRING:
+      sortByValue_<std::string>(column, order, rows);
+      break;
+    default:
+      // doubles hold all other types exactly
+      sortByValue_<double>(column, order, rows);
+      break;
+    }
+  }
+  sortedRows_.swap(rows);
+  sorted_ = !sortedRows_.empty();
+  modelRows_.assign(sortedRows_.size(), 0);
+  for (size_t k = 0; k < sortedRows_.size(); ++k)
+    modelRows_[sortedRows_[k]] = static_cast<int>(k);
+
+  QModelIndexList newIndices;
+  for (int k = 0; k < oldIndices.size(); ++k)
+    newIndices.push_back(createIndex(modelRow_(oldRows[k]), oldIndices[k].column()));
+  changePersistentIndexList(oldIndices, newIndices);
+  emit layoutChanged();
+}
+
+template <typename T>
+void DataTableModel::sortByValue_(int column, Qt::SortOrder order, std::vector<int>& rows) const
+{
+  // extract the column into a contiguous buffer; rows_ is visited in time order so the cursor
+  // steps from each cell to the next
+  std::vector<T> values(rows_.size());
+  std::vector<int> present;
+  std::vector<int> missing;
+  present.reserve(rows_.size());
+  for (int k = 0; k < rows_.size(); ++k)
+  {
+    const simData::TableColumn::IteratorDataPtr cell = cell_(column, k);
+    if (cell)
+    {
+      cell->getValue(values[k]);
+      present.push_back(k);
+    }
+    else
+      missing.push_back(k);
+  }
+
+  // stable sort keeps equal values in time order
+  const bool descending = (order == Qt::DescendingOrder);
+  std::stable_sort(present.begin(), present.end(), ExtractedValueLess<T>(values, descending));
+  rows.clear();
+  rows.reserve(rows_.size());
+  if (descending)
+  {
+    rows.insert(rows.end(), present.begin(), present.end());
+    rows.insert(rows.end(), missing.begin(), missing.end());
+  }
+  else
+  {
+    rows.insert(rows.end(), missing.begin(), missing.end());
+    rows.insert(rows.end(), present.begin(), present.end());
+  }
 }
 
 double DataTableModel::getTime(const QModelIndex& index) const
 {
-  if (rows_.size() > index.row())
-    return rows_.at(index.row());
+  if (index.row() >= 0 && rowCount() > index.row())
+    return rows_.at(storageRow_(index.row()));
   return INVALID_TIME;
 }
 
@@ -225,8 +476,19 @@ void DataTableModel::setDataTable(simData::DataTable* dataTable)
   // clear out our local references to the DataTable
   // TODO: See SIMSDK-402: This function needs some TLC ASAP
   beginResetModel();
+  if (dataTable_ != NULL)
+    dataTable_->removeObserver(observer_);
+  clearCursors_();
   columns_.clear();
   rows_.clear();
+  cellPositions_.clear();
+  columnIndices_.clear();
+  sorted_ = false;
+  sortedRows_.clear();
+  modelRows_.clear();
+  timeStrings_.clear();
+  cursors_.clear();
+  removedTimes_.clear();
 
   dataTable_ = dataTable;
 
@@ -237,6 +499,9 @@ void DataTableModel::setDataTable(simData::DataTable* dataTable)
     return;
   }
 
+  // keep rows and columns up to date as the table changes
+  dataTable_->addObserver(observer_);
+
   // update rows/columns
 
   // fill in columns vector
@@ -245,7 +510,10 @@ void DataTableModel::setDataTable(simData::DataTable* dataTable)
   dataTable_->accept(cv);
   // empty table, nothing more to do
   if (cv.columns().empty())
+  {
+    endResetModel();
     return;
+  }
 
   // use size() instead of size() - 1 because of the time column
   const int lastColIndex = cv.columns().size();
@@ -253,10 +521,15 @@ void DataTableModel::setDataTable(simData::DataTable* dataTable)
   columns_.push_back(NULL); // time column
   columns_ += cv.columns();
   endInsertColumns();
+  for (int k = 1; k < columns_.size(); ++k)
+    columnIndices_[columns_[k]->columnId()] = k;
+  cellPositions_.resize(columns_.size());
+  cursors_.resize(columns_.size(), NULL);
 
   // Add rows
-  RowValueAccumulator rvc(rows_);
+  RowValueAccumulator rvc(rows_, columnIndices_, cellPositions_);
   dataTable_->accept(0, std::numeric_limits<double>::max(), rvc);
+  timeStrings_.resize(rows_.size());
 
   // force an update now
   endResetModel();
@@ -267,65 +540,62 @@ simData::DataTable* DataTableModel::dataTable() const
   return dataTable_;
 }
 
-QVariant DataTableModel::cellDisplayValue_(simData::VariableType type, simData::TableColumn::Iterator& cell) const
+QVariant DataTableModel::cellDisplayValue_(simData::VariableType type, const simData::TableColumn::IteratorData& cell) const
 {
-  if (!cell.hasNext())
-    return QVariant();
-
   switch (type)
   {
   case simData::VT_UINT8:
     {
       uint8_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val);
     }
   case simData::VT_UINT16:
     {
       uint16_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val);
     }
   case simData::VT_UINT32:
     {
       uint32_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val);
     }
   case simData::VT_UINT64:
     {
       uint64_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(static_cast<unsigned long long>(val));
     }
   case simData::VT_INT8:
     {
       int8_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val);
     }
   case simData::VT_INT16:
     {
       int16_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val);
     }
   case simData::VT_INT32:
     {
       int32_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val);
     }
   case simData::VT_INT64:
     {
       int64_t val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(static_cast<long long>(val));
     }
   case simData::VT_FLOAT:
     {
       float val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
 
       if (std::isnan(val))
         return QVariant(QString::fromStdString("NaN"));
@@ -342,7 +612,7 @@ QVariant DataTableModel::cellDisplayValue_(simData::VariableType type, simData::
   case simData::VT_DOUBLE:
     {
       double val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
 
       if (std::isnan(val))
         return QVariant(QString::fromStdString("NaN"));
@@ -359,7 +629,7 @@ QVariant DataTableModel::cellDisplayValue_(simData::VariableType type, simData::
   case simData::VT_STRING:
     {
       std::string val;
-      cell.next()->getValue(val);
+      cell.getValue(val);
       return QVariant(val.c_str());
     }
   default:
@@ -369,25 +639,302 @@ QVariant DataTableModel::cellDisplayValue_(simData::VariableType type, simData::
   return QVariant();
 }
 
-QVariant DataTableModel::cellSortValue_(simData::VariableType type, simData::TableColumn::Iterator& cell) const
+QVariant DataTableModel::cellSortValue_(simData::VariableType type, const simData::TableColumn::IteratorData& cell) const
 {
-  if (!cell.hasNext())
-    return QVariant();
-
   if (type == simData::VT_FLOAT)
   {
     float val;
-    cell.next()->getValue(val);
+    cell.getValue(val);
     return QVariant(val);
   }
   if (type == simData::VT_DOUBLE)
   {
     double val;
-    cell.next()->getValue(val);
+    cell.getValue(val);
     return QVariant(val);
   }
 
   return cellDisplayValue_(type, cell);
 }
+
+int DataTableModel::storageRow_(int row) const
+{
+  return sorted_ ? sortedRows_[row] : row;
+}
+
+int DataTableModel::modelRow_(int storageRow) const
+{
+  return sorted_ ? modelRows_[storageRow] : storageRow;
+}
+
+simData::TableColumn::IteratorDataPtr DataTableModel::cell_(int column, int storageRow) const
+{
+  const int position = cellPositions_[column][storageRow];
+  if (position == MISSING_CELL)
+    return simData::TableColumn::IteratorDataPtr();
+  const double time = rows_[storageRow];
+
+  // step from the last cell visited when it is close, which is the usual case when painting or sorting
+  ColumnCursor* cursor = cursors_[column];
+  if (cursor != NULL && abs(position - cursor->position_) <= MAX_CURSOR_STEPS)
+  {
+    while (cursor->position_ < position && cursor->iter_.hasNext())
+    {
+      cursor->iter_.next();
+      ++cursor->position_;
+    }
+    while (cursor->position_ > position && cursor->iter_.hasPrevious())
+    {
+      cursor->iter_.previous();
+      --cursor->position_;
+    }
+    if (cursor->position_ == position && cursor->iter_.hasNext())
+    {
+      const simData::TableColumn::IteratorDataPtr cell = cursor->iter_.peekNext();
+      if (cell->time() == time)
+        return cell;
+    }
+  }
+
+  // otherwise search the column; this also recovers when removed cells have shifted positions
+  const simData::TableColumn::Iterator iter = columns_[column]->findAtOrBeforeTime(time);
+  if (cursor == NULL)
+    cursors_[column] = new ColumnCursor(iter, position);
+  else
+  {
+    cursor->iter_ = iter;
+    cursor->position_ = position;
+  }
+  if (!iter.hasNext())
+    return simData::TableColumn::IteratorDataPtr();
+  const simData::TableColumn::IteratorDataPtr cell = iter.peekNext();
+  return (cell->time() == time) ? cell : simData::TableColumn::IteratorDataPtr();
+}
+
+void DataTableModel::clearCursors_()
+{
+  for (std::vector<ColumnCursor*>::iterator i = cursors_.begin(); i != cursors_.end(); ++i)
+  {
+    delete *i;
+    *i = NULL;
+  }
 }
 
+void DataTableModel::addRow_(const simData::TableRow& row)
+{
+  // adding data can invalidate iterators into the table
+  clearCursors_();
+  // initial load skips rows before time 0 as well
+  if (row.time() < 0.0)
+    return;
+  std::vector<int> columns;
+  CellColumnAccumulator cellColumns(columnIndices_, columns);
+  row.accept(cellColumns);
+  if (columns.empty())
+    return;
+
+  const double time = row.time();
+  const int storageRow = static_cast<int>(std::lower_bound(rows_.begin(), rows_.end(), time) - rows_.begin());
+  const bool newRow = (storageRow == rows_.size() || rows_[storageRow] != time);
+  if (newRow)
+  {
+    // rows added while sorted go at the end
+    const int modelRow = sorted_ ? rows_.size() : storageRow;
+    beginInsertRows(QModelIndex(), modelRow, modelRow);
+    if (sorted_)
+    {
+      // only rows after the new one move in storage; none do when appending, the usual case
+      for (int k = storageRow; k < rows_.size(); ++k)
+        ++sortedRows_[modelRows_[k]];
+      modelRows_.insert(modelRows_.begin() + storageRow, modelRow);
+      sortedRows_.push_back(storageRow);
+    }
+    rows_.insert(storageRow, time);
+    timeStrings_.insert(storageRow, QString());
+    for (size_t k = 1; k < cellPositions_.size(); ++k)
+      cellPositions_[k].insert(cellPositions_[k].begin() + storageRow, MISSING_CELL);
+  }
+
+  for (std::vector<int>::const_iterator i = columns.begin(); i != columns.end(); ++i)
+  {
+    std::vector<int>& positions = cellPositions_[*i];
+    // replaced values keep their position
+    if (positions[storageRow] != MISSING_CELL)
+      continue;
+    // the new cell follows the previous cell in the column, and later cells move down one
+    int position = 0;
+    for (int k = storageRow - 1; k >= 0; --k)
+    {
+      if (positions[k] != MISSING_CELL)
+      {
+        position = positions[k] + 1;
+        break;
+      }
+    }
+    positions[storageRow] = position;
+    for (size_t k = storageRow + 1; k < positions.size(); ++k)
+    {
+      if (positions[k] != MISSING_CELL)
+        ++positions[k];
+    }
+  }
+
+  if (newRow)
+  {
+    endInsertRows();
+    return;
+  }
+  const int modelRow = modelRow_(storageRow);
+  emit dataChanged(createIndex(modelRow, 1), createIndex(modelRow, columns_.size() - 1));
+}
+
+void DataTableModel::addColumn_(const simData::TableColumn& column)
+{
+  clearCursors_();
+  // the time column comes first
+  const int first = columns_.empty() ? 0 : columns_.size();
+  const int last = columns_.size() + (columns_.empty() ? 1 : 0);
+  beginInsertColumns(QModelIndex(), first, last);
+  if (columns_.empty())
+  {
+    columns_.push_back(NULL);
+    cellPositions_.push_back(std::vector<int>());
+    cursors_.push_back(NULL);
+  }
+  columnIndices_[column.columnId()] = columns_.size();
+  columns_.push_back(&column);
+  cellPositions_.push_back(std::vector<int>(rows_.size(), MISSING_CELL));
+  cursors_.push_back(NULL);
+  endInsertColumns();
+}
+
+void DataTableModel::removeColumn_(const simData::TableColumn& column)
+{
+  std::map<simData::TableColumnId, int>::iterator found = columnIndices_.find(column.columnId());
+  if (found == columnIndices_.end())
+    return;
+  clearCursors_();
+  const int index = found->second;
+  beginRemoveColumns(QModelIndex(), index, index);
+  columns_.removeAt(index);
+  cellPositions_.erase(cellPositions_.begin() + index);
+  cursors_.erase(cursors_.begin() + index);
+  columnIndices_.erase(found);
+  for (std::map<simData::TableColumnId, int>::iterator i = columnIndices_.begin(); i != columnIndices_.end(); ++i)
+  {
+    if (i->second > index)
+      --i->second;
+  }
+  endRemoveColumns();
+}
+
+void DataTableModel::removeRow_(double rowTime)
+{
+  // cells are removed after this notification, invalidating iterators; check the row once they are gone
+  clearCursors_();
+  if (removedTimes_.empty())
+    QMetaObject::invokeMethod(this, "processRemovedRows_", Qt::QueuedConnection);
+  removedTimes_.push_back(rowTime);
+}
+
+void DataTableModel::processRemovedRows_()
+{
+  std::vector<double> times;
+  times.swap(removedTimes_);
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+
+  std::vector<int> emptyRows;
+  for (std::vector<double>::const_iterator i = times.begin(); i != times.end(); ++i)
+  {
+    const int storageRow = static_cast<int>(std::lower_bound(rows_.begin(), rows_.end(), *i) - rows_.begin());
+    if (storageRow == rows_.size() || rows_[storageRow] != *i)
+      continue;
+
+    // forget the cells that are gone; positions of remaining cells are only used relative to each other
+    bool empty = true;
+    for (size_t k = 1; k < cellPositions_.size(); ++k)
+    {
+      if (cellPositions_[k][storageRow] == MISSING_CELL)
+        continue;
+      if (cell_(static_cast<int>(k), storageRow))
+        empty = false;
+      else
+        cellPositions_[k][storageRow] = MISSING_CELL;
+    }
+
+    if (empty)
+      emptyRows.push_back(storageRow);
+    else
+    {
+      const int modelRow = modelRow_(storageRow);
+      emit dataChanged(createIndex(modelRow, 1), createIndex(modelRow, columns_.size() - 1));
+    }
+  }
+
+  if (!emptyRows.empty())
+    removeRows_(emptyRows);
+}
+
+void DataTableModel::removeRows_(const std::vector<int>& storageRows)
+{
+  // model rows to remove, in increasing order
+  std::vector<int> modelRows;
+  modelRows.reserve(storageRows.size());
+  for (std::vector<int>::const_iterator i = storageRows.begin(); i != storageRows.end(); ++i)
+    modelRows.push_back(modelRow_(*i));
+  if (sorted_)
+    std::sort(modelRows.begin(), modelRows.end());
+
+  // remove each run of adjacent model rows at once, last run first so earlier model rows keep their index
+  size_t end = modelRows.size();
+  while (end > 0)
+  {
+    size_t begin = end - 1;
+    while (begin > 0 && modelRows[begin - 1] + 1 == modelRows[begin])
+      --begin;
+    const int first = modelRows[begin];
+    const int last = modelRows[end - 1];
+    beginRemoveRows(QModelIndex(), first, last);
+    if (sorted_)
+    {
+      // storage is compacted once after the model no longer refers to the rows
+      sortedRows_.erase(sortedRows_.begin() + first, sortedRows_.begin() + last + 1);
+    }
+    else
+    {
+      rows_.erase(rows_.begin() + first, rows_.begin() + last + 1);
+      timeStrings_.erase(timeStrings_.begin() + first, timeStrings_.begin() + last + 1);
+      for (size_t k = 1; k < cellPositions_.size(); ++k)
+        cellPositions_[k].erase(cellPositions_[k].begin() + first, cellPositions_[k].begin() + last + 1);
+    }
+    endRemoveRows();
+    end = begin;
+  }
+  if (!sorted_)
+    return;
+
+  // new index of each row remaining in storage, or -1 for removed rows
+  std::vector<int> newRows(rows_.size(), 0);
+  for (std::vector<int>::const_iterator i = storageRows.begin(); i != storageRows.end(); ++i)
+    newRows[*i] = -1;
+  int numRows = 0;
+  for (size_t k = 0; k < newRows.size(); ++k)
+  {
+    if (newRows[k] == 0)
+      newRows[k] = numRows++;
+  }
+
+  compact(rows_, newRows, numRows);
+  compact(timeStrings_, newRows, numRows);
+  for (size_t k = 1; k < cellPositions_.size(); ++k)
+    compact(cellPositions_[k], newRows, numRows);
+  modelRows_.resize(numRows);
+  for (size_t k = 0; k < sortedRows_.size(); ++k)
+  {
+    sortedRows_[k] = newRows[sortedRows_[k]];
+    modelRows_[sortedRows_[k]] = static_cast<int>(k);
+  }
+}
+
+}
@@ -22,7 +22,10 @@
 #ifndef SIMQT_DATATABLE_MODEL_H
 #define SIMQT_DATATABLE_MODEL_H
 
+#include <map>
+#include <vector>
 #include <QList>
+#include <QVector>
 #include <QAbstractItemModel>
 #include "simData/DataTable.h"
 
@@ -63,6 +66,15 @@ namespace simQt {
     virtual QModelIndex parent(const QModelIndex &index) const;
     /** @return number of rows currently loaded in the model */
     virtual int rowCount(const QModelIndex & parent = QModelIndex()) const;
+    /**
+    * Sorts rows by the values of a column.  The column's values are extracted in time order into a
+    * contiguous buffer and row indices are sorted against it.  Rows without a value sort before all
+    * values in ascending order; rows with equal values stay in time order.  Rows added while sorted
+    * are appended at the end until the next sort.
+    * @param column Column to sort by; column 0 sorts by time
+    * @param order Ascending or descending order
+    */
+    virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
 
     /**
     * Get time associated with this index, uses row value to find time.  Returns INVALID_TIME if row index not valid
@@ -83,14 +95,68 @@ namespace simQt {
 
   protected:
     /** Convert the DataTable cell value to a QVariant; converting float and double into strings with the correct precision */
-    QVariant cellDisplayValue_(simData::VariableType type, simData::TableColumn::Iterator& cellIter) const;
+    QVariant cellDisplayValue_(simData::VariableType type, const simData::TableColumn::IteratorData& cell) const;
 
     /** Convert the DataTable cell value to a QVariant */
-    QVariant cellSortValue_(simData::VariableType type, simData::TableColumn::Iterator& cellIter) const;
+    QVariant cellSortValue_(simData::VariableType type, const simData::TableColumn::IteratorData& cell) const;
+
+    /** Returns the index into rows_ of a model row */
+    int storageRow_(int row) const;
+    /** Returns the model row of an index into rows_ */
+    int modelRow_(int storageRow) const;
+
+    /**
+    * Returns the cell of a column at an index into rows_ without searching the column when possible.
+    * The column's cursor steps from the last cell visited if it is nearby, otherwise the column is
+    * searched by time.
+    * @param column Model column, greater than 0
+    * @param storageRow Index into rows_
+    * @return Cell data, or an empty pointer if the row has no value in the column
+    */
+    simData::TableColumn::IteratorDataPtr cell_(int column, int storageRow) const;
+    /** Invalidates all column cursors; required whenever the data table's containers change */
+    void clearCursors_();
+
+    /** Sorts indices into rows_ by the values of a column, extracted as type T */
+    template <typename T>
+    void sortByValue_(int column, Qt::SortOrder order, std::vector<int>& rows) const;
+
+    /** Adds a new row, or the new cells of an existing row, from the data table */
+    void addRow_(const simData::TableRow& row);
+    /** Adds a column from the data table */
+    void addColumn_(const simData::TableColumn& column);
+    /** Removes a column that is about to be removed from the data table */
+    void removeColumn_(const simData::TableColumn& column);
+    /** Queues a check of the row at the given time, whose cells are about to be removed from the data table */
+    void removeRow_(double rowTime);
+    /** Removes rows from the model, given their indices into rows_ in increasing order */
+    void removeRows_(const std::vector<int>& storageRows);
 
     simData::DataTable* dataTable_; ///< reference to the data table this model represents
     QList<const simData::TableColumn*> columns_; ///< index in list corresponds to model column index
-    QList<double> rows_; ///< index in list corresponds to model row index
+    QList<double> rows_; ///< row times in time order; see storageRow_() for the model row order
+    /**
+    * Position of each row's cell in the time-ordered storage of each column, or -1 if the row has no value
+    * in the column.  Indexed by model column, then by index into rows_; empty for the time column.
+    */
+    std::vector<std::vector<int> > cellPositions_;
+    std::map<simData::TableColumnId, int> columnIndices_; ///< model column index of each column ID
+    bool sorted_; ///< true after sort() reorders the rows; false while model rows are in time order
+    std::vector<int> sortedRows_; ///< index into rows_ of each model row while sorted_; empty otherwise
+    std::vector<int> modelRows_; ///< model row of each index into rows_ while sorted_, the inverse of sortedRows_; empty otherwise
+    mutable QVector<QString> timeStrings_; ///< formatted time of each entry in rows_, filled in on first display
+
+  private slots:
+    /** Removes rows left without cells after the data table removed cells */
+    void processRemovedRows_();
+
+  private:
+    class ColumnCursor;
+    class DataTableObserver;
+
+    mutable std::vector<ColumnCursor*> cursors_; ///< last cell visited in each model column; can be NULL
+    std::vector<double> removedTimes_; ///< times of rows whose cells are being removed
+    simData::DataTable::TableObserverPtr observer_; ///< listens for rows and columns added to the data table
   };
 
 }
@@ -153,12 +153,17 @@ namespace simQt {
 
   bool EntityProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
   {
-    // Sorting Original ID as numbers
+    // Sorting Original ID as numbers; prefer the numeric sort value to parsing the display string
     if (left.column() == 2)
     {
-      uint64_t leftId = sourceModel()->data(left).toULongLong();
-      uint64_t rightId = sourceModel()->data(right).toULongLong();
-      return leftId < rightId;
+      QVariant leftVal = sourceModel()->data(left, SORT_BY_ENTITY_ROLE);
+      QVariant rightVal = sourceModel()->data(right, SORT_BY_ENTITY_ROLE);
+      if (!leftVal.isValid() || !rightVal.isValid())
+      {
+        leftVal = sourceModel()->data(left);
+        rightVal = sourceModel()->data(right);
+      }
+      return leftVal.toULongLong() < rightVal.toULongLong();
     }
     // Sorting based on entity type
     else if (left.column() == 1)
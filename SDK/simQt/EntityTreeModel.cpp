@@ -19,6 +19,7 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <QString>
 #include <QTimer>
 
@@ -57,6 +58,12 @@ public:
     parent_->emitEntityDataChanged_(changeId);
   }
 
+  /// entity prefs have changed, possibly including the alias or the use of the alias
+  virtual void onPrefsChange(simData::DataStore *source, simData::ObjectId id)
+  {
+    parent_->checkEntityDataChanged_(id);
+  }
+
   /// something has changed in the entity category data
   virtual void onCategoryDataChange(simData::DataStore *source, simData::ObjectId changedId, simData::DataStore::ObjectType ot)
   {
@@ -75,6 +82,11 @@ protected:
 
 //----------------------------------------------------------------------------
 EntityTreeItem::EntityTreeItem(simData::ObjectId id, EntityTreeItem *parent)
+  : nameCacheValid_(false),
+    typeCacheValid_(false),
+    blankAlias_(false),
+    type_(simData::DataStore::NONE),
+    originalId_(0)
 {
   id_ = id;
   parentItem_ = parent;
@@ -133,6 +145,74 @@ int EntityTreeItem::row() const
   return 0;
 }
 
+void EntityTreeItem::updateCache(const simData::DataStore* dataStore)
+{
+  if (dataStore == NULL || (nameCacheValid_ && typeCacheValid_))
+    return;
+
+  if (!typeCacheValid_)
+  {
+    type_ = dataStore->objectType(id_);
+    originalId_ = simData::DataStoreHelpers::originalIdFromId(id_, dataStore);
+    // Entity may not be fully added yet; try again later
+    typeCacheValid_ = (type_ != simData::DataStore::NONE);
+  }
+
+  if (!nameCacheValid_)
+  {
+    simData::DataStore::Transaction transaction;
+    const simData::CommonPrefs* prefs = dataStore->commonPrefs(id_, &transaction);
+    if (prefs == NULL)
+    {
+      name_.clear();
+      alias_.clear();
+      displayName_.clear();
+      blankAlias_ = false;
+      return;
+    }
+    name_ = QString::fromStdString(prefs->name());
+    alias_ = QString::fromStdString(prefs->alias());
+    blankAlias_ = prefs->usealias() && alias_.isEmpty();
+    displayName_ = (prefs->usealias() && !blankAlias_) ? alias_ : name_;
+    nameCacheValid_ = true;
+  }
+}
+
+void EntityTreeItem::invalidateCache()
+{
+  nameCacheValid_ = false;
+}
+
+const QString& EntityTreeItem::displayName() const
+{
+  return displayName_;
+}
+
+const QString& EntityTreeItem::name() const
+{
+  return name_;
+}
+
+const QString& EntityTreeItem::alias() const
+{
+  return alias_;
+}
+
+bool EntityTreeItem::blankAlias() const
+{
+  return blankAlias_;
+}
+
+simData::DataStore::ObjectType EntityTreeItem::type() const
+{
+  return type_;
+}
+
+uint64_t EntityTreeItem::originalId() const
+{
+  return originalId_;
+}
+
 //-----------------------------------------------------------------------------------------
 
 EntityTreeModel::EntityTreeModel(QObject *parent, simData::DataStore* dataStore)
@@ -140,6 +220,7 @@ EntityTreeModel::EntityTreeModel(QObject *parent, simData::DataStore* dataStore)
     rootItem_(NULL),
     treeView_(false),
     dataStore_(NULL),
+    dataChangedPending_(false),
     platformIcon_(":/simQt/images/platform.png"),
     beamIcon_(":/simQt/images/beam.png"),
     gateIcon_(":/simQt/images/gate.png"),
@@ -230,9 +311,74 @@ void EntityTreeModel::emitEntityDataChanged_(uint64_t entityId)
   if (!found)
     return;
 
-  QModelIndex start = createIndex(found->row(), 0, found);
-  QModelIndex end = createIndex(found->row(), 2, found);
-  emit dataChanged(start, end);
+  found->invalidateCache();
+  delayedDataChanges_.insert(entityId);
+  scheduleDataChanged_();
+}
+
+void EntityTreeModel::checkEntityDataChanged_(uint64_t entityId)
+{
+  if (findItem_(entityId) == NULL)
+    return;
+
+  delayedPrefsChecks_.insert(entityId);
+  scheduleDataChanged_();
+}
+
+void EntityTreeModel::scheduleDataChanged_()
+{
+  if (dataChangedPending_)
+    return;
+  dataChangedPending_ = true;
+  QTimer::singleShot(0, this, SLOT(commitDelayedDataChanged_()));
+}
+
+void EntityTreeModel::commitDelayedDataChanged_()
+{
+  dataChangedPending_ = false;
+
+  // Prefs changes only matter if they changed the displayed name or its color
+  for (std::set<simData::ObjectId>::const_iterator it = delayedPrefsChecks_.begin(); it != delayedPrefsChecks_.end(); ++it)
+  {
+    EntityTreeItem* item = findItem_(*it);
+    if (item == NULL)
+      continue;
+    const QString oldDisplayName = item->displayName();
+    const QString oldName = item->name();
+    const QString oldAlias = item->alias();
+    const bool oldBlankAlias = item->blankAlias();
+    item->invalidateCache();
+    item->updateCache(dataStore_);
+    if (item->displayName() != oldDisplayName || item->name() != oldName || item->alias() != oldAlias || item->blankAlias() != oldBlankAlias)
+      delayedDataChanges_.insert(*it);
+  }
+  delayedPrefsChecks_.clear();
+
+  // Collapse the changes into one range of rows per parent
+  std::map<EntityTreeItem*, std::pair<int, int> > rowsByParent;
+  for (std::set<simData::ObjectId>::const_iterator it = delayedDataChanges_.begin(); it != delayedDataChanges_.end(); ++it)
+  {
+    EntityTreeItem* item = findItem_(*it);
+    if (item == NULL)
+      continue;
+    const int row = item->row();
+    std::map<EntityTreeItem*, std::pair<int, int> >::iterator rangeIt = rowsByParent.find(item->parent());
+    if (rangeIt == rowsByParent.end())
+      rowsByParent[item->parent()] = std::make_pair(row, row);
+    else
+    {
+      rangeIt->second.first = std::min(rangeIt->second.first, row);
+      rangeIt->second.second = std::max(rangeIt->second.second, row);
+    }
+  }
+  delayedDataChanges_.clear();
+
+  for (std::map<EntityTreeItem*, std::pair<int, int> >::const_iterator it = rowsByParent.begin(); it != rowsByParent.end(); ++it)
+  {
+    QModelIndex start = createIndex(it->second.first, 0, it->first->child(it->second.first));
+    QModelIndex end = createIndex(it->second.second, 2, it->first->child(it->second.second));
+    emit dataChanged(start, end);
+  }
 }
 
 void EntityTreeModel::setToTreeView()
@@ -405,20 +551,21 @@ QVariant EntityTreeModel::data(const QModelIndex &index, int role) const
   EntityTreeItem *item = static_cast<EntityTreeItem*>(index.internalPointer());
   if (item == NULL)
     return QVariant();
+  item->updateCache(dataStore_);
 
   switch (role)
   {
   case Qt::DisplayRole:
     if (index.column() == 0)
-      return QString::fromStdString(simData::DataStoreHelpers::nameOrAliasFromId(item->id(), dataStore_));
+      return item->displayName();
     if (index.column() == 1)
     {
       if (useEntityIcons_)
         return QVariant();
-      return QString::fromStdString(simData::DataStoreHelpers::typeFromId(item->id(), dataStore_));
+      return QString::fromStdString(simData::DataStoreHelpers::typeToString(item->type()));
     }
     if (index.column() == 2)
-      return QString("%1").arg(simData::DataStoreHelpers::originalIdFromId(item->id(), dataStore_));
+      return QString::number(item->originalId());
 
     // Invalid index encountered
     assert(0);
@@ -428,7 +575,7 @@ QVariant EntityTreeModel::data(const QModelIndex &index, int role) const
     // Only show icon if icons are enabled
     if (useEntityIcons_ && index.column() == 1)
     {
-      switch (dataStore_->objectType(item->id()))
+      switch (item->type())
       {
       case simData::DataStore::PLATFORM:
         return platformIcon_;
@@ -453,9 +600,7 @@ QVariant EntityTreeModel::data(const QModelIndex &index, int role) const
     if (index.column() == 0)
     {
       // If the user asked for alias, but it is empty use gray color for the displayed name
-      simData::DataStore::Transaction transaction;
-      const simData::CommonPrefs* prefs = dataStore_->commonPrefs(item->id(), &transaction);
-      if (prefs && prefs->usealias() && prefs->alias().empty())
+      if (item->blankAlias())
         return QColor(Qt::gray);
     }
     break;
@@ -464,10 +609,10 @@ QVariant EntityTreeModel::data(const QModelIndex &index, int role) const
     if (index.column() == 0)
     {
       QString toolTip = tr("Name: %1\nAlias: %2\nType: %3\nOriginal ID: %4")
-        .arg(QString::fromStdString(simData::DataStoreHelpers::nameFromId(item->id(), dataStore_)))
-        .arg(QString::fromStdString(simData::DataStoreHelpers::aliasFromId(item->id(), dataStore_)))
-        .arg(QString::fromStdString(simData::DataStoreHelpers::fullTypeFromId(item->id(), dataStore_)))
-        .arg(simData::DataStoreHelpers::originalIdFromId(item->id(), dataStore_));
+        .arg(item->name())
+        .arg(item->alias())
+        .arg(QString::fromStdString(simData::DataStoreHelpers::fullTypeToString(item->type())))
+        .arg(item->originalId());
 
       simData::DataStore::Transaction transaction;
       const simData::PlatformPrefs* prefs = dataStore_->platformPrefs(item->id(), &transaction);
@@ -484,7 +629,7 @@ QVariant EntityTreeModel::data(const QModelIndex &index, int role) const
     }
 
     if (index.column() == 1)
-      return QString::fromStdString(simData::DataStoreHelpers::fullTypeFromId(item->id(), dataStore_));
+      return QString::fromStdString(simData::DataStoreHelpers::fullTypeToString(item->type()));
 
     if (index.column() == 2)
       return tr("Original ID");
@@ -495,8 +640,10 @@ QVariant EntityTreeModel::data(const QModelIndex &index, int role) const
     if (index.column() == 1)
     {
       // Use ints to force entity types into desired order whether they're currently being displayed as icons or text
-      return static_cast<int>(dataStore_->objectType(item->id()));
+      return static_cast<int>(item->type());
     }
+    if (index.column() == 2)
+      return static_cast<qulonglong>(item->originalId());
     break;
   }
 
@@ -22,6 +22,7 @@
 #ifndef SIMQT_ENTITYTREE_MODEL_H
 #define SIMQT_ENTITYTREE_MODEL_H
 
+#include <set>
 #include <QTreeWidgetItem>
 #include "simCore/Common/Common.h"
 #include "simData/DataStore.h"
@@ -54,10 +55,44 @@ public:
   int row() const;
   ///@}
 
+  /**@name Cached display values
+   * Values are read from the data store on first use, so that painting and sorting do not
+   * open a transaction per cell.  Type and original ID never change; name and alias values
+   * are refreshed after invalidateCache().
+   *@{
+   */
+  /// Reads any stale values from the data store
+  void updateCache(const simData::DataStore* dataStore);
+  /// Marks the name and alias values as stale
+  void invalidateCache();
+  /// Name or alias, as shown in the name column
+  const QString& displayName() const;
+  /// Entity name
+  const QString& name() const;
+  /// Entity alias
+  const QString& alias() const;
+  /// True if the alias is displayed but is empty, in which case the name is shown instead
+  bool blankAlias() const;
+  /// Entity type
+  simData::DataStore::ObjectType type() const;
+  /// Original ID of the entity
+  uint64_t originalId() const;
+  ///@}
+
 protected:
   simData::ObjectId id_; ///< id of the entity represented
   EntityTreeItem *parentItem_;  ///< parent of the item.  Null if top item
   QList<EntityTreeItem*> childItems_;  ///< Children of item, if any.  If no children, than item is a leaf
+
+private:
+  bool nameCacheValid_;  ///< false if name, alias and display name need to be read
+  bool typeCacheValid_;  ///< false if type and original ID need to be read
+  QString displayName_;
+  QString name_;
+  QString alias_;
+  bool blankAlias_;
+  simData::DataStore::ObjectType type_;
+  uint64_t originalId_;
 };
 
 /// model (data representation) for a tree of Entities (Platforms, Beams, Gates, etc.)
@@ -113,6 +148,8 @@ public slots:
 private slots:
   /** Added any delayed entities */
   void commitDelayedEntities_();
+  /** Emits the data changes accumulated since the last call, one signal per range of sibling rows */
+  void commitDelayedDataChanged_();
 
 private:
   class TreeListener;
@@ -132,6 +169,10 @@ private:
   void addEntity_(uint64_t entityId);
   /// The entity specified by the id has either an new name or its category data changed
   void emitEntityDataChanged_(uint64_t entityId);
+  /// The prefs of the entity specified by the id changed; a data change is emitted only if the displayed values changed
+  void checkEntityDataChanged_(uint64_t entityId);
+  /// Schedules commitDelayedDataChanged_() if it is not already pending
+  void scheduleDataChanged_();
 
   EntityTreeItem *rootItem_;  ///< Top of the entity tree
   std::map<simData::ObjectId, EntityTreeItem*> itemsById_; ///< same information as rootItem, but keyed off of Object ID
@@ -146,6 +187,16 @@ private:
    */
   std::vector<simData::ObjectId> delayedAdds_;
 
+  /**
+   * Name and category changes often arrive in bursts (e.g. a scenario load renaming every entity).
+   * The IDs are collected here and emitted as a few dataChanged() signals on the next event loop pass.
+   */
+  std::set<simData::ObjectId> delayedDataChanges_;
+  /// IDs with changed prefs, checked for changes to displayed values on the next event loop pass
+  std::set<simData::ObjectId> delayedPrefsChecks_;
+  /// True if commitDelayedDataChanged_() is scheduled
+  bool dataChangedPending_;
+
   /** Icons for entity types */
   QIcon platformIcon_;
   QIcon beamIcon_;
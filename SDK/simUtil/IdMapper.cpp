@@ -19,6 +19,7 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <cassert>
 #include "simData/DataStore.h"
 #include "simData/DataStoreHelpers.h"
@@ -34,16 +35,35 @@ public:
   {
   }
 
+  /// new entity has been added, with the given id and type
+  virtual void onAddEntity(simData::DataStore *source, simData::ObjectId newId, simData::DataStore::ObjectType ot)
+  {
+    mapper_.indexLocalId_(newId, ot == simData::DataStore::PLATFORM);
+    // New entity might be the match for a previously unresolved ID
+    mapper_.clearUnresolved_();
+  }
+
   /// entity with the given id and type will be removed after all notifications are processed
   virtual void onRemoveEntity(simData::DataStore *source, simData::ObjectId removedId, simData::DataStore::ObjectType ot)
   {
     mapper_.removeLocalId_(removedId);
+    mapper_.unindexLocalId_(removedId, ot == simData::DataStore::PLATFORM);
+    // Removal might leave a single candidate for a previously ambiguous ID
+    mapper_.clearUnresolved_();
+  }
+
+  /// entity name has changed
+  virtual void onNameChange(simData::DataStore *source, simData::ObjectId changeId)
+  {
+    // Names discriminate between candidates, so a rename might resolve a previously ambiguous ID
+    mapper_.clearUnresolved_();
   }
 
   /// The scenario is about to be deleted
   virtual void onScenarioDelete(simData::DataStore* source)
   {
     mapper_.clearResolvedIds_();
+    mapper_.clearOriginalIdIndex_();
   }
 
 private:
@@ -53,7 +73,8 @@ private:
 ///////////////////////////////////////////////////////////////////////
 
 DataStoreIdMapper::DataStoreIdMapper(simData::DataStore& dataStore)
-  : dataStore_(dataStore)
+  : dataStore_(dataStore),
+    originalIdIndexValid_(false)
 {
   dataStoreListener_.reset(new DataStoreListener(*this));
   dataStore_.addListener(dataStoreListener_);
@@ -67,12 +88,16 @@ DataStoreIdMapper::~DataStoreIdMapper()
 uint64_t DataStoreIdMapper::map(uint64_t id)
 {
   // Try to find it in resolved list first
-  std::map<uint64_t, uint64_t>::const_iterator rid = resolvedIds_.find(id);
+  std::unordered_map<uint64_t, uint64_t>::const_iterator rid = resolvedIds_.find(id);
   if (rid != resolvedIds_.end())
     return rid->second;
 
+  // Failed last time, and nothing has changed since that could make it succeed
+  if (unresolvedIds_.find(id) != unresolvedIds_.end())
+    return 0;
+
   // Try to find the server mapping data for this ID
-  std::map<uint64_t, EntityIdData>::const_iterator dataIter = mappings_.find(id);
+  std::unordered_map<uint64_t, EntityIdData>::const_iterator dataIter = mappings_.find(id);
   if (dataIter == mappings_.end()) // fail?
     return 0;
 
@@ -86,13 +111,34 @@ uint64_t DataStoreIdMapper::map(uint64_t id)
     assert(reverseResolvedIds_.find(resolved) == reverseResolvedIds_.end());
     reverseResolvedIds_[resolved] = id;
   }
+  else
+    unresolvedIds_.insert(id);
   return resolved;
 }
 
+size_t DataStoreIdMapper::map(const std::vector<uint64_t>& remoteIds, std::vector<uint64_t>& localIds)
+{
+  localIds.resize(remoteIds.size());
+  size_t numMapped = 0;
+  for (size_t k = 0; k < remoteIds.size(); ++k)
+  {
+    // Consecutive updates are frequently for the same entity
+    if (k > 0 && remoteIds[k] == remoteIds[k - 1])
+      localIds[k] = localIds[k - 1];
+    else
+      localIds[k] = map(remoteIds[k]);
+    if (localIds[k] != 0)
+      ++numMapped;
+  }
+  return numMapped;
+}
+
 int DataStoreIdMapper::addMapping(const EntityIdData& mapping)
 {
   // Save for later searches; note that already-existing IDs are possible and not an error.
   mappings_[mapping.id] = mapping;
+  // A new mapping (e.g. for a host platform) can help resolve IDs that previously failed
+  clearUnresolved_();
   return 0;
 }
 
@@ -112,7 +158,8 @@ int DataStoreIdMapper::removeId(uint64_t remoteId)
   if (iter == mappings_.end())
     return 1;
   mappings_.erase(iter);
-  std::map<uint64_t, uint64_t>::iterator remoteIter = resolvedIds_.find(remoteId);
+  unresolvedIds_.erase(remoteId);
+  std::unordered_map<uint64_t, uint64_t>::iterator remoteIter = resolvedIds_.find(remoteId);
   if (remoteIter != resolvedIds_.end())
   {
     // Assertion failure means we didn't clean up somewhere properly
@@ -133,15 +180,14 @@ uint64_t DataStoreIdMapper::resolve_(const EntityIdData& fromIdData)
 {
   // Get the entity type -- either platform or all-but-platforms
   const bool isPlatform = (fromIdData.id == fromIdData.hostPlatformId);
-  simData::DataStore::ObjectType entityTypeFilter = simData::DataStore::ALL;
-  if (isPlatform)
-    entityTypeFilter = simData::DataStore::PLATFORM;
-  else
-    entityTypeFilter = static_cast<simData::DataStore::ObjectType>(entityTypeFilter ^ simData::DataStore::PLATFORM);
 
   // Find original IDs matching this list
-  simData::DataStore::IdList ids;
-  dataStore_.idListByOriginalId(&ids, fromIdData.originalId, entityTypeFilter);
+  buildOriginalIdIndex_();
+  const OriginalIdIndex& index = (isPlatform ? platformsByOriginalId_ : othersByOriginalId_);
+  OriginalIdIndex::const_iterator indexIter = index.find(fromIdData.originalId);
+  if (indexIter == index.end())
+    return 0;
+  simData::DataStore::IdList ids = indexIter->second;
 
   // If it's an empty list, we return; server has an ID we don't have
   if (ids.empty())
@@ -198,7 +244,7 @@ void DataStoreIdMapper::filterToName_(const std::string& entityName, std::vector
 
 int DataStoreIdMapper::removeLocalId_(uint64_t localId)
 {
-  std::map<uint64_t, uint64_t>::iterator localIter = reverseResolvedIds_.find(localId);
+  std::unordered_map<uint64_t, uint64_t>::iterator localIter = reverseResolvedIds_.find(localId);
   if (localIter != reverseResolvedIds_.end())
   {
     const uint64_t remoteId = localIter->second;
@@ -219,6 +265,64 @@ void DataStoreIdMapper::clearResolvedIds_()
 {
   resolvedIds_.clear();
   reverseResolvedIds_.clear();
+  unresolvedIds_.clear();
+}
+
+void DataStoreIdMapper::buildOriginalIdIndex_()
+{
+  if (originalIdIndexValid_)
+    return;
+  platformsByOriginalId_.clear();
+  othersByOriginalId_.clear();
+  // Set valid first so that indexLocalId_() adds to the index
+  originalIdIndexValid_ = true;
+
+  simData::DataStore::IdList ids;
+  dataStore_.idList(&ids, simData::DataStore::PLATFORM);
+  for (simData::DataStore::IdList::const_iterator i = ids.begin(); i != ids.end(); ++i)
+    indexLocalId_(*i, true);
+  ids.clear();
+  dataStore_.idList(&ids, static_cast<simData::DataStore::ObjectType>(simData::DataStore::ALL ^ simData::DataStore::PLATFORM));
+  for (simData::DataStore::IdList::const_iterator i = ids.begin(); i != ids.end(); ++i)
+    indexLocalId_(*i, false);
+}
+
+void DataStoreIdMapper::clearOriginalIdIndex_()
+{
+  platformsByOriginalId_.clear();
+  othersByOriginalId_.clear();
+  originalIdIndexValid_ = false;
+}
+
+void DataStoreIdMapper::indexLocalId_(uint64_t localId, bool isPlatform)
+{
+  // Index is filled on first use
+  if (!originalIdIndexValid_)
+    return;
+  const uint64_t originalId = simData::DataStoreHelpers::originalIdFromId(localId, &dataStore_);
+  OriginalIdIndex& index = (isPlatform ? platformsByOriginalId_ : othersByOriginalId_);
+  index[originalId].push_back(localId);
+}
+
+void DataStoreIdMapper::unindexLocalId_(uint64_t localId, bool isPlatform)
+{
+  if (!originalIdIndexValid_)
+    return;
+  // Entity is still in the data store during the remove notification
+  const uint64_t originalId = simData::DataStoreHelpers::originalIdFromId(localId, &dataStore_);
+  OriginalIdIndex& index = (isPlatform ? platformsByOriginalId_ : othersByOriginalId_);
+  OriginalIdIndex::iterator indexIter = index.find(originalId);
+  if (indexIter == index.end())
+    return;
+  std::vector<uint64_t>& localIds = indexIter->second;
+  localIds.erase(std::remove(localIds.begin(), localIds.end(), localId), localIds.end());
+  if (localIds.empty())
+    index.erase(indexIter);
+}
+
+void DataStoreIdMapper::clearUnresolved_()
+{
+  unresolvedIds_.clear();
 }
 
 
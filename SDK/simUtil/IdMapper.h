@@ -24,7 +24,8 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include "simCore/Common/Common.h"
 #include "simCore/Common/Memory.h"
 
@@ -55,6 +56,11 @@ public:
  *
  * IDs are matched by a variety of data that should reasonably be considered identifying,
  * including name, original ID, and host ID.
+ *
+ * Local entities are indexed by original ID on first use, and the index is maintained from
+ * data store add and remove notifications.  Remote IDs that fail to resolve are remembered
+ * and not retried until an entity is added, removed, or renamed, or a mapping is added.  The
+ * index presumes that an entity's original ID does not change after the entity is added.
  */
 class SDKUTIL_EXPORT DataStoreIdMapper : public IdMapper
 {
@@ -89,6 +95,15 @@ public:
   /** Provides an ID mapping from Remote IDs to local ID */
   virtual uint64_t map(uint64_t id);
 
+  /**
+   * Maps a list of remote IDs to local IDs in one call.  Equivalent to calling map() on
+   * each ID, but avoids per-call overhead for callers processing many updates at once.
+   * @param[in ] remoteIds Remote IDs to map
+   * @param[out] localIds Local IDs, parallel to remoteIds; 0 for IDs that do not map
+   * @return Number of remote IDs that mapped to a local ID
+   */
+  size_t map(const std::vector<uint64_t>& remoteIds, std::vector<uint64_t>& localIds);
+
 private:
   /** Attempts to resolve the ID to a known ID on our side, returns 0 on not-found */
   uint64_t resolve_(const EntityIdData& fromIdData);
@@ -102,6 +117,17 @@ private:
   /** Clear out the IDs but keep the mappings */
   void clearResolvedIds_();
 
+  /** Fills the original ID index from the data store if it is not current */
+  void buildOriginalIdIndex_();
+  /** Empties the original ID index; it is rebuilt on next use */
+  void clearOriginalIdIndex_();
+  /** Adds a new local entity to the original ID index, if the index is built */
+  void indexLocalId_(uint64_t localId, bool isPlatform);
+  /** Removes a local entity from the original ID index, if the index is built */
+  void unindexLocalId_(uint64_t localId, bool isPlatform);
+  /** Forgets all remote IDs that previously failed to resolve */
+  void clearUnresolved_();
+
   /** Our data store */
   simData::DataStore& dataStore_;
   /** Listens for events like entity removal to clear out IDs */
@@ -110,11 +136,22 @@ private:
   std::tr1::shared_ptr<DataStoreListener> dataStoreListener_;
 
   /** Maps a SERVER ID to a LOCAL ID */
-  std::map<uint64_t, uint64_t> resolvedIds_;
+  std::unordered_map<uint64_t, uint64_t> resolvedIds_;
   /** Reverse lookup from LOCAL ID to SERVER ID; required for speedy removal */
-  std::map<uint64_t, uint64_t> reverseResolvedIds_;
+  std::unordered_map<uint64_t, uint64_t> reverseResolvedIds_;
   /** Includes all mappings; useful for when resolved IDs have been removed */
-  std::map<uint64_t, EntityIdData> mappings_;
+  std::unordered_map<uint64_t, EntityIdData> mappings_;
+  /** SERVER IDs with a mapping that did not resolve on the last attempt */
+  std::unordered_set<uint64_t> unresolvedIds_;
+
+  /** Maps an original ID to the LOCAL IDs that have it */
+  typedef std::unordered_map<uint64_t, std::vector<uint64_t> > OriginalIdIndex;
+  /** Local platforms by original ID */
+  OriginalIdIndex platformsByOriginalId_;
+  /** Local non-platform entities by original ID */
+  OriginalIdIndex othersByOriginalId_;
+  /** True when the original ID indices reflect the data store */
+  bool originalIdIndexValid_;
 };
 
 }
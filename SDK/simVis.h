@@ -50,6 +50,7 @@
 #include "simVis/GlowHighlight.h"
 #include "simVis/GOG/Annotation.h"
 #include "simVis/GOG/Arc.h"
+#include "simVis/GOG/BinaryCache.h"
 #include "simVis/GOG/Circle.h"
 #include "simVis/GOG/Cylinder.h"
 #include "simVis/GOG/Ellipse.h"
@@ -97,13 +98,16 @@
 #include "simVis/RadialLOS.h"
 #include "simVis/RadialLOSNode.h"
 #include "simVis/RangeTool.h"
+#include "simVis/RangeToolEngine.h"
 #include "simVis/RCS.h"
 #include "simVis/Registry.h"
+#include "simVis/RFProp/ArepsBackgroundLoader.h"
 #include "simVis/RFProp/ArepsLoader.h"
 #include "simVis/RFProp/BearingProfileMap.h"
 #include "simVis/RFProp/ColorProvider.h"
 #include "simVis/RFProp/CompositeColorProvider.h"
 #include "simVis/RFProp/CompositeProfileProvider.h"
+#include "simVis/RFProp/CompressedLUTProfileDataProvider.h"
 #include "simVis/RFProp/FunctionalProfileDataProvider.h"
 #include "simVis/RFProp/GradientColorProvider.h"
 #include "simVis/RFProp/LUT1ProfileDataProvider.h"
@@ -21,6 +21,9 @@
  */
 #include "osg/Geode"
 #include "osg/Geometry"
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
+#include "osgEarth/NodeUtils"
 #include "osgEarthSymbology/MeshConsolidator"
 
 #include "simCore/Calc/Angle.h"
@@ -29,6 +32,7 @@
 #include "simData/DataTypes.h"
 #include "simVis/AxisVector.h"
 #include "simVis/Constants.h"
+#include "simVis/EMFileCache.h"
 #include "simVis/Registry.h"
 #include "simVis/Utils.h"
 #include "simVis/Antenna.h"
@@ -76,13 +80,45 @@ namespace {
     vecNorm = normalRot * vecNorm;
     return vecNorm;
   }
+
+  /// Minimum number of grid points each worker thread evaluates when building the pattern
+  static const size_t MIN_POINTS_PER_THREAD = 4096;
+
+  /** Evaluates a block of antenna pattern rows (elevations) on a worker thread */
+  class GainRowsThread : public OpenThreads::Thread
+  {
+  public:
+    GainRowsThread(simCore::AntennaPattern& pattern, const std::vector<float>& azimuths, const std::vector<float>& elevations, const simCore::AntennaGainParameters& params)
+      : pattern_(pattern),
+        azimuths_(azimuths),
+        elevations_(elevations),
+        params_(params)
+    {
+    }
+
+    virtual void run()
+    {
+      pattern_.gainGrid(azimuths_, elevations_, params_, gains_);
+    }
+
+    /** Gains for the block, valid after join() */
+    const std::vector<float>& gains() const { return gains_; }
+
+  private:
+    simCore::AntennaPattern& pattern_;
+    const std::vector<float>& azimuths_;
+    std::vector<float> elevations_;
+    simCore::AntennaGainParameters params_;
+    std::vector<float> gains_;
+  };
 }
 namespace simVis
 {
 
 AntennaNode::AntennaNode(const osg::Quat& rot)
-  : antennaPattern_(NULL),
-    loadedOK_(false),
+  : loadedOK_(false),
+    loadPending_(false),
+    patternFrequency_(0.0f),
     beamRange_(1.0f),
     beamScale_(1.0f),
     scaleFactor_(-1.0f),
@@ -96,7 +132,6 @@ AntennaNode::AntennaNode(const osg::Quat& rot)
 AntennaNode::~AntennaNode()
 {
   delete colorUtils_;
-  delete antennaPattern_;
 }
 
 // antennaPattern's scale is a product of update range (in m) and pref beamScale (no units, 1.0 default)
@@ -160,12 +195,29 @@ bool AntennaNode::setPrefs(const simData::BeamPrefs& prefs)
       }
     }
 
-    // load the new pattern file
-    delete(antennaPattern_);
+    // load the new pattern file; patterns are shared with other beams that use the same file
+    antennaPattern_.reset();
+    loadedOK_ = false;
     // Frequency must be > 0, if <= 0 use default value
-    double freq = prefs.frequency() > 0 ? prefs.frequency() : simCore::DEFAULT_FREQUENCY;
-    antennaPattern_ = simCore::loadPatternFile(patternFile_, freq);
-    loadedOK_ = (antennaPattern_ != NULL);
+    patternFrequency_ = static_cast<float>(prefs.frequency() > 0 ? prefs.frequency() : simCore::DEFAULT_FREQUENCY);
+    setLoadPending_(true);
+  }
+
+  if (loadPending_)
+  {
+    if (prefs.drawtype() == simData::BeamPrefs_DrawType_ANTENNA_PATTERN)
+    {
+      // parse in the background; traverse() draws the pattern when it is ready
+      if (checkPendingLoad_())
+        setLoadPending_(false);
+    }
+    else
+    {
+      // not in the scene graph, so no update traversal; gain calculations need the pattern now
+      antennaPattern_ = EMFileCache::instance()->antennaPattern(patternFile_, patternFrequency_);
+      loadedOK_ = (antennaPattern_ != NULL);
+      setLoadPending_(false);
+    }
   }
 
   polarity_ = static_cast<simCore::PolarityType>(prefs.polarity());
@@ -188,17 +240,19 @@ bool AntennaNode::setPrefs(const simData::BeamPrefs& prefs)
   if (!drawAntennaPattern)
   {
     removeChildren(0, getNumChildren());
+    if (loadPending_)
+    {
+      // graphic is built in traverse() when the load completes; the node must be attached to receive it
+      beamScale_ = prefs.beamscale();
+      lastPrefs_ = prefs;
+      return true;
+    }
   }
   else if (requiresRedraw)
   {
-    // this needs to be recalc'd if prefs change. reset to -1 to force recalc
-    scaleFactor_ = -1.0f;
     beamScale_ = prefs.beamscale();
     lastPrefs_ = prefs;
-    render_();
-    setNodeMask(simVis::DISPLAY_MASK_BEAM);
-    updateLighting_(prefs.shaded());
-    updateBlending_(prefs.blended());
+    redraw_();
     return true;
   }
   else
@@ -220,6 +274,47 @@ bool AntennaNode::setPrefs(const simData::BeamPrefs& prefs)
   return false;
 }
 
+void AntennaNode::traverse(osg::NodeVisitor& nv)
+{
+  if (loadPending_ && nv.getVisitorType() == nv.UPDATE_VISITOR && checkPendingLoad_())
+  {
+    setLoadPending_(false);
+    redraw_();
+  }
+  osg::MatrixTransform::traverse(nv);
+}
+
+void AntennaNode::setLoadPending_(bool pending)
+{
+  if (pending == loadPending_)
+    return;
+  loadPending_ = pending;
+  ADJUST_UPDATE_TRAV_COUNT(this, pending ? 1 : -1);
+}
+
+bool AntennaNode::checkPendingLoad_()
+{
+  simCore::AntennaPatternPtr pattern;
+  const EMFileCache::Status status = EMFileCache::instance()->requestAntennaPattern(patternFile_, patternFrequency_, pattern);
+  if (status == EMFileCache::STATUS_PENDING)
+    return false;
+  antennaPattern_ = pattern;
+  loadedOK_ = (antennaPattern_ != NULL);
+  return true;
+}
+
+void AntennaNode::redraw_()
+{
+  if (!loadedOK_ || !lastPrefs_.isSet() || lastPrefs_->drawtype() != simData::BeamPrefs_DrawType_ANTENNA_PATTERN)
+    return;
+  // this needs to be recalc'd if prefs change. reset to -1 to force recalc
+  scaleFactor_ = -1.0f;
+  render_();
+  setNodeMask(simVis::DISPLAY_MASK_BEAM);
+  updateLighting_(lastPrefs_->shaded());
+  updateBlending_(lastPrefs_->blended());
+}
+
 void AntennaNode::updateLighting_(bool shaded)
 {
   osg::StateSet* stateSet = getOrCreateStateSet();
@@ -234,36 +329,86 @@ void AntennaNode::updateBlending_(bool blending)
     (blending ? osg::StateAttribute::ON : osg::StateAttribute::OFF));
 }
 
-float AntennaNode::PatternGain(float azim, float elev, simCore::PolarityType polarity) const
+simCore::AntennaGainParameters AntennaNode::gainParameters_() const
 {
-  if (!lastPrefs_.isSet())
-    return 0.0f;
   // convert freq in MHz to Hz (note that freq is not actually used in any supported gain calcs)
   double freq = lastPrefs_->frequency() * 1e6;
-  if (!antennaPattern_)
-    return lastPrefs_->gain();
   switch (antennaPattern_->type())
   {
   case simCore::ANTENNA_PATTERN_MONOPULSE:
-    return antennaPattern_->gain(simCore::AntennaGainParameters(azim, elev, simCore::POLARITY_UNKNOWN, 0, 0, lastPrefs_->gain(), 0, 0, freq, false, lastPrefs_->channel()));
+    return simCore::AntennaGainParameters(0, 0, simCore::POLARITY_UNKNOWN, 0, 0, lastPrefs_->gain(), 0, 0, freq, false, lastPrefs_->channel());
   case simCore::ANTENNA_PATTERN_CRUISE:
-    return antennaPattern_->gain(simCore::AntennaGainParameters(azim, elev, simCore::POLARITY_UNKNOWN, 0, 0, 0, 0, 0, freq));
+    return simCore::AntennaGainParameters(0, 0, simCore::POLARITY_UNKNOWN, 0, 0, 0, 0, 0, freq);
   case simCore::ANTENNA_PATTERN_NSMA:
   case simCore::ANTENNA_PATTERN_EZNEC:
   case simCore::ANTENNA_PATTERN_XFDTD:
-    return antennaPattern_->gain(simCore::AntennaGainParameters(azim, elev, polarity_, 0, 0, lastPrefs_->gain()));
+    return simCore::AntennaGainParameters(0, 0, polarity_, 0, 0, lastPrefs_->gain());
   default:
-    return antennaPattern_->gain(simCore::AntennaGainParameters(azim, elev, simCore::POLARITY_UNKNOWN, simCore::angFix2PI(lastPrefs_->horizontalwidth()), osg::absolute(simCore::angFixPI(lastPrefs_->verticalwidth())), lastPrefs_->gain(), -23.2f, -20.0f, freq, lastPrefs_->weighting()));
+    return simCore::AntennaGainParameters(0, 0, simCore::POLARITY_UNKNOWN, simCore::angFix2PI(lastPrefs_->horizontalwidth()), osg::absolute(simCore::angFixPI(lastPrefs_->verticalwidth())), lastPrefs_->gain(), -23.2f, -20.0f, freq, lastPrefs_->weighting());
   }
-  // this point should never be reached; if assert fails, logic in this routine has been changed
-  assert(0);
-  return lastPrefs_->gain();
 }
 
-float AntennaNode::ComputeRadius_(float azim, float elev, simCore::PolarityType polarity, osg::Vec3f &p) const
+float AntennaNode::PatternGain(float azim, float elev, simCore::PolarityType polarity) const
 {
-  // values returned from PatternGain are in dB
-  float gain = PatternGain(azim, elev, polarity);
+  if (!lastPrefs_.isSet())
+    return 0.0f;
+  if (!antennaPattern_)
+    return lastPrefs_->gain();
+  simCore::AntennaGainParameters params = gainParameters_();
+  params.azim_ = azim;
+  params.elev_ = elev;
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
+  return antennaPattern_->gain(params);
+}
+
+void AntennaNode::computeGains_(const std::vector<float>& azimuths, const std::vector<float>& elevations, std::vector<float>& gains) const
+{
+  if (!antennaPattern_)
+  {
+    gains.assign(azimuths.size() * elevations.size(), lastPrefs_->gain());
+    return;
+  }
+
+  const simCore::AntennaGainParameters params = gainParameters_();
+  // patterns are shared through the EMFileCache; the worker threads below run under this lock
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
+  size_t numThreads = 1;
+  if (antennaPattern_->gainGridThreadSafe() && !azimuths.empty())
+  {
+    numThreads = osg::minimum(static_cast<size_t>(OpenThreads::GetNumberOfProcessors()), (azimuths.size() * elevations.size()) / MIN_POINTS_PER_THREAD);
+    numThreads = osg::minimum(numThreads, elevations.size());
+  }
+  if (numThreads <= 1)
+  {
+    antennaPattern_->gainGrid(azimuths, elevations, params, gains);
+    return;
+  }
+
+  // split the rows into contiguous blocks, one per thread
+  std::vector<GainRowsThread*> threads;
+  const size_t rowsPerThread = (elevations.size() + numThreads - 1) / numThreads;
+  for (size_t first = 0; first < elevations.size(); first += rowsPerThread)
+  {
+    const size_t last = osg::minimum(first + rowsPerThread, elevations.size());
+    const std::vector<float> block(elevations.begin() + first, elevations.begin() + last);
+    GainRowsThread* thread = new GainRowsThread(*antennaPattern_, azimuths, block, params);
+    threads.push_back(thread);
+    thread->start();
+  }
+
+  gains.clear();
+  gains.reserve(azimuths.size() * elevations.size());
+  for (std::vector<GainRowsThread*>::const_iterator i = threads.begin(); i != threads.end(); ++i)
+  {
+    (*i)->join();
+    gains.insert(gains.end(), (*i)->gains().begin(), (*i)->gains().end());
+    delete *i;
+  }
+}
+
+float AntennaNode::computePoint_(float gain, float cosAzim, float sinAzim, float cosElev, float sinElev, osg::Vec3f &p) const
+{
+  // gains are in dB
   float radius;
 
   if (gain < simCore::SMALL_DB_COMPARE)
@@ -276,9 +421,9 @@ float AntennaNode::ComputeRadius_(float azim, float elev, simCore::PolarityType
     radius = ((gain > lastPrefs_->sensitivity()) ? osg::absolute(gain - min_) * scaleFactor_ : 0.0f);
 
   // convert azim & elev to a rectangular coordinate
-  p.set(radius * cosf(azim) * cosf(elev),
-    radius * sinf(azim) * cosf(elev),
-    radius * sinf(elev));
+  p.set(radius * cosAzim * cosElev,
+    radius * sinAzim * cosElev,
+    radius * sinElev);
 
   return gain;
 }
@@ -339,6 +484,7 @@ void AntennaNode::render_()
   // determine pattern bounds in order to normalize
   if (scaleFactor_ < 0.0)
   {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
     antennaPattern_->minMaxGain(&min_, &max_, simCore::AntennaGainParameters(0, 0, polarity_, simCore::angFix2PI(lastPrefs_->horizontalwidth()), osg::absolute(simCore::angFixPI(lastPrefs_->verticalwidth())), lastPrefs_->gain(), -23.2f, -20.0f, lastPrefs_->frequency() * 1e6, lastPrefs_->weighting()));
 
     // prevent divide by zero error for OMNI case
@@ -399,45 +545,48 @@ void AntennaNode::render_()
   }
   #endif
 
-  azimDone = false;
-  // unconventional iteration, due to algorithm needing *iiter and *(iiter+1)
-  for (std::vector<float>::const_iterator iiter = azimPoints.begin(); !azimDone; ++iiter)
+  // evaluate the pattern once for every az/el point; the strips and the side faces all use points of this grid
+  std::vector<float> gains;
+  computeGains_(azimPoints, elevPoints, gains);
+  const size_t numAzim = azimPoints.size();
+  const size_t numElev = elevPoints.size();
+  std::vector<float> cosAzim(numAzim);
+  std::vector<float> sinAzim(numAzim);
+  for (size_t i = 0; i < numAzim; ++i)
   {
-    const float azim = *iiter;
-    auto nextIter = iiter + 1;
-    // azimDone condition should break iteration before this can occur
-    assert(nextIter != azimPoints.end());
-    const float azim2 = *nextIter;
-    azimDone = (nextIter + 1 == azimPoints.end());
-
-    for (std::vector<float>::const_iterator jiter = elevPoints.begin(); jiter != elevPoints.end(); ++jiter)
-    {
-      const float elev = *jiter;
-
-      // compute first point in t-strip
-      osg::Vec3f pt;
-      float gain = ComputeRadius_(azim, elev, polarity_, pt);
-      osg::Vec3f ptNorm(pt);
-      ptNorm.normalize();
-      verts->push_back(pt);
-      norms->push_back(ptNorm);
-      if (colorScale)
-        colors->push_back(colorUtils_->GainThresholdColor(static_cast<int>(gain)));
-      else
-        colors->push_back(color);
+    cosAzim[i] = cosf(azimPoints[i]);
+    sinAzim[i] = sinf(azimPoints[i]);
+  }
+  std::vector<float> cosElev(numElev);
+  std::vector<float> sinElev(numElev);
+  for (size_t j = 0; j < numElev; ++j)
+  {
+    cosElev[j] = cosf(elevPoints[j]);
+    sinElev[j] = sinf(elevPoints[j]);
+  }
 
-      // compute alternate point in t-strip
-      // TODO: this calculated result could potentially be reused in the next azim iteration; consider using an index array.
-      osg::Vec3f ptne;
-      gain = ComputeRadius_(azim2, elev, polarity_, ptne);
-      osg::Vec3f ptneNorm(ptne);
-      ptneNorm.normalize();
-      verts->push_back(ptne);
-      norms->push_back(ptneNorm);
-      if (colorScale)
-        colors->push_back(colorUtils_->GainThresholdColor(static_cast<int>(gain)));
-      else
-        colors->push_back(color);
+  verts->reserve(2 * (numAzim - 1) * numElev + 2 * (numAzim + numElev + 2));
+  norms->reserve(verts->capacity());
+  colors->reserve(verts->capacity());
+
+  for (size_t i = 0; i + 1 < numAzim; ++i)
+  {
+    for (size_t j = 0; j < numElev; ++j)
+    {
+      // compute first point in t-strip, then the alternate point at the next azimuth
+      for (size_t col = i; col <= i + 1; ++col)
+      {
+        osg::Vec3f pt;
+        const float gain = computePoint_(gains[j * numAzim + col], cosAzim[col], sinAzim[col], cosElev[j], sinElev[j], pt);
+        osg::Vec3f ptNorm(pt);
+        ptNorm.normalize();
+        verts->push_back(pt);
+        norms->push_back(ptNorm);
+        if (colorScale)
+          colors->push_back(colorUtils_->GainThresholdColor(static_cast<int>(gain)));
+        else
+          colors->push_back(color);
+      }
     }
 
     antGeom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::TRIANGLE_STRIP, lastCount, verts->size() - lastCount));
@@ -462,12 +611,12 @@ void AntennaNode::render_()
       else
         colors->push_back(color);
 
-      // reverse iteration to set correct polygon facing
+      // reverse iteration to set correct polygon facing; bottom side is the first row of the grid
       for (std::vector<float>::const_reverse_iterator iriter = azimPoints.rbegin(); iriter != azimPoints.rend(); ++iriter)
       {
-        const float azim = *iriter;
+        const size_t i = numAzim - 1 - std::distance(static_cast<std::vector<float>::const_reverse_iterator>(azimPoints.rbegin()), iriter);
         osg::Vec3f pt;
-        const float gain = ComputeRadius_(azim, elev, polarity_, pt);
+        const float gain = computePoint_(gains[i], cosAzim[i], sinAzim[i], cosElev.front(), sinElev.front(), pt);
         verts->push_back(pt);
         const osg::Vec3f& normalVec = calcNormalXY(pt);
         norms->push_back(normalVec);
@@ -504,11 +653,12 @@ void AntennaNode::render_()
       else
         colors->push_back(color);
 
+      // top side is the last row of the grid
       for (std::vector<float>::const_iterator iiter = azimPoints.begin(); iiter != azimPoints.end(); ++iiter)
       {
-        const float azim = *iiter;
+        const size_t i = std::distance(static_cast<std::vector<float>::const_iterator>(azimPoints.begin()), iiter);
         osg::Vec3f pt;
-        const float gain = ComputeRadius_(azim, elev, polarity_, pt);
+        const float gain = computePoint_(gains[(numElev - 1) * numAzim + i], cosAzim[i], sinAzim[i], cosElev.back(), sinElev.back(), pt);
         verts->push_back(pt);
         // sign change is required for top side
         const osg::Vec3f& normalVec = -calcNormalXY(pt);
@@ -551,11 +701,12 @@ void AntennaNode::render_()
       else
         colors->push_back(color);
 
+      // right side is the first column of the grid
       for (std::vector<float>::const_iterator jiter = elevPoints.begin(); jiter != elevPoints.end(); ++jiter)
       {
-        const float elev = *jiter;
+        const size_t j = std::distance(static_cast<std::vector<float>::const_iterator>(elevPoints.begin()), jiter);
         osg::Vec3f pt;
-        const float gain = ComputeRadius_(azim, elev, polarity_, pt);
+        const float gain = computePoint_(gains[j * numAzim], cosAzim.front(), sinAzim.front(), cosElev[j], sinElev[j], pt);
         verts->push_back(pt);
         const osg::Vec3f& normalVec = calcNormalXZ(pt);
         norms->push_back(normalVec);
@@ -592,11 +743,12 @@ void AntennaNode::render_()
         colors->push_back(color);
 
       // reverse iteration to set correct polygon facing
+      // left side is the last column of the grid
       for (std::vector<float>::const_reverse_iterator jriter = elevPoints.rbegin(); jriter != elevPoints.rend(); ++jriter)
       {
-        const float elev = *jriter;
+        const size_t j = numElev - 1 - std::distance(static_cast<std::vector<float>::const_reverse_iterator>(elevPoints.rbegin()), jriter);
         osg::Vec3f pt;
-        const float gain = ComputeRadius_(azim, elev, polarity_, pt);
+        const float gain = computePoint_(gains[j * numAzim + numAzim - 1], cosAzim.back(), sinAzim.back(), cosElev[j], sinElev[j], pt);
         verts->push_back(pt);
         // sign change is required for left side
         const osg::Vec3f& normalVec = -calcNormalXZ(pt);
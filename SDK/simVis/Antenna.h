@@ -22,14 +22,17 @@
 #ifndef SIMVIS_ANTENNA_H
 #define SIMVIS_ANTENNA_H
 
+#include <vector>
 #include "osg/MatrixTransform"
 #include "osgEarth/Config"
 #include "simCore/Common/Common.h"
+#include "simCore/Common/Memory.h"
 #include "simCore/EM/Constants.h"
 #include "simData/DataTypes.h"
 
 namespace simCore
 {
+  class AntennaGainParameters;
   class AntennaPattern;
 }
 
@@ -61,12 +64,20 @@ namespace simVis
     void setRange(float range);
 
     /**
-    * Configures the antenna pattern from the beam prefs
+    * Configures the antenna pattern from the beam prefs.  Pattern files are loaded through the
+    * shared EMFileCache; if the file is still being parsed in the background, the graphic is
+    * built during a later update traversal.
     * @param[in] prefs preferences to use in configuring the antenna
-    * @return flag that indicates whether the antenna graphic was rebuilt
+    * @return flag that indicates whether the antenna graphic was rebuilt, or will be rebuilt once loaded
     */
     bool setPrefs(const simData::BeamPrefs& prefs);
 
+    /** Whether the antenna pattern file is still being loaded in the background */
+    bool isLoadPending() const { return loadPending_; }
+
+    /** Completes background pattern loads during the update traversal */
+    virtual void traverse(osg::NodeVisitor& nv);
+
     /** calculate the antenna gain for given parameters */
     float PatternGain(float azim, float elev, simCore::PolarityType polarity) const;
 
@@ -97,12 +108,46 @@ namespace simVis
     */
     void drawAxes_(const osg::Vec3f& pos, const osg::Vec3f& vec);
 
-    float ComputeRadius_(float azim, float elev, simCore::PolarityType polarity, osg::Vec3f &p) const;
+    /** Returns the gain parameters for the current prefs, with azimuth and elevation set to 0 */
+    simCore::AntennaGainParameters gainParameters_() const;
+
+    /**
+    * Evaluates the pattern gain at every azimuth/elevation combination, splitting the rows
+    * across threads for large grids when the pattern supports it
+    * @param[in ] azimuths Azimuth values, radians
+    * @param[in ] elevations Elevation values, radians
+    * @param[out] gains Gains in dB, indexed [elevationIndex * azimuths.size() + azimuthIndex]
+    */
+    void computeGains_(const std::vector<float>& azimuths, const std::vector<float>& elevations, std::vector<float>& gains) const;
+
+    /**
+    * Computes the pattern point for a gain in a direction given by its sines and cosines
+    * @param[in ] gain Gain at the point, dB
+    * @param[in ] cosAzim Cosine of the azimuth
+    * @param[in ] sinAzim Sine of the azimuth
+    * @param[in ] cosElev Cosine of the elevation
+    * @param[in ] sinElev Sine of the elevation
+    * @param[out] p Point on the pattern surface
+    * @return the gain
+    */
+    float computePoint_(float gain, float cosAzim, float sinAzim, float cosElev, float sinElev, osg::Vec3f &p) const;
     void render_();
 
+    /**
+    * Polls the EMFileCache for the pattern file requested in setPrefs()
+    * @return true if the load finished, successfully or not
+    */
+    bool checkPendingLoad_();
+    /// sets the pending flag, adjusting the update traversal count as needed
+    void setLoadPending_(bool pending);
+    /// draws the pattern using lastPrefs_, if the draw type is antenna pattern
+    void redraw_();
+
   private:
-    simCore::AntennaPattern* antennaPattern_;
+    std::tr1::shared_ptr<simCore::AntennaPattern> antennaPattern_;
     bool                     loadedOK_;
+    bool                     loadPending_;
+    float                    patternFrequency_;
     std::string              patternFile_;
     simCore::PolarityType    polarity_;
 
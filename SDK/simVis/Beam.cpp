@@ -205,7 +205,8 @@ BeamNode::BeamNode(const ScenarioManager* scenario, const simData::BeamPropertie
 
 void BeamNode::updateLabel_(const simData::BeamPrefs& prefs)
 {
-  if (hasLastUpdate_)
+  // regenerate only if prefs, the applied update or the content callback changed
+  if (hasLastUpdate_ && checkLabelContentDirty_(lastUpdateFromDS_.time()))
   {
     std::string label = getEntityName(EntityNode::DISPLAY_NAME);
     if (prefs.commonprefs().labelprefs().namelength() > 0)
@@ -232,6 +233,7 @@ void BeamNode::setLabelContentCallback(LabelContentCallback* cb)
     contentCallback_ = new NullEntityCallback();
   else
     contentCallback_ = cb;
+  setLabelContentDirty();
 }
 
 LabelContentCallback* BeamNode::labelContentCallback() const
@@ -268,6 +270,7 @@ void BeamNode::setPrefs(const simData::BeamPrefs& prefs)
   }
 
   applyPrefs(prefs);
+  setLabelContentDirty();
   updateLabel_(prefs);
   lastPrefsFromDS_ = prefs;
 }
@@ -488,6 +491,8 @@ void BeamNode::applyUpdateOverrides_(bool force)
 
   // we have applied a valid update, and both lastUpdateApplied_ and lastUpdateFromDS_ are valid
   hasLastUpdate_ = true;
+  // target calculations and overrides can change the update without changing its time
+  setLabelContentDirty();
 }
 
 int BeamNode::calculateTargetBeam_(simData::BeamUpdate& targetBeamUpdate)
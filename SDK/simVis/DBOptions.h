@@ -31,6 +31,12 @@ namespace simVis
 {
   /**
   * Configuration options for the "DB" tile source driver.
+  *
+  * The driver can keep decoded tiles in a memory-bounded LRU cache, and prefetch the neighbors
+  * and children of requested tiles into it.  The cache is off by default; set decoded_cache_size_mb
+  * to enable it.  Cache statistics are published as user values on the tile source, updated every
+  * 64 tile requests: "decoded_cache_hits", "decoded_cache_misses", "decoded_cache_hit_rate" (0 to 1),
+  * "decoded_cache_size_bytes" and "prefetch_loads".
   */
   class DBOptions : public osgEarth::TileSourceOptions // header-only (no export)
   {
@@ -45,13 +51,36 @@ namespace simVis
     /** Deepest level (in .db depth) for reading data from the .db file. (immutable) */
     const osgEarth::optional<unsigned int>& deepestLevel() const { return _deepestLevel; }
 
+    /** Number of pages in the SQLite page cache of each reading connection. (mutable) */
+    osgEarth::optional<int>& cacheSizePages() { return _cacheSizePages; }
+    /** Number of pages in the SQLite page cache of each reading connection. (immutable) */
+    const osgEarth::optional<int>& cacheSizePages() const { return _cacheSizePages; }
+
+    /** Memory limit of the decoded tile cache in megabytes; 0 (default) disables the cache. (mutable) */
+    osgEarth::optional<unsigned int>& decodedCacheSizeMB() { return _decodedCacheSizeMB; }
+    /** Memory limit of the decoded tile cache in megabytes; 0 (default) disables the cache. (immutable) */
+    const osgEarth::optional<unsigned int>& decodedCacheSizeMB() const { return _decodedCacheSizeMB; }
+
+    /** Prefetch neighbors and children of requested tiles into the decoded tile cache; requires the cache. (mutable) */
+    osgEarth::optional<bool>& prefetch() { return _prefetch; }
+    /** Prefetch neighbors and children of requested tiles into the decoded tile cache; requires the cache. (immutable) */
+    const osgEarth::optional<bool>& prefetch() const { return _prefetch; }
+
+    /** Number of threads used to prefetch tiles. (mutable) */
+    osgEarth::optional<unsigned int>& prefetchThreads() { return _prefetchThreads; }
+    /** Number of threads used to prefetch tiles. (immutable) */
+    const osgEarth::optional<unsigned int>& prefetchThreads() const { return _prefetchThreads; }
+
   public:
     /**
     * Construct a new DB options structure
     * @param opt Options data from which to deserialize configuration
     */
     DBOptions(const osgEarth::ConfigOptions &opt = osgEarth::ConfigOptions())
-      : TileSourceOptions(opt)
+      : TileSourceOptions(opt),
+        _decodedCacheSizeMB(0),
+        _prefetch(false),
+        _prefetchThreads(2)
     {
       setDriver("db");
       fromConfig_(_conf);
@@ -68,6 +97,10 @@ namespace simVis
       osgEarth::Config conf = osgEarth::TileSourceOptions::getConfig();
       conf.updateIfSet("url", _url);
       conf.updateIfSet("deepest_level", _deepestLevel);
+      conf.updateIfSet("cache_size_pages", _cacheSizePages);
+      conf.updateIfSet("decoded_cache_size_mb", _decodedCacheSizeMB);
+      conf.updateIfSet("prefetch", _prefetch);
+      conf.updateIfSet("prefetch_threads", _prefetchThreads);
       return conf;
     }
 
@@ -85,10 +118,18 @@ namespace simVis
     {
       conf.getIfSet("url", _url);
       conf.getIfSet("deepest_level", _deepestLevel);
+      conf.getIfSet("cache_size_pages", _cacheSizePages);
+      conf.getIfSet("decoded_cache_size_mb", _decodedCacheSizeMB);
+      conf.getIfSet("prefetch", _prefetch);
+      conf.getIfSet("prefetch_threads", _prefetchThreads);
     }
 
     osgEarth::optional<osgEarth::URI> _url;
     osgEarth::optional<unsigned int> _deepestLevel;
+    osgEarth::optional<int> _cacheSizePages;
+    osgEarth::optional<unsigned int> _decodedCacheSizeMB;
+    osgEarth::optional<bool> _prefetch;
+    osgEarth::optional<unsigned int> _prefetchThreads;
   };
 }
 
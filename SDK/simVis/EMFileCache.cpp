@@ -0,0 +1,287 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
+#include "simVis/EMFileCache.h"
+
+namespace simVis {
+
+/** Maximum number of background threads used to parse files */
+static const unsigned int MAX_LOADER_THREADS = 4;
+
+/** Loader thread; pulls keys from the owner's queue until shutdown */
+class EMFileCache::LoaderThread : public OpenThreads::Thread
+{
+public:
+  explicit LoaderThread(EMFileCache& owner)
+    : owner_(owner)
+  {
+  }
+
+  virtual void run()
+  {
+    Key key;
+    while (owner_.nextQueued_(key))
+    {
+      Entry entry;
+      EMFileCache::load_(key, entry);
+      owner_.store_(key, entry);
+    }
+  }
+
+private:
+  EMFileCache& owner_;
+};
+
+//------------------------------------------------------------------------
+
+bool EMFileCache::Key::operator<(const Key& other) const
+{
+  if (isRcs_ != other.isRcs_)
+    return isRcs_ < other.isRcs_;
+  if (freq_ != other.freq_)
+    return freq_ < other.freq_;
+  return filename_ < other.filename_;
+}
+
+//------------------------------------------------------------------------
+
+static OpenThreads::Mutex s_instMutex;
+static OpenThreads::Mutex s_evaluationMutex(OpenThreads::Mutex::MUTEX_RECURSIVE);
+
+EMFileCache* EMFileCache::instance()
+{
+  // Lock on every call; an unguarded read of s_inst is not safe without memory barriers
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(s_instMutex);
+  static EMFileCache* s_inst = NULL;
+  if (!s_inst)
+    s_inst = new EMFileCache();
+  return s_inst;
+}
+
+OpenThreads::Mutex& EMFileCache::evaluationMutex()
+{
+  return s_evaluationMutex;
+}
+
+EMFileCache::EMFileCache()
+  : done_(false)
+{
+}
+
+EMFileCache::~EMFileCache()
+{
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    done_ = true;
+    queued_.broadcast();
+  }
+  for (std::vector<LoaderThread*>::const_iterator i = threads_.begin(); i != threads_.end(); ++i)
+  {
+    (*i)->join();
+    delete *i;
+  }
+}
+
+simCore::AntennaPatternPtr EMFileCache::antennaPattern(const std::string& filename, float freq)
+{
+  return get_(makeKey_(false, filename, freq)).pattern_;
+}
+
+EMFileCache::Status EMFileCache::requestAntennaPattern(const std::string& filename, float freq, simCore::AntennaPatternPtr& pattern)
+{
+  const Entry entry = request_(makeKey_(false, filename, freq));
+  if (entry.state_ == STATE_LOADED)
+  {
+    pattern = entry.pattern_;
+    return STATUS_LOADED;
+  }
+  return (entry.state_ == STATE_FAILED) ? STATUS_FAILED : STATUS_PENDING;
+}
+
+simCore::RadarCrossSectionPtr EMFileCache::rcs(const std::string& filename)
+{
+  return get_(makeKey_(true, filename, 0.f)).rcs_;
+}
+
+EMFileCache::Status EMFileCache::requestRcs(const std::string& filename, simCore::RadarCrossSectionPtr& rcs)
+{
+  const Entry entry = request_(makeKey_(true, filename, 0.f));
+  if (entry.state_ == STATE_LOADED)
+  {
+    rcs = entry.rcs_;
+    return STATUS_LOADED;
+  }
+  return (entry.state_ == STATE_FAILED) ? STATUS_FAILED : STATUS_PENDING;
+}
+
+void EMFileCache::clear()
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  queue_.clear();
+  // Entries being loaded stay, so that threads waiting on them are released by store_()
+  EntryMap::iterator i = entries_.begin();
+  while (i != entries_.end())
+  {
+    if (i->second.state_ == STATE_LOADING)
+      ++i;
+    else
+      entries_.erase(i++);
+  }
+}
+
+size_t EMFileCache::size() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return entries_.size();
+}
+
+EMFileCache::Key EMFileCache::makeKey_(bool isRcs, const std::string& filename, float freq)
+{
+  Key key;
+  key.isRcs_ = isRcs;
+  key.filename_ = filename;
+  key.freq_ = freq;
+  return key;
+}
+
+int64_t EMFileCache::modTime_(const std::string& filename)
+{
+  // Algorithm patterns are not files and have no modification time
+  struct stat buf;
+  return (stat(filename.c_str(), &buf) == 0) ? static_cast<int64_t>(buf.st_mtime) : 0;
+}
+
+void EMFileCache::load_(const Key& key, Entry& entry)
+{
+  // Read the time before parsing, so that an edit made during the parse is reloaded later
+  entry.modTime_ = modTime_(key.filename_);
+  if (key.isRcs_)
+  {
+    entry.rcs_.reset(simCore::RcsFileParser::loadRCSFile(key.filename_));
+    entry.state_ = (entry.rcs_ ? STATE_LOADED : STATE_FAILED);
+  }
+  else
+  {
+    entry.pattern_.reset(simCore::loadPatternFile(key.filename_, key.freq_));
+    entry.state_ = (entry.pattern_ ? STATE_LOADED : STATE_FAILED);
+  }
+}
+
+EMFileCache::Entry EMFileCache::get_(const Key& key)
+{
+  const int64_t modTime = modTime_(key.filename_);
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    EntryMap::iterator i = entries_.find(key);
+    if (i != entries_.end())
+    {
+      // Another thread is parsing the file; wait for it rather than parsing it twice
+      while (i != entries_.end() && i->second.state_ == STATE_LOADING)
+      {
+        loaded_.wait(&mutex_);
+        i = entries_.find(key);
+      }
+      if (i != entries_.end() && i->second.state_ != STATE_QUEUED && i->second.modTime_ == modTime)
+        return i->second;
+    }
+
+    // Not loaded, stale, or still waiting in the queue; take it and load it on this thread
+    for (std::deque<Key>::iterator queued = queue_.begin(); queued != queue_.end(); ++queued)
+    {
+      if (!(*queued < key) && !(key < *queued))
+      {
+        queue_.erase(queued);
+        break;
+      }
+    }
+    entries_[key].state_ = STATE_LOADING;
+  }
+
+  Entry entry;
+  load_(key, entry);
+  store_(key, entry);
+  return entry;
+}
+
+EMFileCache::Entry EMFileCache::request_(const Key& key)
+{
+  const int64_t modTime = modTime_(key.filename_);
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  EntryMap::iterator i = entries_.find(key);
+  if (i != entries_.end())
+  {
+    // Pending loads read the file when they start, so they are never stale
+    if (i->second.state_ == STATE_QUEUED || i->second.state_ == STATE_LOADING || i->second.modTime_ == modTime)
+      return i->second;
+  }
+
+  // Missing, or the file changed since it was parsed; the new load replaces the old entry
+  Entry& entry = entries_[key];
+  entry = Entry();
+  entry.state_ = STATE_QUEUED;
+  queue_.push_back(key);
+  startThreads_();
+  queued_.signal();
+  return entry;
+}
+
+void EMFileCache::store_(const Key& key, const Entry& entry)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  entries_[key] = entry;
+  loaded_.broadcast();
+}
+
+bool EMFileCache::nextQueued_(Key& key)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  while (queue_.empty() && !done_)
+    queued_.wait(&mutex_);
+  if (done_)
+    return false;
+  key = queue_.front();
+  queue_.pop_front();
+  entries_[key].state_ = STATE_LOADING;
+  return true;
+}
+
+void EMFileCache::startThreads_()
+{
+  if (!threads_.empty())
+    return;
+  // Leave a processor for the render thread
+  const int numProcessors = OpenThreads::GetNumberOfProcessors();
+  unsigned int numThreads = (numProcessors > 1) ? static_cast<unsigned int>(numProcessors - 1) : 1;
+  if (numThreads > MAX_LOADER_THREADS)
+    numThreads = MAX_LOADER_THREADS;
+  for (unsigned int k = 0; k < numThreads; ++k)
+  {
+    LoaderThread* thread = new LoaderThread(*this);
+    threads_.push_back(thread);
+    thread->start();
+  }
+}
+
+} // namespace simVis
@@ -0,0 +1,187 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_EMFILECACHE_H
+#define SIMVIS_EMFILECACHE_H
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "OpenThreads/Condition"
+#include "OpenThreads/Mutex"
+#include "simCore/Common/Common.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/EM/RadarCrossSection.h"
+
+namespace simVis
+{
+
+/**
+ * Process-wide cache of loaded antenna pattern and RCS files.
+ *
+ * Beams and platforms frequently share the same pattern or RCS file.  The cache
+ * parses each file once and hands out shared instances.  Entries are keyed on the
+ * file name and (for antenna patterns) the frequency passed to the loader.  Each
+ * entry records the modification time of the file it was parsed from; an entry
+ * whose file has since changed on disk is replaced by a new load on the next request.
+ *
+ * Files can be loaded synchronously, or requested without blocking, in which case
+ * they are parsed on a small pool of background threads and the caller polls until
+ * the load completes.  All methods are thread safe.
+ *
+ * Shared instances must be treated as read-only.  Their gain and RCS accessors
+ * update internal caches, so hold evaluationMutex() while calling them.
+ */
+class SDKVIS_EXPORT EMFileCache
+{
+public:
+  /** Result of a non-blocking request */
+  enum Status
+  {
+    STATUS_LOADED = 0,  ///< The file is loaded and the output pointer is set
+    STATUS_PENDING,     ///< The file is being parsed in the background; request again later
+    STATUS_FAILED       ///< The file could not be loaded
+  };
+
+  /** Retrieves the process-wide instance */
+  static EMFileCache* instance();
+
+  /**
+   * Returns the recursive lock that serializes evaluation of shared instances, such as
+   * AntennaPattern::gain() and minMaxGain(), or RadarCrossSection::RCSdB() and RCSdBGrid().
+   */
+  static OpenThreads::Mutex& evaluationMutex();
+
+  /**
+   * Retrieves an antenna pattern, loading it on the calling thread if needed.  If the
+   * pattern is already being loaded in the background, waits for that load to finish.
+   * @param filename Pattern file name, or one of the ANTENNA_STRING_ALGORITHM_* names
+   * @param freq Frequency value to pass to simCore::loadPatternFile()
+   * @return Shared pattern, or NULL on failure
+   */
+  simCore::AntennaPatternPtr antennaPattern(const std::string& filename, float freq);
+
+  /**
+   * Retrieves an antenna pattern without blocking.  Starts a background load if the
+   * pattern is not yet cached.
+   * @param[in ] filename Pattern file name, or one of the ANTENNA_STRING_ALGORITHM_* names
+   * @param[in ] freq Frequency value to pass to simCore::loadPatternFile()
+   * @param[out] pattern Shared pattern; only set if the return value is STATUS_LOADED
+   * @return Status of the request
+   */
+  Status requestAntennaPattern(const std::string& filename, float freq, simCore::AntennaPatternPtr& pattern);
+
+  /**
+   * Retrieves an RCS, loading it on the calling thread if needed.  If the RCS is
+   * already being loaded in the background, waits for that load to finish.
+   * @param filename Full path to the RCS file
+   * @return Shared RCS, or NULL on failure
+   */
+  simCore::RadarCrossSectionPtr rcs(const std::string& filename);
+
+  /**
+   * Retrieves an RCS without blocking.  Starts a background load if the RCS is not yet cached.
+   * @param[in ] filename Full path to the RCS file
+   * @param[out] rcs Shared RCS; only set if the return value is STATUS_LOADED
+   * @return Status of the request
+   */
+  Status requestRcs(const std::string& filename, simCore::RadarCrossSectionPtr& rcs);
+
+  /**
+   * Removes all loaded and queued entries, such as when loading a new data file.  Instances
+   * already handed out remain valid.  Loads in progress complete normally.
+   */
+  void clear();
+
+  /** Returns the number of entries in the cache, including failed and pending loads */
+  size_t size() const;
+
+private:
+  EMFileCache();
+  virtual ~EMFileCache();
+
+  /** Identifies one loaded file */
+  struct Key
+  {
+    bool isRcs_;
+    std::string filename_;
+    float freq_;
+
+    /** Strict weak ordering for map use */
+    bool operator<(const Key& other) const;
+  };
+
+  /** Load state of one cache entry */
+  enum State
+  {
+    STATE_QUEUED,
+    STATE_LOADING,
+    STATE_LOADED,
+    STATE_FAILED
+  };
+
+  /** Holds the result of loading one file */
+  struct Entry
+  {
+    State state_;
+    /** Modification time of the file when it was parsed, 0 for algorithm patterns */
+    int64_t modTime_;
+    simCore::AntennaPatternPtr pattern_;
+    simCore::RadarCrossSectionPtr rcs_;
+  };
+
+  class LoaderThread;
+
+  /** Builds the key for a file */
+  static Key makeKey_(bool isRcs, const std::string& filename, float freq);
+  /** Returns the current modification time of the file, or 0 if it is not a file */
+  static int64_t modTime_(const std::string& filename);
+  /** Parses the file described by the key; called without the lock held */
+  static void load_(const Key& key, Entry& entry);
+
+  /** Returns the entry for the key, loading it synchronously if it is missing or stale */
+  Entry get_(const Key& key);
+  /** Returns the entry for the key, queuing a background load if it is missing or stale */
+  Entry request_(const Key& key);
+  /** Stores the result of a load and wakes any waiting threads */
+  void store_(const Key& key, const Entry& entry);
+  /** Called by loader threads to pull the next key to load; returns false on shutdown */
+  bool nextQueued_(Key& key);
+  /** Starts the loader threads if they are not running; requires the lock */
+  void startThreads_();
+
+  typedef std::map<Key, Entry> EntryMap;
+  EntryMap entries_;
+  std::deque<Key> queue_;
+  std::vector<LoaderThread*> threads_;
+  bool done_;
+
+  mutable OpenThreads::Mutex mutex_;
+  /** Signaled when a key is queued */
+  OpenThreads::Condition queued_;
+  /** Signaled when a load completes */
+  OpenThreads::Condition loaded_;
+};
+
+} // namespace simVis
+
+#endif // SIMVIS_EMFILECACHE_H
@@ -88,7 +88,9 @@ void CoordSurfaceClamping::setMapNode(const osgEarth::MapNode* map)
 /////////////////////////////////////////////////////////////////////////////////
 
 EntityNode::EntityNode(simData::DataStore::ObjectType type, Locator* locator)
-  : type_(type)
+  : type_(type),
+    labelContentDirty_(true),
+    labelContentTime_(-1.0)
 {
   setNodeMask(0);  // Draw is off until a valid update is received
   setLocator(locator);
@@ -99,6 +101,15 @@ EntityNode::~EntityNode()
   setLocator(NULL);
 }
 
+bool EntityNode::checkLabelContentDirty_(double updateTime)
+{
+  if (!labelContentDirty_ && updateTime == labelContentTime_)
+    return false;
+  labelContentDirty_ = false;
+  labelContentTime_ = updateTime;
+  return true;
+}
+
 bool EntityNode::isVisible() const
 {
   return getNodeMask() != 0;
@@ -235,6 +235,13 @@ namespace simVis
     */
     virtual void flush() = 0;
 
+    /**
+    * Marks the label text as out of date.  Entities regenerate their label text only when
+    * an input changes: preferences, the applied update, the label content callback or
+    * category data.  Call this when label content depends on some other input.
+    */
+    void setLabelContentDirty() { labelContentDirty_ = true; }
+
     /**
     * Returns a range value (meters) used for visualization.  Will return zero for platforms and projectors.
     */
@@ -249,9 +256,20 @@ namespace simVis
   protected:
     virtual ~EntityNode();
 
+    /**
+    * Tests whether the label text needs to be regenerated, and marks it as current.
+    * @param updateTime Time of the update that the label text describes
+    * @return true if the label is dirty or the update time changed since the last call
+    */
+    bool checkLabelContentDirty_(double updateTime);
+
   private:
     simData::DataStore::ObjectType type_;
     osg::ref_ptr<Locator> locator_;
+    /// true when the label text must be regenerated regardless of update time
+    bool labelContentDirty_;
+    /// time of the update described by the current label text
+    double labelContentTime_;
   };
 
   /** Vector of EntityNode ref_ptr */
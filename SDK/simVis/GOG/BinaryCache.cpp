@@ -0,0 +1,416 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "osgDB/FileNameUtils"
+#include "simVis/GOG/Parser.h"
+#include "simVis/GOG/BinaryCache.h"
+
+namespace simVis { namespace GOG
+{
+
+namespace
+{
+
+/** Magic number identifying a GOG cache file; also detects byte order mismatches */
+static const uint32_t CACHE_MAGIC = 0x43474F47; // "GOGC"
+/** Increment when the layout of the cache file changes */
+static const uint32_t CACHE_VERSION = 2;
+/** Extension used for cache files */
+static const std::string CACHE_EXTENSION = ".gogc";
+
+/** 64 bit FNV-1a hash of a string, used to generate unique cache file names */
+uint64_t hashString(const std::string& str)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (std::string::const_iterator i = str.begin(); i != str.end(); ++i)
+  {
+    hash ^= static_cast<unsigned char>(*i);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/** Appends POD values and length-prefixed strings to a byte buffer */
+class Writer
+{
+public:
+  explicit Writer(std::string& buffer) : buffer_(buffer) {}
+
+  template <typename T>
+  void write(const T& value)
+  {
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeString(const std::string& value)
+  {
+    write(static_cast<uint32_t>(value.size()));
+    buffer_.append(value);
+  }
+
+  void writeConfig(const osgEarth::Config& config)
+  {
+    writeString(config.key());
+    writeString(config.value());
+    const osgEarth::ConfigSet& children = config.children();
+    write(static_cast<uint32_t>(children.size()));
+    for (osgEarth::ConfigSet::const_iterator i = children.begin(); i != children.end(); ++i)
+      writeConfig(*i);
+  }
+
+private:
+  std::string& buffer_;
+};
+
+/** Reads values written by the Writer from an in-memory buffer, with bounds checking */
+class Reader
+{
+public:
+  Reader(const char* data, size_t size) : data_(data), size_(size), pos_(0), ok_(true) {}
+
+  bool ok() const { return ok_; }
+  bool atEnd() const { return pos_ == size_; }
+  size_t remaining() const { return size_ - pos_; }
+
+  template <typename T>
+  bool read(T& value)
+  {
+    if (!ok_ || size_ - pos_ < sizeof(T))
+      return fail_();
+    memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string& value)
+  {
+    uint32_t len = 0;
+    if (!read(len) || size_ - pos_ < len)
+      return fail_();
+    value.assign(data_ + pos_, len);
+    pos_ += len;
+    return true;
+  }
+
+  bool readConfig(osgEarth::Config& config, unsigned int depth = 0)
+  {
+    // Config trees produced by the parser are shallow; deep trees indicate corruption
+    if (depth > 16)
+      return fail_();
+    std::string key;
+    std::string value;
+    uint32_t numChildren = 0;
+    if (!readString(key) || !readString(value) || !read(numChildren))
+      return false;
+    config = osgEarth::Config(key, value);
+    for (uint32_t k = 0; k < numChildren; ++k)
+    {
+      osgEarth::Config child;
+      if (!readConfig(child, depth + 1))
+        return false;
+      config.add(child);
+    }
+    return true;
+  }
+
+private:
+  bool fail_()
+  {
+    ok_ = false;
+    return false;
+  }
+
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  bool ok_;
+};
+
+/** Recursive comparison of two Config trees, reporting the path of the first difference */
+bool compareConfig(const osgEarth::Config& expected, const osgEarth::Config& actual, const std::string& path, std::string& difference)
+{
+  const std::string here = path.empty() ? expected.key() : (path + "/" + expected.key());
+  if (expected.key() != actual.key())
+  {
+    difference = here + ": key \"" + actual.key() + "\" does not match";
+    return false;
+  }
+  if (expected.value() != actual.value())
+  {
+    difference = here + ": value \"" + actual.value() + "\" does not match \"" + expected.value() + "\"";
+    return false;
+  }
+  const osgEarth::ConfigSet& expectedChildren = expected.children();
+  const osgEarth::ConfigSet& actualChildren = actual.children();
+  if (expectedChildren.size() != actualChildren.size())
+  {
+    std::ostringstream os;
+    os << here << ": " << actualChildren.size() << " children, expected " << expectedChildren.size();
+    difference = os.str();
+    return false;
+  }
+  osgEarth::ConfigSet::const_iterator a = actualChildren.begin();
+  for (osgEarth::ConfigSet::const_iterator e = expectedChildren.begin(); e != expectedChildren.end(); ++e, ++a)
+  {
+    if (!compareConfig(*e, *a, here, difference))
+      return false;
+  }
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------
+
+BinaryCache::BinaryCache(const std::string& cacheDirectory)
+  : cacheDirectory_(cacheDirectory)
+{
+}
+
+BinaryCache::~BinaryCache()
+{
+}
+
+const std::string& BinaryCache::cacheDirectory() const
+{
+  return cacheDirectory_;
+}
+
+std::string BinaryCache::cacheFileName(const std::string& sourceFile) const
+{
+  // Simple name is kept for readability; hash of the full path guarantees uniqueness
+  std::ostringstream os;
+  os << osgDB::getSimpleFileName(sourceFile) << "." << std::hex << hashString(osgDB::getRealPath(sourceFile)) << CACHE_EXTENSION;
+  return osgDB::concatPaths(cacheDirectory_, os.str());
+}
+
+bool BinaryCache::fileStats(const std::string& fileName, uint64_t& size, int64_t& modTime)
+{
+  struct stat buf;
+  if (stat(fileName.c_str(), &buf) != 0)
+    return false;
+  size = static_cast<uint64_t>(buf.st_size);
+  modTime = static_cast<int64_t>(buf.st_mtime);
+  return true;
+}
+
+bool BinaryCache::read(const std::string& sourceFile, const std::string& signature, osgEarth::Config& config, std::vector<GogMetaData>& metaData,
+  ParseErrors& errors) const
+{
+  uint64_t sourceSize = 0;
+  int64_t sourceTime = 0;
+  if (!fileStats(sourceFile, sourceSize, sourceTime))
+    return false;
+
+  // Pull the whole file into memory with a single sequential read
+  std::ifstream in(cacheFileName(sourceFile).c_str(), std::ios::in | std::ios::binary);
+  if (!in)
+    return false;
+  in.seekg(0, std::ios::end);
+  const std::streamoff length = in.tellg();
+  if (length <= 0)
+    return false;
+  in.seekg(0, std::ios::beg);
+  std::vector<char> buffer(static_cast<size_t>(length));
+  if (!in.read(&buffer[0], length))
+    return false;
+
+  Reader reader(&buffer[0], buffer.size());
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t size = 0;
+  int64_t modTime = 0;
+  std::string cachedSignature;
+  std::string path;
+  if (!reader.read(magic) || magic != CACHE_MAGIC ||
+    !reader.read(version) || version != CACHE_VERSION ||
+    !reader.read(size) || size != sourceSize ||
+    !reader.read(modTime) || modTime != sourceTime ||
+    !reader.readString(cachedSignature) || cachedSignature != signature ||
+    !reader.readString(path) || path != osgDB::getRealPath(sourceFile))
+    return false;
+
+  // Each shape record is at least 12 bytes; reject counts the file cannot hold before allocating
+  uint32_t numShapes = 0;
+  if (!reader.read(numShapes) || numShapes > reader.remaining() / 12)
+    return false;
+  std::vector<GogMetaData> newMetaData(numShapes);
+  for (uint32_t k = 0; k < numShapes; ++k)
+  {
+    GogMetaData& md = newMetaData[k];
+    int32_t shape = 0;
+    uint32_t setFields = 0;
+    if (!reader.read(shape) || !reader.read(setFields) || !reader.readString(md.metadata))
+      return false;
+    md.shape = static_cast<GogShape>(shape);
+    md.clearSetFields();
+    for (int field = GOG_LINE_WIDTH_SET; field <= GOG_LINE_PROJECTION_SET; ++field)
+    {
+      if ((setFields & (0x01 << field)) != 0)
+        md.setExplicitly(static_cast<GogSerializableField>(field));
+    }
+  }
+
+  uint32_t numErrors = 0;
+  if (!reader.read(numErrors) || numErrors > reader.remaining() / 12)
+    return false;
+  ParseErrors newErrors;
+  for (uint32_t k = 0; k < numErrors; ++k)
+  {
+    uint64_t lineNumber = 0;
+    std::string text;
+    if (!reader.read(lineNumber) || !reader.readString(text))
+      return false;
+    newErrors.push_back(std::make_pair(static_cast<size_t>(lineNumber), text));
+  }
+
+  osgEarth::Config newConfig;
+  if (!reader.readConfig(newConfig) || !reader.atEnd() || newConfig.children().size() != numShapes)
+    return false;
+
+  config = newConfig;
+  metaData.swap(newMetaData);
+  errors.swap(newErrors);
+  return true;
+}
+
+bool BinaryCache::write(const std::string& sourceFile, const std::string& signature, const osgEarth::Config& config, const std::vector<GogMetaData>& metaData,
+  const ParseErrors& errors) const
+{
+  uint64_t sourceSize = 0;
+  int64_t sourceTime = 0;
+  if (!fileStats(sourceFile, sourceSize, sourceTime))
+    return false;
+
+  std::string buffer;
+  Writer writer(buffer);
+  writer.write(CACHE_MAGIC);
+  writer.write(CACHE_VERSION);
+  writer.write(sourceSize);
+  writer.write(sourceTime);
+  writer.writeString(signature);
+  writer.writeString(osgDB::getRealPath(sourceFile));
+
+  writer.write(static_cast<uint32_t>(metaData.size()));
+  for (std::vector<GogMetaData>::const_iterator i = metaData.begin(); i != metaData.end(); ++i)
+  {
+    uint32_t setFields = 0;
+    for (int field = GOG_LINE_WIDTH_SET; field <= GOG_LINE_PROJECTION_SET; ++field)
+    {
+      if (i->isSetExplicitly(static_cast<GogSerializableField>(field)))
+        setFields |= (0x01 << field);
+    }
+    writer.write(static_cast<int32_t>(i->shape));
+    writer.write(setFields);
+    writer.writeString(i->metadata);
+  }
+  writer.write(static_cast<uint32_t>(errors.size()));
+  for (ParseErrors::const_iterator i = errors.begin(); i != errors.end(); ++i)
+  {
+    writer.write(static_cast<uint64_t>(i->first));
+    writer.writeString(i->second);
+  }
+  writer.writeConfig(config);
+
+  // Write to a temporary file first so that a concurrent reader never sees a partial entry
+  const std::string cacheFile = cacheFileName(sourceFile);
+  const std::string tempFile = cacheFile + ".tmp";
+  {
+    std::ofstream out(tempFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    out.write(buffer.data(), buffer.size());
+    if (!out)
+    {
+      out.close();
+      ::remove(tempFile.c_str());
+      return false;
+    }
+  }
+  // rename() does not overwrite on all platforms
+  ::remove(cacheFile.c_str());
+  if (::rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+  {
+    ::remove(tempFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool BinaryCache::compare(const osgEarth::Config& expectedConfig, const std::vector<GogMetaData>& expectedMetaData,
+  const osgEarth::Config& actualConfig, const std::vector<GogMetaData>& actualMetaData, std::string& difference)
+{
+  difference.clear();
+  if (expectedMetaData.size() != actualMetaData.size() || expectedConfig.children().size() != actualConfig.children().size())
+  {
+    std::ostringstream os;
+    os << "Cached shape count " << actualMetaData.size() << " does not match parsed shape count " << expectedMetaData.size();
+    difference = os.str();
+    return false;
+  }
+
+  const osgEarth::ConfigSet& expectedShapes = expectedConfig.children();
+  const osgEarth::ConfigSet& actualShapes = actualConfig.children();
+  osgEarth::ConfigSet::const_iterator actual = actualShapes.begin();
+  size_t index = 0;
+  for (osgEarth::ConfigSet::const_iterator expected = expectedShapes.begin(); expected != expectedShapes.end(); ++expected, ++actual, ++index)
+  {
+    const GogMetaData& expectedMd = expectedMetaData[index];
+    const GogMetaData& actualMd = actualMetaData[index];
+    std::ostringstream prefix;
+    prefix << "Shape " << index << " (" << Parser::getKeywordFromShape(expectedMd.shape) << "): ";
+
+    if (expectedMd.shape != actualMd.shape)
+    {
+      difference = prefix.str() + "cached shape type \"" + Parser::getKeywordFromShape(actualMd.shape) + "\" does not match";
+      return false;
+    }
+    if (expectedMd.metadata != actualMd.metadata)
+    {
+      difference = prefix.str() + "meta data does not match";
+      return false;
+    }
+    for (int field = GOG_LINE_WIDTH_SET; field <= GOG_LINE_PROJECTION_SET; ++field)
+    {
+      const GogSerializableField f = static_cast<GogSerializableField>(field);
+      if (expectedMd.isSetExplicitly(f) != actualMd.isSetExplicitly(f))
+      {
+        difference = prefix.str() + "explicitly set fields do not match";
+        return false;
+      }
+    }
+    std::string configDifference;
+    if (!compareConfig(*expected, *actual, "", configDifference))
+    {
+      difference = prefix.str() + configDifference;
+      return false;
+    }
+  }
+  return true;
+}
+
+} } // namespace simVis::GOG
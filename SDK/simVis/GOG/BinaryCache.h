@@ -0,0 +1,124 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_GOG_BINARYCACHE_H
+#define SIMVIS_GOG_BINARYCACHE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simVis/GOG/GOGNode.h"
+#include "osgEarth/Config"
+
+namespace simVis { namespace GOG
+{
+  /**
+   * Compact binary cache of parsed GOG files.
+   *
+   * The text parse of a GOG file (tokenizing, lower-casing, angle and color
+   * conversion) produces an osgEarth::Config tree and a parallel vector of
+   * GogMetaData.  The BinaryCache stores that intermediate result in a single
+   * file per GOG source, keyed on the source path, its size and its modification
+   * time, so that subsequent loads are a single sequential read followed by a
+   * decode of length-prefixed records.  Resolved colors are stored as part of the
+   * Config tree; follow data is regenerated by the GOGRegistry from the Config.
+   *
+   * A caller-supplied signature (e.g. the Parser's color table) is also
+   * stored, and a mismatch invalidates the cache entry.  Errors reported by the
+   * text parse are stored with the entry so they can be reported again on a hit.
+   */
+  class SDKVIS_EXPORT BinaryCache
+  {
+  public:
+    /** Line number and text of each error reported by the text parse */
+    typedef std::vector<std::pair<size_t, std::string> > ParseErrors;
+
+    /**
+     * Constructs a cache that stores its files in the given directory
+     * @param cacheDirectory Directory for cache files; must already exist
+     */
+    explicit BinaryCache(const std::string& cacheDirectory);
+    virtual ~BinaryCache();
+
+    /** Retrieves the directory in which cache files are stored */
+    const std::string& cacheDirectory() const;
+
+    /**
+     * Returns the full path of the cache file that would hold the given source
+     * @param sourceFile Full path to the GOG file
+     * @return Full path to the cache file in the cache directory
+     */
+    std::string cacheFileName(const std::string& sourceFile) const;
+
+    /**
+     * Reads the cache entry for the given source file.  Fails if there is no entry,
+     * or if the source path, size, modification time or signature do not match.
+     * @param[in ] sourceFile Full path to the GOG file
+     * @param[in ] signature  Signature of the parser settings that produced the entry
+     * @param[out] config     Config tree as produced by the text parser
+     * @param[out] metaData   Meta data parallel to the Config children
+     * @param[out] errors     Errors reported by the text parse that produced the entry
+     * @return True if a valid entry was read, false otherwise
+     */
+    bool read(const std::string& sourceFile, const std::string& signature, osgEarth::Config& config, std::vector<GogMetaData>& metaData,
+      ParseErrors& errors) const;
+
+    /**
+     * Writes the cache entry for the given source file, replacing any existing entry.
+     * @param sourceFile Full path to the GOG file
+     * @param signature  Signature of the parser settings that produced the data
+     * @param config     Config tree as produced by the text parser
+     * @param metaData   Meta data parallel to the Config children
+     * @param errors     Errors reported by the text parse
+     * @return True on success, false if the source cannot be found or the cache cannot be written
+     */
+    bool write(const std::string& sourceFile, const std::string& signature, const osgEarth::Config& config, const std::vector<GogMetaData>& metaData,
+      const ParseErrors& errors) const;
+
+    /**
+     * Compares two parse results shape by shape.
+     * @param[in ] expectedConfig   Freshly parsed Config
+     * @param[in ] expectedMetaData Freshly parsed meta data
+     * @param[in ] actualConfig     Config read from the cache
+     * @param[in ] actualMetaData   Meta data read from the cache
+     * @param[out] difference       Description of the first difference found
+     * @return True if both results are identical
+     */
+    static bool compare(const osgEarth::Config& expectedConfig, const std::vector<GogMetaData>& expectedMetaData,
+      const osgEarth::Config& actualConfig, const std::vector<GogMetaData>& actualMetaData, std::string& difference);
+
+    /**
+     * Retrieves the size and modification time of a file
+     * @param[in ] fileName File to query
+     * @param[out] size     Size of the file in bytes
+     * @param[out] modTime  Modification time, in seconds since epoch
+     * @return True if the file exists
+     */
+    static bool fileStats(const std::string& fileName, uint64_t& size, int64_t& modTime);
+
+  private:
+    std::string cacheDirectory_;
+  };
+
+} } // namespace simVis::GOG
+
+#endif // SIMVIS_GOG_BINARYCACHE_H
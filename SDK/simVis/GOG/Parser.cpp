@@ -19,6 +19,7 @@
  * disclose, or release this software.
  *
  */
+#include <fstream>
 #include <iomanip>
 #include <set>
 
@@ -33,6 +34,7 @@
 #include "simCore/Calc/Angle.h"
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/Mgrs.h"
+#include "simVis/GOG/BinaryCache.h"
 #include "simVis/GOG/GogNodeInterface.h"
 #include "simVis/GOG/Parser.h"
 #include "simVis/GOG/Utils.h"
@@ -68,7 +70,8 @@ class NotifyErrorHandler : public ErrorHandler
 
 Parser::Parser(osgEarth::MapNode* mapNode) :
 mapNode_(mapNode),
-registry_(mapNode)
+registry_(mapNode),
+parseErrors_(NULL)
 {
   context_.errorHandler_.reset(new NotifyErrorHandler);
   initGogColors_();
@@ -76,7 +79,8 @@ registry_(mapNode)
 
 Parser::Parser(const GOGRegistry& reg) :
 mapNode_(reg.getMapNode()),
-registry_(reg)
+registry_(reg),
+parseErrors_(NULL)
 {
   context_.errorHandler_.reset(new NotifyErrorHandler);
   initGogColors_();
@@ -1086,10 +1090,111 @@ bool Parser::loadGOGs(std::istream& input, const GOGNodeType& nodeType, OverlayN
   return createGOGs(input, nodeType, output, followData);
 }
 
+void Parser::setBinaryCacheDirectory(const std::string& directory)
+{
+  binaryCacheDirectory_ = directory;
+}
+
+const std::string& Parser::binaryCacheDirectory() const
+{
+  return binaryCacheDirectory_;
+}
+
+std::string Parser::cacheSignature_() const
+{
+  // Colors are resolved to HTML strings during parse_(), so the color table is part of the cached output
+  std::ostringstream os;
+  for (std::map<std::string, osgEarth::Symbology::Color>::const_iterator i = colors_.begin(); i != colors_.end(); ++i)
+    os << i->first << "=" << i->second.toHTML() << ";";
+  return os.str();
+}
+
+bool Parser::loadGOGs(const std::string& filename, const GOGNodeType& nodeType, OverlayNodeVector& output, std::vector<GogFollowData>& followData) const
+{
+  Config conf;
+  std::vector<GogMetaData> metaData;
+
+  if (!binaryCacheDirectory_.empty())
+  {
+    const BinaryCache cache(binaryCacheDirectory_);
+    const std::string signature = cacheSignature_();
+    BinaryCache::ParseErrors errors;
+    if (cache.read(filename, signature, conf, metaData, errors))
+    {
+      // Report the errors of the text parse that produced the entry
+      for (BinaryCache::ParseErrors::const_iterator i = errors.begin(); i != errors.end(); ++i)
+        printError_(i->first, i->second);
+    }
+    else
+    {
+      std::ifstream input(filename.c_str());
+      if (!input)
+        return false;
+      parseErrors_ = &errors;
+      const bool parsed = parse_(input, conf, metaData);
+      parseErrors_ = NULL;
+      if (!parsed)
+        return false;
+      if (!cache.write(filename, signature, conf, metaData, errors))
+        SIM_WARN << "Unable to write GOG cache file for " << filename << std::endl;
+    }
+    return createGOGs_(conf, nodeType, metaData, output, followData);
+  }
+
+  std::ifstream input(filename.c_str());
+  if (!input)
+    return false;
+  return createGOGs(input, nodeType, output, followData);
+}
+
+bool Parser::validateBinaryCache(const std::string& filename) const
+{
+  if (binaryCacheDirectory_.empty())
+    return false;
+
+  std::ifstream input(filename.c_str());
+  Config parsedConf;
+  std::vector<GogMetaData> parsedMetaData;
+  BinaryCache::ParseErrors parsedErrors;
+  parseErrors_ = &parsedErrors;
+  const bool parsed = input && parse_(input, parsedConf, parsedMetaData);
+  parseErrors_ = NULL;
+  if (!parsed)
+  {
+    printError_(0, "Unable to parse " + filename + " for cache validation");
+    return false;
+  }
+
+  const BinaryCache cache(binaryCacheDirectory_);
+  Config cachedConf;
+  std::vector<GogMetaData> cachedMetaData;
+  BinaryCache::ParseErrors cachedErrors;
+  if (!cache.read(filename, cacheSignature_(), cachedConf, cachedMetaData, cachedErrors))
+  {
+    printError_(0, "No valid cache entry for " + filename);
+    return false;
+  }
+  if (cachedErrors != parsedErrors)
+  {
+    printError_(0, "GOG cache mismatch for " + filename + ": parse errors do not match");
+    return false;
+  }
+
+  std::string difference;
+  if (!BinaryCache::compare(parsedConf, parsedMetaData, cachedConf, cachedMetaData, difference))
+  {
+    printError_(0, "GOG cache mismatch for " + filename + ": " + difference);
+    return false;
+  }
+  return true;
+}
+
 void Parser::printError_(size_t lineNumber, const std::string& errorText) const
 {
   // Assertion failure means Null Object pattern failed
   assert(context_.errorHandler_ != NULL);
+  if (parseErrors_)
+    parseErrors_->push_back(std::make_pair(lineNumber, errorText));
   if (context_.errorHandler_)
     context_.errorHandler_->printError(lineNumber, errorText);
 }
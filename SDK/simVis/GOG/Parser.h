@@ -24,6 +24,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 #include <iostream>
 #include "simCore/Common/Common.h"
 #include "simCore/Common/Memory.h"
@@ -169,6 +171,42 @@ namespace simVis { namespace GOG
     */
     void addOverwriteColor(const std::string& key, osgEarth::Symbology::Color color);
 
+    /**
+     * Enables a binary cache of parsed GOG files, used by the file name version of loadGOGs().
+     * Cache entries are keyed on the file's path, size and modification time, as well as
+     * the parser's color table, and are refreshed automatically when stale.
+     * @param[in ] directory Existing directory in which to store cache files; empty disables the cache (default)
+     */
+    void setBinaryCacheDirectory(const std::string& directory);
+
+    /** Retrieves the binary cache directory; empty when the cache is disabled */
+    const std::string& binaryCacheDirectory() const;
+
+    /**
+     * Parses a GOG file into a collection of GOG nodes.  If a binary cache directory is
+     * set, a valid cache entry is read instead of the text, and a new entry is written
+     * after a text parse.  Parse errors are stored in the entry and reported to the error
+     * handler again when the entry is read.
+     * @param[in ] filename   Full path to the GOG file
+     * @param[in ] nodeType   Read GOGs as this type
+     * @param[out] output     Resulting GOG collection
+     * @param[out] followData Vector of the follow orientation data for attached GOGs, parallel vector to the output
+     * @return True upon success, false upon failure
+     */
+    bool loadGOGs(
+      const std::string&           filename,
+      const GOGNodeType&           nodeType,
+      OverlayNodeVector&           output,
+      std::vector<GogFollowData>&  followData) const;
+
+    /**
+     * Validates the binary cache entry for a GOG file by comparing it, shape by shape,
+     * against a fresh parse of the text.  Differences are reported to the error handler.
+     * @param[in ] filename Full path to the GOG file
+     * @return True if the cache entry exists and matches the text parse
+     */
+    bool validateBinaryCache(const std::string& filename) const;
+
   private:
     /** Initialize the default GOG colors */
     void initGogColors_();
@@ -227,6 +265,9 @@ namespace simVis { namespace GOG
      */
     void printError_(size_t lineNumber, const std::string& errorText) const;
 
+    /** Returns a serialization of the parser settings that affect parse_() output, used to validate cache entries */
+    std::string cacheSignature_() const;
+
   private:
     /// Note that the map node could change; generally though it will not change between when a parser is instantiated and used.
     osg::observer_ptr<osgEarth::MapNode> mapNode_;
@@ -234,6 +275,9 @@ namespace simVis { namespace GOG
     GOGContext                           context_;
     osgEarth::Symbology::Style           style_;
     std::map<std::string, osgEarth::Symbology::Color> colors_; // Key is GOG color like color1, color2
+    std::string                          binaryCacheDirectory_;
+    /// Collects errors from printError_() while parsing for the binary cache; NULL otherwise
+    mutable std::vector<std::pair<size_t, std::string> >* parseErrors_;
   };
 
 } } // namespace simVis::GOG
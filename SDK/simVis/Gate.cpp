@@ -298,7 +298,8 @@ contentCallback_(new NullEntityCallback())
 
 void GateNode::updateLabel_(const simData::GatePrefs& prefs)
 {
-  if (hasLastUpdate_)
+  // regenerate only if prefs, the applied update or the content callback changed
+  if (hasLastUpdate_ && checkLabelContentDirty_(lastUpdateFromDS_.time()))
   {
     std::string label = getEntityName(EntityNode::DISPLAY_NAME);
     if (prefs.commonprefs().labelprefs().namelength() > 0)
@@ -325,6 +326,7 @@ void GateNode::setLabelContentCallback(LabelContentCallback* cb)
     contentCallback_ = new NullEntityCallback();
   else
     contentCallback_ = cb;
+  setLabelContentDirty();
 }
 
 LabelContentCallback* GateNode::labelContentCallback() const
@@ -354,6 +356,7 @@ void GateNode::setPrefs(const simData::GatePrefs& prefs)
   localGrid_->validatePrefs(prefs.commonprefs().localgrid());
 
   applyPrefs_(prefs);
+  setLabelContentDirty();
   updateLabel_(prefs);
   lastPrefsFromDS_ = prefs;
 }
@@ -552,6 +555,8 @@ void GateNode::applyUpdateOverrides_(bool force)
   }
   // we have applied a valid update, and both lastUpdateApplied_ and lastUpdateFromDS_ are valid
   hasLastUpdate_ = true;
+  // target calculations and overrides can change the update without changing its time
+  setLabelContentDirty();
 }
 
 int GateNode::calculateTargetGate_(const simData::GateUpdate& update, simData::GateUpdate& targetGateUpdate)
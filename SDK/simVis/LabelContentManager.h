@@ -29,7 +29,11 @@
 
 namespace simVis
 {
-  /** Callback for the user to create custom label content for a platform.  */
+  /**
+   * Callback for the user to create custom label content for a platform.  Entities call
+   * createString() only when their prefs, applied update, category data or callback change;
+   * content that depends on other data should call EntityNode::setLabelContentDirty().
+   */
   class LabelContentCallback : public osg::Referenced
   {
   public:
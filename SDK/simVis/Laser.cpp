@@ -91,7 +91,8 @@ LaserNode::LaserNode(const simData::LaserProperties& props, Locator* hostLocator
 
 void LaserNode::updateLabel_(const simData::LaserPrefs& prefs)
 {
-  if (hasLastUpdate_)
+  // regenerate only if prefs, the applied update or the content callback changed
+  if (hasLastUpdate_ && checkLabelContentDirty_(lastUpdate_.time()))
   {
     std::string label = getEntityName(EntityNode::DISPLAY_NAME);
     if (prefs.commonprefs().labelprefs().namelength() > 0)
@@ -118,6 +119,7 @@ void LaserNode::setLabelContentCallback(LabelContentCallback* cb)
     contentCallback_ = new NullEntityCallback();
   else
     contentCallback_ = cb;
+  setLabelContentDirty();
 }
 
 LabelContentCallback* LaserNode::labelContentCallback() const
@@ -148,6 +150,7 @@ void LaserNode::setPrefs(const simData::LaserPrefs& prefs)
   localGrid_->validatePrefs(prefs.commonprefs().localgrid());
 
   refresh_(NULL, &prefs);
+  setLabelContentDirty();
   updateLabel_(prefs);
   lastPrefs_ = prefs;
   hasLastPrefs_ = true;
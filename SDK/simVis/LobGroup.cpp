@@ -19,6 +19,8 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <set>
 #include "osg/LineWidth"
 #include "osgEarth/GeoData"
 #include "simCore/Calc/Angle.h"
@@ -39,6 +41,26 @@ namespace
 /// Uniform shader variable for flashing the LOB
 static const std::string SIMVIS_FLASHING_ENABLE = "simvis_flashing_enable";
 
+/// Number of hidden lines the LOB line cache may always keep for reuse
+static const size_t MIN_POOL_SIZE = 64;
+
+/** Returns the index of the first data point after time t, or datapoints_size() if there is none */
+int firstPointAfter(const simData::LobGroupUpdate& update, double t)
+{
+  // data points are ordered by time
+  int low = 0;
+  int high = update.datapoints_size();
+  while (low < high)
+  {
+    const int mid = low + (high - low) / 2;
+    if (update.datapoints(mid).time() <= t)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
 /** Determines whether the new prefs will require new geometry */
 bool prefsRequiresRebuild(const simData::LobGroupPrefs* a, const simData::LobGroupPrefs* b)
 {
@@ -86,90 +108,167 @@ private:
 
 
 
-/// maps time to one or more animated lines
-class LobGroupNode::Cache
+//----------------------------------------------------------------------------
+
+LobLineCache::LobLineCache()
+  : group_(new osg::Group),
+    recycling_(true)
 {
-public:
-  /** Constructor */
-  Cache()
-  {
-  }
+  group_->setName("LOB Lines");
+}
 
-  ~Cache()
-  {
-  }
+LobLineCache::~LobLineCache()
+{
+}
 
-  /** Retrieves the number of animated lines in the cache */
-  int numLines() const
-  {
-    return static_cast<int>(entries_.size());
-  }
+osg::Group* LobLineCache::node() const
+{
+  return group_.get();
+}
+
+int LobLineCache::numLines() const
+{
+  return static_cast<int>(entries_.size());
+}
+
+int LobLineCache::numPooledLines() const
+{
+  return static_cast<int>(pool_.size());
+}
+
+bool LobLineCache::hasTime(double t) const
+{
+  return std::binary_search(entries_.begin(), entries_.end(), t, EntryTimeLess());
+}
+
+int LobLineCache::numLinesAtOrBefore(double t) const
+{
+  return static_cast<int>(std::upper_bound(entries_.begin(), entries_.end(), t, EntryTimeLess()) - entries_.begin());
+}
 
-  /** Removes all animated lines from the cache under the parent */
-  void clearCache(osg::Group* parent)
+double LobLineCache::lastTime() const
+{
+  assert(!entries_.empty());
+  return entries_.empty() ? 0.0 : entries_.back().time;
+}
+
+void LobLineCache::setRecycling(bool recycling)
+{
+  if (recycling_ == recycling)
+    return;
+  recycling_ = recycling;
+  if (recycling_)
+    return;
+  // without recycling, lines leave the scene as soon as they leave the window
+  for (std::vector<osg::ref_ptr<AnimatedLineNode> >::const_iterator iter = pool_.begin(); iter != pool_.end(); ++iter)
+    group_->removeChild(iter->get());
+  pool_.clear();
+}
+
+bool LobLineCache::recycling() const
+{
+  return recycling_;
+}
+
+AnimatedLineNode* LobLineCache::acquireLine()
+{
+  if (pool_.empty())
   {
-    // removes all LOB draw nodes
-    for (LineCache::const_iterator iter = entries_.begin(); iter != entries_.end(); ++iter)
-    {
-      parent->removeChild(iter->second);
-    }
-    // clear out cache
-    entries_.clear();
+    AnimatedLineNode* line = new AnimatedLineNode;
+    group_->addChild(line);
+    return line;
   }
+  // the group keeps the line alive after it leaves the pool
+  AnimatedLineNode* line = pool_.back().get();
+  pool_.pop_back();
+  line->setNodeMask(~0u);
+  return line;
+}
 
-  /** Removes items from the cache that are outside [firstTime,lastTime] */
-  void pruneCache(osg::Group* parent, double firstTime, double lastTime)
-  {
-    // since the ordered multimap keys are ordered by time, remove all entries < firstTime time
-    const LineCache::iterator newStart = entries_.find(firstTime);
-    for (LineCache::const_iterator iter = entries_.begin(); iter != newStart; ++iter)
-    {
-      parent->removeChild(iter->second);
-    }
-    if (newStart != entries_.begin())
-      entries_.erase(entries_.begin(), newStart);
+void LobLineCache::addLineAtTime(double t, AnimatedLineNode* line)
+{
+  Entry entry;
+  entry.time = t;
+  entry.line = line;
+  // data normally arrives in time order, so most lines append to the back
+  if (entries_.empty() || entries_.back().time <= t)
+    entries_.push_back(entry);
+  else
+    entries_.insert(std::upper_bound(entries_.begin(), entries_.end(), t, EntryTimeLess()), entry);
+}
 
-    // since the ordered multimap keys are ordered by time, remove all entries > lastTime time
-    const LineCache::iterator newEnd = entries_.upper_bound(lastTime);
-    for (LineCache::const_iterator iter = newEnd; iter != entries_.end(); ++iter)
-    {
-      parent->removeChild(iter->second);
-    }
-    if (newEnd != entries_.end())
-      entries_.erase(newEnd, entries_.end());
-  }
+void LobLineCache::clearCache()
+{
+  for (std::deque<Entry>::const_iterator iter = entries_.begin(); iter != entries_.end(); ++iter)
+    recycle_(iter->line.get());
+  entries_.clear();
+}
 
-  /// update all lines to have the prefs in 'p'
-  void setAllLineProperties(const simData::LobGroupPrefs &p)
+void LobLineCache::pruneCache(double firstTime, double lastTime)
+{
+  // remove all entries < firstTime
+  const std::deque<Entry>::iterator newStart = std::lower_bound(entries_.begin(), entries_.end(), firstTime, EntryTimeLess());
+  for (std::deque<Entry>::const_iterator iter = entries_.begin(); iter != newStart; ++iter)
+    recycle_(iter->line.get());
+  entries_.erase(entries_.begin(), newStart);
+
+  // remove all entries > lastTime
+  const std::deque<Entry>::iterator newEnd = std::upper_bound(entries_.begin(), entries_.end(), lastTime, EntryTimeLess());
+  for (std::deque<Entry>::const_iterator iter = newEnd; iter != entries_.end(); ++iter)
+    recycle_(iter->line.get());
+  entries_.erase(newEnd, entries_.end());
+}
+
+void LobLineCache::trimPool()
+{
+  const size_t keep = std::max(MIN_POOL_SIZE, entries_.size());
+  if (pool_.size() <= 2 * keep)
+    return;
+
+  // rebuild the child list once instead of searching it for each removed line
+  std::set<const osg::Node*> removed;
+  for (size_t k = keep; k < pool_.size(); ++k)
+    removed.insert(pool_[k].get());
+  pool_.resize(keep);
+
+  std::vector<osg::ref_ptr<osg::Node> > children;
+  children.reserve(group_->getNumChildren());
+  for (unsigned int k = 0; k < group_->getNumChildren(); ++k)
   {
-    // TODO body offset
-    for (LineCache::const_iterator i = entries_.begin(); i != entries_.end(); ++i)
-    {
-      // only changeable pref is color override (maxdatapoints and maxdataseconds are handled in refresh())
-      if (p.commonprefs().useoverridecolor())
-        i->second->setColorOverride(simVis::ColorUtils::RgbaToVec4(p.commonprefs().overridecolor()));
-      else
-        i->second->clearColorOverride();
-    }
+    if (removed.find(group_->getChild(k)) == removed.end())
+      children.push_back(group_->getChild(k));
   }
+  group_->removeChildren(0, group_->getNumChildren());
+  for (std::vector<osg::ref_ptr<osg::Node> >::const_iterator iter = children.begin(); iter != children.end(); ++iter)
+    group_->addChild(iter->get());
+}
 
-  /// return true if there are any lines for time 't'
-  bool hasTime(double t) const
+void LobLineCache::setAllLineProperties(const simData::LobGroupPrefs& prefs)
+{
+  // TODO body offset
+  for (std::deque<Entry>::const_iterator i = entries_.begin(); i != entries_.end(); ++i)
   {
-    return (entries_.find(t) != entries_.end());
+    // only changeable pref is color override (maxdatapoints and maxdataseconds are handled in refresh())
+    if (prefs.commonprefs().useoverridecolor())
+      i->line->setColorOverride(simVis::ColorUtils::RgbaToVec4(prefs.commonprefs().overridecolor()));
+    else
+      i->line->clearColorOverride();
   }
+}
 
-  /// add animated line 'a' at time 't'
-  void addLineAtTime(double t, AnimatedLineNode *a)
+void LobLineCache::recycle_(AnimatedLineNode* line)
+{
+  if (!recycling_)
   {
-    entries_.insert(std::make_pair(t, osg::ref_ptr<AnimatedLineNode>(a)));
+    group_->removeChild(line);
+    return;
   }
+  // hidden lines are skipped by the update and cull traversals
+  line->setNodeMask(0);
+  pool_.push_back(line);
+}
 
-protected:
-  typedef std::multimap<double, osg::ref_ptr<AnimatedLineNode> > LineCache;
-  /** Multimap of scenario time to the animated lines at that time */
-  LineCache entries_;
-};
+//----------------------------------------------------------------------------
 
 LobGroupNode::LobGroupNode(const simData::LobGroupProperties &props,
                            EntityNode* host,
@@ -184,7 +283,7 @@ LobGroupNode::LobGroupNode(const simData::LobGroupProperties &props,
     ds_(ds),
     hostId_(host->getId()),
     drawStyleTableId_(0),
-    lineCache_(new Cache),
+    lineCache_(new LobLineCache),
     label_(NULL),
     contentCallback_(new NullEntityCallback()),
     lastFlashingState_(false)
@@ -192,6 +291,7 @@ LobGroupNode::LobGroupNode(const simData::LobGroupProperties &props,
   setName("LobGroup");
   localGrid_ = new LocalGridNode(getLocator(), host, ds.referenceYear());
   addChild(localGrid_);
+  addChild(lineCache_->node());
 
   osg::Group* labelRoot = new LocatorNode(new Locator(getLocator(), Locator::COMP_POSITION));
   label_ = new EntityLabelNode(labelRoot);
@@ -219,7 +319,6 @@ LobGroupNode::~LobGroupNode()
   ds_.dataTableManager().removeObserver(internalTableObserver_);
   delete coordConverter_;
   coordConverter_ = NULL;
-  lineCache_->clearCache(this);
   delete lineCache_;
   lineCache_ = NULL;
 }
@@ -234,7 +333,8 @@ void LobGroupNode::installShaderProgram(osg::StateSet* intoStateSet)
 
 void LobGroupNode::updateLabel_(const simData::LobGroupPrefs& prefs)
 {
-  if (hasLastUpdate_)
+  // regenerate only if prefs, the applied update or the content callback changed
+  if (hasLastUpdate_ && checkLabelContentDirty_(lastUpdate_.time()))
   {
     std::string label = getEntityName(EntityNode::DISPLAY_NAME);
     if (prefs.commonprefs().labelprefs().namelength() > 0)
@@ -261,6 +361,7 @@ void LobGroupNode::setLabelContentCallback(LabelContentCallback* cb)
     contentCallback_ = new NullEntityCallback();
   else
     contentCallback_ = cb;
+  setLabelContentDirty();
 }
 
 LabelContentCallback* LobGroupNode::labelContentCallback() const
@@ -268,6 +369,11 @@ LabelContentCallback* LobGroupNode::labelContentCallback() const
   return contentCallback_.get();
 }
 
+void LobGroupNode::setLineRecycling(bool recycling)
+{
+  lineCache_->setRecycling(recycling);
+}
+
 std::string LobGroupNode::hookText() const
 {
   if (hasLastUpdate_ && lastPrefsValid_)
@@ -307,8 +413,8 @@ void LobGroupNode::setPrefs(const simData::LobGroupPrefs &prefs)
       (lastPrefs_.userangeoverride() && PB_FIELD_CHANGED(&lastPrefs_, &prefs, rangeoverridevalue)) ||
       PB_FIELD_CHANGED(&lastPrefs_, &prefs, lobuseclampalt))
   {
-    // rebuild all lines
-    lineCache_->clearCache(this);
+    // rebuild all lines, recycling the existing line nodes
+    lineCache_->clearCache();
     const simData::LobGroupUpdateSlice *updateSlice = ds_.lobGroupUpdateSlice(lastProps_.id());
     if (updateSlice)
     {
@@ -322,6 +428,7 @@ void LobGroupNode::setPrefs(const simData::LobGroupPrefs &prefs)
   lastPrefsValid_ = true;
 
   // label does not perform any PB_FIELD_CHANGED tests on prefs, requires that lastPrefs_ be the up-to-date prefs.
+  setLabelContentDirty();
   updateLabel_(prefs);
 }
 
@@ -388,6 +495,8 @@ void LobGroupNode::setLineValueFromPrefs_(AnimatedLineNode& line, const simData:
 
   if (prefs.commonprefs().useoverridecolor())
     line.setColorOverride(simVis::ColorUtils::RgbaToVec4(prefs.commonprefs().overridecolor()));
+  else
+    line.clearColorOverride();
 }
 
 template <class T>
@@ -416,18 +525,28 @@ void LobGroupNode::updateCache_(const simData::LobGroupUpdate &update, const sim
   const simData::PlatformUpdateSlice *platformData = ds_.platformUpdateSlice(hostId_);
   if ((numLines <= 0) || (platformData == NULL))
   {
-    // no lines, clear out cache and remove all draw nodes
-    lineCache_->clearCache(this);
+    // no lines, clear out cache and hide all draw nodes
+    lineCache_->clearCache();
+    lineCache_->trimPool();
     return;
   }
 
   // prune the cache, since the data max values may adjust how much data is shown
   const double firstTime = update.datapoints(0).time();
   const double lastTime = update.datapoints(numLines-1).time();
-  lineCache_->pruneCache(this, firstTime, lastTime);
+  lineCache_->pruneCache(firstTime, lastTime);
+
+  // If every point up to the cache's last time already has a line, only the newer points need processing
+  int startIndex = 0;
+  if (lineCache_->recycling() && lineCache_->numLines() > 0)
+  {
+    const int numCached = firstPointAfter(update, lineCache_->lastTime());
+    if (numCached == lineCache_->numLines())
+      startIndex = numCached;
+  }
 
   simData::Interpolator* li = ds_.interpolator();
-  for (int index = 0; index < numLines;) // Incremented in the for loop below
+  for (int index = startIndex; index < numLines;) // Incremented in the for loop below
   {
     // handle all lines with this time (if time is not already in the cache)
     const double time = update.datapoints(index).time();
@@ -505,8 +624,8 @@ void LobGroupNode::updateCache_(const simData::LobGroupUpdate &update, const sim
       if (prefs.lobuseclampalt())
         applyEndpointCoordClamping_(endCoord);
 
-      //--- construct the line
-      AnimatedLineNode *line = new AnimatedLineNode;
+      //--- construct the line, reusing a pooled node where possible
+      AnimatedLineNode *line = lineCache_->acquireLine();
       line->setShiftsPerSecond(0);
 
       // set starting prefs
@@ -517,7 +636,6 @@ void LobGroupNode::updateCache_(const simData::LobGroupUpdate &update, const sim
 
       // insert into cache
       lineCache_->addLineAtTime(time, line);
-      addChild(line);
     }
 
     // set the local grid for platform's position and az/el of the last of the lobs
@@ -536,6 +654,9 @@ void LobGroupNode::updateCache_(const simData::LobGroupUpdate &update, const sim
       getLocator()->endUpdate();
     }
   }
+
+  // release lines left over from a larger history
+  lineCache_->trimPool();
 }
 
 bool LobGroupNode::isActive() const
@@ -611,6 +732,8 @@ bool LobGroupNode::updateFromDataStore(const simData::DataSliceBase *updateSlice
       updateCache_(*current, lastPrefs_);
       lastUpdate_ = *current;
       hasLastUpdate_ = true;
+      // the set of data points can change without changing the update time
+      setLabelContentDirty();
 
       // update the visibility
       const bool drawnLOBs = hasLastUpdate_ && (lastUpdate_.datapoints_size() > 0);
@@ -637,7 +760,8 @@ bool LobGroupNode::updateFromDataStore(const simData::DataSliceBase *updateSlice
 
 void LobGroupNode::flush()
 {
-  lineCache_->clearCache(this);
+  lineCache_->clearCache();
+  lineCache_->trimPool();
   setNodeMask(DISPLAY_MASK_NONE);
   hasLastUpdate_ = false;
 }
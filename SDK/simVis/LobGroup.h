@@ -22,6 +22,9 @@
 #ifndef SIMVIS_LOB_GROUP_H
 #define SIMVIS_LOB_GROUP_H
 
+#include <deque>
+#include <vector>
+#include "osg/Group"
 #include "simData/DataTable.h"
 #include "simVis/Entity.h"
 #include "simVis/Constants.h"
@@ -36,6 +39,92 @@ namespace simVis
 
 class AnimatedLineNode;
 
+/**
+ * Time-ordered cache of the animated lines drawn by a LobGroupNode.
+ *
+ * Lines are held in a ring ordered by scenario time, so the window of lines to keep
+ * is found by binary search and trimmed from either end.  Lines that fall out of the
+ * window are hidden and returned to a pool instead of being removed from the scene,
+ * and acquireLine() recycles them for new data points.  All lines, active and pooled,
+ * are children of node().
+ */
+class SDKVIS_EXPORT LobLineCache
+{
+public:
+  LobLineCache();
+  virtual ~LobLineCache();
+
+  /** Group that holds every line created by the cache; add this to the scene */
+  osg::Group* node() const;
+
+  /** Retrieves the number of active lines in the cache */
+  int numLines() const;
+  /** Retrieves the number of hidden lines waiting to be recycled */
+  int numPooledLines() const;
+
+  /** Returns true if there are any lines for time 't' */
+  bool hasTime(double t) const;
+  /** Retrieves the number of active lines at or before time 't' */
+  int numLinesAtOrBefore(double t) const;
+  /** Retrieves the time of the latest active line; only valid if numLines() > 0 */
+  double lastTime() const;
+
+  /**
+   * Sets whether lines leaving the window are pooled for reuse (default).  When disabled, they are
+   * removed from node() and every new data point gets a new line, as before the pool existed.
+   */
+  void setRecycling(bool recycling);
+  /** Returns true if lines leaving the window are pooled for reuse */
+  bool recycling() const;
+
+  /** Returns a visible line from the pool, or a new line if the pool is empty; it must be passed to addLineAtTime() */
+  AnimatedLineNode* acquireLine();
+  /** Adds a line from acquireLine() to the cache at time 't' */
+  void addLineAtTime(double t, AnimatedLineNode* line);
+
+  /** Returns all active lines to the pool */
+  void clearCache();
+  /** Returns lines outside [firstTime,lastTime] to the pool */
+  void pruneCache(double firstTime, double lastTime);
+  /** Removes pooled lines from the scene when the pool is much larger than the active set */
+  void trimPool();
+
+  /** Updates all active lines to use the color override in 'prefs' */
+  void setAllLineProperties(const simData::LobGroupPrefs& prefs);
+
+private:
+  /** Copy constructor, not implemented or available. */
+  LobLineCache(const LobLineCache&);
+  /** Assignment operator, not implemented or available. */
+  LobLineCache& operator=(const LobLineCache&);
+
+  /** Hides the line and places it in the pool */
+  void recycle_(AnimatedLineNode* line);
+
+  /** Line drawn at a scenario time */
+  struct Entry
+  {
+    double time;
+    osg::ref_ptr<AnimatedLineNode> line;
+  };
+  /** Orders entries by time for binary searches */
+  struct EntryTimeLess
+  {
+    bool operator()(const Entry& entry, double t) const { return entry.time < t; }
+    bool operator()(double t, const Entry& entry) const { return t < entry.time; }
+    bool operator()(const Entry& lhs, const Entry& rhs) const { return lhs.time < rhs.time; }
+  };
+
+  /** Parent of all lines */
+  osg::ref_ptr<osg::Group> group_;
+  /** Active lines, ordered by time; new data is pushed on the back and old data is popped from the front */
+  std::deque<Entry> entries_;
+  /** Hidden lines available for reuse */
+  std::vector<osg::ref_ptr<AnimatedLineNode> > pool_;
+  /** True if lines leaving the window go to pool_ */
+  bool recycling_;
+};
+
 /**
  * Scene graph node that renders a group of "Lines of Bearing" (LOB)
  *
@@ -82,6 +171,13 @@ public:
   /// Returns current content callback
   LabelContentCallback* labelContentCallback() const;
 
+  /**
+  * Sets whether line nodes are recycled and updates only process new data points (default).  Disabling
+  * this creates a line per data point and rescans every point on each update, for comparison.
+  * @param recycling True to recycle lines, false to recreate them
+  */
+  void setLineRecycling(bool recycling);
+
 public: // EntityNode interface
   /**
   * Whether the entity is active within the scenario at the current time.
@@ -153,7 +249,6 @@ public: // EntityNode interface
   virtual const char* className() const { return "LobGroupNode"; }
 
 private: // types
-  class Cache;
   class InternalTableObserver;
 
 private: // methods
@@ -211,7 +306,7 @@ private: // data
   simData::TableId drawStyleTableId_;
 
   /// Cache of lines drawn
-  Cache *lineCache_;
+  LobLineCache* lineCache_;
   /// the localgrid node for this lobgroup
   osg::ref_ptr<LocalGridNode> localGrid_;
 
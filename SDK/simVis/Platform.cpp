@@ -24,6 +24,7 @@
 #include "simCore/Calc/CoordinateConverter.h"
 #include "simNotify/Notify.h"
 #include "simVis/AnimatedLine.h"
+#include "simVis/EMFileCache.h"
 #include "simVis/LocalGrid.h"
 #include "simVis/Platform.h"
 #include "simVis/PlatformModel.h"
@@ -116,6 +117,34 @@ private:
 };
 
 
+/** OSG Callback that polls for a background RCS load, removing itself when the load completes */
+class PlatformNode::LoadRcsCallback : public osg::Callback
+{
+public:
+  explicit LoadRcsCallback(PlatformNode* platform)
+    : Callback(),
+      platform_(platform)
+  {
+  }
+
+  virtual bool run(osg::Object* object, osg::Object* data)
+  {
+    const bool rv = traverse(object, data);
+    osg::ref_ptr<PlatformNode> platform;
+    if (platform_.lock(platform) && platform->checkPendingRcs_(false))
+    {
+      // hold a reference so that this callback survives its own removal
+      osg::ref_ptr<LoadRcsCallback> keepAlive(this);
+      platform->removeUpdateCallback(this);
+      platform->loadRcsCallback_ = NULL;
+    }
+    return rv;
+  }
+
+private:
+  osg::observer_ptr<PlatformNode> platform_;
+};
+
 //----------------------------------------------------------------------------
 
 PlatformNode::PlatformNode(const simData::PlatformProperties& props,
@@ -181,36 +210,60 @@ void PlatformNode::setProperties(const simData::PlatformProperties& props)
 
 simCore::RadarCrossSectionPtr PlatformNode::getRcs() const
 {
+  checkPendingRcs_(true);
   return rcs_;
 }
 
 void PlatformNode::setRcsPrefs_(const simData::PlatformPrefs& prefs)
 {
-  if (prefs.rcsfile() != lastPrefs_.rcsfile())
+  if (prefs.rcsfile() == lastPrefs_.rcsfile())
+    return;
+
+  // replaces any pending load; the callback polls whichever file is pending
+  rcs_.reset();
+  pendingRcsFile_.clear();
+  if (!prefs.rcsfile().empty())
   {
-    if (prefs.rcsfile().empty())
-    {
-      rcs_.reset();
-    }
+    std::string uri = simVis::Registry::instance()->findModelFile(prefs.rcsfile());
+    if (!uri.empty())
+      pendingRcsFile_ = uri;
     else
     {
-      std::string uri = simVis::Registry::instance()->findModelFile(prefs.rcsfile());
-      if (!uri.empty())
-      {
-        rcs_.reset(simCore::RcsFileParser::loadRCSFile(uri));
-        if (rcs_ == NULL)
-        {
-          SIM_WARN << LC << "Failed to load RCS file \"" << uri << "\"" << std::endl;
-        }
-      }
-      else
-      {
-        SIM_WARN << LC << "Failed to load RCS file \"" << prefs.rcsfile() << "\"" << std::endl;
-      }
+      SIM_WARN << LC << "Failed to load RCS file \"" << prefs.rcsfile() << "\"" << std::endl;
     }
-    if (model_)
-      model_->setRcsData(rcs_);
   }
+
+  // remove the old RCS from the display now rather than when the new file finishes loading
+  if (model_)
+    model_->setRcsData(rcs_);
+
+  // RCS files are shared with other platforms and parsed in the background
+  if (!checkPendingRcs_(false) && !loadRcsCallback_.valid())
+  {
+    loadRcsCallback_ = new LoadRcsCallback(this);
+    addUpdateCallback(loadRcsCallback_.get());
+  }
+}
+
+bool PlatformNode::checkPendingRcs_(bool wait) const
+{
+  if (pendingRcsFile_.empty())
+    return true;
+  simCore::RadarCrossSectionPtr rcs;
+  if (wait)
+    rcs = EMFileCache::instance()->rcs(pendingRcsFile_);
+  else if (EMFileCache::instance()->requestRcs(pendingRcsFile_, rcs) == EMFileCache::STATUS_PENDING)
+    return false;
+
+  if (rcs == NULL)
+  {
+    SIM_WARN << LC << "Failed to load RCS file \"" << pendingRcsFile_ << "\"" << std::endl;
+  }
+  rcs_ = rcs;
+  pendingRcsFile_.clear();
+  if (model_)
+    model_->setRcsData(rcs_);
+  return true;
 }
 
 void PlatformNode::setPrefs(const simData::PlatformPrefs& prefs)
@@ -226,6 +279,7 @@ void PlatformNode::setPrefs(const simData::PlatformPrefs& prefs)
     if (prefsDraw)
     {
       model_->setPrefs(prefs);
+      setLabelContentDirty();
       updateLabel_(prefs);
     }
 
@@ -424,6 +478,7 @@ bool PlatformNode::updateFromDataStore(const simData::DataSliceBase* updateSlice
   if (!updateSlice->hasChanged() && !force && !forceUpdateFromDataStore_)
   {
     // Even if the platform has not changed, the label can still change - entity name could change as a result of category data, for example.
+    // The label is only regenerated if setLabelContentDirty() was called since the last update.
     updateLabel_(lastPrefs_);
     return false;
   }
@@ -592,7 +647,8 @@ const std::string PlatformNode::getEntityName(EntityNode::NameType nameType, boo
 
 void PlatformNode::updateLabel_(const simData::PlatformPrefs& prefs)
 {
-  if (model_ && valid_)
+  // regenerate only if prefs, the applied update or the content callback changed
+  if (model_ && valid_ && checkLabelContentDirty_(lastUpdate_.time()))
   {
     std::string label = getEntityName(EntityNode::DISPLAY_NAME, true);
     if (prefs.commonprefs().labelprefs().namelength() > 0)
@@ -620,6 +676,7 @@ void PlatformNode::setLabelContentCallback(LabelContentCallback* cb)
     contentCallback_ = new NullEntityCallback();
   else
     contentCallback_ = cb;
+  setLabelContentDirty();
 }
 
 LabelContentCallback* PlatformNode::labelContentCallback() const
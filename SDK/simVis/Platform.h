@@ -264,6 +264,12 @@ namespace simVis
     */
     bool showExpiredTrackHistory_(const simData::PlatformPrefs& prefs) const;
     void setRcsPrefs_(const simData::PlatformPrefs& prefs);
+    /**
+    * Completes the RCS load started by setRcsPrefs_(), applying the result to the model
+    * @param wait If true, blocks until the file is loaded
+    * @return true if no load is pending
+    */
+    bool checkPendingRcs_(bool wait) const;
     void updateLocator_(const simData::PlatformUpdate& u);
     void updateHostBounds_(double scale);
     void updateLabel_(const simData::PlatformPrefs& prefs);
@@ -278,7 +284,13 @@ namespace simVis
 
     const simData::DataStore&       ds_;
     PlatformTspiFilterManager&      platformTspiFilterManager_;
-    simCore::RadarCrossSectionPtr   rcs_;
+    /// RCS shared through the EMFileCache; completed lazily by getRcs() if still loading
+    mutable simCore::RadarCrossSectionPtr rcs_;
+    /// full path of an RCS file being loaded in the background, or empty
+    mutable std::string             pendingRcsFile_;
+    /// update callback that polls for the pending RCS file
+    class LoadRcsCallback;
+    osg::ref_ptr<LoadRcsCallback>   loadRcsCallback_;
     simData::PlatformProperties     lastProps_;
     simData::PlatformPrefs          lastPrefs_;
     simData::PlatformUpdate         lastUpdate_;
@@ -32,6 +32,7 @@
 #include "osgDB/ReadFile"
 #include "osgEarth/AutoScale"
 #include "osgEarth/Horizon"
+#include "osgEarth/NodeUtils"
 #include "osgEarth/ObjectIndex"
 #include "osgEarthAnnotation/AnnotationUtils"
 
@@ -224,6 +225,9 @@ bool PlatformModelNode::updateModel_(const simData::PlatformPrefs& prefs)
       !PB_FIELD_CHANGED(&lastPrefs_, &prefs, icon))
     return false;
 
+  // a pending load for the previous icon is no longer needed
+  setPendingModel_("");
+
   // if the new properties say "no model", remove any existing model.
   if (prefs.icon().empty() && model_.valid())
   {
@@ -246,15 +250,33 @@ bool PlatformModelNode::updateModel_(const simData::PlatformPrefs& prefs)
   if (newModelURI.empty())
     return true;
 
-  model_ = simVis::Registry::instance()->getOrCreateIconModel(newModelURI, &isImageModel_);
+  simVis::Registry* registry = simVis::Registry::instance();
+  osg::ref_ptr<osg::Node> model;
+  if (!registry->getAsyncIconModelLoading())
+    model = registry->getOrCreateIconModel(newModelURI, &isImageModel_);
+  else if (registry->requestIconModel(newModelURI, model, &isImageModel_) == simVis::Registry::MODEL_PENDING)
+  {
+    // Show the placeholder until traverse() swaps in the model
+    isImageModel_ = false;
+    setPendingModel_(newModelURI);
+    setModel_(NULL);
+    return true;
+  }
+
+  if (!model.valid() && !registry->isMemoryCheck())
+  {
+    SIM_WARN << "Failed to find icon model: " << newModelURI << "" << std::endl;
+  }
+  setModel_(model.get());
+  return true;
+}
+
+void PlatformModelNode::setModel_(osg::Node* model)
+{
+  model_ = model;
   // If we were not able to load the icon/model, create a box to use as a placeholder.
   if (!model_.valid())
   {
-    if (!simVis::Registry::instance()->isMemoryCheck())
-    {
-      SIM_WARN << "Failed to find icon model: " << newModelURI << "" << std::endl;
-    }
-
     // Use the unit cube
     osg::Geode* geode = new osg::Geode();
     osg::StateSet* stateset = new osg::StateSet();
@@ -276,8 +298,46 @@ bool PlatformModelNode::updateModel_(const simData::PlatformPrefs& prefs)
   offsetXform_->addChild(model_);
   alphaVolumeGroup_->addChild(model_);
   dynamicXform_->setSizingNode(model_);
+}
 
-  return true;
+void PlatformModelNode::setPendingModel_(const std::string& name)
+{
+  if (name.empty() != pendingModel_.empty())
+    ADJUST_UPDATE_TRAV_COUNT(this, name.empty() ? -1 : 1);
+  pendingModel_ = name;
+}
+
+void PlatformModelNode::checkPendingModel_()
+{
+  osg::ref_ptr<osg::Node> model;
+  bool isImage = false;
+  const simVis::Registry::ModelLoadStatus status = simVis::Registry::instance()->requestIconModel(pendingModel_, model, &isImage);
+  if (status == simVis::Registry::MODEL_PENDING)
+    return;
+
+  if (status == simVis::Registry::MODEL_FAILED)
+  {
+    SIM_WARN << "Failed to find icon model: " << pendingModel_ << "" << std::endl;
+  }
+  setPendingModel_("");
+
+  // Replace the placeholder
+  offsetXform_->removeChild(model_);
+  alphaVolumeGroup_->removeChild(model_);
+  isImageModel_ = isImage;
+  setModel_(model.get());
+
+  // Re-apply all preferences to the new model
+  lastPrefsValid_ = false;
+  const simData::PlatformPrefs prefs = lastPrefs_;
+  applyPrefs_(prefs, true);
+}
+
+void PlatformModelNode::traverse(osg::NodeVisitor& nv)
+{
+  if (!pendingModel_.empty() && nv.getVisitorType() == nv.UPDATE_VISITOR)
+    checkPendingModel_();
+  LocatorNode::traverse(nv);
 }
 
 void PlatformModelNode::setRotateToScreen(bool value)
@@ -724,7 +784,11 @@ void PlatformModelNode::setPrefs(const simData::PlatformPrefs& prefs)
 {
   // If a new model is loaded than force a scale update
   const bool modelChanged = updateModel_(prefs);
+  applyPrefs_(prefs, modelChanged);
+}
 
+void PlatformModelNode::applyPrefs_(const simData::PlatformPrefs& prefs, bool modelChanged)
+{
   // Preference rules that set a high Z offset (say 4000) on image icons could be problematic; warn about them.
   // Only really care about image icons, since they have no Z depth and the offset Z moves them closer to
   // camera in a way that scales with dynamic scale and regular scale
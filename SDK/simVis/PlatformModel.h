@@ -118,6 +118,9 @@ namespace simVis
     /** Return the class name */
     virtual const char* className() const { return "PlatformModelNode"; }
 
+    /** Override to swap in icon models loaded in the background */
+    virtual void traverse(osg::NodeVisitor& nv);
+
   private:
     virtual ~PlatformModelNode();
     PlatformModelNode(const PlatformModelNode& rhs); // not implemented
@@ -129,6 +132,8 @@ namespace simVis
     osg::BoundingBox                   unscaledBounds_;
     /// Points to a (likely) shared instance of a single 3-D Model
     osg::ref_ptr<osg::Node>            model_;
+    /// Name of an icon model being loaded in the background, or empty if none
+    std::string                        pendingModel_;
     /// True if the URI of the model points to a 2-D image that needs billboarding
     bool                               isImageModel_;
     osg::ref_ptr<RCSNode>              rcs_;
@@ -145,6 +150,14 @@ namespace simVis
 
     /// May changes the model based on prefs and returns true if the model was changed
     bool updateModel_(const simData::PlatformPrefs& prefs);
+    /** Attaches the given model, or a placeholder box if NULL */
+    void setModel_(osg::Node* model);
+    /** Sets the name of the model loading in the background, enabling the update traversal while pending */
+    void setPendingModel_(const std::string& name);
+    /** Swaps in the pending model when its background load finishes */
+    void checkPendingModel_();
+    /** Applies all preferences other than the model itself */
+    void applyPrefs_(const simData::PlatformPrefs& prefs, bool modelChanged);
     /// Updates the orientation offset  based on prefs; returns true if changed
     bool updateOffsets_(const simData::PlatformPrefs& prefs);
     /// Updates the scale based on pref or if force is set to true when the model has changed; returns true if changed
@@ -213,7 +213,8 @@ void ProjectorNode::init_()
 
 void ProjectorNode::updateLabel_(const simData::ProjectorPrefs& prefs)
 {
-  if (!hasLastUpdate_)
+  // regenerate only if prefs, the applied update or the content callback changed
+  if (!hasLastUpdate_ || !checkLabelContentDirty_(lastUpdate_.time()))
     return;
 
   std::string label = getEntityName(EntityNode::DISPLAY_NAME);
@@ -240,6 +241,7 @@ void ProjectorNode::setLabelContentCallback(LabelContentCallback* cb)
     contentCallback_ = new NullEntityCallback();
   else
     contentCallback_ = cb;
+  setLabelContentDirty();
 }
 
 LabelContentCallback* ProjectorNode::labelContentCallback() const
@@ -298,6 +300,7 @@ void ProjectorNode::setPrefs(const simData::ProjectorPrefs& prefs)
     projectorAlpha_->set(prefs.projectoralpha());
   }
 
+  setLabelContentDirty();
   updateLabel_(prefs);
   lastPrefs_ = prefs;
   hasLastPrefs_ = true;
@@ -25,6 +25,7 @@
 #include "osg/MatrixTransform"
 #include "osg/PolygonStipple"
 #include "osg/Depth"
+#include "OpenThreads/ScopedLock"
 
 #include "simNotify/Notify.h"
 #include "simCore/Calc/Angle.h"
@@ -33,6 +34,7 @@
 #include "simCore/EM/RadarCrossSection.h"
 
 #include "simVis/Constants.h"
+#include "simVis/EMFileCache.h"
 #include "simVis/Registry.h"
 #include "simVis/Utils.h"
 #include "simVis/RCS.h"
@@ -238,17 +240,24 @@ void RCSRenderer::initValues_()
   else
   {
     // calculate RCS bounds
+    std::vector<double> azimuths;
     for (int i = -180; i <= 180; i++)
+      azimuths.push_back(simCore::DEG2RAD*(i));
+    std::vector<double> elevations;
+    for (int j = -90; j <= 90; j++)
+      elevations.push_back(simCore::DEG2RAD*(j));
+    std::vector<float> rcsdB;
     {
-      double azim = simCore::DEG2RAD*(i);
-      for (int j = -90; j <= 90; j++)
-      {
-        double elev = simCore::DEG2RAD*(j);
-        double radius = rcs_->RCSdB(freq_, azim, elev, polarity_);
-        if (radius > simCore::SMALL_DB_COMPARE)
-          min_ = osg::minimum(min_, radius);
-        max_ = osg::maximum(max_, radius);
-      }
+      // RCS instances are shared through the EMFileCache
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
+      rcs_->RCSdBGrid(freq_, azimuths, elevations, polarity_, rcsdB);
+    }
+    for (std::vector<float>::const_iterator iter = rcsdB.begin(); iter != rcsdB.end(); ++iter)
+    {
+      double radius = *iter;
+      if (radius > simCore::SMALL_DB_COMPARE)
+        min_ = osg::minimum(min_, radius);
+      max_ = osg::maximum(max_, radius);
     }
   }
 
@@ -269,20 +278,16 @@ void RCSRenderer::initValues_()
   }
 }
 
-int RCSRenderer::computeRadius_(double azim, double elev, osg::Vec3f &p, float *rcsdB)
+void RCSRenderer::computePoint_(float rcsdB, double cosAzim, double sinAzim, double cosElev, double sinElev, osg::Vec3f &p) const
 {
   // values returned from RCS lookup table are in dB
-  float rcsValue = rcs_->RCSdB(freq_, azim, elev, polarity_);
-  *rcsdB = rcsValue;
-  rcsValue = osg::maximum((float)offset_ + rcsValue, 0.0f);
+  const float rcsValue = osg::maximum((float)offset_ + rcsdB, 0.0f);
 
   // convert azim & elev to a rectangular coordinate
   // course is off Y, elevation off horizon...
-  p.set(rcsValue * cos(-azim) * cos(elev),
-    rcsValue * sin(-azim) * cos(elev),
-    rcsValue * sin(elev));
-
-  return static_cast<int>(rcsValue);
+  p.set(rcsValue * cosAzim * cosElev,
+    rcsValue * sinAzim * cosElev,
+    rcsValue * sinElev);
 }
 
 osg::Node* RCSRenderer::render2D_()
@@ -342,11 +347,20 @@ osg::Node* RCSRenderer::render2D_()
     }
 
     // draw RCS
+    std::vector<double> azimuths(360);
     for (int i = 0; i < 360; i++)
+      azimuths[i] = simCore::DEG2RAD * i;
+    std::vector<float> rcsdB;
     {
-      double azim = simCore::DEG2RAD * i;
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
+      rcs_->RCSdBGrid(freq_, azimuths, std::vector<double>(1, elev), polarity_, rcsdB);
+    }
 
-      rcsValue = rcs_->RCSdB(freq_, azim, elev, polarity_);
+    for (int i = 0; i < 360; i++)
+    {
+      double azim = azimuths[i];
+
+      rcsValue = rcsdB[i];
       // offset RCS value by specified dB for plot
       rcsValue = osg::maximum((float)offset_ + rcsValue, 0.0f);
 
@@ -397,46 +411,66 @@ osg::Node* RCSRenderer::render3D_()
     rcsGeom->setColorArray(colors);
     rcsGeom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
 
-    double radDetail = simCore::DEG2RAD * detail_;
-    float rcsdB;
+    const int step = static_cast<int>(detail_);
 
-    int lastCount = 0;
-    for (int jj = -90; jj < 90; jj += static_cast<int>(detail_))
+    // evaluate the whole pattern in one call; each t-strip uses two adjacent elevation rows
+    std::vector<double> azimuths;
+    std::vector<double> cosAzim;
+    std::vector<double> sinAzim;
+    for (int ii = 0; ii <= 360; ii += step)
     {
-      double elev = simCore::DEG2RAD * jj;
-      for (int ii = 0; ii <= 360; ii += static_cast<int>(detail_))
-      {
-        double azim = simCore::DEG2RAD * ii;
-
-        // compute first point in t-strip
-        osg::Vec3f pt;
-        computeRadius_(azim, elev, pt, &rcsdB);
-
-        osg::Vec3f ptNorm(pt);
-        ptNorm.normalize();
-
-        verts->push_back(pt);
-        norms->push_back(ptNorm);
-
-        if (colorOverride_)
-          colors->push_back(color_);
-        else
-          colors->push_back(colorUtils_->GainThresholdColor(static_cast<int>(rcsdB)));
-
-        // compute alternate point in t-strip
-        osg::Vec3f ptne;
-        computeRadius_(azim, (elev + radDetail), ptne, &rcsdB);
-
-        osg::Vec3f ptneNorm(ptne);
-        ptneNorm.normalize();
+      const double azim = simCore::DEG2RAD * ii;
+      azimuths.push_back(azim);
+      cosAzim.push_back(cos(-azim));
+      sinAzim.push_back(sin(-azim));
+    }
+    std::vector<double> elevations;
+    for (int jj = -90; jj < 90; jj += step)
+      elevations.push_back(simCore::DEG2RAD * jj);
+    if (!elevations.empty())
+      elevations.push_back(elevations.back() + simCore::DEG2RAD * step);
+    std::vector<double> cosElev(elevations.size());
+    std::vector<double> sinElev(elevations.size());
+    for (size_t j = 0; j < elevations.size(); ++j)
+    {
+      cosElev[j] = cos(elevations[j]);
+      sinElev[j] = sin(elevations[j]);
+    }
+    std::vector<float> rcsdB;
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
+      rcs_->RCSdBGrid(freq_, azimuths, elevations, polarity_, rcsdB);
+    }
 
-        verts->push_back(ptne);
-        norms->push_back(ptneNorm);
+    const size_t numAzim = azimuths.size();
+    const size_t numStrips = elevations.empty() ? 0 : elevations.size() - 1;
+    verts->reserve(numStrips * numAzim * 2);
+    norms->reserve(numStrips * numAzim * 2);
+    colors->reserve(numStrips * numAzim * 2);
 
-        if (colorOverride_)
-          colors->push_back(color_);
-        else
-          colors->push_back(colorUtils_->GainThresholdColor(static_cast<int>(rcsdB)));
+    int lastCount = 0;
+    for (size_t j = 0; j < numStrips; ++j)
+    {
+      for (size_t i = 0; i < numAzim; ++i)
+      {
+        // compute first point in t-strip, then alternate point one row up
+        for (size_t row = j; row <= j + 1; ++row)
+        {
+          const float pointdB = rcsdB[row * numAzim + i];
+          osg::Vec3f pt;
+          computePoint_(pointdB, cosAzim[i], sinAzim[i], cosElev[row], sinElev[row], pt);
+
+          osg::Vec3f ptNorm(pt);
+          ptNorm.normalize();
+
+          verts->push_back(pt);
+          norms->push_back(ptNorm);
+
+          if (colorOverride_)
+            colors->push_back(color_);
+          else
+            colors->push_back(colorUtils_->GainThresholdColor(static_cast<int>(pointdB)));
+        }
       }
 
       rcsGeom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::TRIANGLE_STRIP, lastCount, verts->size() - lastCount));
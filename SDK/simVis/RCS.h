@@ -100,7 +100,7 @@ private:
   osg::ref_ptr<osg::Node> rcs3D_;
 
   void initValues_();
-  int computeRadius_(double azim, double elev, osg::Vec3f &p, float *rcsdB);
+  void computePoint_(float rcsdB, double cosAzim, double sinAzim, double cosElev, double sinElev, osg::Vec3f &p) const;
 
   void renderRcs_();
   osg::Node* render2D_();
@@ -0,0 +1,170 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
+#include "simVis/RFProp/CompositeProfileProvider.h"
+#include "simVis/RFProp/ArepsBackgroundLoader.h"
+
+namespace simRF {
+
+/** Worker thread; pulls file indices from the owner until none remain */
+class ArepsBackgroundLoader::Worker : public OpenThreads::Thread
+{
+public:
+  Worker(ArepsBackgroundLoader& owner)
+    : owner_(owner),
+      loader_(owner.prototype_)
+  {
+  }
+
+  virtual void run()
+  {
+    size_t index = 0;
+    while (owner_.nextFile_(index))
+    {
+      osg::ref_ptr<Profile> profile = new Profile(new CompositeProfileProvider());
+      if (loader_.loadFile(owner_.filenames_[index], *profile, false) != 0)
+        profile = NULL;
+      owner_.finishFile_(index, profile.get());
+    }
+  }
+
+private:
+  ArepsBackgroundLoader& owner_;
+  /// Each worker has its own copy of the loader, which carries the header values of the first file
+  ArepsLoader loader_;
+};
+
+ArepsBackgroundLoader::ArepsBackgroundLoader(const ArepsLoader& prototype, const std::vector<std::string>& filenames, unsigned int numThreads)
+  : prototype_(prototype),
+    filenames_(filenames),
+    numThreads_(numThreads),
+    nextIndex_(0),
+    numProcessed_(0),
+    numFailed_(0),
+    canceled_(false)
+{
+  // workers use copies of the facade's parameters instead of the facade itself
+  prototype_.detachBeamHandler();
+  if (numThreads_ == 0)
+    numThreads_ = static_cast<unsigned int>(OpenThreads::GetNumberOfProcessors());
+  // No point in having more threads than files
+  if (numThreads_ > filenames_.size())
+    numThreads_ = static_cast<unsigned int>(filenames_.size());
+  if (numThreads_ == 0 && !filenames_.empty())
+    numThreads_ = 1;
+}
+
+ArepsBackgroundLoader::~ArepsBackgroundLoader()
+{
+  cancel();
+}
+
+void ArepsBackgroundLoader::start()
+{
+  if (!workers_.empty())
+    return;
+  for (unsigned int k = 0; k < numThreads_; ++k)
+  {
+    Worker* worker = new Worker(*this);
+    workers_.push_back(worker);
+    worker->start();
+  }
+}
+
+void ArepsBackgroundLoader::cancel()
+{
+  {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+    canceled_ = true;
+  }
+  for (std::vector<Worker*>::const_iterator i = workers_.begin(); i != workers_.end(); ++i)
+  {
+    (*i)->join();
+    delete *i;
+  }
+  workers_.clear();
+}
+
+size_t ArepsBackgroundLoader::takeCompleted(std::vector<osg::ref_ptr<Profile> >& profiles)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  const size_t count = completed_.size();
+  profiles.insert(profiles.end(), completed_.begin(), completed_.end());
+  completed_.clear();
+  return count;
+}
+
+size_t ArepsBackgroundLoader::numFiles() const
+{
+  return filenames_.size();
+}
+
+size_t ArepsBackgroundLoader::numProcessed() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return numProcessed_;
+}
+
+size_t ArepsBackgroundLoader::numFailed() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return numFailed_;
+}
+
+bool ArepsBackgroundLoader::isDone() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  if (canceled_)
+    return true;
+  return numProcessed_ == filenames_.size();
+}
+
+std::vector<std::string> ArepsBackgroundLoader::loadedFiles() const
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  return loadedFiles_;
+}
+
+bool ArepsBackgroundLoader::nextFile_(size_t& index)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  if (canceled_ || nextIndex_ >= filenames_.size())
+    return false;
+  index = nextIndex_++;
+  return true;
+}
+
+void ArepsBackgroundLoader::finishFile_(size_t index, Profile* profile)
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+  ++numProcessed_;
+  if (profile == NULL)
+  {
+    ++numFailed_;
+    return;
+  }
+  completed_.push_back(profile);
+  loadedFiles_.push_back(filenames_[index]);
+}
+
+}
@@ -0,0 +1,114 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_RFPROP_AREPS_BACKGROUND_LOADER_H
+#define SIMVIS_RFPROP_AREPS_BACKGROUND_LOADER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "OpenThreads/Mutex"
+#include "osg/Referenced"
+#include "osg/ref_ptr"
+#include "simCore/Common/Common.h"
+#include "simVis/RFProp/ArepsLoader.h"
+#include "simVis/RFProp/Profile.h"
+
+namespace simRF
+{
+class RFPropagationFacade;
+
+/**
+ * Loads a set of AREPS files on a pool of background threads.  Each file produces one
+ * Profile; completed Profiles are queued until the owner retrieves them with
+ * takeCompleted() from the main thread, where they can safely be added to the scene.
+ *
+ * Files are independent of one another, with the exception that the first file of a
+ * set establishes the radar parameters and POD thresholds used by the rest.  The caller
+ * is therefore expected to load the first file synchronously and pass the resulting
+ * ArepsLoader as the template for the background loads.  The template is detached from
+ * its RFPropagationFacade (see ArepsLoader::detachBeamHandler()), so worker threads never
+ * access the facade; construct the loader on the thread that owns the facade.
+ */
+class SDKVIS_EXPORT ArepsBackgroundLoader : public osg::Referenced
+{
+public:
+  /**
+   * Creates a background loader.  Loading does not begin until start() is called.
+   * @param prototype Loader that has already processed the first file of the set; copied for each worker
+   * @param filenames Files to load; all are treated as subsequent files of the set
+   * @param numThreads Number of worker threads; 0 uses the number of processors
+   */
+  ArepsBackgroundLoader(const ArepsLoader& prototype, const std::vector<std::string>& filenames, unsigned int numThreads = 0);
+
+  /** Starts the worker threads */
+  void start();
+
+  /** Requests that workers stop after their current file, and waits for them to exit */
+  void cancel();
+
+  /**
+   * Moves Profiles that have completed loading since the last call into the given vector.
+   * @param profiles Vector to which completed profiles are appended
+   * @return Number of profiles appended
+   */
+  size_t takeCompleted(std::vector<osg::ref_ptr<Profile> >& profiles);
+
+  /** Number of files in the set */
+  size_t numFiles() const;
+  /** Number of files processed so far, successfully or not */
+  size_t numProcessed() const;
+  /** Number of files that failed to load */
+  size_t numFailed() const;
+  /** True once every file has been processed (or the load was canceled) */
+  bool isDone() const;
+  /** Files that loaded successfully, in the order they completed */
+  std::vector<std::string> loadedFiles() const;
+
+protected:
+  /** Waits for worker threads to finish */
+  virtual ~ArepsBackgroundLoader();
+
+private:
+  class Worker;
+
+  /** Returns the index of the next file to load, or false if no files remain */
+  bool nextFile_(size_t& index);
+  /** Records the result of a load from a worker thread */
+  void finishFile_(size_t index, Profile* profile);
+
+  ArepsLoader prototype_;
+  std::vector<std::string> filenames_;
+  unsigned int numThreads_;
+  std::vector<Worker*> workers_;
+
+  mutable OpenThreads::Mutex mutex_;
+  size_t nextIndex_;
+  size_t numProcessed_;
+  size_t numFailed_;
+  bool canceled_;
+  std::deque<osg::ref_ptr<Profile> > completed_;
+  std::vector<std::string> loadedFiles_;
+};
+
+}
+
+#endif /* SIMVIS_RFPROP_AREPS_BACKGROUND_LOADER_H */
@@ -19,7 +19,12 @@
  * disclose, or release this software.
  *
  */
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include "osgDB/FileUtils"
 #include "simCore/LUT/LUT2.h"
 #include "simCore/Calc/Angle.h"
@@ -32,6 +37,7 @@
 #include "simCore/String/Utils.h"
 #include "simCore/String/ValidNumber.h"
 #include "simVis/RFProp/CompositeProfileProvider.h"
+#include "simVis/RFProp/CompressedLUTProfileDataProvider.h"
 #include "simVis/RFProp/LUTProfileDataProvider.h"
 #include "simVis/RFProp/LUT1ProfileDataProvider.h"
 #include "simVis/RFProp/PODProfileDataProvider.h"
@@ -42,6 +48,139 @@
 
 namespace simRF {
 
+namespace
+{
+
+/**
+ * Holds an entire AREPS file in memory, read with a single sequential read, and serves lines from it.
+ * Numeric table lines are returned in place so that values can be parsed without tokenizing into strings.
+ */
+class ArepsFileBuffer
+{
+public:
+  ArepsFileBuffer() : pos_(0) {}
+
+  /** Reads the whole file; returns false if it cannot be read */
+  bool open(const std::string& filename)
+  {
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+      return false;
+    in.seekg(0, std::ios::end);
+    const std::streamoff length = in.tellg();
+    if (length < 0)
+      return false;
+    in.seekg(0, std::ios::beg);
+    // Trailing NUL guarantees that strtol/strtod never read past the buffer
+    data_.resize(static_cast<size_t>(length) + 1, '\0');
+    if (length > 0 && !in.read(&data_[0], length))
+      return false;
+    data_.back() = '\0';
+    pos_ = 0;
+    return true;
+  }
+
+  /** Returns the next line as [begin, end) with trailing white space removed; false at end of file */
+  bool nextLine(const char*& begin, const char*& end)
+  {
+    // data_ always ends in the NUL terminator, which is not part of the content
+    const size_t size = data_.empty() ? 0 : data_.size() - 1;
+    if (pos_ >= size)
+      return false;
+    begin = &data_[pos_];
+    const void* newline = memchr(begin, '\n', size - pos_);
+    const char* lineEnd = newline ? static_cast<const char*>(newline) : &data_[size];
+    pos_ = (lineEnd - &data_[0]) + 1;
+    end = lineEnd;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\r' || end[-1] == '\t' || end[-1] == '\n'))
+      --end;
+    return true;
+  }
+
+  /** Equivalent to simCore::getStrippedLine() */
+  bool getStrippedLine(std::string& str)
+  {
+    const char* begin = NULL;
+    const char* end = NULL;
+    if (!nextLine(begin, end))
+    {
+      str.clear();
+      return false;
+    }
+    str.assign(begin, end);
+    return true;
+  }
+
+private:
+  std::vector<char> data_;
+  size_t pos_;
+};
+
+/** Result of scanning a line for the next numeric value */
+enum ScanResult
+{
+  SCAN_END,   ///< No more values on the line
+  SCAN_VALUE, ///< A value was parsed
+  SCAN_ERROR  ///< The next token is not a valid number of the requested type
+};
+
+/** Skips white space in [pos, end); returns true if a token follows */
+inline bool skipWhiteSpace(const char*& pos, const char* end)
+{
+  while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n'))
+    ++pos;
+  return pos < end;
+}
+
+/** True if the character terminates a white-space delimited token */
+inline bool isTokenEnd(const char* pos, const char* end)
+{
+  return pos == end || *pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n';
+}
+
+/** Parses the next integer token in [pos, end) in place, with the same validity rules as simCore::isValidNumber() */
+ScanResult scanValue(const char*& pos, const char* end, short& val)
+{
+  if (!skipWhiteSpace(pos, end))
+    return SCAN_END;
+  // isValidNumber() rejects anything but an optional sign followed by digits
+  const char* digits = (*pos == '-' || *pos == '+') ? pos + 1 : pos;
+  if (digits == end || *digits < '0' || *digits > '9')
+    return SCAN_ERROR;
+  char* tokenEnd = NULL;
+  errno = 0;
+  const long longVal = strtol(pos, &tokenEnd, 10);
+  if (errno != 0 || tokenEnd > end || !isTokenEnd(tokenEnd, end) ||
+    longVal < std::numeric_limits<short>::min() || longVal > std::numeric_limits<short>::max())
+    return SCAN_ERROR;
+  val = static_cast<short>(longVal);
+  pos = tokenEnd;
+  return SCAN_VALUE;
+}
+
+/** Parses the next real number token in [pos, end) in place, with the same validity rules as simCore::isValidNumber() */
+ScanResult scanValue(const char*& pos, const char* end, float& val)
+{
+  if (!skipWhiteSpace(pos, end))
+    return SCAN_END;
+  // Reject forms that strtod accepts but isValidNumber() does not, such as hex, inf and nan
+  const char* p = (*pos == '-' || *pos == '+') ? pos + 1 : pos;
+  if (p == end || !((*p >= '0' && *p <= '9') || *p == '.'))
+    return SCAN_ERROR;
+  char* tokenEnd = NULL;
+  errno = 0;
+  const double dVal = strtod(pos, &tokenEnd);
+  if (errno != 0 || tokenEnd == pos || tokenEnd > end || !isTokenEnd(tokenEnd, end) ||
+    (tokenEnd - p > 1 && (p[1] == 'x' || p[1] == 'X')) ||
+    dVal < -std::numeric_limits<float>::max() || dVal > std::numeric_limits<float>::max())
+    return SCAN_ERROR;
+  val = static_cast<float>(dVal);
+  pos = tokenEnd;
+  return SCAN_VALUE;
+}
+
+}
+
 ArepsLoader::ArepsLoader(RFPropagationFacade* beamHandler)
   : maxHeight_(0.0),
   minHeight_(0.0),
@@ -50,7 +189,8 @@ ArepsLoader::ArepsLoader(RFPropagationFacade* beamHandler)
   maxRange_(0.0),
   minRange_(0.0),
   antennaHgt_(0.0),
-  beamHandler_(beamHandler)
+  beamHandler_(beamHandler),
+  compressTables_(false)
 {
 }
 
@@ -63,11 +203,30 @@ double ArepsLoader::getAntennaHeight() const
   return antennaHgt_;
 }
 
+void ArepsLoader::setCompressTables(bool compress)
+{
+  compressTables_ = compress;
+}
+
+bool ArepsLoader::compressTables() const
+{
+  return compressTables_;
+}
+
+void ArepsLoader::detachBeamHandler()
+{
+  if (beamHandler_ == NULL)
+    return;
+  radarParams_ = beamHandler_->radarParams();
+  podLossThresholds_ = beamHandler_->getPODLossThreshold();
+  beamHandler_ = NULL;
+}
+
 int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile, bool firstFile)
 {
-  // create stream to input file
-  std::ifstream inFile(arepsFile.c_str());
-  if (!inFile)
+  // read the entire file into memory; numeric tables are parsed in place from the buffer
+  ArepsFileBuffer inFile;
+  if (!inFile.open(arepsFile))
   {
     SIM_ERROR << "Could not open AREPS file: " << simCore::toNativeSeparators(arepsFile) << " for reading" << std::endl;
     return 1;
@@ -81,7 +240,7 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
   double bearingAngleRad = getBearingAngle_(arepsFile);
   RadarParameters radarParameters;
   std::string st;
-  while (simCore::getStrippedLine(inFile, st))
+  while (inFile.getStrippedLine(st))
   {
     // clears vec every time through loop, otherwise, accumulate
     // tokens in vec from previous lines
@@ -208,7 +367,7 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
         else if (beamHandler_ && (st == "[Probability of detection]"))
         {
           // skip comment
-          simCore::getStrippedLine(inFile, st);
+          inFile.getStrippedLine(st);
           // Thresholds in DB for a probability of detection from 1% to 100%, 10 lines of 10 values
           // expected to be positive, in decreasing order;
           // they are sign-inverted by setPODLossThreshold, producing a vector of negative thresholds, in increasing order.
@@ -216,7 +375,7 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
           podVector.reserve(PODProfileDataProvider::POD_VECTOR_SIZE);
           for (size_t i = 0; i < 10; i++)
           {
-            simCore::getStrippedLine(inFile, st);
+            inFile.getStrippedLine(st);
 
             std::vector<std::string> pdVec;
             //remove quotes
@@ -285,7 +444,7 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
       else if (st == "[Clutter to noise ratio]")
       {
         // skip comment
-        simCore::getStrippedLine(inFile, st);
+        inFile.getStrippedLine(st);
 
         simCore::LUT::LUT1<short>* cnr = new simCore::LUT::LUT1<short>();
 
@@ -294,33 +453,31 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
         cnr->initialize(minRange_, maxRange_, numRanges_);
 
         size_t rngCnt = 0;
-        std::vector<std::string> tmpvec;
         do
         {
-          if (simCore::getStrippedLine(inFile, st))
+          const char* pos = NULL;
+          const char* lineEnd = NULL;
+          if (!inFile.nextLine(pos, lineEnd))
           {
-            // tokenize based on white space
-            simCore::stringTokenizer(tmpvec, st);
-          }
-          else
-          {
-            tmpvec.clear();
+            SIM_ERROR << "Incomplete CNR data for AREPS file: " << arepsFile << std::endl;
+            delete cnr;
+            return 1;
           }
-          vecLen = tmpvec.size();
-          for (size_t i = 0; i < vecLen; ++i)
+          ScanResult result;
+          float cnr_dB = 0.f;
+          while ((result = scanValue(pos, lineEnd, cnr_dB)) == SCAN_VALUE && rngCnt < numRanges_)
           {
             // AREPS CNR data stored as decibels, convert to centibels
-            float cnr_dB;
-            if (rngCnt == numRanges_ || !simCore::isValidNumber(tmpvec[i], cnr_dB))
-            {
-              SIM_ERROR << "Invalid CNR data for AREPS file: " << arepsFile << std::endl;
-              delete cnr;
-              return 1;
-            }
             short cnr_cB = static_cast<short>(simCore::rint(cnr_dB * AREPS_SCALE_FACTOR));
             (*cnr)(rngCnt) = cnr_cB;
             rngCnt++;
           }
+          if (result != SCAN_END)
+          {
+            SIM_ERROR << "Invalid CNR data for AREPS file: " << arepsFile << std::endl;
+            delete cnr;
+            return 1;
+          }
         } while (rngCnt < numRanges_);
 
         // data must be populated in the provider prior to assigning to profile, provider takes ownership of the cnr LUT
@@ -343,55 +500,66 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
         simCore::LUT::LUT2<short>* loss = new simCore::LUT::LUT2<short>();
         loss->initialize(minHeight_, maxHeight_, numHeights_, minRange_, maxRange_, numRanges_);
 
-        // parse APM data in AREPS file
-        std::vector<std::string> vec;
-
         // skip InitValue, InvalidValue and GroundValue lines
         // skip comment lines, and then read height based values
-        do
-        {
-          simCore::getStrippedLine(inFile, st);
-        } while (st.find("Height(") == std::string::npos);
+        bool foundHeights = false;
+        while (!foundHeights && inFile.getStrippedLine(st))
+          foundHeights = (st.find("Height(") != std::string::npos);
 
-        for (size_t i = 0; i < static_cast<size_t>(numHeights_); i++)
+        for (size_t i = 0; foundHeights && i < static_cast<size_t>(numHeights_); i++)
         {
           // read first data line
-          simCore::getStrippedLine(inFile, st);
+          const char* pos = NULL;
+          const char* lineEnd = NULL;
+          bool haveLine = inFile.nextLine(pos, lineEnd);
           size_t k = 0;
           do
           {
-            simCore::stringTokenizer(vec, st);
-            for (size_t j = 0; j < vec.size(); j++)
+            if (!haveLine)
+            {
+              foundHeights = false;
+              break;
+            }
+            // values are parsed in place from the file buffer, in centibels, then stored in LUT
+            ScanResult result;
+            short lossVal = 0;
+            while ((result = scanValue(pos, lineEnd, lossVal)) == SCAN_VALUE && k < numRanges_)
             {
-              // read in centibel data, then store in LUT
-              short lossVal = 0;
-              if (k == numRanges_ || !simCore::isValidNumber(vec[j], lossVal))
-              {
-                if (type == ProfileDataProvider::THRESHOLDTYPE_LOSS)
-                {
-                  SIM_ERROR << "Invalid Loss data for AREPS file: " << arepsFile << std::endl;
-                }
-                else
-                {
-                  SIM_ERROR << "Invalid PPF data for AREPS file: " << arepsFile << std::endl;
-                }
-                delete loss;
-                return 1;
-              }
-
               // fix incorrect initialization value
               if (lossVal == AREPS_ERRONEOUS_INIT_VALUE)
                 lossVal = AREPS_INIT_VALUE;
               (*loss)(i, k) = lossVal;
               k++;
             }
-            simCore::getStrippedLine(inFile, st);
+            if (result != SCAN_END)
+            {
+              if (type == ProfileDataProvider::THRESHOLDTYPE_LOSS)
+              {
+                SIM_ERROR << "Invalid Loss data for AREPS file: " << arepsFile << std::endl;
+              }
+              else
+              {
+                SIM_ERROR << "Invalid PPF data for AREPS file: " << arepsFile << std::endl;
+              }
+              delete loss;
+              return 1;
+            }
+            haveLine = inFile.nextLine(pos, lineEnd);
           } while (k < static_cast<size_t>(numRanges_));
         } // end of for numHeights
 
+        if (!foundHeights)
+        {
+          SIM_ERROR << "Incomplete " << ((type == ProfileDataProvider::THRESHOLDTYPE_LOSS) ? "Loss" : "PPF") << " data for AREPS file: " << arepsFile << std::endl;
+          delete loss;
+          return 1;
+        }
+
         // loss/ppf data provided must be populated prior to assigning to profile, provider takes ownership of the LUT
-        profile.addProvider(
-          new simRF::LUTProfileDataProvider(loss, type, 1.0/AREPS_SCALE_FACTOR));
+        if (compressTables_)
+          profile.addProvider(new simRF::CompressedLUTProfileDataProvider(loss, type, 1.0/AREPS_SCALE_FACTOR));
+        else
+          profile.addProvider(new simRF::LUTProfileDataProvider(loss, type, 1.0/AREPS_SCALE_FACTOR));
       }
     }
   } // end of while (simCore::getStrippedLine ...
@@ -409,25 +577,29 @@ int ArepsLoader::loadFile(const std::string& arepsFile, simRF::Profile& profile,
   }
 
 
+  // dependent providers share the facade's parameters, or the copies taken by detachBeamHandler()
+  const PODVectorPtr podLossThresholds = (beamHandler_ != NULL) ? beamHandler_->getPODLossThreshold() : podLossThresholds_;
+  const RadarParametersPtr radarParams = (beamHandler_ != NULL) ? beamHandler_->radarParams() : radarParams_;
+
   // PODProfileDataProvider depends on the loss provider
   const simRF::ProfileDataProvider* lossProvider = profile.getDataProvider()->getProvider(ProfileDataProvider::THRESHOLDTYPE_LOSS);
-  if (beamHandler_ != NULL && lossProvider)
+  if (podLossThresholds && lossProvider)
   {
-    osg::ref_ptr<PODProfileDataProvider> podProvider = new PODProfileDataProvider(lossProvider, beamHandler_->getPODLossThreshold());
+    osg::ref_ptr<PODProfileDataProvider> podProvider = new PODProfileDataProvider(lossProvider, podLossThresholds);
     profile.addProvider(podProvider);
   }
 
   // create providers that depend on the PPF provider
   const simRF::ProfileDataProvider* ppfProvider = profile.getDataProvider()->getProvider(ProfileDataProvider::THRESHOLDTYPE_FACTOR);
-  if (beamHandler_ != NULL && ppfProvider)
+  if (radarParams && ppfProvider)
   {
-    profile.addProvider(new OneWayPowerDataProvider(ppfProvider, beamHandler_->radarParams()));
+    profile.addProvider(new OneWayPowerDataProvider(ppfProvider, radarParams));
 
-    osg::ref_ptr<TwoWayPowerDataProvider> twoWayPowerDataProvider = new TwoWayPowerDataProvider(ppfProvider, beamHandler_->radarParams());
+    osg::ref_ptr<TwoWayPowerDataProvider> twoWayPowerDataProvider = new TwoWayPowerDataProvider(ppfProvider, radarParams);
     profile.addProvider(twoWayPowerDataProvider);
 
     //SNRDataProvider depends on TwoWayPowerDataProvider
-    profile.addProvider(new SNRDataProvider(twoWayPowerDataProvider, beamHandler_->radarParams()));
+    profile.addProvider(new SNRDataProvider(twoWayPowerDataProvider, radarParams));
   }
 
   profile.setBearing(bearingAngleRad);
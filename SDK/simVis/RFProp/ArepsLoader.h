@@ -59,6 +59,27 @@ public:
    */
   double getAntennaHeight() const;
 
+  /**
+   * Sets whether loss and PPF tables are stored compressed (see CompressedLUTProfileDataProvider).
+   * Compressed tables are expanded on first access; default is false.
+   * @param compress true to compress tables as they are loaded
+   */
+  void setCompressTables(bool compress);
+
+  /**
+   * Retrieves whether loss and PPF tables are stored compressed
+   * @return true if tables are compressed as they are loaded
+   */
+  bool compressTables() const;
+
+  /**
+   * Replaces the RFPropagationFacade with the radar parameters and POD thresholds that it holds.
+   * Afterward, subsequent files of the set can be loaded without accessing the facade, for
+   * example from a background thread; first files no longer update the facade.  Call from the
+   * thread that owns the facade.
+   */
+  void detachBeamHandler();
+
 private:
   /**
    * getBearingAngle_() obtains the bearing angle for the file, from the filename;
@@ -77,6 +98,11 @@ private:
   double minRange_;
   double antennaHgt_;
   RFPropagationFacade* beamHandler_;
+  /// radar parameters shared with the facade, used after detachBeamHandler()
+  RadarParametersPtr radarParams_;
+  /// POD thresholds shared with the facade, used after detachBeamHandler()
+  PODVectorPtr podLossThresholds_;
+  bool compressTables_;
 };
 }
 
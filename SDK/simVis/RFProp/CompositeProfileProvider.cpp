@@ -21,6 +21,7 @@
  */
 #include <limits>
 #include "simNotify/Notify.h"
+#include "simVis/RFProp/CompressedLUTProfileDataProvider.h"
 #include "simVis/RFProp/CompositeProfileProvider.h"
 
 namespace simRF
@@ -182,5 +183,38 @@ double CompositeProfileProvider::interpolateValue(double height, double range) c
 {
   return getActiveProvider() ? getActiveProvider()->interpolateValue(height, range) : 0;
 }
+
+size_t CompositeProfileProvider::getStorageSize() const
+{
+  size_t bytes = 0;
+  for (ProfileDataProviderList::const_iterator i = providers_.begin(); i != providers_.end(); ++i)
+    bytes += (*i)->getStorageSize();
+  return bytes;
 }
 
+void CompositeProfileProvider::getCompressedSizes(size_t& compressedBytes, size_t& decompressedBytes) const
+{
+  compressedBytes = 0;
+  decompressedBytes = 0;
+  for (ProfileDataProviderList::const_iterator i = providers_.begin(); i != providers_.end(); ++i)
+  {
+    const CompressedLUTProfileDataProvider* compressed = dynamic_cast<const CompressedLUTProfileDataProvider*>(i->get());
+    if (compressed)
+    {
+      compressedBytes += compressed->getCompressedSize();
+      decompressedBytes += compressed->getDecompressedSize();
+    }
+  }
+}
+
+void CompositeProfileProvider::releaseDecompressed()
+{
+  for (ProfileDataProviderList::const_iterator i = providers_.begin(); i != providers_.end(); ++i)
+  {
+    CompressedLUTProfileDataProvider* compressed = dynamic_cast<CompressedLUTProfileDataProvider*>(i->get());
+    if (compressed)
+      compressed->releaseDecompressed();
+  }
+}
+
+}
@@ -112,6 +112,19 @@ public:
   /** Adds a ProfileDataProvider to this CompositeProfileProvider; if it is the first, make it the active provider */
   void addProvider(ProfileDataProvider* provider);
 
+  /** Returns the sum of the storage sizes of all providers */
+  virtual size_t getStorageSize() const;
+
+  /**
+   * Returns the compressed and expanded sizes of providers that store compressed tables
+   * @param[out] compressedBytes Bytes held in compressed form
+   * @param[out] decompressedBytes Bytes held by currently expanded tables
+   */
+  void getCompressedSizes(size_t& compressedBytes, size_t& decompressedBytes) const;
+
+  /** Frees the expanded tables of providers that store compressed tables; they are expanded again on next access */
+  void releaseDecompressed();
+
 protected:
   /// osg::Referenced-derived
   virtual ~CompositeProfileProvider() {}
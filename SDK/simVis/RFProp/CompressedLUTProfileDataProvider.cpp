@@ -0,0 +1,269 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cassert>
+#include "OpenThreads/ScopedLock"
+#include "simCore/LUT/InterpTable.h"
+#include "simNotify/Notify.h"
+#include "simVis/RFProp/CompressedLUTProfileDataProvider.h"
+
+namespace simRF
+{
+
+namespace
+{
+
+/** Appends an unsigned value as a little-endian base-128 varint */
+inline void appendVarint(std::vector<unsigned char>& out, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<unsigned char>(value));
+}
+
+/** Reads a varint written by appendVarint */
+inline uint32_t readVarint(const unsigned char*& pos)
+{
+  uint32_t value = 0;
+  unsigned int shift = 0;
+  while (*pos & 0x80)
+  {
+    value |= static_cast<uint32_t>(*pos++ & 0x7f) << shift;
+    shift += 7;
+  }
+  value |= static_cast<uint32_t>(*pos++) << shift;
+  return value;
+}
+
+/** Maps signed deltas to unsigned so that small magnitudes encode in few bytes */
+inline uint32_t zigZag(int32_t value)
+{
+  return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+/** Inverse of zigZag() */
+inline int32_t unZigZag(uint32_t value)
+{
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+}
+
+CompressedLUTProfileDataProvider::CompressedLUTProfileDataProvider(simCore::LUT::LUT2<short>* lut, ProfileDataProvider::ThresholdType type, double scalar)
+  : scalar_(scalar),
+    minHeight_(0.0),
+    maxHeight_(0.0),
+    minRange_(0.0),
+    maxRange_(0.0),
+    heightStep_(0.0),
+    rangeStep_(0.0),
+    numHeights_(0),
+    numRanges_(0),
+    expanded_(NULL)
+{
+  setType_(type);
+  // CompressedLUTProfileDataProvider is taking ownership of the lut
+  assert(lut);
+  if (lut == NULL)
+  {
+    SIM_ERROR << "Attempting to assign a NULL LUT to the CompressedLUTProfileDataProvider" << std::endl;
+    return;
+  }
+  minHeight_ = lut->minX();
+  maxHeight_ = lut->maxX();
+  heightStep_ = lut->stepX();
+  numHeights_ = static_cast<unsigned int>(lut->numX());
+  minRange_ = lut->minY();
+  maxRange_ = lut->maxY();
+  rangeStep_ = lut->stepY();
+  numRanges_ = static_cast<unsigned int>(lut->numY());
+  compress_(*lut);
+  delete lut;
+}
+
+CompressedLUTProfileDataProvider::~CompressedLUTProfileDataProvider()
+{
+  delete static_cast<simCore::LUT::LUT2<short>*>(expanded_.get());
+}
+
+void CompressedLUTProfileDataProvider::compress_(const simCore::LUT::LUT2<short>& lut)
+{
+  compressed_.clear();
+  // Most values need 1 byte, and runs collapse to 2; reserve for the common case
+  compressed_.reserve(static_cast<size_t>(numHeights_) * numRanges_ / 2);
+  for (unsigned int h = 0; h < numHeights_; ++h)
+  {
+    int32_t prev = 0;
+    unsigned int r = 0;
+    while (r < numRanges_)
+    {
+      const int32_t value = lut(h, r);
+      if (value != prev)
+      {
+        appendVarint(compressed_, zigZag(value - prev));
+        prev = value;
+        ++r;
+        continue;
+      }
+      // A zero delta starts a run of repeated values
+      unsigned int runEnd = r + 1;
+      while (runEnd < numRanges_ && lut(h, runEnd) == prev)
+        ++runEnd;
+      appendVarint(compressed_, 0);
+      appendVarint(compressed_, runEnd - r);
+      r = runEnd;
+    }
+  }
+  // Release the slack from reserve()
+  std::vector<unsigned char>(compressed_).swap(compressed_);
+}
+
+const simCore::LUT::LUT2<short>& CompressedLUTProfileDataProvider::table_() const
+{
+  // Samples only read the published pointer; the table stays valid since only the non-const releaseDecompressed() frees it
+  const simCore::LUT::LUT2<short>* table = static_cast<const simCore::LUT::LUT2<short>*>(expanded_.get());
+  if (table != NULL)
+    return *table;
+
+  // First access expands under the lock; a thread that lost the race sees the winner's table
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(expandedMutex_);
+  table = static_cast<const simCore::LUT::LUT2<short>*>(expanded_.get());
+  if (table != NULL)
+    return *table;
+
+  simCore::LUT::LUT2<short>* expanded = expand_();
+  // assign() is a full barrier, so the table is completely written before other threads can see it
+  expanded_.assign(expanded, NULL);
+  return *expanded;
+}
+
+simCore::LUT::LUT2<short>* CompressedLUTProfileDataProvider::expand_() const
+{
+  simCore::LUT::LUT2<short>* expanded = new simCore::LUT::LUT2<short>();
+  expanded->initialize(minHeight_, maxHeight_, numHeights_, minRange_, maxRange_, numRanges_);
+  if (compressed_.empty())
+    return expanded;
+
+  const unsigned char* pos = &compressed_[0];
+  for (unsigned int h = 0; h < numHeights_; ++h)
+  {
+    int32_t prev = 0;
+    unsigned int r = 0;
+    while (r < numRanges_)
+    {
+      const uint32_t code = readVarint(pos);
+      if (code != 0)
+      {
+        prev += unZigZag(code);
+        (*expanded)(h, r++) = static_cast<short>(prev);
+        continue;
+      }
+      const uint32_t runLength = readVarint(pos);
+      for (uint32_t k = 0; k < runLength; ++k)
+        (*expanded)(h, r++) = static_cast<short>(prev);
+    }
+  }
+  // If assert fails, compress_() and expand_() disagree on the format
+  assert(pos == &compressed_[0] + compressed_.size());
+  return expanded;
+}
+
+void CompressedLUTProfileDataProvider::releaseDecompressed()
+{
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(expandedMutex_);
+  simCore::LUT::LUT2<short>* expanded = static_cast<simCore::LUT::LUT2<short>*>(expanded_.get());
+  expanded_.assign(NULL, expanded);
+  delete expanded;
+}
+
+size_t CompressedLUTProfileDataProvider::getCompressedSize() const
+{
+  return compressed_.size();
+}
+
+size_t CompressedLUTProfileDataProvider::getDecompressedSize() const
+{
+  return (expanded_.get() == NULL) ? 0 : static_cast<size_t>(numHeights_) * numRanges_ * sizeof(short);
+}
+
+size_t CompressedLUTProfileDataProvider::getStorageSize() const
+{
+  return getCompressedSize() + getDecompressedSize();
+}
+
+unsigned int CompressedLUTProfileDataProvider::getNumRanges() const
+{
+  return numRanges_;
+}
+
+double CompressedLUTProfileDataProvider::getRangeStep() const
+{
+  return rangeStep_;
+}
+
+double CompressedLUTProfileDataProvider::getHeightStep() const
+{
+  return heightStep_;
+}
+
+unsigned int CompressedLUTProfileDataProvider::getNumHeights() const
+{
+  return numHeights_;
+}
+
+double CompressedLUTProfileDataProvider::getMinRange() const
+{
+  return minRange_;
+}
+
+double CompressedLUTProfileDataProvider::getMaxRange() const
+{
+  return maxRange_;
+}
+
+double CompressedLUTProfileDataProvider::getMinHeight() const
+{
+  return minHeight_;
+}
+
+double CompressedLUTProfileDataProvider::getMaxHeight() const
+{
+  return maxHeight_;
+}
+
+double CompressedLUTProfileDataProvider::getValueByIndex(unsigned int heightIndex, unsigned int rangeIndex) const
+{
+  // Apply scalar to convert internal storage back to dB
+  const double val = table_()(heightIndex, rangeIndex);
+  return ((val > AREPS_GROUND_VALUE) ? scalar_ * val : val);
+}
+
+double CompressedLUTProfileDataProvider::interpolateValue(double height, double range) const
+{
+  // Apply scalar to convert internal storage back to dB
+  BilinearInterpolate<short> bil;
+  return scalar_ * simCore::LUT::interpolate(table_(), height, range, bil);
+}
+
+}
@@ -0,0 +1,118 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_RFPROP_COMPRESSED_LUT_PROFILE_DATA_PROVIDER_H
+#define SIMVIS_RFPROP_COMPRESSED_LUT_PROFILE_DATA_PROVIDER_H
+
+#include <vector>
+#include "OpenThreads/Atomic"
+#include "OpenThreads/Mutex"
+#include "simCore/Common/Common.h"
+#include "simCore/LUT/LUT2.h"
+#include "simVis/RFProp/ProfileDataProvider.h"
+
+namespace simRF
+{
+/**
+ * CompressedLUTProfileDataProvider provides the same data as the LUTProfileDataProvider, but holds the
+ * table in a lossless compressed form (per-height-row delta encoding with run-length coded repeats) and
+ * only expands it when a value is first requested.  AREPS loss and PPF tables are smooth along range and
+ * contain long runs of ground and initialization values, so they typically compress by a factor of 2-4.
+ *
+ * Since each Profile represents a single bearing, only bearings that are displayed or queried are
+ * expanded.  Call releaseDecompressed() to return a table to its compressed-only state.  Expansion on
+ * first access is synchronized and later reads take no lock, so the const accessors may be used from
+ * multiple threads.
+ */
+class SDKVIS_EXPORT CompressedLUTProfileDataProvider : public ProfileDataProvider
+{
+public:
+  /**
+   * Creates a new CompressedLUTProfileDataProvider.  The provider compresses the LUT and deletes it.
+   * @param lut The look-up table to use as a data source; provider takes ownership
+   * @param type ProfileDataProvider type
+   * @param scalar Scalar value to store normalized loss values converted from dB, values typically stored as centiBels
+   */
+  CompressedLUTProfileDataProvider(simCore::LUT::LUT2<short>* lut, ProfileDataProvider::ThresholdType type, double scalar = 0.1);
+
+  /**@name data access
+   * @{
+   */
+  virtual unsigned int getNumRanges() const;
+  virtual double getRangeStep() const;
+  virtual double getMinRange() const;
+  virtual double getMaxRange() const;
+
+  virtual unsigned int getNumHeights() const;
+  virtual double getMinHeight() const;
+  virtual double getMaxHeight() const;
+  virtual double getHeightStep() const;
+  virtual double getValueByIndex(unsigned int heightIndex, unsigned int rangeIndex) const;
+  ///@}
+
+  /** @copydoc simRF::ProfileDataProvider::interpolateValue() */
+  virtual double interpolateValue(double hgtMeters, double gndRngMeters) const;
+
+  /** @copydoc simRF::ProfileDataProvider::getStorageSize() */
+  virtual size_t getStorageSize() const;
+
+  /** Returns the size of the compressed table, in bytes */
+  size_t getCompressedSize() const;
+
+  /** Returns the size of the expanded table if it is currently expanded, in bytes; 0 otherwise */
+  size_t getDecompressedSize() const;
+
+  /**
+   * Frees the expanded table, if any; it will be expanded again on next access.  Values must not be
+   * read from other threads during this call.
+   */
+  void releaseDecompressed();
+
+protected:
+  /// osg::Referenced-derived
+  virtual ~CompressedLUTProfileDataProvider();
+
+private:
+  /** Returns the expanded table, expanding it if necessary */
+  const simCore::LUT::LUT2<short>& table_() const;
+  /** Returns a new table expanded from compressed_ */
+  simCore::LUT::LUT2<short>* expand_() const;
+
+  /** Compresses the table into compressed_ */
+  void compress_(const simCore::LUT::LUT2<short>& lut);
+
+  double scalar_;     ///< 2D table scalar value, doubles are scaled to a short for efficient memory use
+  double minHeight_;  ///< minimum height of the table, in meters
+  double maxHeight_;  ///< maximum height of the table, in meters
+  double minRange_;   ///< minimum range of the table, in meters
+  double maxRange_;   ///< maximum range of the table, in meters
+  double heightStep_; ///< height step of the table, in meters
+  double rangeStep_;  ///< range step of the table, in meters
+  unsigned int numHeights_; ///< number of height samples
+  unsigned int numRanges_;  ///< number of range samples
+  std::vector<unsigned char> compressed_;  ///< compressed table data
+  mutable OpenThreads::Mutex expandedMutex_; ///< serializes expansion and release of expanded_
+  mutable OpenThreads::AtomicPtr expanded_; ///< expanded simCore::LUT::LUT2<short>, or NULL if not expanded; published once fully written
+};
+
+}
+
+#endif /* SIMVIS_RFPROP_COMPRESSED_LUT_PROFILE_DATA_PROVIDER_H */
@@ -139,4 +139,9 @@ double LUT1ProfileDataProvider::interpolateValue(double height, double range) co
   return scalar_ * simCore::LUT::interpolate(*lut_, range, lin);
 }
 
+size_t LUT1ProfileDataProvider::getStorageSize() const
+{
+  return lut_->numX() * sizeof(short);
+}
+
 }
@@ -110,5 +110,9 @@ double LUTProfileDataProvider::interpolateValue(double height, double range) con
   return scalar_ * simCore::LUT::interpolate(*lut_, height, range, bil);
 }
 
+size_t LUTProfileDataProvider::getStorageSize() const
+{
+  return lut_->numX() * lut_->numY() * sizeof(short);
 }
 
+}
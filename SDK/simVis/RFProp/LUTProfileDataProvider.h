@@ -70,6 +70,9 @@ public:
   */
   virtual double interpolateValue(double hgtMeters, double gndRngMeters) const;
 
+  /** @copydoc simRF::ProfileDataProvider::getStorageSize() */
+  virtual size_t getStorageSize() const;
+
 protected:
   /// osg::Referenced-derived
   virtual ~LUTProfileDataProvider();
@@ -75,6 +75,12 @@ CompositeProfileProvider* Profile::getDataProvider_()
   return data_;
 }
 
+void Profile::releaseDecompressed()
+{
+  if (data_.valid())
+    data_->releaseDecompressed();
+}
+
 void Profile::setDataProvider(CompositeProfileProvider* dataProvider)
 {
   if (data_ != dataProvider)
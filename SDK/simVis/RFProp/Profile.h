@@ -76,6 +76,9 @@ public:
   /** Sets the DataProvider for this Profile */
   void setDataProvider(CompositeProfileProvider* dataProvider);
 
+  /** Frees expanded tables of compressed data providers; see CompressedLUTProfileDataProvider */
+  void releaseDecompressed();
+
   /** Gets the display thickness, in meters for this Profile. */
   float getDisplayThickness() const;
 
@@ -102,6 +102,12 @@ public:
   /** Retrieves the threshold type value */
   virtual ThresholdType getType() const { return type_; }
 
+  /**
+   * Gets the number of bytes of sample data held by this provider.  Providers that compute their
+   * values from another provider hold no samples and return 0.
+   */
+  virtual size_t getStorageSize() const { return 0; }
+
 protected:
   /// osg::Referenced-derived
   virtual ~ProfileDataProvider() {}
@@ -364,6 +364,30 @@ void ProfileManager::addProfile(Profile* profile)
 {
   if (!profile)
     return;
+  addProfile_(*currentProfileMap_, profile);
+  updateVisibility_();
+}
+
+void ProfileManager::addProfile(double time, Profile* profile)
+{
+  if (!profile)
+    return;
+  std::map<double, BearingProfileMap*>::const_iterator i = timeBearingProfiles_.find(time);
+  if (i == timeBearingProfiles_.end())
+  {
+    // if assert fails, addProfileMap() was not called for this time
+    assert(0);
+    return;
+  }
+  addProfile_(*i->second, profile);
+  if (i->second == currentProfileMap_)
+    updateVisibility_();
+  else
+    profile->setNodeMask(simVis::DISPLAY_MASK_NONE);
+}
+
+void ProfileManager::addProfile_(BearingProfileMap& profileMap, Profile* profile)
+{
 
   profile->setHeight(height_);
   profile->setMode(mode_);
@@ -376,13 +400,12 @@ void ProfileManager::addProfile(Profile* profile)
   profile->setAlpha(alpha_);
 
   // old profile must match exactly
-  Profile *oldProfile = currentProfileMap_->getProfileByBearing(profile->getBearing());
+  Profile *oldProfile = profileMap.getProfileByBearing(profile->getBearing());
   if (oldProfile)
     removeChild(oldProfile);
 
   addChild(profile);
-  currentProfileMap_->addProfile(*profile);
-  updateVisibility_();
+  profileMap.addProfile(*profile);
 }
 
 void ProfileManager::updateVisibility_()
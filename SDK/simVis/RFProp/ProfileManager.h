@@ -110,6 +110,14 @@ public:
    */
   void addProfile(Profile* profile);
 
+  /**
+   * Adds the Profile to the profile map for the given time, without changing the current time.
+   * Profiles added to a map other than the current one are hidden.
+   * @param time Time of the profile map, as passed to addProfileMap(); the map must exist
+   * @param profile Profile to add
+   */
+  void addProfile(double time, Profile* profile);
+
   /**
    * Gets the ColorProvider for this ProfileManager.
    */
@@ -240,6 +248,8 @@ public:
 
 private:
   void updateVisibility_();
+  /** Adds the profile to the given profile map */
+  void addProfile_(BearingProfileMap& profileMap, Profile* profile);
   void initShaders_();
 
 private:
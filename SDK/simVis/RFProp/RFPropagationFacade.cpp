@@ -25,6 +25,7 @@
 #include "simCore/EM/AntennaPattern.h"
 #include "simNotify/Notify.h"
 #include "simVis/Constants.h"
+#include "simVis/RFProp/ArepsBackgroundLoader.h"
 #include "simVis/RFProp/ArepsLoader.h"
 #include "simVis/RFProp/OneWayPowerDataProvider.h"
 #include "simVis/RFProp/PODProfileDataProvider.h"
@@ -94,6 +95,7 @@ RFPropagationFacade::RFPropagationFacade(simData::ObjectId id, osg::Group* paren
  : id_(id),
    antennaHeightMeters_(0.0),
    rfParamsSet_(false),
+   compressProfiles_(false),
    parent_(parent)
 {
   // create locator
@@ -134,6 +136,9 @@ RFPropagationFacade::RFPropagationFacade(simData::ObjectId id, osg::Group* paren
 
 RFPropagationFacade::~RFPropagationFacade()
 {
+  // stop workers rather than let them finish loads that can no longer be delivered
+  for (size_t k = 0; k < backgroundLoads_.size(); ++k)
+    backgroundLoads_[k].second->cancel();
   if (parent_.valid() && locator_.valid())
     parent_->removeChild(locator_.get());
 }
@@ -483,6 +488,9 @@ int RFPropagationFacade::belowColor(osg::Vec4f& color)
 
 int RFPropagationFacade::clearCache(bool reset)
 {
+  for (size_t k = 0; k < backgroundLoads_.size(); ++k)
+    backgroundLoads_[k].second->cancel();
+  backgroundLoads_.clear();
   setDisplay(false);
   arepsFilesetTimeMap_.clear();
   profileList_.clear();
@@ -727,10 +735,11 @@ int RFPropagationFacade::loadArepsFiles(const simCore::TimeStamp& time, const st
   // TODO: we have to update the profileManager_ time to load data at specified time; should we restore previous time after load is completed?
 
   simRF::ArepsLoader arepsLoader(this);
+  arepsLoader.setCompressTables(compressProfiles_);
 
   // TODO: SDK-53
   // it may be desirable to check that height min/max/num, range min/max/num, beam width, and antenna height values for the first file match values obtained from all subsequent files
-  // loading 180 files is very slow, and there are no dependencies between files, so loading could be parallelized.
+  // see loadArepsFilesAsync() for a parallel, non-blocking alternative
 
   // Process AREPS files
   for (size_t ii = 0; ii < filenames.size(); ii++)
@@ -759,6 +768,90 @@ int RFPropagationFacade::loadArepsFiles(const simCore::TimeStamp& time, const st
   return 0;
 }
 
+int RFPropagationFacade::loadArepsFilesAsync(const simCore::TimeStamp& time, const std::vector<std::string>& filenames, unsigned int numThreads)
+{
+  if (filenames.empty())
+    return 1;
+
+  const double timeAsDouble = time.secondsSinceRefYear().Double();
+  profileManager_->addProfileMap(timeAsDouble);
+  profileManager_->update(timeAsDouble);
+
+  // The first file sets the radar parameters and POD thresholds for the set, so it is loaded here
+  simRF::ArepsLoader arepsLoader(this);
+  arepsLoader.setCompressTables(compressProfiles_);
+  osg::ref_ptr<simRF::Profile> profile = new simRF::Profile(new simRF::CompositeProfileProvider());
+  if (0 != arepsLoader.loadFile(filenames[0], *profile, true))
+  {
+    profileManager_->removeProfileMap(timeAsDouble);
+    return 1;
+  }
+  if (arepsFilesetTimeMap_.empty())
+    setAntennaHeight(arepsLoader.getAntennaHeight());
+  setSlotData(profile);
+  arepsFilesetTimeMap_[time].push_back(filenames[0]);
+  setDisplay(true);
+
+  if (filenames.size() > 1)
+  {
+    const std::vector<std::string> remaining(filenames.begin() + 1, filenames.end());
+    osg::ref_ptr<simRF::ArepsBackgroundLoader> loader = new simRF::ArepsBackgroundLoader(arepsLoader, remaining, numThreads);
+    backgroundLoads_.push_back(std::make_pair(time, loader));
+    loader->start();
+  }
+  return 0;
+}
+
+unsigned int RFPropagationFacade::processBackgroundLoads()
+{
+  unsigned int numAdded = 0;
+  std::vector<std::pair<simCore::TimeStamp, osg::ref_ptr<simRF::ArepsBackgroundLoader> > >::iterator i = backgroundLoads_.begin();
+  while (i != backgroundLoads_.end())
+  {
+    // check completion before taking profiles, so that no profile can be left behind
+    const bool done = i->second->isDone();
+    std::vector<osg::ref_ptr<simRF::Profile> > profiles;
+    if (i->second->takeCompleted(profiles) > 0)
+    {
+      // profiles go to the profile map for their time, without changing the map on display
+      const double timeAsDouble = i->first.secondsSinceRefYear().Double();
+      for (std::vector<osg::ref_ptr<simRF::Profile> >::const_iterator p = profiles.begin(); p != profiles.end(); ++p)
+      {
+        profileManager_->addProfile(timeAsDouble, p->get());
+        profileList_.push_back(*p);
+      }
+      numAdded += static_cast<unsigned int>(profiles.size());
+    }
+
+    if (!done)
+    {
+      ++i;
+      continue;
+    }
+
+    // store filenames to support getInputFiles()
+    const std::vector<std::string> loadedFiles = i->second->loadedFiles();
+    std::vector<std::string>& fileset = arepsFilesetTimeMap_[i->first];
+    fileset.insert(fileset.end(), loadedFiles.begin(), loadedFiles.end());
+    if (i->second->numFailed() > 0)
+      SIM_WARN << i->second->numFailed() << " of " << i->second->numFiles() << " AREPS files failed to load for beam " << id_ << std::endl;
+    i = backgroundLoads_.erase(i);
+  }
+  return numAdded;
+}
+
+bool RFPropagationFacade::backgroundLoadProgress(size_t& numProcessed, size_t& numFiles) const
+{
+  numProcessed = 0;
+  numFiles = 0;
+  for (size_t k = 0; k < backgroundLoads_.size(); ++k)
+  {
+    numProcessed += backgroundLoads_[k].second->numProcessed();
+    numFiles += backgroundLoads_[k].second->numFiles();
+  }
+  return !backgroundLoads_.empty();
+}
+
 const simRF::CompositeProfileProvider* RFPropagationFacade::getProfileProvider(double azimRad) const
 {
   const simRF::Profile *profile = getSlotData(azimRad);
@@ -826,6 +919,44 @@ const simRF::Profile* RFPropagationFacade::getProfile(unsigned int index) const
   return (profileList_.size() > index) ? profileList_.at(index) : NULL;
 }
 
+void RFPropagationFacade::setCompressProfiles(bool compress)
+{
+  compressProfiles_ = compress;
+}
+
+bool RFPropagationFacade::compressProfiles() const
+{
+  return compressProfiles_;
+}
+
+RFPropagationFacade::MemoryReport RFPropagationFacade::memoryReport() const
+{
+  MemoryReport report;
+  report.numProfiles = static_cast<unsigned int>(profileList_.size());
+  report.storageBytes = 0;
+  report.compressedBytes = 0;
+  report.decompressedBytes = 0;
+  for (std::vector<osg::ref_ptr<simRF::Profile> >::const_iterator i = profileList_.begin(); i != profileList_.end(); ++i)
+  {
+    const simRF::CompositeProfileProvider* provider = (*i)->getDataProvider();
+    if (provider == NULL)
+      continue;
+    report.storageBytes += provider->getStorageSize();
+    size_t compressed = 0;
+    size_t decompressed = 0;
+    provider->getCompressedSizes(compressed, decompressed);
+    report.compressedBytes += compressed;
+    report.decompressedBytes += decompressed;
+  }
+  return report;
+}
+
+void RFPropagationFacade::releaseDecompressedProfiles()
+{
+  for (std::vector<osg::ref_ptr<simRF::Profile> >::const_iterator i = profileList_.begin(); i != profileList_.end(); ++i)
+    (*i)->releaseDecompressed();
+}
+
 void RFPropagationFacade::setPosition(double latRad, double lonRad)
 {
   profileManager_->setRefCoord(latRad, lonRad, antennaHeight());
@@ -42,6 +42,7 @@ namespace osgEarth {
 
 namespace simRF
 {
+class ArepsBackgroundLoader;
 class CompositeProfileProvider;
 
 /** Facade to the simRF module, managing RF data for a single beam. */
@@ -128,6 +129,73 @@ public:
    */
   int getInputFiles(const simCore::TimeStamp& time, std::vector<std::string>& filenames) const;
 
+  /**
+   * Loads a set of AREPS files, with all but the first file loaded on background threads.
+   * The first file is loaded before returning, since it defines the radar parameters
+   * for the set.  Profiles from the remaining files are handed to the profile manager
+   * by processBackgroundLoads(), which must be called periodically from the main thread.
+   * Background threads do not access the facade; profiles they load share its radar
+   * parameters and POD thresholds, as profiles from loadArepsFiles() do.
+   * @param time Time for which the files are specified
+   * @param filenames AREPS files to load
+   * @param numThreads Number of background threads; 0 uses the number of processors
+   * @return 0 on success (first file loaded and background load started), !0 on error
+   */
+  int loadArepsFilesAsync(const simCore::TimeStamp& time, const std::vector<std::string>& filenames, unsigned int numThreads = 0);
+
+  /**
+   * Adds profiles completed by background loads to the profile maps for their times.
+   * The profile map on display does not change.  Call from the main thread.
+   * @return Number of profiles added
+   */
+  unsigned int processBackgroundLoads();
+
+  /**
+   * Reports progress of pending background loads
+   * @param numProcessed Number of files processed so far, including failures
+   * @param numFiles Total number of files in pending loads
+   * @return True if any background load is pending
+   */
+  bool backgroundLoadProgress(size_t& numProcessed, size_t& numFiles) const;
+
+  /** Memory used by the loaded profile data */
+  struct MemoryReport
+  {
+    /// Number of profiles loaded
+    unsigned int numProfiles;
+    /// Bytes held by all data tables, compressed or not, including expanded copies of compressed tables
+    size_t storageBytes;
+    /// Bytes held by compressed tables in their compressed form
+    size_t compressedBytes;
+    /// Bytes held by the currently expanded copies of compressed tables
+    size_t decompressedBytes;
+  };
+
+  /**
+   * Sets whether AREPS loss and PPF tables are stored compressed.  Applies to files loaded after the call.
+   * Compressed tables are expanded when a profile is first drawn or queried; see releaseDecompressedProfiles().
+   * @param compress true to compress tables as they are loaded; default is false
+   */
+  void setCompressProfiles(bool compress);
+
+  /**
+   * Retrieves whether AREPS loss and PPF tables are stored compressed
+   * @return true if tables are compressed as they are loaded
+   */
+  bool compressProfiles() const;
+
+  /**
+   * Reports the memory used by the loaded profile data
+   * @return memory report for all loaded profiles
+   */
+  MemoryReport memoryReport() const;
+
+  /**
+   * Releases the expanded copies of compressed tables; they are rebuilt on next access.
+   * Useful after a bearing sweep, to return to the compressed footprint.
+   */
+  void releaseDecompressedProfiles();
+
   /**
    * Controls the display of the specified RF propagation data
    * @param option on(true) or off(false)
@@ -501,6 +569,9 @@ private:
   /// indicates whether RF Parameters have been set
   bool rfParamsSet_;
 
+  /// indicates whether AREPS tables are compressed on load
+  bool compressProfiles_;
+
   /// profile manager manages all the profiles that hold the rf prop data
   osg::ref_ptr<simRF::ProfileManager> profileManager_;
 
@@ -519,6 +590,9 @@ private:
   /// vector of all profiles available
   std::vector<osg::ref_ptr<simRF::Profile> > profileList_;
 
+  /// AREPS file sets being loaded in the background, keyed by the timestamp for which they were specified
+  std::vector<std::pair<simCore::TimeStamp, osg::ref_ptr<simRF::ArepsBackgroundLoader> > > backgroundLoads_;
+
   /// shared ptr to the POD Loss thresholds
   PODVectorPtr podLossThresholds_;
 
@@ -26,13 +26,362 @@
 #include "simNotify/Notify.h"
 #include "simCore/Calc/Math.h"
 #include "osgEarth/GeoData"
-#include "osgEarth/Terrain"
+#include "osgEarth/MapNode"
+#include "osgEarth/TerrainEngineNode"
+#include "osgUtil/IntersectionVisitor"
+#include "osgUtil/LineSegmentIntersector"
+#include "OpenThreads/Condition"
+#include "OpenThreads/Mutex"
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
 #include <cassert>
 
 #define LC "[LOS] "
 
 using namespace simVis;
 
+namespace
+{
+  /** Radials from a previous computation whose azimuths differ by less than this (radians) are reused */
+  const double AZIMUTH_MATCH_EPSILON = 1e-9;
+  /** Terrain rays run from this far above the ellipsoid to this far below, in meters */
+  const double TERRAIN_RAY_EXTENT = 50000.0;
+
+  /** Intersects a vertical ray with a terrain graph, reusing one intersector for every query */
+  class TerrainQuery : public RadialLOS::HeightSource::Query
+  {
+  public:
+    explicit TerrainQuery(osg::Node* graph)
+      : graph_(graph),
+        intersector_(new osgUtil::LineSegmentIntersector(osg::Vec3d(), osg::Vec3d()))
+    {
+      intersector_->setIntersectionLimit(osgUtil::Intersector::LIMIT_NEAREST);
+      visitor_.setIntersector(intersector_.get());
+    }
+
+    virtual bool getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae)
+    {
+      if (graph_ == NULL || point.getSRS() == NULL)
+        return false;
+
+      osg::Vec3d start;
+      osg::Vec3d end;
+      osgEarth::GeoPoint(point.getSRS(), point.x(), point.y(), TERRAIN_RAY_EXTENT, osgEarth::ALTMODE_ABSOLUTE).toWorld(start);
+      osgEarth::GeoPoint(point.getSRS(), point.x(), point.y(), -TERRAIN_RAY_EXTENT, osgEarth::ALTMODE_ABSOLUTE).toWorld(end);
+      intersector_->reset();
+      intersector_->setStart(start);
+      intersector_->setEnd(end);
+      visitor_.reset();
+      graph_->accept(visitor_);
+      if (!intersector_->containsIntersections())
+        return false;
+
+      osg::Vec3d hit;
+      point.getSRS()->transformFromWorld(intersector_->getFirstIntersection().getWorldIntersectPoint(), hit, &hae);
+      hamsl = hit.z();
+      return true;
+    }
+
+  private:
+    osg::Node* graph_;
+    osg::ref_ptr<osgUtil::LineSegmentIntersector> intersector_;
+    osgUtil::IntersectionVisitor visitor_;
+  };
+
+  /** Converts a map point to a geodetic LLA position, in radians and meters */
+  bool toLla(const osgEarth::GeoPoint& point, simCore::Vec3& lla)
+  {
+    osgEarth::GeoPoint geoPoint = point;
+    if (!geoPoint.getSRS()->isGeographic() && !point.transform(point.getSRS()->getGeographicSRS(), geoPoint))
+      return false;
+    lla.set(geoPoint.y() * simCore::DEG2RAD, geoPoint.x() * simCore::DEG2RAD, geoPoint.z());
+    return true;
+  }
+
+  /** State shared by all radials of one computation; read only while radials are sampled */
+  struct RadialContext
+  {
+    const RadialLOS::HeightSource* heights;
+    const osgEarth::SpatialReference* mapSRS;
+    /** Serializes height queries without a per-thread query; NULL if the source is thread safe */
+    OpenThreads::Mutex* heightMutex;
+    osg::Matrixd local2world;
+    simCore::Vec3 originLla;
+    /** Converter with its reference origin at the LOS origin */
+    simCore::CoordinateConverter originCC;
+    double rangeMax_m;
+    double rangeRes_m;
+  };
+
+  /** Samples one radial out to the maximum range, keeping its first firstSample samples; query may be NULL */
+  void sampleRadial(const RadialContext& context, RadialLOS::HeightSource::Query* query, RadialLOS::Radial& radial, unsigned int firstSample)
+  {
+    RadialLOS::SampleVector& samples = radial.samples_;
+    samples.erase(samples.begin() + firstSample, samples.end());
+
+    // Track the highest elevation along this azimuth to check for visibility
+    double maxElev = -2 * M_PI;
+    for (RadialLOS::SampleVector::const_iterator i = samples.begin(); i != samples.end(); ++i)
+    {
+      if (i->valid_ && i->elev_rad_ >= maxElev)
+        maxElev = i->elev_rad_;
+    }
+
+    const double x = sin(radial.azim_rad_);
+    const double y = cos(radial.azim_rad_);
+
+    // step through the distance range, continuing from the last kept sample:
+    bool rangeDone = false;
+    for (double range_m = (samples.empty() ? context.rangeRes_m : samples.back().range_m_ + context.rangeRes_m); !rangeDone; range_m += context.rangeRes_m)
+    {
+      if (range_m >= context.rangeMax_m)
+      {
+        range_m = context.rangeMax_m;
+        rangeDone = true;
+      }
+
+      // calculate the world point:
+      osg::Vec3d sampleWorld = osg::Vec3d(x*range_m, y*range_m, 0.0) * context.local2world;
+
+      // convert to a map point
+      osgEarth::GeoPoint mapPoint;
+      mapPoint.fromWorld(context.mapSRS, sampleWorld);
+
+      // sample the terrain at that point
+      double hamsl = 0.0, hae = 0.0;
+      bool ok;
+      if (query)
+        ok = query->getHeight(mapPoint, hamsl, hae);
+      else if (context.heightMutex)
+      {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(*context.heightMutex);
+        ok = context.heights->getHeight(mapPoint, hamsl, hae);
+      }
+      else
+        ok = context.heights->getHeight(mapPoint, hamsl, hae);
+
+      simCore::Vec3 destLla;
+      if (ok)
+      {
+        mapPoint.z() = hae;
+        ok = toLla(mapPoint, destLla);
+      }
+      if (ok)
+      {
+        // see if the point is unobstructed.
+        double elev;
+        simCore::calculateAbsAzEl(context.originLla, destLla, NULL, &elev, NULL, simCore::FLAT_EARTH, &context.originCC);
+
+        bool visible = false;
+        if (elev >= maxElev)
+        {
+          maxElev = elev;
+          visible = true;
+        }
+
+        samples.push_back(RadialLOS::Sample(range_m, mapPoint, hamsl, hae, elev, visible));
+      }
+      else
+      {
+        // record an "invalid" sample
+        samples.push_back(RadialLOS::Sample(range_m, mapPoint));
+      }
+    }
+  }
+
+  /** Hands out radials to the threads sampling them */
+  class RadialQueue
+  {
+  public:
+    RadialQueue(const RadialContext& context, RadialLOS::RadialVector& radials, const std::vector<unsigned int>& firstSamples)
+      : context_(context),
+        radials_(radials),
+        firstSamples_(firstSamples),
+        next_(0)
+    {
+    }
+
+    /** Samples radials until none are left, with a height query owned by the calling thread */
+    void process()
+    {
+      RadialLOS::HeightSource::Query* query = context_.heights->createQuery();
+      size_t index;
+      while (nextRadial_(index))
+        sampleRadial(context_, query, radials_[index], firstSamples_[index]);
+      delete query;
+    }
+
+  private:
+    bool nextRadial_(size_t& index)
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      if (next_ >= radials_.size())
+        return false;
+      index = next_++;
+      return true;
+    }
+
+    const RadialContext& context_;
+    RadialLOS::RadialVector& radials_;
+    const std::vector<unsigned int>& firstSamples_;
+    size_t next_;
+    OpenThreads::Mutex mutex_;
+  };
+
+  /**
+   * Threads that help sample the radials of each computation.  The threads persist between
+   * computations, waiting for the next queue; one computation runs at a time.
+   */
+  class RadialWorkerPool
+  {
+  public:
+    static RadialWorkerPool& instance()
+    {
+      static RadialWorkerPool s_pool;
+      return s_pool;
+    }
+
+    /** Samples all radials in the queue on the calling thread plus up to numHelpers pool threads */
+    void run(RadialQueue& queue, unsigned int numHelpers)
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> runLock(runMutex_);
+      {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+        while (workers_.size() < numHelpers)
+        {
+          Worker* worker = new Worker(*this);
+          workers_.push_back(worker);
+          worker->start();
+        }
+        queue_ = &queue;
+        helpersWanted_ = numHelpers;
+        ++jobId_;
+        workAvailable_.broadcast();
+      }
+
+      queue.process();
+
+      // Helpers that have not picked up the queue yet no longer can; wait for the others
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      queue_ = NULL;
+      helpersWanted_ = 0;
+      while (activeHelpers_ > 0)
+        helpersDone_.wait(&mutex_);
+    }
+
+  private:
+    class Worker : public OpenThreads::Thread
+    {
+    public:
+      explicit Worker(RadialWorkerPool& pool)
+        : pool_(pool)
+      {
+      }
+
+      virtual void run()
+      {
+        pool_.work_();
+      }
+
+    private:
+      RadialWorkerPool& pool_;
+    };
+
+    RadialWorkerPool()
+      : queue_(NULL),
+        helpersWanted_(0),
+        activeHelpers_(0),
+        jobId_(0),
+        done_(false)
+    {
+    }
+
+    ~RadialWorkerPool()
+    {
+      {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+        done_ = true;
+        workAvailable_.broadcast();
+      }
+      for (std::vector<Worker*>::const_iterator i = workers_.begin(); i != workers_.end(); ++i)
+      {
+        (*i)->join();
+        delete *i;
+      }
+    }
+
+    /** Loop of each pool thread; helps with each queue at most once */
+    void work_()
+    {
+      unsigned int lastJob = 0;
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      while (!done_)
+      {
+        if (queue_ == NULL || helpersWanted_ == 0 || jobId_ == lastJob)
+        {
+          workAvailable_.wait(&mutex_);
+          continue;
+        }
+        lastJob = jobId_;
+        --helpersWanted_;
+        ++activeHelpers_;
+        RadialQueue* queue = queue_;
+        {
+          OpenThreads::ReverseScopedLock<OpenThreads::Mutex> unlock(mutex_);
+          queue->process();
+        }
+        if (--activeHelpers_ == 0)
+          helpersDone_.signal();
+      }
+    }
+
+    /** Serializes computations */
+    OpenThreads::Mutex runMutex_;
+    /** Protects the members below */
+    OpenThreads::Mutex mutex_;
+    OpenThreads::Condition workAvailable_;
+    OpenThreads::Condition helpersDone_;
+    std::vector<Worker*> workers_;
+    RadialQueue* queue_;
+    unsigned int helpersWanted_;
+    unsigned int activeHelpers_;
+    unsigned int jobId_;
+    bool done_;
+  };
+}
+
+//----------------------------------------------------------------------------
+
+RadialLOS::TerrainHeightSource::TerrainHeightSource(osgEarth::MapNode* mapNode, osg::Node* patch)
+  : mapNode_(mapNode),
+    patch_(patch)
+{
+  assert(mapNode_ != NULL || patch_ != NULL);
+}
+
+bool RadialLOS::TerrainHeightSource::getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae) const
+{
+  TerrainQuery query(graph_());
+  return query.getHeight(point, hamsl, hae);
+}
+
+bool RadialLOS::TerrainHeightSource::isThreadSafe() const
+{
+  return true;
+}
+
+RadialLOS::HeightSource::Query* RadialLOS::TerrainHeightSource::createQuery() const
+{
+  return new TerrainQuery(graph_());
+}
+
+osg::Node* RadialLOS::TerrainHeightSource::graph_() const
+{
+  if (patch_)
+    return patch_;
+  return (mapNode_ == NULL) ? NULL : mapNode_->getTerrainEngine();
+}
+
 //----------------------------------------------------------------------------
 
 RadialLOS::Sample::Sample(double range_m, const osgEarth::GeoPoint& point)
@@ -75,7 +424,9 @@ RadialLOS::RadialLOS()
     range_resolution_(Distance(1.0, Units::KILOMETERS)),
     azim_center_(Angle(0.0, Units::DEGREES)),
     fov_(Angle(360.0, Units::DEGREES)),
-    azim_resolution_(Angle(15.0, Units::DEGREES))
+    azim_resolution_(Angle(15.0, Units::DEGREES)),
+    sampledRangeRes_m_(0.0),
+    numThreads_(0)
 {
   //nop
 }
@@ -88,7 +439,10 @@ RadialLOS::RadialLOS(const RadialLOS& rhs)
     range_resolution_(rhs.range_resolution_),
     azim_center_(rhs.azim_center_),
     fov_(rhs.fov_),
-    azim_resolution_(rhs.azim_resolution_)
+    azim_resolution_(rhs.azim_resolution_),
+    sampledRangeRes_m_(rhs.sampledRangeRes_m_),
+    numThreads_(rhs.numThreads_),
+    sampledMapNode_(rhs.sampledMapNode_)
 {
   //nop
 }
@@ -138,40 +492,25 @@ void RadialLOS::setAzimuthalResolution(const Angle& value)
   }
 }
 
-bool RadialLOS::compute(osgEarth::MapNode* mapNode, const simCore::Coordinate& originCoord)
+void RadialLOS::setNumThreads(unsigned int value)
 {
-  assert(mapNode != NULL);
+  numThreads_ = value;
+}
 
-  // clear out existing data
+void RadialLOS::clearSamples()
+{
   radials_.clear();
+  dirty_ = true;
+}
 
-  // set up the localizer transforms:
-  if (!convertCoordToGeoPoint(originCoord, originMap_, mapNode->getMapSRS()))
-    return false;
-
-  osg::Matrix local2world, world2local;
-  originMap_.createLocalToWorld(local2world);
-  osg::Vec3d originWorld = osg::Vec3d(0, 0, 0) * local2world;
-
-  // store to world up vector for LOS testing later:
-  osg::Vec3d originUpWorld = osg::Vec3d(0, 0, 1) * local2world;
-  originUpWorld.normalize();
-
-  // first test the elevation at the origin point to see if it's above ground.
-  double relativeZ = 0.0;
-  bool aboveGround =
-    originMap_.transformZ(osgEarth::ALTMODE_RELATIVE, mapNode->getTerrain(), relativeZ) &&
-    relativeZ >= 0.0;
-
+void RadialLOS::getAzimuths_(std::vector<double>& azimuths) const
+{
   // convert everything to the proper units:
   double azim_center  = azim_center_.as(Units::RADIANS);
   double fov          = fov_.as(Units::RADIANS);
   double azim_res_rad = azim_resolution_.as(Units::RADIANS);
-  double range_max_m  = range_max_.as(Units::METERS);
-  double range_res_m  = range_resolution_.as(Units::METERS);
 
   // collect the azimuth list:
-  std::vector<double> azimuths;
   double   azim_min_rad = azim_center - 0.5*fov;
   double   azim_max_rad = azim_center + 0.5*fov;
   double   halfSpan       = 0.5 * (azim_max_rad - azim_min_rad);
@@ -195,91 +534,125 @@ bool RadialLOS::compute(osgEarth::MapNode* mapNode, const simCore::Coordinate& o
   {
     azimuths.push_back(azim_max_rad);
   }
+}
 
-  // step through the azimuthal range:
-  for (std::vector<double>::iterator i = azimuths.begin(); i != azimuths.end(); ++i)
-  {
-    double azim_rad = *i;
-    double x = sin(azim_rad);
-    double y = cos(azim_rad);
-
-    radials_.push_back(Radial(azim_rad));
-    Radial& radial = radials_.back();
-
-    // Track the highest elevation along this azimuth to check for visibility
-    double maxElev = -2 * M_PI;
-    // step through the distance range:
-    bool rangeDone = false;
-    for (double range_m = range_res_m; !rangeDone; range_m += range_res_m)
-    {
-      if (range_m >= range_max_m)
-      {
-        range_m = range_max_m;
-        rangeDone = true;
-      }
-
-      // calculate the world point:
-      osg::Vec3d sampleWorld = osg::Vec3d(x*range_m, y*range_m, 0.0) * local2world;
-
-      // convert to a map point
-      osgEarth::GeoPoint mapPoint;
-      mapPoint.fromWorld(mapNode->getMapSRS(), sampleWorld);
-
-      // sample the terrain at that point
-      double hamsl = 0.0, hae = 0.0;
-
-      bool ok = mapNode->getTerrain()->getHeight(mapPoint.getSRS(), mapPoint.x(), mapPoint.y(), &hamsl, &hae);
+bool RadialLOS::compute(osgEarth::MapNode* mapNode, const simCore::Coordinate& originCoord)
+{
+  assert(mapNode != NULL);
 
-      if (ok)
-      {
-        // see if the point is unobstructed.
-        mapPoint.z() = hae;
-        mapPoint.toWorld(sampleWorld);
+  // Samples from another map's terrain cannot be reused
+  if (sampledMapNode_.get() != mapNode)
+  {
+    clearSamples();
+    sampledMapNode_ = mapNode;
+  }
+  TerrainHeightSource heights(mapNode);
+  return compute(heights, mapNode->getMapSRS(), originCoord);
+}
 
-        simCore::Coordinate destCoord;
-        convertGeoPointToCoord(mapPoint, destCoord, mapNode);
+bool RadialLOS::compute(const HeightSource& heights, const osgEarth::SpatialReference* mapSRS, const simCore::Coordinate& originCoord)
+{
+  assert(mapSRS != NULL);
 
-        simCore::CoordinateConverter cc;
-        simCore::Coordinate originLlaCoord;
-        cc.convert(originCoord, originLlaCoord, simCore::COORD_SYS_LLA);
-        cc.setReferenceOrigin(originLlaCoord.lat(), originLlaCoord.lon(), originLlaCoord.alt());
+  // Radials sampled from the same origin at the same range resolution can be extended rather than resampled
+  RadialVector previous;
+  previous.swap(radials_);
 
-        double elev;
-        simCore::calculateAbsAzEl(originLlaCoord.position(), destCoord.position(), NULL, &elev, NULL, simCore::FLAT_EARTH, &cc);
+  // set up the localizer transforms:
+  osgEarth::GeoPoint originMap;
+  if (!convertCoordToGeoPoint(originCoord, originMap, mapSRS))
+    return false;
 
-        bool visible = false;
-        if (elev >= maxElev)
-        {
-          maxElev = elev;
-          visible = true;
-        }
+  const double range_max_m = range_max_.as(Units::METERS);
+  const double range_res_m = range_resolution_.as(Units::METERS);
+  if (srs_.get() != mapSRS || originMap != originMap_ || sampledRangeRes_m_ != range_res_m)
+    previous.clear();
+  originMap_ = originMap;
 
-        radial.samples_.push_back(Sample(range_m, mapPoint, hamsl, hae, elev, visible));
-      }
-      else
-      {
-        // record an "invalid" sample
-        radial.samples_.push_back(Sample(range_m, mapPoint));
-      }
+  std::vector<double> azimuths;
+  getAzimuths_(azimuths);
+
+  // Match previous radials by azimuth; both lists are in increasing order
+  std::vector<unsigned int> firstSamples;
+  radials_.reserve(azimuths.size());
+  firstSamples.reserve(azimuths.size());
+  RadialVector::iterator prev = previous.begin();
+  for (std::vector<double>::const_iterator i = azimuths.begin(); i != azimuths.end(); ++i)
+  {
+    while (prev != previous.end() && prev->azim_rad_ < *i && !osg::equivalent(prev->azim_rad_, *i, AZIMUTH_MATCH_EPSILON))
+      ++prev;
+    if (prev == previous.end() || !osg::equivalent(prev->azim_rad_, *i, AZIMUTH_MATCH_EPSILON))
+    {
+      radials_.push_back(Radial(*i));
+      firstSamples.push_back(0);
+      continue;
     }
+
+    // Keep the samples inside the new range, except the last one, which was clamped to the old maximum range
+    unsigned int numKept = 0;
+    while (numKept + 1 < prev->samples_.size() && prev->samples_[numKept].range_m_ < range_max_m)
+      ++numKept;
+    radials_.push_back(Radial(*i));
+    radials_.back().samples_.swap(prev->samples_);
+    firstSamples.push_back(numKept);
+    ++prev;
   }
 
-  srs_ = mapNode->getMapSRS();
+  srs_ = mapSRS;
+  sampleRadials_(heights, firstSamples);
 
+  sampledRangeRes_m_ = range_res_m;
   dirty_ = false;
   return true;
 }
 
+void RadialLOS::sampleRadials_(const HeightSource& heights, const std::vector<unsigned int>& firstSamples)
+{
+  RadialContext context;
+  context.heights = &heights;
+  context.mapSRS = srs_.get();
+  context.heightMutex = NULL;
+  context.rangeMax_m = range_max_.as(Units::METERS);
+  context.rangeRes_m = range_resolution_.as(Units::METERS);
+
+  // The origin frame is the same for every sample
+  originMap_.createLocalToWorld(context.local2world);
+  toLla(originMap_, context.originLla);
+  context.originCC.setReferenceOrigin(context.originLla);
+
+  OpenThreads::Mutex heightMutex;
+  if (!heights.isThreadSafe())
+    context.heightMutex = &heightMutex;
+
+  RadialQueue queue(context, radials_, firstSamples);
+
+  unsigned int numThreads = (numThreads_ == 0) ? static_cast<unsigned int>(OpenThreads::GetNumberOfProcessors()) : numThreads_;
+  if (numThreads > radials_.size())
+    numThreads = static_cast<unsigned int>(radials_.size());
+
+  // The calling thread is one of the workers
+  if (numThreads <= 1)
+    queue.process();
+  else
+    RadialWorkerPool::instance().run(queue, numThreads - 1);
+}
+
 bool RadialLOS::update(osgEarth::MapNode* mapNode, const osgEarth::GeoExtent& extent, osg::Node* patch)
 {
-  osg::Vec3d originWorld;
-  originMap_.toWorld(originWorld);
+  TerrainHeightSource heights(mapNode, patch);
+  return update(heights, extent);
+}
 
-  // first test the elevation at the origin point to see if it's above ground.
-  double relativeZ = 0.0;
-  bool aboveGround =
-    originMap_.transformZ(osgEarth::ALTMODE_RELATIVE, mapNode->getTerrain(), relativeZ) &&
-    relativeZ >= 0.0;
+bool RadialLOS::update(const HeightSource& heights, const osgEarth::GeoExtent& extent)
+{
+  // The origin frame is the same for every sample
+  simCore::Vec3 originLla;
+  if (!toLla(originMap_, originLla))
+    return false;
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOrigin(originLla);
+  // Query reused for every sample, if the source provides one
+  HeightSource::Query* query = heights.createQuery();
 
   // NOTE:
   // if any point in the radial falls within the extent, we will have to
@@ -295,11 +668,13 @@ bool RadialLOS::update(osgEarth::MapNode* mapNode, const osgEarth::GeoExtent& ex
 
       if (!sample.point_.isValid() || extent.contains(sample.point_))
       {
-        bool ok = mapNode->getTerrain()->getHeight(patch, sample.point_.getSRS(), sample.point_.x(), sample.point_.y(), &sample.hamsl_m_, &sample.hae_m_);
+        bool ok = query ? query->getHeight(sample.point_, sample.hamsl_m_, sample.hae_m_) : heights.getHeight(sample.point_, sample.hamsl_m_, sample.hae_m_);
 
-        if (ok && firstNewSampleIndex == ~(0u))
+        if (ok)
         {
-          firstNewSampleIndex = sampleIndex;
+          sample.valid_ = true;
+          if (firstNewSampleIndex == ~(0u))
+            firstNewSampleIndex = sampleIndex;
         }
       }
     }
@@ -308,36 +683,21 @@ bool RadialLOS::update(osgEarth::MapNode* mapNode, const osgEarth::GeoExtent& ex
     // visibility from there on out.
     if (firstNewSampleIndex != ~(0u))
     {
-      osg::Matrix local2world;
-      originMap_.createLocalToWorld(local2world);
-
-      osg::Vec3d originUpWorld = osg::Vec3d(0, 0, 1) * local2world;
-      originUpWorld.normalize();
-
       double maxElev = -2 * M_PI;
       for (unsigned int sampleIndex = 0; sampleIndex < radial.samples_.size(); ++sampleIndex)
       {
         Sample& sample = radial.samples_[sampleIndex];
+        if (!sample.valid_)
+          continue;
 
         // recalculate the elevation for all the new samples only.
         if (sampleIndex >= firstNewSampleIndex)
         {
           // see if the point is unobstructed.
           sample.point_.z() = sample.hae_m_;
-
-          simCore::Coordinate destCoord;
-          convertGeoPointToCoord(sample.point_, destCoord, mapNode);
-          simCore::Coordinate originCoord;
-          convertGeoPointToCoord(originMap_, originCoord, mapNode);
-
-          simCore::CoordinateConverter cc;
-          simCore::Coordinate originLlaCoord;
-          cc.convert(originCoord, originLlaCoord, simCore::COORD_SYS_LLA);
-          cc.setReferenceOrigin(originLlaCoord.lat(), originLlaCoord.lon(), originLlaCoord.alt());
-
-          double elev;
-          simCore::calculateAbsAzEl(originLlaCoord.position(), destCoord.position(), NULL, &elev, NULL, simCore::FLAT_EARTH, &cc);
-          sample.elev_rad_ = elev;
+          simCore::Vec3 destLla;
+          if (toLla(sample.point_, destLla))
+            simCore::calculateAbsAzEl(originLla, destLla, NULL, &sample.elev_rad_, NULL, simCore::FLAT_EARTH, &cc);
         }
 
         if (sample.elev_rad_ >= maxElev)
@@ -352,6 +712,7 @@ bool RadialLOS::update(osgEarth::MapNode* mapNode, const osgEarth::GeoExtent& ex
       }
     }
   }
+  delete query;
   return true;
 }
 
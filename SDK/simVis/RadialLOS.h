@@ -29,16 +29,92 @@
 #include "osgEarth/GeoData"
 #include "osgEarth/SpatialReference"
 #include "osg/Node"
+#include "osg/observer_ptr"
 
 namespace simVis
 {
 
 /**
  * Samples the terrain in a radial pattern around an origin point.
+ *
+ * Radials are evaluated in parallel on a pool of threads that persists between
+ * computations.  Terrain heights come from a HeightSource; the MapNode versions of
+ * compute() and update() sample the map's terrain, with each thread intersecting the
+ * terrain through its own query.  When compute() is called again with the same origin and range
+ * resolution, radials that were already sampled are kept and only extended, so
+ * growing the range or the field of view does not resample the existing terrain.
  */
 class SDKVIS_EXPORT RadialLOS
 {
 public:
+  /**
+   * Interface to the terrain heights sampled by the LOS computation.
+   */
+  class SDKVIS_EXPORT HeightSource
+  {
+  public:
+    virtual ~HeightSource() {}
+
+    /**
+     * Retrieves the terrain height at a point
+     * @param[in ] point Point in the map SRS; Z is ignored
+     * @param[out] hamsl Height above mean sea level, in meters
+     * @param[out] hae Height above ellipsoid, in meters
+     * @return True if a height is available at the point
+     */
+    virtual bool getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae) const = 0;
+
+    /** Returns true if getHeight() may be called from several threads at once */
+    virtual bool isThreadSafe() const = 0;
+
+    /** Height query holding per-thread state; used by one thread at a time */
+    class SDKVIS_EXPORT Query
+    {
+    public:
+      virtual ~Query() {}
+
+      /** @copydoc HeightSource::getHeight() */
+      virtual bool getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae) = 0;
+    };
+
+    /**
+     * Creates a query for the calling thread.  Each thread that samples radials creates its
+     * own query, so queries may keep scratch state such as an intersector.  Returns NULL by
+     * default, in which case getHeight() is called, serialized if the source is not thread safe.
+     * @return New query owned by the caller, or NULL
+     */
+    virtual Query* createQuery() const { return NULL; }
+  };
+
+  /**
+   * HeightSource that intersects the terrain of a map node.  Each query owns its intersector
+   * and only reads the terrain graph, so threads intersect concurrently; the graph must not
+   * be modified during compute() or update(), which holds in the update traversal.
+   */
+  class SDKVIS_EXPORT TerrainHeightSource : public HeightSource
+  {
+  public:
+    /**
+     * Constructs a source that samples the terrain of the given map node, or the patch if given.
+     * The map node may be NULL if a patch is given.
+     */
+    explicit TerrainHeightSource(osgEarth::MapNode* mapNode, osg::Node* patch = NULL);
+
+    /** @copydoc HeightSource::getHeight() */
+    virtual bool getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae) const;
+    /** @copydoc HeightSource::isThreadSafe() */
+    virtual bool isThreadSafe() const;
+    /** @copydoc HeightSource::createQuery() */
+    virtual Query* createQuery() const;
+
+  private:
+    /** Returns the graph to intersect */
+    osg::Node* graph_() const;
+
+    osgEarth::MapNode* mapNode_;
+    osg::Node* patch_;
+  };
+
   /**
    * Terrain sample at a given relative location.
    */
@@ -152,6 +228,18 @@ public:
    */
   const Angle& getAzimuthalResolution() const { return azim_resolution_; }
 
+  /**
+   * Sets the number of threads used to evaluate radials, including the calling thread
+   * @param[in ] value Thread count; 0 uses one thread per processor
+   */
+  void setNumThreads(unsigned int value);
+
+  /**
+   * Gets the number of threads used to evaluate radials
+   * @return Thread count; 0 means one thread per processor
+   */
+  unsigned int getNumThreads() const { return numThreads_; }
+
 
 public:
 
@@ -163,6 +251,17 @@ public:
    */
   bool compute(osgEarth::MapNode* mapNode, const simCore::Coordinate& origin);
 
+  /**
+   * Compute the entire set of terrain samples using the current settings, sampling heights
+   * from the given source.  Radials already sampled from the same origin are extended rather
+   * than resampled; call clearSamples() first if the source's heights have changed.
+   * @param[in ] heights Source of terrain heights
+   * @param[in ] mapSRS  SRS of the map points passed to the height source
+   * @param[in ] origin  Origin point for the LOS computation
+   * @return True upon success
+   */
+  bool compute(const HeightSource& heights, const osgEarth::SpatialReference* mapSRS, const simCore::Coordinate& origin);
+
   /**
    * Re-samples the terrain for all sample points that fall within the specified extent.
    * @param[in ] mapNode Map interface to use for sampling
@@ -172,6 +271,17 @@ public:
    */
   bool update(osgEarth::MapNode* mapNode, const osgEarth::GeoExtent& extent, osg::Node* patch = NULL);
 
+  /**
+   * Re-samples the terrain for all sample points that fall within the specified extent.
+   * @param[in ] heights Source of terrain heights
+   * @param[in ] extent  Geospatial extent within which to update the samples
+   * @return True upon success
+   */
+  bool update(const HeightSource& heights, const osgEarth::GeoExtent& extent);
+
+  /** Discards all samples, so that the next compute() resamples every radial */
+  void clearSamples();
+
   /**
    * Gets the number of samples in each radial
    * @return Sample count
@@ -231,9 +341,19 @@ private:
   Angle               fov_;
   Angle               azim_resolution_;
   osg::ref_ptr<const osgEarth::SpatialReference> srs_;
+  /** Range resolution, in meters, of the samples in radials_ */
+  double              sampledRangeRes_m_;
+  unsigned int        numThreads_;
+  /** Map node whose terrain was last sampled through the MapNode interface */
+  osg::observer_ptr<osgEarth::MapNode> sampledMapNode_;
 
   bool getBoundingRadials_(double azim_rad, const Radial*& out_r0, const Radial*& out_r1, double& out_mix) const;
 
+  /** Computes the azimuths of the radials for the current settings */
+  void getAzimuths_(std::vector<double>& azimuths) const;
+  /** Samples each radial out to the maximum range in parallel, keeping samples before the radial's entry in firstSamples */
+  void sampleRadials_(const HeightSource& heights, const std::vector<unsigned int>& firstSamples);
+
   bool makeRadial_(Radial& out_radial) const;
 };
 
@@ -19,6 +19,9 @@
  * disclose, or release this software.
  *
  */
+#include <map>
+#include "OpenThreads/Mutex"
+#include "OpenThreads/ScopedLock"
 #include "osg/Depth"
 #include "osg/Geode"
 #include "osg/Geometry"
@@ -39,6 +42,7 @@
 #include "simCore/EM/Decibel.h"
 
 #include "simVis/Constants.h"
+#include "simVis/EMFileCache.h"
 #include "simVis/Utils.h"
 #include "simVis/Registry.h"
 #include "simVis/Platform.h"
@@ -68,6 +72,123 @@ namespace
     simCore::calculateVelocity(1.0, ypr.yaw(), ypr.pitch(), enuVector);
     return osg::Vec3d(enuVector.x(), enuVector.y(), enuVector.z());
   }
+
+  /** Depth attributes shared by every association */
+  struct SharedDepth
+  {
+    osg::ref_ptr<osg::Depth> test_;    ///< Depth tested, not written
+    osg::ref_ptr<osg::Depth> always_;  ///< Always passes, not written
+    osg::ref_ptr<osg::Depth> label_;   ///< Always passes and written, for labels
+
+    SharedDepth()
+      : test_(new osg::Depth(osg::Depth::LEQUAL, 0, 1, false)),
+        always_(new osg::Depth(osg::Depth::ALWAYS, 0.0, 1.0, false)),
+        label_(new osg::Depth(osg::Depth::ALWAYS))
+    {
+    }
+  };
+
+  SharedDepth& sharedDepth()
+  {
+    static SharedDepth s_depth;
+    return s_depth;
+  }
+
+  /** Returns a state set shared by every graphic drawn with the same stipple and width */
+  osg::StateSet* sharedStateSet(unsigned short lineStipple, unsigned int lineWidth, bool polygonStipple)
+  {
+    typedef std::pair<std::pair<unsigned short, unsigned int>, bool> Key;
+    static OpenThreads::Mutex s_mutex;
+    static std::map<Key, osg::ref_ptr<osg::StateSet> > s_stateSets;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(s_mutex);
+    osg::ref_ptr<osg::StateSet>& stateSet = s_stateSets[Key(std::make_pair(lineStipple, lineWidth), polygonStipple)];
+    if (!stateSet.valid())
+    {
+      stateSet = new osg::StateSet();
+      if (polygonStipple)
+        stateSet->setAttributeAndModes(new osg::PolygonStipple(gPatternMask1), 1);
+      stateSet->setAttributeAndModes(new osg::LineStipple(1, lineStipple), 1);
+      if (lineWidth != 1)
+        stateSet->setAttributeAndModes(new osg::LineWidth(lineWidth), 1);
+    }
+    return stateSet.get();
+  }
+
+  /** Copies the vertices into the geometry's own vertex array, reusing the array if it has one */
+  void setVertices(osg::Geometry* geom, const osg::Vec3Array* verts)
+  {
+    osg::Vec3Array* existing = dynamic_cast<osg::Vec3Array*>(geom->getVertexArray());
+    if (existing)
+    {
+      existing->assign(verts->begin(), verts->end());
+      existing->dirty();
+      geom->dirtyBound();
+    }
+    else
+      geom->setVertexArray(new osg::Vec3Array(verts->begin(), verts->end()));
+  }
+
+  /** Sets the overall color of the geometry, reusing its color array if it has one */
+  void setColor(osg::Geometry* geom, const osg::Vec4f& color)
+  {
+    osg::Vec4Array* colors = dynamic_cast<osg::Vec4Array*>(geom->getColorArray());
+    if (colors && colors->size() == 1)
+    {
+      if ((*colors)[0] != color)
+      {
+        (*colors)[0] = color;
+        colors->dirty();
+      }
+      return;
+    }
+    colors = new osg::Vec4Array(1);
+    (*colors)[0] = color;
+    geom->setColorArray(colors);
+    geom->setColorBinding(osg::Geometry::BIND_OVERALL);
+  }
+
+  /**
+   * Sets the primitive set at the index, updating the existing set in place if it is the same kind.
+   * The geometry never keeps primSet itself, so that its sets are not shared with other geometry.
+   */
+  void setPrimitiveSet(osg::Geometry* geom, unsigned int index, const osg::PrimitiveSet* primSet)
+  {
+    if (index < geom->getNumPrimitiveSets())
+    {
+      osg::PrimitiveSet* existing = geom->getPrimitiveSet(index);
+      osg::DrawArrays* existingArrays = dynamic_cast<osg::DrawArrays*>(existing);
+      const osg::DrawArrays* arrays = dynamic_cast<const osg::DrawArrays*>(primSet);
+      if (existingArrays && arrays)
+      {
+        existingArrays->set(arrays->getMode(), arrays->getFirst(), arrays->getCount());
+        existingArrays->dirty();
+        return;
+      }
+      osg::DrawElementsUByte* existingElements = dynamic_cast<osg::DrawElementsUByte*>(existing);
+      const osg::DrawElementsUByte* elements = dynamic_cast<const osg::DrawElementsUByte*>(primSet);
+      if (existingElements && elements)
+      {
+        existingElements->setMode(elements->getMode());
+        existingElements->assign(elements->begin(), elements->end());
+        existingElements->dirty();
+        return;
+      }
+    }
+
+    osg::PrimitiveSet* copy = static_cast<osg::PrimitiveSet*>(primSet->clone(osg::CopyOp::SHALLOW_COPY));
+    if (index < geom->getNumPrimitiveSets())
+      geom->setPrimitiveSet(index, copy);
+    else
+      geom->addPrimitiveSet(copy);
+  }
+
+  /** Removes primitive sets past the given count */
+  void trimPrimitiveSets(osg::Geometry* geom, unsigned int numSets)
+  {
+    if (geom->getNumPrimitiveSets() > numSets)
+      geom->removePrimitiveSet(numSets, geom->getNumPrimitiveSets() - numSets);
+  }
 }
 
 
@@ -167,6 +288,34 @@ void RangeTool::setDirty()
   root_->scheduleRefresh();
 }
 
+RangeTool::UpdateStats RangeTool::updateStats() const
+{
+  UpdateStats stats;
+  for (AssociationVector::const_iterator i = associations_.begin(); i != associations_.end(); ++i)
+  {
+    const UpdateStats& assocStats = (*i)->updateStats();
+    stats.rebuilds_ += assocStats.rebuilds_;
+    stats.inPlaceUpdates_ += assocStats.inPlaceUpdates_;
+    stats.skippedUpdates_ += assocStats.skippedUpdates_;
+  }
+  return stats;
+}
+
+void RangeTool::resetUpdateStats()
+{
+  for (AssociationVector::const_iterator i = associations_.begin(); i != associations_.end(); ++i)
+    (*i)->resetUpdateStats();
+}
+
+//------------------------------------------------------------------------
+
+RangeTool::UpdateStats::UpdateStats()
+  : rebuilds_(0),
+    inPlaceUpdates_(0),
+    skippedUpdates_(0)
+{
+}
+
 //------------------------------------------------------------------------
 
 RangeTool::GraphicOptions::GraphicOptions()
@@ -361,7 +510,7 @@ void RangeTool::Measurement::calculateTrueAngles_(const RangeTool::State& state,
   }
   else
   {
-    simCore::calculateAbsAzEl(state.beginEntity_.lla_, state.endEntity_.lla_, az, el, cmp, state.earthModel_, &state.coordConv_);
+    RangeToolEngine::trueAngles(state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_, az, el, cmp);
   }
 }
 
@@ -456,7 +605,7 @@ RangeTool::Association::Association(simData::ObjectId id1, simData::ObjectId id2
   simVis::setLighting(s, 0);
   s->setMode(GL_BLEND, 1);
   s->setMode(GL_CULL_FACE, 0);
-  s->setAttributeAndModes(new osg::Depth(osg::Depth::LEQUAL, 0, 1, false));
+  s->setAttributeAndModes(sharedDepth().test_.get());
   geode_->setName("Line");
 
   labels_ = new osg::Geode();
@@ -464,7 +613,7 @@ RangeTool::Association::Association(simData::ObjectId id1, simData::ObjectId id2
   simVis::setLighting(s, 0);
   s->setMode(GL_BLEND, 1);
   s->setMode(GL_CULL_FACE, 0);
-  s->setAttributeAndModes(new osg::Depth(osg::Depth::LEQUAL, 0, 1, false));
+  s->setAttributeAndModes(sharedDepth().test_.get());
   labels_->setName("Graphics");
 
   // group exists solely to house the horizon culler, since cull callbacks do not
@@ -557,10 +706,17 @@ bool RangeTool::Association::update(ScenarioManager* scenario, double timestamp)
 
     resetDirty();
   }
+  else
+    ++stats_.skippedUpdates_;
 
   return true;
 }
 
+void RangeTool::Association::resetUpdateStats()
+{
+  stats_ = UpdateStats();
+}
+
 void RangeTool::Association::setDirty()
 {
   this->labels_->removeDrawables(0, labels_->getNumDrawables()); // Clear existing labels to force a refresh to update colors if needed
@@ -607,6 +763,9 @@ void RangeTool::Association::refresh_(EntityNode* obj0, EntityNode* obj1, Scenar
     return;
   }
 
+  // graphics update the previous refresh's geometry in place where they can
+  state.recycledGeometry_.swap(geometry_);
+
   // initialize coordinate system and converter to optimize repeated conversions and support other values (flat projections)
   state.coordConv_.setReferenceOrigin(state.beginEntity_.lla_);
 
@@ -643,11 +802,9 @@ void RangeTool::Association::refresh_(EntityNode* obj0, EntityNode* obj1, Scenar
 
       if (graphic->graphicOptions().useDepthTest_ == false)
       {
-        geode_->getOrCreateStateSet()->setAttributeAndModes(
-          new osg::Depth(osg::Depth::ALWAYS, 0.0, 1.0, false),
+        geode_->getOrCreateStateSet()->setAttributeAndModes(sharedDepth().always_.get(),
           osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
-        labels_->getOrCreateStateSet()->setAttributeAndModes(
-          new osg::Depth(osg::Depth::ALWAYS, 0.0, 1.0, false),
+        labels_->getOrCreateStateSet()->setAttributeAndModes(sharedDepth().always_.get(),
           osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
       }
       else if (geode_->getStateSet())
@@ -682,6 +839,13 @@ void RangeTool::Association::refresh_(EntityNode* obj0, EntityNode* obj1, Scenar
     }
   }
 
+  // geometry not handed out this time is released
+  geometry_.swap(state.acquiredGeometry_);
+  if (state.numCreatedGeometry_ > 0)
+    ++stats_.rebuilds_;
+  else
+    ++stats_.inPlaceUpdates_;
+
   // finally, assemble the labels.
   unsigned int labelCount = 0;
   unsigned int originalLabelCount = labels_->getNumDrawables();
@@ -749,7 +913,7 @@ void RangeTool::Association::refresh_(EntityNode* obj0, EntityNode* obj1, Scenar
       case TextOptions::OUTLINE_THICK: text->setBackdropOffset(simVis::outlineThickness(simData::TO_THICK));
         break;
       }
-      text->getOrCreateStateSet()->setAttributeAndModes(new osg::Depth(osg::Depth::ALWAYS), 1);
+      text->getOrCreateStateSet()->setAttributeAndModes(sharedDepth().label_.get(), 1);
       text->getOrCreateStateSet()->setRenderBinDetails(BIN_LABEL, BIN_GLOBAL_SIMSDK);
       labels_->addDrawable(text);
     }
@@ -775,27 +939,21 @@ void RangeTool::Association::refresh_(EntityNode* obj0, EntityNode* obj1, Scenar
 
 void RangeTool::LineGraphic::createGeometry(osg::Vec3Array* verts, osg::PrimitiveSet* primSet, osg::Geode* geode, State& state, bool subdivide)
 {
-  if (primSet && primSet->getNumIndices() > 0)
+  // geometry keeps copies of the arrays so that it can be updated in place on the next refresh
+  osg::ref_ptr<osg::Vec3Array> vertsRef(verts);
+  osg::ref_ptr<osg::PrimitiveSet> primSetRef(primSet);
+  if (geode && primSet && primSet->getNumIndices() > 0)
   {
     // To support the double-stippling pattern we have to make two geometries. If the first
     // stipple is 0xFFFF, just make one.
     for (unsigned int i = 0; i < 2; ++i)
     {
-      osg::Geometry* geom = new osg::Geometry();
-      geom->setUseVertexBufferObjects(true);
-
-      geom->setVertexArray(verts);
-      geom->addPrimitiveSet(primSet);
-
-      osg::Vec4Array* colors = new osg::Vec4Array(1);
-      (*colors)[0] = (i==0) ? options_.lineColor1_ : options_.lineColor2_;
-      geom->setColorArray(colors);
-      geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-
-      osg::StateSet* ss = geom->getOrCreateStateSet();
-      ss->setAttributeAndModes(new osg::LineStipple(1, (i==0) ? options_.lineStipple1_ : options_.lineStipple2_), 1);
-      if (options_.lineWidth_ != 1.0f)
-        ss->setAttributeAndModes(new osg::LineWidth(options_.lineWidth_), 1);
+      osg::Geometry* geom = state.acquireGeometry();
+      setVertices(geom, verts);
+      setPrimitiveSet(geom, 0, primSet);
+      trimPrimitiveSets(geom, 1);
+      setColor(geom, (i==0) ? options_.lineColor1_ : options_.lineColor2_);
+      geom->setStateSet(sharedStateSet((i==0) ? options_.lineStipple1_ : options_.lineStipple2_, options_.lineWidth_, false));
 
       geode->addDrawable(geom);
 
@@ -811,38 +969,9 @@ void RangeTool::LineGraphic::createGeometry(osg::Vec3Array* verts, osg::Primitiv
 
 void RangeTool::PieSliceGraphic::createGeometry(const osg::Vec3& originVec, osg::Vec3d startVec, osg::Vec3d endVec, double angle, osg::Geode* geode, RangeTool::State& state)
 {
-  osg::Geometry*  arcEndVecGeom = NULL;
-  osg::Geometry*  startVecGeom  = NULL;
-  osg::Vec3Array* verts         = NULL;
-
+  osg::ref_ptr<osg::Vec3Array> verts;
   if (geode)
-  {
-    arcEndVecGeom = new osg::Geometry();
-    arcEndVecGeom->setUseVertexBufferObjects(true);
-
     verts = new osg::Vec3Array();
-    arcEndVecGeom->setVertexArray(verts);
-
-    osg::Vec4Array* colors = new osg::Vec4Array(1);
-    (*colors)[0] = options_.pieColor_;
-    arcEndVecGeom->setColorArray(colors);
-    arcEndVecGeom->setColorBinding(osg::Geometry::BIND_OVERALL);
-
-    osg::StateSet* ss = arcEndVecGeom->getOrCreateStateSet();
-    ss->setAttributeAndModes(new osg::PolygonStipple(gPatternMask1), 1);
-    ss->setAttributeAndModes(new osg::LineStipple(1, options_.lineStipple1_), 1);
-
-    geode->addDrawable(arcEndVecGeom);
-
-    // the geometry that holds the start vector; it shares the contents of the
-    // first geometry, but applies a different state set.
-    startVecGeom = new osg::Geometry();
-    startVecGeom->setUseVertexBufferObjects(true);
-    startVecGeom->setVertexArray(verts);
-    startVecGeom->setColorArray(colors);
-    startVecGeom->setColorBinding(osg::Geometry::BIND_OVERALL);
-    geode->addDrawable(startVecGeom);
-  }
 
   osg::BoundingBox bbox;
   startVec.normalize();
@@ -896,20 +1025,35 @@ void RangeTool::PieSliceGraphic::createGeometry(const osg::Vec3& originVec, osg:
 
   if (geode)
   {
-    arcEndVecGeom->addPrimitiveSet(new osg::DrawArrays(GL_TRIANGLE_FAN, 0, seg+1));
-
     verts->push_back(startVec * pieRadius * 1.5 + originVec);
     verts->push_back(endVec   * pieRadius * 1.5 + originVec);
 
-    osg::DrawElementsUByte* startVecPrim = new osg::DrawElementsUByte(GL_LINES);
+    osg::ref_ptr<osg::DrawArrays> arcPrim = new osg::DrawArrays(GL_TRIANGLE_FAN, 0, seg+1);
+    osg::ref_ptr<osg::DrawElementsUByte> startVecPrim = new osg::DrawElementsUByte(GL_LINES);
     startVecPrim->push_back(0);
     startVecPrim->push_back(verts->size()-2);
-    startVecGeom->addPrimitiveSet(startVecPrim);
-
-    osg::DrawElementsUByte* endVecPrim = new osg::DrawElementsUByte(GL_LINES);
+    osg::ref_ptr<osg::DrawElementsUByte> endVecPrim = new osg::DrawElementsUByte(GL_LINES);
     endVecPrim->push_back(0);
     endVecPrim->push_back(verts->size()-1);
-    arcEndVecGeom->addPrimitiveSet(endVecPrim);
+
+    osg::Geometry* arcEndVecGeom = state.acquireGeometry();
+    setVertices(arcEndVecGeom, verts.get());
+    setPrimitiveSet(arcEndVecGeom, 0, arcPrim.get());
+    setPrimitiveSet(arcEndVecGeom, 1, endVecPrim.get());
+    trimPrimitiveSets(arcEndVecGeom, 2);
+    setColor(arcEndVecGeom, options_.pieColor_);
+    arcEndVecGeom->setStateSet(sharedStateSet(options_.lineStipple1_, 1, true));
+    geode->addDrawable(arcEndVecGeom);
+
+    // the geometry that holds the start vector; it has the same vertices as the
+    // first geometry, but no stipple state.
+    osg::Geometry* startVecGeom = state.acquireGeometry();
+    setVertices(startVecGeom, verts.get());
+    setPrimitiveSet(startVecGeom, 0, startVecPrim.get());
+    trimPrimitiveSets(startVecGeom, 1);
+    setColor(startVecGeom, options_.pieColor_);
+    startVecGeom->setStateSet(NULL);
+    geode->addDrawable(startVecGeom);
   }
 
 #ifdef DRAW_PIE_NORMAL
@@ -936,6 +1080,29 @@ osg::Vec3 RangeTool::PieSliceGraphic::labelPos(State& state)
 
 //----------------------------------------------------------------------------
 
+RangeTool::State::State()
+  : earthModel_(simCore::WGS_84),
+    numCreatedGeometry_(0)
+{
+}
+
+osg::Geometry* RangeTool::State::acquireGeometry()
+{
+  osg::ref_ptr<osg::Geometry> geom;
+  if (acquiredGeometry_.size() < recycledGeometry_.size())
+    geom = recycledGeometry_[acquiredGeometry_.size()];
+  else
+  {
+    geom = new osg::Geometry();
+    geom->setUseVertexBufferObjects(true);
+    // updated in place while the previous frame may still be drawing
+    geom->setDataVariance(osg::Object::DYNAMIC);
+    ++numCreatedGeometry_;
+  }
+  acquiredGeometry_.push_back(geom);
+  return geom.get();
+}
+
 void RangeTool::State::line(const simCore::Vec3& lla0, const simCore::Vec3& lla1, double altOffset, osg::Vec3Array* verts)
 {
   // Use Sodano method to calculate azimuth and distance
@@ -1957,7 +2124,7 @@ RangeTool::GroundDistanceMeasurement::GroundDistanceMeasurement()
 
 double RangeTool::GroundDistanceMeasurement::value(State& state) const
 {
-  return simCore::calculateGroundDist(state.beginEntity_.lla_, state.endEntity_.lla_, state.earthModel_, &state.coordConv_);
+  return RangeToolEngine::value(RangeToolEngine::GROUND_DISTANCE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::GroundDistanceMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -1973,7 +2140,7 @@ RangeTool::SlantDistanceMeasurement::SlantDistanceMeasurement()
 
 double RangeTool::SlantDistanceMeasurement::value(State& state) const
 {
-  return simCore::calculateSlant(state.beginEntity_.lla_, state.endEntity_.lla_, state.earthModel_, &state.coordConv_);
+  return RangeToolEngine::value(RangeToolEngine::SLANT_DISTANCE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::SlantDistanceMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -1989,7 +2156,7 @@ RangeTool::AltitudeDeltaMeasurement::AltitudeDeltaMeasurement()
 
 double RangeTool::AltitudeDeltaMeasurement::value(State& state) const
 {
-  return simCore::calculateAltitude(state.beginEntity_.lla_, state.endEntity_.lla_, state.earthModel_, &state.coordConv_);
+  return RangeToolEngine::value(RangeToolEngine::ALTITUDE_DELTA, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::AltitudeDeltaMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2059,9 +2226,7 @@ RangeTool::DownRangeMeasurement::DownRangeMeasurement()
 
 double RangeTool::DownRangeMeasurement::value(State& state) const
 {
-  double dr;
-  simCore::calculateDRCRDownValue(state.beginEntity_.lla_, state.beginEntity_.ypr_.x(), state.endEntity_.lla_, state.earthModel_, &state.coordConv_, &dr, NULL, NULL);
-  return dr;
+  return RangeToolEngine::value(RangeToolEngine::DOWN_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::DownRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2077,9 +2242,7 @@ RangeTool::CrossRangeMeasurement::CrossRangeMeasurement()
 
 double RangeTool::CrossRangeMeasurement::value(State& state) const
 {
-  double cr;
-  simCore::calculateDRCRDownValue(state.beginEntity_.lla_, state.beginEntity_.ypr_.x(), state.endEntity_.lla_, state.earthModel_, &state.coordConv_, NULL, &cr, NULL);
-  return cr;
+  return RangeToolEngine::value(RangeToolEngine::CROSS_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::CrossRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2095,9 +2258,7 @@ RangeTool::DownRangeCrossRangeDownValueMeasurement::DownRangeCrossRangeDownValue
 
 double RangeTool::DownRangeCrossRangeDownValueMeasurement::value(State& state) const
 {
-  double dv;
-  simCore::calculateDRCRDownValue(state.beginEntity_.lla_, state.beginEntity_.ypr_.x(), state.endEntity_.lla_, state.earthModel_, &state.coordConv_, NULL, NULL, &dv);
-  return dv;
+  return RangeToolEngine::value(RangeToolEngine::DOWN_VALUE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::DownRangeCrossRangeDownValueMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2113,9 +2274,7 @@ RangeTool::GeoDownRangeMeasurement::GeoDownRangeMeasurement()
 
 double RangeTool::GeoDownRangeMeasurement::value(State& state) const
 {
-  double dr;
-  simCore::calculateGeodesicDRCR(state.beginEntity_.lla_, state.beginEntity_.ypr_.x(), state.endEntity_.lla_, &dr, NULL);
-  return dr;
+  return RangeToolEngine::value(RangeToolEngine::GEO_DOWN_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::GeoDownRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2131,9 +2290,7 @@ RangeTool::GeoCrossRangeMeasurement::GeoCrossRangeMeasurement()
 
 double RangeTool::GeoCrossRangeMeasurement::value(State& state) const
 {
-  double cr;
-  simCore::calculateGeodesicDRCR(state.beginEntity_.lla_, state.beginEntity_.ypr_.x(), state.endEntity_.lla_, NULL, &cr);
-  return cr;
+  return RangeToolEngine::value(RangeToolEngine::GEO_CROSS_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::GeoCrossRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2224,7 +2381,7 @@ void RangeTool::RelOriMeasurement::getAngles(double* az, double* el, double* cmp
   }
   else
   {
-    simCore::calculateRelAzEl(state.beginEntity_.lla_, state.beginEntity_.ypr_, state.endEntity_.lla_, az, el, cmp, state.earthModel_, &state.coordConv_);
+    RangeToolEngine::relOriAngles(state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_, az, el, cmp);
   }
 }
 
@@ -2303,7 +2460,7 @@ void RangeTool::RelVelMeasurement::getAngles(double* az, double* el, double* cmp
   }
   else
   {
-    simCore::calculateRelAzEl(state.beginEntity_.lla_, fpaVec, state.endEntity_.lla_, az, el, cmp, state.earthModel_, &state.coordConv_);
+    RangeToolEngine::relVelAngles(state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_, az, el, cmp);
   }
 }
 
@@ -2368,7 +2525,7 @@ RangeTool::ClosingVelocityMeasurement::ClosingVelocityMeasurement()
 
 double RangeTool::ClosingVelocityMeasurement::value(State& state) const
 {
-  return simCore::calculateClosingVelocity(state.beginEntity_.lla_, state.endEntity_.lla_, state.earthModel_, &state.coordConv_, state.beginEntity_.vel_, state.endEntity_.vel_);
+  return RangeToolEngine::value(RangeToolEngine::CLOSING_VELOCITY, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::ClosingVelocityMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2384,7 +2541,7 @@ RangeTool::SeparationVelocityMeasurement::SeparationVelocityMeasurement()
 
 double RangeTool::SeparationVelocityMeasurement::value(State& state) const
 {
-  return -simCore::calculateClosingVelocity(state.beginEntity_.lla_, state.endEntity_.lla_, state.earthModel_, &state.coordConv_, state.beginEntity_.vel_, state.endEntity_.vel_);
+  return RangeToolEngine::value(RangeToolEngine::SEPARATION_VELOCITY, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::SeparationVelocityMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2400,7 +2557,7 @@ RangeTool::VelocityDeltaMeasurement::VelocityDeltaMeasurement()
 
 double RangeTool::VelocityDeltaMeasurement::value(State& state) const
 {
-  return simCore::calculateVelocityDelta(state.beginEntity_.lla_, state.endEntity_.lla_, state.earthModel_, &state.coordConv_, state.beginEntity_.vel_, state.endEntity_.vel_);
+  return RangeToolEngine::value(RangeToolEngine::VELOCITY_DELTA, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::VelocityDeltaMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2416,11 +2573,7 @@ RangeTool::VelAzimDownRangeMeasurement::VelAzimDownRangeMeasurement()
 
 double RangeTool::VelAzimDownRangeMeasurement::value(State& state) const
 {
-  double downRng=0;
-  simCore::Vec3 fpa;
-  simCore::calculateFlightPathAngles(state.beginEntity_.vel_, fpa);
-  simCore::calculateDRCRDownValue(state.beginEntity_.lla_, fpa[0], state.endEntity_.lla_, state.earthModel_, &state.coordConv_, &downRng, NULL, NULL);
-  return downRng;
+  return RangeToolEngine::value(RangeToolEngine::VEL_AZIM_DOWN_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::VelAzimDownRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2436,11 +2589,7 @@ RangeTool::VelAzimCrossRangeMeasurement::VelAzimCrossRangeMeasurement()
 
 double RangeTool::VelAzimCrossRangeMeasurement::value(State& state) const
 {
-  double crossRng=0;
-  simCore::Vec3 fpa;
-  simCore::calculateFlightPathAngles(state.beginEntity_.vel_, fpa);
-  simCore::calculateDRCRDownValue(state.beginEntity_.lla_, fpa[0], state.endEntity_.lla_, state.earthModel_, &state.coordConv_, NULL, &crossRng, NULL);
-  return crossRng;
+  return RangeToolEngine::value(RangeToolEngine::VEL_AZIM_CROSS_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::VelAzimCrossRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2456,11 +2605,7 @@ RangeTool::VelAzimGeoDownRangeMeasurement::VelAzimGeoDownRangeMeasurement()
 
 double RangeTool::VelAzimGeoDownRangeMeasurement::value(State& state) const
 {
-  double downRng=0;
-  simCore::Vec3 fpa;
-  simCore::calculateFlightPathAngles(state.beginEntity_.vel_, fpa);
-  simCore::calculateGeodesicDRCR(state.beginEntity_.lla_, fpa[0], state.endEntity_.lla_, &downRng, NULL);
-  return downRng;
+  return RangeToolEngine::value(RangeToolEngine::VEL_AZIM_GEO_DOWN_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::VelAzimGeoDownRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2476,11 +2621,7 @@ RangeTool::VelAzimGeoCrossRangeMeasurement::VelAzimGeoCrossRangeMeasurement()
 
 double RangeTool::VelAzimGeoCrossRangeMeasurement::value(State& state) const
 {
-  double crossRng=0;
-  simCore::Vec3 fpa;
-  simCore::calculateFlightPathAngles(state.beginEntity_.vel_, fpa);
-  simCore::calculateGeodesicDRCR(state.beginEntity_.lla_, fpa[0], state.endEntity_.lla_, NULL, &crossRng);
-  return crossRng;
+  return RangeToolEngine::value(RangeToolEngine::VEL_AZIM_GEO_CROSS_RANGE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::VelAzimGeoCrossRangeMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2496,7 +2637,7 @@ RangeTool::AspectAngleMeasurement::AspectAngleMeasurement()
 
 double RangeTool::AspectAngleMeasurement::value(State& state) const
 {
-  return simCore::calculateAspectAngle(state.beginEntity_.lla_, state.endEntity_.lla_, state.endEntity_.ypr_);
+  return RangeToolEngine::value(RangeToolEngine::ASPECT_ANGLE, state.beginEntity_, state.endEntity_, state.earthModel_, state.coordConv_);
 }
 
 bool RangeTool::AspectAngleMeasurement::willAccept(const simVis::RangeTool::State& state) const
@@ -2573,6 +2714,8 @@ void RangeTool::RfMeasurement::getRfParameters_(State& state, double *azAbs, dou
         simCore::PolarityType type = (beam != NULL) ? beam->polarity() : simCore::POLARITY_UNKNOWN;
         const double frequency = simCore::DEFAULT_FREQUENCY;
         simCore::calculateRelAzEl(state.endEntity_.lla_, state.endEntity_.ypr_, state.beginEntity_.lla_, &azTarget, &elTarget, NULL, state.earthModel_, &state.coordConv_);
+        // RCS instances are shared through the EMFileCache
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(EMFileCache::evaluationMutex());
         if (useDb)
           rcsLocal = rcsPtr->RCSdB(frequency, azTarget, elTarget, type);
         else
@@ -24,6 +24,7 @@
 
 #include <sstream>
 
+#include "osg/Geometry"
 #include "osg/Group"
 #include "osg/MatrixTransform"
 #include "osgEarth/Revisioning"
@@ -35,6 +36,7 @@
 #include "simData/DataStore.h"
 #include "simVis/Scenario.h"
 #include "simVis/Platform.h"
+#include "simVis/RangeToolEngine.h"
 #include "simVis/Tool.h"
 #include "simVis/Utils.h"
 
@@ -132,11 +134,8 @@ namespace simVis
     /**
     * Entity state needed to do Range calculations
     */
-    struct SDKVIS_EXPORT EntityState
+    struct SDKVIS_EXPORT EntityState : public RangeToolEngine::Kinematics
     {
-      simCore::Vec3 lla_;  ///< Lat, lon, alt in rad, rad, m
-      simCore::Vec3 ypr_;  ///< Yaw, pitch, roll in rad, rad, rad
-      simCore::Vec3 vel_;  ///< X, Y and Z velocities in m/s
       osg::ref_ptr<const simVis::EntityNode> node_; ///< The node of the entity
       simData::ObjectId platformHostId_;   ///< Unique ID of the host entity; for platforms platformHostId_ == id_
       osg::ref_ptr<const simVis::PlatformNode> platformHostNode_; ///< The node of the host platform; for platforms platformHostNode_ == node_
@@ -158,6 +157,8 @@ namespace simVis
     */
     struct SDKVIS_EXPORT State
     {
+      State();
+
       /**
        * Coordinate data saved in the coord_ member variable for later use
        * Local coordinate mean LTP with OBJ 0 at the origin
@@ -229,6 +230,15 @@ namespace simVis
       */
       int populateEntityState(const simVis::ScenarioManager& scenario, const simVis::EntityNode* node, EntityState& state);
 
+      /**
+      * Returns a geometry for a graphic to fill in.  Geometry from the association's previous
+      * refresh is handed out first, in render order, so that graphics can update its arrays in
+      * place; new geometry is allocated only when none is left.  The caller owns the geometry's
+      * arrays and primitive sets, and should replace its state set.
+      * @return Geometry to fill in and add to the geode
+      */
+      osg::Geometry* acquireGeometry();
+
       /**@name internal state (TODO: make private)
        *@{
        */
@@ -239,6 +249,9 @@ namespace simVis
       simCore::EarthModelCalculations  earthModel_;
       simCore::CoordinateConverter     coordConv_;
       osgEarth::optional<osg::Vec3d>   coord_[16];  // 16 equals the number of enumerations in State::Coord
+      std::vector< osg::ref_ptr<osg::Geometry> > recycledGeometry_;  // geometry from the previous refresh, available for reuse
+      std::vector< osg::ref_ptr<osg::Geometry> > acquiredGeometry_;  // geometry handed out during this refresh
+      unsigned int                     numCreatedGeometry_;  // geometry allocated during this refresh
       ///@}
     };
 
@@ -567,6 +580,18 @@ namespace simVis
     /// vector of Calculation pointers
     typedef std::vector< osg::ref_ptr<Calculation> > CalculationVector;
 
+    /**
+    * Counts of how associations responded to updates, for profiling
+    */
+    struct SDKVIS_EXPORT UpdateStats
+    {
+      UpdateStats();
+
+      unsigned int rebuilds_;        ///< Refreshes that allocated new geometry
+      unsigned int inPlaceUpdates_;  ///< Refreshes that updated the previous geometry in place
+      unsigned int skippedUpdates_;  ///< Updates skipped because neither entity's locator changed
+    };
+
     /**
     * Associated two entities from the scenario, and draws one or more
     * calculations applied to those entities.
@@ -634,6 +659,16 @@ namespace simVis
       */
       osg::Node* getNode() const { return xform_.get(); }
 
+      /**
+      * Gets the counts of rebuilt, updated in place and skipped refreshes
+      */
+      const UpdateStats& updateStats() const { return stats_; }
+
+      /**
+      * Resets the update counters to zero
+      */
+      void resetUpdateStats();
+
     private:
       simData::ObjectId                  id1_, id2_;             // id's of the associated entities
       bool                               dirty_;                 // whether the scene geometry needs rebuilding
@@ -646,6 +681,8 @@ namespace simVis
       osgEarth::Revision                 obj1LocatorRev_;        // tracks whether entity 1 is up to date with scenario data
       osgEarth::Revision                 obj2LocatorRev_;        // tracks whether entity 2 is up to date with scenario data
       CalculationVector                  calculations_;          // calculations to render
+      std::vector< osg::ref_ptr<osg::Geometry> > geometry_;      // geometry rendered by the last refresh, reused by the next
+      UpdateStats                        stats_;                 // update counters
 
     protected:
       /// osg::Referenced-derived
@@ -693,6 +730,17 @@ namespace simVis
      */
     void update(ScenarioManager* scenario) { onUpdate(scenario, 0.0, EntityVector()); }
 
+    /**
+    * Gets the update counters summed over all associations
+    * @return Counts of rebuilt, updated in place and skipped refreshes
+    */
+    UpdateStats updateStats() const;
+
+    /**
+    * Resets the update counters of all associations to zero
+    */
+    void resetUpdateStats();
+
     /**
     * Gets the node representing the range tool's graphics.
     * @returns an OSG node
@@ -743,8 +791,8 @@ namespace simVis
       }
 
       /** add our geometry to 'geode'
-       * @param verts vertex array to use (shared reference)
-       * @param primSet primitive set to use (shared reference)
+       * @param verts vertex array to use; copied into the geometry
+       * @param primSet primitive set to use; copied into the geometry
        * @param geode root node to attach to
        * @param state control display settings
        * @param subdivide not currently used
@@ -0,0 +1,449 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <map>
+#include "OpenThreads/Mutex"
+#include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Vec3.h"
+#include "simData/DataStore.h"
+#include "simData/LinearInterpolator.h"
+#include "simVis/RangeToolEngine.h"
+
+namespace simVis {
+
+namespace
+{
+  /** Work divided into items that can be processed in any order on any thread */
+  class ParallelTask
+  {
+  public:
+    explicit ParallelTask(size_t numItems)
+      : numItems_(numItems),
+        next_(0)
+    {
+    }
+    virtual ~ParallelTask() {}
+
+    /** Processes items until none are left */
+    void process()
+    {
+      size_t index;
+      while (nextItem_(index))
+        processItem(index);
+    }
+
+  protected:
+    /** Processes one item; called from multiple threads */
+    virtual void processItem(size_t index) = 0;
+
+  private:
+    bool nextItem_(size_t& index)
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      if (next_ >= numItems_)
+        return false;
+      index = next_++;
+      return true;
+    }
+
+    size_t numItems_;
+    size_t next_;
+    OpenThreads::Mutex mutex_;
+  };
+
+  /** Worker thread that processes items of a task */
+  class TaskWorker : public OpenThreads::Thread
+  {
+  public:
+    explicit TaskWorker(ParallelTask& task)
+      : task_(task)
+    {
+    }
+
+    virtual void run()
+    {
+      task_.process();
+    }
+
+  private:
+    ParallelTask& task_;
+  };
+
+  /** Processes all items of the task on up to numThreads threads, including the calling thread */
+  void runTask(ParallelTask& task, size_t numItems, unsigned int numThreads)
+  {
+    if (numThreads == 0)
+      numThreads = static_cast<unsigned int>(OpenThreads::GetNumberOfProcessors());
+    if (numThreads > numItems)
+      numThreads = static_cast<unsigned int>(numItems);
+
+    std::vector<TaskWorker*> workers;
+    for (unsigned int k = 1; k < numThreads; ++k)
+    {
+      TaskWorker* worker = new TaskWorker(task);
+      workers.push_back(worker);
+      worker->start();
+    }
+    task.process();
+    for (std::vector<TaskWorker*>::const_iterator i = workers.begin(); i != workers.end(); ++i)
+    {
+      (*i)->join();
+      delete *i;
+    }
+  }
+
+  /** Samples the kinematics of each platform at each time */
+  class SamplePlatformsTask : public ParallelTask
+  {
+  public:
+    SamplePlatformsTask(const RangeToolEngine& engine, const std::vector<uint64_t>& ids, const std::vector<double>& times,
+      std::vector<RangeToolEngine::Kinematics>& kinematics, std::vector<unsigned char>& valid)
+      : ParallelTask(ids.size()),
+        engine_(engine),
+        ids_(ids),
+        times_(times),
+        kinematics_(kinematics),
+        valid_(valid)
+    {
+    }
+
+  protected:
+    virtual void processItem(size_t index)
+    {
+      const size_t offset = index * times_.size();
+      for (size_t k = 0; k < times_.size(); ++k)
+        valid_[offset + k] = (engine_.platformKinematics(ids_[index], times_[k], kinematics_[offset + k]) == 0) ? 1 : 0;
+    }
+
+  private:
+    const RangeToolEngine& engine_;
+    const std::vector<uint64_t>& ids_;
+    const std::vector<double>& times_;
+    std::vector<RangeToolEngine::Kinematics>& kinematics_;
+    std::vector<unsigned char>& valid_;
+  };
+
+  /** Evaluates every measurement at every time for each pair */
+  class EvaluatePairsTask : public ParallelTask
+  {
+  public:
+    EvaluatePairsTask(simCore::EarthModelCalculations earthModel, const std::vector<RangeToolEngine::MeasurementType>& measurements,
+      size_t numTimes, const std::vector<std::pair<size_t, size_t> >& pairSlots,
+      const std::vector<RangeToolEngine::Kinematics>& kinematics, const std::vector<unsigned char>& kinematicsValid,
+      RangeToolEngine::TimeSeries& results)
+      : ParallelTask(pairSlots.size()),
+        earthModel_(earthModel),
+        measurements_(measurements),
+        numTimes_(numTimes),
+        pairSlots_(pairSlots),
+        kinematics_(kinematics),
+        kinematicsValid_(kinematicsValid),
+        results_(results)
+    {
+    }
+
+  protected:
+    virtual void processItem(size_t index)
+    {
+      const size_t beginOffset = pairSlots_[index].first * numTimes_;
+      const size_t endOffset = pairSlots_[index].second * numTimes_;
+      simCore::CoordinateConverter coordConv;
+      for (size_t k = 0; k < numTimes_; ++k)
+      {
+        const bool valid = kinematicsValid_[beginOffset + k] && kinematicsValid_[endOffset + k];
+        const RangeToolEngine::Kinematics& begin = kinematics_[beginOffset + k];
+        const RangeToolEngine::Kinematics& end = kinematics_[endOffset + k];
+        // Same reference origin as the live Range Tool
+        if (valid)
+          coordConv.setReferenceOrigin(begin.lla_);
+        for (size_t m = 0; m < measurements_.size(); ++m)
+        {
+          const size_t resultIndex = results_.seriesOffset(index, m) + k;
+          results_.valid_[resultIndex] = valid ? 1 : 0;
+          results_.values_[resultIndex] = valid ? RangeToolEngine::value(measurements_[m], begin, end, earthModel_, coordConv) : 0.0;
+        }
+      }
+    }
+
+  private:
+    simCore::EarthModelCalculations earthModel_;
+    const std::vector<RangeToolEngine::MeasurementType>& measurements_;
+    size_t numTimes_;
+    const std::vector<std::pair<size_t, size_t> >& pairSlots_;
+    const std::vector<RangeToolEngine::Kinematics>& kinematics_;
+    const std::vector<unsigned char>& kinematicsValid_;
+    RangeToolEngine::TimeSeries& results_;
+  };
+}
+
+//----------------------------------------------------------------------------
+
+RangeToolEngine::TimeSeries::TimeSeries()
+  : numPairs_(0),
+    numMeasurements_(0),
+    numTimes_(0)
+{
+}
+
+size_t RangeToolEngine::TimeSeries::seriesOffset(size_t pairIndex, size_t measurementIndex) const
+{
+  return (pairIndex * numMeasurements_ + measurementIndex) * numTimes_;
+}
+
+//----------------------------------------------------------------------------
+
+RangeToolEngine::RangeToolEngine(const simData::DataStore& dataStore)
+  : dataStore_(dataStore),
+    earthModel_(simCore::WGS_84),
+    numThreads_(0),
+    interpolate_(true)
+{
+}
+
+RangeToolEngine::~RangeToolEngine()
+{
+}
+
+void RangeToolEngine::setEarthModel(simCore::EarthModelCalculations earthModel)
+{
+  earthModel_ = earthModel;
+}
+
+simCore::EarthModelCalculations RangeToolEngine::earthModel() const
+{
+  return earthModel_;
+}
+
+void RangeToolEngine::setNumThreads(unsigned int numThreads)
+{
+  numThreads_ = numThreads;
+}
+
+unsigned int RangeToolEngine::numThreads() const
+{
+  return numThreads_;
+}
+
+void RangeToolEngine::setInterpolate(bool interpolate)
+{
+  interpolate_ = interpolate;
+}
+
+bool RangeToolEngine::interpolate() const
+{
+  return interpolate_;
+}
+
+int RangeToolEngine::evaluate(const std::vector<EntityPair>& pairs, const std::vector<MeasurementType>& measurements,
+  const std::vector<double>& times, TimeSeries& results) const
+{
+  // Each platform is sampled once, no matter how many pairs it is in
+  std::map<uint64_t, size_t> slots;
+  std::vector<uint64_t> ids;
+  std::vector<std::pair<size_t, size_t> > pairSlots;
+  pairSlots.reserve(pairs.size());
+  for (std::vector<EntityPair>::const_iterator i = pairs.begin(); i != pairs.end(); ++i)
+  {
+    size_t pairSlot[2];
+    const uint64_t pairIds[2] = { i->first, i->second };
+    for (size_t k = 0; k < 2; ++k)
+    {
+      std::map<uint64_t, size_t>::const_iterator slot = slots.find(pairIds[k]);
+      if (slot != slots.end())
+      {
+        pairSlot[k] = slot->second;
+        continue;
+      }
+      if (dataStore_.objectType(pairIds[k]) != simData::DataStore::PLATFORM)
+        return 1;
+      pairSlot[k] = ids.size();
+      slots[pairIds[k]] = ids.size();
+      ids.push_back(pairIds[k]);
+    }
+    pairSlots.push_back(std::make_pair(pairSlot[0], pairSlot[1]));
+  }
+
+  results.numPairs_ = pairs.size();
+  results.numMeasurements_ = measurements.size();
+  results.numTimes_ = times.size();
+  const size_t numValues = pairs.size() * measurements.size() * times.size();
+  results.values_.assign(numValues, 0.0);
+  results.valid_.assign(numValues, 0);
+  if (numValues == 0)
+    return 0;
+
+  std::vector<Kinematics> kinematics(ids.size() * times.size());
+  std::vector<unsigned char> kinematicsValid(ids.size() * times.size(), 0);
+  SamplePlatformsTask sampleTask(*this, ids, times, kinematics, kinematicsValid);
+  runTask(sampleTask, ids.size(), numThreads_);
+
+  EvaluatePairsTask evaluateTask(earthModel_, measurements, times.size(), pairSlots, kinematics, kinematicsValid, results);
+  runTask(evaluateTask, pairSlots.size(), numThreads_);
+  return 0;
+}
+
+int RangeToolEngine::platformKinematics(uint64_t id, double time, Kinematics& kinematics) const
+{
+  const simData::PlatformUpdateSlice* slice = dataStore_.platformUpdateSlice(id);
+  if (slice == NULL)
+    return 1;
+
+  // previous() is the last update at or before the time
+  simData::PlatformUpdateSlice::Iterator iter = slice->upper_bound(time);
+  if (!iter.hasPrevious())
+    return 1;
+  const simData::PlatformUpdate* prev = iter.peekPrevious();
+  const simData::PlatformUpdate* next = iter.hasNext() ? iter.peekNext() : NULL;
+
+  simData::PlatformUpdate interpolated;
+  const simData::PlatformUpdate* update = prev;
+  if (interpolate_ && next != NULL && prev->time() != time)
+  {
+    simData::LinearInterpolator interpolator;
+    if (interpolator.interpolate(time, *prev, *next, &interpolated))
+      update = &interpolated;
+  }
+
+  // Same conversion as the live Range Tool uses for platform velocity
+  const simCore::Coordinate ecef(simCore::COORD_SYS_ECEF,
+    simCore::Vec3(update->x(), update->y(), update->z()),
+    simCore::Vec3(update->psi(), update->theta(), update->phi()),
+    simCore::Vec3(update->vx(), update->vy(), update->vz()));
+  simCore::Coordinate lla;
+  simCore::CoordinateConverter::convertEcefToGeodetic(ecef, lla);
+  kinematics.lla_ = lla.position();
+  kinematics.ypr_ = lla.orientation();
+  kinematics.vel_ = lla.velocity();
+  return 0;
+}
+
+double RangeToolEngine::value(MeasurementType type, const Kinematics& begin, const Kinematics& end,
+  simCore::EarthModelCalculations earthModel, const simCore::CoordinateConverter& coordConv)
+{
+  double az = 0.0;
+  double el = 0.0;
+  double cmp = 0.0;
+  double downRng = 0.0;
+  double crossRng = 0.0;
+  double downValue = 0.0;
+  simCore::Vec3 fpa;
+
+  switch (type)
+  {
+  case GROUND_DISTANCE:
+    return simCore::calculateGroundDist(begin.lla_, end.lla_, earthModel, &coordConv);
+  case SLANT_DISTANCE:
+    return simCore::calculateSlant(begin.lla_, end.lla_, earthModel, &coordConv);
+  case ALTITUDE_DELTA:
+    return simCore::calculateAltitude(begin.lla_, end.lla_, earthModel, &coordConv);
+  case DOWN_RANGE:
+    simCore::calculateDRCRDownValue(begin.lla_, begin.ypr_.x(), end.lla_, earthModel, &coordConv, &downRng, NULL, NULL);
+    return downRng;
+  case CROSS_RANGE:
+    simCore::calculateDRCRDownValue(begin.lla_, begin.ypr_.x(), end.lla_, earthModel, &coordConv, NULL, &crossRng, NULL);
+    return crossRng;
+  case DOWN_VALUE:
+    simCore::calculateDRCRDownValue(begin.lla_, begin.ypr_.x(), end.lla_, earthModel, &coordConv, NULL, NULL, &downValue);
+    return downValue;
+  case GEO_DOWN_RANGE:
+    simCore::calculateGeodesicDRCR(begin.lla_, begin.ypr_.x(), end.lla_, &downRng, NULL);
+    return downRng;
+  case GEO_CROSS_RANGE:
+    simCore::calculateGeodesicDRCR(begin.lla_, begin.ypr_.x(), end.lla_, NULL, &crossRng);
+    return crossRng;
+  case TRUE_AZIMUTH:
+    trueAngles(begin, end, earthModel, coordConv, &az, NULL, NULL);
+    return az;
+  case TRUE_ELEVATION:
+    trueAngles(begin, end, earthModel, coordConv, NULL, &el, NULL);
+    return el;
+  case TRUE_COMPOSITE_ANGLE:
+    trueAngles(begin, end, earthModel, coordConv, NULL, NULL, &cmp);
+    return cmp;
+  case REL_ORI_AZIMUTH:
+    relOriAngles(begin, end, earthModel, coordConv, &az, &el, &cmp);
+    return simCore::angFixPI(az);
+  case REL_ORI_ELEVATION:
+    relOriAngles(begin, end, earthModel, coordConv, &az, &el, &cmp);
+    return el;
+  case REL_ORI_COMPOSITE_ANGLE:
+    relOriAngles(begin, end, earthModel, coordConv, &az, &el, &cmp);
+    return cmp;
+  case REL_VEL_AZIMUTH:
+    relVelAngles(begin, end, earthModel, coordConv, &az, &el, &cmp);
+    return az;
+  case REL_VEL_ELEVATION:
+    relVelAngles(begin, end, earthModel, coordConv, &az, &el, &cmp);
+    return el;
+  case REL_VEL_COMPOSITE_ANGLE:
+    relVelAngles(begin, end, earthModel, coordConv, &az, &el, &cmp);
+    return cmp;
+  case CLOSING_VELOCITY:
+    return simCore::calculateClosingVelocity(begin.lla_, end.lla_, earthModel, &coordConv, begin.vel_, end.vel_);
+  case SEPARATION_VELOCITY:
+    return -simCore::calculateClosingVelocity(begin.lla_, end.lla_, earthModel, &coordConv, begin.vel_, end.vel_);
+  case VELOCITY_DELTA:
+    return simCore::calculateVelocityDelta(begin.lla_, end.lla_, earthModel, &coordConv, begin.vel_, end.vel_);
+  case VEL_AZIM_DOWN_RANGE:
+    simCore::calculateFlightPathAngles(begin.vel_, fpa);
+    simCore::calculateDRCRDownValue(begin.lla_, fpa[0], end.lla_, earthModel, &coordConv, &downRng, NULL, NULL);
+    return downRng;
+  case VEL_AZIM_CROSS_RANGE:
+    simCore::calculateFlightPathAngles(begin.vel_, fpa);
+    simCore::calculateDRCRDownValue(begin.lla_, fpa[0], end.lla_, earthModel, &coordConv, NULL, &crossRng, NULL);
+    return crossRng;
+  case VEL_AZIM_GEO_DOWN_RANGE:
+    simCore::calculateFlightPathAngles(begin.vel_, fpa);
+    simCore::calculateGeodesicDRCR(begin.lla_, fpa[0], end.lla_, &downRng, NULL);
+    return downRng;
+  case VEL_AZIM_GEO_CROSS_RANGE:
+    simCore::calculateFlightPathAngles(begin.vel_, fpa);
+    simCore::calculateGeodesicDRCR(begin.lla_, fpa[0], end.lla_, NULL, &crossRng);
+    return crossRng;
+  case ASPECT_ANGLE:
+    return simCore::calculateAspectAngle(begin.lla_, end.lla_, end.ypr_);
+  }
+  return 0.0;
+}
+
+void RangeToolEngine::trueAngles(const Kinematics& begin, const Kinematics& end, simCore::EarthModelCalculations earthModel,
+  const simCore::CoordinateConverter& coordConv, double* az, double* el, double* cmp)
+{
+  simCore::calculateAbsAzEl(begin.lla_, end.lla_, az, el, cmp, earthModel, &coordConv);
+}
+
+void RangeToolEngine::relOriAngles(const Kinematics& begin, const Kinematics& end, simCore::EarthModelCalculations earthModel,
+  const simCore::CoordinateConverter& coordConv, double* az, double* el, double* cmp)
+{
+  simCore::calculateRelAzEl(begin.lla_, begin.ypr_, end.lla_, az, el, cmp, earthModel, &coordConv);
+}
+
+void RangeToolEngine::relVelAngles(const Kinematics& begin, const Kinematics& end, simCore::EarthModelCalculations earthModel,
+  const simCore::CoordinateConverter& coordConv, double* az, double* el, double* cmp)
+{
+  simCore::Vec3 fpa;
+  simCore::calculateFlightPathAngles(begin.vel_, fpa);
+  simCore::calculateRelAzEl(begin.lla_, fpa, end.lla_, az, el, cmp, earthModel, &coordConv);
+}
+
+}
@@ -0,0 +1,185 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMVIS_RANGETOOLENGINE_H
+#define SIMVIS_RANGETOOLENGINE_H
+
+#include <utility>
+#include <vector>
+#include "simCore/Common/Common.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Calculations.h"
+
+namespace simData { class DataStore; }
+
+namespace simVis
+{
+
+/**
+ * Scene-independent evaluation of the kinematic Range Tool measurements.
+ *
+ * The static methods hold the measurement math shared with the RangeTool's live
+ * Measurement classes.  An engine instance reads platform positions directly from
+ * the data store's update slices, so measurements between platforms can be evaluated
+ * over a whole scenario without stepping the scene.  Pairs are evaluated in parallel
+ * on a small pool of threads; the data store must not be modified during evaluate().
+ */
+class SDKVIS_EXPORT RangeToolEngine
+{
+public:
+  /** Measurements that depend only on the position, orientation and velocity of two entities */
+  enum MeasurementType
+  {
+    GROUND_DISTANCE = 0,      ///< Ground range, meters
+    SLANT_DISTANCE,           ///< Slant range, meters
+    ALTITUDE_DELTA,           ///< Altitude difference, meters
+    DOWN_RANGE,               ///< Down range along the begin entity's yaw, meters
+    CROSS_RANGE,              ///< Cross range from the begin entity's yaw, meters
+    DOWN_VALUE,               ///< Down value of the down range/cross range calculation, meters
+    GEO_DOWN_RANGE,           ///< Geodesic down range along the begin entity's yaw, meters
+    GEO_CROSS_RANGE,          ///< Geodesic cross range from the begin entity's yaw, meters
+    TRUE_AZIMUTH,             ///< True azimuth, radians
+    TRUE_ELEVATION,           ///< True elevation, radians
+    TRUE_COMPOSITE_ANGLE,     ///< True composite angle, radians
+    REL_ORI_AZIMUTH,          ///< Azimuth relative to the begin entity's orientation, radians
+    REL_ORI_ELEVATION,        ///< Elevation relative to the begin entity's orientation, radians
+    REL_ORI_COMPOSITE_ANGLE,  ///< Composite angle relative to the begin entity's orientation, radians
+    REL_VEL_AZIMUTH,          ///< Azimuth relative to the begin entity's velocity vector, radians
+    REL_VEL_ELEVATION,        ///< Elevation relative to the begin entity's velocity vector, radians
+    REL_VEL_COMPOSITE_ANGLE,  ///< Composite angle relative to the begin entity's velocity vector, radians
+    CLOSING_VELOCITY,         ///< Closing velocity, meters per second
+    SEPARATION_VELOCITY,      ///< Separation velocity, meters per second
+    VELOCITY_DELTA,           ///< Magnitude of the velocity difference, meters per second
+    VEL_AZIM_DOWN_RANGE,      ///< Down range along the begin entity's velocity azimuth, meters
+    VEL_AZIM_CROSS_RANGE,     ///< Cross range from the begin entity's velocity azimuth, meters
+    VEL_AZIM_GEO_DOWN_RANGE,  ///< Geodesic down range along the begin entity's velocity azimuth, meters
+    VEL_AZIM_GEO_CROSS_RANGE, ///< Geodesic cross range from the begin entity's velocity azimuth, meters
+    ASPECT_ANGLE              ///< Aspect angle of the begin entity as seen from the end entity, radians
+  };
+
+  /** Position, orientation and velocity of one entity */
+  struct SDKVIS_EXPORT Kinematics
+  {
+    simCore::Vec3 lla_;  ///< Lat, lon, alt in rad, rad, m
+    simCore::Vec3 ypr_;  ///< Yaw, pitch, roll in rad, rad, rad
+    simCore::Vec3 vel_;  ///< X, Y and Z velocities in m/s
+  };
+
+  /** Begin and end entity IDs of one association */
+  typedef std::pair<uint64_t, uint64_t> EntityPair;
+
+  /** Measurement values produced by evaluate() */
+  struct SDKVIS_EXPORT TimeSeries
+  {
+    TimeSeries();
+
+    size_t numPairs_;         ///< Number of entity pairs evaluated
+    size_t numMeasurements_;  ///< Number of measurements per pair
+    size_t numTimes_;         ///< Number of times per measurement
+    /** Values in meters, radians or m/s.  Each (pair, measurement) series is contiguous and ordered by time. */
+    std::vector<double> values_;
+    /** Nonzero where both entities had data at the time; parallel to values_ */
+    std::vector<unsigned char> valid_;
+
+    /**
+     * Returns the index in values_ of the first time of a series
+     * @param pairIndex Index into the pairs passed to evaluate()
+     * @param measurementIndex Index into the measurements passed to evaluate()
+     * @return Offset of the series in values_ and valid_
+     */
+    size_t seriesOffset(size_t pairIndex, size_t measurementIndex) const;
+  };
+
+  /**
+   * Constructs an engine that reads from the given data store
+   * @param dataStore Source of platform updates; must outlive the engine
+   */
+  explicit RangeToolEngine(const simData::DataStore& dataStore);
+  virtual ~RangeToolEngine();
+
+  /** Sets the earth model used for calculations; defaults to simCore::WGS_84 */
+  void setEarthModel(simCore::EarthModelCalculations earthModel);
+  /** Retrieves the earth model used for calculations */
+  simCore::EarthModelCalculations earthModel() const;
+
+  /** Sets the number of threads used by evaluate(), including the calling thread; 0 (default) uses one per processor */
+  void setNumThreads(unsigned int numThreads);
+  /** Retrieves the number of threads used by evaluate() */
+  unsigned int numThreads() const;
+
+  /** Sets whether positions between platform updates are interpolated (default) or held from the previous update */
+  void setInterpolate(bool interpolate);
+  /** Retrieves whether positions between platform updates are interpolated */
+  bool interpolate() const;
+
+  /**
+   * Evaluates measurements between platform pairs at each of the given times.  A value is
+   * invalid if either platform has no update at or before the time.
+   * @param[in ] pairs Begin and end platform IDs
+   * @param[in ] measurements Measurements to evaluate for every pair
+   * @param[in ] times Scenario times at which to evaluate, in any order
+   * @param[out] results Values and validity flags for each pair, measurement and time
+   * @return 0 on success, non-zero if an ID in pairs is not a platform
+   */
+  int evaluate(const std::vector<EntityPair>& pairs, const std::vector<MeasurementType>& measurements,
+    const std::vector<double>& times, TimeSeries& results) const;
+
+  /**
+   * Retrieves the kinematics of a platform at a given time
+   * @param[in ] id Platform ID
+   * @param[in ] time Scenario time
+   * @param[out] kinematics Position, orientation and velocity of the platform
+   * @return 0 on success, non-zero if the platform has no data at or before the time
+   */
+  int platformKinematics(uint64_t id, double time, Kinematics& kinematics) const;
+
+  /**
+   * Calculates a measurement between two entities
+   * @param type Measurement to calculate
+   * @param begin Begin entity
+   * @param end End entity
+   * @param earthModel Earth model for the calculation
+   * @param coordConv Converter with its reference origin at the begin entity
+   * @return Measurement value in meters, radians or m/s
+   */
+  static double value(MeasurementType type, const Kinematics& begin, const Kinematics& end,
+    simCore::EarthModelCalculations earthModel, const simCore::CoordinateConverter& coordConv);
+
+  /** Calculates true azimuth, elevation and composite angle (rad) from begin to end; outputs may be NULL */
+  static void trueAngles(const Kinematics& begin, const Kinematics& end, simCore::EarthModelCalculations earthModel,
+    const simCore::CoordinateConverter& coordConv, double* az, double* el, double* cmp);
+  /** Calculates angles (rad) from begin to end, relative to the begin entity's orientation; outputs may be NULL */
+  static void relOriAngles(const Kinematics& begin, const Kinematics& end, simCore::EarthModelCalculations earthModel,
+    const simCore::CoordinateConverter& coordConv, double* az, double* el, double* cmp);
+  /** Calculates angles (rad) from begin to end, relative to the begin entity's velocity vector; outputs may be NULL */
+  static void relVelAngles(const Kinematics& begin, const Kinematics& end, simCore::EarthModelCalculations earthModel,
+    const simCore::CoordinateConverter& coordConv, double* az, double* el, double* cmp);
+
+private:
+  const simData::DataStore& dataStore_;
+  simCore::EarthModelCalculations earthModel_;
+  unsigned int numThreads_;
+  bool interpolate_;
+};
+
+} // namespace simVis
+
+#endif // SIMVIS_RANGETOOLENGINE_H
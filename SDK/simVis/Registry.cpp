@@ -30,6 +30,7 @@
 
 #include "OpenThreads/Mutex"
 #include "OpenThreads/ScopedLock"
+#include "OpenThreads/Thread"
 
 #include "osgDB/Callbacks"
 #include "osgDB/FileUtils"
@@ -53,6 +54,7 @@
 #include "osgEarth/ShaderGenerator"
 #include "osgEarthAnnotation/AnnotationUtils"
 
+#include <algorithm>
 #include <stdlib.h>
 #include <cstring>
 
@@ -66,6 +68,29 @@ namespace
   const std::string CANT_FIND_FONT = "CouldNotFind";
 }
 
+const unsigned int simVis::Registry::MAX_MODEL_LOADER_THREADS;
+
+/** Loader thread; pulls model names from the registry's queue until shutdown */
+class simVis::Registry::ModelLoaderThread : public OpenThreads::Thread
+{
+public:
+  explicit ModelLoaderThread(const simVis::Registry& registry)
+    : registry_(registry)
+  {
+  }
+
+  virtual void run()
+  {
+    std::string name;
+    unsigned int generation = 0;
+    while (registry_.nextQueuedModel_(name, generation))
+      registry_.loadQueuedModel_(name, generation);
+  }
+
+private:
+  const simVis::Registry& registry_;
+};
+
 
 /**
  * osgDB read callback that will reject filenames with an http: prefix.
@@ -184,7 +209,10 @@ private:
 //----------------------------------------------------------------------------
 
 simVis::Registry::Registry()
-  : clock_(NULL),
+  : loadGeneration_(0),
+    asyncIconModelLoading_(false),
+    loadersDone_(false),
+    clock_(NULL),
     fileSearch_(new simCore::NoSearchFileSearch()),
     sequenceTimeUpdater_(new simVis::SequenceTimeUpdater(NULL))
 {
@@ -241,6 +269,16 @@ simVis::Registry::Registry()
 
 simVis::Registry::~Registry()
 {
+  {
+    ScopedLock<Mutex> lock(modelCacheMutex_);
+    loadersDone_ = true;
+    modelQueued_.broadcast();
+  }
+  for (std::vector<ModelLoaderThread*>::const_iterator i = loaderThreads_.begin(); i != loaderThreads_.end(); ++i)
+  {
+    (*i)->join();
+    delete *i;
+  }
 }
 
 static OpenThreads::Mutex s_instMutex;
@@ -312,6 +350,11 @@ void simVis::Registry::setShareArticulatedIconModels(bool value)
   shareArticulatedModels_ = value;
 }
 
+void simVis::Registry::setAsyncIconModelLoading(bool value)
+{
+  asyncIconModelLoading_ = value;
+}
+
 std::string simVis::Registry::findModelFile(const std::string& name) const
 {
   osgEarth::Threading::ScopedMutexLock lock(fileSearchMutex_);
@@ -370,8 +413,17 @@ std::string simVis::Registry::findModelFile(const std::string& name) const
 
 void simVis::Registry::clearModelCache()
 {
-  modelFilenameCache_.clear();
+  {
+    osgEarth::Threading::ScopedMutexLock lock(fileSearchMutex_);
+    modelFilenameCache_.clear();
+  }
+  ScopedLock<Mutex> lock(modelCacheMutex_);
   modelCache_.clear();
+  // Loads in progress complete, but their results are discarded
+  asyncLoads_.clear();
+  stats_.pendingLoads -= std::min(stats_.pendingLoads, static_cast<unsigned int>(loadQueue_.size()));
+  loadQueue_.clear();
+  ++loadGeneration_;
 }
 
 /** Local helper visitor to add a given callback to all sequences in the graph */
@@ -418,33 +470,189 @@ osg::Node* simVis::Registry::getOrCreateIconModel(const std::string& location, b
     return NULL;
 
   // Attempt to locate the filename
-  osg::Node* result = NULL;
   std::string uri = findModelFile(location);
   if (uri.empty())
     return NULL;
 
   // first check the cache.
-  ModelCache::const_iterator i = modelCache_.find(uri);
-  if (i != modelCache_.end())
   {
-    const ModelCacheEntry& entry = i->second;
-    if (pIsImage)
-      *pIsImage = entry.isImage_;
+    ScopedLock<Mutex> lock(modelCacheMutex_);
+    ++stats_.requests;
+    ModelCache::const_iterator i = modelCache_.find(uri);
+    if (i != modelCache_.end())
+    {
+      ++stats_.cacheHits;
+      if (pIsImage)
+        *pIsImage = i->second.isImage_;
+      return instanceOf_(i->second);
+    }
+  }
+
+  ModelCacheEntry entry;
+  bool cacheIt = true;
+  if (!loadIconModel_(uri, entry, cacheIt))
+    return NULL;
+
+  // Save the is-image flag
+  if (pIsImage)
+    *pIsImage = entry.isImage_;
+
+  // cache it.
+  if (cacheIt)
+  {
+    ScopedLock<Mutex> lock(modelCacheMutex_);
+    modelCache_[uri] = entry;
+  }
+  // The cache (if any) holds its own reference; hand out the new node unreferenced
+  return entry.node_.release();
+}
 
-    if (entry.isArticulated_ && !shareArticulatedModels_)
+simVis::Registry::ModelLoadStatus simVis::Registry::requestIconModel(const std::string& name, osg::ref_ptr<osg::Node>& model, bool* pIsImage) const
+{
+  // if doing a memory check, fail so that the caller loads in a box instead of a complex icon
+  if (memoryChecking_ || name.empty())
+    return MODEL_FAILED;
+
+  ScopedLock<Mutex> lock(modelCacheMutex_);
+  ++stats_.requests;
+  AsyncModelLoads::iterator i = asyncLoads_.find(name);
+  if (i == asyncLoads_.end())
+  {
+    // Queue a background load; the file search happens on the loader thread too
+    asyncLoads_[name].state_ = ASYNC_QUEUED;
+    loadQueue_.push_back(name);
+    ++stats_.queuedLoads;
+    ++stats_.pendingLoads;
+    if (loaderThreads_.empty())
     {
-      // clone nodes so we get independent articulations
-      return osg::clone(entry.node_.get(), osg::CopyOp::DEEP_COPY_NODES);
+      // Leave a processor for the render thread
+      const int numProcessors = OpenThreads::GetNumberOfProcessors();
+      unsigned int numThreads = (numProcessors > 1) ? static_cast<unsigned int>(numProcessors - 1) : 1;
+      if (numThreads > MAX_MODEL_LOADER_THREADS)
+        numThreads = MAX_MODEL_LOADER_THREADS;
+      for (unsigned int k = 0; k < numThreads; ++k)
+      {
+        ModelLoaderThread* thread = new ModelLoaderThread(*this);
+        loaderThreads_.push_back(thread);
+        thread->start();
+      }
     }
+    modelQueued_.signal();
+    return MODEL_PENDING;
+  }
 
-    // shared scene graph:
-    return entry.node_.get();
+  switch (i->second.state_)
+  {
+  case ASYNC_QUEUED:
+  case ASYNC_LOADING:
+    return MODEL_PENDING;
+  case ASYNC_FAILED:
+    return MODEL_FAILED;
+  case ASYNC_LOADED:
+    break;
   }
 
+  ++stats_.cacheHits;
+  if (pIsImage)
+    *pIsImage = i->second.model_.isImage_;
+  if (i->second.cached_)
+  {
+    model = instanceOf_(i->second.model_);
+  }
+  else
+  {
+    // Uncached models (time dependent icons) go to a single requester; the next request loads again
+    model = i->second.model_.node_.get();
+    asyncLoads_.erase(i);
+  }
+  return MODEL_LOADED;
+}
+
+simVis::Registry::ModelCacheStats simVis::Registry::modelCacheStats() const
+{
+  ScopedLock<Mutex> lock(modelCacheMutex_);
+  ModelCacheStats stats = stats_;
+  stats.cachedModels = static_cast<unsigned int>(modelCache_.size());
+  stats.loaderThreads = static_cast<unsigned int>(loaderThreads_.size());
+  return stats;
+}
+
+osg::Node* simVis::Registry::instanceOf_(const ModelCacheEntry& entry) const
+{
+  if (entry.isArticulated_ && !shareArticulatedModels_)
+  {
+    // clone nodes so we get independent articulations
+    return osg::clone(entry.node_.get(), osg::CopyOp::DEEP_COPY_NODES);
+  }
+
+  // shared scene graph:
+  return entry.node_.get();
+}
+
+bool simVis::Registry::nextQueuedModel_(std::string& name, unsigned int& generation) const
+{
+  ScopedLock<Mutex> lock(modelCacheMutex_);
+  while (loadQueue_.empty() && !loadersDone_)
+    modelQueued_.wait(&modelCacheMutex_);
+  if (loadersDone_)
+    return false;
+  name = loadQueue_.front();
+  loadQueue_.pop_front();
+  asyncLoads_[name].state_ = ASYNC_LOADING;
+  generation = loadGeneration_;
+  return true;
+}
+
+void simVis::Registry::loadQueuedModel_(const std::string& name, unsigned int generation) const
+{
+  AsyncModelLoad result;
+  result.state_ = ASYNC_FAILED;
+  result.cached_ = false;
+
+  const std::string uri = findModelFile(name);
+  if (!uri.empty())
+  {
+    // A synchronous or earlier request may have loaded the same file under a different name
+    ScopedLock<Mutex> lock(modelCacheMutex_);
+    ModelCache::const_iterator i = modelCache_.find(uri);
+    if (i != modelCache_.end())
+    {
+      result.state_ = ASYNC_LOADED;
+      result.model_ = i->second;
+      result.cached_ = true;
+    }
+  }
+
+  bool cacheIt = true;
+  if (!uri.empty() && result.state_ != ASYNC_LOADED && loadIconModel_(uri, result.model_, cacheIt))
+  {
+    result.state_ = ASYNC_LOADED;
+    result.cached_ = cacheIt;
+  }
+
+  ScopedLock<Mutex> lock(modelCacheMutex_);
+  if (stats_.pendingLoads > 0)
+    --stats_.pendingLoads;
+  if (result.state_ == ASYNC_LOADED)
+    ++stats_.completedLoads;
+  else
+    ++stats_.failedLoads;
+
+  // Discard results from before clearModelCache()
+  if (generation != loadGeneration_)
+    return;
+  asyncLoads_[name] = result;
+  if (result.state_ == ASYNC_LOADED && result.cached_ && modelCache_.find(uri) == modelCache_.end())
+    modelCache_[uri] = result.model_;
+}
+
+bool simVis::Registry::loadIconModel_(const std::string& uri, ModelCacheEntry& entry, bool& cacheIt) const
+{
+  osg::Node* result = NULL;
   // Treat models and icons differently
   const bool isImage = simVis::isImageFile(uri);
   // Only cache icons re-usable between scenarios
-  bool cacheIt = true;
+  cacheIt = true;
 
   if (isImage)
   {
@@ -514,9 +722,9 @@ osg::Node* simVis::Registry::getOrCreateIconModel(const std::string& location, b
     }
   }
 
-  // process and cache the result.
+  // process the result.
   if (!result)
-    return NULL;
+    return false;
 
   // Set up an LOD for performance's sake that eliminates the object from drawing if eye is too far
   osg::LOD* lod = new osg::LOD;
@@ -526,10 +734,6 @@ osg::Node* simVis::Registry::getOrCreateIconModel(const std::string& location, b
   lod->addChild(result, 0.f, radius * 5000.f); // Minimum value: 160km (5000 * 32) before phase out
   result = lod;
 
-  // Save the is-image flag
-  if (pIsImage)
-    *pIsImage = isImage;
-
   // Perform vertex cache ordering optimization.
   osgUtil::Optimizer o;
   o.optimize(
@@ -544,15 +748,10 @@ osg::Node* simVis::Registry::getOrCreateIconModel(const std::string& location, b
   osg::ref_ptr<osgEarth::StateSetCache> stateCache = new osgEarth::StateSetCache();
   osgEarth::Registry::shaderGenerator().run(result, stateCache.get());
 
-  // cache it.
-  if (cacheIt)
-  {
-    ModelCacheEntry& entry = modelCache_[uri];
-    entry.node_ = result;
-    entry.isImage_ = isImage;
-    entry.isArticulated_ = isArticulated_(result);
-  }
-  return result;
+  entry.node_ = result;
+  entry.isImage_ = isImage;
+  entry.isArticulated_ = isArticulated_(result);
+  return true;
 }
 
 osgText::Font* simVis::Registry::getOrCreateFont(const std::string& name) const
@@ -24,13 +24,17 @@
 
 #include "simCore/Common/Common.h"
 #include "simCore/Common/FileSearch.h"
+#include "OpenThreads/Condition"
+#include "OpenThreads/Mutex"
 #include "OpenThreads/ReentrantMutex"
 #include "osgText/Text"
 #include "osgDB/FileUtils"
 #include "osgEarth/ThreadingUtils"
 #include "osg/observer_ptr"
 #include "osg/ref_ptr"
+#include <deque>
 #include <list>
+#include <vector>
 
 namespace osg { class FrameStamp; }
 namespace simCore { class Clock; }
@@ -52,6 +56,34 @@ class SequenceTimeUpdater;
 class SDKVIS_EXPORT Registry
 {
 public:
+  /** Result of a non-blocking icon model request */
+  enum ModelLoadStatus
+  {
+    MODEL_LOADED = 0,  ///< The model is loaded and the output node is set
+    MODEL_PENDING,     ///< The model is being loaded in the background; request again later
+    MODEL_FAILED       ///< The model could not be found or loaded
+  };
+
+  /** Maximum number of background threads used by requestIconModel() */
+  static const unsigned int MAX_MODEL_LOADER_THREADS = 4;
+
+  /** Counters describing the icon model cache and its background loaders */
+  struct ModelCacheStats
+  {
+    unsigned int cachedModels;    ///< Number of shareable models held in the cache
+    unsigned int requests;        ///< Calls to getOrCreateIconModel() and requestIconModel()
+    unsigned int cacheHits;       ///< Requests answered from a previously loaded model
+    unsigned int queuedLoads;     ///< Background loads started; repeated requests for a pending model do not queue another
+    unsigned int completedLoads;  ///< Background loads that produced a model
+    unsigned int failedLoads;     ///< Background loads that did not find or read a model
+    unsigned int pendingLoads;    ///< Background loads queued or in progress
+    unsigned int loaderThreads;   ///< Background loader threads started; never more than MAX_MODEL_LOADER_THREADS
+
+    ModelCacheStats()
+      : cachedModels(0), requests(0), cacheHits(0), queuedLoads(0), completedLoads(0), failedLoads(0), pendingLoads(0), loaderThreads(0)
+    {
+    }
+  };
 
   /**
   * Enable "NO NETWORK" mode, in which the application will never attempt
@@ -111,6 +143,34 @@ public:
   */
   osg::Node* getOrCreateIconModel(const std::string& name, bool* pIsImage = NULL) const;
 
+  /**
+  * Retrieves an icon model without blocking.  If the model is not yet loaded, the file search
+  * and read are queued on a small pool of background threads and MODEL_PENDING is returned;
+  * the caller displays a placeholder and requests again later (e.g. during the update traversal)
+  * until the status changes.  Repeated requests for a model that is already pending share the
+  * same load.  Returned nodes follow the same sharing rules as getOrCreateIconModel().
+  * This method is thread safe.
+  * @param[in ] name Location of the file
+  * @param[out] model Loaded model; only set if the return value is MODEL_LOADED
+  * @param[out] pIsImage Pointer to a boolean set to true if the model is an image; only set on MODEL_LOADED
+  * @return Status of the request
+  */
+  ModelLoadStatus requestIconModel(const std::string& name, osg::ref_ptr<osg::Node>& model, bool* pIsImage = NULL) const;
+
+  /** Retrieves counters for the icon model cache and background loaders */
+  ModelCacheStats modelCacheStats() const;
+
+  /**
+  * Whether platforms load their icon models in the background using requestIconModel(),
+  * showing a placeholder box until the model is ready.  Default=FALSE, which loads models
+  * synchronously in getOrCreateIconModel().  Enable to avoid stalling the frame when many
+  * platforms with new models are added at once.
+  */
+  void setAsyncIconModelLoading(bool value);
+
+  /** Retrieves the flag for whether platform icon models load in the background */
+  bool getAsyncIconModelLoading() const { return asyncIconModelLoading_; }
+
   /**
   * Searches for the named font, using the data search path list and the extensions list.
   * This method is thread safe
@@ -203,6 +263,47 @@ private:
   typedef std::map<std::string, ModelCacheEntry> ModelCache;
   mutable ModelCache modelCache_;
 
+  /// Load state of an asynchronous model request
+  enum AsyncLoadState
+  {
+    ASYNC_QUEUED,
+    ASYNC_LOADING,
+    ASYNC_LOADED,
+    ASYNC_FAILED
+  };
+  /// Result of an asynchronous model request, keyed on the requested name
+  struct AsyncModelLoad {
+    AsyncLoadState   state_;
+    ModelCacheEntry  model_;
+    bool             cached_;
+  };
+  typedef std::map<std::string, AsyncModelLoad> AsyncModelLoads;
+
+  /// Loads and prepares the model at the resolved URI; returns false if it cannot be read.  Thread safe
+  bool loadIconModel_(const std::string& uri, ModelCacheEntry& entry, bool& cacheIt) const;
+  /// Returns the node to hand out for a loaded entry, cloning articulated models if they are not shared
+  osg::Node* instanceOf_(const ModelCacheEntry& entry) const;
+  /// Called by loader threads to pull the next model name to load; returns false on shutdown
+  bool nextQueuedModel_(std::string& name, unsigned int& generation) const;
+  /// Called by loader threads to resolve and load one model, storing the result
+  void loadQueuedModel_(const std::string& name, unsigned int generation) const;
+
+  mutable AsyncModelLoads asyncLoads_;
+  mutable std::deque<std::string> loadQueue_;
+  /// Incremented by clearModelCache() so that loads from before the clear are discarded
+  mutable unsigned int loadGeneration_;
+  mutable ModelCacheStats stats_;
+  bool asyncIconModelLoading_;
+  /// Set on destruction to stop the loader threads
+  bool loadersDone_;
+
+  class ModelLoaderThread;
+  mutable std::vector<ModelLoaderThread*> loaderThreads_;
+  /// Protects the model cache, asynchronous loads, and statistics
+  mutable OpenThreads::Mutex modelCacheMutex_;
+  /// Signaled when a model name is queued
+  mutable OpenThreads::Condition modelQueued_;
+
   // A mapping between the supplied file name and the actual file name
   typedef std::map<std::string, std::string> FilenameCache;
   /// Cache of all found model filenames
@@ -94,7 +94,10 @@ public:
   /// something has changed in the entity category data
   virtual void onCategoryDataChange(simData::DataStore *source, simData::ObjectId changedId, simData::DataStore::ObjectType ot)
   {
-    // category data has no effect on visualization
+    // category data has no effect on the graphics, but label content callbacks may display it
+    EntityNode* node = scenarioManager_->find(changedId);
+    if (node)
+      node->setLabelContentDirty();
   }
 
   /// entity name has changed
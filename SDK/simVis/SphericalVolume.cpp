@@ -19,6 +19,7 @@
  * disclose, or release this software.
  *
  */
+#include <map>
 #include "osg/BlendFunc"
 #include "osg/CullFace"
 #include "osg/Depth"
@@ -29,6 +30,8 @@
 #include "osg/PolygonStipple"
 #include "osg/UserDataContainer"
 #include "osgUtil/Simplifier"
+#include "OpenThreads/Mutex"
+#include "OpenThreads/ScopedLock"
 
 #include "simNotify/Notify.h"
 #include "simCore/Calc/Angle.h"
@@ -138,6 +141,157 @@ namespace
   typedef ToggleDE<osg::DrawElementsUByte>  ToggleDrawElementsUByte;
   typedef ToggleDE<osg::DrawElementsUShort> ToggleDrawElementsUShort;
   typedef ToggleDE<osg::DrawElementsUInt>   ToggleDrawElementsUInt;
+
+  /// parameters that determine the vertices and primitives of a mesh with no near face
+  struct SVMeshKey
+  {
+    SVMeshKey(const SVData& d, const osg::Vec3& dir)
+      : shape_(d.shape_),
+        drawMode_(d.drawMode_),
+        capRes_(d.capRes_),
+        coneRes_(d.coneRes_),
+        wallRes_(d.wallRes_),
+        outlineWidth_(d.outlineWidth_),
+        farRange_(d.farRange_ * d.scale_),
+        hfov_deg_(d.hfov_deg_),
+        vfov_deg_(d.vfov_deg_),
+        // offsets are only baked into the mesh in sphere-seg mode
+        azimOffset_deg_(d.drawAsSphereSegment_ ? d.azimOffset_deg_ : 0.0f),
+        elevOffset_deg_(d.drawAsSphereSegment_ ? d.elevOffset_deg_ : 0.0f),
+        drawCone_(d.drawCone_),
+        drawAsSphereSegment_(d.drawAsSphereSegment_),
+        dir_(dir)
+    {
+    }
+
+    bool operator<(const SVMeshKey& rhs) const
+    {
+      if (shape_ != rhs.shape_) return shape_ < rhs.shape_;
+      if (drawMode_ != rhs.drawMode_) return drawMode_ < rhs.drawMode_;
+      if (capRes_ != rhs.capRes_) return capRes_ < rhs.capRes_;
+      if (coneRes_ != rhs.coneRes_) return coneRes_ < rhs.coneRes_;
+      if (wallRes_ != rhs.wallRes_) return wallRes_ < rhs.wallRes_;
+      if (outlineWidth_ != rhs.outlineWidth_) return outlineWidth_ < rhs.outlineWidth_;
+      if (farRange_ != rhs.farRange_) return farRange_ < rhs.farRange_;
+      if (hfov_deg_ != rhs.hfov_deg_) return hfov_deg_ < rhs.hfov_deg_;
+      if (vfov_deg_ != rhs.vfov_deg_) return vfov_deg_ < rhs.vfov_deg_;
+      if (azimOffset_deg_ != rhs.azimOffset_deg_) return azimOffset_deg_ < rhs.azimOffset_deg_;
+      if (elevOffset_deg_ != rhs.elevOffset_deg_) return elevOffset_deg_ < rhs.elevOffset_deg_;
+      if (drawCone_ != rhs.drawCone_) return drawCone_ < rhs.drawCone_;
+      if (drawAsSphereSegment_ != rhs.drawAsSphereSegment_) return drawAsSphereSegment_ < rhs.drawAsSphereSegment_;
+      return dir_ < rhs.dir_;
+    }
+
+    SVData::Shape shape_;
+    int           drawMode_;
+    unsigned int  capRes_;
+    unsigned int  coneRes_;
+    unsigned int  wallRes_;
+    float         outlineWidth_;
+    float         farRange_;
+    float         hfov_deg_;
+    float         vfov_deg_;
+    float         azimOffset_deg_;
+    float         elevOffset_deg_;
+    bool          drawCone_;
+    bool          drawAsSphereSegment_;
+    osg::Vec3     dir_;
+  };
+
+  /// a cached mesh and the number of nodes drawing it
+  struct SVMeshEntry
+  {
+    SVMeshEntry() : users_(0) {}
+
+    /// geode holding the template geometries
+    osg::ref_ptr<osg::Geode> mesh_;
+    /// number of live nodes drawing the mesh
+    unsigned int users_;
+  };
+
+  /// meshes shared between nodes, built at their far range
+  struct SVMeshCache
+  {
+    SVMeshCache() : enabled_(true) {}
+
+    OpenThreads::Mutex mutex_;
+    std::map<SVMeshKey, SVMeshEntry> meshes_;
+    bool enabled_;
+  };
+
+  SVMeshCache& meshCache()
+  {
+    // never destroyed, since nodes released during static destruction still deregister
+    static SVMeshCache* s_cache = new SVMeshCache();
+    return *s_cache;
+  }
+
+  /// user data of a node drawing a cached mesh; releases the node's claim on the mesh when destroyed
+  class SVMeshUser : public osg::Referenced
+  {
+  public:
+    /// registers a user of the mesh under 'key'; cache mutex must be held
+    SVMeshUser(SVMeshCache& cache, const SVMeshKey& key)
+      : cache_(cache),
+        key_(key)
+    {
+      ++cache_.meshes_[key_].users_;
+    }
+
+  protected:
+    virtual ~SVMeshUser()
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(cache_.mutex_);
+      std::map<SVMeshKey, SVMeshEntry>::iterator i = cache_.meshes_.find(key_);
+      // Assertion failure means the entry was pruned while still in use
+      assert(i != cache_.meshes_.end() && i->second.users_ > 0);
+      if (i != cache_.meshes_.end() && i->second.users_ > 0)
+        --i->second.users_;
+    }
+
+  private:
+    SVMeshCache& cache_;
+    const SVMeshKey key_;
+  };
+
+  /// removes meshes no longer drawn by any node; cache mutex must be held
+  void pruneMeshCache(SVMeshCache& cache)
+  {
+    std::map<SVMeshKey, SVMeshEntry>::iterator i = cache.meshes_.begin();
+    while (i != cache.meshes_.end())
+    {
+      if (i->second.users_ == 0)
+        cache.meshes_.erase(i++);
+      else
+        ++i;
+    }
+  }
+
+  /// copies a template geometry, sharing its arrays, primitives and metadata but not its color or state
+  osg::Geometry* instanceGeometry(const osg::Geometry& shared, const osg::Vec4f& color, bool opaque)
+  {
+    osg::Geometry* geom = new osg::Geometry(shared, osg::CopyOp::SHALLOW_COPY);
+    if (shared.getStateSet())
+      geom->setStateSet(new osg::StateSet(*shared.getStateSet(), osg::CopyOp::DEEP_COPY_ALL));
+    if (shared.getColorArray())
+    {
+      osg::Vec4Array* colorArray = new osg::Vec4Array(1);
+      (*colorArray)[0] = color;
+      if (opaque)
+        (*colorArray)[0][3] = 1.0f;
+      geom->setColorArray(colorArray);
+      geom->setColorBinding(osg::Geometry::BIND_OVERALL);
+    }
+    return geom;
+  }
+
+  /// returns the geode holding the solid and outline geometries
+  osg::Geode* solidGeode(osg::MatrixTransform* xform)
+  {
+    if (xform == NULL || xform->getNumChildren() == 0)
+      return NULL;
+    return xform->getChild(0)->asGeode();
+  }
 }
 
 
@@ -861,35 +1015,84 @@ osg::Geometry* SVFactory::createCone_(const SVData& d, const osg::Vec3& directio
   return geom;
 }
 
-osg::MatrixTransform* SVFactory::createNode(const SVData& d, const osg::Vec3& dir)
+osg::MatrixTransform* SVFactory::createSharedNode_(const SVData& d, const osg::Vec3& dir)
 {
-  osg::ref_ptr<osg::Geode> geodeSolid = new osg::Geode();
+  // volumes with a near face are built per node
+  if (d.nearRange_ > 0.0f || d.farRange_ * d.scale_ <= 0.0f || d.drawMode_ == SVData::DRAW_MODE_NONE || d.capRes_ == 0)
+    return NULL;
 
-  if (d.shape_ == SVData::SHAPE_PYRAMID)
+  osg::ref_ptr<osg::Geode> mesh;
+  osg::ref_ptr<SVMeshUser> user;
   {
-    // pyramid always adds a solid geometry, can also add an outline geometry
-    createPyramid_(*geodeSolid, d, dir);
-    if (geodeSolid->getNumDrawables() < 1)
-    {
-      // assertion failure means that createPyramid_ changed and no longer guarantees to return a geode with geometry
-      assert(0);
+    SVMeshCache& cache = meshCache();
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(cache.mutex_);
+    if (!cache.enabled_)
       return NULL;
-    }
-  }
-  else
-  {
-    osg::Geometry* geom = createCone_(d, dir);
-    if (geom == NULL)
+
+    const SVMeshKey key(d, dir);
+    std::map<SVMeshKey, SVMeshEntry>::const_iterator i = cache.meshes_.find(key);
+    if (i != cache.meshes_.end())
+      mesh = i->second.mesh_;
+    else
     {
-      // Assertion failure means create*_() did not return a valid geometry
-      assert(0);
-      return NULL;
+      pruneMeshCache(cache);
+
+      // vertices are built at the node's own range, so shaders see the same model coordinates as an unshared node
+      mesh = new osg::Geode();
+      if (d.shape_ == SVData::SHAPE_PYRAMID)
+        createPyramid_(*mesh, d, dir);
+      else
+        mesh->addDrawable(createCone_(d, dir));
+      cache.meshes_[key].mesh_ = mesh;
     }
-    geodeSolid->addDrawable(geom);
+    user = new SVMeshUser(cache, key);
   }
 
+  // the outline geometry, if any, is always the 2nd geometry and has no transparency
+  osg::Geode* geodeSolid = new osg::Geode();
+  for (unsigned int i = 0; i < mesh->getNumDrawables(); ++i)
+    geodeSolid->addDrawable(instanceGeometry(*mesh->getDrawable(i)->asGeometry(), d.color_, i > 0));
+
   osg::MatrixTransform* xform = new osg::MatrixTransform();
   xform->addChild(geodeSolid);
+  xform->setUserData(user.get());
+  return xform;
+}
+
+osg::MatrixTransform* SVFactory::createNode(const SVData& d, const osg::Vec3& dir)
+{
+  osg::MatrixTransform* xform = createSharedNode_(d, dir);
+  if (xform == NULL)
+  {
+    osg::ref_ptr<osg::Geode> geodeSolid = new osg::Geode();
+
+    if (d.shape_ == SVData::SHAPE_PYRAMID)
+    {
+      // pyramid always adds a solid geometry, can also add an outline geometry
+      createPyramid_(*geodeSolid, d, dir);
+      if (geodeSolid->getNumDrawables() < 1)
+      {
+        // assertion failure means that createPyramid_ changed and no longer guarantees to return a geode with geometry
+        assert(0);
+        return NULL;
+      }
+    }
+    else
+    {
+      osg::Geometry* geom = createCone_(d, dir);
+      if (geom == NULL)
+      {
+        // Assertion failure means create*_() did not return a valid geometry
+        assert(0);
+        return NULL;
+      }
+      geodeSolid->addDrawable(geom);
+    }
+
+    xform = new osg::MatrixTransform();
+    xform->addChild(geodeSolid);
+  }
+  osg::Geode* geodeSolid = solidGeode(xform);
 
   // Turn off backface culling
   xform->getOrCreateStateSet()->setMode(GL_CULL_FACE, osg::StateAttribute::OFF);
@@ -903,7 +1106,7 @@ osg::MatrixTransform* SVFactory::createNode(const SVData& d, const osg::Vec3& di
       // include a second geode that will re-draw the item in wireframe mode.
       osg::Geode* geodeWire = new osg::Geode();
       geodeWire->addDrawable(geom);
-      xform->addChild(geodeWire);
+      geodeSolid->getParent(0)->addChild(geodeWire);
       osg::PolygonMode* pm = new osg::PolygonMode(osg::PolygonMode::FRONT_AND_BACK, osg::PolygonMode::LINE);
       geodeWire->getOrCreateStateSet()->setAttributeAndModes(pm, osg::StateAttribute::ON);
     }
@@ -1021,6 +1224,8 @@ void SVFactory::updateColor(osg::MatrixTransform* xform, const osg::Vec4f& color
 void SVFactory::updateNearRange(osg::MatrixTransform* xform, float nearRange)
 {
   nearRange = simCore::sdkMax(1.0f, nearRange);
+  // vertices are about to change, so stop sharing them with other nodes
+  unshare_(xform);
 
   osg::Geometry*  geom = SVFactory::solidGeometry_(xform);
   // Assertion failure means internal consistency error, or caller has inconsistent input
@@ -1053,6 +1258,8 @@ void SVFactory::updateNearRange(osg::MatrixTransform* xform, float nearRange)
 void SVFactory::updateFarRange(osg::MatrixTransform* xform, float farRange)
 {
   farRange = simCore::sdkMax(1.0f, farRange);
+  // vertices are about to change, so stop sharing them with other nodes
+  unshare_(xform);
 
   osg::Geometry*  geom = SVFactory::solidGeometry_(xform);
   // Assertion failure means internal consistency error, or caller has inconsistent input
@@ -1084,6 +1291,9 @@ void SVFactory::updateFarRange(osg::MatrixTransform* xform, float farRange)
 
 void SVFactory::updateHorizAngle(osg::MatrixTransform* xform, float oldAngle, float newAngle)
 {
+  // vertices are about to change, so stop sharing them with other nodes
+  unshare_(xform);
+
   osg::Geometry* geom = SVFactory::solidGeometry_(xform);
   // Assertion failure means internal consistency error, or caller has inconsistent input
   assert(geom);
@@ -1167,6 +1377,9 @@ void SVFactory::updateHorizAngle(osg::MatrixTransform* xform, float oldAngle, fl
 
 void SVFactory::updateVertAngle(osg::MatrixTransform* xform, float oldAngle, float newAngle)
 {
+  // vertices are about to change, so stop sharing them with other nodes
+  unshare_(xform);
+
   osg::Geometry*  geom = SVFactory::solidGeometry_(xform);
   // Assertion failure means internal consistency error, or caller has inconsistent input
   assert(geom);
@@ -1250,9 +1463,7 @@ void SVFactory::updateVertAngle(osg::MatrixTransform* xform, float oldAngle, flo
 
 osg::Geometry* SVFactory::solidGeometry_(osg::MatrixTransform* xform)
 {
-  if (xform == NULL || xform->getNumChildren() == 0)
-    return NULL;
-  osg::Geode* geode = xform->getChild(0)->asGeode();
+  osg::Geode* geode = solidGeode(xform);
   if (geode == NULL || geode->getNumDrawables() == 0)
     return NULL;
   return geode->getDrawable(0)->asGeometry();
@@ -1261,11 +1472,84 @@ osg::Geometry* SVFactory::solidGeometry_(osg::MatrixTransform* xform)
 // if the sv pyramid has an outline, it will exist in its own geometry, which should always be the 2nd geometry
 osg::Geometry* SVFactory::outlineGeometry(osg::MatrixTransform* xform)
 {
-  if (xform == NULL || xform->getNumChildren() == 0)
-    return NULL;
-  osg::Geode* geode = xform->getChild(0)->asGeode();
+  osg::Geode* geode = solidGeode(xform);
   if (geode == NULL || geode->getNumDrawables() < 2)
     return NULL;
   return geode->getDrawable(1)->asGeometry();
 }
 
+void SVFactory::unshare_(osg::MatrixTransform* xform)
+{
+  if (!isShared(xform))
+    return;
+  osg::Geode* geode = solidGeode(xform);
+  // Assertion failure means internal consistency error
+  assert(geode);
+  if (geode != NULL)
+  {
+    // the solid and outline geometries share arrays; copy them once, from whichever geometry has them
+    osg::Geometry* source = NULL;
+    for (unsigned int i = 0; i < geode->getNumDrawables() && source == NULL; ++i)
+    {
+      osg::Geometry* geom = geode->getDrawable(i)->asGeometry();
+      if (geom && geom->getVertexArray() && geom->getNormalArray() && geom->getUserData())
+        source = geom;
+    }
+
+    if (source)
+    {
+      const osg::Array* sharedVerts = source->getVertexArray();
+      osg::ref_ptr<osg::Vec3Array> verts = new osg::Vec3Array(*static_cast<const osg::Vec3Array*>(sharedVerts), osg::CopyOp::DEEP_COPY_ALL);
+      osg::ref_ptr<osg::Vec3Array> normals = new osg::Vec3Array(*static_cast<const osg::Vec3Array*>(source->getNormalArray()), osg::CopyOp::DEEP_COPY_ALL);
+      osg::ref_ptr<SVMetaContainer> meta = new SVMetaContainer(*static_cast<const SVMetaContainer*>(source->getUserData()));
+
+      for (unsigned int i = 0; i < geode->getNumDrawables(); ++i)
+      {
+        osg::Geometry* geom = geode->getDrawable(i)->asGeometry();
+        if (geom == NULL || geom->getVertexArray() != sharedVerts)
+          continue;
+        geom->setVertexArray(verts.get());
+        geom->setNormalArray(normals.get());
+        geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
+        geom->setUserData(meta.get());
+      }
+    }
+  }
+
+  // releases the node's claim on the cached mesh
+  xform->setUserData(NULL);
+}
+
+void SVFactory::setMeshCacheEnabled(bool enabled)
+{
+  SVMeshCache& cache = meshCache();
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(cache.mutex_);
+  cache.enabled_ = enabled;
+}
+
+bool SVFactory::meshCacheEnabled()
+{
+  SVMeshCache& cache = meshCache();
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(cache.mutex_);
+  return cache.enabled_;
+}
+
+SVFactory::MeshCacheStats SVFactory::meshCacheStats()
+{
+  SVMeshCache& cache = meshCache();
+  OpenThreads::ScopedLock<OpenThreads::Mutex> lock(cache.mutex_);
+  pruneMeshCache(cache);
+
+  MeshCacheStats stats;
+  stats.uniqueMeshes_ = static_cast<unsigned int>(cache.meshes_.size());
+  stats.sharedNodes_ = 0;
+  for (std::map<SVMeshKey, SVMeshEntry>::const_iterator i = cache.meshes_.begin(); i != cache.meshes_.end(); ++i)
+    stats.sharedNodes_ += i->second.users_;
+  return stats;
+}
+
+bool SVFactory::isShared(osg::MatrixTransform* xform)
+{
+  return xform != NULL && dynamic_cast<SVMeshUser*>(xform->getUserData()) != NULL;
+}
+
@@ -134,10 +134,26 @@ struct SVState
   unsigned int farFaceOffset_;
 };
 
-/// Utility class to create volumetric geometry for beams and gates (internal)
+/**
+ * Utility class to create volumetric geometry for beams and gates (internal)
+ *
+ * Volumes with no near range share a cached mesh, keyed on the shape, far range, angular
+ * extents, tessellation and draw mode; each node holds its own color and state.  Shared
+ * vertices are in the same model coordinates as an unshared node's.  A node gets a
+ * private copy of the mesh the first time its range or angles are changed in place.
+ */
 class SVFactory
 {
 public:
+  /// Statistics on the meshes shared between nodes
+  struct MeshCacheStats
+  {
+    /// Number of unique meshes held by the cache
+    unsigned int uniqueMeshes_;
+    /// Number of nodes currently drawing one of the cached meshes
+    unsigned int sharedNodes_;
+  };
+
   /// create a node visualizing the spherical volume given in 'data'
   static osg::MatrixTransform* createNode(const SVData &data, const osg::Vec3& dir = osg::Vec3(0, 1, 0));
 
@@ -159,7 +175,21 @@ public:
   static void updateVertAngle(osg::MatrixTransform* xform, float oldAngle, float newAngle);
   /// Retrieves the 'outline' geometry, or NULL if there is no such geometry
   static osg::Geometry* outlineGeometry(osg::MatrixTransform* xform);
+
+  /// enable or disable sharing of meshes by new nodes (default on); existing nodes are unaffected
+  static void setMeshCacheEnabled(bool enabled);
+  /// true if new nodes share meshes
+  static bool meshCacheEnabled();
+  /// retrieves the number of unique cached meshes and the number of nodes sharing them
+  static MeshCacheStats meshCacheStats();
+  /// true if the node draws a mesh shared with other nodes
+  static bool isShared(osg::MatrixTransform* xform);
+
 private:
+  /// returns a new node drawing the cached mesh for 'data', or NULL if the volume cannot be shared
+  static osg::MatrixTransform* createSharedNode_(const SVData &data, const osg::Vec3& dir);
+  /// gives a node drawing a shared mesh its own copy of the mesh
+  static void unshare_(osg::MatrixTransform* xform);
   static void createPyramid_(osg::Geode& geode, const SVData &data, const osg::Vec3& dir);
   static osg::Geometry* createCone_(const SVData &data, const osg::Vec3& dir);
 
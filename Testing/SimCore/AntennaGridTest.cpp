@@ -0,0 +1,239 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/EM/AntennaPattern.h"
+#include "simCore/Time/Utils.h"
+
+namespace
+{
+
+/** Builds the az/el sample points used by the antenna display at the given detail (deg) */
+void makeGrid(double detail, std::vector<float>& azimuths, std::vector<float>& elevations)
+{
+  azimuths.clear();
+  elevations.clear();
+  for (double az = -180.0; az <= 180.0; az += detail)
+    azimuths.push_back(static_cast<float>(simCore::DEG2RAD * az));
+  for (double el = -90.0; el <= 90.0; el += detail)
+    elevations.push_back(static_cast<float>(simCore::DEG2RAD * el));
+  // values outside the table limits
+  azimuths.push_back(static_cast<float>(simCore::DEG2RAD * 250.0));
+  elevations.push_back(static_cast<float>(simCore::DEG2RAD * 95.0));
+}
+
+/** Fills a table pattern with a main lobe and side lobes, sampled irregularly */
+void fillTable(simCore::AntennaPatternTable& table)
+{
+  for (double az = -180.0; az <= 180.0; az += (fabs(az) < 10.0) ? 0.5 : 3.0)
+    table.setAzimData(static_cast<float>(simCore::DEG2RAD * az), static_cast<float>(-fabs(az) * 0.2 + 3.0 * cos(simCore::DEG2RAD * az * 8.0)));
+  for (double el = -90.0; el <= 90.0; el += (fabs(el) < 10.0) ? 0.5 : 2.0)
+    table.setElevData(static_cast<float>(simCore::DEG2RAD * el), static_cast<float>(-fabs(el) * 0.3 + 2.0 * cos(simCore::DEG2RAD * el * 6.0)));
+  table.setValid(true);
+}
+
+/** Compares gainGrid() against gain() for every point of the grid */
+int testPattern(simCore::AntennaPattern& pattern, const simCore::AntennaGainParameters& params, const std::string& name)
+{
+  std::vector<float> azimuths;
+  std::vector<float> elevations;
+  makeGrid(2.0, azimuths, elevations);
+
+  std::vector<float> gains;
+  pattern.gainGrid(azimuths, elevations, params, gains);
+  int rv = SDK_ASSERT(gains.size() == azimuths.size() * elevations.size());
+  if (rv != 0)
+    return rv;
+
+  size_t mismatches = 0;
+  simCore::AntennaGainParameters agp(params);
+  for (size_t e = 0; e < elevations.size(); ++e)
+  {
+    agp.elev_ = elevations[e];
+    for (size_t a = 0; a < azimuths.size(); ++a)
+    {
+      agp.azim_ = azimuths[a];
+      const float expected = pattern.gain(agp);
+      const float actual = gains[e * azimuths.size() + a];
+      if (expected != actual)
+      {
+        if (mismatches == 0)
+          std::cerr << name << " mismatch at az " << azimuths[a] << " el " << elevations[e] << ": " << actual << " != " << expected << std::endl;
+        ++mismatches;
+      }
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+
+  // empty inputs
+  pattern.gainGrid(std::vector<float>(), elevations, params, gains);
+  rv += SDK_ASSERT(gains.empty());
+  pattern.gainGrid(azimuths, std::vector<float>(), params, gains);
+  rv += SDK_ASSERT(gains.empty());
+  return rv;
+}
+
+int testEquivalence()
+{
+  int rv = 0;
+  const simCore::AntennaGainParameters params(0.f, 0.f, simCore::POLARITY_UNKNOWN, static_cast<float>(simCore::DEG2RAD * 12.0),
+    static_cast<float>(simCore::DEG2RAD * 5.0), 30.f, -23.2f, -20.0f, 3e9, false);
+  simCore::AntennaGainParameters weighted(params);
+  weighted.weighting_ = true;
+
+  simCore::AntennaPatternGauss gauss;
+  rv += testPattern(gauss, params, "Gauss");
+  simCore::AntennaPatternCscSq cscSq;
+  rv += testPattern(cscSq, params, "CscSq");
+  simCore::AntennaPatternSinXX sinXX;
+  rv += testPattern(sinXX, params, "SinXX");
+  simCore::AntennaPatternPedestal pedestal;
+  rv += testPattern(pedestal, params, "Pedestal");
+  simCore::AntennaPatternOmni omni;
+  rv += testPattern(omni, params, "Omni");
+
+  simCore::AntennaPatternTable table;
+  rv += testPattern(table, params, "Invalid table");
+  fillTable(table);
+  rv += testPattern(table, params, "Table");
+  rv += testPattern(table, weighted, "Weighted table");
+  simCore::AntennaGainParameters equalWidths(weighted);
+  equalWidths.vbw_ = equalWidths.hbw_;
+  rv += testPattern(table, equalWidths, "Weighted table, equal beam widths");
+
+  rv += SDK_ASSERT(table.gainGridThreadSafe());
+  return rv;
+}
+
+/** Min and max gains of a shared pattern must follow the reference gain of each request */
+int testMinMaxReferenceGain()
+{
+  int rv = 0;
+  const char* nsmaFile = "AntennaGridTest.nsma";
+  {
+    std::ofstream os(nsmaFile);
+    for (int k = 0; k < 7; ++k)
+      os << "header\n";
+    os << "2900-3100\n10\n5\n";
+    const char* azimPols[] = { "HH", "HV", "VV", "VH" };
+    for (int k = 0; k < 4; ++k)
+      os << azimPols[k] << " 3\n-180 -40\n0 0\n180 -40\n";
+    const char* elevPols[] = { "ELHH", "ELHV", "ELVV", "ELVH" };
+    for (int k = 0; k < 4; ++k)
+      os << elevPols[k] << " 3\n-90 -30\n0 0\n90 -30\n";
+  }
+  simCore::AntennaPatternNSMA nsma;
+  rv += SDK_ASSERT(nsma.readPat(nsmaFile) == 0);
+  remove(nsmaFile);
+
+  simCore::AntennaGainParameters params(0.f, 0.f, simCore::POLARITY_HORIZONTAL, 0.f, 0.f, 0.f, -23.2f, -20.0f, 3e9, false);
+  float min0 = 0.f;
+  float max0 = 0.f;
+  nsma.minMaxGain(&min0, &max0, params);
+  params.refGain_ = 12.f;
+  float min12 = 0.f;
+  float max12 = 0.f;
+  nsma.minMaxGain(&min12, &max12, params);
+  rv += SDK_ASSERT(simCore::areEqual(max12, max0 + 12.f, 1.0e-4));
+  rv += SDK_ASSERT(simCore::areEqual(min12, min0 + 12.f, 1.0e-4));
+  params.azim_ = 0.f;
+  params.elev_ = 0.f;
+  rv += SDK_ASSERT(simCore::areEqual(max12, nsma.gain(params), 1.0e-4));
+
+  // back to the first reference gain
+  params.refGain_ = 0.f;
+  float min = 0.f;
+  float max = 0.f;
+  nsma.minMaxGain(&min, &max, params);
+  rv += SDK_ASSERT(min == min0 && max == max0);
+  return rv;
+}
+
+/** Times gain() against gainGrid() for a table pattern at the finest antenna display detail */
+int testBenchmark()
+{
+  int rv = 0;
+  simCore::AntennaPatternTable table;
+  fillTable(table);
+  simCore::AntennaGainParameters params(0.f, 0.f, simCore::POLARITY_UNKNOWN, static_cast<float>(simCore::DEG2RAD * 12.0),
+    static_cast<float>(simCore::DEG2RAD * 5.0), 30.f, -23.2f, -20.0f, 3e9, true);
+
+  std::vector<float> azimuths;
+  std::vector<float> elevations;
+  makeGrid(1.0, azimuths, elevations);
+  const int iterations = 5;
+
+  for (int weighting = 0; weighting < 2; ++weighting)
+  {
+    params.weighting_ = (weighting != 0);
+    double sum1 = 0.0;
+    double start = simCore::getSystemTime();
+    for (int i = 0; i < iterations; ++i)
+    {
+      for (size_t e = 0; e < elevations.size(); ++e)
+      {
+        for (size_t a = 0; a < azimuths.size(); ++a)
+        {
+          params.azim_ = azimuths[a];
+          params.elev_ = elevations[e];
+          sum1 += table.gain(params);
+        }
+      }
+    }
+    const double pointTime = simCore::getSystemTime() - start;
+
+    double sum2 = 0.0;
+    std::vector<float> gains;
+    start = simCore::getSystemTime();
+    for (int i = 0; i < iterations; ++i)
+    {
+      table.gainGrid(azimuths, elevations, params, gains);
+      for (size_t k = 0; k < gains.size(); ++k)
+        sum2 += gains[k];
+    }
+    const double gridTime = simCore::getSystemTime() - start;
+
+    rv += SDK_ASSERT(sum1 == sum2);
+    std::cout << "  Table pattern " << azimuths.size() << "x" << elevations.size() << (params.weighting_ ? " weighted" : "")
+      << ", " << iterations << " iterations: gain() " << pointTime << " s, gainGrid() " << gridTime << " s" << std::endl;
+  }
+  return rv;
+}
+
+}
+
+int AntennaGridTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  rv += testEquivalence();
+  rv += testMinMaxReferenceGain();
+  rv += testBenchmark();
+
+  std::cout << "AntennaGridTest " << ((rv == 0) ? "Passed" : "Failed") << std::endl;
+  return rv;
+}
@@ -0,0 +1,318 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/Time/Utils.h"
+
+namespace
+{
+
+/** Gold data tolerance in meters; the NGA gold data is approximate */
+const double GOLD_EPSILON_M = 0.9;
+/** Gold data tolerance in radians; about one meter at the equator */
+const double GOLD_EPSILON_RAD = 1.57e-7;
+
+/** Loads a comma separated NGA gold data file; lat and lon are converted from degrees */
+int loadGoldData(const std::string& fileName, bool lla, simCore::PositionArrays& positions)
+{
+  std::ifstream inFile(fileName.c_str());
+  if (!inFile)
+  {
+    std::cout << "Error opening file " << fileName << std::endl;
+    return 1;
+  }
+
+  std::string line;
+  while (std::getline(inFile, line))
+  {
+    double values[3];
+    if (sscanf(line.c_str(), "%lf , %lf , %lf", &values[0], &values[1], &values[2]) != 3)
+      continue;
+    const double scale = lla ? simCore::DEG2RAD : 1.0;
+    positions.x_.push_back(values[0] * scale);
+    positions.y_.push_back(values[1] * scale);
+    positions.z_.push_back(values[2]);
+  }
+  return positions.size() > 0 ? 0 : 1;
+}
+
+/** Returns the number of positions that differ by more than the epsilons */
+int compareGold(const simCore::PositionArrays& expected, const simCore::PositionArrays& actual, double epsilonXY, double epsilonZ)
+{
+  if (expected.size() != actual.size())
+    return 1;
+  int rv = 0;
+  for (size_t k = 0; k < expected.size(); ++k)
+  {
+    if (!simCore::areEqual(expected.x_[k], actual.x_[k], epsilonXY) ||
+      !simCore::areEqual(expected.y_[k], actual.y_[k], epsilonXY) ||
+      !simCore::areEqual(expected.z_[k], actual.z_[k], epsilonZ))
+      ++rv;
+  }
+  return rv;
+}
+
+/** Returns the number of geodetic positions that differ; longitude is ignored at the poles */
+int compareGoldLla(const simCore::PositionArrays& expected, const simCore::PositionArrays& actual)
+{
+  if (expected.size() != actual.size())
+    return 1;
+  int rv = 0;
+  for (size_t k = 0; k < expected.size(); ++k)
+  {
+    const bool atPole = simCore::areEqual(fabs(expected.x_[k]), M_PI_2, GOLD_EPSILON_RAD);
+    if (!simCore::areEqual(expected.x_[k], actual.x_[k], GOLD_EPSILON_RAD) ||
+      (!atPole && !simCore::areEqual(simCore::angFixPI(expected.y_[k] - actual.y_[k]), 0.0, GOLD_EPSILON_RAD)) ||
+      !simCore::areEqual(expected.z_[k], actual.z_[k], GOLD_EPSILON_M))
+      ++rv;
+  }
+  return rv;
+}
+
+int testGoldData(const std::string& dataDir)
+{
+  int rv = 0;
+  simCore::PositionArrays lla;
+  simCore::PositionArrays ecef;
+  simCore::PositionArrays tangentPlane;
+  simCore::PositionArrays enu;
+  rv += SDK_ASSERT(loadGoldData(dataDir + "/geodetic.dat", true, lla) == 0);
+  rv += SDK_ASSERT(loadGoldData(dataDir + "/geocentric.dat", false, ecef) == 0);
+  rv += SDK_ASSERT(loadGoldData(dataDir + "/tan_plane_0_0_0.dat", false, tangentPlane) == 0);
+  rv += SDK_ASSERT(loadGoldData(dataDir + "/out3.dat", false, enu) == 0);
+  if (rv != 0)
+    return rv;
+
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOrigin(0, 0, 0);
+  simCore::PositionArrays out;
+
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(lla, out);
+  rv += SDK_ASSERT(compareGold(ecef, out, GOLD_EPSILON_M, GOLD_EPSILON_M) == 0);
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef, out);
+  rv += SDK_ASSERT(compareGoldLla(lla, out) == 0);
+
+  rv += SDK_ASSERT(cc.convertEcefPosToXEast(ecef, out) == 0);
+  rv += SDK_ASSERT(compareGold(tangentPlane, out, GOLD_EPSILON_M, GOLD_EPSILON_M) == 0);
+  rv += SDK_ASSERT(cc.convertXEastPosToEcef(tangentPlane, out) == 0);
+  rv += SDK_ASSERT(compareGold(ecef, out, GOLD_EPSILON_M, GOLD_EPSILON_M) == 0);
+  rv += SDK_ASSERT(cc.convertGeodeticPosToXEast(lla, out) == 0);
+  rv += SDK_ASSERT(compareGold(tangentPlane, out, GOLD_EPSILON_M, GOLD_EPSILON_M) == 0);
+  rv += SDK_ASSERT(cc.convertXEastPosToGeodetic(tangentPlane, out) == 0);
+  rv += SDK_ASSERT(compareGoldLla(lla, out) == 0);
+
+  rv += SDK_ASSERT(cc.convertGeodeticPosToFlat(lla, out, simCore::COORD_SYS_ENU) == 0);
+  rv += SDK_ASSERT(compareGold(enu, out, GOLD_EPSILON_M, GOLD_EPSILON_M) == 0);
+  return rv;
+}
+
+/** Fills positions with a spread of geodetic positions, including the poles */
+void makeLla(size_t count, simCore::PositionArrays& lla)
+{
+  lla.resize(count);
+  for (size_t k = 0; k < count; ++k)
+  {
+    lla.x_[k] = (static_cast<double>(k % 181) - 90.0) * simCore::DEG2RAD;
+    lla.y_[k] = (static_cast<double>((k * 7) % 360) - 180.0) * simCore::DEG2RAD;
+    lla.z_[k] = static_cast<double>(k % 50) * 1000.0 - 10000.0;
+  }
+}
+
+/** Compares each batch conversion against the Coordinate based conversion of the same point */
+int testMatchesConvert()
+{
+  int rv = 0;
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOriginDegrees(22.0, -159.0, 10.0);
+
+  simCore::PositionArrays lla;
+  makeLla(1000, lla);
+  simCore::PositionArrays ecef;
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(lla, ecef);
+  simCore::PositionArrays backToLla;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef, backToLla);
+  simCore::PositionArrays tp;
+  rv += SDK_ASSERT(cc.convertEcefPosToXEast(ecef, tp) == 0);
+  simCore::PositionArrays tpToEcef;
+  rv += SDK_ASSERT(cc.convertXEastPosToEcef(tp, tpToEcef) == 0);
+
+  const simCore::CoordinateSystem flatSystems[] = { simCore::COORD_SYS_NED, simCore::COORD_SYS_NWU, simCore::COORD_SYS_ENU };
+  simCore::PositionArrays flat[3];
+  simCore::PositionArrays flatToLla[3];
+  for (size_t f = 0; f < 3; ++f)
+  {
+    rv += SDK_ASSERT(cc.convertGeodeticPosToFlat(lla, flat[f], flatSystems[f]) == 0);
+    rv += SDK_ASSERT(cc.convertFlatPosToGeodetic(flat[f], flatSystems[f], flatToLla[f]) == 0);
+  }
+
+  int mismatches = 0;
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    const simCore::Coordinate llaCoord(simCore::COORD_SYS_LLA, lla.get(k));
+    simCore::Coordinate out;
+    cc.convert(llaCoord, out, simCore::COORD_SYS_ECEF);
+    if (!simCore::v3AreEqual(out.position(), ecef.get(k), 1e-6))
+      ++mismatches;
+
+    simCore::Vec3 scalarLla;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef.get(k), scalarLla);
+    if (!simCore::v3AreEqual(scalarLla, backToLla.get(k), 1e-9))
+      ++mismatches;
+
+    cc.convert(simCore::Coordinate(simCore::COORD_SYS_ECEF, ecef.get(k)), out, simCore::COORD_SYS_XEAST);
+    if (!simCore::v3AreEqual(out.position(), tp.get(k), 1e-6))
+      ++mismatches;
+    if (!simCore::v3AreEqual(tpToEcef.get(k), ecef.get(k), 1e-6))
+      ++mismatches;
+
+    for (size_t f = 0; f < 3; ++f)
+    {
+      cc.convert(llaCoord, out, flatSystems[f]);
+      if (!simCore::v3AreEqual(out.position(), flat[f].get(k), 1e-6))
+        ++mismatches;
+      simCore::Coordinate flatLla;
+      cc.convert(simCore::Coordinate(flatSystems[f], flat[f].get(k)), flatLla, simCore::COORD_SYS_LLA);
+      if (!simCore::v3AreEqual(flatLla.position(), flatToLla[f].get(k), 1e-9))
+        ++mismatches;
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+
+  // Converting in place gives the same result
+  simCore::PositionArrays inPlace = lla;
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(inPlace, inPlace);
+  rv += SDK_ASSERT(inPlace.x_ == ecef.x_ && inPlace.y_ == ecef.y_ && inPlace.z_ == ecef.z_);
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(inPlace, inPlace);
+  rv += SDK_ASSERT(inPlace.x_ == backToLla.x_ && inPlace.y_ == backToLla.y_ && inPlace.z_ == backToLla.z_);
+  return rv;
+}
+
+int testSpecialCases()
+{
+  int rv = 0;
+  simCore::PositionArrays ecef;
+  ecef.resize(4);
+  ecef.set(0, simCore::Vec3(0.0, 0.0, simCore::WGS_B + 100.0));
+  ecef.set(1, simCore::Vec3(0.0, 0.0, -simCore::WGS_B - 100.0));
+  ecef.set(2, simCore::Vec3(0.0, 0.0, 0.0));
+  ecef.set(3, simCore::Vec3(0.0, simCore::WGS_A, 0.0));
+  simCore::PositionArrays lla;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef, lla);
+  for (size_t k = 0; k < ecef.size(); ++k)
+  {
+    simCore::Vec3 expected;
+    simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef.get(k), expected);
+    rv += SDK_ASSERT(simCore::v3AreEqual(expected, lla.get(k), 1e-9));
+  }
+  rv += SDK_ASSERT(simCore::areEqual(lla.z_[0], 100.0, 1e-6));
+
+  // Empty input produces empty output
+  simCore::PositionArrays empty;
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(empty, lla);
+  rv += SDK_ASSERT(lla.size() == 0);
+
+  // Conversions that need a reference origin fail without one
+  simCore::CoordinateConverter noOrigin;
+  simCore::PositionArrays out;
+  rv += SDK_ASSERT(noOrigin.convertEcefPosToXEast(ecef, out) != 0);
+  rv += SDK_ASSERT(noOrigin.convertGeodeticPosToFlat(lla, out, simCore::COORD_SYS_ENU) != 0);
+
+  // Flat earth conversions reject other systems and polar origins
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOrigin(0, 0, 0);
+  rv += SDK_ASSERT(cc.convertGeodeticPosToFlat(lla, out, simCore::COORD_SYS_XEAST) != 0);
+  cc.setReferenceOrigin(M_PI_2, 0, 0);
+  rv += SDK_ASSERT(cc.convertFlatPosToGeodetic(lla, simCore::COORD_SYS_NED, out) != 0);
+  return rv;
+}
+
+/** Times the batch conversions against Coordinate based conversions */
+int testBenchmark()
+{
+  int rv = 0;
+  simCore::CoordinateConverter cc;
+  cc.setReferenceOriginDegrees(22.0, -159.0, 10.0);
+  simCore::PositionArrays lla;
+  makeLla(200000, lla);
+
+  double start = simCore::getSystemTime();
+  simCore::Coordinate out;
+  double sum = 0.0;
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    cc.convert(simCore::Coordinate(simCore::COORD_SYS_LLA, lla.get(k)), out, simCore::COORD_SYS_ECEF);
+    sum += out.x();
+  }
+  const double scalarToEcef = simCore::getSystemTime() - start;
+
+  simCore::PositionArrays ecef;
+  start = simCore::getSystemTime();
+  simCore::CoordinateConverter::convertGeodeticPosToEcef(lla, ecef);
+  const double batchToEcef = simCore::getSystemTime() - start;
+
+  simCore::Coordinate llaOut;
+  start = simCore::getSystemTime();
+  for (size_t k = 0; k < ecef.size(); ++k)
+  {
+    cc.convert(simCore::Coordinate(simCore::COORD_SYS_ECEF, ecef.get(k)), llaOut, simCore::COORD_SYS_LLA);
+    sum += llaOut.lat();
+  }
+  const double scalarToLla = simCore::getSystemTime() - start;
+
+  simCore::PositionArrays backToLla;
+  start = simCore::getSystemTime();
+  simCore::CoordinateConverter::convertEcefToGeodeticPos(ecef, backToLla);
+  const double batchToLla = simCore::getSystemTime() - start;
+
+  simCore::PositionArrays tp;
+  start = simCore::getSystemTime();
+  rv += SDK_ASSERT(cc.convertEcefPosToXEast(ecef, tp) == 0);
+  const double batchToXEast = simCore::getSystemTime() - start;
+
+  rv += SDK_ASSERT(sum != 0.0);
+  std::cout << "  " << lla.size() << " positions, Coordinate vs batch:" << std::endl
+    << "    LLA to ECEF: " << scalarToEcef << " s vs " << batchToEcef << " s" << std::endl
+    << "    ECEF to LLA: " << scalarToLla << " s vs " << batchToLla << " s" << std::endl
+    << "    ECEF to XEast (batch): " << batchToXEast << " s" << std::endl;
+  return rv;
+}
+
+}
+
+int BatchCoordConvertTest(int argc, char* argv[])
+{
+  int rv = 0;
+  // The gold data directory is optional; the remaining tests do not need it
+  if (argc >= 2)
+    rv += SDK_ASSERT(testGoldData(argv[1]) == 0);
+  rv += SDK_ASSERT(testMatchesConvert() == 0);
+  rv += SDK_ASSERT(testSpecialCases() == 0);
+  rv += SDK_ASSERT(testBenchmark() == 0);
+  return rv;
+}
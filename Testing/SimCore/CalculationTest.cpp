@@ -1460,7 +1460,104 @@ int testTaos_intercept()
   return rv;
 }
 
+/** Compares every RelativeGeometryFrame calculation against the free function for one model */
+int testRelativeGeometryFrame(simCore::EarthModelCalculations model, const simCore::CoordinateConverter* coordConv)
+{
+  int rv = 0;
+  const simCore::Vec3 fromLla(22.0 * simCore::DEG2RAD, -159.0 * simCore::DEG2RAD, 1500.0);
+  const simCore::Vec3 fromOri(35.0 * simCore::DEG2RAD, 5.0 * simCore::DEG2RAD, -2.0 * simCore::DEG2RAD);
+  const simCore::Vec3 fromVel(120.0, 80.0, -3.0);
+  const simCore::RelativeGeometryFrame frame(fromLla, fromOri, fromVel, model, coordConv);
+  rv += SDK_ASSERT(frame.isValid());
+  rv += SDK_ASSERT(frame.model() == model);
+
+  std::vector<simCore::Vec3> toLla;
+  std::vector<simCore::Vec3> toOri;
+  std::vector<simCore::Vec3> toVel;
+  for (int k = 0; k < 24; ++k)
+  {
+    const double azim = k * 15.0 * simCore::DEG2RAD;
+    toLla.push_back(simCore::Vec3(fromLla[0] + 0.2 * cos(azim) * simCore::DEG2RAD, fromLla[1] + 0.3 * sin(azim) * simCore::DEG2RAD, 100.0 * k));
+    toOri.push_back(simCore::Vec3(simCore::angFix2PI(azim + M_PI), 0.0, 0.0));
+    toVel.push_back(simCore::Vec3(-10.0 * k, 5.0, 1.0));
+  }
+
+  std::vector<simCore::RelativeGeometryFrame::TargetGeometry> results;
+  rv += SDK_ASSERT(frame.calculate(toLla, toVel, results) == 0);
+  rv += SDK_ASSERT(results.size() == toLla.size());
+  if (rv != 0)
+    return rv;
+
+  const bool sphere = (model == simCore::PERFECT_SPHERE);
+  for (size_t k = 0; k < toLla.size(); ++k)
+  {
+    double az = 0.0;
+    double el = 0.0;
+    double cmp = 0.0;
+    double frameAz = 0.0;
+    double frameEl = 0.0;
+    double frameCmp = 0.0;
+    simCore::calculateAbsAzEl(fromLla, toLla[k], &az, &el, &cmp, model, coordConv);
+    frame.calculateAbsAzEl(toLla[k], &frameAz, &frameEl, &frameCmp);
+    rv += SDK_ASSERT(simCore::areEqual(az, frameAz, 1e-12) && simCore::areEqual(el, frameEl, 1e-12) && simCore::areEqual(cmp, frameCmp, 1e-12));
+    rv += SDK_ASSERT(simCore::areEqual(az, results[k].azim_, 1e-9) && simCore::areEqual(el, results[k].elev_, 1e-9) && simCore::areEqual(cmp, results[k].cmp_, 1e-9));
+
+    const double slant = simCore::calculateSlant(fromLla, toLla[k], model, coordConv);
+    rv += SDK_ASSERT(simCore::areEqual(slant, frame.calculateSlant(toLla[k]), 1e-6));
+    rv += SDK_ASSERT(simCore::areEqual(slant, results[k].slant_, 1e-6));
+    if (sphere)
+      continue;
+
+    simCore::calculateRelAzEl(fromLla, fromOri, toLla[k], &az, &el, &cmp, model, coordConv);
+    frame.calculateRelAzEl(toLla[k], &frameAz, &frameEl, &frameCmp);
+    rv += SDK_ASSERT(simCore::areEqual(az, frameAz, 1e-12) && simCore::areEqual(el, frameEl, 1e-12) && simCore::areEqual(cmp, frameCmp, 1e-12));
+    rv += SDK_ASSERT(simCore::areEqual(az, results[k].relAzim_, 1e-9) && simCore::areEqual(el, results[k].relElev_, 1e-9) && simCore::areEqual(cmp, results[k].relCmp_, 1e-9));
+
+    const double ground = simCore::calculateGroundDist(fromLla, toLla[k], model, coordConv);
+    rv += SDK_ASSERT(simCore::areEqual(ground, frame.calculateGroundDist(toLla[k]), 1e-6));
+    rv += SDK_ASSERT(simCore::areEqual(ground, results[k].ground_, 1e-6));
+    const double altitude = simCore::calculateAltitude(fromLla, toLla[k], model, coordConv);
+    rv += SDK_ASSERT(simCore::areEqual(altitude, frame.calculateAltitude(toLla[k]), 1e-6));
+    rv += SDK_ASSERT(simCore::areEqual(altitude, results[k].altitude_, 1e-6));
+
+    const double closing = simCore::calculateClosingVelocity(fromLla, toLla[k], model, coordConv, fromVel, toVel[k]);
+    rv += SDK_ASSERT(simCore::areEqual(closing, frame.calculateClosingVelocity(toLla[k], toVel[k]), 1e-9));
+    rv += SDK_ASSERT(simCore::areEqual(closing, results[k].closingVelocity_, 1e-6));
+    rv += SDK_ASSERT(simCore::areEqual(simCore::calculateVelocityDelta(fromLla, toLla[k], model, coordConv, fromVel, toVel[k]),
+      frame.calculateVelocityDelta(toLla[k], toVel[k]), 1e-9));
+    rv += SDK_ASSERT(simCore::areEqual(simCore::calculateRangeRate(fromLla, fromOri, toLla[k], toOri[k], model, coordConv, fromVel, toVel[k]),
+      frame.calculateRangeRate(toLla[k], toOri[k], toVel[k]), 1e-9));
+    rv += SDK_ASSERT(simCore::areEqual(simCore::calculateBearingRate(fromLla, fromOri, toLla[k], toOri[k], model, coordConv, fromVel, toVel[k]),
+      frame.calculateBearingRate(toLla[k], toOri[k], toVel[k]), 1e-9));
+  }
 
+  // Mismatched velocities are rejected
+  toVel.pop_back();
+  rv += SDK_ASSERT(frame.calculate(toLla, toVel, results) != 0);
+  // Stationary targets need no velocities
+  rv += SDK_ASSERT(frame.calculate(toLla, std::vector<simCore::Vec3>(), results) == 0);
+  rv += SDK_ASSERT(results.size() == toLla.size());
+  return rv;
+}
+
+int testRelativeGeometryFrame()
+{
+  int rv = 0;
+  simCore::CoordinateConverter coordConv;
+  coordConv.setReferenceOriginDegrees(21.9, -159.1, 0.0);
+  rv += SDK_ASSERT(testRelativeGeometryFrame(simCore::WGS_84, NULL) == 0);
+  rv += SDK_ASSERT(testRelativeGeometryFrame(simCore::WGS_84, &coordConv) == 0);
+  rv += SDK_ASSERT(testRelativeGeometryFrame(simCore::TANGENT_PLANE_WGS_84, NULL) == 0);
+  rv += SDK_ASSERT(testRelativeGeometryFrame(simCore::FLAT_EARTH, &coordConv) == 0);
+  rv += SDK_ASSERT(testRelativeGeometryFrame(simCore::PERFECT_SPHERE, NULL) == 0);
+
+  // Flat earth needs a converter with a reference origin
+  const simCore::RelativeGeometryFrame invalid(simCore::Vec3(), simCore::Vec3(), simCore::Vec3(), simCore::FLAT_EARTH, NULL);
+  rv += SDK_ASSERT(!invalid.isValid());
+  std::vector<simCore::RelativeGeometryFrame::TargetGeometry> results;
+  rv += SDK_ASSERT(invalid.calculate(std::vector<simCore::Vec3>(1), std::vector<simCore::Vec3>(), results) != 0);
+  return rv;
+}
 
 }
 
@@ -1487,6 +1584,7 @@ int CalculationTest(int argc, char* argv[])
   rv += testMidPointHighRes();
   rv += testRandom();
   rv += testTaos_intercept();
+  rv += testRelativeGeometryFrame();
 
   return rv;
 }
@@ -19,11 +19,17 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
 #include <float.h>
+#include <iostream>
+#include <memory>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Angle.h"
+#include "simCore/Calc/CoordinateConverter.h"
 #include "simCore/Calc/Math.h"
 #include "simCore/Calc/Geometry.h"
+#include "simCore/Time/Utils.h"
 
 namespace {
 
@@ -520,6 +526,202 @@ namespace {
 
     return rv;
   }
+
+  /** Returns ECEF fence posts around an LLA box, in degrees, in CCW order; the last post repeats the first if closed */
+  simCore::Vec3String boxPosts(double south, double west, double north, double east, bool closed)
+  {
+    const double lla[4][2] = { { north, west }, { south, west }, { south, east }, { north, east } };
+    simCore::Vec3String posts;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      simCore::Vec3 ecef;
+      simCore::CoordinateConverter::convertGeodeticPosToEcef(simCore::Vec3(lla[i][0] * simCore::DEG2RAD, lla[i][1] * simCore::DEG2RAD, 0.0), ecef);
+      posts.push_back(ecef);
+    }
+    if (closed)
+      posts.push_back(posts.front());
+    return posts;
+  }
+
+  /** Builds a polytope from the same planes a GeoFence builds from its posts, without any bounding cap */
+  simCore::Polytope planesOf(const simCore::Vec3String& posts)
+  {
+    simCore::Polytope tope;
+    for (size_t i = 0; i + 1 < posts.size(); ++i)
+      tope.addPlane(simCore::Plane(posts[i], posts[i + 1], simCore::Vec3(0, 0, 0)));
+    return tope;
+  }
+
+  /** Generates ECEF points spread over the globe at a few altitudes, plus points near the earth's center */
+  void makePoints(simCore::Vec3String& points, size_t count)
+  {
+    points.clear();
+    const double altitudes[] = { 0.0, 10000.0, -2000.0, 400000.0 };
+    for (size_t k = 0; k < count; ++k)
+    {
+      // Irregular steps cover latitude and longitude without repeating a pattern
+      const double lat = asin(fmod(k * 0.6180339887, 2.0) - 1.0);
+      const double lon = fmod(k * 2.399963, M_TWOPI) - M_PI;
+      simCore::Vec3 ecef;
+      simCore::CoordinateConverter::convertGeodeticPosToEcef(simCore::Vec3(lat, lon, altitudes[k % 4]), ecef);
+      points.push_back(ecef);
+    }
+    points.push_back(simCore::Vec3(0.0, 0.0, 0.0));
+    points.push_back(simCore::Vec3(1.0, 0.0, 0.0));
+    points.push_back(simCore::Vec3(-3.0e5, 2.0e5, 1.0e5));
+  }
+
+  /** Batch and cap-accelerated classification must match the plane tests exactly */
+  int testBatchContains()
+  {
+    int rv = 0;
+    std::vector<simCore::Vec3String> fencePosts;
+    fencePosts.push_back(boxPosts(-20.0, -10.0, 40.0, 20.0, true));
+    fencePosts.push_back(boxPosts(-40.0, 170.0, 20.0, 200.0, true));
+    fencePosts.push_back(boxPosts(70.0, 10.0, 89.99, 140.0, true));
+    fencePosts.push_back(boxPosts(10.0, 10.0, 10.001, 10.001, true));
+    // open fences and fences larger than a hemisphere have no cap
+    fencePosts.push_back(boxPosts(-20.0, -10.0, 40.0, 20.0, false));
+    fencePosts.push_back(boxPosts(-60.0, -100.0, 60.0, 100.0, true));
+
+    simCore::Vec3String points;
+    makePoints(points, 20000);
+    // posts and points just beside them are the hardest cases
+    for (size_t f = 0; f < fencePosts.size(); ++f)
+    {
+      for (size_t i = 0; i < fencePosts[f].size(); ++i)
+      {
+        const simCore::Vec3& post = fencePosts[f][i];
+        points.push_back(post);
+        points.push_back(simCore::Vec3(post.x() + 1e-6, post.y() - 1e-6, post.z() + 1e-6));
+        points.push_back(simCore::Vec3(post.x() - 1e-4, post.y() + 1e-4, post.z() - 1e-4));
+      }
+    }
+
+    for (size_t f = 0; f < fencePosts.size(); ++f)
+    {
+      const simCore::GeoFence fence(fencePosts[f], simCore::COORD_SYS_ECEF);
+      const simCore::Polytope reference = planesOf(fencePosts[f]);
+      simCore::Vec3 axis;
+      double cosRadius = 0.0;
+      double margin = 0.0;
+      const bool hasCap = fence.boundingCap(axis, cosRadius, margin);
+      rv += SDK_ASSERT(hasCap == (f < 4));
+
+      std::vector<bool> batch;
+      fence.contains(points, batch);
+      std::vector<bool> topeBatch;
+      reference.contains(points, topeBatch);
+      rv += SDK_ASSERT(batch.size() == points.size());
+      rv += SDK_ASSERT(topeBatch.size() == points.size());
+      size_t mismatches = 0;
+      size_t numInside = 0;
+      for (size_t k = 0; k < points.size(); ++k)
+      {
+        const bool expected = reference.contains(points[k]);
+        if (fence.contains(points[k]) != expected || batch[k] != expected || topeBatch[k] != expected)
+          ++mismatches;
+        if (expected)
+          ++numInside;
+      }
+      rv += SDK_ASSERT(mismatches == 0);
+      rv += SDK_ASSERT(numInside > 0);
+    }
+
+    // empty input and empty polytopes
+    std::vector<bool> results(3, false);
+    simCore::Polytope empty;
+    empty.contains(points, results);
+    rv += SDK_ASSERT(results.size() == points.size() && results.front() && results.back());
+    empty.contains(simCore::Vec3String(), results);
+    rv += SDK_ASSERT(results.empty());
+    return rv;
+  }
+
+  /** The fence index must find exactly the fences a scan of all fences finds */
+  int testFenceIndex()
+  {
+    int rv = 0;
+    const size_t numFences = 200;
+    simCore::GeoFenceIndex index;
+    std::vector<std::shared_ptr<simCore::GeoFence> > fences;
+    for (size_t f = 0; f < numFences; ++f)
+    {
+      // boxes of a few degrees scattered over the globe, some across the anti-meridian and near the poles
+      const double south = -84.0 + fmod(f * 37.3, 160.0);
+      const double west = -180.0 + fmod(f * 53.7, 360.0);
+      const double height = 1.0 + (f % 7);
+      const double width = 2.0 + (f % 5) * 3.0;
+      std::shared_ptr<simCore::GeoFence> fence(new simCore::GeoFence(boxPosts(south, west, south + height, west + width, (f % 50) != 0), simCore::COORD_SYS_ECEF));
+      fences.push_back(fence);
+      rv += SDK_ASSERT(index.addFence(fence) == f);
+    }
+    rv += SDK_ASSERT(index.numFences() == numFences);
+
+    simCore::Vec3String points;
+    makePoints(points, 10000);
+
+    // reference: every point against every fence
+    double start = simCore::getSystemTime();
+    std::vector<std::vector<size_t> > expected(points.size());
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+      for (size_t f = 0; f < numFences; ++f)
+      {
+        if (fences[f]->contains(points[k]))
+          expected[k].push_back(f);
+      }
+    }
+    const double scanTime = simCore::getSystemTime() - start;
+
+    start = simCore::getSystemTime();
+    std::vector<std::vector<bool> > perFence(numFences);
+    for (size_t f = 0; f < numFences; ++f)
+      fences[f]->contains(points, perFence[f]);
+    const double batchTime = simCore::getSystemTime() - start;
+
+    start = simCore::getSystemTime();
+    std::vector<size_t> found;
+    size_t singleMismatches = 0;
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+      index.find(points[k], found);
+      if (found != expected[k])
+        ++singleMismatches;
+    }
+    const double indexTime = simCore::getSystemTime() - start;
+
+    start = simCore::getSystemTime();
+    std::vector<std::vector<size_t> > batchFound;
+    index.find(points, batchFound);
+    const double indexBatchTime = simCore::getSystemTime() - start;
+
+    rv += SDK_ASSERT(singleMismatches == 0);
+    rv += SDK_ASSERT(batchFound == expected);
+    size_t batchMismatches = 0;
+    size_t numContained = 0;
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+      for (size_t f = 0; f < numFences; ++f)
+      {
+        const bool inExpected = std::find(expected[k].begin(), expected[k].end(), f) != expected[k].end();
+        if (perFence[f][k] != inExpected)
+          ++batchMismatches;
+      }
+      numContained += expected[k].size();
+    }
+    rv += SDK_ASSERT(batchMismatches == 0);
+    rv += SDK_ASSERT(numContained > 0);
+
+    std::cout << "  " << points.size() << " points against " << numFences << " fences: scan " << scanTime
+      << " s, batch per fence " << batchTime << " s, index " << indexTime << " s, index batch " << indexBatchTime << " s" << std::endl;
+
+    index.clear();
+    rv += SDK_ASSERT(index.numFences() == 0);
+    index.find(points[0], found);
+    rv += SDK_ASSERT(found.empty());
+    return rv;
+  }
 }
 
 
@@ -530,6 +732,8 @@ int GeoFenceTest(int argc, char* argv[])
   rv += testGeoFilter2DPolygonZeroDeg();
   rv += testGeoFilter2DPolygonDateline();
   rv += testGeoFilter2DPolygonNPole();
+  rv += testBatchContains();
+  rv += testFenceIndex();
   return rv;
 }
 
@@ -0,0 +1,227 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/MagneticVariance.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/Calc/Vec3.h"
+#include "simCore/Time/TimeClass.h"
+#include "simCore/Time/Utils.h"
+
+namespace
+{
+
+/** Year, ordinal day, lat (deg), lon (deg), alt (m) and expected variance (rad) */
+struct ReferenceValue
+{
+  int year;
+  int day;
+  double latDeg;
+  double lonDeg;
+  double alt;
+  double varianceRad;
+};
+
+const ReferenceValue REFERENCE_VALUES[] = {
+  { 1987, 40, 0.0, 0.0, 0.0, -0.15237348252836297 },
+  { 1987, 40, 38.8, -77.0, 0.0, -0.16719294690475872 },
+  { 1987, 40, -89.9, -120.0, 500.0, 1.6114824322251022 },
+  { 1999, 300, 21.3, -157.9, 10000.0, 0.17860662924685747 },
+  { 1999, 300, -45.0, 170.0, 0.0, 0.41679717823527163 },
+  { 2012, 100, 38.8, -77.0, 0.0, -0.18859565637221681 },
+  { 2012, 100, 89.9, 20.0, 0.0, 0.15262239262072461 },
+  { 2012, 100, 90.0, 0.0, 0.0, -0.19872125273430774 },
+  { 2016, 5, 60.0, 100.0, 1000.0, -0.0020061578394638749 },
+  { 2016, 5, -33.9, 18.4, 0.0, -0.43607476347713264 },
+  { 2019, 364, 38.8, -77.0, 0.0, -0.18940165530714426 },
+  { 2019, 364, -90.0, 0.0, 0.0, -0.53747262934554774 }
+};
+const size_t NUM_REFERENCE_VALUES = sizeof(REFERENCE_VALUES) / sizeof(REFERENCE_VALUES[0]);
+
+/** Positions spread over the globe, in radians and meters */
+void makePositions(size_t count, std::vector<simCore::Vec3>& lla)
+{
+  lla.clear();
+  for (size_t k = 0; k < count; ++k)
+  {
+    const double lat = (-89.5 + fmod(k * 37.31, 179.0)) * simCore::DEG2RAD;
+    const double lon = (-180.0 + fmod(k * 101.77, 360.0)) * simCore::DEG2RAD;
+    lla.push_back(simCore::Vec3(lat, lon, fmod(k * 13.0, 5000.0)));
+  }
+}
+
+int testReferenceValues()
+{
+  int rv = 0;
+  simCore::WorldMagneticModel wmm;
+  for (size_t k = 0; k < NUM_REFERENCE_VALUES; ++k)
+  {
+    const ReferenceValue& ref = REFERENCE_VALUES[k];
+    double variance = 0.0;
+    rv += SDK_ASSERT(wmm.calculateMagneticVariance(simCore::Vec3(ref.latDeg * simCore::DEG2RAD, ref.lonDeg * simCore::DEG2RAD, ref.alt),
+      ref.day, ref.year, variance) == 0);
+    rv += SDK_ASSERT(simCore::areEqual(variance, ref.varianceRad, 1e-12));
+  }
+
+  // Dates outside the model
+  double variance = 1.0;
+  rv += SDK_ASSERT(wmm.calculateMagneticVariance(simCore::Vec3(), 0, 2021, variance) != 0);
+  rv += SDK_ASSERT(variance == 0.0);
+  rv += SDK_ASSERT(wmm.calculateMagneticVariance(simCore::Vec3(), 0, 1984, variance) != 0);
+  // A valid date after an invalid one
+  const ReferenceValue& ref = REFERENCE_VALUES[0];
+  rv += SDK_ASSERT(wmm.calculateMagneticVariance(simCore::Vec3(ref.latDeg * simCore::DEG2RAD, ref.lonDeg * simCore::DEG2RAD, ref.alt),
+    ref.day, ref.year, variance) == 0);
+  rv += SDK_ASSERT(simCore::areEqual(variance, ref.varianceRad, 1e-12));
+  return rv;
+}
+
+/** Models keep independent caches, so interleaved calls give the same values as separate ones */
+int testIndependentModels()
+{
+  int rv = 0;
+  simCore::WorldMagneticModel wmm1;
+  simCore::WorldMagneticModel wmm2;
+  const simCore::Vec3 north(60.0 * simCore::DEG2RAD, 10.0 * simCore::DEG2RAD, 0.0);
+  const simCore::Vec3 south(-40.0 * simCore::DEG2RAD, 10.0 * simCore::DEG2RAD, 0.0);
+  double expectedNorth = 0.0;
+  double expectedSouth = 0.0;
+  rv += SDK_ASSERT(wmm1.calculateMagneticVariance(north, 100, 2016, expectedNorth) == 0);
+  rv += SDK_ASSERT(wmm2.calculateMagneticVariance(south, 100, 2016, expectedSouth) == 0);
+
+  // Same latitude again for wmm1, after wmm2 evaluated another latitude
+  double variance = 0.0;
+  rv += SDK_ASSERT(wmm1.calculateMagneticVariance(simCore::Vec3(north.lat(), 20.0 * simCore::DEG2RAD, 0.0), 100, 2016, variance) == 0);
+  rv += SDK_ASSERT(wmm2.calculateMagneticVariance(south, 100, 2016, variance) == 0);
+  rv += SDK_ASSERT(wmm1.calculateMagneticVariance(north, 100, 2016, variance) == 0);
+  rv += SDK_ASSERT(variance == expectedNorth);
+  rv += SDK_ASSERT(wmm2.calculateMagneticVariance(simCore::Vec3(south.lat(), 30.0 * simCore::DEG2RAD, 0.0), 100, 2016, variance) == 0);
+  rv += SDK_ASSERT(wmm2.calculateMagneticVariance(south, 100, 2016, variance) == 0);
+  rv += SDK_ASSERT(variance == expectedSouth);
+  return rv;
+}
+
+int testGrid()
+{
+  int rv = 0;
+  const simCore::TimeStamp timeStamp(2016, 200.0 * 86400.0);
+  const double tolerance = 0.1 * simCore::DEG2RAD;
+  simCore::MagneticVarianceGrid grid;
+  double variance = 1.0;
+  rv += SDK_ASSERT(!grid.isValid());
+  rv += SDK_ASSERT(grid.calculateMagneticVariance(simCore::Vec3(), variance) != 0);
+  rv += SDK_ASSERT(grid.build(timeStamp, 0.0, 0.0, tolerance) != 0);
+  rv += SDK_ASSERT(grid.build(simCore::TimeStamp(1970, 0.0), simCore::DEG2RAD, 0.0, tolerance) != 0);
+  rv += SDK_ASSERT(!grid.isValid());
+
+  rv += SDK_ASSERT(grid.build(timeStamp, simCore::DEG2RAD, 0.0, tolerance) == 0);
+  rv += SDK_ASSERT(grid.isValid());
+  rv += SDK_ASSERT(simCore::areEqual(grid.spacing(), simCore::DEG2RAD));
+  rv += SDK_ASSERT(grid.maxSampledErrorRad() <= tolerance);
+  // Cells around the magnetic poles vary too quickly to interpolate
+  rv += SDK_ASSERT(grid.numDirectCells() > 0);
+  rv += SDK_ASSERT(grid.numDirectCells() < 180 * 360 / 10);
+
+  // Grid values stay close to the direct evaluation everywhere
+  std::vector<simCore::Vec3> lla;
+  makePositions(20000, lla);
+  for (size_t k = 0; k < lla.size(); ++k)
+    lla[k].setAlt(0.0);
+  lla.push_back(simCore::Vec3(M_PI_2, M_PI, 0.0));
+  lla.push_back(simCore::Vec3(-M_PI_2, -M_PI, 0.0));
+  lla.push_back(simCore::Vec3(0.0, 3.0 * M_PI, 0.0));
+  simCore::WorldMagneticModel wmm;
+  double maxError = 0.0;
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    double expected = 0.0;
+    rv += SDK_ASSERT(wmm.calculateMagneticVariance(lla[k], timeStamp, expected) == 0);
+    rv += SDK_ASSERT(grid.calculateMagneticVariance(lla[k], variance) == 0);
+    maxError = simCore::sdkMax(maxError, fabs(simCore::angFixPI(variance - expected)));
+  }
+  rv += SDK_ASSERT(maxError < 2.0 * tolerance);
+
+  // Nodes match the direct evaluation exactly
+  const simCore::Vec3 node(10.0 * simCore::DEG2RAD, -20.0 * simCore::DEG2RAD, 0.0);
+  double expected = 0.0;
+  rv += SDK_ASSERT(wmm.calculateMagneticVariance(node, timeStamp, expected) == 0);
+  rv += SDK_ASSERT(grid.calculateMagneticVariance(node, variance) == 0);
+  rv += SDK_ASSERT(simCore::areEqual(variance, expected, 1e-9));
+  return rv;
+}
+
+/** Times per-entity evaluation against grid lookup */
+int testBenchmark()
+{
+  int rv = 0;
+  std::vector<simCore::Vec3> lla;
+  makePositions(50000, lla);
+  for (size_t k = 0; k < lla.size(); ++k)
+    lla[k].setAlt(0.0);
+  const simCore::TimeStamp timeStamp(2018, 45.0 * 86400.0);
+
+  simCore::WorldMagneticModel wmm;
+  double sum = 0.0;
+  double start = simCore::getSystemTime();
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    double variance = 0.0;
+    wmm.calculateMagneticVariance(lla[k], timeStamp, variance);
+    sum += variance;
+  }
+  const double direct = simCore::getSystemTime() - start;
+
+  simCore::MagneticVarianceGrid grid;
+  start = simCore::getSystemTime();
+  rv += SDK_ASSERT(grid.build(timeStamp, simCore::DEG2RAD, 0.0, 0.1 * simCore::DEG2RAD) == 0);
+  const double build = simCore::getSystemTime() - start;
+  start = simCore::getSystemTime();
+  for (size_t k = 0; k < lla.size(); ++k)
+  {
+    double variance = 0.0;
+    grid.calculateMagneticVariance(lla[k], variance);
+    sum += variance;
+  }
+  const double lookup = simCore::getSystemTime() - start;
+
+  rv += SDK_ASSERT(sum != 0.0);
+  std::cout << "  " << lla.size() << " positions:" << std::endl
+    << "    direct: " << direct << " s" << std::endl
+    << "    grid: " << lookup << " s, after " << build << " s to build with "
+    << grid.numDirectCells() << " direct cells, max sampled error " << grid.maxSampledErrorRad() * simCore::RAD2DEG << " deg" << std::endl;
+  return rv;
+}
+
+}
+
+int MagneticVarianceTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += SDK_ASSERT(testReferenceValues() == 0);
+  rv += SDK_ASSERT(testIndependentModels() == 0);
+  rv += SDK_ASSERT(testGrid() == 0);
+  rv += SDK_ASSERT(testBenchmark() == 0);
+  return rv;
+}
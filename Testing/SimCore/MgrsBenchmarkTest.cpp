@@ -0,0 +1,124 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/Calc/Mgrs.h"
+#include "simCore/Time/Utils.h"
+
+namespace
+{
+
+/** Builds positions (rad) along tracks that wander across several zones, as recorded platform data does */
+void makeTracks(std::vector<double>& lats, std::vector<double>& lons, size_t count)
+{
+  lats.clear();
+  lons.clear();
+  const double startLats[] = { 36.5, -33.8, 0.2, 64.0, -85.0 };
+  const double startLons[] = { -76.3, 151.2, 8.9, -20.5, 120.0 };
+  const size_t numTracks = sizeof(startLats) / sizeof(startLats[0]);
+  const size_t perTrack = count / numTracks;
+  for (size_t t = 0; t < numTracks; ++t)
+  {
+    for (size_t k = 0; k < perTrack; ++k)
+    {
+      // About 20 m per point heading north east, with a gentle weave
+      const double latDeg = startLats[t] + k * 1.5e-4 + 0.01 * sin(k * 1e-3);
+      const double lonDeg = startLons[t] + k * 1.5e-4;
+      lats.push_back(latDeg * simCore::DEG2RAD);
+      lons.push_back(simCore::angFixPI(lonDeg * simCore::DEG2RAD));
+    }
+  }
+}
+
+/** Times per-point string conversion against the batch conversion in both directions */
+int testBenchmark()
+{
+  int rv = 0;
+  std::vector<double> lats;
+  std::vector<double> lons;
+  makeTracks(lats, lons, 200000);
+  std::cout << "  " << lats.size() << " track positions:" << std::endl;
+
+  std::vector<std::string> strings(lats.size());
+  size_t failures1 = 0;
+  double start = simCore::getSystemTime();
+  for (size_t k = 0; k < lats.size(); ++k)
+  {
+    if (simCore::Mgrs::convertGeodeticToMgrs(lats[k], lons[k], strings[k]) != 0)
+      ++failures1;
+  }
+  const double stringTime = simCore::getSystemTime() - start;
+
+  std::vector<char> buffer;
+  start = simCore::getSystemTime();
+  const size_t failures2 = simCore::Mgrs::convertGeodeticToMgrs(lats, lons, 5, buffer);
+  const double bufferTime = simCore::getSystemTime() - start;
+  rv += SDK_ASSERT(failures1 == 0 && failures2 == 0);
+
+  size_t mismatches = 0;
+  for (size_t k = 0; k < strings.size(); ++k)
+  {
+    if (strings[k] != &buffer[k * simCore::Mgrs::MGRS_BUFFER_SIZE])
+      ++mismatches;
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+
+  std::vector<double> singleLat(strings.size());
+  std::vector<double> singleLon(strings.size());
+  failures1 = 0;
+  start = simCore::getSystemTime();
+  for (size_t k = 0; k < strings.size(); ++k)
+  {
+    if (simCore::Mgrs::convertMgrsToGeodetic(strings[k], singleLat[k], singleLon[k]) != 0)
+      ++failures1;
+  }
+  const double parseTime = simCore::getSystemTime() - start;
+
+  std::vector<double> batchLat;
+  std::vector<double> batchLon;
+  start = simCore::getSystemTime();
+  const size_t parseFailures = simCore::Mgrs::convertMgrsToGeodetic(strings, batchLat, batchLon);
+  const double batchParseTime = simCore::getSystemTime() - start;
+  rv += SDK_ASSERT(failures1 == 0 && parseFailures == 0);
+  rv += SDK_ASSERT(singleLat == batchLat && singleLon == batchLon);
+
+  std::cout << "    to MGRS: per point " << stringTime << " s, batch " << bufferTime << " s" << std::endl;
+  std::cout << "    from MGRS: per point " << parseTime << " s, batch " << batchParseTime << " s" << std::endl;
+  return rv;
+}
+
+}
+
+int MgrsBenchmarkTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  rv += testBenchmark();
+
+  std::cout << "MgrsBenchmarkTest " << ((rv == 0) ? "Passed" : "Failed") << std::endl;
+  return rv;
+}
@@ -19,8 +19,13 @@
  * disclose, or release this software.
  *
  */
+#include <cmath>
+#include <string>
+#include <vector>
 #include "simCore/Common/SDKAssert.h"
 #include "simCore/Calc/Angle.h"
+#include "simCore/Calc/CoordinateSystem.h"
+#include "simCore/Calc/Math.h"
 #include "simCore/Calc/Mgrs.h"
 
 namespace
@@ -364,6 +369,161 @@ int divide()
   return rv;
 }
 
+/** Returns the MGRS string for a position in degrees, or an empty string on error */
+std::string toMgrs(double latDeg, double lonDeg, int precision = 5)
+{
+  std::string mgrs;
+  simCore::Mgrs::convertGeodeticToMgrs(latDeg * simCore::DEG2RAD, lonDeg * simCore::DEG2RAD, mgrs, precision);
+  return mgrs;
+}
+
+int llaToMgrs()
+{
+  int rv = 0;
+  // Same positions as mgrsToLla()
+  rv += SDK_ASSERT(toMgrs(0, 0) == "31NAA6602100000");
+  rv += SDK_ASSERT(toMgrs(32.5, -120.5) == "10SGA3487998613");
+  rv += SDK_ASSERT(toMgrs(-76, 179.99) == "60CWA8071262770");
+  rv += SDK_ASSERT(toMgrs(4.1, -179.99) == "01NAE6798353800");
+  rv += SDK_ASSERT(toMgrs(-79.999, 16.01846201) == "33CWM1974418352");
+  rv += SDK_ASSERT(toMgrs(0.5, 0.5) == "31NBA2173455318");
+  rv += SDK_ASSERT(toMgrs(89.99, -44.5258892) == "YZG9922199208");
+  rv += SDK_ASSERT(toMgrs(87.0, -1.0) == "YZD9418566906");
+  rv += SDK_ASSERT(toMgrs(-89.99, 16.0021174) == "BAN0030601067");
+  rv += SDK_ASSERT(toMgrs(0, 360.0) == "31NAA6602100000");
+
+  // Precision truncates the easting and northing
+  rv += SDK_ASSERT(toMgrs(0.5, 0.5, 3) == "31NBA217553");
+  rv += SDK_ASSERT(toMgrs(0.5, 0.5, 1) == "31NBA25");
+  rv += SDK_ASSERT(toMgrs(0.5, 0.5, 0) == "31NBA");
+
+  // Norway and Svalbard zone exceptions
+  rv += SDK_ASSERT(toMgrs(60.0, 5.0).substr(0, 3) == "32V");
+  rv += SDK_ASSERT(toMgrs(60.0, 2.0).substr(0, 3) == "31V");
+  rv += SDK_ASSERT(toMgrs(78.0, 8.0).substr(0, 3) == "31X");
+  rv += SDK_ASSERT(toMgrs(78.0, 15.0).substr(0, 3) == "33X");
+  rv += SDK_ASSERT(toMgrs(78.0, 40.0).substr(0, 3) == "37X");
+
+  // Invalid input
+  std::string err;
+  std::string mgrs = "unchanged";
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToMgrs(0.0, 0.0, mgrs, 6, &err) != 0);
+  rv += SDK_ASSERT(!err.empty());
+  rv += SDK_ASSERT(mgrs.empty());
+  err.clear();
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToMgrs(M_PI, 0.0, mgrs, 5, &err) != 0);
+  rv += SDK_ASSERT(!err.empty());
+  err.clear();
+  int zone;
+  simCore::Mgrs::Hemisphere hemisphere;
+  double easting;
+  double northing;
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToUtm(85.0 * simCore::DEG2RAD, 0.0, zone, hemisphere, easting, northing, &err) != 0);
+  rv += SDK_ASSERT(!err.empty());
+
+  // UTM and UPS round trips
+  double lat;
+  double lon;
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToUtm(-33.9 * simCore::DEG2RAD, 18.4 * simCore::DEG2RAD, zone, hemisphere, easting, northing) == 0);
+  rv += SDK_ASSERT(zone == 34 && hemisphere == simCore::Mgrs::UPS_SOUTH);
+  rv += SDK_ASSERT(simCore::Mgrs::convertUtmToGeodetic(zone, hemisphere, easting, northing, lat, lon) == 0);
+  rv += SDK_ASSERT(simCore::areAnglesEqual(lat, -33.9 * simCore::DEG2RAD, 1e-8));
+  rv += SDK_ASSERT(simCore::areAnglesEqual(lon, 18.4 * simCore::DEG2RAD, 1e-8));
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToUps(-84.8684706 * simCore::DEG2RAD, 74.7448813 * simCore::DEG2RAD, hemisphere, easting, northing) == 0);
+  rv += SDK_ASSERT(hemisphere == simCore::Mgrs::UPS_SOUTH);
+  rv += SDK_ASSERT(simCore::areEqual(easting, 2550000.0, 0.1));
+  rv += SDK_ASSERT(simCore::areEqual(northing, 2150000.0, 0.1));
+
+  // Round trips through MGRS stay within the 1 meter truncation everywhere.  Longitudes start
+  // east of the antimeridian, where truncating the easting would fall outside [-180,180].
+  size_t failures = 0;
+  for (double latDeg = -89.9; latDeg < 90.0; latDeg += 0.7)
+  {
+    for (double lonDeg = -179.9; lonDeg < 180.0; lonDeg += 1.3)
+    {
+      const double latRad = latDeg * simCore::DEG2RAD;
+      const double lonRad = lonDeg * simCore::DEG2RAD;
+      if (simCore::Mgrs::convertGeodeticToMgrs(latRad, lonRad, mgrs) != 0 ||
+        simCore::Mgrs::convertMgrsToGeodetic(mgrs, lat, lon) != 0)
+      {
+        ++failures;
+        continue;
+      }
+      const double north = (lat - latRad) * simCore::WGS_A;
+      const double east = simCore::angFixPI(lon - lonRad) * simCore::WGS_A * cos(latRad);
+      if (sqrt(north * north + east * east) > 2.0)
+        ++failures;
+    }
+  }
+  rv += SDK_ASSERT(failures == 0);
+  return rv;
+}
+
+int batch()
+{
+  int rv = 0;
+  std::vector<double> lats;
+  std::vector<double> lons;
+  for (int k = 0; k < 2000; ++k)
+  {
+    lats.push_back((-89.0 + fmod(k * 0.37, 178.0)) * simCore::DEG2RAD);
+    lons.push_back((-180.0 + fmod(k * 0.21, 360.0)) * simCore::DEG2RAD);
+  }
+  // Invalid latitude
+  lats.push_back(2.0);
+  lons.push_back(0.0);
+
+  std::vector<char> buffer;
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToMgrs(lats, lons, 4, buffer) == 1);
+  rv += SDK_ASSERT(buffer.size() == lats.size() * simCore::Mgrs::MGRS_BUFFER_SIZE);
+  if (rv != 0)
+    return rv;
+
+  std::vector<std::string> strings;
+  for (size_t k = 0; k < lats.size(); ++k)
+  {
+    std::string mgrs;
+    const int singleRv = simCore::Mgrs::convertGeodeticToMgrs(lats[k], lons[k], mgrs, 4);
+    const char* record = &buffer[k * simCore::Mgrs::MGRS_BUFFER_SIZE];
+    rv += SDK_ASSERT(mgrs == record);
+    rv += SDK_ASSERT((singleRv == 0) == (record[0] != '\0'));
+    strings.push_back(record);
+  }
+
+  // Strings that need the general parser, and invalid ones
+  strings.push_back("\"31NAA6602100000\"");
+  strings.push_back("31naa 66021 00000");
+  strings.push_back("4QFJ123456789012");
+  strings.push_back("YZG9922199208");
+  strings.push_back("31NBA2");
+  strings.push_back("32XAA0000000000");
+  strings.push_back("31NAA66021000001");
+
+  std::vector<double> lat;
+  std::vector<double> lon;
+  // The invalid latitude, "31NBA2", "32XAA..." and the odd digits string fail
+  rv += SDK_ASSERT(simCore::Mgrs::convertMgrsToGeodetic(strings, lat, lon) == 4);
+  rv += SDK_ASSERT(lat.size() == strings.size() && lon.size() == strings.size());
+  for (size_t k = 0; k < strings.size(); ++k)
+  {
+    double singleLat = 0.0;
+    double singleLon = 0.0;
+    if (simCore::Mgrs::convertMgrsToGeodetic(strings[k], singleLat, singleLon) != 0)
+    {
+      rv += SDK_ASSERT(lat[k] == 0.0 && lon[k] == 0.0);
+      continue;
+    }
+    rv += SDK_ASSERT(lat[k] == singleLat);
+    rv += SDK_ASSERT(lon[k] == singleLon);
+  }
+
+  // Mismatched input sizes
+  lons.pop_back();
+  rv += SDK_ASSERT(simCore::Mgrs::convertGeodeticToMgrs(lats, lons, 5, buffer) == lats.size());
+  rv += SDK_ASSERT(buffer.empty());
+  return rv;
+}
+
 }
 
 int MgrsTest(int argc, char* argv[])
@@ -372,5 +532,7 @@ int MgrsTest(int argc, char* argv[])
   rv += SDK_ASSERT(mgrsToLla() == 0);
   rv += SDK_ASSERT(upsToLla() == 0);
   rv += SDK_ASSERT(divide() == 0);
+  rv += SDK_ASSERT(llaToMgrs() == 0);
+  rv += SDK_ASSERT(batch() == 0);
   return rv;
 }
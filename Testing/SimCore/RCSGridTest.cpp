@@ -0,0 +1,268 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/EM/RadarCrossSection.h"
+#include "simCore/Time/Utils.h"
+
+namespace
+{
+
+/** Appends one table to an RCS LUT stream; azimuths in degrees, values in dBsm */
+void writeTable(std::ostream& os, float freq, float elevDeg, int pol, const std::vector<double>& azDeg, double elevFactor)
+{
+  os << freq << "\n" << elevDeg << "\n" << pol << "\n" << azDeg.size() << "\n0 1\n";
+  for (size_t i = 0; i < azDeg.size(); ++i)
+  {
+    const double az = azDeg[i] * simCore::DEG2RAD;
+    os << azDeg[i] << " " << (10.0 * cos(2.0 * az) + 5.0 * sin(az) * elevFactor - 0.05 * elevDeg) << "\n";
+  }
+}
+
+/**
+ * Builds an RCS LUT with two polarities, two frequencies and an elevation table every 10 degrees.
+ * Horizontal tables are sampled every degree; vertical tables are irregularly sampled.
+ */
+std::string makeLut(int tableType, int funcType)
+{
+  std::vector<double> regular;
+  for (int az = 0; az < 360; ++az)
+    regular.push_back(az);
+  std::vector<double> irregular;
+  for (double az = 0.; az < 360.; az += 0.5 + fmod(az, 7.0))
+    irregular.push_back(az);
+
+  std::stringstream tables;
+  int numTables = 0;
+  for (int elev = -90; elev <= 90; elev += 10)
+  {
+    writeTable(tables, 3000.f, static_cast<float>(elev), simCore::POLARITY_HORIZONTAL, regular, 1.0);
+    writeTable(tables, 9000.f, static_cast<float>(elev), simCore::POLARITY_HORIZONTAL, regular, -1.0);
+    writeTable(tables, 3000.f, static_cast<float>(elev), simCore::POLARITY_VERTICAL, irregular, 0.5);
+    numTables += 3;
+  }
+
+  std::stringstream lut;
+  lut << "0\nRCSGridTest synthetic pattern\n" << tableType << "\n" << funcType << "\n1.5\n" << numTables << "\n" << tables.str();
+  return lut.str();
+}
+
+/** Builds the 1 degree az/el grid used by the 3D RCS display */
+void makeGrid(std::vector<double>& azimuths, std::vector<double>& elevations)
+{
+  azimuths.clear();
+  elevations.clear();
+  for (int az = -180; az <= 180; ++az)
+    azimuths.push_back(az * simCore::DEG2RAD);
+  for (int el = -90; el <= 90; ++el)
+    elevations.push_back(el * simCore::DEG2RAD);
+  // values between and outside table keys
+  azimuths.push_back(0.3 * simCore::DEG2RAD);
+  azimuths.push_back(400.25 * simCore::DEG2RAD);
+  elevations.push_back(-4.75 * simCore::DEG2RAD);
+  elevations.push_back(95.0 * simCore::DEG2RAD);
+}
+
+/** Compares grid evaluation against point by point evaluation */
+int testEquivalence(int tableType, int funcType, float freq, simCore::PolarityType pol)
+{
+  int rv = 0;
+  simCore::RCSLUT lut;
+  std::istringstream is(makeLut(tableType, funcType));
+  rv += SDK_ASSERT(lut.loadRCSFile(is) == 0);
+
+  std::vector<double> azimuths;
+  std::vector<double> elevations;
+  makeGrid(azimuths, elevations);
+
+  std::vector<float> grid;
+  lut.RCSdBGrid(freq, azimuths, elevations, pol, grid);
+  rv += SDK_ASSERT(grid.size() == azimuths.size() * elevations.size());
+
+  simCore::CompiledRCSLUT compiled;
+  rv += SDK_ASSERT(compiled.compile(lut, freq, pol) == 0);
+
+  size_t mismatches = 0;
+  for (size_t e = 0; e < elevations.size(); ++e)
+  {
+    for (size_t a = 0; a < azimuths.size(); ++a)
+    {
+      const float expected = lut.RCSdB(freq, azimuths[a], elevations[e], pol);
+      if (!simCore::areEqual(grid[e * azimuths.size() + a], expected, 1.0e-4) ||
+        !simCore::areEqual(compiled.RCSdB(azimuths[a], elevations[e]), expected, 1.0e-4) ||
+        !simCore::areEqual(compiled.RCSsm(azimuths[a], elevations[e]), lut.RCSsm(freq, azimuths[a], elevations[e], pol), 1.0e-6))
+      {
+        if (mismatches == 0)
+          std::cerr << "Mismatch at az " << azimuths[a] << " el " << elevations[e] << ": " << grid[e * azimuths.size() + a] << " != " << expected << std::endl;
+        ++mismatches;
+      }
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+  return rv;
+}
+
+int testSelection()
+{
+  int rv = 0;
+  simCore::RCSLUT lut;
+  std::istringstream is(makeLut(simCore::RCS_LUT_TYPE, simCore::RCS_MEAN_FUNC));
+  rv += SDK_ASSERT(lut.loadRCSFile(is) == 0);
+
+  std::vector<double> azimuths(1, 0.5);
+  std::vector<double> elevations(1, 0.1);
+  std::vector<float> grid;
+
+  // missing polarity returns the small RCS value
+  lut.RCSdBGrid(3000.f, azimuths, elevations, simCore::POLARITY_CIRCULAR, grid);
+  rv += SDK_ASSERT(grid.size() == 1);
+  rv += SDK_ASSERT(grid[0] == lut.RCSdB(3000.f, 0.5, 0.1, simCore::POLARITY_CIRCULAR));
+  rv += SDK_ASSERT(grid[0] < -200.f);
+
+  // nearest frequency is used
+  simCore::CompiledRCSLUT compiled;
+  rv += SDK_ASSERT(compiled.compile(lut, 7000.f, simCore::POLARITY_HORIZONTAL) == 0);
+  rv += SDK_ASSERT(compiled.numTables() == 19);
+  rv += SDK_ASSERT(compiled.RCSdB(0.5, 0.1) == lut.RCSdB(9000.f, 0.5, 0.1, simCore::POLARITY_HORIZONTAL));
+
+  // random distributions cannot be compiled, but the grid still evaluates
+  simCore::RCSLUT gaussian;
+  std::istringstream gis(makeLut(simCore::RCS_DISTRIBUTION_FUNC_TYPE, simCore::RCS_GAUSSIAN_FUNC));
+  rv += SDK_ASSERT(gaussian.loadRCSFile(gis) == 0);
+  rv += SDK_ASSERT(compiled.compile(gaussian, 3000.f, simCore::POLARITY_HORIZONTAL) != 0);
+  gaussian.RCSdBGrid(3000.f, azimuths, elevations, simCore::POLARITY_HORIZONTAL, grid);
+  rv += SDK_ASSERT(grid.size() == 1);
+
+  // empty inputs
+  lut.RCSdBGrid(3000.f, std::vector<double>(), elevations, simCore::POLARITY_HORIZONTAL, grid);
+  rv += SDK_ASSERT(grid.empty());
+  return rv;
+}
+
+/** Changes the modulation between grid evaluations; the compiled mean bias must follow */
+int testModulation()
+{
+  int rv = 0;
+  simCore::RCSLUT lut;
+  std::istringstream is(makeLut(simCore::RCS_DISTRIBUTION_FUNC_TYPE, simCore::RCS_MEAN_FUNC));
+  rv += SDK_ASSERT(lut.loadRCSFile(is) == 0);
+
+  std::vector<double> azimuths;
+  std::vector<double> elevations;
+  makeGrid(azimuths, elevations);
+
+  std::vector<float> before;
+  lut.RCSdBGrid(3000.f, azimuths, elevations, simCore::POLARITY_HORIZONTAL, before);
+  lut.modulation(lut.modulation() + 10.f);
+  std::vector<float> after;
+  lut.RCSdBGrid(3000.f, azimuths, elevations, simCore::POLARITY_HORIZONTAL, after);
+  rv += SDK_ASSERT(after.size() == before.size());
+
+  size_t mismatches = 0;
+  size_t unchanged = 0;
+  for (size_t e = 0; e < elevations.size(); ++e)
+  {
+    for (size_t a = 0; a < azimuths.size(); ++a)
+    {
+      const size_t k = e * azimuths.size() + a;
+      if (!simCore::areEqual(after[k], lut.RCSdB(3000.f, azimuths[a], elevations[e], simCore::POLARITY_HORIZONTAL), 1.0e-4))
+        ++mismatches;
+      if (after[k] == before[k])
+        ++unchanged;
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+  rv += SDK_ASSERT(unchanged == 0);
+
+  // a frequency within the lookup tolerance reuses the compiled tables and gives the same values
+  std::vector<float> nearby;
+  lut.RCSdBGrid(3000.05f, azimuths, elevations, simCore::POLARITY_HORIZONTAL, nearby);
+  rv += SDK_ASSERT(nearby == after);
+  return rv;
+}
+
+/** Times the map based lookup against the grid evaluation over the 3D RCS grid */
+int testBenchmark()
+{
+  int rv = 0;
+  simCore::RCSLUT lut;
+  std::istringstream is(makeLut(simCore::RCS_LUT_TYPE, simCore::RCS_MEAN_FUNC));
+  rv += SDK_ASSERT(lut.loadRCSFile(is) == 0);
+
+  std::vector<double> azimuths;
+  std::vector<double> elevations;
+  makeGrid(azimuths, elevations);
+  const int iterations = 10;
+
+  double checksum1 = 0.0;
+  double start = simCore::getSystemTime();
+  for (int i = 0; i < iterations; ++i)
+  {
+    for (size_t e = 0; e < elevations.size(); ++e)
+    {
+      for (size_t a = 0; a < azimuths.size(); ++a)
+        checksum1 += lut.RCSdB(3000.f, azimuths[a], elevations[e], simCore::POLARITY_HORIZONTAL);
+    }
+  }
+  const double mapTime = simCore::getSystemTime() - start;
+
+  double checksum2 = 0.0;
+  std::vector<float> grid;
+  start = simCore::getSystemTime();
+  for (int i = 0; i < iterations; ++i)
+  {
+    lut.RCSdBGrid(3000.f, azimuths, elevations, simCore::POLARITY_HORIZONTAL, grid);
+    for (size_t k = 0; k < grid.size(); ++k)
+      checksum2 += grid[k];
+  }
+  const double gridTime = simCore::getSystemTime() - start;
+
+  rv += SDK_ASSERT(simCore::areEqual(checksum1, checksum2, 1.0e-3 * fabs(checksum1)));
+  std::cout << "  RCS " << azimuths.size() << "x" << elevations.size() << " grid, " << iterations << " iterations: map lookup "
+    << mapTime << " s, compiled grid " << gridTime << " s" << std::endl;
+  return rv;
+}
+
+}
+
+int RCSGridTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  rv += testEquivalence(simCore::RCS_LUT_TYPE, simCore::RCS_MEAN_FUNC, 3000.f, simCore::POLARITY_HORIZONTAL);
+  rv += testEquivalence(simCore::RCS_LUT_TYPE, simCore::RCS_MEAN_FUNC, 6500.f, simCore::POLARITY_HORIZONTAL);
+  rv += testEquivalence(simCore::RCS_LUT_TYPE, simCore::RCS_MEAN_FUNC, 3000.f, simCore::POLARITY_VERTICAL);
+  rv += testEquivalence(simCore::RCS_LUT_TYPE, simCore::RCS_MEAN_FUNC, 3000.f, simCore::POLARITY_UNKNOWN);
+  rv += testEquivalence(simCore::RCS_SYM_LUT_TYPE, simCore::RCS_MEAN_FUNC, 9000.f, simCore::POLARITY_HORIZONTAL);
+  rv += testEquivalence(simCore::RCS_SYM_LUT_TYPE, simCore::RCS_MEAN_FUNC, 3000.f, simCore::POLARITY_VERTICAL);
+  rv += testEquivalence(simCore::RCS_DISTRIBUTION_FUNC_TYPE, simCore::RCS_MEAN_FUNC, 3000.f, simCore::POLARITY_HORIZONTAL);
+  rv += testSelection();
+  rv += testModulation();
+  rv += testBenchmark();
+
+  std::cout << "RCSGridTest " << ((rv == 0) ? "Passed" : "Failed") << std::endl;
+  return rv;
+}
@@ -0,0 +1,273 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Time/Constants.h"
+#include "simCore/Time/String.h"
+#include "simCore/Time/TimeClass.h"
+#include "simCore/Time/Utils.h"
+
+namespace
+{
+
+const simCore::TimeFormat ALL_FORMATS[] = {
+  simCore::TIMEFORMAT_SECONDS,
+  simCore::TIMEFORMAT_MINUTES,
+  simCore::TIMEFORMAT_HOURS,
+  simCore::TIMEFORMAT_ORDINAL,
+  simCore::TIMEFORMAT_MONTHDAY,
+  simCore::TIMEFORMAT_DTG
+};
+const size_t NUM_FORMATS = sizeof(ALL_FORMATS) / sizeof(ALL_FORMATS[0]);
+
+/** Builds time stamps across leap and non-leap years, including values that round up to the next minute or day */
+void makeTimeStamps(std::vector<simCore::TimeStamp>& stamps, size_t count)
+{
+  stamps.clear();
+  const int years[] = { 1970, 1999, 2000, 2004, 2015, 2016, 2069 };
+  for (size_t k = 0; k < count; ++k)
+  {
+    const int year = years[k % (sizeof(years) / sizeof(years[0]))];
+    // Spread over the year with an irregular fraction
+    const double seconds = fmod(k * 7919.123456789, 366 * 86400.0);
+    stamps.push_back(simCore::TimeStamp(year, seconds));
+  }
+  stamps.push_back(simCore::TimeStamp(2016, 59.9999996));
+  stamps.push_back(simCore::TimeStamp(2016, 86399.9999996));
+  stamps.push_back(simCore::TimeStamp(2015, 365 * 86400 - 0.0000001));
+  stamps.push_back(simCore::TimeStamp(2004, 59 * 86400 + 3600.5));
+}
+
+/** Compares buffer formatting against the std::string and ostream formatting */
+int testFormatEquivalence()
+{
+  int rv = 0;
+  simCore::TimeFormatterRegistry registry;
+  std::vector<simCore::TimeStamp> stamps;
+  makeTimeStamps(stamps, 500);
+
+  size_t mismatches = 0;
+  char buffer[64];
+  for (size_t k = 0; k < stamps.size(); ++k)
+  {
+    const simCore::TimeStamp& stamp = stamps[k];
+    // Reference years before, at, and after the time stamp exercise negative relative values
+    const int refYears[] = { 1970, stamp.referenceYear(), stamp.referenceYear() + 1 };
+    for (size_t r = 0; r < 3; ++r)
+    {
+      for (unsigned short precision = 0; precision <= 9; ++precision)
+      {
+        // Built-in formats with a stream-based equivalent
+        std::stringstream secs;
+        simCore::SecondsTimeFormatter::toStream(secs, stamp.secondsSinceRefYear(refYears[r]), precision);
+        std::stringstream mins;
+        simCore::MinutesTimeFormatter::toStream(mins, stamp.secondsSinceRefYear(refYears[r]), precision);
+        std::stringstream hrs;
+        simCore::HoursTimeFormatter::toStream(hrs, stamp.secondsSinceRefYear(refYears[r]), precision);
+        std::stringstream ord;
+        simCore::OrdinalTimeFormatter::toStream(ord, stamp, precision);
+        const std::string expected[] = { secs.str(), mins.str(), hrs.str(), ord.str() };
+
+        for (size_t f = 0; f < NUM_FORMATS; ++f)
+        {
+          const std::string str = registry.toString(ALL_FORMATS[f], stamp, refYears[r], precision);
+          const size_t len = registry.toString(ALL_FORMATS[f], stamp, refYears[r], precision, buffer, sizeof(buffer));
+          const bool streamMatch = (f >= 4 || str == expected[f]);
+          if (len != str.size() || str != buffer || !streamMatch)
+          {
+            if (mismatches == 0)
+              std::cerr << "Format mismatch: \"" << str << "\" != \"" << buffer << "\"" << std::endl;
+            ++mismatches;
+          }
+        }
+      }
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+
+  // Truncation reports the full length and keeps the buffer null terminated
+  const simCore::TimeStamp stamp(2007, 95 * 86400 + 14 * 3600 + 35 * 60 + 3.01);
+  const std::string dtg = registry.toString(simCore::TIMEFORMAT_DTG, stamp, 2007, 3);
+  rv += SDK_ASSERT(dtg == "061435:03.010 Z Apr07");
+  memset(buffer, 'x', sizeof(buffer));
+  rv += SDK_ASSERT(registry.toString(simCore::TIMEFORMAT_DTG, stamp, 2007, 3, buffer, 7) == dtg.size());
+  rv += SDK_ASSERT(std::string(buffer) == "061435");
+  rv += SDK_ASSERT(registry.toString(simCore::TIMEFORMAT_DTG, stamp, 2007, 3, buffer, 0) == dtg.size());
+  rv += SDK_ASSERT(buffer[0] == '0');
+  rv += SDK_ASSERT(registry.toString(simCore::TIMEFORMAT_DTG, stamp, 2007, 3, buffer, dtg.size() + 1) == dtg.size());
+  rv += SDK_ASSERT(dtg == buffer);
+
+  // Large precision does not overrun internal buffers
+  std::vector<char> large(512);
+  const size_t len = registry.toString(simCore::TIMEFORMAT_SECONDS, stamp, 2007, 300, &large[0], large.size());
+  rv += SDK_ASSERT(len == registry.toString(simCore::TIMEFORMAT_SECONDS, stamp, 2007, 300).size());
+  rv += SDK_ASSERT(len < large.size() && strlen(&large[0]) == len);
+  return rv;
+}
+
+/** Returns true if the fast and tokenizing parsers agree on the string */
+bool parsersAgree(const simCore::TimeFormatterRegistry& registry, const std::string& timeString, int referenceYear)
+{
+  simCore::TimeStamp fast;
+  simCore::TimeStamp slow;
+  const int fastRv = registry.fromString(timeString, fast, referenceYear);
+  const int slowRv = registry.formatter(timeString).fromString(timeString, slow, referenceYear);
+  if (fastRv == slowRv && (fastRv != 0 || fast == slow))
+    return true;
+  std::cerr << "Parse mismatch for \"" << timeString << "\": " << fastRv << " vs " << slowRv << std::endl;
+  return false;
+}
+
+/** Custom formatter that claims every string */
+class AlwaysFormatter : public simCore::SecondsTimeFormatter
+{
+public:
+  virtual bool canConvert(const std::string& timeString) const { return true; }
+  virtual int fromString(const std::string& timeString, simCore::TimeStamp& timeStamp, int referenceYear) const
+  {
+    timeStamp = simCore::TimeStamp(referenceYear, 1.0);
+    return 0;
+  }
+};
+
+/** Compares the single-pass parser against the tokenizing formatters */
+int testParseEquivalence()
+{
+  int rv = 0;
+  simCore::TimeFormatterRegistry registry;
+  std::vector<simCore::TimeStamp> stamps;
+  makeTimeStamps(stamps, 500);
+
+  size_t mismatches = 0;
+  for (size_t k = 0; k < stamps.size(); ++k)
+  {
+    const int refYear = stamps[k].referenceYear();
+    for (size_t f = 0; f < NUM_FORMATS; ++f)
+    {
+      for (unsigned short precision = 0; precision <= 9; precision += 3)
+      {
+        if (!parsersAgree(registry, registry.toString(ALL_FORMATS[f], stamps[k], refYear, precision), refYear))
+          ++mismatches;
+      }
+    }
+  }
+  rv += SDK_ASSERT(mismatches == 0);
+
+  // Non-canonical and invalid strings, which either match exactly or fall back to the tokenizing parsers
+  const char* variants[] = {
+    "", " ", "12", "  12.5  ", "12.", ".5", "+12", "-12", "1e3", "0x10", "12.5.3", "\"12.5\"", "12\t",
+    "1:2", "1:02.5", "-1:02", "1:60", "1:59.9999999999999999", "1:02:03", "25:00:00.5", "1:60:00", "1:02:3.25", "1:2:3:4",
+    "001 2016 00:00:00", "1 2016 1:2:3.5", "366 2016 23:59:59.9", "366 2015 12:00:00", "000 2016 12:00:00",
+    "001 1900 12:00:00", "001  2016   12:00:00", "1 2016 24:00:00", "1 +2016 12:00:00",
+    "Jan 1 2016 00:00:00", "jan 01 2016 1:2:3", "FEB 29 2016 12:00:00", "Feb 29 2015 12:00:00", "Feb 30 2016 12:00:00",
+    "Dec 31 1899 12:00:00", "Foo 1 2016 12:00:00", "Jan 0 2016 12:00:00", "Jan 1 2016 12:00",
+    "061435:03.010 Z Apr07", "061435:03 Z Apr07", "061435:3 Z Apr07", "291200:00 Z Feb15", "291200:00 Z Feb16",
+    "062435:03 Z Apr07", "061460:03 Z Apr07", "061435:03 Z Apr7", "061435:03 z Apr07", "061435:03 Z apr69",
+    "320000:00 Z Jan70", "6143:03 Z Apr07",
+    "001 12:00:00", "001 12:00:00 2016", "Jan 1 12:00:00 2016", "1 Jan 2016 12:00:00", "Fri Jan 1 12:00:00 2016"
+  };
+  for (size_t k = 0; k < sizeof(variants) / sizeof(variants[0]); ++k)
+    rv += SDK_ASSERT(parsersAgree(registry, variants[k], 2016));
+
+  // Custom formatters take priority over the built-in formats
+  simCore::TimeStamp stamp;
+  rv += SDK_ASSERT(registry.fromString("12.5", stamp, 2016) == 0 && stamp == simCore::TimeStamp(2016, 12.5));
+  registry.registerCustomFormatter(simCore::TimeFormatterRegistry::TimeFormatterPtr(new AlwaysFormatter));
+  rv += SDK_ASSERT(registry.fromString("12.5", stamp, 2016) == 0 && stamp == simCore::TimeStamp(2016, 1.0));
+  return rv;
+}
+
+/** Times the string and buffer formatting, and the tokenizing and single-pass parsing, of every built-in format */
+int testBenchmark()
+{
+  int rv = 0;
+  simCore::TimeFormatterRegistry registry;
+  std::vector<simCore::TimeStamp> stamps;
+  makeTimeStamps(stamps, 20000);
+
+  std::cout << "  " << stamps.size() << " time stamps per format:" << std::endl;
+  for (size_t f = 0; f < NUM_FORMATS; ++f)
+  {
+    const simCore::TimeFormat format = ALL_FORMATS[f];
+    std::vector<std::string> strings(stamps.size());
+
+    size_t length1 = 0;
+    double start = simCore::getSystemTime();
+    for (size_t k = 0; k < stamps.size(); ++k)
+    {
+      strings[k] = registry.toString(format, stamps[k], stamps[k].referenceYear(), 3);
+      length1 += strings[k].size();
+    }
+    const double stringTime = simCore::getSystemTime() - start;
+
+    size_t length2 = 0;
+    char buffer[64];
+    start = simCore::getSystemTime();
+    for (size_t k = 0; k < stamps.size(); ++k)
+      length2 += registry.toString(format, stamps[k], stamps[k].referenceYear(), 3, buffer, sizeof(buffer));
+    const double bufferTime = simCore::getSystemTime() - start;
+    rv += SDK_ASSERT(length1 == length2);
+
+    size_t failures1 = 0;
+    simCore::TimeStamp stamp;
+    start = simCore::getSystemTime();
+    for (size_t k = 0; k < strings.size(); ++k)
+    {
+      if (registry.formatter(strings[k]).fromString(strings[k], stamp, stamps[k].referenceYear()) != 0)
+        ++failures1;
+    }
+    const double tokenizeTime = simCore::getSystemTime() - start;
+
+    size_t failures2 = 0;
+    start = simCore::getSystemTime();
+    for (size_t k = 0; k < strings.size(); ++k)
+    {
+      if (registry.fromString(strings[k], stamp, stamps[k].referenceYear()) != 0)
+        ++failures2;
+    }
+    const double fastTime = simCore::getSystemTime() - start;
+    rv += SDK_ASSERT(failures1 == 0 && failures2 == 0);
+
+    std::cout << "    format " << format << ": toString " << stringTime << " s, buffer " << bufferTime
+      << " s; tokenizing parse " << tokenizeTime << " s, single-pass parse " << fastTime << " s" << std::endl;
+  }
+  return rv;
+}
+
+}
+
+int TimeStringBenchmarkTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  rv += testFormatEquivalence();
+  rv += testParseEquivalence();
+  rv += testBenchmark();
+
+  std::cout << "TimeStringBenchmarkTest " << ((rv == 0) ? "Passed" : "Failed") << std::endl;
+  return rv;
+}
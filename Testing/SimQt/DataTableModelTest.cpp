@@ -0,0 +1,391 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <QCoreApplication>
+#include <QString>
+#include <QVariant>
+#include "simCore/Common/SDKAssert.h"
+#include "simData/MemoryTable/DataLimitsProvider.h"
+#include "simData/MemoryTable/TableManager.h"
+#include "simQt/DataTableModel.h"
+
+namespace
+{
+
+const int NUM_ROWS = 200;
+
+/** Expected display strings, by time and then by model column */
+typedef std::map<double, std::map<int, QString> > ExpectedCells;
+
+QString displayString(const simQt::DataTableModel& model, int row, int column)
+{
+  return model.data(model.index(row, column, QModelIndex()), Qt::DisplayRole).toString();
+}
+
+/** Verifies every cell of the model against the expected values, visiting rows in the given order */
+int checkCells(const simQt::DataTableModel& model, const ExpectedCells& expected, int rowStep)
+{
+  int rv = 0;
+  const int numRows = model.rowCount();
+  rv += SDK_ASSERT(numRows == static_cast<int>(expected.size()));
+  if (rv != 0)
+    return rv;
+  int row = 0;
+  std::set<double> times;
+  for (int k = 0; k < numRows; ++k)
+  {
+    row = (row + rowStep) % numRows;
+    const double time = model.getTime(model.index(row, 0, QModelIndex()));
+    // each row of the table appears once
+    rv += SDK_ASSERT(times.insert(time).second);
+    ExpectedCells::const_iterator cells = expected.find(time);
+    rv += SDK_ASSERT(cells != expected.end());
+    if (cells == expected.end())
+      continue;
+    for (int column = 1; column < model.columnCount(); ++column)
+    {
+      std::map<int, QString>::const_iterator cell = cells->second.find(column);
+      const bool present = (cell != cells->second.end());
+      rv += SDK_ASSERT(displayString(model, row, column) == (present ? cell->second : QString("NULL")));
+      if (!present)
+        rv += SDK_ASSERT(model.data(model.index(row, column, QModelIndex()), Qt::TextAlignmentRole) == QVariant(Qt::AlignLeft));
+    }
+  }
+  return rv;
+}
+
+/** Verifies that rows are ordered by a column's sort values, with empty cells first when ascending */
+int checkSorted(const simQt::DataTableModel& model, int column, Qt::SortOrder order, bool isString)
+{
+  int rv = 0;
+  for (int row = 1; row < model.rowCount(); ++row)
+  {
+    const QModelIndex prevIndex = model.index(row - 1, column, QModelIndex());
+    const QModelIndex index = model.index(row, column, QModelIndex());
+    const bool prevMissing = (displayString(model, row - 1, column) == "NULL");
+    const bool missing = (displayString(model, row, column) == "NULL");
+    if (prevMissing || missing)
+    {
+      rv += SDK_ASSERT(order == Qt::AscendingOrder ? prevMissing : missing);
+      continue;
+    }
+    const QVariant prev = model.data(prevIndex, simQt::DataTableModel::SortRole);
+    const QVariant value = model.data(index, simQt::DataTableModel::SortRole);
+    bool inOrder;
+    if (isString)
+      inOrder = (order == Qt::AscendingOrder) ? (prev.toString() <= value.toString()) : (prev.toString() >= value.toString());
+    else
+      inOrder = (order == Qt::AscendingOrder) ? (prev.toDouble() <= value.toDouble()) : (prev.toDouble() >= value.toDouble());
+    rv += SDK_ASSERT(inOrder);
+  }
+  return rv;
+}
+
+/** Limits tables to a number of points */
+class PointsLimits : public simData::MemoryTable::DataLimitsProvider
+{
+public:
+  explicit PointsLimits(size_t points)
+    : points_(points)
+  {
+  }
+
+  virtual simData::TableStatus getLimits(const simData::DataTable& table, size_t& pointsLimit, double& secondsLimit) const
+  {
+    pointsLimit = points_;
+    secondsLimit = 0.0;
+    return simData::TableStatus::Success();
+  }
+
+private:
+  size_t points_;
+};
+
+/** Collects the display strings of an integer and a double column in each row of a table */
+class TableCells : public simData::DataTable::RowVisitor
+{
+public:
+  TableCells(simData::TableColumnId intColumn, simData::TableColumnId doubleColumn)
+    : intColumn_(intColumn),
+      doubleColumn_(doubleColumn)
+  {
+  }
+
+  virtual VisitReturn visit(const simData::TableRow& row)
+  {
+    int32_t intValue = 0;
+    if (row.value(intColumn_, intValue).isSuccess())
+      cells_[row.time()][1] = QString::number(intValue);
+    double doubleValue = 0.0;
+    if (row.value(doubleColumn_, doubleValue).isSuccess())
+      cells_[row.time()][2] = QString::number(doubleValue, 'f', 3);
+    return VISIT_CONTINUE;
+  }
+
+  ExpectedCells cells_; ///< display strings of the rows visited
+
+private:
+  simData::TableColumnId intColumn_;
+  simData::TableColumnId doubleColumn_;
+};
+
+/** Returns the display strings of the integer and double columns of a table */
+ExpectedCells tableCells(const simData::DataTable& table, const simData::TableColumn& intColumn, const simData::TableColumn& doubleColumn)
+{
+  TableCells cells(intColumn.columnId(), doubleColumn.columnId());
+  table.accept(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), cells);
+  return cells.cells_;
+}
+
+/** Adds a row with a scrambled integer, and optionally a double, to the table */
+int addRow(simData::DataTable& table, const simData::TableColumn& intColumn, const simData::TableColumn& doubleColumn, int time, bool addDouble)
+{
+  simData::TableRow row;
+  row.setTime(time);
+  row.setValue(intColumn.columnId(), (time * 37) % 101);
+  if (addDouble)
+    row.setValue(doubleColumn.columnId(), 0.5 * time);
+  return table.addRow(row).isSuccess() ? 0 : 1;
+}
+
+/** Returns the time of each model row, in model order */
+std::vector<double> modelTimes(const simQt::DataTableModel& model)
+{
+  std::vector<double> times;
+  for (int row = 0; row < model.rowCount(); ++row)
+    times.push_back(model.getTime(model.index(row, 0, QModelIndex())));
+  return times;
+}
+
+int testModel()
+{
+  int rv = 0;
+  simData::MemoryTable::TableManager mgr(NULL);
+  simData::DataTable* table = NULL;
+  rv += SDK_ASSERT(mgr.addDataTable(0, "Table", &table).isSuccess());
+  simData::TableColumn* intColumn = NULL;
+  simData::TableColumn* doubleColumn = NULL;
+  simData::TableColumn* stringColumn = NULL;
+  rv += SDK_ASSERT(table->addColumn("Int", simData::VT_INT32, 0, &intColumn).isSuccess());
+  rv += SDK_ASSERT(table->addColumn("Double", simData::VT_DOUBLE, 0, &doubleColumn).isSuccess());
+  rv += SDK_ASSERT(table->addColumn("String", simData::VT_STRING, 0, &stringColumn).isSuccess());
+  if (rv != 0)
+    return rv;
+
+  // Integers in every row, doubles in even rows and strings in every third row
+  ExpectedCells expected;
+  for (int k = 0; k < NUM_ROWS; ++k)
+  {
+    simData::TableRow row;
+    row.setTime(k);
+    const int32_t intValue = (k * 37) % NUM_ROWS;
+    row.setValue(intColumn->columnId(), intValue);
+    expected[k][1] = QString::number(intValue);
+    if (k % 2 == 0)
+    {
+      row.setValue(doubleColumn->columnId(), 0.5 * (NUM_ROWS - k));
+      expected[k][2] = QString::number(0.5 * (NUM_ROWS - k), 'f', 3);
+    }
+    if (k % 3 == 0)
+    {
+      const std::string stringValue(1 + k % 5, 'a' + k % 7);
+      row.setValue(stringColumn->columnId(), stringValue);
+      expected[k][3] = QString::fromStdString(stringValue);
+    }
+    rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  }
+
+  simQt::DataTableModel model(NULL, table);
+  rv += SDK_ASSERT(model.columnCount() == 4);
+  // Sequential access steps the column cursors; scattered access searches the columns
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  rv += SDK_ASSERT(checkCells(model, expected, 73) == 0);
+  rv += SDK_ASSERT(model.data(model.index(0, 1, QModelIndex()), Qt::TextAlignmentRole) == QVariant(Qt::AlignRight));
+  rv += SDK_ASSERT(model.data(model.index(0, 3, QModelIndex()), Qt::TextAlignmentRole) == QVariant(Qt::AlignLeft));
+
+  // Rows added to the table appear in the model, in time order
+  simData::TableRow row;
+  row.setTime(NUM_ROWS);
+  row.setValue(intColumn->columnId(), 1000);
+  expected[NUM_ROWS][1] = "1000";
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  row.clear();
+  row.setTime(50.5);
+  row.setValue(doubleColumn->columnId(), 7.0);
+  expected[50.5][2] = "7.000";
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  // New cell in an existing row
+  row.clear();
+  row.setTime(1.0);
+  row.setValue(doubleColumn->columnId(), 3.25);
+  expected[1.0][2] = "3.250";
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  rv += SDK_ASSERT(model.rowCount() == NUM_ROWS + 2);
+  rv += SDK_ASSERT(model.getTime(model.index(51, 0, QModelIndex())) == 50.5);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  rv += SDK_ASSERT(checkCells(model, expected, 37) == 0);
+
+  // Columns added to the table appear in the model
+  simData::TableColumn* lateColumn = NULL;
+  rv += SDK_ASSERT(table->addColumn("Late", simData::VT_UINT64, 0, &lateColumn).isSuccess());
+  rv += SDK_ASSERT(model.columnCount() == 5);
+  row.clear();
+  row.setTime(10.0);
+  row.setValue(lateColumn->columnId(), static_cast<uint64_t>(5));
+  expected[10.0][4] = "5";
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+
+  // Sorting reorders rows without changing their contents
+  model.sort(1, Qt::AscendingOrder);
+  rv += SDK_ASSERT(checkSorted(model, 1, Qt::AscendingOrder, false) == 0);
+  rv += SDK_ASSERT(model.getTime(model.index(0, 0, QModelIndex())) == 50.5);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  model.sort(2, Qt::DescendingOrder);
+  rv += SDK_ASSERT(checkSorted(model, 2, Qt::DescendingOrder, false) == 0);
+  rv += SDK_ASSERT(displayString(model, 0, 2) == "100.000");
+  rv += SDK_ASSERT(checkCells(model, expected, 7) == 0);
+  model.sort(3, Qt::AscendingOrder);
+  rv += SDK_ASSERT(checkSorted(model, 3, Qt::AscendingOrder, true) == 0);
+  model.sort(4, Qt::DescendingOrder);
+  rv += SDK_ASSERT(model.getTime(model.index(0, 0, QModelIndex())) == 10.0);
+  model.sort(0, Qt::DescendingOrder);
+  rv += SDK_ASSERT(model.getTime(model.index(0, 0, QModelIndex())) == NUM_ROWS);
+
+  // Rows added while sorted go at the end
+  row.clear();
+  row.setTime(20.5);
+  row.setValue(intColumn->columnId(), 3);
+  expected[20.5][1] = "3";
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  rv += SDK_ASSERT(model.getTime(model.index(model.rowCount() - 1, 0, QModelIndex())) == 20.5);
+  const std::vector<double> times = modelTimes(model);
+  for (size_t k = 1; k + 1 < times.size(); ++k)
+    rv += SDK_ASSERT(times[k - 1] > times[k]);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  model.sort(0, Qt::AscendingOrder);
+  rv += SDK_ASSERT(model.getTime(model.index(21, 0, QModelIndex())) == 20.5);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+
+  // Model no longer follows the table once detached
+  model.setDataTable(NULL);
+  rv += SDK_ASSERT(model.rowCount() == 0);
+  row.clear();
+  row.setTime(NUM_ROWS + 1);
+  row.setValue(intColumn->columnId(), 1);
+  rv += SDK_ASSERT(table->addRow(row).isSuccess());
+  rv += SDK_ASSERT(model.rowCount() == 0);
+  return rv;
+}
+
+int testDataLimiting()
+{
+  int rv = 0;
+  // Columns filled in different rows are stored and limited separately
+  PointsLimits limits(50);
+  simData::MemoryTable::TableManager mgr(&limits);
+  simData::DataTable* table = NULL;
+  rv += SDK_ASSERT(mgr.addDataTable(0, "Table", &table).isSuccess());
+  simData::TableColumn* intColumn = NULL;
+  simData::TableColumn* doubleColumn = NULL;
+  rv += SDK_ASSERT(table->addColumn("Int", simData::VT_INT32, 0, &intColumn).isSuccess());
+  rv += SDK_ASSERT(table->addColumn("Double", simData::VT_DOUBLE, 0, &doubleColumn).isSuccess());
+  if (rv != 0)
+    return rv;
+
+  // Integers in every row and doubles in even rows
+  for (int k = 0; k < 100; ++k)
+    rv += addRow(*table, *intColumn, *doubleColumn, k, k % 2 == 0);
+  simQt::DataTableModel model(NULL, table);
+  rv += SDK_ASSERT(checkCells(model, tableCells(*table, *intColumn, *doubleColumn), 1) == 0);
+
+  // Rows that lose all their cells are removed once events are processed; rows that keep some are updated
+  const int numRows = model.rowCount();
+  for (int k = 100; k < 150; ++k)
+    rv += addRow(*table, *intColumn, *doubleColumn, k, k % 2 == 0);
+  QCoreApplication::processEvents();
+  ExpectedCells expected = tableCells(*table, *intColumn, *doubleColumn);
+  rv += SDK_ASSERT(model.rowCount() < numRows + 50);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  rv += SDK_ASSERT(checkCells(model, expected, 13) == 0);
+
+  // While sorted, the removed rows are scattered through the model
+  model.sort(1, Qt::AscendingOrder);
+  const std::vector<double> sortedTimes = modelTimes(model);
+  for (int k = 150; k < 200; ++k)
+    rv += addRow(*table, *intColumn, *doubleColumn, k, false);
+  QCoreApplication::processEvents();
+  expected = tableCells(*table, *intColumn, *doubleColumn);
+  rv += SDK_ASSERT(model.rowCount() < static_cast<int>(sortedTimes.size()) + 50);
+  // remaining rows keep their sorted order, followed by the rows added while sorted
+  std::vector<double> remainingTimes;
+  for (std::vector<double>::const_iterator i = sortedTimes.begin(); i != sortedTimes.end(); ++i)
+  {
+    if (expected.count(*i) != 0)
+      remainingTimes.push_back(*i);
+  }
+  for (int k = 150; k < 200; ++k)
+  {
+    if (expected.count(k) != 0)
+      remainingTimes.push_back(k);
+  }
+  rv += SDK_ASSERT(modelTimes(model) == remainingTimes);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  rv += SDK_ASSERT(checkCells(model, expected, 11) == 0);
+
+  // Rows added after the removal land in the right place
+  rv += addRow(*table, *intColumn, *doubleColumn, 1000, true);
+  QCoreApplication::processEvents();
+  expected = tableCells(*table, *intColumn, *doubleColumn);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  model.sort(0, Qt::AscendingOrder);
+  rv += SDK_ASSERT(model.getTime(model.index(0, 0, QModelIndex())) == expected.begin()->first);
+  rv += SDK_ASSERT(model.getTime(model.index(model.rowCount() - 1, 0, QModelIndex())) == 1000.0);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+
+  // A block of adjacent rows is removed at once
+  const int numBeforeBlock = model.rowCount();
+  for (int k = 1001; k < 1050; ++k)
+    rv += addRow(*table, *intColumn, *doubleColumn, k, false);
+  QCoreApplication::processEvents();
+  expected = tableCells(*table, *intColumn, *doubleColumn);
+  rv += SDK_ASSERT(model.rowCount() < numBeforeBlock + 49);
+  rv += SDK_ASSERT(checkCells(model, expected, 1) == 0);
+  rv += SDK_ASSERT(checkCells(model, expected, 7) == 0);
+  return rv;
+}
+
+}
+
+int DataTableModelTest(int argc, char* argv[])
+{
+  // Rows are removed in a queued call
+  QCoreApplication app(argc, argv);
+  int rv = 0;
+  rv += testModel();
+  rv += testDataLimiting();
+  return rv;
+}
@@ -0,0 +1,193 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <QApplication>
+#include <QColor>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Time/Utils.h"
+#include "simData/MemoryDataStore.h"
+#include "simVis/Headless.h"
+#include "simQt/EntityProxyModel.h"
+#include "simQt/EntityTreeModel.h"
+#include "EntityTreeModelTest.h"
+
+namespace
+{
+
+uint64_t addPlatform(simData::DataStore& dataStore, const std::string& name, uint64_t originalId)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformProperties* props = dataStore.addPlatform(&t);
+  props->set_originalid(originalId);
+  const uint64_t id = props->id();
+  t.commit();
+  simData::PlatformPrefs* prefs = dataStore.mutable_platformPrefs(id, &t);
+  prefs->mutable_commonprefs()->set_name(name);
+  t.commit();
+  return id;
+}
+
+void setAlias(simData::DataStore& dataStore, uint64_t id, const std::string& alias, bool useAlias)
+{
+  simData::DataStore::Transaction t;
+  simData::CommonPrefs* prefs = dataStore.mutable_commonPrefs(id, &t);
+  prefs->set_alias(alias);
+  prefs->set_usealias(useAlias);
+  t.commit();
+}
+
+void setDraw(simData::DataStore& dataStore, uint64_t id, bool draw)
+{
+  simData::DataStore::Transaction t;
+  simData::CommonPrefs* prefs = dataStore.mutable_commonPrefs(id, &t);
+  prefs->set_draw(draw);
+  t.commit();
+}
+
+std::string platformName(int index)
+{
+  std::ostringstream os;
+  os << "platform";
+  os.width(6);
+  os.fill('0');
+  os << index;
+  return os.str();
+}
+
+int testCachedValues()
+{
+  int rv = 0;
+  simData::MemoryDataStore dataStore;
+  const uint64_t plat1 = addPlatform(dataStore, "plat1", 101);
+  const uint64_t plat2 = addPlatform(dataStore, "plat2", 102);
+
+  simQt::EntityTreeModel model(NULL, &dataStore);
+  model.setUseEntityIcons(false);
+  DataChangedCounter counter(model);
+  const QModelIndex index1 = model.index(plat1);
+  rv += SDK_ASSERT(model.data(index1, Qt::DisplayRole).toString() == "plat1");
+  rv += SDK_ASSERT(model.data(index1.sibling(index1.row(), 1), Qt::DisplayRole).toString() == "P");
+  rv += SDK_ASSERT(model.data(index1.sibling(index1.row(), 2), Qt::DisplayRole).toString() == "101");
+  rv += SDK_ASSERT(model.data(index1.sibling(index1.row(), 2), simQt::SORT_BY_ENTITY_ROLE).toULongLong() == 101);
+
+  // Alias is shown once changes are committed
+  setAlias(dataStore, plat1, "alias1", true);
+  QApplication::processEvents();
+  rv += SDK_ASSERT(counter.count == 1);
+  rv += SDK_ASSERT(model.data(index1, Qt::DisplayRole).toString() == "alias1");
+
+  // Blank alias falls back to the name, in gray
+  setAlias(dataStore, plat1, "", true);
+  QApplication::processEvents();
+  rv += SDK_ASSERT(counter.count == 2);
+  rv += SDK_ASSERT(model.data(index1, Qt::DisplayRole).toString() == "plat1");
+  rv += SDK_ASSERT(model.data(index1, Qt::TextColorRole).value<QColor>() == QColor(Qt::gray));
+
+  // Prefs changes that do not affect displayed values do not emit
+  setDraw(dataStore, plat1, false);
+  setDraw(dataStore, plat2, false);
+  QApplication::processEvents();
+  rv += SDK_ASSERT(counter.count == 2);
+
+  // Name changes are picked up
+  {
+    simData::DataStore::Transaction t;
+    dataStore.mutable_commonPrefs(plat2, &t)->set_name("renamed");
+    t.commit();
+  }
+  QApplication::processEvents();
+  rv += SDK_ASSERT(counter.count == 3);
+  rv += SDK_ASSERT(model.data(model.index(plat2), Qt::DisplayRole).toString() == "renamed");
+  return rv;
+}
+
+int testBatchedDataChanged()
+{
+  int rv = 0;
+  simData::MemoryDataStore dataStore;
+  std::vector<uint64_t> ids;
+  for (int k = 0; k < 200; ++k)
+    ids.push_back(addPlatform(dataStore, platformName(k), k));
+
+  simQt::EntityTreeModel model(NULL, &dataStore);
+  DataChangedCounter counter(model);
+
+  // Rename every other platform; all top level rows collapse into a single signal
+  for (size_t k = 0; k < ids.size(); k += 2)
+    setAlias(dataStore, ids[k], "alias", true);
+  rv += SDK_ASSERT(counter.count == 0);
+  QApplication::processEvents();
+  rv += SDK_ASSERT(counter.count == 1);
+  rv += SDK_ASSERT(model.data(model.index(ids[0]), Qt::DisplayRole).toString() == "alias");
+  rv += SDK_ASSERT(model.data(model.index(ids[1]), Qt::DisplayRole).toString() == QString::fromStdString(platformName(1)));
+  return rv;
+}
+
+int testSortPerformance()
+{
+  int rv = 0;
+  const int numPlatforms = 50000;
+  simData::MemoryDataStore dataStore;
+  // Add in reverse order so the sort has work to do
+  for (int k = numPlatforms - 1; k >= 0; --k)
+    addPlatform(dataStore, platformName(k), numPlatforms - k);
+
+  simQt::EntityTreeModel model(NULL, &dataStore);
+  simQt::EntityProxyModel proxy;
+  proxy.setSourceModel(&model);
+
+  const double startName = simCore::getSystemTime();
+  proxy.sort(0, Qt::AscendingOrder);
+  const double nameSeconds = simCore::getSystemTime() - startName;
+  rv += SDK_ASSERT(proxy.rowCount(QModelIndex()) == numPlatforms);
+  rv += SDK_ASSERT(proxy.data(proxy.index(0, 0), Qt::DisplayRole).toString() == QString::fromStdString(platformName(0)));
+  rv += SDK_ASSERT(proxy.data(proxy.index(numPlatforms - 1, 0), Qt::DisplayRole).toString() == QString::fromStdString(platformName(numPlatforms - 1)));
+
+  const double startId = simCore::getSystemTime();
+  proxy.sort(2, Qt::AscendingOrder);
+  const double idSeconds = simCore::getSystemTime() - startId;
+  rv += SDK_ASSERT(proxy.data(proxy.index(0, 2), Qt::DisplayRole).toString() == "1");
+  rv += SDK_ASSERT(proxy.data(proxy.index(numPlatforms - 1, 2), Qt::DisplayRole).toString() == QString::number(numPlatforms));
+
+  std::cout << "EntityTreeModel: sorted " << numPlatforms << " entities by name in " << nameSeconds
+    << " s, by original ID in " << idSeconds << " s" << std::endl;
+  return rv;
+}
+
+}
+
+int EntityTreeModelTest(int argc, char* argv[])
+{
+  if (simVis::isHeadless())
+  {
+    std::cerr << "Headless display detected; aborting test." << std::endl;
+    return 0;
+  }
+  int rv = 0;
+  QApplication app(argc, argv);
+  rv += testCachedValues();
+  rv += testBatchedDataChanged();
+  rv += testSortPerformance();
+  return rv;
+}
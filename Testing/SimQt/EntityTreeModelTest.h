@@ -0,0 +1,49 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#ifndef SIMQT_ENTITY_TREE_MODEL_TEST_H
+#define SIMQT_ENTITY_TREE_MODEL_TEST_H
+
+#include <QAbstractItemModel>
+#include <QObject>
+
+/// Counts dataChanged() signals from a model
+class DataChangedCounter : public QObject
+{
+  Q_OBJECT;
+public:
+  explicit DataChangedCounter(QAbstractItemModel& model)
+    : count(0)
+  {
+    connect(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(countDataChanged_()));
+  }
+
+  /// Number of dataChanged() signals received
+  int count;
+
+private slots:
+  void countDataChanged_()
+  {
+    ++count;
+  }
+};
+
+#endif /* SIMQT_ENTITY_TREE_MODEL_TEST_H */
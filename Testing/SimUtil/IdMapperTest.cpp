@@ -19,7 +19,11 @@
  * disclose, or release this software.
  *
  */
+#include <algorithm>
+#include <iostream>
+#include <sstream>
 #include "simCore/Common/SDKAssert.h"
+#include "simCore/Time/Utils.h"
 #include "simUtil/IdMapper.h"
 #include "simUtil/DataStoreTestHelper.h"
 
@@ -188,11 +192,169 @@ int testMapping()
   return rv;
 }
 
+/** Tests that IDs that failed to resolve are retried after relevant data store changes */
+int testUnresolvedRetry()
+{
+  int rv = 0;
+
+  simUtil::DataStoreTestHelper dsHelper;
+  simData::DataStore& dataStore = *dsHelper.dataStore();
+  const uint64_t plat1 = dsHelper.addPlatform(10);
+  setName(dataStore, plat1, "plat1");
+  const uint64_t beam1 = dsHelper.addBeam(plat1, 41);
+  setName(dataStore, beam1, "beam1");
+  const uint64_t beam2 = dsHelper.addBeam(plat1, 41);
+  setName(dataStore, beam2, "beam2");
+
+  simUtil::DataStoreIdMapper map(dataStore);
+  rv += SDK_ASSERT(map.addMapping(210, 10, "plat1", 210) == 0);
+  rv += SDK_ASSERT(map.addMapping(241, 41, "beam3", 210) == 0);
+
+  // Two candidates, and neither name matches
+  rv += SDK_ASSERT(map.map(241) == 0);
+  rv += SDK_ASSERT(map.map(241) == 0);
+  // Renaming a candidate makes it match
+  setName(dataStore, beam2, "beam3");
+  rv += SDK_ASSERT(map.map(241) == beam2);
+
+  // Ambiguous gate becomes resolvable when the other candidate is removed
+  const uint64_t gate1 = dsHelper.addGate(beam1, 51);
+  setName(dataStore, gate1, "gate");
+  const uint64_t gate2 = dsHelper.addGate(beam1, 51);
+  setName(dataStore, gate2, "gate");
+  rv += SDK_ASSERT(map.addMapping(251, 51, "gate", 210) == 0);
+  rv += SDK_ASSERT(map.map(251) == 0);
+  dataStore.removeEntity(gate2);
+  rv += SDK_ASSERT(map.map(251) == gate1);
+
+  // Gate with an unmapped host fails until the host mapping is added
+  const uint64_t plat2 = dsHelper.addPlatform(20);
+  setName(dataStore, plat2, "plat2");
+  const uint64_t beam3 = dsHelper.addBeam(plat2, 61);
+  setName(dataStore, beam3, "beam");
+  const uint64_t beam4 = dsHelper.addBeam(plat1, 61);
+  setName(dataStore, beam4, "beam");
+  rv += SDK_ASSERT(map.addMapping(261, 61, "beam", 220) == 0);
+  rv += SDK_ASSERT(map.map(261) == 0);
+  rv += SDK_ASSERT(map.addMapping(220, 20, "plat2", 220) == 0);
+  rv += SDK_ASSERT(map.map(261) == beam3);
+
+  // Batch interface matches the single interface, including repeated and unknown IDs
+  std::vector<uint64_t> remoteIds;
+  remoteIds.push_back(210);
+  remoteIds.push_back(261);
+  remoteIds.push_back(261);
+  remoteIds.push_back(999);
+  remoteIds.push_back(241);
+  std::vector<uint64_t> localIds;
+  rv += SDK_ASSERT(map.map(remoteIds, localIds) == 4);
+  rv += SDK_ASSERT(localIds.size() == remoteIds.size());
+  if (localIds.size() == remoteIds.size())
+  {
+    rv += SDK_ASSERT(localIds[0] == plat1);
+    rv += SDK_ASSERT(localIds[1] == beam3);
+    rv += SDK_ASSERT(localIds[2] == beam3);
+    rv += SDK_ASSERT(localIds[3] == 0);
+    rv += SDK_ASSERT(localIds[4] == beam2);
+  }
+  return rv;
+}
+
+/** Maps a large stream of updates and reports the throughput */
+int testThroughput()
+{
+  int rv = 0;
+  simUtil::DataStoreTestHelper dsHelper;
+  simData::DataStore& dataStore = *dsHelper.dataStore();
+
+  // Each platform has beams that share an original ID, so beams are resolved by host
+  const size_t numPlatforms = 200;
+  const size_t beamsPerPlatform = 4;
+  std::vector<uint64_t> expected;
+  for (size_t k = 0; k < numPlatforms; ++k)
+  {
+    const uint64_t plat = dsHelper.addPlatform(1000 + k);
+    expected.push_back(plat);
+    for (size_t j = 0; j < beamsPerPlatform; ++j)
+    {
+      const uint64_t beam = dsHelper.addBeam(plat, 1);
+      std::ostringstream name;
+      name << "beam" << j;
+      setName(dataStore, beam, name.str());
+      expected.push_back(beam);
+    }
+  }
+
+  // Remote IDs: platforms, their beams, then entities the local store does not have
+  simUtil::DataStoreIdMapper map(dataStore);
+  std::vector<uint64_t> remoteIds;
+  for (size_t k = 0; k < numPlatforms; ++k)
+  {
+    const uint64_t remotePlat = 10000 + k;
+    map.addMapping(remotePlat, 1000 + k, "", remotePlat);
+    remoteIds.push_back(remotePlat);
+    for (size_t j = 0; j < beamsPerPlatform; ++j)
+    {
+      const uint64_t remoteBeam = 20000 + k * beamsPerPlatform + j;
+      std::ostringstream name;
+      name << "beam" << j;
+      map.addMapping(remoteBeam, 1, name.str(), remotePlat);
+      remoteIds.push_back(remoteBeam);
+    }
+  }
+  const size_t numKnown = remoteIds.size();
+  for (size_t k = 0; k < numPlatforms; ++k)
+  {
+    map.addMapping(30000 + k, 5000 + k, "", 30000 + k);
+    remoteIds.push_back(30000 + k);
+  }
+
+  // First pass resolves everything
+  std::vector<uint64_t> localIds;
+  double startTime = simCore::getSystemTime();
+  rv += SDK_ASSERT(map.map(remoteIds, localIds) == numKnown);
+  const double resolveTime = simCore::getSystemTime() - startTime;
+  for (size_t k = 0; k < numKnown; ++k)
+    rv += SDK_ASSERT(localIds[k] == expected[k]);
+  for (size_t k = numKnown; k < remoteIds.size(); ++k)
+    rv += SDK_ASSERT(localIds[k] == 0);
+
+  // Stream of updates, as from a merging service
+  const size_t numPasses = 200;
+  size_t numMapped = 0;
+  startTime = simCore::getSystemTime();
+  for (size_t k = 0; k < numPasses; ++k)
+    numMapped += map.map(remoteIds, localIds);
+  const double batchTime = simCore::getSystemTime() - startTime;
+  rv += SDK_ASSERT(numMapped == numPasses * numKnown);
+
+  numMapped = 0;
+  startTime = simCore::getSystemTime();
+  for (size_t k = 0; k < numPasses; ++k)
+  {
+    for (std::vector<uint64_t>::const_iterator i = remoteIds.begin(); i != remoteIds.end(); ++i)
+    {
+      if (map.map(*i) != 0)
+        ++numMapped;
+    }
+  }
+  const double singleTime = simCore::getSystemTime() - startTime;
+  rv += SDK_ASSERT(numMapped == numPasses * numKnown);
+
+  const double numUpdates = static_cast<double>(numPasses * remoteIds.size());
+  std::cout << "IdMapper: initial resolve of " << remoteIds.size() << " IDs: " << resolveTime << " s\n"
+    << "IdMapper: batch map: " << numUpdates / std::max(batchTime, 1e-9) << " IDs/s\n"
+    << "IdMapper: single map: " << numUpdates / std::max(singleTime, 1e-9) << " IDs/s" << std::endl;
+  return rv;
+}
+
 }
 
 int IdMapperTest(int argc, char* argv[])
 {
   int rv = 0;
   rv += SDK_ASSERT(testMapping() == 0);
+  rv += SDK_ASSERT(testUnresolvedRetry() == 0);
+  rv += SDK_ASSERT(testThroughput() == 0);
   return rv;
 }
@@ -0,0 +1,136 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "OpenThreads/Thread"
+#include "osg/ref_ptr"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Time/TimeClass.h"
+#include "simVis/RFProp/RFPropagationFacade.h"
+
+namespace
+{
+
+/** Writes a small AREPS file with a loss table for the given bearing, returning its name */
+std::string writeArepsFile(double bearingDeg)
+{
+  std::ostringstream name;
+  name << "ArepsBackgroundLoadTest_" << static_cast<int>(bearingDeg) << ".txt";
+  std::ofstream os(name.str().c_str(), std::ios::out | std::ios::trunc);
+  os << "Hmax = 100\n"
+    << "Hmin = 0\n"
+    << "Nrout = 3\n"
+    << "Nzout = 1\n"
+    << "Rmax = 3000\n"
+    << "Bearing = deg " << bearingDeg << "\n"
+    << "HorBw = 10\n"
+    << "[Apm Loss Data]\n"
+    << "Height(m) Loss(cB)\n"
+    << "100 110 120\n"
+    << "130 140 150\n";
+  return name.str();
+}
+
+/** Calls processBackgroundLoads() until no load is pending, returning the number of profiles added */
+unsigned int finishBackgroundLoads(simRF::RFPropagationFacade& facade)
+{
+  unsigned int numAdded = 0;
+  size_t numProcessed = 0;
+  size_t numFiles = 0;
+  // 30 seconds is far longer than four tiny files should take
+  for (int k = 0; k < 3000 && facade.backgroundLoadProgress(numProcessed, numFiles); ++k)
+  {
+    numAdded += facade.processBackgroundLoads();
+    OpenThreads::Thread::microSleep(10000);
+  }
+  return numAdded + facade.processBackgroundLoads();
+}
+
+int testDisplayedTimeUnchanged()
+{
+  int rv = 0;
+  std::vector<std::string> earlyFiles;
+  earlyFiles.push_back(writeArepsFile(0.0));
+  earlyFiles.push_back(writeArepsFile(90.0));
+  earlyFiles.push_back(writeArepsFile(180.0));
+  std::vector<std::string> lateFiles;
+  lateFiles.push_back(writeArepsFile(270.0));
+
+  const simCore::TimeStamp earlyTime(1970, 10.0);
+  const simCore::TimeStamp lateTime(1970, 20.0);
+  simRF::RFPropagationFacade facade(1, NULL, NULL);
+
+  // The first file is loaded immediately, the rest in the background
+  rv += SDK_ASSERT(facade.loadArepsFilesAsync(earlyTime, earlyFiles, 2) == 0);
+  rv += SDK_ASSERT(facade.getSlotData(0.0) != NULL);
+
+  // Display the late profile map before the background load is processed
+  rv += SDK_ASSERT(facade.loadArepsFiles(lateTime, lateFiles) == 0);
+  const simRF::Profile* lateProfile = facade.getSlotData(270.0 * simCore::DEG2RAD);
+  rv += SDK_ASSERT(lateProfile != NULL);
+
+  rv += SDK_ASSERT(finishBackgroundLoads(facade) == 2);
+  size_t numProcessed = 0;
+  size_t numFiles = 0;
+  rv += SDK_ASSERT(!facade.backgroundLoadProgress(numProcessed, numFiles));
+
+  // The late profile map remains on display, and does not contain the early profiles
+  rv += SDK_ASSERT(facade.getSlotData(270.0 * simCore::DEG2RAD) == lateProfile);
+  rv += SDK_ASSERT(facade.getSlotData(90.0 * simCore::DEG2RAD) == NULL);
+  rv += SDK_ASSERT(facade.getSlotData(180.0 * simCore::DEG2RAD) == NULL);
+
+  std::vector<std::string> inputFiles;
+  rv += SDK_ASSERT(facade.getInputFiles(earlyTime, inputFiles) == 0);
+  rv += SDK_ASSERT(inputFiles.size() == 3);
+
+  // Returning to the early time shows all of its profiles, each with the POD provider from the facade
+  std::vector<std::string> reload(1, earlyFiles[0]);
+  rv += SDK_ASSERT(facade.loadArepsFiles(earlyTime, reload) == 0);
+  rv += SDK_ASSERT(facade.getSlotData(270.0 * simCore::DEG2RAD) == NULL);
+  for (double bearingDeg = 0.0; bearingDeg < 360.0; bearingDeg += 90.0)
+  {
+    if (bearingDeg == 270.0)
+      continue;
+    const simRF::Profile* profile = facade.getSlotData(bearingDeg * simCore::DEG2RAD);
+    rv += SDK_ASSERT(profile != NULL);
+    if (profile != NULL)
+      rv += SDK_ASSERT(profile->getDataProvider()->getProvider(simRF::ProfileDataProvider::THRESHOLDTYPE_POD) != NULL);
+  }
+
+  for (size_t k = 0; k < earlyFiles.size(); ++k)
+    ::remove(earlyFiles[k].c_str());
+  ::remove(lateFiles[0].c_str());
+  return rv;
+}
+
+}
+
+int ArepsBackgroundLoadTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testDisplayedTimeUnchanged();
+  return rv;
+}
@@ -0,0 +1,110 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdlib>
+#include <limits>
+#include "osg/ref_ptr"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/LUT/LUT2.h"
+#include "simVis/RFProp/CompressedLUTProfileDataProvider.h"
+#include "simVis/RFProp/LUTProfileDataProvider.h"
+
+namespace
+{
+
+const unsigned int NUM_HEIGHTS = 37;
+const unsigned int NUM_RANGES = 211;
+
+/** Fills a table with smooth loss values, runs of ground and initialization values, and extreme jumps */
+void fillTable(simCore::LUT::LUT2<short>& lut)
+{
+  lut.initialize(0.0, 3600.0, NUM_HEIGHTS, 100.0, 21100.0, NUM_RANGES);
+  srand(4321);
+  for (unsigned int h = 0; h < NUM_HEIGHTS; ++h)
+  {
+    for (unsigned int r = 0; r < NUM_RANGES; ++r)
+    {
+      short value = static_cast<short>(1200 + 3 * r + h + (rand() % 5));
+      if (h < 2)
+        value = simRF::AREPS_GROUND_VALUE;
+      else if (r > 180)
+        value = simRF::AREPS_INIT_VALUE;
+      else if (r % 53 == 7)
+        value = std::numeric_limits<short>::max();
+      else if (r % 53 == 8)
+        value = std::numeric_limits<short>::min();
+      lut(h, r) = value;
+    }
+  }
+}
+
+int testRoundTrip()
+{
+  int rv = 0;
+  simCore::LUT::LUT2<short>* source = new simCore::LUT::LUT2<short>();
+  fillTable(*source);
+  simCore::LUT::LUT2<short>* copy = new simCore::LUT::LUT2<short>();
+  fillTable(*copy);
+
+  // Both providers take ownership of their tables
+  osg::ref_ptr<simRF::LUTProfileDataProvider> expected = new simRF::LUTProfileDataProvider(source, simRF::ProfileDataProvider::THRESHOLDTYPE_LOSS, 0.1);
+  osg::ref_ptr<simRF::CompressedLUTProfileDataProvider> compressed = new simRF::CompressedLUTProfileDataProvider(copy, simRF::ProfileDataProvider::THRESHOLDTYPE_LOSS, 0.1);
+
+  rv += SDK_ASSERT(compressed->getNumHeights() == NUM_HEIGHTS);
+  rv += SDK_ASSERT(compressed->getNumRanges() == NUM_RANGES);
+  rv += SDK_ASSERT(compressed->getMinRange() == expected->getMinRange());
+  rv += SDK_ASSERT(compressed->getRangeStep() == expected->getRangeStep());
+  rv += SDK_ASSERT(compressed->getHeightStep() == expected->getHeightStep());
+  rv += SDK_ASSERT(compressed->getCompressedSize() > 0);
+  rv += SDK_ASSERT(compressed->getCompressedSize() < NUM_HEIGHTS * NUM_RANGES * sizeof(short));
+  rv += SDK_ASSERT(compressed->getDecompressedSize() == 0);
+
+  // Two passes: the first expands the table, the second follows a release
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    unsigned int mismatches = 0;
+    for (unsigned int h = 0; h < NUM_HEIGHTS; ++h)
+    {
+      for (unsigned int r = 0; r < NUM_RANGES; ++r)
+      {
+        if (compressed->getValueByIndex(h, r) != expected->getValueByIndex(h, r))
+          ++mismatches;
+      }
+    }
+    rv += SDK_ASSERT(mismatches == 0);
+    rv += SDK_ASSERT(compressed->getDecompressedSize() == NUM_HEIGHTS * NUM_RANGES * sizeof(short));
+    rv += SDK_ASSERT(compressed->interpolateValue(1234.5, 5432.1) == expected->interpolateValue(1234.5, 5432.1));
+
+    compressed->releaseDecompressed();
+    rv += SDK_ASSERT(compressed->getDecompressedSize() == 0);
+    rv += SDK_ASSERT(compressed->getStorageSize() == compressed->getCompressedSize());
+  }
+  return rv;
+}
+
+}
+
+int CompressedLUTProfileDataProviderTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testRoundTrip();
+  return rv;
+}
@@ -0,0 +1,157 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <sys/types.h>
+#ifdef WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#include "OpenThreads/Thread"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Common/Version.h"
+#include "simVis/EMFileCache.h"
+
+namespace
+{
+
+const char* RCS_FILE = "EMFileCacheTest.rcs";
+
+/** Writes a small RCS LUT file with one table and sets its modification time */
+void writeRcsFile(time_t modTime)
+{
+  std::ofstream os(RCS_FILE);
+  os << "0\nEMFileCacheTest\n" << simCore::RCS_LUT_TYPE << "\n" << simCore::RCS_MEAN_FUNC << "\n1.5\n1\n"
+    << "3000\n0\n" << simCore::POLARITY_HORIZONTAL << "\n4\n0 1\n"
+    << "0 10\n90 5\n180 0\n270 5\n";
+  os.close();
+  struct utimbuf times;
+  times.actime = modTime;
+  times.modtime = modTime;
+  utime(RCS_FILE, &times);
+}
+
+/** Polls a background RCS request until it completes, with a generous timeout */
+simVis::EMFileCache::Status waitForRcs(const std::string& filename, simCore::RadarCrossSectionPtr& rcs)
+{
+  simVis::EMFileCache::Status status = simVis::EMFileCache::instance()->requestRcs(filename, rcs);
+  for (int k = 0; k < 10000 && status == simVis::EMFileCache::STATUS_PENDING; ++k)
+  {
+    OpenThreads::Thread::microSleep(1000);
+    status = simVis::EMFileCache::instance()->requestRcs(filename, rcs);
+  }
+  return status;
+}
+
+int testSharedPatterns()
+{
+  int rv = 0;
+  simVis::EMFileCache* cache = simVis::EMFileCache::instance();
+  cache->clear();
+
+  simCore::AntennaPatternPtr gauss = cache->antennaPattern(simCore::ANTENNA_STRING_ALGORITHM_GAUSS, 3000.f);
+  rv += SDK_ASSERT(gauss != NULL);
+  // Same name and frequency share one instance
+  rv += SDK_ASSERT(cache->antennaPattern(simCore::ANTENNA_STRING_ALGORITHM_GAUSS, 3000.f) == gauss);
+  simCore::AntennaPatternPtr requested;
+  rv += SDK_ASSERT(cache->requestAntennaPattern(simCore::ANTENNA_STRING_ALGORITHM_GAUSS, 3000.f, requested) == simVis::EMFileCache::STATUS_LOADED);
+  rv += SDK_ASSERT(requested == gauss);
+  // A different frequency is a different entry
+  simCore::AntennaPatternPtr other = cache->antennaPattern(simCore::ANTENNA_STRING_ALGORITHM_GAUSS, 6000.f);
+  rv += SDK_ASSERT(other != NULL && other != gauss);
+  rv += SDK_ASSERT(cache->size() == 2);
+
+  // Failures are cached too
+  rv += SDK_ASSERT(cache->antennaPattern("EMFileCacheTest_missing.pat", 3000.f) == NULL);
+  rv += SDK_ASSERT(cache->requestAntennaPattern("EMFileCacheTest_missing.pat", 3000.f, requested) == simVis::EMFileCache::STATUS_FAILED);
+  rv += SDK_ASSERT(cache->size() == 3);
+
+  // Instances remain valid after the cache is cleared
+  cache->clear();
+  rv += SDK_ASSERT(cache->size() == 0);
+  rv += SDK_ASSERT(gauss->type() == simCore::ANTENNA_PATTERN_GAUSS);
+  rv += SDK_ASSERT(cache->antennaPattern(simCore::ANTENNA_STRING_ALGORITHM_GAUSS, 3000.f) != gauss);
+  return rv;
+}
+
+int testBackgroundLoad()
+{
+  int rv = 0;
+  simVis::EMFileCache* cache = simVis::EMFileCache::instance();
+  cache->clear();
+  writeRcsFile(1000000);
+
+  // Many requests for the same file resolve to one instance
+  simCore::RadarCrossSectionPtr first;
+  rv += SDK_ASSERT(waitForRcs(RCS_FILE, first) == simVis::EMFileCache::STATUS_LOADED);
+  rv += SDK_ASSERT(first != NULL);
+  for (int k = 0; k < 500; ++k)
+  {
+    simCore::RadarCrossSectionPtr rcs;
+    rv += SDK_ASSERT(cache->requestRcs(RCS_FILE, rcs) == simVis::EMFileCache::STATUS_LOADED);
+    rv += SDK_ASSERT(rcs == first);
+  }
+  rv += SDK_ASSERT(cache->rcs(RCS_FILE) == first);
+  if (first != NULL)
+    rv += SDK_ASSERT(simCore::areEqual(first->RCSdB(3000.f, 0.0, 0.0, simCore::POLARITY_HORIZONTAL), 10.0));
+
+  // A modified file is loaded again and replaces the stale entry; the blocking call waits on a pending background load
+  writeRcsFile(2000000);
+  simCore::RadarCrossSectionPtr pending;
+  rv += SDK_ASSERT(cache->requestRcs(RCS_FILE, pending) == simVis::EMFileCache::STATUS_PENDING);
+  simCore::RadarCrossSectionPtr modified = cache->rcs(RCS_FILE);
+  rv += SDK_ASSERT(modified != NULL && modified != first);
+  rv += SDK_ASSERT(waitForRcs(RCS_FILE, pending) == simVis::EMFileCache::STATUS_LOADED);
+  rv += SDK_ASSERT(pending == modified);
+  rv += SDK_ASSERT(cache->size() == 1);
+
+  // The blocking call also reloads a stale entry
+  writeRcsFile(3000000);
+  simCore::RadarCrossSectionPtr reloaded = cache->rcs(RCS_FILE);
+  rv += SDK_ASSERT(reloaded != NULL && reloaded != modified);
+  rv += SDK_ASSERT(cache->rcs(RCS_FILE) == reloaded);
+  rv += SDK_ASSERT(cache->size() == 1);
+
+  remove(RCS_FILE);
+  simCore::RadarCrossSectionPtr missing;
+  rv += SDK_ASSERT(waitForRcs(RCS_FILE, missing) == simVis::EMFileCache::STATUS_FAILED);
+  rv += SDK_ASSERT(missing == NULL);
+  cache->clear();
+  return rv;
+}
+
+}
+
+int EMFileCacheTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  // Check the SIMDIS SDK version
+  simCore::checkVersionThrow();
+
+  // Run tests
+  rv += testSharedPatterns();
+  rv += testBackgroundLoad();
+
+  return rv;
+}
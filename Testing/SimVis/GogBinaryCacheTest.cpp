@@ -0,0 +1,394 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#ifdef WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#include "simCore/Common/SDKAssert.h"
+#include "simVis/GOG/BinaryCache.h"
+#include "simVis/GOG/ErrorHandler.h"
+#include "simVis/GOG/GogNodeInterface.h"
+#include "simVis/GOG/Parser.h"
+#include "simVis/SceneManager.h"
+
+namespace
+{
+
+const char* GOG_FILE = "GogBinaryCacheTest.gog";
+const std::string SIGNATURE = "color1=#00ffff;";
+
+/** Shapes, keywords and altitude modes covering the GOG types the Parser caches; the empty linewidth is a parse error */
+const std::string SHAPES_GOG =
+  "version 2\n"
+  "start\n"
+  "annotation Label One\n"
+  "lla 24.5 -81.7 0\n"
+  "fontsize 18\n"
+  "linecolor yellow\n"
+  "3d name First Label\n"
+  "end\n"
+  "start\n"
+  "poly\n"
+  "3d name Box\n"
+  "altitudemode relativetoground\n"
+  "altitudeunits ft\n"
+  "ll 24.0 -82.0 100\n"
+  "ll 24.5 -82.0 100\n"
+  "ll 24.5 -81.5 100\n"
+  "filled\n"
+  "fillcolor 0x8000ff00\n"
+  "linewidth\n"
+  "end\n"
+  "start\n"
+  "arc\n"
+  "centerll 24.2 -81.8\n"
+  "radius 2000\n"
+  "rangeunits m\n"
+  "anglestart 10\n"
+  "angleend 200\n"
+  "angleunits deg\n"
+  "linestyle dashed\n"
+  "altitudemode clamptoground\n"
+  "end\n"
+  "start\n"
+  "ellipse\n"
+  "centerlla 24.1 -81.9 100\n"
+  "majoraxis 3000\n"
+  "minoraxis 1500\n"
+  "orient 45\n"
+  "extrude true 500\n"
+  "tessellate true\n"
+  "lineprojection greatcircle\n"
+  "end\n"
+  "start\n"
+  "line\n"
+  "ref 24.0 -82.0 0\n"
+  "xyz 0 0 0\n"
+  "xyz 100 200 50\n"
+  "linewidth 3\n"
+  "end\n";
+
+/** Counts the errors reported by the Parser */
+class CountingErrorHandler : public simVis::GOG::ErrorHandler
+{
+public:
+  CountingErrorHandler() : numErrors(0) {}
+  virtual void printWarning(size_t lineNumber, const std::string& warningText) {}
+  virtual void printError(size_t lineNumber, const std::string& errorText) { ++numErrors; }
+  size_t numErrors;
+};
+
+/** Writes the source GOG file with the given contents and modification time */
+void writeGogFile(const std::string& contents, time_t modTime)
+{
+  std::ofstream os(GOG_FILE, std::ios::out | std::ios::binary | std::ios::trunc);
+  os << contents;
+  os.close();
+  struct utimbuf times;
+  times.actime = modTime;
+  times.modtime = modTime;
+  utime(GOG_FILE, &times);
+}
+
+/** Reads an entire file into a string */
+std::string readFile(const std::string& fileName)
+{
+  std::ifstream is(fileName.c_str(), std::ios::in | std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+}
+
+/** Replaces the contents of a file */
+void replaceFile(const std::string& fileName, const std::string& contents)
+{
+  std::ofstream os(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  os << contents;
+}
+
+/** Builds a two shape parse result */
+void makeParse(osgEarth::Config& config, std::vector<simVis::GOG::GogMetaData>& metaData, simVis::GOG::BinaryCache::ParseErrors& errors)
+{
+  config = osgEarth::Config("gog");
+  osgEarth::Config circle("circle");
+  circle.add("radius", "100");
+  circle.add("linecolor", "#ff0000");
+  config.add(circle);
+  osgEarth::Config line("line");
+  osgEarth::Config points("points");
+  points.add("point", "0 0 0");
+  points.add("point", "1 1 0");
+  line.add(points);
+  config.add(line);
+
+  metaData.resize(2);
+  metaData[0].shape = simVis::GOG::GOG_CIRCLE;
+  metaData[0].metadata = "start\ncircle\nend\n";
+  metaData[0].setExplicitly(simVis::GOG::GOG_LINE_COLOR_SET);
+  metaData[1].shape = simVis::GOG::GOG_LINE;
+  metaData[1].metadata = "start\nline\nend\n";
+
+  errors.clear();
+  errors.push_back(std::make_pair(static_cast<size_t>(3), std::string("unknown keyword")));
+}
+
+int testRoundTrip()
+{
+  int rv = 0;
+  writeGogFile("start\ncircle\nend\n", 1000000);
+  const simVis::GOG::BinaryCache cache(".");
+
+  osgEarth::Config config;
+  std::vector<simVis::GOG::GogMetaData> metaData;
+  simVis::GOG::BinaryCache::ParseErrors errors;
+  makeParse(config, metaData, errors);
+  rv += SDK_ASSERT(cache.write(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  osgEarth::Config readConfig;
+  std::vector<simVis::GOG::GogMetaData> readMetaData;
+  simVis::GOG::BinaryCache::ParseErrors readErrors;
+  rv += SDK_ASSERT(cache.read(GOG_FILE, SIGNATURE, readConfig, readMetaData, readErrors));
+  std::string difference;
+  rv += SDK_ASSERT(simVis::GOG::BinaryCache::compare(config, metaData, readConfig, readMetaData, difference));
+  rv += SDK_ASSERT(difference.empty());
+  rv += SDK_ASSERT(readErrors == errors);
+  if (readMetaData.size() == 2)
+  {
+    rv += SDK_ASSERT(readMetaData[0].isSetExplicitly(simVis::GOG::GOG_LINE_COLOR_SET));
+    rv += SDK_ASSERT(!readMetaData[1].isSetExplicitly(simVis::GOG::GOG_LINE_COLOR_SET));
+  }
+
+  // Compare reports the first difference
+  readMetaData[1].metadata = "changed";
+  rv += SDK_ASSERT(!simVis::GOG::BinaryCache::compare(config, metaData, readConfig, readMetaData, difference));
+  rv += SDK_ASSERT(!difference.empty());
+  return rv;
+}
+
+int testInvalidation()
+{
+  int rv = 0;
+  const simVis::GOG::BinaryCache cache(".");
+  osgEarth::Config config;
+  std::vector<simVis::GOG::GogMetaData> metaData;
+  simVis::GOG::BinaryCache::ParseErrors errors;
+  makeParse(config, metaData, errors);
+
+  writeGogFile("start\ncircle\nend\n", 1000000);
+  rv += SDK_ASSERT(cache.write(GOG_FILE, SIGNATURE, config, metaData, errors));
+  rv += SDK_ASSERT(cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  // Signature of the parser settings
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, "color1=#ff0000;", config, metaData, errors));
+
+  // Modification time of the source
+  writeGogFile("start\ncircle\nend\n", 2000000);
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+  rv += SDK_ASSERT(cache.write(GOG_FILE, SIGNATURE, config, metaData, errors));
+  rv += SDK_ASSERT(cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  // Size of the source, with the same modification time
+  writeGogFile("start\ncircle\nradius 5\nend\n", 2000000);
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+  rv += SDK_ASSERT(cache.write(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  // Version of the cache layout, which follows the 4 byte magic number
+  const std::string cacheFile = cache.cacheFileName(GOG_FILE);
+  const std::string valid = readFile(cacheFile);
+  rv += SDK_ASSERT(valid.size() > 32);
+  if (rv != 0)
+    return rv;
+  std::string changed = valid;
+  changed[4] = static_cast<char>(changed[4] + 1);
+  replaceFile(cacheFile, changed);
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  // Missing source or cache file
+  replaceFile(cacheFile, valid);
+  rv += SDK_ASSERT(cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+  ::remove(cacheFile.c_str());
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+  ::remove(GOG_FILE);
+  rv += SDK_ASSERT(!cache.write(GOG_FILE, SIGNATURE, config, metaData, errors));
+  return rv;
+}
+
+int testCorruption()
+{
+  int rv = 0;
+  const simVis::GOG::BinaryCache cache(".");
+  osgEarth::Config config;
+  std::vector<simVis::GOG::GogMetaData> metaData;
+  simVis::GOG::BinaryCache::ParseErrors errors;
+  makeParse(config, metaData, errors);
+  writeGogFile("start\ncircle\nend\n", 1000000);
+  rv += SDK_ASSERT(cache.write(GOG_FILE, SIGNATURE, config, metaData, errors));
+  const std::string cacheFile = cache.cacheFileName(GOG_FILE);
+  const std::string valid = readFile(cacheFile);
+
+  // Every truncation is rejected, and outputs are left alone
+  size_t accepted = 0;
+  for (size_t length = 0; length < valid.size(); ++length)
+  {
+    replaceFile(cacheFile, valid.substr(0, length));
+    osgEarth::Config readConfig("untouched");
+    std::vector<simVis::GOG::GogMetaData> readMetaData;
+    simVis::GOG::BinaryCache::ParseErrors readErrors;
+    if (cache.read(GOG_FILE, SIGNATURE, readConfig, readMetaData, readErrors))
+      ++accepted;
+    else if (readConfig.key() != "untouched" || !readMetaData.empty() || !readErrors.empty())
+      ++accepted;
+  }
+  rv += SDK_ASSERT(accepted == 0);
+
+  // Trailing data
+  replaceFile(cacheFile, valid + "x");
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  // Impossible string length in the signature, which follows the magic, version, size and time
+  std::string corrupt = valid;
+  for (size_t k = 24; k < 28; ++k)
+    corrupt[k] = static_cast<char>(0xff);
+  replaceFile(cacheFile, corrupt);
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  // Wrong magic number
+  corrupt = valid;
+  corrupt[0] = 'X';
+  replaceFile(cacheFile, corrupt);
+  rv += SDK_ASSERT(!cache.read(GOG_FILE, SIGNATURE, config, metaData, errors));
+
+  ::remove(cacheFile.c_str());
+  ::remove(GOG_FILE);
+  return rv;
+}
+
+}
+
+/** Loads the GOG file through the Parser, returning the number of shapes created */
+size_t loadThroughParser(const simVis::GOG::Parser& parser)
+{
+  simVis::GOG::Parser::OverlayNodeVector output;
+  std::vector<simVis::GOG::GogFollowData> followData;
+  if (!parser.loadGOGs(GOG_FILE, simVis::GOG::GOGNODE_GEOGRAPHIC, output, followData))
+    return 0;
+  const size_t numShapes = output.size();
+  for (simVis::GOG::Parser::OverlayNodeVector::const_iterator i = output.begin(); i != output.end(); ++i)
+    delete *i;
+  return numShapes;
+}
+
+/** Round trips real GOG shapes through the Parser's cache and validates them against the text parse */
+int testParserRoundTrip()
+{
+  int rv = 0;
+  osg::ref_ptr<simVis::SceneManager> scene = new simVis::SceneManager();
+  simVis::GOG::Parser parser(scene->getMapNode());
+  std::tr1::shared_ptr<CountingErrorHandler> errorHandler(new CountingErrorHandler);
+  parser.setErrorHandler(errorHandler);
+  parser.setBinaryCacheDirectory(".");
+  writeGogFile(SHAPES_GOG, 1000000);
+  const std::string cacheFile = simVis::GOG::BinaryCache(".").cacheFileName(GOG_FILE);
+  ::remove(cacheFile.c_str());
+
+  // No entry until the file is loaded once
+  rv += SDK_ASSERT(!parser.validateBinaryCache(GOG_FILE));
+  errorHandler->numErrors = 0;
+
+  // First load parses the text and writes the entry
+  rv += SDK_ASSERT(loadThroughParser(parser) == 5);
+  rv += SDK_ASSERT(errorHandler->numErrors == 1);
+  rv += SDK_ASSERT(!readFile(cacheFile).empty());
+
+  // The entry matches a fresh parse shape by shape, including the parse error
+  errorHandler->numErrors = 0;
+  rv += SDK_ASSERT(parser.validateBinaryCache(GOG_FILE));
+  rv += SDK_ASSERT(errorHandler->numErrors == 1);
+
+  // A load from the entry creates the same shapes and reports the stored error again
+  errorHandler->numErrors = 0;
+  rv += SDK_ASSERT(loadThroughParser(parser) == 5);
+  rv += SDK_ASSERT(errorHandler->numErrors == 1);
+
+  // A different color table changes the signature, so the entry no longer applies
+  simVis::GOG::Parser otherColors(scene->getMapNode());
+  otherColors.setErrorHandler(errorHandler);
+  otherColors.setBinaryCacheDirectory(".");
+  otherColors.addOverwriteColor("yellow", osgEarth::Symbology::Color::Red);
+  rv += SDK_ASSERT(!otherColors.validateBinaryCache(GOG_FILE));
+
+  ::remove(cacheFile.c_str());
+  ::remove(GOG_FILE);
+  return rv;
+}
+
+/** Entries for a source whose modification time changed are rejected and rewritten */
+int testParserStaleEntry()
+{
+  int rv = 0;
+  osg::ref_ptr<simVis::SceneManager> scene = new simVis::SceneManager();
+  simVis::GOG::Parser parser(scene->getMapNode());
+  std::tr1::shared_ptr<CountingErrorHandler> errorHandler(new CountingErrorHandler);
+  parser.setErrorHandler(errorHandler);
+  parser.setBinaryCacheDirectory(".");
+  writeGogFile(SHAPES_GOG, 1000000);
+  const std::string cacheFile = simVis::GOG::BinaryCache(".").cacheFileName(GOG_FILE);
+  ::remove(cacheFile.c_str());
+  rv += SDK_ASSERT(loadThroughParser(parser) == 5);
+  rv += SDK_ASSERT(parser.validateBinaryCache(GOG_FILE));
+  const std::string original = readFile(cacheFile);
+
+  // Same contents, newer modification time
+  writeGogFile(SHAPES_GOG, 2000000);
+  rv += SDK_ASSERT(!parser.validateBinaryCache(GOG_FILE));
+
+  // Loading reparses the text and replaces the stale entry
+  rv += SDK_ASSERT(loadThroughParser(parser) == 5);
+  rv += SDK_ASSERT(readFile(cacheFile) != original);
+  rv += SDK_ASSERT(parser.validateBinaryCache(GOG_FILE));
+
+  // Edited source with a new modification time; the stale entry must not hide the new shape
+  writeGogFile(SHAPES_GOG + "start\ncircle\ncenterll 24.0 -81.0\nradius 500\nend\n", 3000000);
+  rv += SDK_ASSERT(!parser.validateBinaryCache(GOG_FILE));
+  rv += SDK_ASSERT(loadThroughParser(parser) == 6);
+  rv += SDK_ASSERT(parser.validateBinaryCache(GOG_FILE));
+
+  ::remove(cacheFile.c_str());
+  ::remove(GOG_FILE);
+  return rv;
+}
+
+
+int GogBinaryCacheTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += testRoundTrip();
+  rv += testInvalidation();
+  rv += testCorruption();
+  rv += testParserRoundTrip();
+  rv += testParserStaleEntry();
+  return rv;
+}
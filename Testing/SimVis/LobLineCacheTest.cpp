@@ -0,0 +1,277 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include <iostream>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Time/Utils.h"
+#include "simData/MemoryDataStore.h"
+#include "simVis/AnimatedLine.h"
+#include "simVis/LobGroup.h"
+#include "simVis/Scenario.h"
+#include "simVis/SceneManager.h"
+
+namespace
+{
+
+/** Adds 'count' lines at each of the times [firstTime, lastTime] */
+void addLines(simVis::LobLineCache& cache, int firstTime, int lastTime, int count)
+{
+  for (int t = firstTime; t <= lastTime; ++t)
+  {
+    for (int k = 0; k < count; ++k)
+      cache.addLineAtTime(t, cache.acquireLine());
+  }
+}
+
+int testWindow()
+{
+  int rv = 0;
+  simVis::LobLineCache cache;
+  addLines(cache, 0, 9, 2);
+  rv += SDK_ASSERT(cache.numLines() == 20);
+  rv += SDK_ASSERT(cache.numPooledLines() == 0);
+  rv += SDK_ASSERT(cache.node()->getNumChildren() == 20);
+  rv += SDK_ASSERT(cache.hasTime(0.0));
+  rv += SDK_ASSERT(!cache.hasTime(0.5));
+  rv += SDK_ASSERT(cache.lastTime() == 9.0);
+  rv += SDK_ASSERT(cache.numLinesAtOrBefore(-1.0) == 0);
+  rv += SDK_ASSERT(cache.numLinesAtOrBefore(4.5) == 10);
+  rv += SDK_ASSERT(cache.numLinesAtOrBefore(9.0) == 20);
+
+  // Out of order lines are placed by time
+  cache.addLineAtTime(4.5, cache.acquireLine());
+  rv += SDK_ASSERT(cache.numLinesAtOrBefore(4.5) == 11);
+  rv += SDK_ASSERT(cache.lastTime() == 9.0);
+
+  // Pruning hides lines outside the window and keeps them for reuse
+  cache.pruneCache(2.5, 7.0);
+  rv += SDK_ASSERT(!cache.hasTime(2.0));
+  rv += SDK_ASSERT(cache.hasTime(3.0));
+  rv += SDK_ASSERT(cache.hasTime(7.0));
+  rv += SDK_ASSERT(!cache.hasTime(8.0));
+  rv += SDK_ASSERT(cache.numLines() == 11);
+  rv += SDK_ASSERT(cache.numPooledLines() == 10);
+  rv += SDK_ASSERT(cache.node()->getNumChildren() == 21);
+  unsigned int numHidden = 0;
+  for (unsigned int k = 0; k < cache.node()->getNumChildren(); ++k)
+  {
+    if (cache.node()->getChild(k)->getNodeMask() == 0)
+      ++numHidden;
+  }
+  rv += SDK_ASSERT(numHidden == 10);
+
+  // New lines come from the pool
+  addLines(cache, 8, 12, 2);
+  rv += SDK_ASSERT(cache.numLines() == 21);
+  rv += SDK_ASSERT(cache.numPooledLines() == 0);
+  rv += SDK_ASSERT(cache.node()->getNumChildren() == 21);
+  rv += SDK_ASSERT(cache.lastTime() == 12.0);
+
+  cache.clearCache();
+  rv += SDK_ASSERT(cache.numLines() == 0);
+  rv += SDK_ASSERT(cache.numPooledLines() == 21);
+  rv += SDK_ASSERT(!cache.hasTime(3.0));
+  return rv;
+}
+
+int testTrimPool()
+{
+  int rv = 0;
+  simVis::LobLineCache cache;
+  addLines(cache, 1, 1000, 1);
+  cache.pruneCache(991.0, 1000.0);
+  rv += SDK_ASSERT(cache.numLines() == 10);
+  rv += SDK_ASSERT(cache.numPooledLines() == 990);
+
+  // Trimming keeps a small pool and all active lines
+  cache.trimPool();
+  rv += SDK_ASSERT(cache.numLines() == 10);
+  rv += SDK_ASSERT(cache.numPooledLines() < 990);
+  rv += SDK_ASSERT(cache.node()->getNumChildren() == static_cast<unsigned int>(cache.numLines() + cache.numPooledLines()));
+  unsigned int numVisible = 0;
+  for (unsigned int k = 0; k < cache.node()->getNumChildren(); ++k)
+  {
+    if (cache.node()->getChild(k)->getNodeMask() != 0)
+      ++numVisible;
+  }
+  rv += SDK_ASSERT(numVisible == 10);
+
+  // A pool no larger than the active set is not trimmed
+  cache.clearCache();
+  addLines(cache, 1, 500, 1);
+  cache.clearCache();
+  const int numPooled = cache.numPooledLines();
+  addLines(cache, 1, 500, 1);
+  cache.trimPool();
+  rv += SDK_ASSERT(cache.numPooledLines() == numPooled - 500);
+  return rv;
+}
+
+/** Times a sliding window of one update per time step, and a full rebuild, at several history sizes */
+int testBenchmark()
+{
+  int rv = 0;
+  const int numUpdates = 2000;
+  std::cout << "  " << numUpdates << " sliding window updates per history size:" << std::endl;
+  for (int historySize = 100; historySize <= 10000; historySize *= 10)
+  {
+    simVis::LobLineCache cache;
+    addLines(cache, 1, historySize, 1);
+
+    double start = simCore::getSystemTime();
+    for (int t = historySize + 1; t <= historySize + numUpdates; ++t)
+    {
+      cache.pruneCache(t - historySize + 1, t);
+      if (!cache.hasTime(t))
+        cache.addLineAtTime(t, cache.acquireLine());
+      cache.trimPool();
+    }
+    const double slideTime = simCore::getSystemTime() - start;
+    rv += SDK_ASSERT(cache.numLines() == historySize);
+    // Each update reused the line dropped by the previous one
+    rv += SDK_ASSERT(cache.node()->getNumChildren() <= static_cast<unsigned int>(historySize + 1));
+
+    start = simCore::getSystemTime();
+    cache.clearCache();
+    addLines(cache, 1, historySize, 1);
+    const double rebuildTime = simCore::getSystemTime() - start;
+    rv += SDK_ASSERT(cache.numPooledLines() <= 1);
+
+    std::cout << "    history " << historySize << ": " << (1e6 * slideTime / numUpdates) << " us/update, rebuild "
+      << (1e3 * rebuildTime) << " ms" << std::endl;
+  }
+  return rv;
+}
+
+}
+
+/** Adds a stationary platform and a LOB group on it with one data point per second from 1 to numPoints, keeping historySize points */
+uint64_t addLobGroup(simData::DataStore& dataStore, int numPoints, int historySize)
+{
+  simData::DataStore::Transaction platformTransaction;
+  simData::PlatformProperties* platformProps = dataStore.addPlatform(&platformTransaction);
+  const uint64_t platformId = platformProps->id();
+  platformTransaction.commit();
+
+  const simCore::Coordinate lla(simCore::COORD_SYS_LLA, simCore::Vec3(21.5 * simCore::DEG2RAD, -158.0 * simCore::DEG2RAD, 1000.0));
+  simCore::Coordinate ecef;
+  simCore::CoordinateConverter::convertGeodeticToEcef(lla, ecef);
+  simData::DataStore::Transaction platformUpdateTransaction;
+  simData::PlatformUpdate* platformUpdate = dataStore.addPlatformUpdate(platformId, &platformUpdateTransaction);
+  platformUpdate->set_time(0.0);
+  platformUpdate->set_x(ecef.x());
+  platformUpdate->set_y(ecef.y());
+  platformUpdate->set_z(ecef.z());
+  platformUpdateTransaction.commit();
+
+  simData::DataStore::Transaction lobTransaction;
+  simData::LobGroupProperties* lobProps = dataStore.addLobGroup(&lobTransaction);
+  const uint64_t lobId = lobProps->id();
+  lobProps->set_hostid(platformId);
+  lobTransaction.commit();
+
+  simData::DataStore::Transaction prefsTransaction;
+  simData::LobGroupPrefs* prefs = dataStore.mutable_lobGroupPrefs(lobId, &prefsTransaction);
+  prefs->mutable_commonprefs()->set_datadraw(true);
+  prefs->mutable_commonprefs()->set_draw(true);
+  prefs->set_maxdatapoints(historySize);
+  prefsTransaction.commit();
+
+  for (int k = 1; k <= numPoints; ++k)
+  {
+    simData::DataStore::Transaction t;
+    simData::LobGroupUpdate* update = dataStore.addLobGroupUpdate(lobId, &t);
+    update->set_time(k);
+    simData::LobGroupUpdatePoint* point = update->add_datapoints();
+    point->set_time(k);
+    point->set_range(10000.0);
+    point->set_azimuth(fmod(0.01 * k, M_TWOPI));
+    point->set_elevation(0.0);
+    t.commit();
+  }
+  return lobId;
+}
+
+/**
+ * Times scenario updates of a LOB group whose window slides by one point per update, through
+ * LobGroupNode::updateCache_.  Returns the time per update in seconds, and the lines drawn at the end.
+ */
+double timeLobGroupUpdates(int historySize, int numUpdates, bool recycling, int& numLines)
+{
+  simData::MemoryDataStore dataStore;
+  osg::ref_ptr<simVis::SceneManager> scene = new simVis::SceneManager();
+  osg::ref_ptr<simVis::ScenarioManager> scenario = scene->getScenario();
+  scenario->bind(&dataStore);
+  const uint64_t lobId = addLobGroup(dataStore, historySize + numUpdates, historySize);
+  simVis::LobGroupNode* lobNode = scenario->find<simVis::LobGroupNode>(lobId);
+  numLines = 0;
+  if (lobNode == NULL)
+    return 0.0;
+  lobNode->setLineRecycling(recycling);
+
+  // Fill the window, then slide it
+  dataStore.update(historySize);
+  scenario->update(&dataStore);
+  const double start = simCore::getSystemTime();
+  for (int t = historySize + 1; t <= historySize + numUpdates; ++t)
+  {
+    dataStore.update(t);
+    scenario->update(&dataStore);
+  }
+  const double elapsed = simCore::getSystemTime() - start;
+  numLines = lobNode->update()->datapoints_size();
+  scenario->unbind(&dataStore, true);
+  return elapsed / numUpdates;
+}
+
+/** Compares LobGroupNode updates with line recycling against recreating lines and rescanning every point */
+int testLobGroupBenchmark()
+{
+  int rv = 0;
+  const int numUpdates = 200;
+  std::cout << "  " << numUpdates << " LobGroupNode updates per history size:" << std::endl;
+  for (int historySize = 100; historySize <= 10000; historySize *= 10)
+  {
+    int oldLines = 0;
+    int newLines = 0;
+    const double oldTime = timeLobGroupUpdates(historySize, numUpdates, false, oldLines);
+    const double newTime = timeLobGroupUpdates(historySize, numUpdates, true, newLines);
+    rv += SDK_ASSERT(oldLines == historySize);
+    rv += SDK_ASSERT(newLines == historySize);
+    std::cout << "    history " << historySize << ": recreate " << (1e6 * oldTime) << " us/update, recycle "
+      << (1e6 * newTime) << " us/update" << std::endl;
+  }
+  return rv;
+}
+
+int LobLineCacheTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += SDK_ASSERT(testWindow() == 0);
+  rv += SDK_ASSERT(testTrimPool() == 0);
+  rv += SDK_ASSERT(testBenchmark() == 0);
+  rv += SDK_ASSERT(testLobGroupBenchmark() == 0);
+  return rv;
+}
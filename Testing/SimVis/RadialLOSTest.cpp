@@ -0,0 +1,404 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include <iostream>
+#include "OpenThreads/Mutex"
+#include "OpenThreads/ScopedLock"
+#include "osg/Geode"
+#include "osg/Geometry"
+#include "osg/MatrixTransform"
+#include "osgEarth/GeoData"
+#include "osgEarth/SpatialReference"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/Math.h"
+#include "simCore/Time/Utils.h"
+#include "simVis/RadialLOS.h"
+
+namespace
+{
+
+/** Height of the ridge in the synthetic terrain, meters */
+const double RIDGE_HEIGHT = 200.0;
+/** Southern edge of the ridge, degrees latitude */
+const double RIDGE_SOUTH = 0.02;
+/** Northern edge of the ridge, degrees latitude */
+const double RIDGE_NORTH = 0.0215;
+
+/** Flat terrain at the ellipsoid with an east-west ridge north of the equator; counts queries */
+class RidgeHeightSource : public simVis::RadialLOS::HeightSource
+{
+public:
+  explicit RidgeHeightSource(bool threadSafe)
+    : threadSafe_(threadSafe),
+      numQueries_(0)
+  {
+  }
+
+  virtual bool getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae) const
+  {
+    {
+      OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+      ++numQueries_;
+    }
+    hae = (point.y() >= RIDGE_SOUTH && point.y() <= RIDGE_NORTH) ? RIDGE_HEIGHT : 0.0;
+    hamsl = hae;
+    return true;
+  }
+
+  virtual bool isThreadSafe() const
+  {
+    return threadSafe_;
+  }
+
+  unsigned int numQueries() const
+  {
+    return numQueries_;
+  }
+
+private:
+  bool threadSafe_;
+  mutable unsigned int numQueries_;
+  mutable OpenThreads::Mutex mutex_;
+};
+
+/** Forwards to another source without per-thread queries, so that queries are serialized */
+class SerializedHeightSource : public simVis::RadialLOS::HeightSource
+{
+public:
+  explicit SerializedHeightSource(const simVis::RadialLOS::HeightSource& source)
+    : source_(source)
+  {
+  }
+
+  virtual bool getHeight(const osgEarth::GeoPoint& point, double& hamsl, double& hae) const
+  {
+    return source_.getHeight(point, hamsl, hae);
+  }
+
+  virtual bool isThreadSafe() const
+  {
+    return false;
+  }
+
+private:
+  const simVis::RadialLOS::HeightSource& source_;
+};
+
+/** Returns the ridge terrain height at the given latitude, degrees */
+double ridgeHeight(double lat)
+{
+  return (lat >= RIDGE_SOUTH && lat <= RIDGE_NORTH) ? RIDGE_HEIGHT : 0.0;
+}
+
+/** Builds a tiled terrain mesh of the ridge terrain, in world coordinates, around the equator and prime meridian */
+osg::Node* createRidgeTerrain(const osgEarth::SpatialReference* srs)
+{
+  // Grid lines fall on the edges of the ridge
+  const double cellDeg = 0.0005;
+  const int cellsPerTile = 20;
+  const int tilesPerSide = 10;
+  const double extentDeg = 0.5 * tilesPerSide * cellsPerTile * cellDeg;
+
+  osg::Group* terrain = new osg::Group();
+  for (int tileY = 0; tileY < tilesPerSide; ++tileY)
+  {
+    for (int tileX = 0; tileX < tilesPerSide; ++tileX)
+    {
+      const double west = -extentDeg + tileX * cellsPerTile * cellDeg;
+      const double south = -extentDeg + tileY * cellsPerTile * cellDeg;
+      // Vertices are relative to the tile center, as in a paged terrain
+      osg::Vec3d center;
+      osgEarth::GeoPoint(srs, west + 0.5 * cellsPerTile * cellDeg, south + 0.5 * cellsPerTile * cellDeg, 0.0, osgEarth::ALTMODE_ABSOLUTE).toWorld(center);
+
+      osg::Vec3Array* verts = new osg::Vec3Array();
+      for (int j = 0; j <= cellsPerTile; ++j)
+      {
+        for (int i = 0; i <= cellsPerTile; ++i)
+        {
+          const double lat = south + j * cellDeg;
+          osg::Vec3d world;
+          osgEarth::GeoPoint(srs, west + i * cellDeg, lat, ridgeHeight(lat), osgEarth::ALTMODE_ABSOLUTE).toWorld(world);
+          verts->push_back(world - center);
+        }
+      }
+      osg::DrawElementsUInt* triangles = new osg::DrawElementsUInt(GL_TRIANGLES);
+      for (int j = 0; j < cellsPerTile; ++j)
+      {
+        for (int i = 0; i < cellsPerTile; ++i)
+        {
+          const unsigned int corner = j * (cellsPerTile + 1) + i;
+          triangles->push_back(corner);
+          triangles->push_back(corner + 1);
+          triangles->push_back(corner + cellsPerTile + 2);
+          triangles->push_back(corner);
+          triangles->push_back(corner + cellsPerTile + 2);
+          triangles->push_back(corner + cellsPerTile + 1);
+        }
+      }
+      osg::Geometry* geom = new osg::Geometry();
+      geom->setVertexArray(verts);
+      geom->addPrimitiveSet(triangles);
+      osg::Geode* geode = new osg::Geode();
+      geode->addDrawable(geom);
+      osg::MatrixTransform* tile = new osg::MatrixTransform(osg::Matrix::translate(center));
+      tile->addChild(geode);
+      terrain->addChild(tile);
+    }
+  }
+  return terrain;
+}
+
+/** Returns the radial closest to the given azimuth, or NULL if there are none */
+const simVis::RadialLOS::Radial* findRadial(const simVis::RadialLOS& los, double azimRad)
+{
+  const simVis::RadialLOS::Radial* best = NULL;
+  const simVis::RadialLOS::RadialVector& radials = los.getRadials();
+  for (simVis::RadialLOS::RadialVector::const_iterator i = radials.begin(); i != radials.end(); ++i)
+  {
+    if (!best || fabs(i->azim_rad_ - azimRad) < fabs(best->azim_rad_ - azimRad))
+      best = &*i;
+  }
+  return best;
+}
+
+/** Returns 0 if the two computations produced the same samples */
+int compareLos(const simVis::RadialLOS& lhs, const simVis::RadialLOS& rhs)
+{
+  int rv = 0;
+  const simVis::RadialLOS::RadialVector& lhsRadials = lhs.getRadials();
+  const simVis::RadialLOS::RadialVector& rhsRadials = rhs.getRadials();
+  rv += SDK_ASSERT(lhsRadials.size() == rhsRadials.size());
+  if (rv != 0)
+    return rv;
+  for (size_t k = 0; k < lhsRadials.size(); ++k)
+  {
+    const simVis::RadialLOS::SampleVector& lhsSamples = lhsRadials[k].samples_;
+    const simVis::RadialLOS::SampleVector& rhsSamples = rhsRadials[k].samples_;
+    rv += SDK_ASSERT(simCore::areEqual(lhsRadials[k].azim_rad_, rhsRadials[k].azim_rad_));
+    rv += SDK_ASSERT(lhsSamples.size() == rhsSamples.size());
+    if (lhsSamples.size() != rhsSamples.size())
+      continue;
+    for (size_t j = 0; j < lhsSamples.size(); ++j)
+    {
+      rv += SDK_ASSERT(lhsSamples[j].valid_ == rhsSamples[j].valid_);
+      rv += SDK_ASSERT(simCore::areEqual(lhsSamples[j].range_m_, rhsSamples[j].range_m_));
+      rv += SDK_ASSERT(simCore::areEqual(lhsSamples[j].hae_m_, rhsSamples[j].hae_m_));
+      rv += SDK_ASSERT(simCore::areEqual(lhsSamples[j].elev_rad_, rhsSamples[j].elev_rad_));
+      rv += SDK_ASSERT(lhsSamples[j].visible_ == rhsSamples[j].visible_);
+    }
+  }
+  return rv;
+}
+
+/** Configures an LOS for the tests */
+void configure(simVis::RadialLOS& los, double rangeKm, double fovDeg, unsigned int numThreads)
+{
+  los.setMaxRange(simVis::Distance(rangeKm, simVis::Units::KILOMETERS));
+  los.setRangeResolution(simVis::Distance(100.0, simVis::Units::METERS));
+  los.setFieldOfView(simVis::Angle(fovDeg, simVis::Units::DEGREES));
+  los.setAzimuthalResolution(simVis::Angle(10.0, simVis::Units::DEGREES));
+  los.setNumThreads(numThreads);
+}
+
+int testRidge(const osgEarth::SpatialReference* srs, const simCore::Coordinate& origin)
+{
+  int rv = 0;
+  RidgeHeightSource heights(true);
+  simVis::RadialLOS los;
+  configure(los, 5.0, 360.0, 4);
+  rv += SDK_ASSERT(los.compute(heights, srs, origin));
+  rv += SDK_ASSERT(los.getNumSamplesPerRadial() == 50);
+
+  // Looking south, the terrain is flat and all samples inside the horizon are visible
+  const simVis::RadialLOS::Radial* south = findRadial(los, M_PI);
+  rv += SDK_ASSERT(south != NULL);
+  if (south)
+  {
+    for (simVis::RadialLOS::SampleVector::const_iterator i = south->samples_.begin(); i != south->samples_.end(); ++i)
+    {
+      rv += SDK_ASSERT(i->valid_);
+      rv += SDK_ASSERT(i->visible_);
+    }
+  }
+
+  // Looking north, the ridge hides the terrain behind it
+  const simVis::RadialLOS::Radial* north = findRadial(los, 0.0);
+  rv += SDK_ASSERT(north != NULL);
+  if (north)
+  {
+    bool sawRidge = false;
+    for (simVis::RadialLOS::SampleVector::const_iterator i = north->samples_.begin(); i != north->samples_.end(); ++i)
+    {
+      const double lat = i->point_.y();
+      if (lat < RIDGE_SOUTH)
+        rv += SDK_ASSERT(i->visible_);
+      else if (lat <= RIDGE_NORTH)
+      {
+        sawRidge = true;
+        rv += SDK_ASSERT(i->visible_);
+        rv += SDK_ASSERT(simCore::areEqual(i->hae_m_, RIDGE_HEIGHT));
+      }
+      else
+        rv += SDK_ASSERT(!i->visible_);
+    }
+    rv += SDK_ASSERT(sawRidge);
+  }
+  return rv;
+}
+
+int testParallel(const osgEarth::SpatialReference* srs, const simCore::Coordinate& origin)
+{
+  int rv = 0;
+  RidgeHeightSource heights(true);
+  RidgeHeightSource serialHeights(false);
+
+  simVis::RadialLOS serial;
+  configure(serial, 5.0, 360.0, 1);
+  rv += SDK_ASSERT(serial.compute(heights, srs, origin));
+
+  simVis::RadialLOS parallel;
+  configure(parallel, 5.0, 360.0, 4);
+  rv += SDK_ASSERT(parallel.compute(heights, srs, origin));
+  rv += SDK_ASSERT(compareLos(serial, parallel) == 0);
+
+  // Sources that are not thread safe give the same results
+  simVis::RadialLOS serialized;
+  configure(serialized, 5.0, 360.0, 4);
+  rv += SDK_ASSERT(serialized.compute(serialHeights, srs, origin));
+  rv += SDK_ASSERT(compareLos(serial, serialized) == 0);
+  rv += SDK_ASSERT(serialHeights.numQueries() == heights.numQueries() / 2);
+  return rv;
+}
+
+int testIncremental(const osgEarth::SpatialReference* srs, const simCore::Coordinate& origin)
+{
+  int rv = 0;
+
+  RidgeHeightSource freshHeights(true);
+  simVis::RadialLOS fresh;
+  configure(fresh, 5.0, 180.0, 4);
+  rv += SDK_ASSERT(fresh.compute(freshHeights, srs, origin));
+
+  // Grow the range and field of view; existing samples are kept
+  RidgeHeightSource heights(true);
+  simVis::RadialLOS los;
+  configure(los, 3.05, 90.0, 4);
+  rv += SDK_ASSERT(los.compute(heights, srs, origin));
+  const unsigned int initialQueries = heights.numQueries();
+  configure(los, 5.0, 180.0, 4);
+  rv += SDK_ASSERT(los.compute(heights, srs, origin));
+  rv += SDK_ASSERT(compareLos(fresh, los) == 0);
+  rv += SDK_ASSERT(heights.numQueries() - initialQueries < freshHeights.numQueries());
+
+  // Shrinking the range also reuses samples
+  RidgeHeightSource shortHeights(true);
+  simVis::RadialLOS shortLos;
+  configure(shortLos, 2.55, 180.0, 4);
+  rv += SDK_ASSERT(shortLos.compute(shortHeights, srs, origin));
+  const unsigned int grownQueries = heights.numQueries();
+  configure(los, 2.55, 180.0, 4);
+  rv += SDK_ASSERT(los.compute(heights, srs, origin));
+  rv += SDK_ASSERT(compareLos(shortLos, los) == 0);
+  rv += SDK_ASSERT(heights.numQueries() - grownQueries < shortHeights.numQueries());
+
+  // Moving the origin resamples everything
+  simCore::Coordinate moved(simCore::COORD_SYS_LLA, simCore::Vec3(0.001 * simCore::DEG2RAD, 0.0, 10.0));
+  const unsigned int shrunkQueries = heights.numQueries();
+  rv += SDK_ASSERT(los.compute(heights, srs, moved));
+  rv += SDK_ASSERT(heights.numQueries() - shrunkQueries == shortHeights.numQueries());
+  return rv;
+}
+
+/** Samples a terrain mesh serialized and with per-thread queries, timing each */
+int testTerrain(const osgEarth::SpatialReference* srs, const simCore::Coordinate& origin)
+{
+  int rv = 0;
+  osg::ref_ptr<osg::Node> terrain = createRidgeTerrain(srs);
+  const simVis::RadialLOS::TerrainHeightSource heights(NULL, terrain.get());
+  const SerializedHeightSource serializedHeights(heights);
+  rv += SDK_ASSERT(heights.isThreadSafe());
+
+  // A point on the ridge intersects the mesh at the ridge height
+  double hamsl = 0.0;
+  double hae = 0.0;
+  rv += SDK_ASSERT(heights.getHeight(osgEarth::GeoPoint(srs, 0.001, 0.5 * (RIDGE_SOUTH + RIDGE_NORTH), 0.0, osgEarth::ALTMODE_ABSOLUTE), hamsl, hae));
+  rv += SDK_ASSERT(simCore::areEqual(hae, RIDGE_HEIGHT, 0.1));
+
+  const int numComputes = 5;
+  simVis::RadialLOS serial;
+  configure(serial, 5.0, 360.0, 1);
+  double start = simCore::getSystemTime();
+  for (int k = 0; k < numComputes; ++k)
+  {
+    serial.clearSamples();
+    rv += SDK_ASSERT(serial.compute(heights, srs, origin));
+  }
+  const double serialTime = simCore::getSystemTime() - start;
+
+  // Four threads sharing one serialized source, as terrain was sampled before per-thread queries
+  simVis::RadialLOS serialized;
+  configure(serialized, 5.0, 360.0, 4);
+  start = simCore::getSystemTime();
+  for (int k = 0; k < numComputes; ++k)
+  {
+    serialized.clearSamples();
+    rv += SDK_ASSERT(serialized.compute(serializedHeights, srs, origin));
+  }
+  const double serializedTime = simCore::getSystemTime() - start;
+
+  // Four threads, each with its own intersector, on the persistent pool
+  simVis::RadialLOS parallel;
+  configure(parallel, 5.0, 360.0, 4);
+  start = simCore::getSystemTime();
+  for (int k = 0; k < numComputes; ++k)
+  {
+    parallel.clearSamples();
+    rv += SDK_ASSERT(parallel.compute(heights, srs, origin));
+  }
+  const double parallelTime = simCore::getSystemTime() - start;
+
+  rv += SDK_ASSERT(compareLos(serial, serialized) == 0);
+  rv += SDK_ASSERT(compareLos(serial, parallel) == 0);
+
+  // The ridge hides the terrain behind it
+  const simVis::RadialLOS::Radial* north = findRadial(parallel, 0.0);
+  rv += SDK_ASSERT(north != NULL && !north->samples_.empty() && !north->samples_.back().visible_);
+
+  std::cout << "  terrain LOS, " << numComputes << " computes: 1 thread " << serialTime << " s, 4 threads serialized "
+    << serializedTime << " s, 4 threads with per-thread queries " << parallelTime << " s" << std::endl;
+  return rv;
+}
+
+}
+
+int RadialLOSTest(int argc, char* argv[])
+{
+  int rv = 0;
+  osg::ref_ptr<const osgEarth::SpatialReference> srs = osgEarth::SpatialReference::get("wgs84");
+  const simCore::Coordinate origin(simCore::COORD_SYS_LLA, simCore::Vec3(0.0, 0.0, 10.0));
+  rv += SDK_ASSERT(testRidge(srs.get(), origin) == 0);
+  rv += SDK_ASSERT(testParallel(srs.get(), origin) == 0);
+  rv += SDK_ASSERT(testIncremental(srs.get(), origin) == 0);
+  rv += SDK_ASSERT(testTerrain(srs.get(), origin) == 0);
+  return rv;
+}
@@ -0,0 +1,295 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cmath>
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simCore/Calc/Math.h"
+#include "simData/MemoryDataStore.h"
+#include "simVis/RangeTool.h"
+#include "simVis/RangeToolEngine.h"
+#include "simVis/Scenario.h"
+#include "simVis/SceneManager.h"
+
+namespace
+{
+
+uint64_t addPlatform(simData::DataStore& dataStore)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformProperties* props = dataStore.addPlatform(&t);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+/** Adds an update at the given LLA (deg, deg, m), heading north at 100 m/s */
+void addUpdate(simData::DataStore& dataStore, uint64_t id, double time, double latDeg, double lonDeg, double alt)
+{
+  const simCore::Coordinate lla(simCore::COORD_SYS_LLA,
+    simCore::Vec3(latDeg * simCore::DEG2RAD, lonDeg * simCore::DEG2RAD, alt),
+    simCore::Vec3(0.0, 0.0, 0.0),
+    simCore::Vec3(0.0, 100.0, 0.0));
+  simCore::Coordinate ecef;
+  simCore::CoordinateConverter::convertGeodeticToEcef(lla, ecef);
+
+  simData::DataStore::Transaction t;
+  simData::PlatformUpdate* update = dataStore.addPlatformUpdate(id, &t);
+  update->set_time(time);
+  update->set_x(ecef.x());
+  update->set_y(ecef.y());
+  update->set_z(ecef.z());
+  update->set_psi(ecef.psi());
+  update->set_theta(ecef.theta());
+  update->set_phi(ecef.phi());
+  update->set_vx(ecef.vx());
+  update->set_vy(ecef.vy());
+  update->set_vz(ecef.vz());
+  t.commit();
+}
+
+std::vector<simVis::RangeToolEngine::MeasurementType> allMeasurements()
+{
+  std::vector<simVis::RangeToolEngine::MeasurementType> measurements;
+  for (int k = simVis::RangeToolEngine::GROUND_DISTANCE; k <= simVis::RangeToolEngine::ASPECT_ANGLE; ++k)
+    measurements.push_back(static_cast<simVis::RangeToolEngine::MeasurementType>(k));
+  return measurements;
+}
+
+int testValues(simData::DataStore& dataStore, uint64_t plat1, uint64_t plat2)
+{
+  int rv = 0;
+  simVis::RangeToolEngine engine(dataStore);
+
+  std::vector<simVis::RangeToolEngine::EntityPair> pairs;
+  pairs.push_back(simVis::RangeToolEngine::EntityPair(plat1, plat2));
+  std::vector<simVis::RangeToolEngine::MeasurementType> measurements;
+  measurements.push_back(simVis::RangeToolEngine::ALTITUDE_DELTA);
+  measurements.push_back(simVis::RangeToolEngine::TRUE_AZIMUTH);
+  measurements.push_back(simVis::RangeToolEngine::GROUND_DISTANCE);
+  // Out of order on purpose; the first time is before plat2 has data
+  std::vector<double> times;
+  times.push_back(20.0);
+  times.push_back(5.0);
+  times.push_back(-1.0);
+  times.push_back(10.0);
+
+  simVis::RangeToolEngine::TimeSeries results;
+  rv += SDK_ASSERT(engine.evaluate(pairs, measurements, times, results) == 0);
+  rv += SDK_ASSERT(results.numPairs_ == 1);
+  rv += SDK_ASSERT(results.numMeasurements_ == 3);
+  rv += SDK_ASSERT(results.numTimes_ == 4);
+  rv += SDK_ASSERT(results.values_.size() == 12);
+  rv += SDK_ASSERT(results.valid_.size() == 12);
+  if (rv != 0)
+    return rv;
+
+  const size_t altOffset = results.seriesOffset(0, 0);
+  const size_t azOffset = results.seriesOffset(0, 1);
+  const size_t groundOffset = results.seriesOffset(0, 2);
+  for (size_t k = 0; k < times.size(); ++k)
+    rv += SDK_ASSERT(results.valid_[altOffset + k] == (times[k] >= 0.0 ? 1 : 0));
+
+  // plat2 climbs from 1000 m to 2000 m directly north of plat1
+  rv += SDK_ASSERT(simCore::areEqual(results.values_[altOffset], 2000.0, 1e-3));
+  rv += SDK_ASSERT(simCore::areEqual(results.values_[altOffset + 1], 1500.0, 1e-3));
+  rv += SDK_ASSERT(simCore::areEqual(results.values_[altOffset + 3], 2000.0, 1e-3));
+  rv += SDK_ASSERT(simCore::areEqual(results.values_[azOffset + 1], 0.0, 1e-6));
+  rv += SDK_ASSERT(results.values_[groundOffset + 1] > 11000.0 && results.values_[groundOffset + 1] < 11200.0);
+
+  // Holding the previous update instead of interpolating
+  engine.setInterpolate(false);
+  rv += SDK_ASSERT(engine.evaluate(pairs, measurements, times, results) == 0);
+  rv += SDK_ASSERT(simCore::areEqual(results.values_[results.seriesOffset(0, 0) + 1], 1000.0, 1e-3));
+  return rv;
+}
+
+/** Live Range Tool measurements, in the order of RangeToolEngine::MeasurementType */
+std::vector<osg::ref_ptr<simVis::RangeTool::Measurement> > liveMeasurements()
+{
+  std::vector<osg::ref_ptr<simVis::RangeTool::Measurement> > measurements;
+  measurements.push_back(new simVis::RangeTool::GroundDistanceMeasurement());
+  measurements.push_back(new simVis::RangeTool::SlantDistanceMeasurement());
+  measurements.push_back(new simVis::RangeTool::AltitudeDeltaMeasurement());
+  measurements.push_back(new simVis::RangeTool::DownRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::CrossRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::DownRangeCrossRangeDownValueMeasurement());
+  measurements.push_back(new simVis::RangeTool::GeoDownRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::GeoCrossRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::TrueAzimuthMeasurement());
+  measurements.push_back(new simVis::RangeTool::TrueElevationMeasurement());
+  measurements.push_back(new simVis::RangeTool::TrueCompositeAngleMeasurement());
+  measurements.push_back(new simVis::RangeTool::RelOriAzimuthMeasurement());
+  measurements.push_back(new simVis::RangeTool::RelOriElevationMeasurement());
+  measurements.push_back(new simVis::RangeTool::RelOriCompositeAngleMeasurement());
+  measurements.push_back(new simVis::RangeTool::RelVelAzimuthMeasurement());
+  measurements.push_back(new simVis::RangeTool::RelVelElevationMeasurement());
+  measurements.push_back(new simVis::RangeTool::RelVelCompositeAngleMeasurement());
+  measurements.push_back(new simVis::RangeTool::ClosingVelocityMeasurement());
+  measurements.push_back(new simVis::RangeTool::SeparationVelocityMeasurement());
+  measurements.push_back(new simVis::RangeTool::VelocityDeltaMeasurement());
+  measurements.push_back(new simVis::RangeTool::VelAzimDownRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::VelAzimCrossRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::VelAzimGeoDownRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::VelAzimGeoCrossRangeMeasurement());
+  measurements.push_back(new simVis::RangeTool::AspectAngleMeasurement());
+  return measurements;
+}
+
+/** Fills in a Range Tool state the way an association refresh does, from the scenario's current platform nodes */
+int populateLiveState(const simVis::ScenarioManager& scenario, uint64_t beginId, uint64_t endId, simVis::RangeTool::State& state)
+{
+  state.earthModel_ = simCore::WGS_84;
+  int rv = state.populateEntityState(scenario, scenario.find(beginId), state.beginEntity_);
+  rv += state.populateEntityState(scenario, scenario.find(endId), state.endEntity_);
+  state.coordConv_.setReferenceOrigin(state.beginEntity_.lla_);
+  return rv;
+}
+
+/** Compares evaluate() against the live Range Tool measurements on a scenario stepped through the same times */
+int testMatchesLive()
+{
+  int rv = 0;
+  simData::MemoryDataStore dataStore;
+  osg::ref_ptr<simVis::SceneManager> scene = new simVis::SceneManager();
+  osg::ref_ptr<simVis::ScenarioManager> scenario = scene->getScenario();
+  scenario->bind(&dataStore);
+
+  // plat2 moves north-east of plat1 and climbs, so every angle and distance changes
+  const uint64_t plat1 = addPlatform(dataStore);
+  const uint64_t plat2 = addPlatform(dataStore);
+  addUpdate(dataStore, plat1, 0.0, 0.0, 0.0, 0.0);
+  addUpdate(dataStore, plat1, 10.0, 0.01, 0.0, 0.0);
+  addUpdate(dataStore, plat2, 0.0, 0.1, 0.0, 1000.0);
+  addUpdate(dataStore, plat2, 5.0, 0.1, 0.1, 1500.0);
+  addUpdate(dataStore, plat2, 10.0, 0.05, 0.15, 2000.0);
+
+  // The data store has no interpolator, so the live platforms hold their previous update
+  simVis::RangeToolEngine engine(dataStore);
+  engine.setInterpolate(false);
+  std::vector<simVis::RangeToolEngine::EntityPair> pairs;
+  pairs.push_back(simVis::RangeToolEngine::EntityPair(plat1, plat2));
+  pairs.push_back(simVis::RangeToolEngine::EntityPair(plat2, plat1));
+  const std::vector<simVis::RangeToolEngine::MeasurementType> measurements = allMeasurements();
+  const std::vector<osg::ref_ptr<simVis::RangeTool::Measurement> > live = liveMeasurements();
+  rv += SDK_ASSERT(live.size() == measurements.size());
+  std::vector<double> times;
+  times.push_back(0.0);
+  times.push_back(2.5);
+  times.push_back(5.0);
+  times.push_back(10.0);
+  times.push_back(12.0);
+
+  simVis::RangeToolEngine::TimeSeries results;
+  rv += SDK_ASSERT(engine.evaluate(pairs, measurements, times, results) == 0);
+  if (rv != 0)
+    return rv;
+
+  for (size_t k = 0; k < times.size(); ++k)
+  {
+    dataStore.update(times[k]);
+    scenario->update(&dataStore);
+    for (size_t p = 0; p < pairs.size(); ++p)
+    {
+      simVis::RangeTool::State state;
+      rv += SDK_ASSERT(populateLiveState(*scenario, pairs[p].first, pairs[p].second, state) == 0);
+      for (size_t m = 0; m < measurements.size(); ++m)
+      {
+        const size_t index = results.seriesOffset(p, m) + k;
+        rv += SDK_ASSERT(results.valid_[index] != 0);
+        const double expected = live[m]->value(state);
+        double delta = results.values_[index] - expected;
+        if (live[m]->units().isAngle())
+          delta = simCore::angFixPI(delta);
+        rv += SDK_ASSERT(fabs(delta) <= 1e-6 * simCore::sdkMax(1.0, fabs(expected)));
+      }
+    }
+  }
+
+  scenario->unbind(&dataStore, true);
+  return rv;
+}
+
+/** Threaded and serial evaluation give the same values */
+int testThreads(simData::DataStore& dataStore, uint64_t plat1, uint64_t plat2)
+{
+  int rv = 0;
+  simVis::RangeToolEngine engine(dataStore);
+  engine.setNumThreads(4);
+
+  std::vector<simVis::RangeToolEngine::EntityPair> pairs;
+  pairs.push_back(simVis::RangeToolEngine::EntityPair(plat1, plat2));
+  pairs.push_back(simVis::RangeToolEngine::EntityPair(plat2, plat1));
+  const std::vector<simVis::RangeToolEngine::MeasurementType> measurements = allMeasurements();
+  std::vector<double> times;
+  for (size_t k = 0; k <= 40; ++k)
+    times.push_back(0.5 * k);
+
+  simVis::RangeToolEngine::TimeSeries results;
+  rv += SDK_ASSERT(engine.evaluate(pairs, measurements, times, results) == 0);
+  for (size_t k = 0; k < results.valid_.size(); ++k)
+    rv += SDK_ASSERT(results.valid_[k] != 0);
+
+  simVis::RangeToolEngine::TimeSeries serialResults;
+  engine.setNumThreads(1);
+  rv += SDK_ASSERT(engine.evaluate(pairs, measurements, times, serialResults) == 0);
+  rv += SDK_ASSERT(serialResults.values_ == results.values_);
+  rv += SDK_ASSERT(serialResults.valid_ == results.valid_);
+  return rv;
+}
+
+int testInvalidIds(simData::DataStore& dataStore, uint64_t plat1)
+{
+  int rv = 0;
+  simVis::RangeToolEngine engine(dataStore);
+  std::vector<simVis::RangeToolEngine::EntityPair> pairs;
+  pairs.push_back(simVis::RangeToolEngine::EntityPair(plat1, plat1 + 1000));
+  std::vector<double> times(1, 0.0);
+  simVis::RangeToolEngine::TimeSeries results;
+  rv += SDK_ASSERT(engine.evaluate(pairs, allMeasurements(), times, results) != 0);
+
+  simVis::RangeToolEngine::Kinematics kinematics;
+  rv += SDK_ASSERT(engine.platformKinematics(plat1 + 1000, 0.0, kinematics) != 0);
+  rv += SDK_ASSERT(engine.platformKinematics(plat1, -10.0, kinematics) != 0);
+  return rv;
+}
+
+}
+
+int RangeToolEngineTest(int argc, char* argv[])
+{
+  int rv = 0;
+  simData::MemoryDataStore dataStore;
+  const uint64_t plat1 = addPlatform(dataStore);
+  const uint64_t plat2 = addPlatform(dataStore);
+  addUpdate(dataStore, plat1, -5.0, 0.0, 0.0, 0.0);
+  addUpdate(dataStore, plat1, 20.0, 0.0, 0.0, 0.0);
+  addUpdate(dataStore, plat2, 0.0, 0.1, 0.0, 1000.0);
+  addUpdate(dataStore, plat2, 10.0, 0.1, 0.0, 2000.0);
+
+  rv += SDK_ASSERT(testValues(dataStore, plat1, plat2) == 0);
+  rv += SDK_ASSERT(testThreads(dataStore, plat1, plat2) == 0);
+  rv += SDK_ASSERT(testInvalidIds(dataStore, plat1) == 0);
+  rv += SDK_ASSERT(testMatchesLive() == 0);
+  return rv;
+}
@@ -0,0 +1,195 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include "osg/Geode"
+#include "osg/Geometry"
+#include "osg/Group"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Coordinate.h"
+#include "simCore/Calc/CoordinateConverter.h"
+#include "simData/MemoryDataStore.h"
+#include "simVis/RangeTool.h"
+#include "simVis/Scenario.h"
+#include "simVis/SceneManager.h"
+
+namespace
+{
+
+uint64_t addPlatform(simData::DataStore& dataStore)
+{
+  simData::DataStore::Transaction t;
+  simData::PlatformProperties* props = dataStore.addPlatform(&t);
+  const uint64_t id = props->id();
+  t.commit();
+  return id;
+}
+
+/** Adds an update at the given LLA (deg, deg, m) */
+void addUpdate(simData::DataStore& dataStore, uint64_t id, double time, double latDeg, double lonDeg, double alt)
+{
+  const simCore::Coordinate lla(simCore::COORD_SYS_LLA,
+    simCore::Vec3(latDeg * simCore::DEG2RAD, lonDeg * simCore::DEG2RAD, alt),
+    simCore::Vec3(0.0, 0.0, 0.0));
+  simCore::Coordinate ecef;
+  simCore::CoordinateConverter::convertGeodeticToEcef(lla, ecef);
+
+  simData::DataStore::Transaction t;
+  simData::PlatformUpdate* update = dataStore.addPlatformUpdate(id, &t);
+  update->set_time(time);
+  update->set_x(ecef.x());
+  update->set_y(ecef.y());
+  update->set_z(ecef.z());
+  update->set_psi(ecef.psi());
+  update->set_theta(ecef.theta());
+  update->set_phi(ecef.phi());
+  t.commit();
+}
+
+/** Adds a ground line and a true azimuth pie slice calculation to the association */
+void addCalculations(simVis::RangeTool::Association* assoc)
+{
+  osg::ref_ptr<simVis::RangeTool::Calculation> line = new simVis::RangeTool::Calculation("Ground Distance");
+  line->addGraphic(new simVis::RangeTool::GroundLineGraphic());
+  line->setLabelMeasurement(new simVis::RangeTool::GroundDistanceMeasurement());
+  assoc->add(line.get());
+
+  osg::ref_ptr<simVis::RangeTool::Calculation> azimuth = new simVis::RangeTool::Calculation("True Azimuth");
+  azimuth->addGraphic(new simVis::RangeTool::TrueAzimuthPieSliceGraphic());
+  assoc->add(azimuth.get());
+}
+
+/** Returns the geode holding the association's graphics */
+osg::Geode* graphicsGeode(const simVis::RangeTool::Association* assoc)
+{
+  const osg::Group* xform = assoc->getNode()->asGroup();
+  if (xform == NULL || xform->getNumChildren() == 0)
+    return NULL;
+  return const_cast<osg::Node*>(xform->getChild(0))->asGeode();
+}
+
+/** Collects the drawables currently attached to the association's geode */
+std::vector<const osg::Drawable*> drawables(const simVis::RangeTool::Association* assoc)
+{
+  std::vector<const osg::Drawable*> rv;
+  const osg::Geode* geode = graphicsGeode(assoc);
+  if (geode == NULL)
+    return rv;
+  for (unsigned int k = 0; k < geode->getNumDrawables(); ++k)
+    rv.push_back(geode->getDrawable(k));
+  return rv;
+}
+
+/** Compares the vertices of two associations' graphics */
+int compareVertices(const simVis::RangeTool::Association* updated, const simVis::RangeTool::Association* fresh)
+{
+  int rv = 0;
+  const std::vector<const osg::Drawable*> updatedDrawables = drawables(updated);
+  const std::vector<const osg::Drawable*> freshDrawables = drawables(fresh);
+  rv += SDK_ASSERT(!updatedDrawables.empty());
+  rv += SDK_ASSERT(updatedDrawables.size() == freshDrawables.size());
+  if (rv != 0)
+    return rv;
+
+  for (size_t k = 0; k < updatedDrawables.size(); ++k)
+  {
+    const osg::Geometry* updatedGeom = updatedDrawables[k]->asGeometry();
+    const osg::Geometry* freshGeom = freshDrawables[k]->asGeometry();
+    rv += SDK_ASSERT(updatedGeom != NULL && freshGeom != NULL);
+    if (updatedGeom == NULL || freshGeom == NULL)
+      continue;
+    const osg::Vec3Array* updatedVerts = dynamic_cast<const osg::Vec3Array*>(updatedGeom->getVertexArray());
+    const osg::Vec3Array* freshVerts = dynamic_cast<const osg::Vec3Array*>(freshGeom->getVertexArray());
+    rv += SDK_ASSERT(updatedVerts != NULL && freshVerts != NULL);
+    if (updatedVerts == NULL || freshVerts == NULL)
+      continue;
+    rv += SDK_ASSERT(updatedVerts->size() == freshVerts->size());
+    if (updatedVerts->size() != freshVerts->size())
+      continue;
+    for (size_t v = 0; v < updatedVerts->size(); ++v)
+      rv += SDK_ASSERT(((*updatedVerts)[v] - (*freshVerts)[v]).length() < 1e-3f);
+  }
+  return rv;
+}
+
+/** Advances the data store and the scenario to the given time */
+void setTime(simData::DataStore& dataStore, simVis::ScenarioManager& scenario, double time)
+{
+  dataStore.update(time);
+  scenario.update(&dataStore);
+}
+
+}
+
+int RangeToolUpdateTest(int argc, char* argv[])
+{
+  int rv = 0;
+  simData::MemoryDataStore dataStore;
+  osg::ref_ptr<simVis::SceneManager> scene = new simVis::SceneManager();
+  osg::ref_ptr<simVis::ScenarioManager> scenario = scene->getScenario();
+  scenario->bind(&dataStore);
+
+  const uint64_t plat1 = addPlatform(dataStore);
+  const uint64_t plat2 = addPlatform(dataStore);
+  addUpdate(dataStore, plat1, 0.0, 0.0, 0.0, 0.0);
+  // plat2 moves north-east of plat1 so both the line and the pie slice change shape
+  addUpdate(dataStore, plat2, 0.0, 0.10, 0.00, 1000.0);
+  addUpdate(dataStore, plat2, 10.0, 0.10, 0.10, 1500.0);
+  addUpdate(dataStore, plat2, 20.0, 0.05, 0.15, 2000.0);
+  setTime(dataStore, *scenario, 0.0);
+
+  osg::ref_ptr<simVis::RangeTool> rangeTool = new simVis::RangeTool(scenario.get());
+  simVis::RangeTool::Association* assoc = rangeTool->add(plat1, plat2);
+  addCalculations(assoc);
+
+  // First update allocates the geometry
+  rangeTool->update(scenario.get());
+  rv += SDK_ASSERT(rangeTool->updateStats().rebuilds_ == 1);
+  rv += SDK_ASSERT(rangeTool->updateStats().inPlaceUpdates_ == 0);
+  const std::vector<const osg::Drawable*> initial = drawables(assoc);
+  rv += SDK_ASSERT(!initial.empty());
+
+  // Nothing moved, so the next update is skipped
+  rangeTool->update(scenario.get());
+  rv += SDK_ASSERT(rangeTool->updateStats().skippedUpdates_ == 1);
+
+  // Each time the platform moves, the same geometry is updated in place
+  const double times[] = { 10.0, 20.0 };
+  for (size_t k = 0; k < 2; ++k)
+  {
+    setTime(dataStore, *scenario, times[k]);
+    rangeTool->update(scenario.get());
+    rv += SDK_ASSERT(rangeTool->updateStats().rebuilds_ == 1);
+    rv += SDK_ASSERT(rangeTool->updateStats().inPlaceUpdates_ == k + 1);
+    rv += SDK_ASSERT(drawables(assoc) == initial);
+
+    // The refreshed vertices match those of a range tool built from scratch at this time
+    osg::ref_ptr<simVis::RangeTool> freshTool = new simVis::RangeTool(scenario.get());
+    simVis::RangeTool::Association* freshAssoc = freshTool->add(plat1, plat2);
+    addCalculations(freshAssoc);
+    freshTool->update(scenario.get());
+    rv += SDK_ASSERT(freshTool->updateStats().rebuilds_ == 1);
+    rv += SDK_ASSERT(compareVertices(assoc, freshAssoc) == 0);
+  }
+
+  scenario->unbind(&dataStore, true);
+  return rv;
+}
@@ -0,0 +1,204 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "osg/Node"
+#include "OpenThreads/Thread"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Common/Version.h"
+#include "simVis/Registry.h"
+
+namespace
+{
+
+const char* MODEL_FILE = "RegistryModelLoadTest.osgt";
+const char* MISSING_FILE = "RegistryModelLoadTestMissing.osgt";
+
+/** Writes a minimal OSG ascii scene file */
+void writeModelFile()
+{
+  std::ofstream os(MODEL_FILE);
+  os << "#Ascii Scene\n#Version 80\n#Generator OpenSceneGraph 3.0.0\n\n"
+    << "osg::Group {\n  UniqueID 1\n}\n";
+}
+
+/** Polls a background model request until it completes, with a generous timeout */
+simVis::Registry::ModelLoadStatus waitForModel(const std::string& name, osg::ref_ptr<osg::Node>& model)
+{
+  simVis::Registry* registry = simVis::Registry::instance();
+  simVis::Registry::ModelLoadStatus status = registry->requestIconModel(name, model);
+  for (int k = 0; k < 10000 && status == simVis::Registry::MODEL_PENDING; ++k)
+  {
+    OpenThreads::Thread::microSleep(1000);
+    status = registry->requestIconModel(name, model);
+  }
+  return status;
+}
+
+/** Waits until no background loads are queued or in progress */
+void waitForLoaders()
+{
+  for (int k = 0; k < 10000 && simVis::Registry::instance()->modelCacheStats().pendingLoads > 0; ++k)
+    OpenThreads::Thread::microSleep(1000);
+}
+
+int testLoadAndDedup()
+{
+  int rv = 0;
+  simVis::Registry* registry = simVis::Registry::instance();
+  registry->clearModelCache();
+  const simVis::Registry::ModelCacheStats initial = registry->modelCacheStats();
+
+  // Two requests for the same name before it finishes share one background load
+  osg::ref_ptr<osg::Node> model;
+  bool isImage = true;
+  rv += SDK_ASSERT(registry->requestIconModel(MODEL_FILE, model, &isImage) == simVis::Registry::MODEL_PENDING);
+  rv += SDK_ASSERT(!model.valid());
+  registry->requestIconModel(MODEL_FILE, model);
+  simVis::Registry::ModelCacheStats stats = registry->modelCacheStats();
+  rv += SDK_ASSERT(stats.queuedLoads == initial.queuedLoads + 1);
+  rv += SDK_ASSERT(stats.requests == initial.requests + 2);
+  rv += SDK_ASSERT(stats.loaderThreads >= 1);
+  rv += SDK_ASSERT(stats.loaderThreads <= simVis::Registry::MAX_MODEL_LOADER_THREADS);
+
+  model = NULL;
+  rv += SDK_ASSERT(waitForModel(MODEL_FILE, model) == simVis::Registry::MODEL_LOADED);
+  rv += SDK_ASSERT(model.valid());
+  stats = registry->modelCacheStats();
+  rv += SDK_ASSERT(stats.queuedLoads == initial.queuedLoads + 1);
+  rv += SDK_ASSERT(stats.completedLoads == initial.completedLoads + 1);
+  rv += SDK_ASSERT(stats.failedLoads == initial.failedLoads);
+  rv += SDK_ASSERT(stats.pendingLoads == 0);
+  rv += SDK_ASSERT(stats.cachedModels == 1);
+  rv += SDK_ASSERT(stats.cacheHits >= initial.cacheHits + 1);
+
+  // Later requests are answered from the cache without another load
+  const unsigned int hits = stats.cacheHits;
+  osg::ref_ptr<osg::Node> again;
+  rv += SDK_ASSERT(registry->requestIconModel(MODEL_FILE, again, &isImage) == simVis::Registry::MODEL_LOADED);
+  rv += SDK_ASSERT(again.valid());
+  rv += SDK_ASSERT(!isImage);
+  stats = registry->modelCacheStats();
+  rv += SDK_ASSERT(stats.cacheHits == hits + 1);
+  rv += SDK_ASSERT(stats.queuedLoads == initial.queuedLoads + 1);
+
+  // The synchronous call shares the background load's cache entry
+  osg::ref_ptr<osg::Node> sync = registry->getOrCreateIconModel(MODEL_FILE);
+  rv += SDK_ASSERT(sync.valid());
+  rv += SDK_ASSERT(registry->modelCacheStats().cacheHits == hits + 2);
+  return rv;
+}
+
+int testFailed()
+{
+  int rv = 0;
+  simVis::Registry* registry = simVis::Registry::instance();
+  const simVis::Registry::ModelCacheStats initial = registry->modelCacheStats();
+
+  osg::ref_ptr<osg::Node> model;
+  rv += SDK_ASSERT(waitForModel(MISSING_FILE, model) == simVis::Registry::MODEL_FAILED);
+  rv += SDK_ASSERT(!model.valid());
+  const simVis::Registry::ModelCacheStats stats = registry->modelCacheStats();
+  rv += SDK_ASSERT(stats.queuedLoads == initial.queuedLoads + 1);
+  rv += SDK_ASSERT(stats.failedLoads == initial.failedLoads + 1);
+  rv += SDK_ASSERT(stats.completedLoads == initial.completedLoads);
+  rv += SDK_ASSERT(stats.cachedModels == initial.cachedModels);
+
+  // Failures are remembered rather than loaded again
+  rv += SDK_ASSERT(registry->requestIconModel(MISSING_FILE, model) == simVis::Registry::MODEL_FAILED);
+  rv += SDK_ASSERT(registry->modelCacheStats().queuedLoads == initial.queuedLoads + 1);
+
+  // Empty names fail without queuing
+  rv += SDK_ASSERT(registry->requestIconModel("", model) == simVis::Registry::MODEL_FAILED);
+  rv += SDK_ASSERT(registry->modelCacheStats().queuedLoads == initial.queuedLoads + 1);
+  return rv;
+}
+
+int testThreadBound()
+{
+  int rv = 0;
+  simVis::Registry* registry = simVis::Registry::instance();
+  registry->clearModelCache();
+
+  // Many distinct names queue many loads, but the pool does not grow past its bound
+  osg::ref_ptr<osg::Node> model;
+  for (unsigned int k = 0; k < 4 * simVis::Registry::MAX_MODEL_LOADER_THREADS; ++k)
+  {
+    std::ostringstream name;
+    name << "RegistryModelLoadTestMissing" << k << ".osgt";
+    registry->requestIconModel(name.str(), model);
+    rv += SDK_ASSERT(registry->modelCacheStats().loaderThreads <= simVis::Registry::MAX_MODEL_LOADER_THREADS);
+  }
+  waitForLoaders();
+  const simVis::Registry::ModelCacheStats stats = registry->modelCacheStats();
+  rv += SDK_ASSERT(stats.pendingLoads == 0);
+  rv += SDK_ASSERT(stats.loaderThreads >= 1);
+  rv += SDK_ASSERT(stats.loaderThreads <= simVis::Registry::MAX_MODEL_LOADER_THREADS);
+  return rv;
+}
+
+int testClearDiscardsLoads()
+{
+  int rv = 0;
+  simVis::Registry* registry = simVis::Registry::instance();
+  registry->clearModelCache();
+  rv += SDK_ASSERT(registry->modelCacheStats().cachedModels == 0);
+
+  // Clear while the load is queued or in progress; its result must not reach the new generation
+  osg::ref_ptr<osg::Node> model;
+  rv += SDK_ASSERT(registry->requestIconModel(MODEL_FILE, model) == simVis::Registry::MODEL_PENDING);
+  registry->clearModelCache();
+  waitForLoaders();
+  simVis::Registry::ModelCacheStats stats = registry->modelCacheStats();
+  rv += SDK_ASSERT(stats.pendingLoads == 0);
+  rv += SDK_ASSERT(stats.cachedModels == 0);
+
+  // The next request starts a fresh load instead of picking up the discarded one
+  const unsigned int queued = stats.queuedLoads;
+  rv += SDK_ASSERT(registry->requestIconModel(MODEL_FILE, model) == simVis::Registry::MODEL_PENDING);
+  rv += SDK_ASSERT(registry->modelCacheStats().queuedLoads == queued + 1);
+  rv += SDK_ASSERT(waitForModel(MODEL_FILE, model) == simVis::Registry::MODEL_LOADED);
+  rv += SDK_ASSERT(registry->modelCacheStats().cachedModels == 1);
+  registry->clearModelCache();
+  return rv;
+}
+
+}
+
+int RegistryModelLoadTest(int argc, char* argv[])
+{
+  int rv = 0;
+
+  // Check the SIMDIS SDK version
+  simCore::checkVersionThrow();
+
+  writeModelFile();
+  ::remove(MISSING_FILE);
+  rv += SDK_ASSERT(testLoadAndDedup() == 0);
+  rv += SDK_ASSERT(testFailed() == 0);
+  rv += SDK_ASSERT(testThreadBound() == 0);
+  rv += SDK_ASSERT(testClearDiscardsLoads() == 0);
+  ::remove(MODEL_FILE);
+
+  return rv;
+}
@@ -0,0 +1,196 @@
+/* -*- mode: c++ -*- */
+/****************************************************************************
+ *****                                                                  *****
+ *****                   Classification: UNCLASSIFIED                   *****
+ *****                    Classified By:                                *****
+ *****                    Declassify On:                                *****
+ *****                                                                  *****
+ ****************************************************************************
+ *
+ *
+ * Developed by: Naval Research Laboratory, Tactical Electronic Warfare Div.
+ *               EW Modeling & Simulation, Code 5773
+ *               4555 Overlook Ave.
+ *               Washington, D.C. 20375-5339
+ *
+ * License for source code at https://simdis.nrl.navy.mil/License.aspx
+ *
+ * The U.S. Government retains all rights to use, duplicate, distribute,
+ * disclose, or release this software.
+ *
+ */
+#include "osg/Geode"
+#include "osg/Geometry"
+#include "osg/MatrixTransform"
+#include "simCore/Common/SDKAssert.h"
+#include "simCore/Calc/Angle.h"
+#include "simCore/Calc/Math.h"
+#include "simVis/SphericalVolume.h"
+
+namespace
+{
+
+/** Returns the first geometry of the node's solid geode */
+osg::Geometry* solidGeometry(osg::MatrixTransform* xform)
+{
+  return xform->getChild(0)->asGeode()->getDrawable(0)->asGeometry();
+}
+
+/** Returns the node's model-space vertices */
+const osg::Vec3Array& vertices(osg::MatrixTransform* xform)
+{
+  return *static_cast<const osg::Vec3Array*>(solidGeometry(xform)->getVertexArray());
+}
+
+simVis::SVData beamData(simVis::SVData::Shape shape)
+{
+  simVis::SVData sv;
+  sv.shape_ = shape;
+  sv.farRange_ = 2000.0f;
+  sv.hfov_deg_ = 10.0f;
+  sv.vfov_deg_ = 5.0f;
+  sv.drawMode_ = simVis::SVData::DRAW_MODE_SOLID | simVis::SVData::DRAW_MODE_WIRE;
+  return sv;
+}
+
+int testSharing()
+{
+  int rv = 0;
+  const simVis::SVFactory::MeshCacheStats initial = simVis::SVFactory::meshCacheStats();
+
+  simVis::SVData sv = beamData(simVis::SVData::SHAPE_CONE);
+  osg::ref_ptr<osg::MatrixTransform> first = simVis::SVFactory::createNode(sv);
+  sv.color_.set(1.0f, 0.0f, 0.0f, 1.0f);
+  osg::ref_ptr<osg::MatrixTransform> second = simVis::SVFactory::createNode(sv);
+  rv += SDK_ASSERT(simVis::SVFactory::isShared(first.get()));
+  rv += SDK_ASSERT(simVis::SVFactory::isShared(second.get()));
+
+  // Vertices are shared, colors are not
+  osg::Geometry* firstGeom = solidGeometry(first.get());
+  osg::Geometry* secondGeom = solidGeometry(second.get());
+  rv += SDK_ASSERT(firstGeom != secondGeom);
+  rv += SDK_ASSERT(firstGeom->getVertexArray() == secondGeom->getVertexArray());
+  rv += SDK_ASSERT(firstGeom->getColorArray() != secondGeom->getColorArray());
+
+  simVis::SVFactory::MeshCacheStats stats = simVis::SVFactory::meshCacheStats();
+  rv += SDK_ASSERT(stats.uniqueMeshes_ == initial.uniqueMeshes_ + 1);
+  rv += SDK_ASSERT(stats.sharedNodes_ == initial.sharedNodes_ + 2);
+
+  // A different range or shape gets its own mesh
+  sv.farRange_ = 500.0f;
+  osg::ref_ptr<osg::MatrixTransform> shorter = simVis::SVFactory::createNode(sv);
+  rv += SDK_ASSERT(solidGeometry(shorter.get())->getVertexArray() != secondGeom->getVertexArray());
+  osg::ref_ptr<osg::MatrixTransform> pyramid = simVis::SVFactory::createNode(beamData(simVis::SVData::SHAPE_PYRAMID));
+  stats = simVis::SVFactory::meshCacheStats();
+  rv += SDK_ASSERT(stats.uniqueMeshes_ == initial.uniqueMeshes_ + 3);
+  rv += SDK_ASSERT(stats.sharedNodes_ == initial.sharedNodes_ + 4);
+
+  // Other references to the shared arrays do not count as users
+  osg::ref_ptr<const osg::Array> extraRef = secondGeom->getVertexArray();
+  stats = simVis::SVFactory::meshCacheStats();
+  rv += SDK_ASSERT(stats.sharedNodes_ == initial.sharedNodes_ + 4);
+
+  // Range changes give the node its own copy, at its new range
+  simVis::SVFactory::updateFarRange(first.get(), 3000.0f);
+  rv += SDK_ASSERT(!simVis::SVFactory::isShared(first.get()));
+  rv += SDK_ASSERT(simVis::SVFactory::isShared(second.get()));
+  firstGeom = solidGeometry(first.get());
+  rv += SDK_ASSERT(firstGeom->getVertexArray() != secondGeom->getVertexArray());
+  rv += SDK_ASSERT(simCore::areEqual(vertices(first.get())[0].length(), 3000.0, 0.01));
+  rv += SDK_ASSERT(simCore::areEqual(vertices(second.get())[0].length(), 2000.0, 0.01));
+  // The wireframe geode still draws the solid geometry
+  rv += SDK_ASSERT(first->getNumChildren() == 2);
+  rv += SDK_ASSERT(first->getChild(1)->asGeode()->getDrawable(0) == firstGeom);
+
+  // Angle changes also give the node its own copy
+  simVis::SVFactory::updateHorizAngle(shorter.get(), 10.0f * simCore::DEG2RAD, 20.0f * simCore::DEG2RAD);
+  rv += SDK_ASSERT(!simVis::SVFactory::isShared(shorter.get()));
+  rv += SDK_ASSERT(simCore::areEqual(vertices(shorter.get())[0].length(), 500.0, 0.01));
+
+  stats = simVis::SVFactory::meshCacheStats();
+  rv += SDK_ASSERT(stats.uniqueMeshes_ == initial.uniqueMeshes_ + 2);
+  rv += SDK_ASSERT(stats.sharedNodes_ == initial.sharedNodes_ + 2);
+
+  // Meshes are released when no node draws them, even if their arrays are still referenced
+  second = NULL;
+  pyramid = NULL;
+  stats = simVis::SVFactory::meshCacheStats();
+  rv += SDK_ASSERT(stats.uniqueMeshes_ == initial.uniqueMeshes_);
+  rv += SDK_ASSERT(stats.sharedNodes_ == initial.sharedNodes_);
+  return rv;
+}
+
+/** Compares model-space vertices of shared and unshared nodes; beam pulse and stipple shaders read them directly */
+int testModelCoordinates(simVis::SVData::Shape shape)
+{
+  int rv = 0;
+  const simVis::SVData sv = beamData(shape);
+  osg::ref_ptr<osg::MatrixTransform> shared = simVis::SVFactory::createNode(sv);
+  simVis::SVFactory::setMeshCacheEnabled(false);
+  osg::ref_ptr<osg::MatrixTransform> unshared = simVis::SVFactory::createNode(sv);
+  simVis::SVFactory::setMeshCacheEnabled(true);
+  rv += SDK_ASSERT(simVis::SVFactory::isShared(shared.get()));
+  rv += SDK_ASSERT(!simVis::SVFactory::isShared(unshared.get()));
+
+  // No transform between the node and its geometry
+  rv += SDK_ASSERT(shared->getChild(0)->asGeode() != NULL);
+
+  const osg::Vec3Array& sharedVerts = vertices(shared.get());
+  const osg::Vec3Array& unsharedVerts = vertices(unshared.get());
+  rv += SDK_ASSERT(sharedVerts.size() == unsharedVerts.size());
+  if (sharedVerts.size() != unsharedVerts.size())
+    return rv;
+
+  // The beam pulse coordinate is the model-space y, which runs out to the far range
+  float maxY = 0.0f;
+  bool same = true;
+  for (unsigned int i = 0; i < sharedVerts.size(); ++i)
+  {
+    same = same && (sharedVerts[i] == unsharedVerts[i]);
+    maxY = simCore::sdkMax(maxY, sharedVerts[i].y());
+  }
+  rv += SDK_ASSERT(same);
+  rv += SDK_ASSERT(maxY > 0.99f * sv.farRange_ && maxY <= sv.farRange_ + 0.01f);
+
+  // Normals need no rescaling
+  const osg::Vec3Array* normals = static_cast<const osg::Vec3Array*>(solidGeometry(shared.get())->getNormalArray());
+  rv += SDK_ASSERT(normals != NULL && !normals->empty() && simCore::areEqual((*normals)[0].length(), 1.0, 1e-5));
+  return rv;
+}
+
+int testUnshareable()
+{
+  int rv = 0;
+  // Volumes with a near face are built per node
+  simVis::SVData gate = beamData(simVis::SVData::SHAPE_PYRAMID);
+  gate.nearRange_ = 1000.0f;
+  osg::ref_ptr<osg::MatrixTransform> node = simVis::SVFactory::createNode(gate);
+  rv += SDK_ASSERT(!simVis::SVFactory::isShared(node.get()));
+
+  // Gates that start at the origin share until the near range changes
+  gate.nearRange_ = 0.0f;
+  node = simVis::SVFactory::createNode(gate);
+  rv += SDK_ASSERT(simVis::SVFactory::isShared(node.get()));
+  simVis::SVFactory::updateNearRange(node.get(), 100.0f);
+  rv += SDK_ASSERT(!simVis::SVFactory::isShared(node.get()));
+  rv += SDK_ASSERT(simVis::SVFactory::outlineGeometry(node.get()) == NULL);
+
+  // Sharing can be turned off
+  simVis::SVFactory::setMeshCacheEnabled(false);
+  node = simVis::SVFactory::createNode(gate);
+  rv += SDK_ASSERT(!simVis::SVFactory::isShared(node.get()));
+  simVis::SVFactory::setMeshCacheEnabled(true);
+  return rv;
+}
+
+}
+
+int SphericalVolumeTest(int argc, char* argv[])
+{
+  int rv = 0;
+  rv += SDK_ASSERT(testSharing() == 0);
+  rv += SDK_ASSERT(testModelCoordinates(simVis::SVData::SHAPE_CONE) == 0);
+  rv += SDK_ASSERT(testModelCoordinates(simVis::SVData::SHAPE_PYRAMID) == 0);
+  rv += SDK_ASSERT(testUnshareable() == 0);
+  return rv;
+}